@@ -0,0 +1,286 @@
+///
+/// @file   primesieve_bench.cpp
+/// @brief  Benchmark suite of standard primesieve workloads:
+///         prime counting near 1e9, 1e12, 1e15 and 1e18 with
+///         short and long distances, prime k-tuplet counting,
+///         generate_primes(), primesieve::iterator, nth_prime()
+///         and printing primes. The workloads are run for each
+///         sieve size and thread count, the results are printed
+///         as JSON to stdout.
+///
+///         Usage: primesieve_bench [--quick] [--repeat=N]
+///                [--sizes=16,32,...] [--threads=1,2,...]
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/CpuInfo.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+struct Workload
+{
+  string name;
+  uint64_t start;
+  uint64_t stop;
+  function<uint64_t()> run;
+};
+
+struct Options
+{
+  bool quick = false;
+  int repeat = 1;
+  vector<int> sizes;
+  vector<int> threads;
+};
+
+/// e.g. "16,32,64" -> { 16, 32, 64 }
+vector<int> parseList(const string& str)
+{
+  vector<int> list;
+  istringstream in(str);
+  string item;
+
+  while (getline(in, item, ','))
+    list.push_back(stoi(item));
+
+  return list;
+}
+
+Options parseOptions(int argc, char* argv[])
+{
+  Options opts;
+
+  for (int i = 1; i < argc; i++)
+  {
+    string arg = argv[i];
+    size_t pos = arg.find('=');
+    string opt = arg.substr(0, pos);
+    string val = (pos != string::npos) ? arg.substr(pos + 1) : "";
+
+    if (opt == "--quick")
+      opts.quick = true;
+    else if (opt == "--repeat" && !val.empty())
+      opts.repeat = max(1, stoi(val));
+    else if (opt == "--sizes" && !val.empty())
+      opts.sizes = parseList(val);
+    else if (opt == "--threads" && !val.empty())
+      opts.threads = parseList(val);
+    else
+      throw primesieve_error("invalid option " + arg);
+  }
+
+  if (opts.sizes.empty())
+    opts.sizes.push_back(get_sieve_size());
+  if (opts.threads.empty())
+    opts.threads.push_back(get_num_threads());
+
+  return opts;
+}
+
+/// Print the primes to the null device
+uint64_t printPrimes(uint64_t start, uint64_t stop)
+{
+#if defined(_WIN32)
+  ofstream null("NUL");
+#else
+  ofstream null("/dev/null");
+#endif
+
+  auto buf = cout.rdbuf(null.rdbuf());
+
+  try
+  {
+    print_primes(start, stop);
+  }
+  catch (...)
+  {
+    cout.rdbuf(buf);
+    throw;
+  }
+
+  cout.flush();
+  cout.rdbuf(buf);
+  return 0;
+}
+
+uint64_t nextPrimes(uint64_t start, uint64_t stop)
+{
+  uint64_t sum = 0;
+  primesieve::iterator it(start, stop);
+  for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+    sum += prime;
+  return sum;
+}
+
+uint64_t prevPrimes(uint64_t start, uint64_t stop)
+{
+  uint64_t sum = 0;
+  primesieve::iterator it(stop + 1);
+  for (uint64_t prime = it.prev_prime(); prime >= start && prime > 0; prime = it.prev_prime())
+    sum += prime;
+  return sum;
+}
+
+vector<Workload> getWorkloads(bool quick)
+{
+  // --quick runs 100x smaller workloads
+  uint64_t div = quick ? 100 : 1;
+  uint64_t shortDist = (uint64_t) 1e8 / div;
+  uint64_t longDist = (uint64_t) 1e10 / div;
+  vector<Workload> workloads;
+
+  auto count = [](uint64_t start, uint64_t stop) {
+    return [=]() { return count_primes(start, stop); };
+  };
+
+  uint64_t x = (uint64_t) 1e9 / div;
+  workloads.push_back({ "count_primes", 0, x, count(0, x) });
+
+  for (uint64_t n : { (uint64_t) 1e12, (uint64_t) 1e15, (uint64_t) 1e18 })
+  {
+    workloads.push_back({ "count_primes", n, n + shortDist, count(n, n + shortDist) });
+    workloads.push_back({ "count_primes", n, n + longDist, count(n, n + longDist) });
+  }
+
+  uint64_t n = (uint64_t) 1e12;
+  uint64_t stop = n + (uint64_t) 1e9 / div;
+  workloads.push_back({ "count_twins", n, stop, [=]() { return count_twins(n, stop); } });
+  workloads.push_back({ "count_triplets", n, stop, [=]() { return count_triplets(n, stop); } });
+  workloads.push_back({ "count_sextuplets", n, stop, [=]() { return count_sextuplets(n, stop); } });
+
+  stop = n + shortDist;
+  workloads.push_back({ "generate_primes", n, stop, [=]() {
+    vector<uint64_t> primes;
+    generate_primes(n, stop, &primes);
+    return (uint64_t) primes.size();
+  }});
+
+  x = (uint64_t) 1e9 / div;
+  workloads.push_back({ "next_prime", 0, x, [=]() { return nextPrimes(0, x); } });
+  workloads.push_back({ "prev_prime", 0, x, [=]() { return prevPrimes(0, x); } });
+
+  int64_t nth = (int64_t) (1e8 / div);
+  workloads.push_back({ "nth_prime", 0, 0, [=]() { return nth_prime(nth); } });
+
+  x = (uint64_t) 1e9 / div;
+  workloads.push_back({ "print_primes", 0, x, [=]() { return printPrimes(0, x); } });
+
+  return workloads;
+}
+
+/// Best time of repeat runs
+double benchmark(const Workload& workload, int repeat, uint64_t* result)
+{
+  double best = 0;
+
+  for (int i = 0; i < repeat; i++)
+  {
+    auto t1 = chrono::steady_clock::now();
+    *result = workload.run();
+    auto t2 = chrono::steady_clock::now();
+    chrono::duration<double> seconds = t2 - t1;
+
+    if (i == 0 || seconds.count() < best)
+      best = seconds.count();
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    Options opts = parseOptions(argc, argv);
+    vector<Workload> workloads = getWorkloads(opts.quick);
+    ostringstream json;
+
+    json << "{\n";
+    json << "  \"version\": \"" << primesieve_version() << "\",\n";
+    json << "  \"cpu\": \"" << (cpuInfo.hasCpuName() ? cpuInfo.cpuName() : "unknown") << "\",\n";
+    json << "  \"quick\": " << (opts.quick ? "true" : "false") << ",\n";
+    json << "  \"results\": [\n";
+
+    bool first = true;
+
+    for (int sieveSize : opts.sizes)
+    {
+      for (int threads : opts.threads)
+      {
+        set_sieve_size(sieveSize);
+        set_num_threads(threads);
+
+        for (auto& workload : workloads)
+        {
+          uint64_t result = 0;
+          double seconds = benchmark(workload, opts.repeat, &result);
+
+          // nth_prime sieves up to the result
+          uint64_t stop = workload.stop;
+          if (workload.name == "nth_prime")
+            stop = result;
+
+          double numbers = (double) (stop - workload.start) + 1;
+          double numbersPerSec = (seconds > 0) ? numbers / seconds : 0;
+
+          // 1 byte of the sieve array holds 30 numbers
+          double bytesPerSec = numbersPerSec / 30;
+
+          if (!first)
+            json << ",\n";
+          first = false;
+
+          json << "    {\"name\": \"" << workload.name
+               << "\", \"start\": " << workload.start
+               << ", \"stop\": " << stop
+               << ", \"sieve_size\": " << get_sieve_size()
+               << ", \"threads\": " << get_num_threads()
+               << ", \"result\": " << result
+               << fixed << setprecision(6)
+               << ", \"seconds\": " << seconds
+               << defaultfloat << setprecision(6)
+               << ", \"numbers_per_second\": " << numbersPerSec
+               << ", \"bytes_per_second\": " << bytesPerSec << "}";
+
+          cerr << workload.name << " [" << workload.start << ", " << stop
+               << "], sieve size = " << get_sieve_size()
+               << " KiB, threads = " << get_num_threads()
+               << ": " << fixed << setprecision(3) << seconds << " s" << endl;
+        }
+      }
+    }
+
+    json << "\n  ]\n}\n";
+    cout << json.str();
+  }
+  catch (exception& e)
+  {
+    cerr << "primesieve_bench: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,341 @@
+///
+/// @file   primesieve_kernels.cpp
+/// @brief  Microbenchmarks of the sieving kernels: EratSmall,
+///         EratMedium and EratBig cross off the multiples of a
+///         reproducible set of sieving primes (generated from
+///         fixed intervals) in consecutive segments, PreSieve::copy
+///         and popcount process the segments, PrimeGenerator::fill
+///         decodes primes. The results (ns and, on x86, TSC
+///         cycles per crossing, byte or prime) are printed as JSON.
+///
+///         Usage: primesieve_kernels [--size=KiB] [--segments=N]
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/EratBig.hpp>
+#include <primesieve/EratMedium.hpp>
+#include <primesieve/EratSmall.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PreSieve.hpp>
+#include <primesieve/PrimeGenerator.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  #include <intrin.h>
+  #define HAS_RDTSC
+#elif (defined(__GNUC__) || defined(__clang__)) && \
+      (defined(__x86_64__) || defined(__i386__))
+  #include <x86intrin.h>
+  #define HAS_RDTSC
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Accumulates the time (and TSC cycles)
+/// between start() and stop()
+///
+class Timer
+{
+public:
+  void start()
+  {
+    t1_ = chrono::steady_clock::now();
+#if defined(HAS_RDTSC)
+    c1_ = __rdtsc();
+#endif
+  }
+
+  void stop()
+  {
+#if defined(HAS_RDTSC)
+    cycles_ += __rdtsc() - c1_;
+#endif
+    chrono::duration<double, nano> ns = chrono::steady_clock::now() - t1_;
+    ns_ += ns.count();
+  }
+
+  double ns() const { return ns_; }
+  double cycles() const { return (double) cycles_; }
+
+private:
+  chrono::steady_clock::time_point t1_;
+  double ns_ = 0;
+  uint64_t c1_ = 0;
+  uint64_t cycles_ = 0;
+};
+
+/// Number of k in [1, n] coprime to the wheel modulo
+class CoprimeCount
+{
+public:
+  CoprimeCount(uint64_t modulo) :
+    modulo_(modulo),
+    prefix_(modulo + 1, 0)
+  {
+    for (uint64_t i = 1; i <= modulo; i++)
+    {
+      bool coprime = (i % 2) && (i % 3) && (i % 5) && (modulo < 210 || (i % 7));
+      prefix_[i] = prefix_[i - 1] + coprime;
+    }
+  }
+
+  uint64_t operator()(uint64_t n) const
+  {
+    return (n / modulo_) * prefix_[modulo_] + prefix_[n % modulo_];
+  }
+
+private:
+  uint64_t modulo_;
+  vector<uint64_t> prefix_;
+};
+
+/// Multiples p * q >= p^2 inside ]low + 6, high + 6] that are
+/// crossed off, q is coprime to the wheel modulo
+///
+uint64_t countCrossings(const vector<uint64_t>& primes,
+                        uint64_t low,
+                        uint64_t high,
+                        uint64_t modulo)
+{
+  CoprimeCount count(modulo);
+  uint64_t crossings = 0;
+
+  for (uint64_t p : primes)
+  {
+    uint64_t qmin = max(p, (low + 6) / p + 1);
+    uint64_t qmax = (high + 6) / p;
+    if (qmax >= qmin)
+      crossings += count(qmax) - count(qmin - 1);
+  }
+
+  return crossings;
+}
+
+struct Result
+{
+  string kernel;
+  string unit;
+  uint64_t primes;
+  uint64_t units;
+  Timer timer;
+};
+
+void print(ostringstream& json, const Result& r, bool last)
+{
+  double units = (double) max<uint64_t>(r.units, 1);
+
+  json << "    {\"kernel\": \"" << r.kernel
+       << "\", \"sieving_primes\": " << r.primes
+       << ", \"" << r.unit << "s\": " << r.units
+       << fixed << setprecision(3)
+       << ", \"ns\": " << r.timer.ns()
+       << ", \"ns_per_" << r.unit << "\": " << r.timer.ns() / units;
+#if defined(HAS_RDTSC)
+  json << ", \"cycles_per_" << r.unit << "\": " << r.timer.cycles() / units;
+#endif
+  json << "}" << (last ? "\n" : ",\n");
+
+  cerr << r.kernel << ": " << fixed << setprecision(3)
+       << r.timer.ns() / units << " ns per " << r.unit << endl;
+}
+
+struct Setup
+{
+  uint64_t sieveSize;
+  uint64_t segments;
+  uint64_t low;
+  uint64_t high;
+};
+
+template <typename ERAT>
+Result crossOff(const string& name,
+                const Setup& s,
+                uint64_t minPrime,
+                uint64_t maxPrime,
+                uint64_t blockSize,
+                uint64_t modulo,
+                ERAT& erat)
+{
+  vector<uint64_t> primes;
+  generate_primes(minPrime + 1, maxPrime, &primes);
+  for (uint64_t p : primes)
+    erat.addSievingPrime(p, s.low);
+
+  Result r;
+  r.kernel = name;
+  r.unit = "crossing";
+  r.primes = primes.size();
+  r.units = countCrossings(primes, s.low, s.high, modulo);
+  vector<byte_t> sieve(s.sieveSize);
+
+  for (uint64_t i = 0; i < s.segments; i++)
+  {
+    fill(sieve.begin(), sieve.end(), (byte_t) 0xff);
+    r.timer.start();
+    for (uint64_t j = 0; j < s.sieveSize; j += blockSize)
+      erat.crossOff(&sieve[j], min(blockSize, s.sieveSize - j));
+    r.timer.stop();
+  }
+
+  return r;
+}
+
+/// EratBig crosses off a whole segment
+struct EratBigSegment
+{
+  EratBig& erat;
+  void addSievingPrime(uint64_t prime, uint64_t low) { erat.addSievingPrime(prime, low); }
+  void crossOff(byte_t* sieve, uint64_t) { erat.crossOff(sieve); }
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    uint64_t sieveSize = get_sieve_size();
+    uint64_t segments = 64;
+
+    for (int i = 1; i < argc; i++)
+    {
+      string arg = argv[i];
+      size_t pos = arg.find('=');
+      string opt = arg.substr(0, pos);
+      if (pos == string::npos || pos + 1 == arg.size())
+        throw primesieve_error("invalid option " + arg);
+      uint64_t val = stoull(arg.substr(pos + 1));
+
+      if (opt == "--size")
+        sieveSize = inBetween(8, val, config::MAX_SIEVE_SIZE);
+      else if (opt == "--segments")
+        segments = max<uint64_t>(val, 1);
+      else
+        throw primesieve_error("invalid option " + arg);
+    }
+
+    Setup s;
+    s.sieveSize = sieveSize * 1024;
+    s.segments = segments;
+    s.low = (uint64_t) 1e16;
+    s.low -= s.low % 30;
+    s.high = s.low + s.sieveSize * 30 * segments;
+
+    // same parameters as Erat::initErat()
+    uint64_t l1Size = EratSmall::getL1Size(s.sieveSize);
+    uint64_t l2Size = EratMedium::getL2Size(s.sieveSize);
+    uint64_t maxEratSmall = (uint64_t) (l1Size * config::FACTOR_ERATSMALL);
+    uint64_t maxEratMedium = (uint64_t) (l2Size * config::FACTOR_ERATMEDIUM);
+    uint64_t maxEratBig = isqrt(s.high);
+    PreSieve preSieve;
+    vector<Result> results;
+
+    EratSmall eratSmall;
+    eratSmall.init(s.high + 6, l1Size, maxEratSmall);
+    results.push_back(crossOff("EratSmall", s, preSieve.getMaxPrime(), maxEratSmall, l1Size, 30, eratSmall));
+
+    EratMedium eratMedium;
+    eratMedium.init(s.high + 6, l2Size, maxEratMedium);
+    results.push_back(crossOff("EratMedium", s, maxEratSmall, maxEratMedium, s.sieveSize, 30, eratMedium));
+
+    EratBig eratBig;
+    eratBig.init(s.high + 6, s.sieveSize, maxEratBig);
+    EratBigSegment bigSegment { eratBig };
+    results.push_back(crossOff("EratBig", s, maxEratMedium, maxEratBig, s.sieveSize, 210, bigSegment));
+
+    vector<byte_t> sieve(s.sieveSize);
+    Result copy;
+    copy.kernel = "PreSieve::copy";
+    copy.unit = "byte";
+    copy.primes = 0;
+    copy.units = s.sieveSize * segments;
+
+    for (uint64_t i = 0; i < segments; i++)
+    {
+      copy.timer.start();
+      preSieve.copy(sieve.data(), s.sieveSize, s.low + i * s.sieveSize * 30);
+      copy.timer.stop();
+    }
+
+    results.push_back(copy);
+
+    Result count;
+    count.kernel = "popcount";
+    count.unit = "byte";
+    count.primes = 0;
+    count.units = s.sieveSize * segments;
+    uint64_t bits = 0;
+
+    for (uint64_t i = 0; i < segments; i++)
+    {
+      count.timer.start();
+      bits += popcount((const uint64_t*) sieve.data(), s.sieveSize / 8);
+      count.timer.stop();
+    }
+
+    results.push_back(count);
+
+    // decode the primes of 1/8 of the interval
+    // (the sieving is included in the time)
+    Result decode;
+    decode.kernel = "PrimeGenerator::fill";
+    decode.unit = "prime";
+    decode.primes = 0;
+    decode.units = 0;
+    PrimeGenerator generator(s.low, s.low + (s.high - s.low) / 8);
+    vector<uint64_t> primes(config::MIN_CACHE_ITERATOR / sizeof(uint64_t));
+    size_t size = 0;
+
+    decode.timer.start();
+    while (!generator.finished())
+    {
+      generator.fill(primes, &size);
+      decode.units += size;
+      size = 0;
+    }
+    decode.timer.stop();
+
+    results.push_back(decode);
+
+    ostringstream json;
+    json << "{\n";
+    json << "  \"sieve_size\": " << sieveSize
+         << ", \"segments\": " << segments
+         << ", \"low\": " << s.low
+         << ", \"l1_size\": " << l1Size
+         << ", \"l2_size\": " << l2Size
+         << ", \"popcount\": " << bits << ",\n";
+    json << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++)
+      print(json, results[i], i + 1 == results.size());
+    json << "  ]\n}\n";
+
+    cout << json.str();
+  }
+  catch (exception& e)
+  {
+    cerr << "primesieve_kernels: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
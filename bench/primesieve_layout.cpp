@@ -0,0 +1,181 @@
+///
+/// @file   primesieve_layout.cpp
+/// @brief  Estimates the gain of a mod 210 sieve layout (48 bits
+///         per 210 numbers) over the mod 30 layout (8 bits per
+///         30 numbers). A mod 210 segment of N bytes holds as
+///         many numbers as a mod 30 segment of N * 7 / 6 bytes,
+///         hence we count the primes of [start, start + distance]
+///         using 1 thread and the sieve sizes N and N * 7 / 6
+///         (KiB). This estimates only the gain of the denser
+///         sieve array, crossing off does not get cheaper using
+///         mod 210 (EratBig already uses a mod 210 wheel and
+///         PreSieve removes the multiples of 7). Prints the
+///         results as JSON to stdout.
+///
+///         Usage: primesieve_layout [--quick] [--repeat=N]
+///                [--start=N] [--distance=N] [--sizes=32,256,...]
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+struct Options
+{
+  bool quick = false;
+  int repeat = 3;
+  uint64_t start = (uint64_t) 1e12;
+  uint64_t distance = (uint64_t) 1e10;
+  vector<int> sizes;
+};
+
+/// e.g. "16,32,64" -> { 16, 32, 64 }
+vector<int> parseList(const string& str)
+{
+  vector<int> list;
+  istringstream in(str);
+  string item;
+
+  while (getline(in, item, ','))
+    list.push_back(stoi(item));
+
+  return list;
+}
+
+Options parseOptions(int argc, char* argv[])
+{
+  Options opts;
+  bool distance = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    string arg = argv[i];
+    size_t pos = arg.find('=');
+    string opt = arg.substr(0, pos);
+    string val = (pos != string::npos) ? arg.substr(pos + 1) : "";
+
+    if (opt == "--quick")
+      opts.quick = true;
+    else if (opt == "--repeat" && !val.empty())
+      opts.repeat = max(1, stoi(val));
+    else if (opt == "--start" && !val.empty())
+      opts.start = (uint64_t) stod(val);
+    else if (opt == "--distance" && !val.empty())
+    {
+      opts.distance = (uint64_t) stod(val);
+      distance = true;
+    }
+    else if (opt == "--sizes" && !val.empty())
+      opts.sizes = parseList(val);
+    else
+      throw primesieve_error("invalid option " + arg);
+  }
+
+  // --quick runs 100x smaller workloads
+  if (opts.quick && !distance)
+    opts.distance /= 100;
+  if (opts.sizes.empty())
+    opts.sizes = { 32, 256, 2048 };
+
+  return opts;
+}
+
+/// Best time of repeat runs using 1 thread, sieve()
+/// does not use the pi(x) table or the LMO algorithm
+///
+double run(uint64_t start, uint64_t stop, int sieveSize, int repeat, uint64_t& count)
+{
+  double best = 0;
+
+  for (int i = 0; i < repeat; i++)
+  {
+    ParallelSieve ps;
+    ps.setNumThreads(1);
+    ps.setSieveSize(sieveSize);
+    ps.setFlags(COUNT_PRIMES);
+    ps.sieve(start, stop);
+    count = ps.getCount(0);
+
+    if (i == 0 || ps.getSeconds() < best)
+      best = ps.getSeconds();
+  }
+
+  return best;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    Options opts = parseOptions(argc, argv);
+    uint64_t stop = opts.start + opts.distance;
+    ostringstream json;
+
+    json << "{\n";
+    json << "  \"version\": \"" << primesieve_version() << "\",\n";
+    json << "  \"start\": " << opts.start << ",\n";
+    json << "  \"stop\": " << stop << ",\n";
+    json << "  \"results\": [\n";
+
+    for (size_t i = 0; i < opts.sizes.size(); i++)
+    {
+      int mod30 = opts.sizes[i];
+      int mod210 = (mod30 * 7 + 3) / 6;
+      uint64_t count30 = 0;
+      uint64_t count210 = 0;
+      double seconds30 = run(opts.start, stop, mod30, opts.repeat, count30);
+      double seconds210 = run(opts.start, stop, mod210, opts.repeat, count210);
+      double gain = (seconds30 > 0) ? 1 - seconds210 / seconds30 : 0;
+
+      if (count30 != count210)
+        throw primesieve_error("prime counts differ");
+
+      if (i > 0)
+        json << ",\n";
+
+      json << "    {\"sieve_size\": " << mod30
+           << ", \"mod210_equivalent_size\": " << mod210
+           << ", \"count\": " << count30
+           << fixed << setprecision(6)
+           << ", \"seconds\": " << seconds30
+           << ", \"mod210_seconds\": " << seconds210
+           << setprecision(4)
+           << ", \"gain\": " << gain << "}";
+
+      cerr << "sieve size " << mod30 << " KiB: " << fixed << setprecision(3)
+           << seconds30 << " s, " << mod210 << " KiB (mod 210): "
+           << seconds210 << " s, gain = " << setprecision(1)
+           << gain * 100 << "%" << endl;
+    }
+
+    json << "\n  ]\n}\n";
+    cout << json.str();
+  }
+  catch (exception& e)
+  {
+    cerr << "primesieve_layout: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,245 @@
+///
+/// @file   primesieve_scaling.cpp
+/// @brief  Strong and weak scaling of ParallelSieve. Counts the
+///         primes inside [start, start + distance] (strong) and
+///         [start, start + distance * threads] (weak) using 1 to
+///         N threads and prints the efficiency, the idle fraction,
+///         the tail idle fraction (threads waiting for the last
+///         thread to finish) and the memory usage per thread as
+///         JSON to stdout.
+///
+///         Usage: primesieve_scaling [--quick] [--repeat=N]
+///                [--start=N] [--distance=N] [--threads=N]
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/SieveStats.hpp>
+#include <primesieve/SieveTrace.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <exception>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+struct Options
+{
+  bool quick = false;
+  int repeat = 1;
+  uint64_t start = (uint64_t) 1e12;
+  uint64_t distance = (uint64_t) 1e10;
+  int threads = 0;
+};
+
+struct Result
+{
+  uint64_t stop = 0;
+  uint64_t count = 0;
+  int threads = 0;
+  double seconds = 0;
+  double idle = 0;
+  double tailIdle = 0;
+  uint64_t threadMemory = 0;
+};
+
+Options parseOptions(int argc, char* argv[])
+{
+  Options opts;
+  bool distance = false;
+
+  for (int i = 1; i < argc; i++)
+  {
+    string arg = argv[i];
+    size_t pos = arg.find('=');
+    string opt = arg.substr(0, pos);
+    string val = (pos != string::npos) ? arg.substr(pos + 1) : "";
+
+    if (opt == "--quick")
+      opts.quick = true;
+    else if (opt == "--repeat" && !val.empty())
+      opts.repeat = max(1, stoi(val));
+    else if (opt == "--start" && !val.empty())
+      opts.start = (uint64_t) stod(val);
+    else if (opt == "--distance" && !val.empty())
+    {
+      opts.distance = (uint64_t) stod(val);
+      distance = true;
+    }
+    else if (opt == "--threads" && !val.empty())
+      opts.threads = max(1, stoi(val));
+    else
+      throw primesieve_error("invalid option " + arg);
+  }
+
+  // --quick runs 100x smaller workloads
+  if (opts.quick && !distance)
+    opts.distance /= 100;
+  if (opts.threads == 0)
+    opts.threads = ParallelSieve::getMaxThreads();
+
+  return opts;
+}
+
+/// Fraction of the thread time spent waiting for the
+/// last thread to finish, from the timeline of the
+/// worker threads (the main thread is -1).
+///
+double tailIdle(const SieveTrace& trace, int threads)
+{
+  map<int, double> lastEnd;
+  double first = -1;
+  double last = 0;
+
+  for (auto& e : trace.getEvents())
+  {
+    if (e.thread < 0)
+      continue;
+    if (first < 0 || e.start < first)
+      first = e.start;
+    last = max(last, e.end);
+    lastEnd[e.thread] = max(lastEnd[e.thread], e.end);
+  }
+
+  double wall = last - first;
+  if (first < 0 || wall <= 0)
+    return 0;
+
+  // threads that got no work idle all the time
+  double idle = (threads - (int) lastEnd.size()) * wall;
+  for (auto& thread : lastEnd)
+    idle += last - thread.second;
+
+  return idle / (threads * wall);
+}
+
+/// Best time of repeat runs
+Result run(uint64_t start, uint64_t stop, int threads, int repeat)
+{
+  Result best;
+
+  for (int i = 0; i < repeat; i++)
+  {
+    ParallelSieve ps;
+    SieveStats stats;
+    SieveTrace trace;
+    ps.setNumThreads(threads);
+    ps.setSieveStats(&stats);
+    ps.setTrace(&trace);
+
+    Result r;
+    r.stop = stop;
+    r.count = ps.countPrimes(start, stop);
+    r.threads = max(stats.threads, 1);
+    r.seconds = ps.getSeconds();
+    r.threadMemory = ps.getThreadMemory(ps.getSieveSize());
+
+    double threadSeconds = r.threads * r.seconds;
+    if (threadSeconds > 0)
+      r.idle = stats.idle / threadSeconds;
+    r.tailIdle = tailIdle(trace, r.threads);
+
+    if (i == 0 || r.seconds < best.seconds)
+      best = r;
+  }
+
+  return best;
+}
+
+void print(ostringstream& json,
+           const string& mode,
+           uint64_t start,
+           int threads,
+           const Result& r,
+           double efficiency,
+           bool first)
+{
+  if (!first)
+    json << ",\n";
+
+  json << "    {\"mode\": \"" << mode
+       << "\", \"start\": " << start
+       << ", \"stop\": " << r.stop
+       << ", \"threads\": " << threads
+       << ", \"threads_used\": " << r.threads
+       << ", \"count\": " << r.count
+       << fixed << setprecision(6)
+       << ", \"seconds\": " << r.seconds
+       << setprecision(4)
+       << ", \"efficiency\": " << efficiency
+       << ", \"idle_fraction\": " << r.idle
+       << ", \"tail_idle_fraction\": " << r.tailIdle
+       << ", \"memory_per_thread\": " << r.threadMemory << "}";
+
+  cerr << mode << " [" << start << ", " << r.stop << "], threads = "
+       << r.threads << "/" << threads << ": " << fixed << setprecision(3)
+       << r.seconds << " s, efficiency = " << setprecision(1)
+       << efficiency * 100 << "%" << endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+  try
+  {
+    Options opts = parseOptions(argc, argv);
+    ostringstream json;
+
+    json << "{\n";
+    json << "  \"version\": \"" << primesieve_version() << "\",\n";
+    json << "  \"sieve_size\": " << get_sieve_size() << ",\n";
+    json << "  \"results\": [\n";
+
+    bool first = true;
+    Result strong1;
+    Result weak1;
+
+    // strong scaling: efficiency = T(1) / (threads * T(threads))
+    for (int t = 1; t <= opts.threads; t++)
+    {
+      uint64_t stop = opts.start + opts.distance;
+      Result r = run(opts.start, stop, t, opts.repeat);
+      if (t == 1)
+        strong1 = r;
+      double efficiency = (r.seconds > 0) ? strong1.seconds / (t * r.seconds) : 0;
+      print(json, "strong", opts.start, t, r, efficiency, first);
+      first = false;
+    }
+
+    // weak scaling: efficiency = T(1) / T(threads)
+    for (int t = 1; t <= opts.threads; t++)
+    {
+      uint64_t stop = opts.start + opts.distance * t;
+      Result r = run(opts.start, stop, t, opts.repeat);
+      if (t == 1)
+        weak1 = r;
+      double efficiency = (r.seconds > 0) ? weak1.seconds / r.seconds : 0;
+      print(json, "weak", opts.start, t, r, efficiency, first);
+    }
+
+    json << "\n  ]\n}\n";
+    cout << json.str();
+  }
+  catch (exception& e)
+  {
+    cerr << "primesieve_scaling: " << e.what() << endl;
+    return 1;
+  }
+
+  return 0;
+}
@@ -27,6 +27,38 @@
  */
 #define PRIMESIEVE_ERROR ((uint64_t) ~((uint64_t) 0))
 
+/**
+ * Opaque handle used to cancel a long running computation,
+ * see primesieve_count_primes_cancellable().
+ */
+typedef struct primesieve_cancel_token primesieve_cancel_token;
+
+/**
+ * Opaque handle of a primesieve context which has its own
+ * settings, thread pool and caches. Different contexts of
+ * the same process do not share any mutable state.
+ */
+typedef struct primesieve_context primesieve_context;
+
+/**
+ * Callback of the asynchronous functions e.g.
+ * primesieve_count_primes_async(), it is called from one of
+ * primesieve's worker threads. If an error occurred result is
+ * PRIMESIEVE_ERROR and error is set to EDOM or ECANCELED,
+ * else error is 0.
+ */
+typedef void (*primesieve_callback)(uint64_t result, int error, void* data);
+
+/**
+ * Unsigned 128-bit integer returned by primesieve_sum_primes(),
+ * the sum of the primes below 2^64 does not fit into 64 bits.
+ */
+typedef struct
+{
+  uint64_t low;
+  uint64_t high;
+} primesieve_uint128;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -75,6 +107,60 @@ void* primesieve_generate_primes(uint64_t start, uint64_t stop, size_t* size, in
  */
 void* primesieve_generate_n_primes(uint64_t n, uint64_t start, int type);
 
+/**
+ * Store the primes inside the interval [start, stop] in the
+ * caller's buffer, at most size primes are stored. Unlike
+ * primesieve_generate_primes() no memory is allocated.
+ * If the buffer is full call this function again with
+ * start = last prime + 1, or use primesieve_fill_next_primes()
+ * which continues where the previous call stopped.
+ * @param written  Set to the number of primes stored.
+ * @param type     The type of the primes, e.g. INT_PRIMES.
+ * @return 1 if the buffer is full, 0 if all primes have
+ *         been stored, -1 if an error occurred.
+ */
+int primesieve_fill_primes(uint64_t start, uint64_t stop, void* primes, size_t size, size_t* written, int type);
+
+/**
+ * Get an array with the first member of each prime k-tuplet
+ * inside [start, stop], k = 2 for twin primes, ..., k = 6 for
+ * prime sextuplets. The returned array must be deallocated
+ * using primesieve_free().
+ * @param size  The number of tuplets of the returned array.
+ */
+uint64_t* primesieve_generate_tuplets(int k, uint64_t start, uint64_t stop, size_t* size);
+
+/**
+ * Store the first member of each prime k-tuplet inside the
+ * interval [start, stop] in the caller's buffer, at most size
+ * tuplets are stored. If the buffer is full call this function
+ * again with start = last tuplet + 1.
+ * @param written  Set to the number of tuplets stored.
+ * @return 1 if the buffer is full, 0 if all tuplets have
+ *         been stored, -1 if an error occurred.
+ */
+int primesieve_fill_tuplets(int k, uint64_t start, uint64_t stop, uint64_t* tuplets, size_t size, size_t* written);
+
+/**
+ * Get an array with the primes p inside [start, stop] for which
+ * p, 2p + 1, 4p + 3, ... (length members) are all prime, i.e.
+ * the Cunningham chains of the first kind, length = 2 for the
+ * Sophie Germain primes. The returned array must be
+ * deallocated using primesieve_free().
+ * @param size  The number of primes of the returned array.
+ */
+uint64_t* primesieve_generate_cunningham_chains(int length, uint64_t start, uint64_t stop, size_t* size);
+
+/**
+ * Store the primes inside the interval [start, stop] in a binary
+ * file as an array of the given type (native-endian), the file
+ * may be larger than the available memory.
+ * @param type  The type of the primes, e.g. UINT64_PRIMES.
+ * @return The number of primes, or PRIMESIEVE_ERROR if an
+ *         error occurred.
+ */
+uint64_t primesieve_generate_primes_to_file(uint64_t start, uint64_t stop, const char* filename, int type);
+
 /**
  * Find the nth prime.
  * By default all CPU cores are used, use
@@ -86,6 +172,21 @@ void* primesieve_generate_n_primes(uint64_t n, uint64_t start, int type);
  */
 uint64_t primesieve_nth_prime(int64_t n, uint64_t start);
 
+/**
+ * Returns 1 if n is prime, else 0. Small n are looked up
+ * in a cached sieve bitmap, large n are tested using the
+ * deterministic Miller-Rabin test.
+ */
+int primesieve_is_prime(uint64_t n);
+
+/**
+ * Test the primality of many numbers, results[i] is set
+ * to 1 if numbers[i] is prime, else 0. Batches with many
+ * nearby numbers are sieved. In case an error occurs
+ * errno is set to EDOM and all results are set to 0.
+ */
+void primesieve_is_prime_batch(const uint64_t* numbers, size_t size, int* results);
+
 /**
  * Count the primes within the interval [start, stop]. 
  * By default all CPU cores are used, use
@@ -94,6 +195,146 @@ uint64_t primesieve_nth_prime(int64_t n, uint64_t start);
  */
 uint64_t primesieve_count_primes(uint64_t start, uint64_t stop);
 
+/**
+ * Count the primes within many intervals, counts[i] is set to
+ * the number of primes inside [starts[i], stops[i]]. Nearby
+ * intervals are counted in a single sieve sweep. In case an
+ * error occurs errno is set to EDOM and all counts are set
+ * to PRIMESIEVE_ERROR.
+ */
+void primesieve_count_primes_batch(const uint64_t* starts, const uint64_t* stops, size_t size, uint64_t* counts);
+
+/**
+ * Count the prime constellations n + offsets[i] whose primes are
+ * all inside [start, stop] e.g. offsets = {0, 4} counts cousin
+ * primes. The offsets must be increasing and start with 0.
+ * In case an error occurs errno is set to EDOM and
+ * PRIMESIEVE_ERROR is returned.
+ */
+uint64_t primesieve_count_constellations(uint64_t start, uint64_t stop, const uint64_t* offsets, size_t size);
+
+/**
+ * Count the primes inside each bin [start + i * width,
+ * start + (i + 1) * width - 1] of the interval [start, stop]
+ * in a single sieving pass. The returned array must be
+ * deallocated using primesieve_free().
+ * @param size  The number of bins of the returned array.
+ */
+uint64_t* primesieve_count_primes_bins(uint64_t start, uint64_t stop, uint64_t width, size_t* size);
+
+/**
+ * Count the primes p % q == a inside [start, stop] for all
+ * residues a < q in a single sieving pass. The returned array
+ * must be deallocated using primesieve_free().
+ * @param size  The number of residues of the returned array (q).
+ */
+uint64_t* primesieve_count_primes_mod(uint64_t start, uint64_t stop, uint64_t q, size_t* size);
+
+/**
+ * Sum of the primes inside [start, stop], the primes are summed
+ * up in the sieving pass using all CPU cores by default.
+ * In case an error occurs errno is set to EDOM and
+ * low = high = PRIMESIEVE_ERROR is returned.
+ */
+primesieve_uint128 primesieve_sum_primes(uint64_t start, uint64_t stop);
+
+/**
+ * Sum of the squares of the primes inside [start, stop].
+ * In case an error occurs e.g. the sum is >= 2^128, errno is
+ * set to EDOM and low = high = PRIMESIEVE_ERROR is returned.
+ */
+primesieve_uint128 primesieve_sum_prime_squares(uint64_t start, uint64_t stop);
+
+/**
+ * Same as primesieve_nth_prime() but the computation stops
+ * once the token is cancelled, in this case errno is set to
+ * ECANCELED and PRIMESIEVE_ERROR is returned.
+ */
+uint64_t primesieve_nth_prime_cancellable(int64_t n, uint64_t start, const primesieve_cancel_token* token);
+
+/**
+ * Same as primesieve_count_primes() but the computation stops
+ * once the token is cancelled, in this case errno is set to
+ * ECANCELED and PRIMESIEVE_ERROR is returned.
+ */
+uint64_t primesieve_count_primes_cancellable(uint64_t start, uint64_t stop, const primesieve_cancel_token* token);
+
+/**
+ * Find the nth prime asynchronously, the computation is queued
+ * on primesieve's thread pool and the function returns
+ * immediately. Once finished callback(result, error, data) is
+ * called. The token may be NULL.
+ * @return 0 on success, -1 if the computation could not be queued.
+ */
+int primesieve_nth_prime_async(int64_t n, uint64_t start, const primesieve_cancel_token* token, primesieve_callback callback, void* data);
+
+/**
+ * Count the primes within the interval [start, stop]
+ * asynchronously, the computation is queued on primesieve's
+ * thread pool and the function returns immediately. Once
+ * finished callback(result, error, data) is called.
+ * The token may be NULL.
+ * @return 0 on success, -1 if the computation could not be queued.
+ */
+int primesieve_count_primes_async(uint64_t start, uint64_t stop, const primesieve_cancel_token* token, primesieve_callback callback, void* data);
+
+/**
+ * Create a cancel token, must be freed using
+ * primesieve_free_cancel_token(). Returns NULL on error.
+ */
+primesieve_cancel_token* primesieve_create_cancel_token();
+
+/**
+ * Cancel the computations using the token,
+ * may be called from any thread.
+ */
+void primesieve_cancel(primesieve_cancel_token* token);
+
+/**
+ * Cancel the computations using the token once the
+ * timeout (in seconds from now) has passed.
+ */
+void primesieve_set_deadline(primesieve_cancel_token* token, double seconds);
+
+/** Deallocate a cancel token */
+void primesieve_free_cancel_token(primesieve_cancel_token* token);
+
+/**
+ * Create a context, must be freed using
+ * primesieve_free_context(). Returns NULL on error.
+ */
+primesieve_context* primesieve_create_context();
+
+/**
+ * Deallocate a context, this waits until the
+ * queued computations of the context have finished.
+ */
+void primesieve_free_context(primesieve_context* ctx);
+
+/** Get the current set sieve size in KiB of the context */
+int primesieve_context_get_sieve_size(primesieve_context* ctx);
+
+/** Get the current set number of threads of the context */
+int primesieve_context_get_num_threads(primesieve_context* ctx);
+
+/**
+ * Set the sieve size in KiB of the context.
+ * @pre sieve_size >= 8 && <= 8192.
+ */
+void primesieve_context_set_sieve_size(primesieve_context* ctx, int sieve_size);
+
+/** Set the number of threads of the context */
+void primesieve_context_set_num_threads(primesieve_context* ctx, int num_threads);
+
+/** Same as primesieve_nth_prime() using the context */
+uint64_t primesieve_context_nth_prime(primesieve_context* ctx, int64_t n, uint64_t start);
+
+/** Same as primesieve_count_primes() using the context */
+uint64_t primesieve_context_count_primes(primesieve_context* ctx, uint64_t start, uint64_t stop);
+
+/** Same as primesieve_count_twins() using the context */
+uint64_t primesieve_context_count_twins(primesieve_context* ctx, uint64_t start, uint64_t stop);
+
 /**
  * Count the twin primes within the interval [start, stop]. 
  * By default all CPU cores are used, use
@@ -134,6 +375,15 @@ uint64_t primesieve_count_quintuplets(uint64_t start, uint64_t stop);
  */
 uint64_t primesieve_count_sextuplets(uint64_t start, uint64_t stop);
 
+/**
+ * Count the primes p within the interval [start, stop] for
+ * which p, 2p + 1, 4p + 3, ... (length members) are all prime.
+ * By default all CPU cores are used, use
+ * primesieve_set_num_threads(int threads) to change the
+ * number of threads.
+ */
+uint64_t primesieve_count_cunningham_chains(int length, uint64_t start, uint64_t stop);
+
 /**
  * Print the primes within the interval [start, stop]
  * to the standard output.
@@ -182,11 +432,30 @@ int primesieve_get_sieve_size();
 /** Get the current set number of threads */
 int primesieve_get_num_threads();
 
+/**
+ * Set the priority of the computations started by the calling
+ * thread, a thread-local setting (default 0). Computations
+ * with a higher priority get the worker threads first,
+ * computations of the same priority share them fairly.
+ */
+void primesieve_set_priority(int priority);
+
+/** Get the priority of the calling thread's computations */
+int primesieve_get_priority();
+
+/**
+ * Get the number of CPUs available to this process, this is
+ * the default and the maximum number of threads. It honours
+ * the CPU affinity, cgroup CPU quotas (e.g. Docker and
+ * Kubernetes) and Windows job object limits.
+ */
+int primesieve_get_max_threads();
+
 /**
  * Set the sieve size in KiB (kibibyte).
  * The best sieving performance is achieved with a sieve size
  * of your CPU's L1 or L2 cache size (per core).
- * @pre sieve_size >= 8 && <= 4096.
+ * @pre sieve_size >= 8 && <= 8192.
  */
 void primesieve_set_sieve_size(int sieve_size);
 
@@ -197,6 +466,82 @@ void primesieve_set_sieve_size(int sieve_size);
  */
 void primesieve_set_num_threads(int num_threads);
 
+/** Get the current set memory limit in bytes, 0 = unlimited */
+uint64_t primesieve_get_memory_limit();
+
+/**
+ * Limit the memory usage (in bytes) of primesieve_count_*()
+ * and primesieve_nth_prime(). The number of threads (and if
+ * needed the sieve size) is reduced so that the estimated
+ * memory usage stays within the limit.
+ * By default there is no limit.
+ */
+void primesieve_set_memory_limit(uint64_t bytes);
+
+/** Get the current set iterator memory limit in bytes */
+uint64_t primesieve_get_iterator_memory_limit();
+
+/**
+ * Limit the size (in bytes) of the prime buffer of each
+ * primesieve_iterator, primesieve_prev_prime() buffers the
+ * primes of a whole interval which by default may grow up
+ * to 1 GiB. 0 restores the default.
+ */
+void primesieve_set_iterator_memory_limit(uint64_t bytes);
+
+/** Get the current set iterator growth factor */
+int primesieve_get_iterator_growth();
+
+/**
+ * primesieve_iterator multiplies its sieving distance by
+ * factor (default 4) after each refill, a smaller factor
+ * reduces the memory usage but increases the number of
+ * sieving passes. @pre factor >= 1 && <= 64.
+ */
+void primesieve_set_iterator_growth(int factor);
+
+/** Get whether primesieve_iterator compresses its prev_prime buffer (0 or 1) */
+int primesieve_get_iterator_compression();
+
+/**
+ * If enabled primesieve_prev_prime() stores the primes of each
+ * interval as gaps (about 1 byte per prime instead of 8 bytes)
+ * and decodes them in small blocks. This reduces the memory
+ * usage of backward iteration about 8 times. Disabled by default.
+ */
+void primesieve_set_iterator_compression(int enable);
+
+/** Get whether the worker threads are pinned to CPUs (0 or 1) */
+int primesieve_get_pin_threads();
+
+/**
+ * Pin the worker threads of primesieve's thread pool to CPUs.
+ * The threads are spread evenly across the NUMA nodes and each
+ * thread allocates its sieving memory on its local NUMA node,
+ * this improves scaling on multi-socket systems.
+ * Currently only supported on Linux. By default threads are
+ * not pinned.
+ */
+void primesieve_set_pin_threads(int pin);
+
+/**
+ * Stop the worker threads of primesieve's thread pool.
+ * The multi-threaded functions e.g. primesieve_count_primes()
+ * run on a process-wide pool of worker threads which is started
+ * lazily and reused by all subsequent function calls. After
+ * shutting it down the pool is restarted automatically
+ * when it is needed again.
+ */
+void primesieve_shutdown_thread_pool();
+
+/**
+ * Free the memory cached by primesieve's threads. Each thread
+ * keeps the sieve arrays and buckets freed by the current
+ * computation for reuse by its next chunk, the cache of the
+ * thread pool is freed when the computation ends.
+ */
+void primesieve_release_memory();
+
 /**
  * Deallocate a primes array created using the
  * primesieve_generate_primes() or primesieve_generate_n_primes()
@@ -17,13 +17,29 @@
 #define PRIMESIEVE_VERSION_MAJOR 7
 #define PRIMESIEVE_VERSION_MINOR 1
 
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/context.hpp>
+#include <primesieve/factor_table.hpp>
 #include <primesieve/iterator.hpp>
+#include <primesieve/prefetch_iterator.hpp>
+#include <primesieve/prime_archive.hpp>
+#include <primesieve/prime_monitor.hpp>
+#include <primesieve/prime_queue.hpp>
+#include <primesieve/prime_stream.hpp>
+#include <primesieve/prime_table.hpp>
+#include <primesieve/primes_view.hpp>
 #include <primesieve/primesieve_error.hpp>
+#include <primesieve/sequence_sieve.hpp>
+#include <primesieve/sieve_bitmap.hpp>
 #include <primesieve/StorePrimes.hpp>
+#include <primesieve/uint128.hpp>
 
 #include <stdint.h>
+#include <cstddef>
+#include <future>
 #include <vector>
 #include <string>
+#include <utility>
 
 /// Contains primesieve's C++ functions and classes.
 namespace primesieve {
@@ -62,6 +78,54 @@ inline void generate_n_primes(uint64_t n, uint64_t start, std::vector<T>* primes
     store_n_primes(n, start, *primes);
 }
 
+/// Store the first member of each prime k-tuplet inside
+/// [start, stop] in the tuplets vector (in increasing order),
+/// k = 2 for twin primes, ..., k = 6 for prime sextuplets. The
+/// tuplets are sieved using multiple threads.
+///
+void generate_tuplets(int k, uint64_t start, uint64_t stop, std::vector<uint64_t>* tuplets);
+
+/// Store the twin primes inside [start, stop]
+/// in the twins vector.
+///
+void generate_twins(uint64_t start, uint64_t stop, std::vector<std::pair<uint64_t, uint64_t>>* twins);
+
+/// Store the first member of each prime k-tuplet inside
+/// [start, stop] in the caller's buffer, at most size
+/// tuplets are stored. If the buffer is full (returns true)
+/// call this function again with start = last tuplet + 1.
+/// @param written  Set to the number of tuplets stored.
+///
+bool fill_tuplets(int k, uint64_t start, uint64_t stop, uint64_t* tuplets, std::size_t size, std::size_t* written);
+
+/// Store the primes p inside [start, stop] for which
+/// p, 2p + 1, 4p + 3, ... (length members) are all prime in
+/// the primes vector (in increasing order). These are the
+/// Cunningham chains of the first kind, length = 2 are the
+/// Sophie Germain primes. The candidates are sieved using
+/// multiple threads.
+/// @pre 1 <= length <= 64
+///
+void generate_cunningham_chains(int length, uint64_t start, uint64_t stop, std::vector<uint64_t>* primes);
+
+/// Store the Sophie Germain primes p (2p + 1 is prime)
+/// inside [start, stop] in the primes vector.
+///
+void generate_sophie_germain_primes(uint64_t start, uint64_t stop, std::vector<uint64_t>* primes);
+
+/// Store the safe primes q ((q - 1) / 2 is prime)
+/// inside [start, stop] in the primes vector.
+///
+void generate_safe_primes(uint64_t start, uint64_t stop, std::vector<uint64_t>* primes);
+
+/// Store the primes inside [start, stop] in a binary file as an
+/// array of bytes sized (2, 4 or 8) native-endian unsigned integers,
+/// the file can later be memory mapped as an array. The file is
+/// written using multiple threads and it may be larger than the
+/// available memory. Returns the number of primes.
+///
+uint64_t generate_primes_to_file(uint64_t start, uint64_t stop, const std::string& filename, std::size_t bytes = 8);
+
 /// Find the nth prime.
 /// By default all CPU cores are used, use
 /// primesieve::set_num_threads(int threads) to change the
@@ -72,13 +136,114 @@ inline void generate_n_primes(uint64_t n, uint64_t start, std::vector<T>* primes
 ///
 uint64_t nth_prime(int64_t n, uint64_t start = 0);
 
+/// Find the nth prime, the computation can be stopped
+/// using the token, in which case a primesieve_cancelled
+/// exception is thrown.
+///
+uint64_t nth_prime(int64_t n, uint64_t start, const cancel_token& token);
+
+/// Returns true if n is prime. Small n are looked up in a
+/// cached sieve bitmap, large n are tested using the
+/// deterministic Miller-Rabin test.
+///
+bool is_prime(uint64_t n);
+
+/// Test the primality of many numbers, the result of numbers[i]
+/// is stored in results[i]. Batches with many nearby numbers
+/// are sieved which is faster than testing each number.
+///
+void is_prime(const uint64_t* numbers, std::size_t size, bool* results);
+
 /// Count the primes within the interval [start, stop].
 /// By default all CPU cores are used, use
 /// primesieve::set_num_threads(int threads) to change the
-/// number of threads.
+/// number of threads. Large intervals are not sieved, the
+/// primes are counted using the Lagarias-Miller-Odlyzko
+/// algorithm in O(stop^(2/3)) operations.
 ///
 uint64_t count_primes(uint64_t start, uint64_t stop);
 
+/// Count the primes within the interval [start, stop], the
+/// computation can be stopped using the token, in which
+/// case a primesieve_cancelled exception is thrown.
+///
+uint64_t count_primes(uint64_t start, uint64_t stop, const cancel_token& token);
+
+/// Count the primes within many intervals, counts[i] is set
+/// to the number of primes inside [starts[i], stops[i]].
+/// Nearby intervals are counted in a single sieve sweep,
+/// this is much faster than one count_primes() call per
+/// interval if the intervals are small.
+///
+void count_primes_batch(const uint64_t* starts,
+                        const uint64_t* stops,
+                        std::size_t size,
+                        uint64_t* counts);
+
+/// Count the prime constellations n + offsets[i] whose primes
+/// are all inside [start, stop] e.g. offsets = {0, 4} counts
+/// cousin primes, {0, 6} sexy primes and {0, 2, 6, 8, 12, 18,
+/// 20, 26} prime 8-tuplets. The offsets must be increasing and
+/// start with 0. By default all CPU cores are used.
+///
+uint64_t count_constellations(uint64_t start, uint64_t stop, const std::vector<uint64_t>& offsets);
+
+/// Count the primes inside each bin [start + i * width,
+/// start + (i + 1) * width - 1] of the interval [start, stop]
+/// (the last bin may be smaller). All bins are counted in a
+/// single multi-threaded sieving pass.
+///
+std::vector<uint64_t> count_primes_bins(uint64_t start, uint64_t stop, uint64_t width);
+
+/// Count the primes p % q == a inside [start, stop] for all
+/// residues a < q i.e. counts[a] = number of such primes.
+/// All residue classes are counted in a single multi-threaded
+/// sieving pass. q must be > 0 and <= 2^30.
+///
+std::vector<uint64_t> count_primes_mod(uint64_t start, uint64_t stop, uint64_t q);
+
+/// Sum of the primes inside [start, stop]. The primes are
+/// summed up from the sieve array in the sieving pass (using
+/// 128-bit accumulators) hence this is about as fast as
+/// count_primes(). By default all CPU cores are used.
+///
+uint128 sum_primes(uint64_t start, uint64_t stop);
+
+/// Sum of the squares of the primes inside [start, stop].
+/// @pre The sum must be < 2^128, else a primesieve_error
+///      exception is thrown.
+///
+uint128 sum_prime_squares(uint64_t start, uint64_t stop);
+
+/// Find the nth prime asynchronously. The computation is queued
+/// on primesieve's thread pool and the function returns
+/// immediately. The current sieve size and number of threads
+/// settings are used.
+///
+std::future<uint64_t> nth_prime_async(int64_t n, uint64_t start = 0);
+
+/// Same as above, the token must remain valid
+/// until the computation has finished.
+///
+std::future<uint64_t> nth_prime_async(int64_t n, uint64_t start, const cancel_token& token);
+
+/// Count the primes within the interval [start, stop]
+/// asynchronously. The computation is queued on primesieve's
+/// thread pool and the function returns immediately. The
+/// current sieve size and number of threads settings are used.
+///
+std::future<uint64_t> count_primes_async(uint64_t start, uint64_t stop);
+
+/// Same as above, the token must remain valid
+/// until the computation has finished.
+///
+std::future<uint64_t> count_primes_async(uint64_t start, uint64_t stop, const cancel_token& token);
+
+/// Count the twin primes within the interval [start, stop]
+/// asynchronously, see count_primes_async().
+///
+std::future<uint64_t> count_twins_async(uint64_t start, uint64_t stop);
+
 /// Count the twin primes within the interval [start, stop].
 /// By default all CPU cores are used, use
 /// primesieve::set_num_threads(int threads) to change the
@@ -114,8 +279,28 @@ uint64_t count_quintuplets(uint64_t start, uint64_t stop);
 ///
 uint64_t count_sextuplets(uint64_t start, uint64_t stop);
 
+/// Count the primes p within the interval [start, stop] for
+/// which p, 2p + 1, 4p + 3, ... (length members) are all prime.
+/// By default all CPU cores are used, use
+/// primesieve::set_num_threads(int threads) to change the
+/// number of threads.
+/// @pre 1 <= length <= 64
+///
+uint64_t count_cunningham_chains(int length, uint64_t start, uint64_t stop);
+
+/// Count the Sophie Germain primes p (2p + 1 is prime)
+/// within the interval [start, stop].
+///
+uint64_t count_sophie_germain_primes(uint64_t start, uint64_t stop);
+
+/// Count the safe primes q ((q - 1) / 2 is prime)
+/// within the interval [start, stop].
+///
+uint64_t count_safe_primes(uint64_t start, uint64_t stop);
+
 /// Print the primes within the interval [start, stop]
-/// to the standard output.
+/// to the standard output. The primes are sieved using
+/// multiple threads and printed in increasing order.
 ///
 void print_primes(uint64_t start, uint64_t stop);
 
@@ -155,19 +340,226 @@ int get_sieve_size();
 /// Get the current set number of threads.
 int get_num_threads();
 
+/// Get the number of CPUs available to this process, this is
+/// the default and the maximum number of threads. It honours
+/// the CPU affinity, cgroup CPU quotas (e.g. Docker and
+/// Kubernetes) and Windows job object limits.
+///
+int get_max_threads();
+
 /// Set the sieve size in KiB (kibibyte).
 /// The best sieving performance is achieved with a sieve size
 /// of your CPU's L1 or L2 cache size (per core).
-/// @pre sieve_size >= 8 && <= 4096.
+/// @pre sieve_size >= 8 && <= 8192.
 ///
 void set_sieve_size(int sieve_size);
 
+/// Set the priority of the computations started by the calling
+/// thread, a thread-local setting (default 0). Concurrent
+/// computations share the worker threads of the thread pool:
+/// computations with a higher priority are executed first,
+/// computations of the same priority get an equal share of the
+/// workers, i.e. a large computation yields workers to smaller
+/// ones after its current chunk of work.
+///
+void set_priority(int priority);
+
+/// Get the priority of the calling thread's computations.
+int get_priority();
+
 /// Set the number of threads for use in
 /// primesieve::count_*() and primesieve::nth_prime().
 /// By default all CPU cores are used.
 ///
 void set_num_threads(int num_threads);
 
+/// Get the current set memory limit in bytes, 0 = unlimited.
+uint64_t get_memory_limit();
+
+/// Limit the memory usage (in bytes) of primesieve::count_*()
+/// and primesieve::nth_prime(). The memory usage grows
+/// linearly with the number of threads, hence the number of
+/// threads (and if needed the sieve size) is reduced so that
+/// the estimated memory usage stays within the limit. The
+/// sieving primes up to sqrt(stop) are always needed, so very
+/// small limits (e.g. stop near 2^64 and less than 2 GiB)
+/// cannot be met. By default there is no limit.
+///
+void set_memory_limit(uint64_t bytes);
+
+/// Get the current set iterator memory limit in bytes.
+uint64_t get_iterator_memory_limit();
+
+/// Limit the size (in bytes) of the prime buffer of each
+/// primesieve::iterator, prev_prime() buffers the primes of
+/// a whole interval which by default may grow up to 1 GiB.
+/// Smaller limits require more (smaller) sieving passes.
+/// 0 restores the default.
+///
+void set_iterator_memory_limit(uint64_t bytes);
+
+/// Get the current set iterator growth factor.
+int get_iterator_growth();
+
+/// primesieve::iterator multiplies its sieving distance by
+/// factor (default 4) after each refill, a smaller factor
+/// reduces the memory usage but increases the number of
+/// sieving passes. @pre factor >= 1 && <= 64.
+///
+void set_iterator_growth(int factor);
+
+/// Get whether primesieve::iterator compresses its
+/// prev_prime() buffer.
+///
+bool get_iterator_compression();
+
+/// If enabled prev_prime() stores the primes of each interval
+/// as gaps (about 1 byte per prime instead of 8 bytes) and
+/// decodes them in small blocks. This reduces the memory
+/// usage of backward iteration about 8 times at the cost of
+/// a little decoding work. Disabled by default.
+///
+void set_iterator_compression(bool enable);
+
+/// Get whether the worker threads are pinned to CPUs.
+bool get_pin_threads();
+
+/// Pin the worker threads of primesieve's thread pool to CPUs.
+/// The threads are spread evenly across the NUMA nodes and each
+/// thread allocates its sieving memory on its local NUMA node,
+/// this improves scaling on multi-socket systems.
+/// Currently only supported on Linux. By default threads are
+/// not pinned.
+///
+void set_pin_threads(bool pin);
+
+/// Stop the worker threads of primesieve's thread pool.
+/// The multi-threaded functions e.g. primesieve::count_primes()
+/// run on a process-wide pool of worker threads which is started
+/// lazily and reused by all subsequent function calls. After
+/// shutting it down the pool is restarted automatically
+/// when it is needed again.
+///
+void shutdown_thread_pool();
+
+/// Free the memory cached by primesieve's threads. Each thread
+/// keeps the sieve arrays and buckets freed by the current
+/// computation for reuse by its next chunk, the cache of the
+/// thread pool is freed when the computation ends. The workers
+/// of a primesieve::context keep their cache between the calls,
+/// long-running programs may free it using release_memory().
+///
+void release_memory();
+
+/// Write the table of prime counts pi(k * dist) for
+/// k * dist <= stop to a file, e.g. dist = 10^9. The primes
+/// are counted using multiple threads.
+///
+void write_pi_table(const std::string& filename, uint64_t stop, uint64_t dist);
+
+/// Load a table written by write_pi_table(), subsequent
+/// primesieve::count_primes() and primesieve::nth_prime(n)
+/// calls only sieve from the nearest table entry. The file
+/// is memory mapped (if supported by the OS).
+///
+void load_pi_table(const std::string& filename);
+
+/// Stop using the table loaded by load_pi_table()
+void unload_pi_table();
+
+/// Write the sieving primes <= stop (default 2^32, enough
+/// for sieving up to 2^64) to a sieving cache file.
+///
+void write_sieving_cache(const std::string& filename, uint64_t stop = 1ull << 32);
+
+/// Memory map a file written by write_sieving_cache(), all
+/// subsequent sieves and iterators read their sieving primes
+/// from the file instead of sieving them. The file is mapped
+/// read-only, hence the pages are shared by all processes
+/// using the same file.
+///
+void load_sieving_cache(const std::string& filename);
+
+/// Stop using the file loaded by load_sieving_cache()
+void unload_sieving_cache();
+
+struct segment_cache_stats
+{
+  uint64_t hits;
+  uint64_t misses;
+};
+
+/// Keep up to bytes of sieved segments in memory, the least
+/// recently used segments are evicted. Counting or generating
+/// primes of an already sieved range again (with the same
+/// start number and sieve size) reads the segments from the
+/// cache instead of sieving them. 0 (default) disables the
+/// cache and frees its memory.
+///
+void set_segment_cache_size(uint64_t bytes);
+
+/// Number of segments read from the segment cache (hits)
+/// and segments that were not found in the cache (misses)
+///
+segment_cache_stats get_segment_cache_stats();
+
+struct count_cache_stats
+{
+  uint64_t hits;
+  uint64_t misses;
+};
+
+/// Keep the counts of up to bytes / 128 chunks of ~ 1.26 * 10^8
+/// numbers in memory, the least recently used chunks are evicted.
+/// The count_*() functions store the counts of each chunk they
+/// sieve, later counts of overlapping or extended intervals
+/// reuse the cached chunks and only sieve the remaining
+/// numbers. 0 (default) disables the cache and frees its memory.
+///
+void set_count_cache_size(uint64_t bytes);
+
+/// Number of chunks read from the count cache (hits)
+/// and chunks that were not found in the cache (misses)
+///
+count_cache_stats get_count_cache_stats();
+
+/// Hot path counters summed over all threads, the
+/// arrays are indexed by EratSmall (0), EratMedium (1)
+/// and EratBig (2).
+///
+struct sieve_counters
+{
+  /// Segments sieved, including the segments
+  /// sieved to generate the sieving primes
+  uint64_t segments;
+  /// Segments whose primes were counted or printed
+  uint64_t segments_consumed;
+  uint64_t sieving_primes[3];
+  /// Bits unset whilst crossing off multiples
+  uint64_t bits_unset[3];
+  /// Buckets taken from the stock of EratMedium, EratBig
+  uint64_t buckets_pushed[2];
+  /// Buckets allocated because the stock was empty
+  uint64_t buckets_allocated[2];
+  /// Processed buckets moved back to the stock
+  uint64_t buckets_recycled[2];
+};
+
+/// Returns true if primesieve has been built with
+/// hot path counters (cmake -DWITH_COUNTERS=ON)
+///
+bool has_sieve_counters();
+
+/// Get the hot path counters, all counters
+/// are 0 unless has_sieve_counters().
+///
+sieve_counters get_sieve_counters();
+
+/// Reset the hot path counters to 0,
+/// must not be called whilst sieving.
+///
+void reset_sieve_counters();
+
 /// Get the primesieve version number, in the form “i.j”.
 std::string primesieve_version();
 
@@ -0,0 +1,55 @@
+///
+/// @file  Affinity.hpp
+///        Pin threads to CPUs. Used by the ThreadPool to spread its
+///        worker threads evenly across the NUMA nodes so that the
+///        memory of each worker is allocated on its local node.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef AFFINITY_HPP
+#define AFFINITY_HPP
+
+#include <string>
+#include <vector>
+
+namespace primesieve {
+
+/// CPUs the calling thread is allowed to run on,
+/// empty if unsupported by the operating system.
+///
+std::vector<int> getAllowedCpus();
+
+/// Allowed CPUs ordered for thread pinning: the CPUs of the
+/// different NUMA nodes are interleaved, e.g. node0 cpu0,
+/// node1 cpu0, node0 cpu1, node1 cpu1, ... The SMT siblings
+/// come after the 1st hardware thread of all CPU cores, so
+/// the threads only share the caches of a CPU core if there
+/// are more threads than CPU cores.
+///
+std::vector<int> getCpuOrder();
+
+/// Restrict the calling thread to the given CPUs.
+/// @return false if unsupported or on failure.
+///
+bool setThreadAffinity(const std::vector<int>& cpus);
+
+/// CPU the calling thread is currently running on,
+/// -1 if unsupported by the operating system.
+///
+int getCurrentCpu();
+
+/// Number of CPUs available to the process: the online CPUs
+/// limited by the CPU affinity mask, the cgroup v1/v2 CPU
+/// quota (rounded up) and the Windows job object limits.
+/// @limit: Set to what limits the CPUs,
+///         e.g. "cgroup v2 cpu.max", empty if unlimited.
+///
+int getAvailableCpus(std::string& limit);
+
+} // namespace
+
+#endif
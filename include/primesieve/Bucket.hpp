@@ -27,6 +27,12 @@ namespace primesieve {
 /// usage the multipleIndex and wheelIndex are packed into a
 /// single 32-bit variable.
 ///
+/// 60 of the 64 bits are used: sievingPrime = prime / 30 < 2^28
+/// for primes < 2^32, multipleIndex < 2^23 (max sieve size and
+/// EratBig block size) and wheelIndex < 384 (Wheel210). The
+/// buckets are not sorted, hence encoding the sieving primes as
+/// deltas of a per bucket base would not save any bits either.
+///
 class SievingPrime
 {
 public:
@@ -97,6 +103,8 @@ private:
   uint32_t sievingPrime_;
 };
 
+static_assert(sizeof(SievingPrime) == 8, "8 sieving primes per 64-byte cache line");
+
 /// The Bucket data structure is used to store sieving primes.
 /// @see http://www.ieeta.pt/~tos/software/prime_sieve.html
 /// The Bucket class is designed as a singly linked list, once
@@ -0,0 +1,65 @@
+///
+/// @file  Checkpoint.hpp
+///        Checkpoint file of a long running ParallelSieve count.
+///        The finished pieces of [start, stop] and their counts
+///        are written to the file periodically, if the process
+///        is killed ParallelSieve resumes the unfinished pieces
+///        when it is run again with the same checkpoint file.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "PrimeSieve.hpp"
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace primesieve {
+
+class Checkpoint
+{
+public:
+  /// @seconds: Minimum time between 2 writes of the file
+  Checkpoint(const std::string& filename, double seconds = 60);
+  /// Load the checkpoint file if it exists, it must
+  /// belong to the same start, stop and count flags.
+  ///
+  void init(uint64_t start, uint64_t stop, int flags);
+  /// Record the finished piece [low, high]
+  void add(uint64_t low, uint64_t high, const counts_t& counts);
+  /// Sum of the counts of the finished pieces
+  counts_t getCounts() const;
+  /// Unfinished intervals of [start, stop]
+  std::vector<std::pair<uint64_t, uint64_t>> remaining() const;
+  void save();
+private:
+  struct Piece
+  {
+    uint64_t low;
+    uint64_t high;
+    counts_t counts;
+  };
+  std::string filename_;
+  double seconds_;
+  uint64_t start_ = 0;
+  uint64_t stop_ = 0;
+  int flags_ = 0;
+  std::vector<Piece> pieces_;
+  std::chrono::steady_clock::time_point lastSave_;
+  mutable std::mutex lock_;
+  void write() const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,84 @@
+///
+/// @file  ChunkScheduler.hpp
+///        Work-stealing scheduler used by ParallelSieve to
+///        distribute the chunks of the interval [start, stop]
+///        to the threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CHUNKSCHEDULER_HPP
+#define CHUNKSCHEDULER_HPP
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace primesieve {
+
+/// The interval [start, stop] is initially split into one large
+/// contiguous span per thread. Each thread sieves its own span
+/// in one go, i.e. the sieving state is kept across all segments
+/// of the span. Before sieving a segment the thread claims it
+/// using claim(). When a thread runs out of work it steals the
+/// upper half of the unclaimed part of the span with most work
+/// left, which shrinks the stop number of the victim thread.
+/// Hence the sieving state is only initialized at steal points
+/// and the load is still well balanced near the end.
+///
+class ChunkScheduler
+{
+public:
+  ChunkScheduler(uint64_t start, uint64_t stop, int threads, uint64_t minDist);
+  ChunkScheduler(uint64_t start, uint64_t stop, const std::vector<double>& weights, uint64_t minDist);
+  /// Get the next span [*start, *stop] of the calling thread,
+  /// calling next() again marks the previous span as finished.
+  /// @span: Span of the calling thread, initialize to -1.
+  /// @weight: Relative speed of the calling thread's core.
+  /// @return false if there is no work left.
+  ///
+  bool next(int* span, uint64_t* start, uint64_t* stop, double weight = 1.0);
+  /// Claim the numbers <= high of our span that are about to
+  /// be sieved, these cannot be stolen anymore.
+  /// @return The current stop number of our span which
+  ///         may have been decreased by other threads.
+  ///
+  uint64_t claim(int span, uint64_t high);
+  /// Mark our previous span as finished and give it up,
+  /// used by threads that stop early. A thread that
+  /// starts later adopts it and steals work.
+  ///
+  void release(int span);
+  /// Split [start, stop] into up to parts contiguous ranges
+  /// of at least minDist, aligned like the spans. Used to
+  /// distribute [start, stop] to multiple processes.
+  ///
+  static std::vector<std::pair<uint64_t, uint64_t>>
+  split(uint64_t start, uint64_t stop, uint64_t parts, uint64_t minDist);
+private:
+  struct Span
+  {
+    std::mutex lock;
+    uint64_t start = 0;
+    uint64_t stop = 0;
+    bool empty = true;
+    bool owned = false;
+    double weight = 1.0;
+  };
+  uint64_t stop_;
+  uint64_t minDist_;
+  int threads_;
+  std::unique_ptr<Span[]> spans_;
+  uint64_t align(uint64_t) const;
+  bool adopt(int*, bool, double);
+  bool steal(int);
+};
+
+} // namespace
+
+#endif
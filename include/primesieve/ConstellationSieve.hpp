@@ -0,0 +1,93 @@
+///
+/// @file   ConstellationSieve.hpp
+/// @brief  Count the prime constellations n + offsets[i] (e.g.
+///         cousin primes {0, 4}, sexy primes {0, 6}, prime
+///         8-tuplets {0, 2, 6, 8, 12, 18, 20, 26}) whose primes
+///         span multiple bytes of the sieve array and multiple
+///         segments.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef CONSTELLATIONSIEVE_HPP
+#define CONSTELLATIONSIEVE_HPP
+
+#include "Erat.hpp"
+#include "PreSieve.hpp"
+#include "types.hpp"
+
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+namespace primesieve {
+
+class SievingTable;
+
+/// A constellation compiled into byte offsets and bits of the
+/// sieve array, for each of the 8 bits (residues mod 30) of
+/// the smallest prime n.
+///
+class Constellation
+{
+public:
+  /// @pre offsets are sorted, offsets[0] = 0
+  Constellation(const std::vector<uint64_t>& offsets);
+  const std::vector<uint64_t>& offsets() const { return offsets_; }
+  uint64_t maxOffset() const { return offsets_.back(); }
+  /// Max byte distance of the last prime from n
+  uint64_t maxBytes() const { return maxBytes_; }
+
+  /// n + offsets[i] is inside byte + bytes of bit
+  struct Term
+  {
+    uint64_t bytes;
+    int bit;
+  };
+
+  /// Terms of n = 30 * k + bitValue(bit), empty if
+  /// n + offsets[i] cannot all be coprime to 30
+  ///
+  const std::vector<Term>& terms(int bit) const { return terms_[bit]; }
+
+private:
+  std::vector<uint64_t> offsets_;
+  std::array<std::vector<Term>, 8> terms_;
+  uint64_t maxBytes_ = 0;
+};
+
+class ConstellationSieve : public Erat
+{
+public:
+  /// Count the n inside [start, maxN] with
+  /// n + offsets[i] prime and <= stop
+  ///
+  ConstellationSieve(uint64_t start,
+                     uint64_t maxN,
+                     uint64_t stop,
+                     int sieveSize,
+                     const Constellation&,
+                     const SievingTable* = nullptr);
+  uint64_t count();
+
+private:
+  uint64_t minN_;
+  uint64_t maxN_;
+  const Constellation& constellation_;
+  const SievingTable* sievingTable_;
+  PreSieve preSieve_;
+  /// Unprocessed bytes of the previous segments
+  /// followed by the current segment
+  std::vector<byte_t> buffer_;
+  /// Number of buffer_[0] (minus its bit values)
+  uint64_t bufferLow_ = 0;
+  std::vector<uint64_t> matches_;
+  uint64_t countBuffer(uint64_t bytes);
+};
+
+} // namespace
+
+#endif
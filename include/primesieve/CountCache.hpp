@@ -0,0 +1,74 @@
+///
+/// @file  CountCache.hpp
+/// @brief Process-wide LRU cache of the prime and prime k-tuplet
+///        counts of aligned chunks. ParallelSieve stores the
+///        counts of each chunk it sieves (if the cache is enabled)
+///        and assembles the counts of later intervals from the
+///        cached chunks, only the edges of the interval and the
+///        chunks that are not cached are sieved.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef COUNTCACHE_HPP
+#define COUNTCACHE_HPP
+
+#include "PrimeSieve.hpp"
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace primesieve {
+
+class CountCache
+{
+public:
+  /// Chunk i = [i * COUNT_CACHE_CHUNK + 3, (i + 1) * COUNT_CACHE_CHUNK + 2],
+  /// chunk 0 starts at 0. The bounds are aligned to 30 + 2 so
+  /// that no prime k-tuplet crosses them, hence the counts of
+  /// adjacent chunks add up.
+  ///
+  static uint64_t chunkLow(uint64_t chunk);
+  static uint64_t chunkHigh(uint64_t chunk);
+  /// Index of the first chunk whose low >= n
+  static uint64_t firstChunk(uint64_t n);
+  /// Number of chunks whose high <= n
+  static uint64_t chunks(uint64_t n);
+  bool enabled() const { return maxSize_ > 0; }
+  uint64_t getHits() const { return hits_; }
+  uint64_t getMisses() const { return misses_; }
+  void setMaxSize(uint64_t bytes);
+  /// @countFlags: The COUNT_* flags of the needed counts,
+  ///              the other counts are not modified.
+  bool get(uint64_t chunk, int countFlags, counts_t& counts);
+  void put(uint64_t chunk, int countFlags, const counts_t& counts);
+private:
+  struct Entry
+  {
+    uint64_t chunk;
+    /// COUNT_* flags of the valid counts
+    int countFlags;
+    counts_t counts;
+  };
+  std::mutex mutex_;
+  /// Most recently used chunk first
+  std::list<Entry> lru_;
+  std::unordered_map<uint64_t, std::list<Entry>::iterator> index_;
+  uint64_t size_ = 0;
+  std::atomic<uint64_t> maxSize_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  void evict(uint64_t maxSize);
+};
+
+CountCache& countCache();
+
+} // namespace
+
+#endif
@@ -0,0 +1,67 @@
+///
+/// @file  Counters.hpp
+///        Hot path counters (segments, sieving primes, unset
+///        bits and buckets) used to quantify tuning changes.
+///        The counters are only compiled in if primesieve is
+///        built with -DWITH_COUNTERS=ON (PRIMESIEVE_COUNTERS),
+///        else PRIMESIEVE_COUNT() expands to nothing.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef COUNTERS_HPP
+#define COUNTERS_HPP
+
+#include <stdint.h>
+#include <atomic>
+
+namespace primesieve {
+
+/// Same order as the fields of primesieve::sieve_counters
+enum Counter
+{
+  COUNTER_SEGMENTS,
+  COUNTER_SEGMENTS_CONSUMED,
+  COUNTER_SIEVING_PRIMES_SMALL,
+  COUNTER_SIEVING_PRIMES_MEDIUM,
+  COUNTER_SIEVING_PRIMES_BIG,
+  COUNTER_BITS_UNSET_SMALL,
+  COUNTER_BITS_UNSET_MEDIUM,
+  COUNTER_BITS_UNSET_BIG,
+  COUNTER_BUCKETS_PUSHED_MEDIUM,
+  COUNTER_BUCKETS_PUSHED_BIG,
+  COUNTER_BUCKETS_ALLOCATED_MEDIUM,
+  COUNTER_BUCKETS_ALLOCATED_BIG,
+  COUNTER_BUCKETS_RECYCLED_MEDIUM,
+  COUNTER_BUCKETS_RECYCLED_BIG,
+  COUNTERS
+};
+
+#if defined(PRIMESIEVE_COUNTERS)
+
+/// Counters of the calling thread, only written
+/// by this thread (without any locking)
+///
+std::atomic<uint64_t>* threadCounters();
+
+inline void addCounter(Counter counter, uint64_t n)
+{
+  std::atomic<uint64_t>& c = threadCounters()[counter];
+  c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+#define PRIMESIEVE_COUNT(counter, n) \
+  primesieve::addCounter(primesieve::counter, n)
+
+#else
+
+#define PRIMESIEVE_COUNT(counter, n) ((void) 0)
+
+#endif
+
+} // namespace
+
+#endif
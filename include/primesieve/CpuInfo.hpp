@@ -13,9 +13,23 @@
 #include <cstddef>
 #include <string>
 #include <array>
+#include <vector>
 
 namespace primesieve {
 
+/// CPU cores of the same type e.g. the performance
+/// cores or the efficiency cores of a hybrid CPU
+///
+struct CoreClass
+{
+  /// Relative performance, the fastest class has 1024
+  std::size_t capacity;
+  std::size_t l1CacheSize;
+  std::size_t l2CacheSize;
+  std::size_t l2Sharing;
+  std::vector<int> cpus;
+};
+
 class CpuInfo
 {
 public:
@@ -31,6 +45,19 @@ public:
   bool hasL3Sharing() const;
   bool hasThreadsPerCore() const;
   bool hasPrivateL2Cache() const;
+  bool hasHybridCpu() const;
+  /// x86 SIMD instruction sets, false on other CPUs
+  bool hasSSE2() const;
+  bool hasAVX2() const;
+  bool hasAVX512() const;
+  bool hasPOPCNT() const;
+  /// BMI1 (TZCNT, BLSR)
+  bool hasBMI() const;
+  /// AVX-512 vector popcount (VPOPCNTDQ)
+  bool hasAVX512VPOPCNT() const;
+  /// ARM SIMD instruction sets, false on other CPUs
+  bool hasNEON() const;
+  bool hasSVE() const;
   std::string cpuName() const;
   std::string getError() const;
   std::size_t l1CacheSize() const;
@@ -42,15 +69,33 @@ public:
   std::size_t cpuCores() const;
   std::size_t cpuThreads() const;
   std::size_t threadsPerCore() const;
+  /// CPUs available to this process, limited by the
+  /// CPU affinity and the cgroup or job object quotas
+  std::size_t availableCpus() const;
+  /// What limits availableCpus(), empty if unlimited
+  std::string cpuLimit() const;
+  /// Core classes sorted by capacity (fastest first),
+  /// empty unless the CPU has different core types.
+  const std::vector<CoreClass>& coreClasses() const;
+  /// Index of the core class of cpu, -1 if unknown
+  int coreClass(int cpu) const;
+  /// Number of our threads sharing each cache of the level
+  std::size_t threadsSharing(int level, int threads) const;
+  /// Default sieve size in KiB for the number of threads
+  int sieveSize(int threads) const;
 
 private:
   void init();
+  void initCoreClasses();
   std::size_t cpuCores_;
   std::size_t cpuThreads_;
   std::size_t threadsPerCore_;
+  std::size_t availableCpus_;
   std::array<std::size_t, 4> cacheSizes_;
   std::array<std::size_t, 4> cacheSharing_;
+  std::vector<CoreClass> coreClasses_;
   std::string cpuName_;
+  std::string cpuLimit_;
   std::string error_;
 };
 
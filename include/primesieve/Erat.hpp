@@ -10,18 +10,22 @@
 #ifndef ERAT_HPP
 #define ERAT_HPP
 
+#include "Counters.hpp"
 #include "EratSmall.hpp"
 #include "EratMedium.hpp"
 #include "EratBig.hpp"
+#include "MemoryPool.hpp"
 #include "types.hpp"
 
 #include <stdint.h>
 #include <array>
 #include <memory>
+#include <vector>
 
 namespace primesieve {
 
 class PreSieve;
+class SegmentCache;
 
 /// The abstract Erat class sieves primes using the segmented sieve
 /// of Eratosthenes. It uses a bit array for sieving, the bit array
@@ -34,6 +38,9 @@ class Erat
 public:
   uint64_t getSieveSize() const;
   uint64_t getStop() const;
+  static uint64_t nextPrime(uint64_t*, uint64_t);
+  static uint64_t getMaxEratSmall(uint64_t, uint64_t);
+  static uint64_t getMaxEratMedium(uint64_t, uint64_t);
 protected:
   /// Sieve primes >= start_
   uint64_t start_ = 0;
@@ -53,24 +60,41 @@ protected:
   virtual ~Erat();
   void init(uint64_t, uint64_t, uint64_t, PreSieve&);
   void addSievingPrime(uint64_t);
+  void setStop(uint64_t);
   void sieveSegment();
   bool hasNextSegment() const;
-  static uint64_t nextPrime(uint64_t*, uint64_t);
+  void enableSegmentCache();
+  bool cachedSegment();
 private:
   static const std::array<uint64_t, 64> bruijnBitValues_;
   uint64_t maxPreSieve_;
+  uint64_t l1Size_;
   uint64_t maxEratSmall_;
   uint64_t maxEratMedium_;
-  std::unique_ptr<byte_t[]> deleter_;
+  /// If [start_, stop_] fits into a single segment the
+  /// sieving primes > sparseLimit_ have at most one
+  /// multiple inside it, which is crossed off directly
+  /// instead of storing the sieving prime in EratBig
+  uint64_t sparseLimit_ = ~0ull;
+  /// Bit indexes of the multiples of the sparse primes
+  std::vector<uint32_t> sparseHits_;
+  /// Sieved segments are stored in the cache
+  SegmentCache* segmentCache_ = nullptr;
+  /// Consult the cache until the first miss
+  bool consultCache_ = false;
+  pool_ptr<byte_t> deleter_;
   EratSmall eratSmall_;
   EratMedium eratMedium_;
   EratBig eratBig_;
   static uint64_t byteRemainder(uint64_t);
   void initSieve(uint64_t);
   void initErat();
-  void preSieve();
+  void addSparsePrime(uint64_t);
+  void preSieve(uint64_t, uint64_t);
   void crossOff();
   void sieveLastSegment();
+  void nextSegment();
+  void storeSegment();
 };
 
 /// Reconstruct the prime number corresponding to
@@ -90,9 +114,24 @@ inline uint64_t Erat::nextPrime(uint64_t* bits, uint64_t low)
 
 inline void Erat::addSievingPrime(uint64_t prime)
 {
-       if (prime > maxEratMedium_)   eratBig_.addSievingPrime(prime, segmentLow_);
-  else if (prime > maxEratSmall_) eratMedium_.addSievingPrime(prime, segmentLow_);
-  else /* (prime > maxPreSieve) */ eratSmall_.addSievingPrime(prime, segmentLow_);
+  if (prime > maxEratMedium_)
+  {
+    PRIMESIEVE_COUNT(COUNTER_SIEVING_PRIMES_BIG, 1);
+    if (prime > sparseLimit_)
+      addSparsePrime(prime);
+    else
+      eratBig_.addSievingPrime(prime, segmentLow_);
+  }
+  else if (prime > maxEratSmall_)
+  {
+    PRIMESIEVE_COUNT(COUNTER_SIEVING_PRIMES_MEDIUM, 1);
+    eratMedium_.addSievingPrime(prime, segmentLow_);
+  }
+  else /* (prime > maxPreSieve) */
+  {
+    PRIMESIEVE_COUNT(COUNTER_SIEVING_PRIMES_SMALL, 1);
+    eratSmall_.addSievingPrime(prime, segmentLow_);
+  }
 }
 
 inline uint64_t Erat::getStop() const
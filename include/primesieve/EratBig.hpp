@@ -11,6 +11,7 @@
 #define ERATBIG_HPP
 
 #include "Bucket.hpp"
+#include "MemoryPool.hpp"
 #include "Wheel.hpp"
 #include "types.hpp"
 
@@ -22,7 +23,15 @@ namespace primesieve {
 
 /// EratBig is an implementation of the segmented sieve of
 /// Eratosthenes optimized for big sieving primes that have
-/// very few multiples per segment
+/// very few multiples per segment. If more than
+/// config::MAX_BUCKET_LISTS bucket lists would be needed, the
+/// sieving primes are stored in a two-level bucket hierarchy:
+/// the sieving primes whose next multiple is within the current
+/// block of segments are stored in the bucket list of that
+/// segment, all other sieving primes are stored in the bucket
+/// list of the block of their next multiple. When a block
+/// becomes the current block its sieving primes are moved to
+/// the lists of their segments.
 ///
 class EratBig : public Wheel210_t
 {
@@ -32,18 +41,37 @@ public:
   bool enabled() const { return enabled_; }
 private:
   uint64_t maxPrime_;
+  uint64_t sieveSize_;
   uint64_t log2SieveSize_;
-  uint64_t moduloSieveSize_;
-  /// Vector of bucket lists, holds the sieving primes
+  /// ceil(2^32 / sieveSize), used if sieveSize is not a power of 2
+  uint64_t reciprocal_;
+  /// Number of segments per block
+  uint64_t blockSegments_;
+  /// blockSize_ = blockSegments_ * sieveSize_
+  uint64_t blockSize_;
+  uint64_t log2BlockSize_;
+  uint64_t blockReciprocal_;
+  /// Bytes from the current segment to the end of the block,
+  /// UINT64_MAX if farLists_ is empty (single level)
+  uint64_t blockLimit_;
+  /// Bucket lists of the segments of the current block,
+  /// lists_[0] holds the sieving primes of the current segment
   std::vector<Bucket*> lists_;
+  /// Bucket lists of the next blocks,
+  /// farLists_[0] holds the sieving primes of the next block
+  std::vector<Bucket*> farLists_;
   /// List of empty buckets
   Bucket* stock_;
   /// Pointers of the allocated buckets
-  std::vector<std::unique_ptr<Bucket[]>> memory_;
+  std::vector<pool_ptr<Bucket>> memory_;
   bool enabled_ = false;
   void init(uint64_t);
-  void pushBucket(uint64_t);
+  void pushBucket(Bucket*&);
   void storeSievingPrime(uint64_t, uint64_t, uint64_t);
+  void nextBlock();
+  template <bool POW2>
+  void store(uint64_t, uint64_t, uint64_t);
+  template <bool POW2>
   void crossOff(byte_t*, SievingPrime*, SievingPrime*);
   static void moveBucket(Bucket&, Bucket*&);
 };
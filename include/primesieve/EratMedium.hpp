@@ -11,29 +11,46 @@
 #define ERATMEDIUM_HPP
 
 #include "Bucket.hpp"
+#include "MemoryPool.hpp"
 #include "Wheel.hpp"
 #include "types.hpp"
 
 #include <stdint.h>
+#include <array>
 #include <vector>
 
 namespace primesieve {
 
 /// EratMedium is an implementation of the segmented sieve
 /// of Eratosthenes optimized for medium sieving primes that
-/// have a few multiples per segment
+/// have a few multiples per segment. The sieving primes are
+/// stored in buckets grouped by their wheel index. Large
+/// segments are processed in L2 cache sized blocks.
 ///
-class EratMedium : public Wheel210_t
+class EratMedium : public Wheel30_t
 {
 public:
+  static uint64_t getL2Size(uint64_t);
   void init(uint64_t, uint64_t, uint64_t);
   void crossOff(byte_t*, uint64_t);
   bool enabled() const { return enabled_; }
 private:
   uint64_t maxPrime_;
-  std::vector<SievingPrime> primes_;
+  uint64_t l2Size_;
+  /// Bucket lists of the sieving primes, one per wheel index
+  std::array<Bucket*, 64> lists_;
+  /// List of empty buckets
+  Bucket* stock_;
+  /// Number of buckets per allocation
+  uint64_t bucketsPerAlloc_;
+  /// Pointers of the allocated buckets
+  std::vector<pool_ptr<Bucket>> memory_;
   bool enabled_ = false;
+  void pushBucket(uint64_t);
   void storeSievingPrime(uint64_t, uint64_t, uint64_t);
+  void crossOff(byte_t*, byte_t*);
+  void crossOff(byte_t*, byte_t*, Bucket*);
+  static void moveBucket(Bucket&, Bucket*&);
 };
 
 } // namespace
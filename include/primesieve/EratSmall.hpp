@@ -28,15 +28,30 @@ class EratSmall : public Wheel30_t
 public:
   static uint64_t getL1Size(uint64_t);
   void init(uint64_t, uint64_t, uint64_t);
+  void addSievingPrime(uint64_t, uint64_t);
   void crossOff(byte_t*, uint64_t);
   bool enabled() const { return enabled_; }
 private:
+  /// Sieving prime < MAX_STAMP whose multiples are
+  /// removed using a precomputed bit pattern
+  struct StampPrime
+  {
+    uint64_t prime;
+    /// Index of the pattern byte for the
+    /// first byte of the next L1 block
+    uint64_t phase;
+    /// Bytes up to the byte of prime^2
+    uint64_t skip;
+  };
+  enum { MAX_STAMP = 64 };
   uint64_t maxPrime_;
   uint64_t l1Size_;
   std::vector<SievingPrime> primes_;
+  std::vector<StampPrime> stampPrimes_;
   bool enabled_ = false;
   void storeSievingPrime(uint64_t, uint64_t, uint64_t);
   void crossOff(byte_t*, byte_t*);
+  void stamp(byte_t*, byte_t*);
 };
 
 } // namespace
@@ -0,0 +1,54 @@
+///
+/// @file  GapBuffer.hpp
+///        Stores the primes of a prev_prime() interval of
+///        primesieve::iterator as gaps, about 1 byte per prime
+///        instead of 8 bytes. The primes are decoded backwards
+///        in blocks of config::ITERATOR_BUFFER primes.
+///        Enabled using primesieve::set_iterator_compression().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef GAPBUFFER_HPP
+#define GAPBUFFER_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <vector>
+
+namespace primesieve {
+
+class PrimeGenerator;
+
+class GapBuffer
+{
+public:
+  /// Store the primes inside [start, stop]
+  /// of the PrimeGenerator, @pre start > 2
+  ///
+  void fill(PrimeGenerator& primeGenerator,
+            uint64_t start,
+            uint64_t stop);
+  /// Decode the next block of primes (in decreasing order) and
+  /// store it in increasing order into primes.
+  /// @return false if there are no primes left.
+  ///
+  bool prevPrimes(std::vector<uint64_t>& primes);
+  void clear();
+private:
+  /// (gap / 2) bytes in increasing order, gaps > 510
+  /// are stored as 3 bytes: low byte, high byte, 0
+  std::vector<uint8_t> gaps_;
+  /// Largest prime not yet decoded
+  uint64_t prime_ = 0;
+  /// Primes not yet decoded
+  std::size_t count_ = 0;
+  void add(const uint64_t* primes, std::size_t size);
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,41 @@
+///
+/// @file  GpuSieve.hpp
+///        Count the primes inside [start, stop] on an OpenCL GPU.
+///        Only available if primesieve has been built using
+///        cmake -DWITH_OPENCL=ON and if the system has an
+///        OpenCL GPU, ParallelSieve::setGpu(true) enables it.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef GPUSIEVE_HPP
+#define GPUSIEVE_HPP
+
+#include <stdint.h>
+#include <string>
+
+namespace primesieve {
+
+class cancel_token;
+
+/// @return true if there is an OpenCL GPU,
+///         the GPU is initialized once per process
+///
+bool gpuAvailable();
+
+/// Name of the GPU, empty if not available
+std::string gpuName();
+
+/// Count the primes inside [start, stop] on the GPU
+/// @pre gpuAvailable() && stop <= config::MAX_GPU_STOP
+///
+uint64_t gpuCountPrimes(uint64_t start,
+                        uint64_t stop,
+                        const cancel_token* token = nullptr);
+
+} // namespace
+
+#endif
@@ -0,0 +1,91 @@
+///
+/// @file   Histogram.hpp
+/// @brief  Prime and prime k-tuplet counts of the bins
+///         [start + i * width, start + (i + 1) * width - 1]
+///         of the interval [start, stop]. The bins are filled
+///         by PrintPrimes after each sieved segment.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef HISTOGRAM_HPP
+#define HISTOGRAM_HPP
+
+#include "primesieve_error.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace primesieve {
+
+class Histogram
+{
+public:
+  Histogram(uint64_t start, uint64_t stop, uint64_t width) :
+    start_(start),
+    stop_(stop),
+    width_(width)
+  {
+    if (width == 0)
+      throw primesieve_error("bin width must be > 0");
+    if (start > stop)
+      throw primesieve_error("start must be <= stop");
+
+    bins_ = (stop - start) / width + 1;
+    // 6 counts per bin: primes, twins, ...
+    counts_.reset(new std::atomic<uint64_t>[bins_ * 6]());
+  }
+
+  uint64_t getStart() const { return start_; }
+  uint64_t getStop() const { return stop_; }
+  uint64_t size() const { return bins_; }
+
+  /// @pre start <= n <= stop
+  uint64_t bin(uint64_t n) const
+  {
+    return (n - start_) / width_;
+  }
+
+  uint64_t binLow(uint64_t i) const
+  {
+    return start_ + i * width_;
+  }
+
+  uint64_t binHigh(uint64_t i) const
+  {
+    uint64_t low = binLow(i);
+    uint64_t dist = std::min(stop_ - low, width_ - 1);
+    return low + dist;
+  }
+
+  /// The bins of a segment are added by a single
+  /// thread, except the first and last bin which
+  /// may be shared with the neighbouring segments.
+  ///
+  void add(uint64_t i, int k, uint64_t count)
+  {
+    counts_[i * 6 + k].fetch_add(count, std::memory_order_relaxed);
+  }
+
+  /// @k: 0 = primes, 1 = twin primes, ...
+  uint64_t count(uint64_t i, int k) const
+  {
+    return counts_[i * 6 + k].load(std::memory_order_relaxed);
+  }
+
+private:
+  uint64_t start_;
+  uint64_t stop_;
+  uint64_t width_;
+  uint64_t bins_;
+  std::unique_ptr<std::atomic<uint64_t>[]> counts_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,33 @@
+///
+/// @file  IsPrime.hpp
+///        Primality tests used by primesieve::is_prime().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef ISPRIME_HPP
+#define ISPRIME_HPP
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace primesieve {
+
+/// Uses a cached sieve bitmap for small n
+/// and Miller-Rabin for large n.
+///
+bool isPrimeCached(uint64_t n);
+
+/// results[i] = isPrimeCached(numbers[i]), batches of
+/// nearby numbers are sieved instead.
+///
+void isPrimeBatch(const uint64_t* numbers,
+                  std::size_t size,
+                  bool* results);
+
+} // namespace
+
+#endif
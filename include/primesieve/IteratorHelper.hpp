@@ -11,9 +11,12 @@
 #define ITERATOR_HELPER_HPP
 
 #include <stdint.h>
+#include <memory>
 
 namespace primesieve {
 
+class SievingTable;
+
 class IteratorHelper
 {
 public:
@@ -26,6 +29,9 @@ public:
                    uint64_t* stop,
                    uint64_t stopHint,
                    uint64_t* dist);
+
+  static void updateSievingTable(uint64_t stop,
+                                 std::shared_ptr<const SievingTable>& table);
 };
 
 } // namespace
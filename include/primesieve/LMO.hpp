@@ -0,0 +1,31 @@
+///
+/// @file  LMO.hpp
+/// @brief Count the primes <= x using the combinatorial algorithm
+///        of Lagarias, Miller and Odlyzko. The special leaves
+///        are computed using a segmented sieve of the numbers
+///        <= x^(2/3), in O(x^(2/3) log log x) operations. This
+///        is much faster than sieving up to x if x is large.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef LMO_HPP
+#define LMO_HPP
+
+#include <stdint.h>
+
+namespace primesieve {
+
+class cancel_token;
+
+/// Count the primes <= x using multiple threads, throws
+/// primesieve_cancelled if the token is cancelled.
+///
+uint64_t piLMO(uint64_t x, int threads, const cancel_token* token = nullptr);
+
+} // namespace
+
+#endif
@@ -0,0 +1,52 @@
+///
+/// @file  LargePages.hpp
+///        Allocate large memory blocks (sieve arrays, buckets)
+///        backed by huge pages to reduce TLB misses. Used by the
+///        MemoryPool, falls back to normal pages if huge pages
+///        are not available.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef LARGEPAGES_HPP
+#define LARGEPAGES_HPP
+
+#include <cstddef>
+
+namespace primesieve {
+
+enum PageType
+{
+  /// Normal (usually 4 KiB) pages
+  NORMAL_PAGES,
+  /// Linux transparent huge pages, requested using
+  /// madvise(MADV_HUGEPAGE). The kernel may still
+  /// use normal pages.
+  TRANSPARENT_HUGE_PAGES,
+  /// Reserved huge pages (Linux MAP_HUGETLB,
+  /// Windows MEM_LARGE_PAGES)
+  HUGE_PAGES
+};
+
+/// Allocate uninitialized memory, blocks >= HUGE_PAGE_SIZE
+/// are backed by huge pages if possible.
+/// @type: The pages that were actually obtained.
+///
+void* allocatePages(std::size_t bytes, PageType* type = nullptr);
+
+/// Free memory allocated by allocatePages(),
+/// bytes must match the allocation size.
+///
+void freePages(void* ptr, std::size_t bytes);
+
+/// Smaller allocations use normal pages, a huge
+/// page would waste most of its memory.
+///
+const std::size_t HUGE_PAGE_SIZE = 2 << 20;
+
+} // namespace
+
+#endif
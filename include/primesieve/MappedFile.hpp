@@ -0,0 +1,59 @@
+///
+/// @file  MappedFile.hpp
+/// @brief View of a file, the file is memory mapped if supported
+///        by the OS, else it is read into memory. Writable files
+///        are created with a fixed size.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace primesieve {
+
+class MappedFile
+{
+public:
+  /// Read-only view of an existing file
+  MappedFile(const std::string& filename);
+  /// Create (or truncate) a writable file of size bytes
+  MappedFile(const std::string& filename, std::size_t size);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  const unsigned char* data() const { return data_; }
+  /// Only valid for writable files
+  unsigned char* data() { return data_; }
+  std::size_t size() const { return size_; }
+  /// Little-endian uint64_t at offset
+  uint64_t read64(std::size_t offset) const
+  {
+    uint64_t n = 0;
+    for (int i = 7; i >= 0; i--)
+      n = (n << 8) | data_[offset + i];
+    return n;
+  }
+  /// Write the changes back to the file
+  void sync();
+private:
+  unsigned char* data_ = nullptr;
+  std::size_t size_ = 0;
+  /// Used if the file is not memory mapped
+  std::vector<unsigned char> buffer_;
+  bool mapped_ = false;
+  bool writable_ = false;
+  std::string filename_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,91 @@
+///
+/// @file  MemoryPool.hpp
+///        Thread-local cache of large memory blocks. Erat, PreSieve
+///        and EratBig allocate their arrays from the MemoryPool so
+///        that consecutive chunks sieved by the same thread reuse
+///        the memory instead of calling malloc and page faulting
+///        again. The ThreadPool releases the cached memory when a
+///        computation ends, release_memory() releases the cached
+///        memory of all threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef MEMORYPOOL_HPP
+#define MEMORYPOOL_HPP
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace primesieve {
+
+class MemoryPool
+{
+public:
+  MemoryPool();
+  ~MemoryPool();
+  void* allocate(std::size_t bytes);
+  void deallocate(void* ptr, std::size_t bytes);
+  /// Free all cached memory blocks
+  void release();
+  std::size_t getCachedBytes() const;
+  /// Free the cached memory blocks of all threads
+  static void releaseAll();
+private:
+  struct Block
+  {
+    void* ptr;
+    std::size_t bytes;
+  };
+  /// releaseAll() is called from other threads
+  mutable std::mutex mutex_;
+  std::vector<Block> blocks_;
+  std::size_t cached_ = 0;
+};
+
+/// MemoryPool of the calling thread,
+/// nullptr if the thread is exiting
+///
+MemoryPool* memoryPool();
+
+void* poolAllocate(std::size_t bytes);
+void poolDeallocate(void* ptr, std::size_t bytes);
+
+template <typename T>
+struct PoolDeleter
+{
+  std::size_t size = 0;
+  void operator()(T* ptr) const
+  {
+    poolDeallocate(ptr, size * sizeof(T));
+  }
+};
+
+template <typename T>
+using pool_ptr = std::unique_ptr<T[], PoolDeleter<T>>;
+
+/// Allocate an uninitialized array of size objects,
+/// the memory is returned to the pool of the
+/// thread that destroys the pool_ptr.
+///
+template <typename T>
+pool_ptr<T> allocatePool(std::size_t size)
+{
+  static_assert(std::is_trivially_destructible<T>::value,
+                "allocatePool<T>: T must be trivially destructible");
+
+  PoolDeleter<T> deleter;
+  deleter.size = size;
+  T* ptr = static_cast<T*>(poolAllocate(size * sizeof(T)));
+  return pool_ptr<T>(ptr, deleter);
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,32 @@
+///
+/// @file  MillerRabin.hpp
+///        Deterministic Miller-Rabin primality test for 64-bit
+///        numbers. Used by primesieve::iterator to find the
+///        first primes after skipto() at huge offsets where
+///        sieving (up to sqrt(stop)) would take much longer.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef MILLERRABIN_HPP
+#define MILLERRABIN_HPP
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace primesieve {
+
+/// Correct for all n < 2^64
+bool isPrime(uint64_t n);
+
+/// Store the next n primes > start in primes[0, n[.
+/// Stores UINT64_MAX if next prime > 2^64.
+///
+void nextPrimes(uint64_t start, uint64_t* primes, std::size_t n);
+
+} // namespace
+
+#endif
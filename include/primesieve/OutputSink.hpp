@@ -0,0 +1,54 @@
+///
+/// @file  OutputSink.hpp
+/// @brief Buffered writer of the printed primes to a file
+///        descriptor, bypasses iostream and stdio.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef OUTPUTSINK_HPP
+#define OUTPUTSINK_HPP
+
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+#include <streambuf>
+#include <vector>
+
+namespace primesieve {
+
+class OutputSink : public std::streambuf
+{
+public:
+  OutputSink(int fd);
+  ~OutputSink();
+  OutputSink(const OutputSink&) = delete;
+  OutputSink& operator=(const OutputSink&) = delete;
+protected:
+  int_type overflow(int_type c) override;
+  std::streamsize xsputn(const char* data, std::streamsize size) override;
+  int sync() override;
+private:
+  bool flushBuffer();
+  bool writeAll(const char* data, std::size_t size);
+  int fd_;
+  /// Page aligned buffer of OUTPUT_BUFFER bytes
+  std::vector<char> memory_;
+  char* buffer_;
+  std::size_t pos_ = 0;
+  std::mutex mutex_;
+};
+
+/// Printed primes are written to the returned stream,
+/// this is an OutputSink of the stdout file descriptor if
+/// out is std::cout and std::cout has not been redirected
+/// using rdbuf(), else *out.
+///
+std::ostream& outputStream(std::ostream* out);
+
+} // namespace
+
+#endif
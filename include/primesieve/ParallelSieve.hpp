@@ -14,42 +14,70 @@
 
 #include "PrimeSieve.hpp"
 #include <stdint.h>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 namespace primesieve {
 
+class Checkpoint;
+class SievingTable;
+class SievingTableCache;
+class StatusThread;
+class ThreadPool;
+
 class ParallelSieve : public PrimeSieve
 {
 public:
-  /// Used for inter-process communication with the
-  /// primesieve GUI application.
-  struct SharedMemory
-  {
-    uint64_t start;
-    uint64_t stop;
-    uint64_t counts[6];
-    double status;
-    double seconds;
-    int flags;
-    int sieveSize;
-    int threads;
-  };
   ParallelSieve();
   virtual ~ParallelSieve() { }
-  void init(SharedMemory&);
   static int getMaxThreads();
-  int getNumThreads() const;
+  virtual int getNumThreads() const;
   int idealNumThreads() const;
   void setNumThreads(int numThreads);
+  uint64_t getMemoryLimit() const;
+  void setMemoryLimit(uint64_t bytes);
+  uint64_t getThreadMemory(int sieveSize) const;
+  uint64_t getMinDistance() const;
+  void setThreadPool(ThreadPool*);
+  void setSievingTableCache(SievingTableCache*);
+  void setCheckpoint(Checkpoint*);
+  void setStatusCallback(const std::function<void(double)>& callback);
+  void setGpu(bool gpu);
+  bool useGpu() const;
   using PrimeSieve::sieve;
   virtual void sieve();
+  virtual uint64_t countPrimes(uint64_t, uint64_t);
 private:
   std::mutex lock_;
-  SharedMemory* shm_;
   int numThreads_;
-  uint64_t getThreadDistance(int) const;
-  uint64_t align(uint64_t) const;
-  virtual bool updateStatus(uint64_t, bool);
+  /// Max memory usage in bytes, 0 = unlimited
+  uint64_t memoryLimit_;
+  /// Used by primesieve::context
+  ThreadPool* pool_;
+  SievingTableCache* tableCache_;
+  Checkpoint* checkpoint_;
+  /// Count primes on the GPU (see GpuSieve.hpp)
+  bool gpu_;
+  /// false while sieving the pieces of sieveCountCache()
+  bool countCache_;
+  /// Receives the status, e.g. the primesieve GUI
+  std::function<void(double)> statusCallback_;
+  uint64_t getSharedMemory() const;
+  void applyMemoryLimit();
+  void sievePrint(int threads);
+  void sieveCheckpoint();
+  void sieveCountCache();
+  bool useCountCache() const;
+  void sieveGpu();
+  void sievePrimePartitions(int threads);
+  bool usePrimePartitions() const;
+  uint64_t getThreadDistance() const;
+  std::shared_ptr<const SievingTable> getSievingTable(int threads);
+  std::vector<double> getThreadWeights(int) const;
+  std::vector<int> getCoreSieveSizes() const;
+  std::unique_ptr<StatusThread> getStatusThread(int threads);
 };
 
 } // namespace
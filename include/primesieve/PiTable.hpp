@@ -0,0 +1,50 @@
+///
+/// @file  PiTable.hpp
+/// @brief Table of the prime counts pi(k * dist) loaded from a
+///        file written by primesieve::write_pi_table(). Using
+///        the table count_primes() and nth_prime() only sieve
+///        the distance to the nearest table entry.
+///
+/// File format (all integers are little-endian uint64_t):
+/// "PSPITBL1", dist, n, pi(0 * dist), ..., pi((n - 1) * dist)
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PITABLE_HPP
+#define PITABLE_HPP
+
+#include "MappedFile.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <string>
+
+namespace primesieve {
+
+class PiTable
+{
+public:
+  PiTable(const std::string& filename);
+  /// Largest table entry x <= n
+  uint64_t floor(uint64_t n) const;
+  /// Largest table entry x with pi(x) < n
+  uint64_t floorNth(uint64_t n) const;
+  /// @pre x is a table entry
+  uint64_t pi(uint64_t x) const;
+private:
+  MappedFile file_;
+  uint64_t dist_;
+  uint64_t size_;
+};
+
+/// The table loaded by primesieve::load_pi_table()
+std::shared_ptr<const PiTable> getPiTable();
+void setPiTable(const std::shared_ptr<const PiTable>& table);
+
+} // namespace
+
+#endif
@@ -13,42 +13,38 @@
 #include "types.hpp"
 
 #include <stdint.h>
-#include <memory>
 
 namespace primesieve {
 
 /// PreSieve objects are used to pre-sieve multiples of small primes
-/// e.g. <= 19 to speed up the sieve of Eratosthenes. The idea is to
-/// allocate an array (buffer_) and remove the multiples of small
-/// primes from it at initialization. Then whilst sieving, the
-/// buffer_ array is copied to the sieve array at the beginning of
-/// each new segment to pre-sieve the multiples of small
-/// primes <= maxPrime_. Pre-sieving speeds up my sieve of Eratosthenes
-/// implementation by about 20 percent when sieving < 10^10.
+/// <= 31 to speed up the sieve of Eratosthenes. The idea is to
+/// remove the multiples of small primes from a few small buffers
+/// (patterns) at initialization. Then whilst sieving, the patterns
+/// are combined using bitwise AND and copied to the sieve array at
+/// the beginning of each new segment. Hence the smallest sieving
+/// primes, which have the most multiples, need not be crossed
+/// off by EratSmall.
 ///
 /// <b> Memory Usage </b>
 ///
-/// - PreSieve objects use: primeProduct(maxPrime_) / 30 bytes of memory
-/// - PreSieve multiples of primes <=  7 uses    7    bytes
-/// - PreSieve multiples of primes <= 11 uses   77    bytes
-/// - PreSieve multiples of primes <= 13 uses 1001    bytes
-/// - PreSieve multiples of primes <= 17 uses   17.02 kilobytes
-/// - PreSieve multiples of primes <= 19 uses  323.32 kilobytes
-/// - PreSieve multiples of primes <= 23 uses    7.44 megabytes
+/// The pattern of the primes p1, p2, ... has a period of
+/// 30 * p1 * p2 * ... numbers i.e. p1 * p2 * ... bytes.
+///
+/// - Pattern of the primes  7, 11, 13 uses 1001 bytes
+/// - Pattern of the primes 17, 19, 23 uses 7429 bytes
+/// - Pattern of the primes 29, 31     uses  899 bytes
+///
+/// The patterns are initialized once and shared
+/// read-only by all PreSieve objects.
 ///
 class PreSieve
 {
 public:
-  PreSieve(uint64_t start, uint64_t stop);
+  PreSieve();
   uint64_t getMaxPrime() const { return maxPrime_; }
   void copy(byte_t*, uint64_t, uint64_t) const;
 private:
   uint64_t maxPrime_;
-  uint64_t primeProduct_;
-  uint64_t size_;
-  byte_t* buffer_;
-  std::unique_ptr<byte_t[]> deleter_;
-  void init();
 };
 
 } // namespace
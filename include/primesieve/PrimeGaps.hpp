@@ -0,0 +1,86 @@
+///
+/// @file   PrimeGaps.hpp
+/// @brief  Prime gap statistics: the number of occurrences and
+///         the first occurrence of each gap. Each thread computes
+///         the gaps of its contiguous runs of primes, the gaps
+///         between the runs are added once all threads have
+///         finished.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMEGAPS_HPP
+#define PRIMEGAPS_HPP
+
+#include <stdint.h>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace primesieve {
+
+class PrimeGaps
+{
+public:
+  /// Gaps of a contiguous run of primes
+  class Run
+  {
+  public:
+    /// @pre prime > previous prime
+    void add(uint64_t prime)
+    {
+      if (last_)
+        addGap(last_, prime - last_);
+      else
+        first_ = prime;
+
+      last_ = prime;
+    }
+
+    /// prime + gap is the next prime
+    void addGap(uint64_t prime, uint64_t gap)
+    {
+      if (gap >= counts_.size())
+      {
+        counts_.resize(gap + 1, 0);
+        firstPrimes_.resize(gap + 1, 0);
+      }
+
+      counts_[gap]++;
+      if (!firstPrimes_[gap] || prime < firstPrimes_[gap])
+        firstPrimes_[gap] = prime;
+    }
+
+  private:
+    friend class PrimeGaps;
+    uint64_t first_ = 0;
+    uint64_t last_ = 0;
+    std::vector<uint64_t> counts_;
+    std::vector<uint64_t> firstPrimes_;
+    void merge(const Run&);
+  };
+
+  /// Called by each thread after sieving its span
+  void merge(const Run&);
+  /// Add the gaps between the runs, called
+  /// once after all threads have finished
+  void finish();
+  uint64_t maxGap() const;
+  /// Number of primes p with nextPrime(p) = p + gap
+  uint64_t count(uint64_t gap) const;
+  /// Smallest prime p with nextPrime(p) = p + gap, 0 if none
+  uint64_t firstPrime(uint64_t gap) const;
+
+private:
+  std::mutex mutex_;
+  Run total_;
+  /// First and last prime of each run
+  std::vector<std::pair<uint64_t, uint64_t>> runs_;
+};
+
+} // namespace
+
+#endif
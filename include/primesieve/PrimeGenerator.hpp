@@ -5,6 +5,8 @@
 ///        vector primesieve::iterator iterates over the vector and
 ///        returns the primes. When there are no more primes left in
 ///        the vector PrimeGenerator generates new primes.
+///        fill(std::vector<uint32_t>&) is the 32-bit variant
+///        used if stop < 2^32.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -17,7 +19,6 @@
 
 #include "Erat.hpp"
 #include "PreSieve.hpp"
-#include "littleendian_cast.hpp"
 #include "SievingPrimes.hpp"
 
 #include <stdint.h>
@@ -26,11 +27,18 @@
 
 namespace primesieve {
 
+class SievingTable;
+
 class PrimeGenerator : public Erat
 {
 public:
-  PrimeGenerator(uint64_t start, uint64_t stop);
-  void fill(std::vector<uint64_t>&);
+  PrimeGenerator(uint64_t start, uint64_t stop, const SievingTable* = nullptr);
+
+  /// Append all primes inside [start, stop],
+  /// T = uint32_t requires stop < 2^32.
+  ///
+  template <typename T>
+  void fill(std::vector<T>&);
 
   bool finished() const
   {
@@ -43,28 +51,16 @@ public:
   }
 
   void fill(std::vector<uint64_t>& primes,
-            std::size_t* size)
-  {
-    if (sieveIdx_ >= sieveSize_)
-      if (!sieveSegment(primes, size))
-        return;
-
-    std::size_t i = 0;
-    uint64_t bits = littleendian_cast<uint64_t>(&sieve_[sieveIdx_]);
-    sieveIdx_ += 8;
-
-    for (; bits != 0; i++)
-      primes[i] = nextPrime(&bits, low_);
-
-    *size = i;
-    low_ += 8 * 30;
-  }
+            std::size_t* size);
 private:
   uint64_t low_ = 0;
   uint64_t sieveIdx_ = ~0ull;
   uint64_t prime_ = 0;
   PreSieve preSieve_;
   SievingPrimes sievingPrimes_;
+  /// If not nullptr the sieving primes are
+  /// read from the table, see SievingPrimes
+  const SievingTable* sievingTable_;
   bool isInit_ = false;
   bool finished_ = false;
   static const std::array<uint64_t, 64> smallPrimes;
@@ -72,9 +68,11 @@ private:
   std::size_t getStartIdx() const;
   std::size_t getStopIdx() const;
   void init();
-  void init(std::vector<uint64_t>&);
+  template <typename T>
+  void init(std::vector<T>&);
   void init(std::vector<uint64_t>&, std::size_t*);
-  bool sieveSegment(std::vector<uint64_t>&);
+  template <typename T>
+  bool sieveSegment(std::vector<T>&);
   bool sieveSegment(std::vector<uint64_t>&, std::size_t*);
   void sieveSegment();
 };
@@ -0,0 +1,45 @@
+///
+/// @file  PrimePartitions.hpp
+///        Count the primes of a short interval at a huge offset
+///        by splitting the sieving primes among the threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMEPARTITIONS_HPP
+#define PRIMEPARTITIONS_HPP
+
+#include "PrimeSieve.hpp"
+
+#include <stdint.h>
+#include <functional>
+
+namespace primesieve {
+
+class SievingTable;
+class ThreadPool;
+
+/// Each thread sieves the whole interval [start, stop] into a
+/// private bitmap using its pieces of the sieving primes of
+/// table, afterwards the bitmaps are combined using bitwise
+/// AND and counted.
+/// @countFlags: COUNT_* flags of the counts to compute.
+/// @progress:   Called by thread after each piece of the sieving
+///              primes with its share of the distance.
+/// @pre start >= 7 and table contains the primes <= sqrt(stop)
+///
+counts_t countPrimePartitions(uint64_t start,
+                              uint64_t stop,
+                              int countFlags,
+                              int sieveSize,
+                              int threads,
+                              const SievingTable& table,
+                              ThreadPool& pool,
+                              const std::function<void(int thread, uint64_t dist)>& progress);
+
+} // namespace
+
+#endif
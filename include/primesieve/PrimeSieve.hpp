@@ -15,11 +15,25 @@
 
 #include <stdint.h>
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <iosfwd>
 
 namespace primesieve {
 
 using counts_t = std::array<uint64_t, 6>;
 
+class cancel_token;
+class ChunkScheduler;
+class Histogram;
+class PrimeGaps;
+class PrimeSums;
+class PrintQueue;
+class ResidueCounts;
+class SievingTable;
+struct SieveStats;
+class SieveTrace;
+
 enum
 {
   COUNT_PRIMES      = 1 << 0,
@@ -48,14 +62,40 @@ public:
   uint64_t getStart() const;
   uint64_t getStop() const;
   int getSieveSize() const;
+  int getFlags() const;
+  virtual int getNumThreads() const;
   double getStatus() const;
   double getSeconds() const;
+  const SievingTable* getSievingTable() const;
+  Histogram* getHistogram() const;
+  PrimeGaps* getPrimeGaps() const;
+  PrimeSums* getPrimeSums() const;
+  int getPrintFormat() const;
+  ResidueCounts* getResidueCounts() const;
+  const cancel_token* getCancelToken() const;
+  std::ostream* getOutput() const;
+  SieveStats* getSieveStats() const;
+  SieveTrace* getTrace() const;
   // Setters
   void setStart(uint64_t);
   void setStop(uint64_t);
   void setSieveSize(int);
+  void tuneSieveSize(int threads = 1);
   void setFlags(int);
   void addFlags(int);
+  void setSievingTable(const SievingTable*);
+  void setHistogram(Histogram*);
+  void setPrimeGaps(PrimeGaps*);
+  void setPrimeSums(PrimeSums*);
+  void setPrintFormat(int);
+  void setResidueCounts(ResidueCounts*);
+  void setSpan(ChunkScheduler*, int);
+  void setPrintQueue(PrintQueue*, uint64_t);
+  void setCancelToken(const cancel_token*);
+  void setOutput(std::ostream*);
+  void setProgress(std::atomic<uint64_t>*);
+  void setSieveStats(SieveStats*);
+  void setTrace(SieveTrace*, int thread = 0);
   // Bool is*
   bool isCount(int) const;
   bool isCountPrimes() const;
@@ -67,6 +107,7 @@ public:
   bool isFlag(int) const;
   bool isFlag(int, int) const;
   bool isStatus() const;
+  bool isSpan() const;
   // Sieve
   virtual void sieve();
   void sieve(uint64_t, uint64_t);
@@ -77,8 +118,12 @@ public:
   // Count
   counts_t& getCounts();
   uint64_t getCount(int) const;
-  uint64_t countPrimes(uint64_t, uint64_t);
-  virtual bool updateStatus(uint64_t, bool tryLock = true);
+  virtual uint64_t countPrimes(uint64_t, uint64_t);
+  void updateStatus(uint64_t);
+  uint64_t claimSpan(uint64_t);
+  void checkCancelled() const;
+  void write(const char*, std::size_t);
+  void traceSetupDone();
 protected:
   /// Sieve primes >= start_
   uint64_t start_;
@@ -93,16 +138,48 @@ protected:
 private:
   /// Sum of all processed segments
   uint64_t processed_;
-  /// Sum of processed segments to update
-  uint64_t toUpdate_;
   /// Status of sieve() in percent
   double percent_;
   /// Sieve size in KiB
   int sieveSize_;
+  /// Use the tuned sieve size of stop_ (see Tuning.hpp)
+  /// unless the sieve size has been set using setSieveSize()
+  bool tuneSieveSize_;
   /// Setter methods set flags e.g. COUNT_PRIMES
   int flags_;
+  /// PrintFormat of the printed primes
+  int printFormat_;
   /// parent ParallelSieve object
   PrimeSieve* parent_;
+  /// Sieving primes shared by all threads
+  const SievingTable* sievingTable_;
+  /// Per bin counts, shared by all threads
+  Histogram* histogram_;
+  /// Prime gap statistics, shared by all threads
+  PrimeGaps* primeGaps_;
+  /// Sum of the primes, shared by all threads
+  PrimeSums* primeSums_;
+  /// Counts of the primes mod q, shared by all threads
+  ResidueCounts* residueCounts_;
+  /// ParallelSieve span that is currently sieved
+  ChunkScheduler* scheduler_;
+  int span_;
+  /// ParallelSieve chunk whose primes are printed
+  PrintQueue* printQueue_;
+  uint64_t printChunk_;
+  /// Stops sieving if cancelled
+  const cancel_token* cancelToken_;
+  /// Printed primes are written to output_, default stdout
+  std::ostream* output_;
+  /// Progress counter of a ParallelSieve thread, only
+  /// written by this thread and read by the status thread
+  std::atomic<uint64_t>* progress_;
+  /// Time spent in each sieving phase, nullptr if disabled
+  SieveStats* stats_;
+  /// Timeline of ParallelSieve, nullptr if disabled
+  SieveTrace* trace_;
+  int traceThread_;
+  double setupEnd_;
   static void printStatus(double, double);
   bool isParallelSieve() const;
   void processSmallPrimes();
@@ -0,0 +1,111 @@
+///
+/// @file   PrimeSums.hpp
+/// @brief  Sum of the primes and sum of the squares of the
+///         primes using 128-bit accumulators. Each thread sums
+///         up its primes locally (see PrintPrimes::sumPrimes())
+///         and adds them once it has finished sieving its span.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESUMS_HPP
+#define PRIMESUMS_HPP
+
+#include "primesieve_error.hpp"
+#include "uint128.hpp"
+
+#include <stdint.h>
+#include <mutex>
+
+namespace primesieve {
+
+/// 64 x 64 -> 128 bit multiplication
+inline uint128 mul128(uint64_t a, uint64_t b)
+{
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 x = (unsigned __int128) a * b;
+  return uint128((uint64_t) (x >> 64), (uint64_t) x);
+#else
+  uint64_t a0 = a & 0xffffffff, a1 = a >> 32;
+  uint64_t b0 = b & 0xffffffff, b1 = b >> 32;
+  uint64_t p00 = a0 * b0;
+  uint64_t p01 = a0 * b1;
+  uint64_t p10 = a1 * b0;
+  uint64_t p11 = a1 * b1;
+  uint64_t mid = (p00 >> 32) + (p01 & 0xffffffff) + (p10 & 0xffffffff);
+  uint64_t low = (mid << 32) | (p00 & 0xffffffff);
+  uint64_t high = p11 + (p01 >> 32) + (p10 >> 32) + (mid >> 32);
+  return uint128(high, low);
+#endif
+}
+
+/// a += b, returns false if the result is >= 2^128
+inline bool add128(uint128& a, const uint128& b)
+{
+  uint64_t low = a.low + b.low;
+  uint64_t carry = low < a.low;
+  uint64_t high = a.high + b.high;
+  bool ok = high >= a.high;
+  a.low = low;
+  a.high = high + carry;
+  return ok && a.high >= carry;
+}
+
+/// a * b, returns false if the result is >= 2^128
+inline bool mul128(const uint128& a, uint64_t b, uint128& res)
+{
+  uint128 high = mul128(a.high, b);
+  res = mul128(a.low, b);
+  res.high += high.low;
+  return !high.high && res.high >= high.low;
+}
+
+class PrimeSums
+{
+public:
+  PrimeSums(bool isSquares = false) :
+    isSquares_(isSquares)
+  { }
+
+  /// Additionally sum up the squares of the primes
+  bool isSquares() const
+  {
+    return isSquares_;
+  }
+
+  uint128 sum() const
+  {
+    return sum_;
+  }
+
+  uint128 squares() const
+  {
+    return squares_;
+  }
+
+  void add(const uint128& sum, const uint128& squares)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    add128(sum_, sum);
+    if (!add128(squares_, squares))
+      throw primesieve_error("sum of prime squares >= 2^128");
+  }
+
+  void addPrime(uint64_t prime)
+  {
+    add(prime, isSquares_ ? mul128(prime, prime) : 0);
+  }
+
+private:
+  uint128 sum_;
+  uint128 squares_;
+  bool isSquares_;
+  std::mutex mutex_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,131 @@
+///
+/// @file   PrintFormat.hpp
+/// @brief  Output formats of the printed primes: decimal text
+///         (default), raw little-endian 32-bit or 64-bit
+///         integers, or the gaps between consecutive primes
+///         (delta8, varint).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRINTFORMAT_HPP
+#define PRINTFORMAT_HPP
+
+#include "primesieve_error.hpp"
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstring>
+
+namespace primesieve {
+
+enum PrintFormat
+{
+  /// One decimal number per line
+  FORMAT_TEXT,
+  /// Little-endian uint32_t, requires primes < 2^32
+  FORMAT_U32,
+  /// Little-endian uint64_t
+  FORMAT_U64,
+  /// The first prime as little-endian uint64_t, then one
+  /// byte per prime: gap / 2 (0 for the gap 3 - 2 = 1)
+  FORMAT_DELTA8,
+  /// The gaps (the first prime minus 0) as unsigned
+  /// LEB128 varints, 7 bits per byte, low bits first
+  FORMAT_VARINT
+};
+
+/// The delta formats depend on the previous prime
+inline bool isDeltaFormat(int format)
+{
+  return format == FORMAT_DELTA8 ||
+         format == FORMAT_VARINT;
+}
+
+/// Write n in decimal to str (2 digits at a time),
+/// returns the end of the written digits
+///
+inline char* toChars(uint64_t n, char* str)
+{
+  static const char digitPairs[] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+  char buffer[20];
+  char* end = buffer + 20;
+  char* digits = end;
+
+  for (; n >= 100; n /= 100)
+  {
+    digits -= 2;
+    std::memcpy(digits, &digitPairs[(n % 100) * 2], 2);
+  }
+
+  if (n >= 10)
+  {
+    digits -= 2;
+    std::memcpy(digits, &digitPairs[n * 2], 2);
+  }
+  else
+    *--digits = (char) ('0' + n);
+
+  std::size_t size = end - digits;
+  std::memcpy(str, digits, size);
+  return str + size;
+}
+
+/// Write n as little-endian integer of BYTES bytes
+template <int BYTES>
+inline char* toLittleEndian(uint64_t n, char* str)
+{
+  for (int i = 0; i < BYTES; i++)
+    str[i] = (char) (n >> (i * 8));
+  return str + BYTES;
+}
+
+/// Write prime to str using format, prev is the previously
+/// written prime (0 if none), returns the end of the
+/// written bytes (<= 21 bytes)
+///
+inline char* encodePrime(int format, uint64_t prime, uint64_t prev, char* str)
+{
+  switch (format)
+  {
+    case FORMAT_U32:
+      return toLittleEndian<4>(prime, str);
+    case FORMAT_U64:
+      return toLittleEndian<8>(prime, str);
+    case FORMAT_DELTA8:
+    {
+      if (!prev)
+        return toLittleEndian<8>(prime, str);
+      uint64_t gap = prime - prev;
+      if (gap > 510)
+        throw primesieve_error("delta8 format requires prime gaps <= 510");
+      *str = (char) (gap / 2);
+      return str + 1;
+    }
+    case FORMAT_VARINT:
+    {
+      uint64_t gap = prime - prev;
+      for (; gap >= 0x80; gap >>= 7)
+        *str++ = (char) ((gap & 0x7f) | 0x80);
+      *str = (char) gap;
+      return str + 1;
+    }
+    default:
+      str = toChars(prime, str);
+      *str = '\n';
+      return str + 1;
+  }
+}
+
+} // namespace
+
+#endif
@@ -7,12 +7,14 @@
 /// file in the top level directory.
 ///
 
-#ifndef PRIMEGENERATOR_HPP
-#define PRIMEGENERATOR_HPP
+#ifndef PRINTPRIMES_HPP
+#define PRINTPRIMES_HPP
 
 #include "Erat.hpp"
 #include "PreSieve.hpp"
+#include "PrimeGaps.hpp"
 #include "PrimeSieve.hpp"
+#include "uint128.hpp"
 #include "types.hpp"
 
 #include <stdint.h>
@@ -20,35 +22,99 @@
 
 namespace primesieve {
 
-class Store;
+/// What PrintPrimes does with each sieved segment,
+/// PrintPrimes is instantiated for each combination
+/// so that its per-segment loop has no dead code.
+///
+enum Consumer
+{
+  CONSUME_COUNTS   = 1 << 0,
+  CONSUME_PRIMES   = 1 << 1,
+  CONSUME_KTUPLETS = 1 << 2,
+  CONSUME_GAPS     = 1 << 3
+};
+
+/// Consumers needed for the flags of ps
+/// e.g. CONSUME_COUNTS for count_primes()
+///
+int getConsumer(const PrimeSieve& ps);
+
+/// Adds the counts of the COUNT_* flags of the
+/// sieve array words[0, size[ to counts
+///
+using CountFunc = void (*)(const uint64_t* words, uint64_t size, counts_t& counts);
+
+/// Count kernel specialized on the COUNT_* flags
+CountFunc getCountFunc(int flags);
 
 /// After a segment has been sieved PrintPrimes is
 /// used to reconstruct primes and prime k-tuplets from
 /// 1 bits of the sieve array
 ///
+template <int CONSUMER>
 class PrintPrimes : public Erat
 {
 public:
   PrintPrimes(PrimeSieve&);
   void sieve();
 private:
-  enum { END = 0xff + 1 };
-  static const uint64_t bitmasks_[6][5];
   uint64_t low_ = 0;
-  /// Count lookup tables for prime k-tuplets
-  std::vector<byte_t> kCounts_[6];
+  /// Count kernel specialized on the COUNT_* flags,
+  /// nullptr if nothing needs to be counted
+  void (*countSegment_)(const uint64_t*, uint64_t, counts_t&) = nullptr;
+  /// COUNT_* flags
+  int countFlags_ = 0;
+  bool isStatus_;
+  /// Gaps of the primes sieved by this object
+  PrimeGaps::Run gaps_;
+  /// Counts of the primes mod q sieved by this object
+  std::vector<uint64_t> residues_;
+  /// Per bit counts of the bytes i % period_
+  std::vector<uint64_t> residueSums_;
+  uint64_t period_ = 0;
+  /// Sums of the primes sieved by this object
+  uint128 primeSum_;
+  uint128 squareSum_;
+  /// Primes are formatted into this buffer
+  /// before being written to stdout
+  std::vector<char> printBuffer_;
+  /// Previously printed prime, used by
+  /// the delta print formats
+  uint64_t prevPrime_ = 0;
   /// Reference to the associated PrimeSieve object
   PreSieve preSieve_;
   counts_t& counts_;
   PrimeSieve& ps_;
-  void initCounts();
   void print();
-  void countPrimes();
-  void countkTuplets();
-  void printPrimes() const;
-  void printkTuplets() const;
+  void countBins();
+  void countRange(uint64_t, uint64_t, counts_t&) const;
+  void countResidues();
+  void addResidueSums(uint64_t);
+  void sumPrimes();
+  void printPrimes();
+  void addGaps();
+  void printkTuplets();
+  void flush(char*&);
 };
 
+/// Instantiated in PrintPrimes.cpp
+extern template class PrintPrimes<0>;
+extern template class PrintPrimes<1>;
+extern template class PrintPrimes<2>;
+extern template class PrintPrimes<3>;
+extern template class PrintPrimes<4>;
+extern template class PrintPrimes<5>;
+extern template class PrintPrimes<6>;
+extern template class PrintPrimes<7>;
+extern template class PrintPrimes<8>;
+extern template class PrintPrimes<9>;
+extern template class PrintPrimes<10>;
+extern template class PrintPrimes<11>;
+extern template class PrintPrimes<12>;
+extern template class PrintPrimes<13>;
+extern template class PrintPrimes<14>;
+extern template class PrintPrimes<15>;
+
 } // namespace
 
 #endif
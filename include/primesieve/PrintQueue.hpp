@@ -0,0 +1,74 @@
+///
+/// @file  PrintQueue.hpp
+///        Used by ParallelSieve to print primes using multiple
+///        threads. The interval [start, stop] is split into
+///        chunks that are handed out in increasing order. The
+///        output of the oldest unfinished chunk is written to
+///        the output stream (stdout) directly, the output of the other chunks is
+///        buffered until it is their turn.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRINTQUEUE_HPP
+#define PRINTQUEUE_HPP
+
+#include <stdint.h>
+#include <condition_variable>
+#include <cstddef>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <set>
+#include <string>
+
+namespace primesieve {
+
+class PrintQueue
+{
+public:
+  /// @window: Max number of chunks that are sieved or
+  ///          buffered at the same time, bounds the memory
+  ///          usage of the buffered output.
+  ///
+  PrintQueue(uint64_t start,
+             uint64_t stop,
+             uint64_t chunkDist,
+             int window,
+             std::ostream& out = std::cout);
+  /// Get the next chunk [*low, *high] to sieve, blocks
+  /// while the chunk is too far ahead of the output.
+  /// @return false if there is no work left.
+  ///
+  bool next(uint64_t* chunk, uint64_t* low, uint64_t* high);
+  /// Print the output of a chunk, in order
+  void write(uint64_t chunk, const char* data, std::size_t size);
+  /// All output of the chunk has been written
+  void finish(uint64_t chunk);
+  /// Called if a thread fails, wakes up the waiting threads
+  void abort();
+private:
+  uint64_t start_;
+  uint64_t stop_;
+  uint64_t chunkDist_;
+  uint64_t chunks_;
+  uint64_t window_;
+  std::ostream& out_;
+  /// Next chunk to sieve
+  uint64_t next_ = 0;
+  /// Oldest unfinished chunk, its output is not buffered
+  uint64_t head_ = 0;
+  bool aborted_ = false;
+  std::set<uint64_t> finished_;
+  std::map<uint64_t, std::string> buffers_;
+  std::mutex mutex_;
+  std::condition_variable cond_;
+  uint64_t align(uint64_t) const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,72 @@
+///
+/// @file   ResidueCounts.hpp
+/// @brief  Counts of the primes p % q == a for all residues
+///         a of a modulus q. Each thread counts its primes
+///         locally (see PrintPrimes::countResidues()) and adds
+///         them once it has finished sieving its span.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef RESIDUECOUNTS_HPP
+#define RESIDUECOUNTS_HPP
+
+#include "primesieve_error.hpp"
+
+#include <stdint.h>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace primesieve {
+
+class ResidueCounts
+{
+public:
+  ResidueCounts(uint64_t q) :
+    q_(q)
+  {
+    if (q == 0)
+      throw primesieve_error("modulus must be > 0");
+    if (q > (1ull << 30))
+      throw primesieve_error("modulus must be <= 2^30");
+
+    counts_.resize((std::size_t) q, 0);
+  }
+
+  uint64_t modulus() const
+  {
+    return q_;
+  }
+
+  /// counts[a] = number of primes p % q == a
+  const std::vector<uint64_t>& counts() const
+  {
+    return counts_;
+  }
+
+  void add(const std::vector<uint64_t>& counts)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (std::size_t a = 0; a < counts.size(); a++)
+      counts_[a] += counts[a];
+  }
+
+  void addPrime(uint64_t prime)
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counts_[prime % q_]++;
+  }
+
+private:
+  uint64_t q_;
+  std::vector<uint64_t> counts_;
+  std::mutex mutex_;
+};
+
+} // namespace
+
+#endif
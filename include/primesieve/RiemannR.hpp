@@ -0,0 +1,25 @@
+///
+/// @file  RiemannR.hpp
+/// @brief The logarithmic integral li(x) and the Riemann R
+///        function R(x) are very accurate approximations of
+///        the prime counting function pi(x). The inverse
+///        R^-1(n) approximates the nth prime.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef RIEMANNR_HPP
+#define RIEMANNR_HPP
+
+namespace primesieve {
+
+long double li(long double x);
+long double RiemannR(long double x);
+long double RiemannR_inverse(long double x);
+
+} // namespace
+
+#endif
@@ -0,0 +1,76 @@
+///
+/// @file  SegmentCache.hpp
+/// @brief Process-wide LRU cache of sieved segments. Erat stores
+///        each finished segment (if the cache is enabled) and
+///        PrintPrimes and PrimeGenerator consult the cache before
+///        sieving, hence repeated counts and generations of the
+///        same ranges are served from the cache.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include "types.hpp"
+
+#include <stdint.h>
+#include <atomic>
+#include <list>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <vector>
+
+namespace primesieve {
+
+class SegmentCache
+{
+public:
+  /// A segment is identified by its bounds, start > low
+  /// if the bits < start have been unset.
+  ///
+  struct Key
+  {
+    uint64_t low;
+    uint64_t high;
+    uint64_t start;
+    bool operator<(const Key& other) const
+    {
+      return std::tie(low, high, start) <
+             std::tie(other.low, other.high, other.start);
+    }
+  };
+  bool enabled() const { return maxSize_ > 0; }
+  uint64_t getHits() const { return hits_; }
+  uint64_t getMisses() const { return misses_; }
+  void setMaxSize(uint64_t bytes);
+  /// Copy the cached sieve array of the segment
+  bool get(const Key&, byte_t* sieve, uint64_t* sieveSize);
+  void put(const Key&, const byte_t* sieve, uint64_t sieveSize);
+private:
+  struct Entry
+  {
+    Key key;
+    uint64_t sieveSize;
+    std::vector<byte_t> sieve;
+  };
+  std::mutex mutex_;
+  /// Most recently used segment first
+  std::list<Entry> lru_;
+  std::map<Key, std::list<Entry>::iterator> index_;
+  uint64_t size_ = 0;
+  std::atomic<uint64_t> maxSize_{0};
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  void evict(uint64_t maxSize);
+};
+
+SegmentCache& segmentCache();
+
+} // namespace
+
+#endif
@@ -0,0 +1,67 @@
+///
+/// @file  SequenceSieve.hpp
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SEQUENCESIEVE_HPP
+#define SEQUENCESIEVE_HPP
+
+#include "Bucket.hpp"
+#include "MemoryPool.hpp"
+#include "sequence_sieve.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+namespace primesieve {
+
+/// SequenceSieve sieves the index space of a sequence (one bit
+/// per candidate k) with the roots of the sieving primes, see
+/// sequence_sieve.hpp. Sieving primes < segment size cross off
+/// their multiples directly, the big sieving primes are stored
+/// in the bucket list of the segment of their next multiple
+/// (same as EratBig), hence a segment only processes the
+/// sieving primes that have a multiple inside it.
+///
+class SequenceSieve
+{
+public:
+  SequenceSieve(uint64_t start,
+                uint64_t stop,
+                uint64_t maxPrime,
+                const roots_callback& roots);
+  void sieve(const survivors_callback& callback);
+private:
+  struct SmallPrime
+  {
+    uint64_t prime;
+    /// Next multiple relative to the current segment
+    uint64_t next;
+  };
+  uint64_t start_;
+  uint64_t stop_;
+  uint64_t maxPrime_;
+  uint64_t log2SegmentSize_;
+  std::vector<SmallPrime> smallPrimes_;
+  /// lists_[0] holds the big sieving
+  /// primes of the current segment
+  std::vector<Bucket*> lists_;
+  /// List of empty buckets
+  Bucket* stock_ = nullptr;
+  std::vector<pool_ptr<Bucket>> memory_;
+  pool_ptr<uint64_t> bits_;
+  void init(const roots_callback&);
+  void store(uint64_t, uint64_t);
+  void pushBucket(Bucket*&);
+  void crossOffSmall(uint64_t*);
+  void crossOffBig(uint64_t*);
+  static void moveBucket(Bucket&, Bucket*&);
+};
+
+} // namespace
+
+#endif
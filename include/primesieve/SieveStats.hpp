@@ -0,0 +1,141 @@
+///
+/// @file  SieveStats.hpp
+///        Time spent in the phases of the sieve of Eratosthenes,
+///        used by the --stats option of the primesieve console
+///        application. The timers are only run if the calling
+///        thread has enabled stats, else each PhaseTimer costs
+///        a single thread local load. If hw is set the
+///        hardware counters (Linux perf_event) of each phase
+///        are read as well.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SIEVESTATS_HPP
+#define SIEVESTATS_HPP
+
+#include <stdint.h>
+#include <array>
+#include <chrono>
+
+namespace primesieve {
+
+enum SievePhase
+{
+  PHASE_SIEVING_PRIMES,
+  PHASE_PRE_SIEVE,
+  PHASE_ERAT_SMALL,
+  PHASE_ERAT_MEDIUM,
+  PHASE_ERAT_BIG,
+  PHASE_CONSUME,
+  PHASES
+};
+
+enum HwEvent
+{
+  HW_CYCLES,
+  HW_INSTRUCTIONS,
+  HW_BRANCH_MISSES,
+  HW_L1D_MISSES,
+  HW_LLC_MISSES,
+  HW_DTLB_MISSES,
+  HW_EVENTS
+};
+
+using HwCounters = std::array<uint64_t, HW_EVENTS>;
+
+/// All times are thread seconds i.e. summed over all threads
+struct SieveStats
+{
+  std::array<double, PHASES> seconds {};
+  /// Time spent inside PrimeSieve::sieve()
+  double busy = 0;
+  /// threads * wall clock time - busy
+  double idle = 0;
+  int threads = 0;
+  /// Read the hardware counters of each phase
+  bool hw = false;
+  /// Hardware events of each phase, summed over all threads
+  std::array<HwCounters, PHASES> events {};
+  /// Set while a PhaseTimer is running, the time of
+  /// nested timers is added to the outermost phase.
+  bool timing = false;
+
+  void add(const SieveStats& other)
+  {
+    for (int i = 0; i < PHASES; i++)
+    {
+      seconds[i] += other.seconds[i];
+      for (int j = 0; j < HW_EVENTS; j++)
+        events[i][j] += other.events[i][j];
+    }
+    busy += other.busy;
+  }
+
+  /// Zero all stats, keeps hw
+  void reset()
+  {
+    bool readHw = hw;
+    *this = SieveStats();
+    hw = readHw;
+  }
+};
+
+/// Stats of the calling thread, nullptr if disabled
+SieveStats*& threadStats();
+
+/// Read the hardware counters of the calling thread, the
+/// counters are opened at the first call of each thread.
+/// @return false if perf_event is not supported
+///
+bool readHwCounters(HwCounters& counters);
+
+class PhaseTimer
+{
+public:
+  PhaseTimer(SievePhase phase) :
+    phase_(phase),
+    stats_(threadStats())
+  {
+    if (!stats_ || stats_->timing)
+      stats_ = nullptr;
+    else
+    {
+      stats_->timing = true;
+      hw_ = stats_->hw && readHwCounters(counters_);
+      start_ = std::chrono::steady_clock::now();
+    }
+  }
+
+  ~PhaseTimer()
+  {
+    if (stats_)
+    {
+      std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start_;
+      stats_->seconds[phase_] += seconds.count();
+      stats_->timing = false;
+
+      HwCounters counters;
+      if (hw_ && readHwCounters(counters))
+        for (int i = 0; i < HW_EVENTS; i++)
+          stats_->events[phase_][i] += counters[i] - counters_[i];
+    }
+  }
+
+  PhaseTimer(const PhaseTimer&) = delete;
+  PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+private:
+  SievePhase phase_;
+  SieveStats* stats_;
+  bool hw_ = false;
+  HwCounters counters_;
+  std::chrono::steady_clock::time_point start_;
+};
+
+} // namespace
+
+#endif
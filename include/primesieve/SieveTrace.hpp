@@ -0,0 +1,53 @@
+///
+/// @file  SieveTrace.hpp
+///        Timeline of the work done by the ParallelSieve threads:
+///        the spans (or print chunks) of each thread, split into
+///        setup (Erat init, SievingPrimes) and sieving. The events
+///        are written as Chrome trace JSON which can be viewed
+///        using chrome://tracing or https://ui.perfetto.dev.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SIEVETRACE_HPP
+#define SIEVETRACE_HPP
+
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace primesieve {
+
+class SieveTrace
+{
+public:
+  struct Event
+  {
+    const char* name;
+    int thread;
+    /// Microseconds since the trace was created
+    double start;
+    double end;
+    uint64_t low;
+    uint64_t high;
+  };
+  SieveTrace();
+  /// Microseconds since the trace was created
+  double now() const;
+  void add(const Event& event);
+  std::vector<Event> getEvents() const;
+  void write(const std::string& filename) const;
+private:
+  std::chrono::steady_clock::time_point start_;
+  std::vector<Event> events_;
+  mutable std::mutex lock_;
+};
+
+} // namespace
+
+#endif
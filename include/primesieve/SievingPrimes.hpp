@@ -13,18 +13,20 @@
 #include "Erat.hpp"
 
 #include <stdint.h>
+#include <memory>
 #include <vector>
 
 namespace primesieve {
 
 class PreSieve;
+class SievingTable;
 
 class SievingPrimes : public Erat
 {
 public:
   SievingPrimes() { }
-  SievingPrimes(Erat*, PreSieve&);
-  void init(Erat*, PreSieve&);
+  SievingPrimes(Erat*, PreSieve&, const SievingTable* = nullptr);
+  void init(Erat*, PreSieve&, const SievingTable* = nullptr);
   uint64_t next();
 private:
   uint64_t i_ = 0;
@@ -32,10 +34,17 @@ private:
   uint64_t low_ = 0;
   uint64_t tinyIdx_;
   uint64_t sieveIdx_ = ~0ull;
-  uint64_t primes_[64];
+  /// Decoded sieving primes, refilled from
+  /// multiple 64-bit words of the sieve array
+  uint64_t primes_[256];
+  /// Either sieve_ or the shared SievingTable
+  const byte_t* bits_ = nullptr;
+  /// Keeps the prime_table bitmap alive
+  std::shared_ptr<const SievingTable> shared_;
   std::vector<char> tinySieve_;
   void fill();
   void tinySieve();
+  void initTable(const SievingTable&);
   bool sieveSegment();
 };
 
@@ -0,0 +1,99 @@
+///
+/// @file  SievingTable.hpp
+///        Read-only bit array of the sieving primes <= sqrt(stop)
+///        which is shared by all threads of ParallelSieve.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SIEVINGTABLE_HPP
+#define SIEVINGTABLE_HPP
+
+#include "ThreadPool.hpp"
+#include "types.hpp"
+
+#include <stdint.h>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace primesieve {
+
+class MappedFile;
+class cancel_token;
+
+/// The SievingTable is a sieve array of the primes inside
+/// [7, stop] using the same layout as Erat i.e. 8 flags for 30
+/// numbers. The table is sieved once using multiple threads,
+/// afterwards each SievingPrimes object simply iterates over the
+/// table instead of re-sieving the primes <= sqrt(stop).
+/// The table can also be written to a sieving cache file
+/// which other processes memory map read-only, the pages
+/// are shared through the OS page cache.
+///
+class SievingTable
+{
+public:
+  /// Throws primesieve_cancelled once the token is cancelled
+  SievingTable(uint64_t stop,
+               int threads,
+               int sieveSize,
+               ThreadPool& pool = threadPool(),
+               const cancel_token* token = nullptr);
+  /// Memory map a sieving cache file
+  explicit SievingTable(const std::string& filename);
+  ~SievingTable();
+  uint64_t getStop() const { return stop_; }
+  /// Size of the table in bytes (multiple of 8)
+  uint64_t size() const { return size_; }
+  const byte_t* data() const { return table_; }
+  void write(const std::string& filename) const;
+private:
+  uint64_t stop_;
+  uint64_t size_ = 0;
+  const byte_t* table_ = nullptr;
+  std::unique_ptr<byte_t[]> deleter_;
+  std::unique_ptr<MappedFile> file_;
+};
+
+/// Keeps the most recently used SievingTable so that
+/// subsequent computations of a primesieve::context with a
+/// smaller or equal stop number do not need to re-sieve
+/// the sieving primes. Thread-safe.
+///
+class SievingTableCache
+{
+public:
+  std::shared_ptr<const SievingTable> get(uint64_t stop,
+                                          int threads,
+                                          int sieveSize,
+                                          ThreadPool& pool,
+                                          const cancel_token* token = nullptr);
+  void clear();
+private:
+  std::mutex mutex_;
+  std::shared_ptr<const SievingTable> table_;
+};
+
+enum SharedTable
+{
+  PRIME_TABLE,
+  SIEVING_CACHE
+};
+
+/// Install a process-wide SievingTable, i.e. the bitmap
+/// of the prime_table or the sieving cache file.
+///
+void setSharedSievingTable(SharedTable, std::shared_ptr<const SievingTable>);
+
+/// A process-wide SievingTable containing the
+/// primes <= stop, else nullptr.
+///
+std::shared_ptr<const SievingTable> getSharedSievingTable(uint64_t stop);
+
+} // namespace
+
+#endif
@@ -39,6 +39,93 @@ inline std::size_t prime_count_approx(uint64_t start, uint64_t stop)
   return (std::size_t) pix;
 }
 
+/// Used by store_primes_parallel(), appends n uninitialized
+/// primes to the primes container, returns the first new one.
+///
+template <typename T>
+inline void* resize_primes(void* primes, std::size_t n)
+{
+  T& vect = *(T*) primes;
+  std::size_t size = vect.size();
+  vect.resize(size + n);
+  return (void*) (vect.data() + size);
+}
+
+/// Used by store_primes_parallel(), copies the
+/// primes [first, last[ to &primes[offset].
+///
+template <typename V>
+inline void copy_primes(void* primes,
+                        std::size_t offset,
+                        const uint64_t* first,
+                        const uint64_t* last)
+{
+  V* p = (V*) primes + offset;
+  std::size_t n = (std::size_t) (last - first);
+
+  for (std::size_t i = 0; i < n; i++)
+    p[i] = (V) first[i];
+}
+
+using resize_primes_t = void* (*)(void*, std::size_t);
+using copy_primes_t = void (*)(void*, std::size_t, const uint64_t*, const uint64_t*);
+
+/// Store the primes inside ]start, stop] if stop <= limit
+/// of the small_prime_table(), the primes are decoded from
+/// the table without sieving.
+/// @return false if stop is too large, the primes are
+///         not stored.
+///
+bool store_small_primes(uint64_t start,
+                        uint64_t stop,
+                        void* primes,
+                        resize_primes_t resize,
+                        copy_primes_t copy);
+
+/// Store the primes inside ]start, stop] using multiple threads.
+/// [start, stop] is split into one part per thread, the primes
+/// of each part are counted first so that each thread can then
+/// store its primes in its own slice of the primes container.
+/// @return false if the distance is too small for multiple
+///         threads, the primes are not stored.
+///
+bool store_primes_parallel(uint64_t start,
+                           uint64_t stop,
+                           void* primes,
+                           resize_primes_t resize,
+                           copy_primes_t copy);
+
+/// Store the first n primes > start using multiple threads.
+/// @return false if n is too small for multiple threads,
+///         the primes are not stored.
+///
+bool store_n_primes_parallel(uint64_t n,
+                             uint64_t start,
+                             void* primes,
+                             resize_primes_t resize,
+                             copy_primes_t copy);
+
+/// Store the primes inside ]start, stop] if stop < 2^32, the
+/// primes are decoded from the sieve array straight into the
+/// vector using 32-bit arithmetic, without primesieve::iterator.
+/// @return false if stop is too large, the primes are
+///         not stored.
+///
+bool store_primes32(uint64_t start,
+                    uint64_t stop,
+                    std::vector<uint32_t>& primes);
+
+template <typename T>
+inline bool store_primes32(uint64_t, uint64_t, T&)
+{
+  return false;
+}
+
+/// The primes are copied from primesieve::iterator in bulk,
+/// one buffer at a time instead of one next_prime() call per
+/// prime. For narrow types (e.g. uint32_t) the conversion loop
+/// inside insert() is vectorized by the compiler.
+///
 template <typename T>
 inline void store_primes(uint64_t start,
                          uint64_t stop,
@@ -49,17 +136,26 @@ inline void store_primes(uint64_t start,
   if (~stop == 0)
     stop--;
 
-  if (start < stop)
-  {
-    using V = typename T::value_type;
-    std::size_t size = primes.size() + prime_count_approx(start, stop);
-    primes.reserve(size);
-
-    primesieve::iterator it(start, stop);
-    uint64_t prime = it.next_prime();
-    for (; prime <= stop; prime = it.next_prime())
-      primes.push_back((V) prime);
-  }
+  using V = typename T::value_type;
+  if (start >= stop ||
+      store_small_primes(start, stop, &primes, resize_primes<T>, copy_primes<V>) ||
+      store_primes_parallel(start, stop, &primes, resize_primes<T>, copy_primes<V>) ||
+      store_primes32(start, stop, primes))
+    return;
+
+  std::size_t size = primes.size() + prime_count_approx(start, stop);
+  primes.reserve(size);
+
+  const uint64_t* first;
+  const uint64_t* last;
+  primesieve::iterator it(start, stop);
+  it.next_primes(&first, &last);
+
+  for (; last[-1] <= stop; it.next_primes(&first, &last))
+    primes.insert(primes.end(), first, last);
+
+  for (; *first <= stop; first++)
+    primes.push_back((V) *first);
 }
 
 template <typename T>
@@ -72,9 +168,12 @@ inline void store_n_primes(uint64_t n,
   if (start > 0)
     start--;
 
+  using V = typename T::value_type;
+  if (store_n_primes_parallel(n, start, &primes, resize_primes<T>, copy_primes<V>))
+    return;
+
   std::size_t size = primes.size() + (std::size_t) n;
   primes.reserve(size);
-  using V = typename T::value_type;
 
   double x = (double) start;
   x = std::max(10.0, x);
@@ -82,13 +181,23 @@ inline void store_n_primes(uint64_t n,
   uint64_t dist = n * (logx + 1);
   uint64_t stop = start + dist;
 
+  const uint64_t* first;
+  const uint64_t* last;
   primesieve::iterator it(start, stop);
-  uint64_t prime = it.next_prime();
-  for (; n > 0; n--, prime = it.next_prime())
-    primes.push_back((V) prime);
 
-  if (~prime == 0)
-    throw primesieve_error("cannot generate primes > 2^64");
+  while (n > 0)
+  {
+    it.next_primes(&first, &last);
+    uint64_t count = (uint64_t) (last - first);
+    count = std::min(count, n);
+    last = first + count;
+    n -= count;
+
+    if (~last[-1] == 0)
+      throw primesieve_error("cannot generate primes > 2^64");
+
+    primes.insert(primes.end(), first, last);
+  }
 }
 
 } // namespace
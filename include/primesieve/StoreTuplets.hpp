@@ -0,0 +1,37 @@
+///
+/// @file  StoreTuplets.hpp
+///        Store the first members of the prime k-tuplets of an
+///        interval, used by primesieve::generate_tuplets() and
+///        primesieve_generate_tuplets().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef STORETUPLETS_HPP
+#define STORETUPLETS_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <functional>
+
+namespace primesieve {
+
+/// Returns an array of size elements for the tuplets
+using tuplets_allocator = std::function<uint64_t*(std::size_t size)>;
+
+/// Sieve [start, stop] using all threads and store the first
+/// member of each k-tuplet (in increasing order) in the array
+/// returned by allocate, which is called once.
+/// @pre 2 <= k <= 6
+///
+void store_tuplets(int k,
+                   uint64_t start,
+                   uint64_t stop,
+                   const tuplets_allocator& allocate);
+
+} // namespace
+
+#endif
@@ -0,0 +1,109 @@
+///
+/// @file  ThreadPool.hpp
+///        Process-wide pool of worker threads used by ParallelSieve.
+///        The worker threads are started lazily the first time a
+///        multi-threaded computation is run and they are reused by
+///        all subsequent computations. Concurrent computations
+///        share the workers fairly, see yield().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace primesieve {
+
+class ThreadPool
+{
+public:
+  ThreadPool();
+  ~ThreadPool();
+  /// Execute task() on up to threads threads concurrently,
+  /// the calling thread executes task() too. The job has
+  /// the priority of the calling thread.
+  void run(int threads, const std::function<void()>& task);
+  /// Queue task() for execution on a worker thread
+  /// and return without waiting for it.
+  void submit(const std::function<void()>& task);
+  /// Called by a task of run() between its chunks of work.
+  /// Returns true if the worker thread should return from
+  /// the task because a queued job has a higher priority or
+  /// the same priority and fewer threads. The task is
+  /// resumed later on an idle worker. Always false for the
+  /// calling thread of run().
+  bool yield();
+  /// Priority of the jobs of the calling thread, jobs
+  /// with a higher priority are executed first.
+  /// Default 0, a thread-local setting.
+  static void setPriority(int priority);
+  static int getPriority();
+  /// Stop and join all worker threads
+  void shutdown();
+  /// Pin the worker threads to CPUs, the workers
+  /// are spread evenly across the NUMA nodes.
+  void setPinThreads(bool pin);
+  bool getPinThreads();
+  /// By default the threads free their cached memory
+  /// (see MemoryPool) when a job ends, if keep is true
+  /// the memory is reused by the next job.
+  void setKeepMemory(bool keep);
+  int getNumWorkers();
+private:
+  struct Job
+  {
+    std::function<void()> task;
+    std::mutex lock;
+    std::condition_variable finished;
+    std::exception_ptr error;
+    int running = 0;
+    int priority = 0;
+    bool closed = false;
+    Job(const std::function<void()>& t) : task(t), priority(getPriority()) { }
+    bool enter();
+    void leave();
+    void execute();
+  };
+  std::mutex mutex_;
+  std::mutex shutdownMutex_;
+  std::condition_variable wakeup_;
+  std::deque<std::shared_ptr<Job>> queue_;
+  std::vector<std::thread> workers_;
+  bool stop_ = false;
+  bool pin_ = false;
+  std::atomic<bool> keepMemory_{false};
+  /// Incremented by setPinThreads()
+  int pinEpoch_ = 0;
+  /// CPUs for pinning, see getCpuOrder()
+  std::vector<int> cpus_;
+  /// CPUs of the unpinned process
+  std::vector<int> allowedCpus_;
+  /// Job of the task executed by the worker thread
+  static thread_local Job* workerJob_;
+  static thread_local bool yielded_;
+  void enqueue(const std::shared_ptr<Job>&);
+  void startWorkers(int);
+  void worker(int);
+  std::vector<int> getCpus(int) const;
+  void updateAffinity(const std::vector<int>&);
+};
+
+/// Singleton (started lazily)
+ThreadPool& threadPool();
+
+} // namespace
+
+#endif
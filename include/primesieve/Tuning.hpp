@@ -0,0 +1,75 @@
+///
+/// @file  Tuning.hpp
+///        Sieve size, EratSmall/EratMedium thresholds and minimum
+///        thread distance measured by primesieve --autotune for
+///        bands of stop numbers. The tuning file is loaded once
+///        per process from $PRIMESIEVE_TUNING (empty = disabled)
+///        or Tuning::defaultFilename(), without a tuning file
+///        the defaults of config.hpp and a built-in table of
+///        sieve sizes are used.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef TUNING_HPP
+#define TUNING_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace primesieve {
+
+/// Tuned parameters for stop numbers <= maxStop
+struct TuningBand
+{
+  uint64_t maxStop;
+  /// Sieve size in KiB, 0 = default (CpuInfo)
+  int sieveSize;
+  /// Replace config::FACTOR_ERATSMALL and FACTOR_ERATMEDIUM
+  double factorEratSmall;
+  double factorEratMedium;
+  /// Replaces config::MIN_THREAD_DISTANCE
+  uint64_t minThreadDistance;
+};
+
+class Tuning
+{
+public:
+  /// Band with the smallest maxStop >= stop,
+  /// the defaults if there is no such band
+  TuningBand band(uint64_t stop) const;
+  void add(TuningBand band);
+  const std::vector<TuningBand>& bands() const { return bands_; }
+  bool empty() const { return bands_.empty(); }
+  void load(const std::string& filename);
+  void save(const std::string& filename) const;
+  static TuningBand defaults(uint64_t maxStop);
+  static int builtinSieveSize(uint64_t stop, int threads);
+  static std::string defaultFilename();
+private:
+  /// Sorted by maxStop
+  std::vector<TuningBand> bands_;
+};
+
+/// Tuned parameters of the process for the stop number
+TuningBand getTuning(uint64_t stop);
+
+/// Replace the tuning of the process (used by
+/// --autotune to benchmark candidate values)
+void setTuning(const Tuning& tuning);
+
+/// Sieve size in KiB for sieving [start, stop] using the given
+/// number of threads: set_sieve_size() if set by the user, else
+/// the tuned sieve size of the band, else the built-in sieve
+/// size of the stop number. The sieve size is reduced if the
+/// distance is smaller.
+///
+int tunedSieveSize(uint64_t start, uint64_t stop, int threads);
+
+} // namespace
+
+#endif
@@ -0,0 +1,65 @@
+///
+/// @file  TupletSieve.hpp
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef TUPLETSIEVE_HPP
+#define TUPLETSIEVE_HPP
+
+#include "MemoryPool.hpp"
+#include "PrimeSieve.hpp"
+#include "types.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+namespace primesieve {
+
+/// TupletSieve counts prime quintuplets and sextuplets without
+/// sieving all primes. All admissible quintuplets and sextuplets
+/// > 210 start at a few residues mod 210 (e.g. all sextuplets
+/// start at 210k + 97). For each such residue class TupletSieve
+/// uses a sieve array with one bit per candidate k and removes
+/// the k for which any member of the constellation has a prime
+/// factor <= sqrt(stop). Hence it only crosses off about 1/9 of
+/// the multiples of the normal sieve of Eratosthenes.
+///
+class TupletSieve
+{
+public:
+  /// True if only quintuplets or only sextuplets
+  /// are counted and start is large enough
+  static bool isSupported(const PrimeSieve&);
+  TupletSieve(PrimeSieve&);
+  void sieve();
+private:
+  /// Candidates 210 * k + residue
+  struct Class
+  {
+    int index = 0;
+    uint64_t residue = 0;
+    /// Offsets of the members, the first is 0
+    std::vector<uint64_t> offsets;
+    /// Candidates within [start, stop]
+    uint64_t kLow = 1;
+    uint64_t kHigh = 0;
+    pool_ptr<uint64_t> bits;
+  };
+  uint64_t start_;
+  uint64_t stop_;
+  /// Candidates per sieve array
+  uint64_t segmentSize_;
+  std::vector<Class> classes_;
+  PrimeSieve& ps_;
+  void initStop(uint64_t);
+  void sieveSegment(uint64_t);
+  void crossOff(uint64_t, uint64_t);
+};
+
+} // namespace
+
+#endif
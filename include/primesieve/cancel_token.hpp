@@ -0,0 +1,81 @@
+///
+/// @file  cancel_token.hpp
+/// @brief A cancel_token allows to stop a long running computation
+///        e.g. primesieve::count_primes() from another thread or
+///        once a deadline has passed. The worker threads check the
+///        token after each sieved segment and throw a
+///        primesieve::primesieve_cancelled exception.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_CANCEL_TOKEN_HPP
+#define PRIMESIEVE_CANCEL_TOKEN_HPP
+
+#include <atomic>
+#include <chrono>
+
+namespace primesieve {
+
+class cancel_token
+{
+public:
+  using clock = std::chrono::steady_clock;
+
+  cancel_token() :
+    cancelled_(false),
+    deadline_(0)
+  { }
+
+  /// Request the cancellation, thread-safe.
+  void cancel()
+  {
+    cancelled_.store(true, std::memory_order_relaxed);
+  }
+
+  /// Cancel automatically once the deadline has passed.
+  void set_deadline(clock::time_point deadline)
+  {
+    deadline_.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+  }
+
+  /// Cancel automatically once the timeout (from now) has passed.
+  template <typename Rep, typename Period>
+  void set_timeout(const std::chrono::duration<Rep, Period>& timeout)
+  {
+    set_deadline(clock::now() + std::chrono::duration_cast<clock::duration>(timeout));
+  }
+
+  /// Clear the cancellation and the deadline
+  /// so that the token can be reused.
+  void reset()
+  {
+    cancelled_.store(false, std::memory_order_relaxed);
+    deadline_.store(0, std::memory_order_relaxed);
+  }
+
+  bool is_cancelled() const
+  {
+    if (cancelled_.load(std::memory_order_relaxed))
+      return true;
+
+    auto deadline = deadline_.load(std::memory_order_relaxed);
+    return deadline != 0 &&
+           clock::now().time_since_epoch().count() >= deadline;
+  }
+
+  cancel_token(const cancel_token&) = delete;
+  cancel_token& operator=(const cancel_token&) = delete;
+
+private:
+  std::atomic<bool> cancelled_;
+  /// 0 if no deadline
+  std::atomic<clock::rep> deadline_;
+};
+
+} // namespace
+
+#endif
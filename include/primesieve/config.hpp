@@ -12,6 +12,7 @@
 #define CONFIG_HPP
 
 #include <stdint.h>
+#include <cstddef>
 
 /// Disable assert() by default
 #if !defined(DEBUG) && !defined(NDEBUG)
@@ -36,6 +37,22 @@ enum {
   ///
   BYTES_PER_ALLOC = (1 << 20) * 8,
 
+  /// Maximum sieve size in KiB, the sieve size need not be a
+  /// power of 2. The multipleIndex of a SievingPrime has 23
+  /// bits, hence the sieve array must be <= 2^23 bytes.
+  ///
+  MAX_SIEVE_SIZE = 8192,
+
+  /// EratBig uses one bucket list per segment, each list holds
+  /// at least one partially filled bucket (8 KiB). If more lists
+  /// would be needed (i.e. huge stop numbers with a small sieve
+  /// size) EratBig switches to a two-level bucket hierarchy
+  /// which bounds the number of lists. The hierarchy moves each
+  /// sieving prime one more time, hence it is not used for
+  /// fewer lists.
+  ///
+  MAX_BUCKET_LISTS = 1 << 12,
+
   /// primesieve::iterator caches at least MIN_CACHE_ITERATOR
   /// bytes of primes. Larger is usually faster but also
   /// requires more memory.
@@ -43,9 +60,63 @@ enum {
   MIN_CACHE_ITERATOR = (1 << 20) * 8,
 
   /// primesieve::iterator maximum cache size in bytes, used if
-  /// pi(sqrt(n)) * 8 bytes > MAX_CACHE_ITERATOR.
+  /// pi(sqrt(n)) * 8 bytes > MAX_CACHE_ITERATOR. This is the
+  /// default of primesieve::set_iterator_memory_limit().
+  ///
+  MAX_CACHE_ITERATOR = (1 << 20) * 1024,
+
+  /// primesieve::iterator multiplies its sieving distance by
+  /// ITERATOR_GROWTH after each refill (until the minimum cache
+  /// size is reached for prev_prime()), this is the default
+  /// of primesieve::set_iterator_growth().
+  ///
+  ITERATOR_GROWTH = 4,
+
+  /// Number of primes decoded per refill of the
+  /// primesieve::iterator buffer. Each refill decodes as many
+  /// 64-bit words of the sieve array as fit (a word holds up
+  /// to 64 primes), this amortizes the cost per refill.
+  ///
+  ITERATOR_BUFFER = 1 << 10,
+
+  /// Number of primes per buffer of primesieve::prefetch_iterator.
+  /// The buffers are handed from the helper thread to the caller
+  /// under a lock, hence they must be much larger than the
+  /// primesieve::iterator buffer.
+  ///
+  PREFETCH_BUFFER = 1 << 16,
+
+  /// Each thread's MemoryPool keeps up to MAX_CACHE_POOL bytes
+  /// (at most the memory limit) of freed memory (sieve arrays,
+  /// buckets) for reuse by the next sieving chunk. The memory
+  /// is freed when the computation ends.
+  ///
+  MAX_CACHE_POOL = (1 << 20) * 256,
+
+  /// Size of the sieve array of each residue class used by
+  /// TupletSieve for counting quintuplets (4 classes) and
+  /// sextuplets (1 class). Larger segments reduce the
+  /// per segment cost of the sieving primes > segment size.
+  ///
+  TUPLET_SIEVE_BYTES = 1 << 20,
+
+  /// Size of the survivor bitmap of SequenceSieve (1 bit per
+  /// candidate), at most (SievingPrime::MAX_MULTIPLEINDEX + 1) / 8
+  /// bytes as the big sieving primes are stored in buckets.
+  ///
+  SEQUENCE_SIEVE_BYTES = 1 << 18,
+
+  /// Minimum number of numbers per segment of factor_tables(),
+  /// each number uses 26 bytes. The segment size grows up to
+  /// 32 times for large stop numbers so that the cost of finding
+  /// the first multiple of each sieving prime does not dominate.
+  ///
+  FACTOR_TABLE_SIZE = 1 << 15,
+
+  /// Size of the page aligned buffer of the stdout OutputSink,
+  /// each full buffer is written using a single write().
   ///
-  MAX_CACHE_ITERATOR = (1 << 20) * 1024
+  OUTPUT_BUFFER = 1 << 20
 };
 
   /// Sieving primes <= (sieveSize in bytes * FACTOR_ERATSMALL)
@@ -75,6 +146,118 @@ enum {
   ///
   const uint64_t MIN_THREAD_DISTANCE = (uint64_t) 1e7;
 
+  /// If [start, stop] is too small to be split among the threads
+  /// of ParallelSieve, the sieving primes are split instead if
+  /// sqrt(stop) >= MIN_PRIME_PARTITION. Each thread sieves the
+  /// whole interval into a private bitmap of
+  /// (stop - start) / 30 bytes, hence
+  /// stop - start <= MAX_PRIME_PARTITION_DISTANCE.
+  ///
+  const uint64_t MIN_PRIME_PARTITION = (uint64_t) 1e7;
+  const uint64_t MAX_PRIME_PARTITION_DISTANCE = (uint64_t) 1e9;
+
+  /// The sieving primes are split into PRIME_PARTITIONS_PER_THREAD
+  /// pieces per thread, the threads claim the pieces one by one.
+  ///
+  const int PRIME_PARTITIONS_PER_THREAD = 4;
+
+  /// Chunk size of the CountCache, a multiple of 30 so that
+  /// the chunk bounds are aligned like the spans of the
+  /// ChunkScheduler. Intervals are assembled from the cached
+  /// chunks, the edges < COUNT_CACHE_CHUNK are sieved.
+  ///
+  const uint64_t COUNT_CACHE_CHUNK = 30ull << 22;
+
+  /// The status of a multi-threaded sieve is updated
+  /// every STATUS_INTERVAL milliseconds.
+  ///
+  const int STATUS_INTERVAL = 100;
+
+  /// Count quintuplets and sextuplets using TupletSieve if
+  /// start >= MIN_TUPLET_SIEVE. TupletSieve iterates over all
+  /// sieving primes for each segment and needs
+  /// start > sqrt(stop).
+  ///
+  const uint64_t MIN_TUPLET_SIEVE = (uint64_t) 1e10;
+
+  /// primesieve::iterator caches its sieving primes in a
+  /// SievingTable if sqrt(stop) >= MIN_SIEVING_TABLE,
+  /// smaller sieving primes are re-sieved quickly.
+  ///
+  const uint64_t MIN_SIEVING_TABLE = 1 << 16;
+
+  /// After skipto(start) with start >= MIN_MILLER_RABIN
+  /// primesieve::iterator finds the first MILLER_RABIN_PRIMES
+  /// primes using the Miller-Rabin primality test. For a few
+  /// primes this is much faster than sieving which needs to
+  /// set up a whole segment and all primes <= sqrt(stop).
+  ///
+  const uint64_t MIN_MILLER_RABIN = (uint64_t) 1e10;
+  const std::size_t MILLER_RABIN_PRIMES = 16;
+
+  /// primesieve::is_prime(n), count_primes() and generate_primes()
+  /// look up n, stop <= SMALL_PRIME_TABLE in a prime_table
+  /// (SMALL_PRIME_TABLE / 30 bytes) which is built at the first
+  /// call, hence tiny ranges do not pay the setup of a sieve.
+  ///
+  const uint64_t SMALL_PRIME_TABLE = 1 << 22;
+
+  /// The batch primesieve::is_prime() sieves runs of at least
+  /// MIN_IS_PRIME_SIEVE numbers whose neighbours are at most
+  /// IS_PRIME_GAP apart. Sieving such a run costs less than
+  /// Miller-Rabin on each number.
+  ///
+  const std::size_t MIN_IS_PRIME_SIEVE = 1000;
+  const uint64_t IS_PRIME_GAP = 256;
+
+  /// primesieve::count_primes_batch() sieves through nearby
+  /// intervals in a single sweep, if the gap to the next interval
+  /// is larger than COUNT_BATCH_GAP the sweep is repositioned
+  /// (new iterator) instead of sieving the gap.
+  ///
+  const uint64_t COUNT_BATCH_GAP = (uint64_t) 1e7;
+
+  /// When printing primes using multiple threads each thread
+  /// sieves chunks of PRINT_CHUNK_DISTANCE numbers. The output
+  /// of up to 2 chunks per thread is buffered in memory
+  /// (about 20 MB per chunk near 10^12).
+  ///
+  const uint64_t PRINT_CHUNK_DISTANCE = (uint64_t) 3e7;
+
+  /// A prime archive stores the primes in blocks of
+  /// ARCHIVE_BLOCK_DISTANCE numbers, finding a prime in the
+  /// archive decodes at most one block (about 38,000 primes
+  /// near 10^12).
+  ///
+  const uint64_t ARCHIVE_BLOCK_DISTANCE = 1 << 20;
+
+  /// primesieve::count_primes(start, stop) uses the LMO prime
+  /// counting algorithm instead of sieving if stop >= MIN_LMO_STOP
+  /// and stop - start > LMO_FACTOR * stop^(2/3), for
+  /// pi(stop) - pi(start - 1) the cost is doubled.
+  ///
+  const uint64_t MIN_LMO_STOP = (uint64_t) 1e8;
+  const double LMO_FACTOR = 10;
+
+  /// Max y = alpha * x^(1/3) of the LMO algorithm, limits its
+  /// lookup tables to about 40 MB.
+  ///
+  const uint64_t MAX_LMO_Y = 1 << 22;
+
+  /// ParallelSieve counts the primes on the GPU if enabled
+  /// (setGpu(true), cmake -DWITH_OPENCL=ON) and if
+  /// stop <= MAX_GPU_STOP and stop - start >= MIN_GPU_DISTANCE.
+  /// Above MAX_GPU_STOP the EratBig bucket sieve of the CPU
+  /// is faster than crossing off each sieving prime per batch.
+  ///
+  const uint64_t MAX_GPU_STOP = (uint64_t) 1e14;
+  const uint64_t MIN_GPU_DISTANCE = (uint64_t) 1e9;
+
+  /// Numbers per GPU batch (2^31), the batch is
+  /// sieved in a 128 MiB bitmap in GPU memory.
+  ///
+  const uint64_t GPU_BATCH_DISTANCE = (uint64_t) 1 << 31;
+
 } // namespace config
 } // namespace primesieve
 
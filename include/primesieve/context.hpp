@@ -0,0 +1,103 @@
+///
+/// @file  context.hpp
+/// @brief A primesieve::context has its own settings, its own
+///        thread pool and caches. Each tenant of a process can
+///        use its own context, the computations of different
+///        contexts do not share any mutable state. The
+///        functions in primesieve.hpp instead use process-wide
+///        settings and a process-wide thread pool.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_CONTEXT_HPP
+#define PRIMESIEVE_CONTEXT_HPP
+
+#include "cancel_token.hpp"
+
+#include <stdint.h>
+#include <future>
+#include <memory>
+
+namespace primesieve {
+
+/// The member functions are thread-safe, i.e. a context
+/// may be used by multiple threads concurrently.
+///
+class context
+{
+public:
+  context();
+  ~context();
+  context(const context&) = delete;
+  context& operator=(const context&) = delete;
+
+  /// Get the current set sieve size in KiB
+  int get_sieve_size() const;
+  /// Get the current set number of threads
+  int get_num_threads() const;
+  /// Get the current set memory limit in bytes, 0 = unlimited
+  uint64_t get_memory_limit() const;
+  /// Get whether the threads of the context are pinned to CPUs
+  bool get_pin_threads() const;
+
+  /// Set the sieve size in KiB (kibibyte).
+  /// The best sieving performance is achieved with a sieve size
+  /// of your CPU's L1 or L2 cache size (per core).
+  /// @pre sieve_size >= 8 && <= 8192.
+  ///
+  void set_sieve_size(int sieve_size);
+
+  /// Set the number of threads of the context.
+  /// By default all CPU cores are used.
+  ///
+  void set_num_threads(int num_threads);
+
+  /// Limit the memory usage in bytes of the context,
+  /// see primesieve::set_memory_limit().
+  ///
+  void set_memory_limit(uint64_t bytes);
+
+  /// Pin the threads of the context to CPUs,
+  /// see primesieve::set_pin_threads().
+  ///
+  void set_pin_threads(bool pin);
+
+  uint64_t nth_prime(int64_t n, uint64_t start = 0);
+  uint64_t nth_prime(int64_t n, uint64_t start, const cancel_token& token);
+  uint64_t count_primes(uint64_t start, uint64_t stop);
+  uint64_t count_primes(uint64_t start, uint64_t stop, const cancel_token& token);
+  uint64_t count_twins(uint64_t start, uint64_t stop);
+  uint64_t count_triplets(uint64_t start, uint64_t stop);
+  uint64_t count_quadruplets(uint64_t start, uint64_t stop);
+  uint64_t count_quintuplets(uint64_t start, uint64_t stop);
+  uint64_t count_sextuplets(uint64_t start, uint64_t stop);
+  /// Count the primes and prime k-tuplets in a single pass,
+  /// bit k - 1 of kmask selects the primes (k = 1) or the
+  /// prime k-tuplets (k <= 6), counts[k - 1] is set for
+  /// the selected k and 0 otherwise.
+  ///
+  void count(uint64_t start, uint64_t stop, int kmask, uint64_t counts[6]);
+
+  /// Queued on the thread pool of the context,
+  /// see primesieve::count_primes_async().
+  ///
+  std::future<uint64_t> nth_prime_async(int64_t n, uint64_t start = 0);
+  std::future<uint64_t> count_primes_async(uint64_t start, uint64_t stop);
+
+  /// Free the cached sieving primes and stop
+  /// the threads of the context.
+  ///
+  void clear_cache();
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace
+
+#endif
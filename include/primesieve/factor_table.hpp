@@ -0,0 +1,69 @@
+///
+/// @file   factor_table.hpp
+/// @brief  Segmented tables of the smallest prime factor, the
+///         Moebius function mu(n), Euler's totient phi(n) and
+///         the number of distinct prime factors omega(n) of
+///         the numbers inside [start, stop].
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_FACTOR_TABLE_HPP
+#define PRIMESIEVE_FACTOR_TABLE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <functional>
+
+namespace primesieve {
+
+/// The tables of the numbers [low, low + size[, index i
+/// corresponds to the number low + i. spf(0) = 0, spf(1) = 1
+/// and a prime is its own smallest prime factor. The
+/// tables are only valid during the callback.
+///
+struct factor_segment
+{
+  uint64_t low;
+  std::size_t size;
+  const uint64_t* spf;
+  const int8_t* moebius;
+  const uint64_t* phi;
+  const uint8_t* omega;
+};
+
+using factor_callback = std::function<void(const factor_segment&)>;
+
+/// Same as factor_callback, thread is the number of
+/// the calling worker thread (0 <= thread < threads).
+///
+using parallel_factor_callback = std::function<void(int thread, const factor_segment&)>;
+
+/// Pass the tables of each segment of [start, stop]
+/// (in increasing order) to the callback.
+///
+void factor_tables(uint64_t start, uint64_t stop, const factor_callback& callback);
+
+/// Compute the tables of [start, stop] using up to threads
+/// threads (threads <= 0 uses get_num_threads()), the callback
+/// is called concurrently by the worker threads. The segments
+/// of each thread are in increasing order, there is no order
+/// across threads.
+///
+void factor_tables(uint64_t start, uint64_t stop, int threads, const parallel_factor_callback& callback);
+
+/// Fill the caller's array of stop - start + 1 elements,
+/// array[i] corresponds to the number start + i.
+/// These use all threads (get_num_threads()).
+///
+void smallest_prime_factors(uint64_t start, uint64_t stop, uint64_t* spf);
+void moebius(uint64_t start, uint64_t stop, int8_t* mu);
+void euler_phi(uint64_t start, uint64_t stop, uint64_t* phi);
+void prime_factor_counts(uint64_t start, uint64_t stop, uint8_t* omega);
+
+} // namespace
+
+#endif
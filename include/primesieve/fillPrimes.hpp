@@ -0,0 +1,46 @@
+///
+/// @file  fillPrimes.hpp
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef FILLPRIMES_HPP
+#define FILLPRIMES_HPP
+
+#include "types.hpp"
+
+#include <stdint.h>
+
+namespace primesieve {
+
+/// Decode the 64-bit words of sieve[*sieveIdx, sieveSize[ into
+/// primes (each set bit corresponds to a prime). Stops early
+/// once fewer than 64 entries of primes[size] are left, as a
+/// word holds up to 64 primes. Updates sieveIdx and low.
+/// @return Number of primes stored
+///
+uint64_t fillPrimes(const byte_t* sieve,
+                    uint64_t* sieveIdx,
+                    uint64_t sieveSize,
+                    uint64_t* low,
+                    uint64_t* primes,
+                    uint64_t size);
+
+/// Same as above for primes < 2^32, the primes are decoded
+/// using 32-bit arithmetic which stores twice as many
+/// primes per SIMD instruction.
+/// @pre the primes inside the sieve array are < 2^32
+///
+uint64_t fillPrimes(const byte_t* sieve,
+                    uint64_t* sieveIdx,
+                    uint64_t sieveSize,
+                    uint64_t* low,
+                    uint32_t* primes,
+                    uint64_t size);
+
+} // namespace
+
+#endif
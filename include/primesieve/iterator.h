@@ -81,6 +81,26 @@ static inline uint64_t primesieve_next_prime(primesieve_iterator* it)
   return it->primes[it->i];
 }
 
+/**
+ * Store the next n primes in primes[0, n[, this is the same
+ * as calling primesieve_next_prime() n times but faster.
+ */
+void primesieve_next_primes(primesieve_iterator* it, uint64_t* primes, size_t n);
+
+/**
+ * Store the next primes <= stop in the caller's buffer, at most
+ * size primes are stored. This function can be called repeatedly
+ * to stream the primes <= stop through a small reused buffer,
+ * no memory is allocated for the returned primes.
+ * @param written  Set to the number of primes stored.
+ * @param type     The type of the primes, e.g. INT_PRIMES
+ *                 (see primesieve.h).
+ * @return 1 if the buffer is full (call again to continue),
+ *         0 if there are no more primes <= stop,
+ *         -1 if an error occurred (errno is set).
+ */
+int primesieve_fill_next_primes(primesieve_iterator* it, uint64_t stop, void* primes, size_t size, size_t* written, int type);
+
 /**
  * Get the previous prime.
  * primesieve_prev_prime(n) = 0 if n <= 2.
@@ -19,7 +19,9 @@
 
 namespace primesieve {
 
+class GapBuffer;
 class PrimeGenerator;
+class SievingTable;
 
 uint64_t get_max_stop();
 
@@ -70,6 +72,18 @@ public:
     return primes_[i_];
   }
 
+  /// Get the next primes in bulk, they are stored in
+  /// [*first, *last[. The following next_prime() call
+  /// returns the prime after *(last - 1). The last range
+  /// ends with UINT64_MAX if next prime > 2^64.
+  ///
+  void next_primes(const uint64_t** first, const uint64_t** last);
+
+  /// Store the next n primes in primes[0, n[, this is the
+  /// same as calling next_prime() n times but faster.
+  ///
+  void next_primes(uint64_t* primes, std::size_t n);
+
   ~iterator();
 private:
   std::size_t i_;
@@ -80,6 +94,12 @@ private:
   uint64_t stop_hint_;
   uint64_t dist_;
   std::unique_ptr<PrimeGenerator> primeGenerator_;
+  /// prev_prime() primes not yet in primes_,
+  /// see set_iterator_compression()
+  std::unique_ptr<GapBuffer> gapBuffer_;
+  /// Sieving primes <= sqrt(max stop), they are kept
+  /// across skipto() and reused by each new interval
+  std::shared_ptr<const SievingTable> sievingTable_;
   void generate_next_primes();
   void generate_prev_primes();
 };
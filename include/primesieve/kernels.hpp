@@ -0,0 +1,53 @@
+///
+/// @file  kernels.hpp
+/// @brief The SIMD kernels of the functions that are dispatched
+///        at runtime. Each list contains the kernels supported
+///        by the CPU, the portable kernel first and the kernel
+///        chosen at runtime last. The tests check each kernel
+///        against the portable kernel.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include "types.hpp"
+
+#include <stdint.h>
+#include <vector>
+
+namespace primesieve {
+
+template <typename Func>
+struct Kernel
+{
+  const char* name;
+  Func func;
+};
+
+using PopcountFunc = uint64_t (*)(const uint64_t*, uint64_t);
+
+std::vector<Kernel<PopcountFunc>> getPopcountKernels();
+
+/// fillPrimes() for uint64_t and uint32_t primes
+template <typename T>
+using FillFunc = uint64_t (*)(const byte_t*, uint64_t*, uint64_t, uint64_t*, T*, uint64_t);
+
+template <typename T>
+std::vector<Kernel<FillFunc<T>>> getFillKernels();
+
+/// Number of bytes of words[0...n] (n < 256) that
+/// contain all 1 bits of mask, used for counting
+/// the prime k-tuplets.
+///
+using CountMatchesFunc = uint64_t (*)(const uint64_t* words, uint64_t n, uint64_t mask);
+
+std::vector<Kernel<CountMatchesFunc>> getCountMatchesKernels();
+
+} // namespace
+
+#endif
@@ -12,6 +12,7 @@
 
 #include <stdlib.h>
 #include <algorithm>
+#include <cassert>
 #include <cstddef>
 #include <new>
 
@@ -31,7 +32,7 @@ public:
       capacity_(0),
       is_free_(true)
   {
-    resize(16);
+    reserve(16);
   }
 
   malloc_vector(std::size_t n)
@@ -53,26 +54,38 @@ public:
   {
     array_[size_++] = val;
     if (size_ >= capacity_)
-      resize(size_ * 2);
+      reserve(size_ * 2);
+  }
+
+  /// Only inserting at the end is supported
+  template <typename U>
+  void insert(T* pos, const U* first, const U* last)
+  {
+    assert(pos == end());
+    (void) pos;
+    std::size_t n = (std::size_t) (last - first);
+    if (size_ + n >= capacity_)
+      reserve(std::max(capacity_ * 2, size_ + n + 1));
+
+    T* array = &array_[size_];
+    for (std::size_t i = 0; i < n; i++)
+      array[i] = (T) first[i];
+
+    size_ += n;
   }
 
   void reserve(std::size_t n)
   {
     if (n > capacity_)
-      resize(n);
+      reallocate(n);
   }
 
+  /// The new elements are not initialized
   void resize(std::size_t n)
   {
-    n = std::max(n, (std::size_t) 16);
-    T* new_array = (T*) realloc((void*) array_, n * sizeof(T));
-
-    if (!new_array)
-      throw std::bad_alloc();
-
-    array_ = new_array;
-    capacity_ = n;
-    size_ = std::min(size_, capacity_);
+    // keep room for push_back()
+    reserve(n + 1);
+    size_ = n;
   }
 
   T& operator[] (T n)
@@ -85,6 +98,11 @@ public:
     return array_;
   }
 
+  T* end()
+  {
+    return array_ + size_;
+  }
+
   std::size_t size() const
   {
     return size_;
@@ -103,6 +121,18 @@ private:
   std::size_t size_;
   std::size_t capacity_;
   bool is_free_;
+
+  void reallocate(std::size_t n)
+  {
+    n = std::max(n, (std::size_t) 16);
+    T* new_array = (T*) realloc((void*) array_, n * sizeof(T));
+
+    if (!new_array)
+      throw std::bad_alloc();
+
+    array_ = new_array;
+    capacity_ = n;
+  }
 };
 
 } // namespace
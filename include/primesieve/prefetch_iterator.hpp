@@ -0,0 +1,69 @@
+///
+/// @file  prefetch_iterator.hpp
+/// @brief prefetch_iterator iterates forwards over primes like
+///        primesieve::iterator but the primes are generated by a
+///        helper thread. While the caller consumes the current
+///        buffer of primes the helper thread fills the next
+///        buffers, at most queue_size buffers are kept ahead.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_PREFETCH_ITERATOR_HPP
+#define PRIMESIEVE_PREFETCH_ITERATOR_HPP
+
+#include "iterator.hpp"
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace primesieve {
+
+/// Use prefetch_iterator for long-lived streaming consumers
+/// on a machine with at least one idle CPU core. Unlike
+/// primesieve::iterator it only iterates forwards.
+///
+class prefetch_iterator
+{
+public:
+  /// Create a new prefetch_iterator object.
+  /// @param start       Generate primes > start.
+  /// @param stop_hint   Stop number optimization hint,
+  ///                    see primesieve::iterator.
+  /// @param queue_size  Max number of buffers generated ahead.
+  ///
+  prefetch_iterator(uint64_t start = 0,
+                    uint64_t stop_hint = get_max_stop(),
+                    std::size_t queue_size = 2);
+
+  ~prefetch_iterator();
+  prefetch_iterator(const prefetch_iterator&) = delete;
+  prefetch_iterator& operator=(const prefetch_iterator&) = delete;
+
+  /// Get the next prime.
+  /// Returns UINT64_MAX if next prime > 2^64.
+  ///
+  uint64_t next_prime()
+  {
+    if (i_++ == last_idx_)
+      generate_next_primes();
+    return primes_[i_];
+  }
+
+private:
+  std::size_t i_;
+  std::size_t last_idx_;
+  std::vector<uint64_t> primes_;
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+  void generate_next_primes();
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,136 @@
+///
+/// @file  prime_archive.hpp
+/// @brief A prime archive is a file that stores the primes inside
+///        [start, stop] so that they can be scanned again without
+///        sieving. The primes are stored as varint encoded gaps in
+///        blocks of a fixed number distance, an index of
+///        (pi(block low), file offset) per block allows to find a
+///        number or the nth prime by decoding a single block.
+///
+/// File format (all integers are little-endian uint64_t):
+///
+///   Header: "PSARCHV1", start, stop, block distance,
+///           number of blocks, number of primes,
+///           index offset, 0 (reserved)
+///   Blocks: block i holds the primes inside
+///           [start + i * dist, start + (i + 1) * dist - 1],
+///           the first gap is relative to the block low.
+///   Index:  (number of primes < block low, block offset) for
+///           each block, followed by (number of primes,
+///           index offset).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_PRIME_ARCHIVE_HPP
+#define PRIMESIEVE_PRIME_ARCHIVE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace primesieve {
+
+class MappedFile;
+
+/// Write the primes inside [start, stop] to a prime
+/// archive file, the blocks are encoded in parallel.
+/// @return The number of primes written.
+///
+uint64_t write_prime_archive(const std::string& filename,
+                             uint64_t start,
+                             uint64_t stop);
+
+/// Read-only access to a prime archive file, the file is
+/// memory mapped (if supported by the OS).
+///
+class prime_archive
+{
+public:
+  explicit prime_archive(const std::string& filename);
+  ~prime_archive();
+  prime_archive(const prime_archive&) = delete;
+  prime_archive& operator=(const prime_archive&) = delete;
+
+  uint64_t start() const { return start_; }
+  uint64_t stop() const { return stop_; }
+  /// Number of primes inside [start(), stop()]
+  uint64_t size() const { return primes_; }
+  /// Count the primes inside [start, stop],
+  /// requires start() <= start and stop <= stop().
+  ///
+  uint64_t count_primes(uint64_t start, uint64_t stop) const;
+  /// Find the nth prime of the archive (n = 1 is the
+  /// first prime >= start()), requires n <= size().
+  ///
+  uint64_t nth_prime(uint64_t n) const;
+
+  /// Iterates over the primes of the archive like
+  /// primesieve::iterator, only the block containing
+  /// the current prime is decoded.
+  ///
+  class iterator
+  {
+  public:
+    /// @param start  Iterate over primes > start (or < start).
+    iterator(const prime_archive& archive, uint64_t start = 0);
+    void skipto(uint64_t start);
+
+    /// Get the next prime.
+    /// Returns UINT64_MAX if next prime > archive stop().
+    ///
+    uint64_t next_prime()
+    {
+      if (i_ + 1 < primes_.size())
+        return primes_[++i_];
+      return next_block_prime();
+    }
+
+    /// Get the previous prime.
+    /// Returns 0 if previous prime < archive start().
+    ///
+    uint64_t prev_prime()
+    {
+      if (i_ > 0)
+        return primes_[--i_];
+      return prev_block_prime();
+    }
+
+  private:
+    const prime_archive& archive_;
+    uint64_t start_;
+    uint64_t block_ = 0;
+    bool decoded_ = false;
+    /// Index of the current prime in primes_
+    std::size_t i_ = 0;
+    std::vector<uint64_t> primes_;
+    uint64_t next_block_prime();
+    uint64_t prev_block_prime();
+    void decode(uint64_t block);
+  };
+
+private:
+  uint64_t start_;
+  uint64_t stop_;
+  uint64_t blockDist_;
+  uint64_t blocks_;
+  uint64_t primes_;
+  uint64_t indexOffset_;
+  std::unique_ptr<MappedFile> file_;
+  uint64_t blockOf(uint64_t n) const;
+  uint64_t blockLow(uint64_t block) const;
+  uint64_t blockRank(uint64_t block) const;
+  uint64_t blockOffset(uint64_t block) const;
+  uint64_t blockCount(uint64_t block) const;
+  void decode(uint64_t block, std::vector<uint64_t>& primes) const;
+  uint64_t pi(uint64_t n) const;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,88 @@
+///
+/// @file  prime_monitor.hpp
+/// @brief A prime_monitor keeps the prime gap and prime k-tuplet
+///        statistics of [start, stop] and extends them to larger
+///        stop numbers. The sieve is kept between the extensions,
+///        the sieving primes and their next multiples continue
+///        where the last extension stopped and new sieving primes
+///        are only added as sqrt(stop) grows. Hence each extension
+///        only costs its own distance, not the set up of the
+///        sieve at stop.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_PRIME_MONITOR_HPP
+#define PRIMESIEVE_PRIME_MONITOR_HPP
+
+#include <stdint.h>
+#include <memory>
+
+namespace primesieve {
+
+/// Use a prime_monitor for a search frontier that is extended
+/// repeatedly within the same process, e.g.
+///
+///   prime_monitor monitor(start);
+///   for (uint64_t stop = start + dist; ...; stop += dist)
+///   {
+///     monitor.extend(stop);
+///     report(monitor.max_gap(), monitor.count_twins());
+///   }
+///
+/// The counts are the same as those of count_primes(start, stop),
+/// count_twins(start, stop), ... a k-tuplet is counted once all
+/// of its primes are inside [start, stop].
+///
+class prime_monitor
+{
+public:
+  /// @param start    Monitor the primes >= start.
+  /// @param horizon  Largest stop number of extend(), the
+  ///                 sieve is set up for primes <= horizon.
+  ///
+  prime_monitor(uint64_t start, uint64_t horizon = ~0ull);
+  ~prime_monitor();
+  prime_monitor(const prime_monitor&) = delete;
+  prime_monitor& operator=(const prime_monitor&) = delete;
+
+  /// Add the primes inside ]stop(), stop] to the statistics,
+  /// stop <= stop() is ignored.
+  /// @pre stop <= horizon
+  ///
+  void extend(uint64_t stop);
+
+  uint64_t start() const;
+  /// Primes <= stop() have been added,
+  /// initially stop() = start - 1.
+  ///
+  uint64_t stop() const;
+  uint64_t horizon() const;
+
+  uint64_t count_primes() const;
+  uint64_t count_twins() const;
+  uint64_t count_triplets() const;
+  uint64_t count_quadruplets() const;
+  uint64_t count_quintuplets() const;
+  uint64_t count_sextuplets() const;
+
+  /// Largest prime <= stop(), 0 if none
+  uint64_t last_prime() const;
+  /// Largest gap between 2 consecutive primes
+  uint64_t max_gap() const;
+  /// Number of primes p with next prime = p + gap
+  uint64_t gap_count(uint64_t gap) const;
+  /// Smallest prime p with next prime = p + gap, 0 if none
+  uint64_t gap_first_prime(uint64_t gap) const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace
+
+#endif
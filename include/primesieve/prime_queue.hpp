@@ -0,0 +1,100 @@
+///
+/// @file  prime_queue.hpp
+/// @brief A prime_queue hands out the primes inside [start, stop]
+///        in blocks to any number of worker threads, each call of
+///        next_block() atomically claims the next block. If the
+///        queue is empty the calling worker sieves the next chunk
+///        of [start, stop] and publishes its primes block by block,
+///        hence the sieving is spread over the workers and the
+///        load is balanced over the primes themselves.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_PRIME_QUEUE_HPP
+#define PRIMESIEVE_PRIME_QUEUE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace primesieve {
+
+int get_num_threads();
+
+/// Called with a block of primes, thread is the number
+/// of the calling worker thread (0 <= thread < threads).
+///
+using block_callback = std::function<void(int thread, const uint64_t* primes, std::size_t size)>;
+
+/// Use a prime_queue if the work per prime varies a lot, for
+/// uniform work the static ranges of for_each_prime() with
+/// threads are cheaper. The blocks are claimed in no
+/// particular order, the primes of a block are in
+/// increasing order.
+///
+class prime_queue
+{
+public:
+  /// @param block_size  Number of primes per block.
+  prime_queue(uint64_t start,
+              uint64_t stop,
+              std::size_t block_size = 1 << 10);
+
+  ~prime_queue();
+  prime_queue(const prime_queue&) = delete;
+  prime_queue& operator=(const prime_queue&) = delete;
+
+  /// Claim the next block of primes, thread-safe. The
+  /// previous content of primes is recycled.
+  /// @return false once all blocks have been claimed.
+  ///
+  bool next_block(std::vector<uint64_t>& primes);
+
+  /// Claim all blocks using threads worker threads of the
+  /// primesieve thread pool (threads <= 0 uses
+  /// get_num_threads()), the callback is called
+  /// concurrently by the workers.
+  ///
+  void for_each_block(int threads, const block_callback& callback);
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+/// Call visitor(prime) for each prime inside [start, stop] using
+/// a prime_queue and multiple threads (threads <= 0 uses
+/// get_num_threads()). Each thread gets its own copy of visitor,
+/// returns the visitors of all threads.
+///
+template <typename F>
+inline std::vector<F> for_each_prime_dynamic(uint64_t start,
+                                             uint64_t stop,
+                                             int threads,
+                                             const F& visitor,
+                                             std::size_t block_size = 1 << 10)
+{
+  if (threads <= 0)
+    threads = get_num_threads();
+
+  std::vector<F> visitors(threads, visitor);
+  prime_queue queue(start, stop, block_size);
+
+  queue.for_each_block(threads, [&](int thread, const uint64_t* primes, std::size_t size) {
+    F& f = visitors[thread];
+    for (std::size_t i = 0; i < size; i++)
+      f(primes[i]);
+  });
+
+  return visitors;
+}
+
+} // namespace
+
+#endif
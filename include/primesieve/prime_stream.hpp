@@ -0,0 +1,88 @@
+///
+/// @file  prime_stream.hpp
+/// @brief A prime_stream generates the primes inside ]start, stop]
+///        once using a helper thread and shares the blocks of
+///        primes with any number of cursors. Each cursor iterates
+///        over the primes at its own pace (e.g. in its own thread),
+///        the helper thread stays at most backlog blocks ahead of
+///        the slowest cursor.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_PRIME_STREAM_HPP
+#define PRIMESIEVE_PRIME_STREAM_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace primesieve {
+
+/// Use a prime_stream instead of one primesieve::iterator per
+/// consumer if several consumers iterate over the same range.
+/// Create the cursors before consuming, a cursor that is created
+/// later starts at the oldest block which has not yet been
+/// consumed by all other cursors.
+///
+class prime_stream
+{
+  struct Impl;
+
+public:
+  /// Create a new prime_stream object.
+  /// @param start    Generate primes > start.
+  /// @param stop     Generate primes <= stop.
+  /// @param backlog  Max number of blocks generated ahead
+  ///                 of the slowest cursor.
+  ///
+  prime_stream(uint64_t start,
+               uint64_t stop,
+               std::size_t backlog = 4);
+
+  /// The cursors stay valid, they return
+  /// the primes generated so far.
+  ///
+  ~prime_stream();
+  prime_stream(const prime_stream&) = delete;
+  prime_stream& operator=(const prime_stream&) = delete;
+
+  class cursor
+  {
+  public:
+    cursor(prime_stream& stream);
+    ~cursor();
+    cursor(const cursor&) = delete;
+    cursor& operator=(const cursor&) = delete;
+
+    /// Get the next prime.
+    /// Returns UINT64_MAX after the last prime <= stop.
+    ///
+    uint64_t next_prime()
+    {
+      if (i_++ == last_idx_)
+        next_block();
+      return (*block_)[i_];
+    }
+
+  private:
+    std::size_t i_;
+    std::size_t last_idx_;
+    /// Index of the next block
+    uint64_t pos_;
+    std::shared_ptr<const std::vector<uint64_t>> block_;
+    std::shared_ptr<Impl> impl_;
+    void next_block();
+  };
+
+private:
+  std::shared_ptr<Impl> impl_;
+};
+
+} // namespace
+
+#endif
@@ -0,0 +1,91 @@
+///
+/// @file  prime_table.hpp
+/// @brief A prime_table is a bitmap of the primes <= limit using
+///        the mod 30 layout of the sieve (8 flags for 30 numbers,
+///        e.g. 143 MB for limit = 2^32). Every 64 bytes of the
+///        bitmap store the number of primes below them, hence
+///        pi(x) and is_prime(n) take O(1) and nth_prime(n)
+///        takes O(log n). The table is read-only after it has
+///        been built and can be read from many threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_PRIME_TABLE_HPP
+#define PRIMESIEVE_PRIME_TABLE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace primesieve {
+
+class SievingTable;
+
+class prime_table
+{
+public:
+  /// Sieve the primes <= limit using multiple threads
+  explicit prime_table(uint64_t limit);
+  ~prime_table();
+  prime_table(const prime_table&) = delete;
+  prime_table& operator=(const prime_table&) = delete;
+
+  uint64_t limit() const { return limit_; }
+  /// Number of primes <= limit()
+  uint64_t size() const { return primes_; }
+  /// Requires n <= limit()
+  bool is_prime(uint64_t n) const;
+  /// Count the primes <= n, requires n <= limit()
+  uint64_t pi(uint64_t n) const;
+  /// Count the primes inside [start, stop],
+  /// requires stop <= limit().
+  ///
+  uint64_t count_primes(uint64_t start, uint64_t stop) const;
+  /// Find the nth prime, requires n <= size()
+  uint64_t nth_prime(uint64_t n) const;
+  /// Store up to size primes >= *start and <= stop in primes,
+  /// requires stop <= limit(). *start is set to the number
+  /// after the last stored prime (stop + 1 if done).
+  /// @return Number of primes stored
+  ///
+  std::size_t fill_primes(uint64_t* start,
+                          uint64_t stop,
+                          uint64_t* primes,
+                          std::size_t size) const;
+
+private:
+  uint64_t limit_;
+  uint64_t primes_;
+  std::shared_ptr<const SievingTable> table_;
+  /// Number of table primes below each 64 byte block
+  std::vector<uint64_t> ranks_;
+  friend void load_prime_table(uint64_t);
+};
+
+/// Build a process-wide prime_table of the primes <= limit.
+/// Subsequent primesieve::is_prime(), count_primes() and
+/// nth_prime() calls look up the table and the sieving
+/// primes of all sieves and iterators are read from the
+/// table instead of being re-sieved.
+///
+void load_prime_table(uint64_t limit);
+
+/// Stop using the table built by load_prime_table()
+void unload_prime_table();
+
+/// The table built by load_prime_table() or nullptr
+std::shared_ptr<const prime_table> get_prime_table();
+
+/// Table of the primes <= config::SMALL_PRIME_TABLE,
+/// built at the first call and never unloaded
+///
+const prime_table& small_prime_table();
+
+} // namespace
+
+#endif
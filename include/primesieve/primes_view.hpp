@@ -0,0 +1,140 @@
+///
+/// @file   primes_view.hpp
+/// @brief  primes_view is a lazy, single-pass range of the primes
+///         inside [start, stop] built on primesieve::iterator's
+///         bulk next_primes(). It works with range-based for
+///         loops and in C++20 it models std::ranges::input_range,
+///         e.g. primes_view(0, 1000) | std::views::filter(...).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMES_VIEW_HPP
+#define PRIMES_VIEW_HPP
+
+#include "iterator.hpp"
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+
+#if __cplusplus >= 202002L
+  #include <version>
+#endif
+
+#if defined(__cpp_lib_generator)
+  #include <generator>
+#endif
+
+namespace primesieve {
+
+class primes_view
+{
+  /// Shared by all iterators of the view, stays at the
+  /// same address if the view is moved.
+  struct state
+  {
+    state(uint64_t start, uint64_t stop) :
+      it(start, stop),
+      stop(stop)
+    { }
+    primesieve::iterator it;
+    const uint64_t* first = nullptr;
+    const uint64_t* last = nullptr;
+    uint64_t stop;
+  };
+
+public:
+  class iterator
+  {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = uint64_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const uint64_t*;
+    using reference = const uint64_t&;
+
+    iterator() = default;
+    explicit iterator(state* s) : state_(s) { }
+
+    const uint64_t& operator*() const
+    {
+      return *state_->first;
+    }
+
+    iterator& operator++()
+    {
+      if (++state_->first == state_->last)
+        state_->it.next_primes(&state_->first, &state_->last);
+      return *this;
+    }
+
+    void operator++(int)
+    {
+      ++*this;
+    }
+
+    /// All iterators past stop compare equal to end()
+    friend bool operator==(const iterator& a, const iterator& b)
+    {
+      return a.done() == b.done();
+    }
+
+    friend bool operator!=(const iterator& a, const iterator& b)
+    {
+      return !(a == b);
+    }
+
+  private:
+    state* state_ = nullptr;
+    bool done() const
+    {
+      return !state_ || *state_->first > state_->stop;
+    }
+  };
+
+  /// The primes inside [start, stop]
+  primes_view(uint64_t start, uint64_t stop) :
+    // UINT64_MAX is returned if next prime > 2^64
+    state_(new state(start > 0 ? start - 1 : 0,
+                     std::min(stop, get_max_stop() - 1)))
+  { }
+
+  /// Single pass, begin() continues
+  /// where the previous iteration stopped.
+  ///
+  iterator begin()
+  {
+    if (!state_->first)
+      state_->it.next_primes(&state_->first, &state_->last);
+    return iterator(state_.get());
+  }
+
+  iterator end()
+  {
+    return iterator();
+  }
+
+private:
+  std::unique_ptr<state> state_;
+};
+
+#if defined(__cpp_lib_generator)
+
+/// Coroutine generator yielding the primes inside [start, stop]
+inline std::generator<uint64_t> primes_generator(uint64_t start, uint64_t stop)
+{
+  for (uint64_t prime : primes_view(start, stop))
+    co_yield prime;
+}
+
+#endif
+
+} // namespace
+
+#endif
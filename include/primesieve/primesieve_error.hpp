@@ -28,6 +28,17 @@ public:
   { }
 };
 
+/// primesieve throws a primesieve_cancelled exception if a
+/// computation has been stopped using a cancel_token.
+///
+class primesieve_cancelled : public primesieve_error
+{
+public:
+  primesieve_cancelled()
+    : primesieve_error("computation cancelled")
+  { }
+};
+
 } // namespace
 
 #endif
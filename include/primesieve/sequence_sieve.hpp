@@ -0,0 +1,65 @@
+///
+/// @file   sequence_sieve.hpp
+/// @brief  Remove the candidates with a prime factor <= max_prime
+///         from the index space [start, stop] of a sequence, e.g.
+///         the arithmetic progression a + k * d or k * b^n + c.
+///         The sequence itself is never evaluated, for each
+///         sieving prime p the user provides the residues r for
+///         which candidate k is divisible by p if k = r (mod p).
+///         Hence the candidates need not fit into 64 bits.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_SEQUENCE_SIEVE_HPP
+#define PRIMESIEVE_SEQUENCE_SIEVE_HPP
+
+#include <stdint.h>
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace primesieve {
+
+/// Called once per sieving prime p, append the residues
+/// 0 <= r < p for which candidate k is divisible by p
+/// if k = r (mod p). No residues if p divides no candidate.
+///
+using roots_callback = std::function<void(uint64_t prime, std::vector<uint64_t>& roots)>;
+
+/// Called with the survivor bitmap of each segment, bit i
+/// (bits[i / 64] >> (i % 64) & 1) corresponds to the candidate
+/// k = low + i, a set bit is a candidate without prime factors
+/// <= max_prime. size is the number of candidates of the segment.
+/// The bitmap is only valid during the call.
+///
+using survivors_callback = std::function<void(uint64_t low, const uint64_t* bits, std::size_t size)>;
+
+/// Roots of the arithmetic progression a + k * d, throws a
+/// primesieve_error if a sieving prime divides all candidates.
+///
+roots_callback progression_roots(uint64_t a, uint64_t d);
+
+/// Roots of k * b^n + c e.g. Proth (c = 1) and Riesel (c = -1)
+/// numbers, throws a primesieve_error if a sieving prime
+/// divides all candidates.
+///
+roots_callback power_roots(uint64_t b, uint64_t n, int64_t c);
+
+/// Sieve the candidates k inside [start, stop] with the primes
+/// <= max_prime (max_prime < 2^32) and pass the survivor bitmap
+/// of each segment (in increasing order) to the callback.
+/// Note that a candidate equal to a sieving prime is removed too.
+///
+void sieve_sequence(uint64_t start,
+                    uint64_t stop,
+                    uint64_t max_prime,
+                    const roots_callback& roots,
+                    const survivors_callback& callback);
+
+} // namespace
+
+#endif
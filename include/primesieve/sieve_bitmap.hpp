@@ -0,0 +1,160 @@
+///
+/// @file   sieve_bitmap.hpp
+/// @brief  Access the sieve array of each segment, either directly
+///         using sieve_bitmap() or prime by prime using
+///         for_each_prime(). The primes are not stored.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SIEVE_BITMAP_HPP
+#define SIEVE_BITMAP_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <vector>
+
+namespace primesieve {
+
+int get_num_threads();
+
+/// Called with the sieve array of each segment, byte i
+/// corresponds to the numbers [low + i * 30 + 7, low + i * 30 + 31]
+/// and its bits (from least to most significant) to the offsets
+/// { 7, 11, 13, 17, 19, 23, 29, 31 }, a set bit is a prime.
+/// The sieve array is only valid during the call.
+///
+using bitmap_callback = std::function<void(uint64_t low, const uint8_t* sieve, std::size_t size)>;
+
+/// Same as bitmap_callback, thread is the number of
+/// the calling worker thread (0 <= thread < threads).
+///
+using parallel_bitmap_callback = std::function<void(int thread, uint64_t low, const uint8_t* sieve, std::size_t size)>;
+
+/// Sieve the interval [start, stop] and pass the sieve array
+/// of each segment (in increasing order) to the callback
+/// without reconstructing the primes. The primes 2, 3 and 5
+/// are not part of the bitmap and the bits of the numbers
+/// outside of [start, stop] are unset.
+///
+void sieve_bitmap(uint64_t start, uint64_t stop, const bitmap_callback& callback);
+
+/// Sieve the interval [start, stop] using up to threads threads
+/// (threads <= 0 uses get_num_threads()), the callback is called
+/// concurrently by the worker threads. The segments of each thread
+/// are in increasing order, there is no order across threads.
+///
+void sieve_bitmap(uint64_t start, uint64_t stop, int threads, const parallel_bitmap_callback& callback);
+
+namespace detail {
+
+/// Read 8 sieve bytes as a little-endian word,
+/// compilers translate this into a single load.
+///
+inline uint64_t load64(const uint8_t* sieve)
+{
+  uint64_t bits = 0;
+  for (int i = 0; i < 8; i++)
+    bits |= (uint64_t) sieve[i] << (i * 8);
+  return bits;
+}
+
+/// Call f(prime) for each set bit of the sieve array.
+/// The bit values are found using a De Bruijn bitscan
+/// (same as Erat::nextPrime()).
+///
+template <typename F>
+inline void for_each_bit(uint64_t low, const uint8_t* sieve, std::size_t size, F& f)
+{
+  static const uint64_t bitValues[64] =
+  {
+      7,  47,  11,  49,  67, 113,  13,  53,
+     89,  71, 161, 101, 119, 187,  17, 233,
+     59,  79,  91,  73, 133, 139, 163, 103,
+    149, 121, 203, 169, 191, 217,  19, 239,
+     43,  61, 109,  83, 157,  97, 181, 229,
+     77, 131, 137, 143, 199, 167, 211,  41,
+    107, 151, 179, 227, 127, 197, 209,  37,
+    173, 223, 193,  31, 221,  29,  23, 241
+  };
+
+  const uint64_t debruijn = 0x3F08A4C6ACB9DBDull;
+
+  for (std::size_t i = 0; i < size; i += 8, low += 30 * 8)
+  {
+    uint64_t bits;
+
+    if (i + 8 <= size)
+      bits = load64(&sieve[i]);
+    else
+    {
+      uint8_t tail[8] = { 0 };
+      std::copy(&sieve[i], &sieve[size], tail);
+      bits = load64(tail);
+    }
+
+    while (bits)
+    {
+      uint64_t mask = bits - 1;
+      f(low + bitValues[((bits ^ mask) * debruijn) >> 58]);
+      bits &= mask;
+    }
+  }
+}
+
+template <typename F>
+inline void for_each_small_prime(uint64_t start, uint64_t stop, F& f)
+{
+  for (uint64_t prime : { 2, 3, 5 })
+    if (prime >= start && prime <= stop)
+      f(prime);
+}
+
+} // namespace detail
+
+/// Call f(prime) for each prime inside [start, stop] in
+/// increasing order. f is inlined into the loop that extracts
+/// the primes from the sieve array, this is much faster than
+/// primesieve::iterator for simple functions.
+///
+template <typename F>
+inline void for_each_prime(uint64_t start, uint64_t stop, F&& f)
+{
+  detail::for_each_small_prime(start, stop, f);
+
+  sieve_bitmap(start, stop, [&](uint64_t low, const uint8_t* sieve, std::size_t size) {
+    detail::for_each_bit(low, sieve, size, f);
+  });
+}
+
+/// Call visitor(prime) for each prime inside [start, stop] using
+/// multiple threads (threads <= 0 uses get_num_threads()). Each
+/// thread gets its own copy of visitor, the primes of a thread are
+/// in increasing order. Returns the visitors of all threads, these
+/// have to be reduced by the caller e.g. summing up their counts.
+///
+template <typename F>
+inline std::vector<F> for_each_prime(uint64_t start, uint64_t stop, int threads, const F& visitor)
+{
+  if (threads <= 0)
+    threads = get_num_threads();
+
+  std::vector<F> visitors(threads, visitor);
+  detail::for_each_small_prime(start, stop, visitors[0]);
+
+  sieve_bitmap(start, stop, threads, [&](int thread, uint64_t low, const uint8_t* sieve, std::size_t size) {
+    detail::for_each_bit(low, sieve, size, visitors[thread]);
+  });
+
+  return visitors;
+}
+
+} // namespace
+
+#endif
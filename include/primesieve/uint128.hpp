@@ -0,0 +1,80 @@
+///
+/// @file   uint128.hpp
+/// @brief  Portable unsigned 128-bit integer used for the sums of
+///         primes, the sum of the primes below 2^64 is > 2^64.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef PRIMESIEVE_UINT128_HPP
+#define PRIMESIEVE_UINT128_HPP
+
+#include <stdint.h>
+#include <algorithm>
+#include <string>
+
+namespace primesieve {
+
+struct uint128
+{
+  uint64_t low;
+  uint64_t high;
+
+  uint128() : low(0), high(0) { }
+  uint128(uint64_t n) : low(n), high(0) { }
+  uint128(uint64_t hi, uint64_t lo) : low(lo), high(hi) { }
+
+  bool operator==(const uint128& other) const
+  {
+    return low == other.low && high == other.high;
+  }
+
+  bool operator!=(const uint128& other) const
+  {
+    return !(*this == other);
+  }
+};
+
+/// Decimal representation of n
+inline std::string to_string(uint128 n)
+{
+  // 32-bit limbs, most significant first
+  uint64_t limbs[4] = { n.high >> 32, n.high & 0xffffffff,
+                        n.low >> 32, n.low & 0xffffffff };
+  std::string str;
+
+  do
+  {
+    // divide by 10^9 using long division
+    uint64_t rem = 0;
+    bool isZero = true;
+
+    for (uint64_t& limb : limbs)
+    {
+      uint64_t x = (rem << 32) | limb;
+      limb = x / 1000000000;
+      rem = x % 1000000000;
+      isZero = isZero && !limb;
+    }
+
+    for (int i = 0; i < 9 && (!isZero || rem); i++, rem /= 10)
+      str += (char) ('0' + rem % 10);
+
+    if (isZero)
+      break;
+  }
+  while (true);
+
+  if (str.empty())
+    str = "0";
+
+  std::reverse(str.begin(), str.end());
+  return str;
+}
+
+} // namespace
+
+#endif
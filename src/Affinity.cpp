@@ -0,0 +1,452 @@
+///
+/// @file   Affinity.cpp
+/// @brief  Pin threads to CPUs and get the CPUs of the NUMA
+///         nodes. Thread pinning is currently only supported
+///         on Linux, on other operating systems the functions
+///         below do nothing. getAvailableCpus() also
+///         supports the Windows job object limits.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/Affinity.hpp>
+
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <exception>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+  #include <sched.h>
+#elif defined(_WIN32)
+  #include <windows.h>
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+#if defined(__linux__) && \
+    defined(CPU_SETSIZE)
+
+namespace {
+
+string getString(const string& filename)
+{
+  ifstream file(filename);
+  string str;
+
+  if (file)
+  {
+    // https://stackoverflow.com/a/117456/363778
+    stringstream trimmer;
+    trimmer << file.rdbuf();
+    trimmer >> str;
+  }
+
+  return str;
+}
+
+/// Parse a Linux CPU list e.g. "0-8,18-26"
+/// https://www.kernel.org/doc/Documentation/cputopology.txt
+///
+vector<int> parseCpuList(const string& filename)
+{
+  vector<int> cpus;
+  istringstream list(getString(filename));
+  string token;
+
+  try
+  {
+    while (getline(list, token, ','))
+    {
+      size_t pos = token.find('-');
+      int first = stoi(token.substr(0, pos));
+      int last = first;
+      if (pos != string::npos)
+        last = stoi(token.substr(pos + 1));
+      for (int cpu = first; cpu <= last; cpu++)
+        cpus.push_back(cpu);
+    }
+  }
+  catch (exception&)
+  {
+    cpus.clear();
+  }
+
+  return cpus;
+}
+
+/// Index of the CPU within the SMT siblings of its CPU
+/// core, e.g. 1 for the 2nd hardware thread of a core
+///
+int siblingIndex(int cpu)
+{
+  string path = "/sys/devices/system/cpu/cpu" + to_string(cpu);
+  vector<int> siblings = parseCpuList(path + "/topology/thread_siblings_list");
+  auto pos = find(siblings.begin(), siblings.end(), cpu);
+
+  if (pos == siblings.end())
+    return 0;
+
+  return (int) (pos - siblings.begin());
+}
+
+vector<string> split(const string& str, char delimiter)
+{
+  vector<string> tokens;
+  istringstream stream(str);
+  string token;
+
+  while (getline(stream, token, delimiter))
+    tokens.push_back(token);
+
+  return tokens;
+}
+
+/// Directory of the cgroup of this process in the cgroup v2
+/// hierarchy or in the cgroup v1 hierarchy of the cpu
+/// controller, mountDir is set to the mount point of
+/// the hierarchy. Empty if not found.
+///
+string getCgroupDir(bool v2, string& mountDir)
+{
+  // e.g. "0::/kubepods/pod1" or "3:cpu,cpuacct:/kubepods/pod1"
+  ifstream cgroups("/proc/self/cgroup");
+  string line;
+  string path;
+  bool found = false;
+
+  while (!found && getline(cgroups, line))
+  {
+    size_t pos1 = line.find(':');
+    size_t pos2 = line.find(':', pos1 + 1);
+    if (pos2 == string::npos)
+      continue;
+
+    string controllers = line.substr(pos1 + 1, pos2 - pos1 - 1);
+    path = line.substr(pos2 + 1);
+
+    if (v2)
+      found = line.compare(0, pos1, "0") == 0 && controllers.empty();
+    else
+    {
+      auto list = split(controllers, ',');
+      found = find(list.begin(), list.end(), "cpu") != list.end();
+    }
+  }
+
+  if (!found)
+    return string();
+
+  // e.g. "33 32 0:29 / /sys/fs/cgroup/cpu rw - cgroup cgroup rw,cpu"
+  ifstream mounts("/proc/self/mountinfo");
+
+  while (getline(mounts, line))
+  {
+    size_t pos = line.find(" - ");
+    if (pos == string::npos)
+      continue;
+
+    istringstream mount(line.substr(0, pos));
+    istringstream fs(line.substr(pos + 3));
+    string id, parent, device, root, dir;
+    string fsType, source, options;
+    mount >> id >> parent >> device >> root >> dir;
+    fs >> fsType >> source >> options;
+
+    if (v2 && fsType != "cgroup2")
+      continue;
+    if (!v2)
+    {
+      auto list = split(options, ',');
+      if (fsType != "cgroup" ||
+          find(list.begin(), list.end(), "cpu") == list.end())
+        continue;
+    }
+
+    mountDir = dir;
+
+    // Inside a container the root of the mount is usually
+    // our own cgroup which is then reported as "/"
+    if (root != "/" && path.compare(0, root.size(), root) == 0)
+      path = path.substr(root.size());
+    else if (root != "/")
+      path.clear();
+    if (path == "/")
+      path.clear();
+
+    return dir + path;
+  }
+
+  return string();
+}
+
+/// The CPU quota of the cgroup of this process and of all
+/// its parent cgroups is quota / period CPUs.
+/// @return The smallest quota rounded up, 0 if none.
+///
+int getCgroupCpus(bool v2)
+{
+  string mountDir;
+  string dir = getCgroupDir(v2, mountDir);
+  int cpus = 0;
+
+  while (!dir.empty())
+  {
+    string quota;
+    string period;
+
+    if (v2)
+    {
+      // e.g. "max 100000" or "400000 100000"
+      ifstream file(dir + "/cpu.max");
+      file >> quota >> period;
+    }
+    else
+    {
+      // quota = -1 if unlimited
+      quota = getString(dir + "/cpu.cfs_quota_us");
+      period = getString(dir + "/cpu.cfs_period_us");
+    }
+
+    if (!quota.empty() &&
+        !period.empty() &&
+        quota != "max" &&
+        quota[0] != '-')
+    {
+      uint64_t q = stoull(quota);
+      uint64_t p = stoull(period);
+
+      if (q > 0 && p > 0)
+      {
+        int n = (int) inBetween(1, ceilDiv(q, p), 1 << 20);
+        cpus = (cpus) ? min(cpus, n) : n;
+      }
+    }
+
+    if (dir.size() <= mountDir.size())
+      break;
+
+    dir = dir.substr(0, dir.rfind('/'));
+  }
+
+  return cpus;
+}
+
+} // namespace
+
+namespace primesieve {
+
+vector<int> getAllowedCpus()
+{
+  vector<int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    for (int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+
+  return cpus;
+}
+
+vector<int> getCpuOrder()
+{
+  vector<int> allowed = getAllowedCpus();
+  vector<vector<int>> nodes;
+  string path = "/sys/devices/system/node/";
+
+  // SMT siblings last
+  vector<pair<int, int>> ranks;
+  for (int cpu : allowed)
+    ranks.emplace_back(siblingIndex(cpu), cpu);
+  stable_sort(ranks.begin(), ranks.end(), [](const pair<int, int>& a, const pair<int, int>& b)
+    { return a.first < b.first; });
+  for (size_t i = 0; i < ranks.size(); i++)
+    allowed[i] = ranks[i].second;
+
+  for (int node : parseCpuList(path + "online"))
+  {
+    string cpuList = path + "node" + to_string(node) + "/cpulist";
+    vector<int> nodeCpus = parseCpuList(cpuList);
+    vector<int> cpus;
+
+    for (int cpu : allowed)
+      if (find(nodeCpus.begin(), nodeCpus.end(), cpu) != nodeCpus.end())
+        cpus.push_back(cpu);
+
+    if (!cpus.empty())
+      nodes.push_back(cpus);
+  }
+
+  vector<int> order;
+
+  for (size_t i = 0; order.size() < allowed.size(); i++)
+  {
+    size_t size = order.size();
+
+    for (auto& cpus : nodes)
+      if (i < cpus.size())
+        order.push_back(cpus[i]);
+
+    if (order.size() == size)
+      break;
+  }
+
+  // CPUs without NUMA node information
+  for (int cpu : allowed)
+    if (find(order.begin(), order.end(), cpu) == order.end())
+      order.push_back(cpu);
+
+  return order;
+}
+
+bool setThreadAffinity(const vector<int>& cpus)
+{
+  if (cpus.empty())
+    return false;
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+
+  for (int cpu : cpus)
+    if (cpu >= 0 && cpu < CPU_SETSIZE)
+      CPU_SET(cpu, &set);
+
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+}
+
+int getCurrentCpu()
+{
+  return sched_getcpu();
+}
+
+int getAvailableCpus(string& limit)
+{
+  int cpus = max(1, (int) thread::hardware_concurrency());
+  int allowed = (int) getAllowedCpus().size();
+  limit.clear();
+
+  if (allowed > 0 && allowed < cpus)
+  {
+    cpus = allowed;
+    limit = "CPU affinity";
+  }
+
+  try
+  {
+    int quota = getCgroupCpus(true);
+    if (quota > 0 && quota < cpus)
+    {
+      cpus = quota;
+      limit = "cgroup v2 cpu.max";
+    }
+
+    quota = getCgroupCpus(false);
+    if (quota > 0 && quota < cpus)
+    {
+      cpus = quota;
+      limit = "cgroup v1 cpu.cfs_quota_us";
+    }
+  }
+  catch (exception&)
+  {
+    // Invalid cgroup files, ignore the quota
+  }
+
+  return cpus;
+}
+
+} // namespace
+
+#else
+
+namespace primesieve {
+
+vector<int> getAllowedCpus()
+{
+  return vector<int>();
+}
+
+vector<int> getCpuOrder()
+{
+  return vector<int>();
+}
+
+bool setThreadAffinity(const vector<int>&)
+{
+  return false;
+}
+
+int getCurrentCpu()
+{
+  return -1;
+}
+
+int getAvailableCpus(string& limit)
+{
+  int cpus = max(1, (int) thread::hardware_concurrency());
+  limit.clear();
+
+#if defined(_WIN32)
+  int online = cpus;
+  DWORD_PTR processMask = 0;
+  DWORD_PTR systemMask = 0;
+
+  // Includes the affinity of the job object
+  if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask))
+  {
+    int allowed = 0;
+    for (; processMask > 0; processMask &= processMask - 1)
+      allowed++;
+
+    if (allowed > 0 && allowed < cpus)
+    {
+      cpus = allowed;
+      limit = "CPU affinity";
+    }
+  }
+
+#if defined(JOB_OBJECT_CPU_RATE_CONTROL_ENABLE)
+  JOBOBJECT_CPU_RATE_CONTROL_INFORMATION info;
+
+  if (QueryInformationJobObject(NULL, JobObjectCpuRateControlInformation, &info, sizeof(info), NULL) &&
+      (info.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_ENABLE))
+  {
+    // Rate in 1/100 percent of all CPUs of the system
+    uint64_t rate = 0;
+    if (info.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_HARD_CAP)
+      rate = info.CpuRate;
+    else if (info.ControlFlags & JOB_OBJECT_CPU_RATE_CONTROL_MIN_MAX_RATE)
+      rate = info.MaxRate;
+
+    if (rate > 0)
+    {
+      int quota = (int) ceilDiv(rate * online, (uint64_t) 10000);
+      if (quota > 0 && quota < cpus)
+      {
+        cpus = quota;
+        limit = "job object CPU rate";
+      }
+    }
+  }
+#endif
+#endif
+
+  return cpus;
+}
+
+} // namespace
+
+#endif
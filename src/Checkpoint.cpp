@@ -0,0 +1,183 @@
+///
+/// @file   Checkpoint.cpp
+/// @brief  The checkpoint file is a text file: a header line
+///         "start stop flags" followed by one line per finished
+///         piece "low high count0 ... count5". The file is
+///         written to filename.tmp first and then renamed so
+///         that a crash never leaves a truncated file behind.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/Checkpoint.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+Checkpoint::Checkpoint(const string& filename, double seconds) :
+  filename_(filename),
+  seconds_(seconds),
+  lastSave_(chrono::steady_clock::now())
+{ }
+
+void Checkpoint::init(uint64_t start, uint64_t stop, int flags)
+{
+  lock_guard<mutex> lock(lock_);
+  start_ = start;
+  stop_ = stop;
+  flags_ = flags;
+  pieces_.clear();
+
+  ifstream file(filename_);
+  if (!file)
+    return;
+
+  string line;
+  uint64_t fileStart = 0;
+  uint64_t fileStop = 0;
+  int fileFlags = 0;
+
+  while (getline(file, line) && line[0] == '#') { }
+  istringstream header(line);
+  header >> fileStart >> fileStop >> fileFlags;
+
+  if (!header)
+    throw primesieve_error("invalid checkpoint file " + filename_);
+  if (fileStart != start || fileStop != stop || fileFlags != flags)
+    throw primesieve_error("checkpoint file " + filename_ + " belongs to another computation");
+
+  while (getline(file, line))
+  {
+    istringstream in(line);
+    Piece piece;
+    in >> piece.low >> piece.high;
+    for (auto& count : piece.counts)
+      in >> count;
+
+    // the last line may be incomplete
+    if (!in || piece.low > piece.high ||
+        piece.low < start || piece.high > stop)
+      break;
+
+    pieces_.push_back(piece);
+  }
+}
+
+void Checkpoint::add(uint64_t low, uint64_t high, const counts_t& counts)
+{
+  lock_guard<mutex> lock(lock_);
+  pieces_.push_back({ low, high, counts });
+
+  auto now = chrono::steady_clock::now();
+  chrono::duration<double> seconds = now - lastSave_;
+
+  if (seconds.count() >= seconds_)
+  {
+    write();
+    lastSave_ = now;
+  }
+}
+
+void Checkpoint::save()
+{
+  lock_guard<mutex> lock(lock_);
+  write();
+  lastSave_ = chrono::steady_clock::now();
+}
+
+counts_t Checkpoint::getCounts() const
+{
+  lock_guard<mutex> lock(lock_);
+  counts_t counts;
+  counts.fill(0);
+
+  for (auto& piece : pieces_)
+    for (size_t i = 0; i < counts.size(); i++)
+      counts[i] += piece.counts[i];
+
+  return counts;
+}
+
+vector<pair<uint64_t, uint64_t>> Checkpoint::remaining() const
+{
+  lock_guard<mutex> lock(lock_);
+  vector<pair<uint64_t, uint64_t>> finished;
+  vector<pair<uint64_t, uint64_t>> intervals;
+
+  for (auto& piece : pieces_)
+    finished.emplace_back(piece.low, piece.high);
+
+  sort(finished.begin(), finished.end());
+  uint64_t low = start_;
+  bool done = start_ > stop_;
+
+  for (auto& piece : finished)
+  {
+    if (done)
+      break;
+    if (piece.first > low)
+      intervals.emplace_back(low, piece.first - 1);
+    if (piece.second >= stop_)
+      done = true;
+    else
+      low = max(low, piece.second + 1);
+  }
+
+  if (!done)
+    intervals.emplace_back(low, stop_);
+
+  return intervals;
+}
+
+void Checkpoint::write() const
+{
+  string tmp = filename_ + ".tmp";
+
+  {
+    ofstream file(tmp);
+    if (!file)
+      throw primesieve_error("failed to open " + tmp);
+
+    file << "# primesieve checkpoint: start stop flags, then low high counts\n";
+    file << start_ << ' ' << stop_ << ' ' << flags_ << '\n';
+
+    for (auto& piece : pieces_)
+    {
+      file << piece.low << ' ' << piece.high;
+      for (uint64_t count : piece.counts)
+        file << ' ' << count;
+      file << '\n';
+    }
+
+    if (!file.flush())
+      throw primesieve_error("failed to write " + tmp);
+  }
+
+  // rename() does not replace an
+  // existing file on Windows
+#if defined(_WIN32)
+  remove(filename_.c_str());
+#endif
+
+  if (rename(tmp.c_str(), filename_.c_str()) != 0)
+    throw primesieve_error("failed to rename " + tmp + " to " + filename_);
+}
+
+} // namespace
@@ -0,0 +1,308 @@
+///
+/// @file   ChunkScheduler.cpp
+/// @brief  Work-stealing scheduler used by ParallelSieve. Each
+///         thread sieves its own contiguous span and steals work
+///         from the other threads once its own span has been
+///         completed.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/ChunkScheduler.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Align n to modulo (30 + 2) to prevent prime k-tuplet
+/// (twin primes, prime triplets) gaps
+///
+uint64_t alignTo(uint64_t n, uint64_t stop)
+{
+  uint64_t n32 = primesieve::checkedAdd(n, 32);
+
+  if (n32 >= stop)
+    return stop;
+
+  return n32 - n % 30;
+}
+
+} // namespace
+
+namespace primesieve {
+
+ChunkScheduler::ChunkScheduler(uint64_t start,
+                               uint64_t stop,
+                               int threads,
+                               uint64_t minDist) :
+  ChunkScheduler(start, stop, vector<double>(max(threads, 1), 1.0), minDist)
+{ }
+
+/// @weights: Relative speed of the threads, the initial
+///           span of each thread is proportional to its weight
+///
+ChunkScheduler::ChunkScheduler(uint64_t start,
+                               uint64_t stop,
+                               const vector<double>& weights,
+                               uint64_t minDist) :
+  stop_(stop),
+  minDist_(max<uint64_t>(minDist, 100)),
+  threads_(max((int) weights.size(), 1)),
+  spans_(new Span[threads_])
+{
+  if (start > stop)
+    return;
+
+  long double sum = 0;
+  long double total = 0;
+  for (double w : weights)
+    total += w;
+
+  uint64_t low = start;
+
+  for (int i = 0; i < threads_; i++)
+  {
+    if (i < (int) weights.size())
+    {
+      spans_[i].weight = weights[i];
+      sum += weights[i];
+    }
+
+    uint64_t high = stop;
+    if (i + 1 < threads_ && total > 0)
+      high = align(start + (uint64_t) ((stop - start) * (sum / total)));
+
+    if (low > high)
+      continue;
+
+    spans_[i].start = low;
+    spans_[i].stop = high;
+    spans_[i].empty = false;
+
+    if (high >= stop)
+      break;
+
+    low = high + 1;
+  }
+}
+
+uint64_t ChunkScheduler::align(uint64_t n) const
+{
+  return alignTo(n, stop_);
+}
+
+vector<pair<uint64_t, uint64_t>>
+ChunkScheduler::split(uint64_t start,
+                      uint64_t stop,
+                      uint64_t parts,
+                      uint64_t minDist)
+{
+  vector<pair<uint64_t, uint64_t>> ranges;
+  if (start > stop)
+    return ranges;
+
+  uint64_t dist = stop - start;
+  minDist = max<uint64_t>(minDist, 100);
+  parts = inBetween<uint64_t>(1, parts, dist / minDist + 1);
+  uint64_t chunk = dist / parts + 1;
+  uint64_t low = start;
+
+  for (uint64_t i = 1; low <= stop; i++)
+  {
+    uint64_t high = stop;
+    if (i < parts && chunk * i < dist)
+      high = alignTo(start + chunk * i, stop);
+
+    ranges.emplace_back(low, high);
+    if (high >= stop)
+      break;
+
+    low = high + 1;
+  }
+
+  return ranges;
+}
+
+bool ChunkScheduler::next(int* span,
+                          uint64_t* start,
+                          uint64_t* stop,
+                          double weight)
+{
+  if (*span >= 0)
+  {
+    // our previous span has been sieved
+    lock_guard<mutex> lock(spans_[*span].lock);
+    spans_[*span].empty = true;
+  }
+  else if (!adopt(span, true, weight) &&
+           !adopt(span, false, weight))
+    return false;
+
+  while (true)
+  {
+    Span& s = spans_[*span];
+
+    {
+      lock_guard<mutex> lock(s.lock);
+
+      if (!s.empty)
+      {
+        *start = s.start;
+        *stop = s.stop;
+        return true;
+      }
+    }
+
+    if (!adopt(span, true, weight) &&
+        !steal(*span))
+      return false;
+  }
+}
+
+uint64_t ChunkScheduler::claim(int span, uint64_t high)
+{
+  Span& s = spans_[span];
+  lock_guard<mutex> lock(s.lock);
+
+  if (high < s.stop)
+    s.start = max(s.start, high + 1);
+  else
+    s.start = s.stop;
+
+  return s.stop;
+}
+
+void ChunkScheduler::release(int span)
+{
+  if (span < 0)
+    return;
+
+  Span& s = spans_[span];
+  lock_guard<mutex> lock(s.lock);
+  s.empty = true;
+  s.owned = false;
+}
+
+/// Adopt a span that is not owned by any thread
+/// (because its thread has not been started yet).
+/// @nonEmpty: Only adopt spans with work left
+/// @weight:   Prefer the span whose weight is closest
+///
+bool ChunkScheduler::adopt(int* span, bool nonEmpty, double weight)
+{
+  while (true)
+  {
+    int best = -1;
+    double bestDiff = 0;
+
+    for (int i = 0; i < threads_; i++)
+    {
+      Span& s = spans_[i];
+      lock_guard<mutex> lock(s.lock);
+
+      if (!s.owned && (!nonEmpty || !s.empty))
+      {
+        double diff = fabs(s.weight - weight);
+        if (best < 0 || diff < bestDiff)
+        {
+          best = i;
+          bestDiff = diff;
+        }
+      }
+    }
+
+    if (best < 0)
+      return false;
+
+    Span& s = spans_[best];
+    lock_guard<mutex> lock(s.lock);
+
+    // another thread may have adopted the span
+    if (!s.owned && (!nonEmpty || !s.empty))
+    {
+      s.owned = true;
+      if (*span >= 0)
+      {
+        lock_guard<mutex> lock2(spans_[*span].lock);
+        spans_[*span].owned = false;
+      }
+      *span = best;
+      return true;
+    }
+  }
+}
+
+/// Move the upper half of the unclaimed distance
+/// of the span with most work left to our span
+///
+bool ChunkScheduler::steal(int span)
+{
+  while (true)
+  {
+    int victim = -1;
+    uint64_t maxDist = minDist_ * 2;
+
+    for (int i = 0; i < threads_; i++)
+    {
+      Span& s = spans_[i];
+      lock_guard<mutex> lock(s.lock);
+
+      if (i != span &&
+          !s.empty &&
+          s.stop - s.start >= maxDist)
+      {
+        victim = i;
+        maxDist = s.stop - s.start;
+      }
+    }
+
+    if (victim < 0)
+      return false;
+
+    uint64_t start = 0;
+    uint64_t stop = 0;
+
+    {
+      Span& s = spans_[victim];
+      lock_guard<mutex> lock(s.lock);
+
+      if (!s.empty &&
+          s.stop - s.start >= minDist_ * 2)
+      {
+        uint64_t mid = s.start + (s.stop - s.start) / 2;
+        uint64_t split = align(mid);
+
+        if (split < s.stop)
+        {
+          start = split + 1;
+          stop = s.stop;
+          s.stop = split;
+        }
+      }
+    }
+
+    if (start > 0)
+    {
+      Span& s = spans_[span];
+      lock_guard<mutex> lock(s.lock);
+      s.start = start;
+      s.stop = stop;
+      s.empty = false;
+      return true;
+    }
+  }
+}
+
+} // namespace
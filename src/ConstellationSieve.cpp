@@ -0,0 +1,220 @@
+///
+/// @file   ConstellationSieve.cpp
+/// @brief  Count prime constellations using the sieve array.
+///         The sieve array has 8 bits (one per residue class
+///         coprime to 30) for 30 numbers. For each of the 8
+///         residues of n the constellation n + offsets[i] is
+///         compiled into (byte distance, bit) terms. The terms
+///         are evaluated for 8 bytes (8 candidates) at once using
+///         64-bit words and the matches are counted using
+///         primesieve's popcount kernel. The segments are
+///         appended to a buffer so that constellations which
+///         cross segment boundaries are also found.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/ConstellationSieve.hpp>
+#include <primesieve/littleendian_cast.hpp>
+#include <primesieve/MillerRabin.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SievingPrimes.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const array<uint64_t, 8> bitValues = { 7, 11, 13, 17, 19, 23, 29, 31 };
+
+/// unset bits > 30 * byte + r
+const array<uint64_t, 32> unsetLarger =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01,
+  0x01, 0x01, 0x01, 0x03, 0x03, 0x07, 0x07, 0x07,
+  0x07, 0x0f, 0x0f, 0x1f, 0x1f, 0x1f, 0x1f, 0x3f,
+  0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x7f, 0x7f, 0xff
+};
+
+bool isCoprime30(uint64_t n)
+{
+  return n % 2 != 0 && n % 3 != 0 && n % 5 != 0;
+}
+
+} // namespace
+
+namespace primesieve {
+
+Constellation::Constellation(const vector<uint64_t>& offsets) :
+  offsets_(offsets)
+{
+  if (offsets.empty() || offsets[0] != 0)
+    throw primesieve_error("constellation offsets must start with 0");
+
+  for (size_t i = 1; i < offsets.size(); i++)
+    if (offsets[i] <= offsets[i - 1])
+      throw primesieve_error("constellation offsets must be increasing");
+
+  if (offsets.back() > (1ull << 40))
+    throw primesieve_error("constellation offsets must be <= 2^40");
+
+  for (int bit = 0; bit < 8; bit++)
+  {
+    vector<Term> terms;
+
+    for (uint64_t offset : offsets)
+    {
+      uint64_t n = bitValues[bit] + offset;
+      if (!isCoprime30(n))
+      {
+        terms.clear();
+        break;
+      }
+
+      // n is inside byte (n - 2) / 30
+      uint64_t bytes = (n - 2) / 30;
+      uint64_t value = n - bytes * 30;
+      int i = (int) (find(bitValues.begin(), bitValues.end(), value) - bitValues.begin());
+      terms.push_back(Term{bytes, i});
+      maxBytes_ = max(maxBytes_, bytes);
+    }
+
+    terms_[bit] = terms;
+  }
+}
+
+ConstellationSieve::ConstellationSieve(uint64_t start,
+                                       uint64_t maxN,
+                                       uint64_t stop,
+                                       int sieveSize,
+                                       const Constellation& constellation,
+                                       const SievingTable* sievingTable) :
+  minN_(start),
+  maxN_(maxN),
+  constellation_(constellation),
+  sievingTable_(sievingTable)
+{
+  stop_ = stop;
+  start = max<uint64_t>(start, 7);
+
+  if (start <= maxN && start <= stop)
+    Erat::init(start, stop, sieveSize, preSieve_);
+}
+
+/// Count the n inside [start, maxN] for which all
+/// n + offsets[i] are prime and <= stop
+///
+uint64_t ConstellationSieve::count()
+{
+  uint64_t count = 0;
+  uint64_t stop = stop_;
+
+  // the sieve array only contains
+  // numbers coprime to 30
+  for (uint64_t n : { 2, 3, 5 })
+  {
+    if (n < minN_ || n > maxN_)
+      continue;
+
+    bool isMatch = true;
+    for (uint64_t offset : constellation_.offsets())
+      isMatch = isMatch && n + offset <= stop && isPrime(n + offset);
+
+    count += isMatch;
+  }
+
+  if (max<uint64_t>(minN_, 7) > min(maxN_, stop))
+    return count;
+
+  SievingPrimes sievingPrimes(this, preSieve_, sievingTable_);
+  uint64_t prime = sievingPrimes.next();
+  // bytes needed beyond the last candidate
+  uint64_t extra = constellation_.maxBytes() + 8;
+
+  while (hasNextSegment())
+  {
+    if (buffer_.empty())
+      bufferLow_ = segmentLow_;
+
+    uint64_t sqrtHigh = isqrt(segmentHigh_);
+    for (; prime <= sqrtHigh; prime = sievingPrimes.next())
+      addSievingPrime(prime);
+
+    sieveSegment();
+    buffer_.insert(buffer_.end(), sieve_, sieve_ + sieveSize_);
+
+    if (buffer_.size() > extra)
+    {
+      uint64_t bytes = (buffer_.size() - extra) / 8 * 8;
+      count += countBuffer(bytes);
+      buffer_.erase(buffer_.begin(), buffer_.begin() + bytes);
+      bufferLow_ += bytes * 30;
+    }
+  }
+
+  // the numbers > stop are not prime
+  uint64_t bytes = ceilDiv(buffer_.size(), 8) * 8;
+  buffer_.resize(bytes + extra, 0);
+  count += countBuffer(bytes);
+
+  return count;
+}
+
+/// Count the matches of the candidates inside buffer_[0, bytes[
+uint64_t ConstellationSieve::countBuffer(uint64_t bytes)
+{
+  if (maxN_ < bufferLow_ + 7)
+    return 0;
+
+  // unset the candidates > maxN_
+  uint64_t lastByte = (maxN_ - bufferLow_ - 2) / 30;
+  uint64_t rem = maxN_ - bufferLow_ - lastByte * 30;
+  bytes = min(bytes, lastByte / 8 * 8 + 8);
+  matches_.resize(bytes / 8);
+
+  const uint64_t ones = 0x0101010101010101ull;
+  const byte_t* buffer = buffer_.data();
+
+  for (uint64_t i = 0; i < bytes; i += 8)
+  {
+    uint64_t word = 0;
+
+    for (int bit = 0; bit < 8; bit++)
+    {
+      auto& terms = constellation_.terms(bit);
+      if (terms.empty())
+        continue;
+
+      // bit 0 of each byte is set if the 8
+      // candidates of this residue match
+      uint64_t match = ones;
+      for (auto& term : terms)
+        match &= littleendian_cast<uint64_t>(&buffer[i + term.bytes]) >> term.bit;
+
+      word |= (match & ones) << bit;
+    }
+
+    matches_[i / 8] = word;
+  }
+
+  if (lastByte < bytes)
+  {
+    uint64_t shift = (lastByte % 8) * 8;
+    uint64_t mask = (1ull << shift) - 1;
+    mask |= unsetLarger[rem] << shift;
+    matches_.back() &= mask;
+  }
+
+  return popcount(matches_.data(), matches_.size());
+}
+
+} // namespace
@@ -0,0 +1,157 @@
+///
+/// @file  CountCache.cpp
+/// @brief Process-wide LRU cache of the counts of aligned chunks.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/CountCache.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <limits>
+#include <mutex>
+
+using namespace std;
+
+namespace {
+
+/// Memory usage of an entry including the
+/// list node and the hash table node
+///
+const uint64_t entryBytes = 128;
+
+} // namespace
+
+namespace primesieve {
+
+CountCache& countCache()
+{
+  static CountCache cache;
+  return cache;
+}
+
+uint64_t CountCache::chunkLow(uint64_t chunk)
+{
+  return (chunk) ? chunk * config::COUNT_CACHE_CHUNK + 3 : 0;
+}
+
+uint64_t CountCache::chunkHigh(uint64_t chunk)
+{
+  return (chunk + 1) * config::COUNT_CACHE_CHUNK + 2;
+}
+
+uint64_t CountCache::firstChunk(uint64_t n)
+{
+  if (n == 0)
+    return 0;
+  if (n <= 3)
+    return 1;
+
+  return ceilDiv(n - 3, config::COUNT_CACHE_CHUNK);
+}
+
+uint64_t CountCache::chunks(uint64_t n)
+{
+  uint64_t max = numeric_limits<uint64_t>::max();
+
+  // the high of the next chunk must not overflow
+  n = min(n, max - config::COUNT_CACHE_CHUNK);
+  if (n < 2)
+    return 0;
+
+  return (n - 2) / config::COUNT_CACHE_CHUNK;
+}
+
+void CountCache::setMaxSize(uint64_t bytes)
+{
+  lock_guard<mutex> lock(mutex_);
+  maxSize_ = bytes;
+  evict(bytes);
+}
+
+bool CountCache::get(uint64_t chunk, int countFlags, counts_t& counts)
+{
+  lock_guard<mutex> lock(mutex_);
+  auto iter = index_.find(chunk);
+
+  if (iter == index_.end() ||
+      (iter->second->countFlags & countFlags) != countFlags)
+  {
+    misses_++;
+    return false;
+  }
+
+  // move to the front of the LRU list
+  lru_.splice(lru_.begin(), lru_, iter->second);
+  const Entry& entry = *iter->second;
+
+  for (size_t i = 0; i < counts.size(); i++)
+    if (countFlags & (COUNT_PRIMES << i))
+      counts[i] = entry.counts[i];
+
+  hits_++;
+  return true;
+}
+
+/// If the chunk is already cached the
+/// counts of the new flags are added
+///
+void CountCache::put(uint64_t chunk, int countFlags, const counts_t& counts)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if (entryBytes > maxSize_)
+    return;
+
+  auto iter = index_.find(chunk);
+
+  if (iter == index_.end())
+  {
+    evict(maxSize_ - entryBytes);
+    lru_.push_front(Entry{chunk, countFlags, counts});
+    index_[chunk] = lru_.begin();
+    size_ += entryBytes;
+    return;
+  }
+
+  Entry& entry = *iter->second;
+  entry.countFlags |= countFlags;
+  for (size_t i = 0; i < counts.size(); i++)
+    if (countFlags & (COUNT_PRIMES << i))
+      entry.counts[i] = counts[i];
+}
+
+/// Remove the least recently used
+/// chunks until size <= maxSize
+///
+void CountCache::evict(uint64_t maxSize)
+{
+  while (size_ > maxSize)
+  {
+    index_.erase(lru_.back().chunk);
+    lru_.pop_back();
+    size_ -= entryBytes;
+  }
+}
+
+void set_count_cache_size(uint64_t bytes)
+{
+  countCache().setMaxSize(bytes);
+}
+
+count_cache_stats get_count_cache_stats()
+{
+  count_cache_stats stats;
+  stats.hits = countCache().getHits();
+  stats.misses = countCache().getMisses();
+  return stats;
+}
+
+} // namespace
@@ -0,0 +1,158 @@
+///
+/// @file   Counters.cpp
+/// @brief  Each thread increments its own counters, the counters
+///         of exited threads are added to a process-wide total.
+///         get_sieve_counters() sums up the total and the
+///         counters of the running threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/Counters.hpp>
+
+#include <stdint.h>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <set>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+using counters_t = array<uint64_t, COUNTERS>;
+
+#if defined(PRIMESIEVE_COUNTERS)
+
+using thread_counters_t = array<atomic<uint64_t>, COUNTERS>;
+
+struct Registry
+{
+  mutex lock;
+  set<thread_counters_t*> threads;
+  counters_t exited {};
+};
+
+/// Never destroyed, the ThreadPool threads
+/// may exit after the static destructors
+///
+Registry& registry()
+{
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+struct ThreadCounters
+{
+  thread_counters_t counters;
+
+  ThreadCounters()
+  {
+    for (auto& c : counters)
+      c = 0;
+
+    Registry& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    r.threads.insert(&counters);
+  }
+
+  ~ThreadCounters()
+  {
+    Registry& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    r.threads.erase(&counters);
+    for (int i = 0; i < COUNTERS; i++)
+      r.exited[i] += counters[i];
+  }
+};
+
+counters_t sumCounters()
+{
+  Registry& r = registry();
+  lock_guard<mutex> lock(r.lock);
+  counters_t sum = r.exited;
+
+  for (auto* counters : r.threads)
+    for (int i = 0; i < COUNTERS; i++)
+      sum[i] += (*counters)[i].load(memory_order_relaxed);
+
+  return sum;
+}
+
+#else
+
+counters_t sumCounters()
+{
+  counters_t sum {};
+  return sum;
+}
+
+#endif
+
+} // namespace
+
+namespace primesieve {
+
+#if defined(PRIMESIEVE_COUNTERS)
+
+atomic<uint64_t>* threadCounters()
+{
+  thread_local ThreadCounters counters;
+  return counters.counters.data();
+}
+
+#endif
+
+bool has_sieve_counters()
+{
+#if defined(PRIMESIEVE_COUNTERS)
+  return true;
+#else
+  return false;
+#endif
+}
+
+sieve_counters get_sieve_counters()
+{
+  counters_t sum = sumCounters();
+  sieve_counters counters;
+
+  counters.segments = sum[COUNTER_SEGMENTS];
+  counters.segments_consumed = sum[COUNTER_SEGMENTS_CONSUMED];
+
+  for (int i = 0; i < 3; i++)
+  {
+    counters.sieving_primes[i] = sum[COUNTER_SIEVING_PRIMES_SMALL + i];
+    counters.bits_unset[i] = sum[COUNTER_BITS_UNSET_SMALL + i];
+  }
+
+  for (int i = 0; i < 2; i++)
+  {
+    counters.buckets_pushed[i] = sum[COUNTER_BUCKETS_PUSHED_MEDIUM + i];
+    counters.buckets_allocated[i] = sum[COUNTER_BUCKETS_ALLOCATED_MEDIUM + i];
+    counters.buckets_recycled[i] = sum[COUNTER_BUCKETS_RECYCLED_MEDIUM + i];
+  }
+
+  return counters;
+}
+
+/// Must not be called whilst sieving
+void reset_sieve_counters()
+{
+#if defined(PRIMESIEVE_COUNTERS)
+  Registry& r = registry();
+  lock_guard<mutex> lock(r.lock);
+  r.exited.fill(0);
+
+  for (auto* counters : r.threads)
+    for (auto& c : *counters)
+      c.store(0, memory_order_relaxed);
+#endif
+}
+
+} // namespace
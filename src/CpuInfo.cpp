@@ -1,7 +1,8 @@
 ///
 /// @file   CpuInfo.cpp
 /// @brief  Get detailed information about the CPU's caches
-///         on Windows, macOS and Linux.
+///         on Windows, macOS and Linux and detect the x86 and
+///         ARM SIMD instruction sets.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -10,13 +11,21 @@
 ///
 
 #include <primesieve/CpuInfo.hpp>
+#include <primesieve/Affinity.hpp>
+#include <primesieve/pmath.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <cstddef>
 #include <exception>
 #include <string>
 #include <vector>
 
+#if defined(__aarch64__) && \
+    defined(__linux__)
+  #include <sys/auxv.h>
+#endif
+
 using namespace std;
 
 namespace primesieve {
@@ -28,6 +37,7 @@ CpuInfo::CpuInfo() :
   cpuCores_(0),
   cpuThreads_(0),
   threadsPerCore_(0),
+  availableCpus_(1),
   cacheSizes_{0, 0, 0, 0},
   cacheSharing_{0, 0, 0, 0}
 {
@@ -44,6 +54,10 @@ CpuInfo::CpuInfo() :
     // e.g. 32 KiB L1 data cache size.
     error_ = e.what();
   }
+
+  // Detected once at startup, before the
+  // ThreadPool pins any of its threads
+  availableCpus_ = getAvailableCpus(cpuLimit_);
 }
 
 string CpuInfo::cpuName() const
@@ -96,6 +110,16 @@ size_t CpuInfo::threadsPerCore() const
   return threadsPerCore_;
 }
 
+size_t CpuInfo::availableCpus() const
+{
+  return availableCpus_;
+}
+
+string CpuInfo::cpuLimit() const
+{
+  return cpuLimit_;
+}
+
 string CpuInfo::getError() const
 {
   return error_;
@@ -172,6 +196,190 @@ bool CpuInfo::hasPrivateL2Cache() const
          l2Sharing() <= threadsPerCore_;
 }
 
+bool CpuInfo::hasHybridCpu() const
+{
+  return coreClasses_.size() > 1;
+}
+
+#if defined(__GNUC__) && \
+   (defined(__x86_64__) || defined(__i386__))
+
+bool CpuInfo::hasSSE2() const
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2") != 0;
+}
+
+bool CpuInfo::hasAVX2() const
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2") != 0;
+}
+
+bool CpuInfo::hasAVX512() const
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512f") != 0;
+}
+
+bool CpuInfo::hasPOPCNT() const
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("popcnt") != 0;
+}
+
+bool CpuInfo::hasBMI() const
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("bmi") != 0;
+}
+
+bool CpuInfo::hasAVX512VPOPCNT() const
+{
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx512vpopcntdq") != 0;
+}
+
+#else
+
+bool CpuInfo::hasSSE2() const
+{
+  return false;
+}
+
+bool CpuInfo::hasAVX2() const
+{
+  return false;
+}
+
+bool CpuInfo::hasAVX512() const
+{
+  return false;
+}
+
+bool CpuInfo::hasPOPCNT() const
+{
+  return false;
+}
+
+bool CpuInfo::hasBMI() const
+{
+  return false;
+}
+
+bool CpuInfo::hasAVX512VPOPCNT() const
+{
+  return false;
+}
+
+#endif
+
+#if defined(__aarch64__) || \
+    defined(_M_ARM64)
+
+/// NEON (ASIMD) is part of the
+/// aarch64 base instruction set
+///
+bool CpuInfo::hasNEON() const
+{
+  return true;
+}
+
+bool CpuInfo::hasSVE() const
+{
+#if defined(__linux__) && \
+    defined(HWCAP_SVE)
+  return (getauxval(AT_HWCAP) & HWCAP_SVE) != 0;
+#else
+  return false;
+#endif
+}
+
+#else
+
+bool CpuInfo::hasNEON() const
+{
+  return false;
+}
+
+bool CpuInfo::hasSVE() const
+{
+  return false;
+}
+
+#endif
+
+const vector<CoreClass>& CpuInfo::coreClasses() const
+{
+  return coreClasses_;
+}
+
+/// Number of our threads sharing each cache of the level,
+/// assuming the threads are spread evenly across the CPU
+/// cores as done by the operating system and by the thread
+/// pinning (see getCpuOrder()). E.g. with SMT and more
+/// threads than CPU cores, 2 threads share each L1 and L2.
+///
+size_t CpuInfo::threadsSharing(int level, int threads) const
+{
+  if (level < 1 || level > 3 ||
+      !hasCpuThreads() ||
+      cacheSharing_[level] < 1 ||
+      cacheSharing_[level] > (1 << 20))
+    return 1;
+
+  size_t sharing = cacheSharing_[level];
+  size_t n = ceilDiv((size_t) max(threads, 1) * sharing, cpuThreads_);
+  return inBetween(1, n, sharing);
+}
+
+/// Default sieve size in KiB: the L2 cache size if each
+/// CPU core has a private L2 cache, else the L1 cache size.
+/// The threads sharing a cache get an equal share of it.
+///
+int CpuInfo::sieveSize(int threads) const
+{
+  size_t l1Size = l1CacheSize() / threadsSharing(1, threads);
+  size_t l2Size = l2CacheSize() / threadsSharing(2, threads);
+
+  // convert bytes to KiB
+  l1Size >>= 10;
+  l2Size >>= 10;
+
+  // check if each CPU core has a private L2 cache
+  if (hasL2Cache() &&
+      hasPrivateL2Cache() &&
+      l2Size > l1Size)
+  {
+    l2Size = inBetween(32, l2Size, 4096);
+    l2Size = floorPow2(l2Size);
+    return (int) l2Size;
+  }
+  else
+  {
+    if (!hasL1Cache())
+      l1Size = 32;
+
+    // if the CPU does not have an L2 cache or if the
+    // cache is shared between all CPU cores we
+    // set the sieve size to the CPU's L1 cache size
+
+    l1Size = inBetween(8, l1Size, 4096);
+    l1Size = floorPow2(l1Size);
+    return (int) l1Size;
+  }
+}
+
+int CpuInfo::coreClass(int cpu) const
+{
+  for (size_t i = 0; i < coreClasses_.size(); i++)
+    for (int n : coreClasses_[i].cpus)
+      if (n == cpu)
+        return (int) i;
+
+  return -1;
+}
+
 } // namespace
 
 #if defined(__APPLE__)
@@ -686,6 +894,29 @@ size_t getThreads(const string& threadList,
     return parseThreadMap(threadMap);
 }
 
+/// Get the thread IDs of a thread list file.
+/// Example: 0-3,8 -> { 0, 1, 2, 3, 8 }
+///
+vector<int> getThreadIds(const string& filename)
+{
+  vector<int> ids;
+  auto threadList = getString(filename);
+  auto tokens = split(threadList, ',');
+
+  for (auto& str : tokens)
+  {
+    auto values = split(str, '-');
+    int t0 = stoi(values.at(0));
+    int t1 = t0;
+    if (values.size() > 1)
+      t1 = stoi(values.at(1));
+    for (int t = t0; t <= t1; t++)
+      ids.push_back(t);
+  }
+
+  return ids;
+}
+
 } // namespace
 
 namespace primesieve {
@@ -728,6 +959,95 @@ void CpuInfo::init()
       }
     }
   }
+
+  initCoreClasses();
+}
+
+/// Hybrid CPUs have multiple core types with different
+/// performance and cache sizes. Intel hybrid CPUs list their
+/// efficiency cores in /sys/devices/cpu_atom/cpus, ARM
+/// big.LITTLE CPUs report a cpu_capacity for each core.
+///
+void CpuInfo::initCoreClasses()
+{
+  string cpuPath = "/sys/devices/system/cpu/";
+  auto atomCpus = getThreadIds("/sys/devices/cpu_atom/cpus");
+  bool hasCapacity = !getString(cpuPath + "cpu0/cpu_capacity").empty();
+
+  if (atomCpus.empty() &&
+      !hasCapacity)
+    return;
+
+  // initialize coreClasses_ at the end, so that it
+  // stays empty if an exception is thrown
+  vector<CoreClass> classes;
+
+  for (int cpu : getThreadIds(cpuPath + "online"))
+  {
+    CoreClass core;
+    string path = cpuPath + "cpu" + to_string(cpu);
+    core.capacity = getValue(path + "/cpu_capacity");
+    core.l1CacheSize = 0;
+    core.l2CacheSize = 0;
+    core.l2Sharing = 0;
+    bool isAtom = find(atomCpus.begin(), atomCpus.end(), cpu) != atomCpus.end();
+
+    // Intel hybrid CPUs without cpu_capacity,
+    // use the max frequency instead
+    if (!core.capacity)
+      core.capacity = getValue(path + "/cpufreq/cpuinfo_max_freq");
+
+    for (size_t i = 0; i <= 3; i++)
+    {
+      string cache = path + "/cache/index" + to_string(i);
+      size_t level = getValue(cache + "/level");
+      string type = getString(cache + "/type");
+
+      if (type != "Data" &&
+          type != "Unified")
+        continue;
+
+      if (level == 1)
+        core.l1CacheSize = getCacheSize(cache + "/size");
+      if (level == 2)
+      {
+        core.l2CacheSize = getCacheSize(cache + "/size");
+        core.l2Sharing = getThreads(cache + "/shared_cpu_list", cache + "/shared_cpu_map");
+      }
+    }
+
+    auto iter = find_if(classes.begin(), classes.end(), [&](const CoreClass& c)
+    {
+      return c.capacity == core.capacity &&
+             c.l2CacheSize == core.l2CacheSize &&
+             c.l2Sharing == core.l2Sharing &&
+             (find(atomCpus.begin(), atomCpus.end(), c.cpus[0]) != atomCpus.end()) == isAtom;
+    });
+
+    if (iter != classes.end())
+      iter->cpus.push_back(cpu);
+    else
+    {
+      core.cpus.push_back(cpu);
+      classes.push_back(core);
+    }
+  }
+
+  sort(classes.begin(), classes.end(), [](const CoreClass& a, const CoreClass& b)
+  {
+    return a.capacity > b.capacity;
+  });
+
+  if (classes.size() <= 1 ||
+      !classes[0].capacity)
+    return;
+
+  // scale to Linux cpu_capacity units
+  size_t maxCapacity = classes[0].capacity;
+  for (auto& c : classes)
+    c.capacity = max<size_t>(1, c.capacity * 1024 / maxCapacity);
+
+  coreClasses_ = classes;
 }
 
 } // namespace
@@ -0,0 +1,302 @@
+///
+/// @file   CunninghamChains.cpp
+/// @brief  Find the primes p for which p, 2p + 1, 4p + 3, ...
+///         (Cunningham chain of the first kind) are all prime,
+///         e.g. the Sophie Germain primes. Instead of sieving
+///         [start, stop] and [2 * start + 1, 2 * stop + 1]
+///         separately and combining the bitmaps we sieve the
+///         candidates p = 30 * k + r (r = residues for which no
+///         member is divisible by 2, 3 or 5) using
+///         sieve_sequence(). Each sieving prime q removes the k
+///         for which any member is divisible by q, hence both
+///         bitmaps are combined while crossing off and each
+///         candidate needs only 1 bit.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/sequence_sieve.hpp>
+#include <primesieve/ThreadPool.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Candidates 30 * k + residue with k inside [kLow, kHigh]
+struct Chunk
+{
+  uint64_t residue;
+  uint64_t kLow;
+  uint64_t kHigh;
+};
+
+/// Member i of the chain of p is 2^i * (p + 1) - 1
+uint64_t member(uint64_t p, int i)
+{
+  return ((p + 1) << i) - 1;
+}
+
+bool isChain(uint64_t p, int length)
+{
+  for (int i = 0; i < length; i++)
+    if (!is_prime(member(p, i)))
+      return false;
+
+  return true;
+}
+
+/// Residues mod 30 for which no member
+/// is divisible by 2, 3 or 5
+///
+vector<uint64_t> residues(int length)
+{
+  vector<uint64_t> result;
+
+  for (uint64_t r = 1; r < 30; r++)
+  {
+    bool admissible = true;
+    uint64_t m = r;
+    for (int i = 0; i < length; i++, m = (m * 2 + 1) % 30)
+      if (m % 2 == 0 || m % 3 == 0 || m % 5 == 0)
+        admissible = false;
+
+    if (admissible)
+      result.push_back(r);
+  }
+
+  return result;
+}
+
+/// Roots of the members of 30 * k + r: member i is divisible
+/// by q if k = -(r + 1) / 30 + 1 / (30 * 2^i) (mod q)
+///
+roots_callback chainRoots(uint64_t r, int length)
+{
+  auto inverse30 = progression_roots(1, 30);
+  vector<uint64_t> tmp;
+
+  return [=](uint64_t q, vector<uint64_t>& roots) mutable
+  {
+    if (q <= 5)
+      return;
+
+    // 1 + 30 * k = 0 (mod q) <==> k = -30^-1 (mod q)
+    tmp.clear();
+    inverse30(q, tmp);
+    uint64_t inv30 = q - tmp[0];
+    uint64_t inv2 = (q + 1) / 2;
+    uint64_t kc = ((q - (r + 1) % q) * inv30) % q;
+    uint64_t t = inv30;
+
+    for (int i = 0; i < length; i++)
+    {
+      roots.push_back((kc + t) % q);
+      t = (t * inv2) % q;
+    }
+  };
+}
+
+void checkLength(int length, uint64_t stop)
+{
+  if (length < 1 || length > 64)
+    throw primesieve_error("Cunningham chain length must be >= 1 and <= 64");
+
+  // the last member 2^(length-1) * (stop + 1) - 1
+  // of stop must be <= 2^64 - 1
+  uint64_t max = numeric_limits<uint64_t>::max();
+  if (stop > max >> (length - 1))
+    throw primesieve_error("Cunningham chain: last member of stop " + to_string(stop) + " >= 2^64");
+}
+
+/// Index of the lowest set bit, @pre x != 0
+inline uint64_t lowestBit(uint64_t x)
+{
+#if defined(__GNUC__)
+  return __builtin_ctzll(x);
+#else
+  uint64_t i = 0;
+  for (; !(x & 1); x >>= 1)
+    i++;
+  return i;
+#endif
+}
+
+struct Plan
+{
+  uint64_t maxPrime = 0;
+  /// Chains of the p <= max(maxPrime, 30)
+  vector<uint64_t> small;
+  vector<Chunk> chunks;
+};
+
+/// The small p are tested directly as the sieve removes
+/// a candidate equal to a sieving prime, the remaining
+/// candidates are split into chunks.
+///
+Plan getPlan(int length, uint64_t start, uint64_t stop)
+{
+  checkLength(length, stop);
+  Plan plan;
+
+  if (start > stop)
+    return plan;
+
+  plan.maxPrime = isqrt(member(stop, length - 1));
+  uint64_t smallLimit = max<uint64_t>(plan.maxPrime, 30);
+  uint64_t smallStop = min(stop, smallLimit);
+
+  if (start <= smallStop)
+  {
+    primesieve::iterator it(start > 0 ? start - 1 : 0, smallStop);
+    for (uint64_t p = it.next_prime(); p <= smallStop; p = it.next_prime())
+      if (isChain(p, length))
+        plan.small.push_back(p);
+  }
+
+  if (stop <= smallLimit)
+    return plan;
+
+  start = max(start, smallLimit + 1);
+
+  // large chunks amortize the computation of the
+  // roots of all sieving primes of each chunk
+  uint64_t chunkSize = max<uint64_t>(1 << 24, plan.maxPrime * 16);
+
+  for (uint64_t r : residues(length))
+  {
+    if (stop < r)
+      continue;
+    uint64_t kLow = ceilDiv(start - min(start, r), 30);
+    uint64_t kHigh = (stop - r) / 30;
+
+    for (uint64_t k = kLow; k <= kHigh; k += chunkSize)
+    {
+      Chunk chunk;
+      chunk.residue = r;
+      chunk.kLow = k;
+      chunk.kHigh = min(kHigh, k + chunkSize - 1);
+      plan.chunks.push_back(chunk);
+      if (kHigh - k < chunkSize)
+        break;
+    }
+  }
+
+  return plan;
+}
+
+/// Sieve the chunks in parallel and call f(chunk, p) for
+/// each p whose first length chain members are prime.
+/// Each chunk is sieved by a single thread.
+///
+template <typename F>
+void sieveChunks(const Plan& plan, int length, F&& f)
+{
+  auto& chunks = plan.chunks;
+  atomic<size_t> next(0);
+  int threads = (int) min<size_t>(get_num_threads(), chunks.size());
+
+  threadPool().run(threads, [&]()
+  {
+    for (size_t i = next++; i < chunks.size(); i = next++)
+    {
+      uint64_t r = chunks[i].residue;
+      sieve_sequence(chunks[i].kLow, chunks[i].kHigh, plan.maxPrime, chainRoots(r, length),
+        [&](uint64_t low, const uint64_t* bits, size_t size)
+      {
+        for (size_t j = 0; j < size; j += 64)
+        {
+          for (uint64_t word = bits[j / 64]; word; word &= word - 1)
+          {
+            uint64_t k = low + j + lowestBit(word);
+            f(i, 30 * k + r);
+          }
+        }
+      });
+    }
+  });
+}
+
+} // namespace
+
+namespace primesieve {
+
+uint64_t count_cunningham_chains(int length, uint64_t start, uint64_t stop)
+{
+  Plan plan = getPlan(length, start, stop);
+  atomic<uint64_t> count(plan.small.size());
+  sieveChunks(plan, length, [&](size_t, uint64_t) { count++; });
+  return count;
+}
+
+void generate_cunningham_chains(int length, uint64_t start, uint64_t stop, vector<uint64_t>* primes)
+{
+  if (!primes)
+    return;
+
+  Plan plan = getPlan(length, start, stop);
+  vector<vector<uint64_t>> found(plan.chunks.size());
+  sieveChunks(plan, length, [&](size_t chunk, uint64_t p) {
+    found[chunk].push_back(p);
+  });
+
+  // the chunks of the residue
+  // classes are interleaved
+  size_t offset = primes->size();
+  primes->insert(primes->end(), plan.small.begin(), plan.small.end());
+  for (auto& v : found)
+    primes->insert(primes->end(), v.begin(), v.end());
+
+  sort(primes->begin() + offset, primes->end());
+}
+
+uint64_t count_sophie_germain_primes(uint64_t start, uint64_t stop)
+{
+  return count_cunningham_chains(2, start, stop);
+}
+
+void generate_sophie_germain_primes(uint64_t start, uint64_t stop, vector<uint64_t>* primes)
+{
+  generate_cunningham_chains(2, start, stop, primes);
+}
+
+/// q is a safe prime if q = 2p + 1 with p a Sophie Germain prime
+uint64_t count_safe_primes(uint64_t start, uint64_t stop)
+{
+  if (start > stop || stop < 5)
+    return 0;
+
+  uint64_t pStart = start / 2;
+  uint64_t pStop = (stop - 1) / 2;
+  return count_cunningham_chains(2, pStart, pStop);
+}
+
+void generate_safe_primes(uint64_t start, uint64_t stop, vector<uint64_t>* primes)
+{
+  if (!primes || start > stop || stop < 5)
+    return;
+
+  uint64_t pStart = start / 2;
+  uint64_t pStop = (stop - 1) / 2;
+  size_t offset = primes->size();
+  generate_cunningham_chains(2, pStart, pStop, primes);
+
+  for (size_t i = offset; i < primes->size(); i++)
+    (*primes)[i] = (*primes)[i] * 2 + 1;
+}
+
+} // namespace
@@ -10,12 +10,17 @@
 ///
 
 #include <primesieve/config.hpp>
+#include <primesieve/Counters.hpp>
 #include <primesieve/Erat.hpp>
 #include <primesieve/EratSmall.hpp>
 #include <primesieve/EratMedium.hpp>
 #include <primesieve/EratBig.hpp>
+#include <primesieve/MemoryPool.hpp>
 #include <primesieve/PreSieve.hpp>
 #include <primesieve/pmath.hpp>
+#include <primesieve/SegmentCache.hpp>
+#include <primesieve/SieveStats.hpp>
+#include <primesieve/Tuning.hpp>
 #include <primesieve/primesieve_error.hpp>
 
 #include <stdint.h>
@@ -48,6 +53,61 @@ const array<byte_t, 37> unsetLarger =
   0xff, 0xff, 0xff, 0xff, 0xff
 };
 
+/// Bit of the numbers 30 * i + n, 0xff if n is
+/// divisible by 2, 3 or 5
+///
+const array<uint8_t, 37> bitIndex =
+{
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,    0,
+  0xff, 0xff, 0xff,    1, 0xff,    2, 0xff, 0xff,
+  0xff,    3, 0xff,    4, 0xff, 0xff, 0xff,    5,
+  0xff, 0xff, 0xff, 0xff, 0xff,    6, 0xff,    7,
+  0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+#if defined(PRIMESIEVE_COUNTERS)
+
+uint64_t countBits(const byte_t* sieve, uint64_t bytes)
+{
+  uint64_t bits = 0;
+  for (uint64_t i = 0; i < bytes; i++)
+    for (byte_t b = sieve[i]; b; b &= b - 1)
+      bits++;
+  return bits;
+}
+
+/// Adds the number of bits unset during
+/// its lifetime to counter
+///
+class BitsUnset
+{
+public:
+  BitsUnset(Counter counter, const byte_t* sieve, uint64_t bytes) :
+    counter_(counter),
+    sieve_(sieve),
+    bytes_(bytes),
+    bits_(countBits(sieve, bytes))
+  { }
+  ~BitsUnset()
+  {
+    addCounter(counter_, bits_ - countBits(sieve_, bytes_));
+  }
+private:
+  Counter counter_;
+  const byte_t* sieve_;
+  uint64_t bytes_;
+  uint64_t bits_;
+};
+
+#else
+
+struct BitsUnset
+{
+  BitsUnset(Counter, const byte_t*, uint64_t) { }
+};
+
+#endif
+
 } // namespace
 
 namespace primesieve {
@@ -106,28 +166,88 @@ void Erat::init(uint64_t start,
 
 void Erat::initSieve(uint64_t sieveSize)
 {
-  sieveSize_ = floorPow2(sieveSize);
-  sieveSize_ = inBetween(8, sieveSize_, 4096);
+  sieveSize_ = inBetween(8, sieveSize, config::MAX_SIEVE_SIZE);
   sieveSize_ *= 1024;
 
-  sieve_ = new byte_t[sieveSize_];
-  deleter_.reset(sieve_);
+  deleter_ = allocatePool<byte_t>(sieveSize_);
+  sieve_ = deleter_.get();
+}
+
+/// EratSmall crosses off in L1 sized blocks, EratMedium
+/// in L2 sized blocks and EratBig uses the whole segment.
+/// @return Largest sieving prime of EratSmall
+///
+uint64_t Erat::getMaxEratSmall(uint64_t stop, uint64_t sieveSize)
+{
+  uint64_t l1Size = EratSmall::getL1Size(sieveSize);
+  return (uint64_t) (l1Size * getTuning(stop).factorEratSmall);
+}
+
+/// Also used to estimate the memory usage
+/// of the ParallelSieve threads.
+/// @return Largest sieving prime of EratMedium
+///
+uint64_t Erat::getMaxEratMedium(uint64_t stop, uint64_t sieveSize)
+{
+  uint64_t l2Size = EratMedium::getL2Size(sieveSize);
+  return (uint64_t) (l2Size * getTuning(stop).factorEratMedium);
 }
 
 void Erat::initErat()
 {
   uint64_t sqrtStop = isqrt(stop_);
   uint64_t l1Size = EratSmall::getL1Size(sieveSize_);
-
-  maxEratSmall_  = (uint64_t) (l1Size * config::FACTOR_ERATSMALL);
-  maxEratMedium_ = (uint64_t) (sieveSize_ * config::FACTOR_ERATMEDIUM);
+  l1Size_ = l1Size;
+  uint64_t l2Size = EratMedium::getL2Size(sieveSize_);
+  maxEratSmall_ = getMaxEratSmall(stop_, sieveSize_);
+  maxEratMedium_ = getMaxEratMedium(stop_, sieveSize_);
+
+  // a sieving prime > stop_ - segmentLow_ has at most one
+  // multiple inside a single segment, EratBig would need
+  // O(pi(sqrt(stop))) bucket memory for these primes
+  sparseLimit_ = ~0ull;
+  sparseHits_.clear();
+  if (segmentHigh_ == stop_ &&
+      segmentLow_ > sqrtStop)
+    sparseLimit_ = max(maxEratMedium_, stop_ - segmentLow_);
 
   if (sqrtStop > maxPreSieve_)
     eratSmall_.init(stop_, l1Size, maxEratSmall_);
   if (sqrtStop > maxEratSmall_)
-    eratMedium_.init(stop_, sieveSize_, maxEratMedium_);
-  if (sqrtStop > maxEratMedium_)
-    eratBig_.init(stop_, sieveSize_, sqrtStop);
+    eratMedium_.init(stop_, l2Size, maxEratMedium_);
+  if (sqrtStop > maxEratMedium_ &&
+      sparseLimit_ > maxEratMedium_)
+    eratBig_.init(stop_, sieveSize_, min(sqrtStop, sparseLimit_));
+}
+
+/// Store the bit of the only multiple of prime inside
+/// [segmentLow_, stop_], it is crossed off after the
+/// segment has been pre-sieved. A multiple that is
+/// divisible by 2, 3 or 5 is not part of the sieve array.
+///
+void Erat::addSparsePrime(uint64_t prime)
+{
+  uint64_t rem = segmentLow_ % prime;
+  uint64_t dist = rem ? prime - rem : 0;
+
+  if (dist > stop_ - segmentLow_ || dist < 7)
+    return;
+
+  // segmentLow_ is a multiple of 30
+  uint64_t byte = (dist - 7) / 30;
+  uint64_t bit = bitIndex[dist - byte * 30];
+
+  if (bit != 0xff)
+    sparseHits_.push_back((uint32_t) (byte * 8 + bit));
+}
+
+/// Decrease the stop number whilst sieving, the
+/// new stop number must be > segmentLow_
+///
+void Erat::setStop(uint64_t stop)
+{
+  stop_ = min(stop_, stop);
+  segmentHigh_ = min(segmentHigh_, stop_);
 }
 
 bool Erat::hasNextSegment() const
@@ -142,15 +262,21 @@ uint64_t Erat::byteRemainder(uint64_t n)
   return n;
 }
 
-/// Pre-sieve multiples of small primes e.g. <= 19
+/// Pre-sieve multiples of small primes <= 31
 /// to speed up the sieve of Eratosthenes
 ///
-void Erat::preSieve()
+void Erat::preSieve(uint64_t offset, uint64_t bytes)
 {
-  preSieve_->copy(sieve_, sieveSize_, segmentLow_);
+  uint64_t low = segmentLow_ + offset * 30;
+
+  {
+    PhaseTimer timer(PHASE_PRE_SIEVE);
+    preSieve_->copy(&sieve_[offset], bytes, low);
+  }
 
   // unset bits < start
-  if (segmentLow_ <= start_)
+  if (offset == 0 &&
+      segmentLow_ <= start_)
   {
     if (start_ <= maxPreSieve_)
       sieve_[0] = 0xff;
@@ -159,39 +285,81 @@ void Erat::preSieve()
   }
 }
 
+/// The pre-sieved patterns are copied to the sieve array in
+/// L1 cache sized blocks, each block is crossed off by
+/// EratSmall right away whilst it is still in the L1 cache.
+/// Using a separate pass, the copy would write the whole
+/// segment to the L2 cache and EratSmall would read it
+/// back afterwards.
+///
 void Erat::crossOff()
 {
+  uint64_t blockSize = sieveSize_;
   if (eratSmall_.enabled())
-    eratSmall_.crossOff(sieve_, sieveSize_);
+    blockSize = l1Size_;
+
+  for (uint64_t i = 0; i < sieveSize_; i += blockSize)
+  {
+    uint64_t bytes = min(blockSize, sieveSize_ - i);
+    preSieve(i, bytes);
+    if (eratSmall_.enabled())
+    {
+      BitsUnset counter(COUNTER_BITS_UNSET_SMALL, &sieve_[i], bytes);
+      PhaseTimer timer(PHASE_ERAT_SMALL);
+      eratSmall_.crossOff(&sieve_[i], bytes);
+    }
+  }
+
   if (eratMedium_.enabled())
+  {
+    BitsUnset counter(COUNTER_BITS_UNSET_MEDIUM, sieve_, sieveSize_);
+    PhaseTimer timer(PHASE_ERAT_MEDIUM);
     eratMedium_.crossOff(sieve_, sieveSize_);
+  }
   if (eratBig_.enabled())
+  {
+    BitsUnset counter(COUNTER_BITS_UNSET_BIG, sieve_, sieveSize_);
+    PhaseTimer timer(PHASE_ERAT_BIG);
     eratBig_.crossOff(sieve_);
+  }
+  if (!sparseHits_.empty())
+  {
+    BitsUnset counter(COUNTER_BITS_UNSET_BIG, sieve_, sieveSize_);
+    PhaseTimer timer(PHASE_ERAT_BIG);
+    for (uint32_t i : sparseHits_)
+      sieve_[i >> 3] &= ~(1 << (i & 7));
+    sparseHits_.clear();
+  }
 }
 
 void Erat::sieveSegment()
 {
+  PRIMESIEVE_COUNT(COUNTER_SEGMENTS, 1);
+
   if (segmentHigh_ == stop_)
     sieveLastSegment();
   else
   {
-    preSieve();
     crossOff();
-
-    uint64_t dist = sieveSize_ * 30;
-    segmentLow_ = checkedAdd(segmentLow_, dist);
-    segmentHigh_ = checkedAdd(segmentHigh_, dist);
-    segmentHigh_ = min(segmentHigh_, stop_);
+    storeSegment();
+    nextSegment();
   }
 }
 
+void Erat::nextSegment()
+{
+  uint64_t dist = sieveSize_ * 30;
+  segmentLow_ = checkedAdd(segmentLow_, dist);
+  segmentHigh_ = checkedAdd(segmentHigh_, dist);
+  segmentHigh_ = min(segmentHigh_, stop_);
+}
+
 void Erat::sieveLastSegment()
 {
   uint64_t rem = byteRemainder(stop_);
   uint64_t dist = (stop_ - rem) - segmentLow_;
   sieveSize_ = dist / 30 + 1;
 
-  preSieve();
   crossOff();
 
   // unset bits > stop
@@ -202,7 +370,64 @@ void Erat::sieveLastSegment()
   bytes = (8 - bytes) % 8;
   fill_n(&sieve_[sieveSize_], bytes, 0);
 
+  storeSegment();
   segmentLow_ = stop_;
 }
 
+/// Used by the sieves whose segments are worth caching
+/// i.e. PrintPrimes and PrimeGenerator. Must be called
+/// before any sieving prime has been added.
+///
+void Erat::enableSegmentCache()
+{
+  SegmentCache& cache = segmentCache();
+
+  if (cache.enabled())
+  {
+    segmentCache_ = &cache;
+    consultCache_ = true;
+  }
+}
+
+void Erat::storeSegment()
+{
+  if (segmentCache_)
+  {
+    SegmentCache::Key key = { segmentLow_, segmentHigh_, max(start_, segmentLow_) };
+    segmentCache_->put(key, sieve_, sieveSize_);
+  }
+}
+
+/// Read the current segment from the cache instead of
+/// sieving it. The caller must not add the sieving primes
+/// of a cached segment. After the first miss the cache is
+/// not consulted anymore because the sieving primes are
+/// only correct if they have been added to the first
+/// segment that is actually sieved.
+///
+bool Erat::cachedSegment()
+{
+  if (!consultCache_)
+    return false;
+
+  SegmentCache::Key key = { segmentLow_, segmentHigh_, max(start_, segmentLow_) };
+  uint64_t sieveSize = 0;
+
+  if (!segmentCache_->get(key, sieve_, &sieveSize))
+  {
+    consultCache_ = false;
+    return false;
+  }
+
+  if (segmentHigh_ == stop_)
+  {
+    sieveSize_ = sieveSize;
+    segmentLow_ = stop_;
+  }
+  else
+    nextSegment();
+
+  return true;
+}
+
 } // namespace
@@ -13,7 +13,9 @@
 
 #include <primesieve/Bucket.hpp>
 #include <primesieve/config.hpp>
+#include <primesieve/Counters.hpp>
 #include <primesieve/EratBig.hpp>
+#include <primesieve/MemoryPool.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/primesieve_error.hpp>
 #include <primesieve/types.hpp>
@@ -22,11 +24,57 @@
 #include <stdint.h>
 #include <algorithm>
 #include <cassert>
+#include <limits>
 #include <memory>
+#include <new>
 #include <vector>
 
 using namespace std;
 
+namespace {
+
+/// Prefetch the cache line of ptr for writing
+inline void prefetch(const void* ptr)
+{
+#if defined(__GNUC__)
+  __builtin_prefetch(ptr, 1);
+#else
+  (void) ptr;
+#endif
+}
+
+/// Split multipleIndex into the segment of the multiple and
+/// the multipleIndex within that segment. If sieveSize is not
+/// a power of 2 we divide using the precomputed reciprocal,
+/// for multipleIndex < 2^32 the quotient is either exact
+/// or too large by 1.
+///
+template <bool POW2>
+inline uint64_t getSegment(uint64_t* multipleIndex,
+                           uint64_t sieveSize,
+                           uint64_t log2SieveSize,
+                           uint64_t reciprocal)
+{
+  if (POW2)
+  {
+    uint64_t segment = *multipleIndex >> log2SieveSize;
+    *multipleIndex &= sieveSize - 1;
+    return segment;
+  }
+  else
+  {
+    uint64_t segment = (*multipleIndex * reciprocal) >> 32;
+    uint64_t low = segment * sieveSize;
+    uint64_t tooLarge = low > *multipleIndex;
+    segment -= tooLarge;
+    low -= sieveSize & (0 - tooLarge);
+    *multipleIndex -= low;
+    return segment;
+  }
+}
+
+} // namespace
+
 namespace primesieve {
 
 /// @stop:      Upper bound for sieving
@@ -35,14 +83,11 @@ namespace primesieve {
 ///
 void EratBig::init(uint64_t stop, uint64_t sieveSize, uint64_t maxPrime)
 {
-  // '>> log2SieveSize' requires power of 2 sieveSize
-  if (!isPow2(sieveSize))
-    throw primesieve_error("EratBig: sieveSize is not a power of 2");
-
   enabled_ = true;
   maxPrime_ = maxPrime;
+  sieveSize_ = sieveSize;
   log2SieveSize_ = ilog2(sieveSize);
-  moduloSieveSize_ = sieveSize - 1;
+  reciprocal_ = ((1ull << 32) + sieveSize - 1) / sieveSize;
   stock_ = nullptr;
 
   Wheel::init(stop, sieveSize);
@@ -54,16 +99,43 @@ void EratBig::init(uint64_t sieveSize)
   uint64_t maxSievingPrime  = maxPrime_ / 30;
   uint64_t maxNextMultiple  = maxSievingPrime * getMaxFactor() + getMaxFactor();
   uint64_t maxMultipleIndex = sieveSize - 1 + maxNextMultiple;
-  uint64_t maxSegmentCount  = maxMultipleIndex >> log2SieveSize_;
-  uint64_t size = maxSegmentCount + 1;
+  uint64_t maxSegmentCount  = maxMultipleIndex / sieveSize;
+
+  // required by getSegment()
+  assert(maxMultipleIndex < (1ull << 32));
 
   // EratBig uses up to 1.6 GiB of memory
   uint64_t maxBytes = (1u << 30) * 2;
   memory_.reserve(maxBytes / config::BYTES_PER_ALLOC);
 
-  lists_.resize(size, nullptr);
-  for (uint64_t i = 0; i < size; i++)
-    pushBucket(i);
+  if (maxSegmentCount < config::MAX_BUCKET_LISTS)
+  {
+    // single level, one bucket list per segment
+    blockSegments_ = maxSegmentCount + 1;
+    blockLimit_ = numeric_limits<uint64_t>::max();
+  }
+  else
+  {
+    // the multipleIndex of the sieving primes in
+    // farLists_ is relative to the start of their
+    // block, hence blockSize <= 2^23
+    uint64_t maxBlockSize = SievingPrime::MAX_MULTIPLEINDEX + 1;
+    blockSegments_ = maxBlockSize / sieveSize;
+    blockSegments_ = inBetween(1, blockSegments_, 64);
+    blockSize_ = blockSegments_ * sieveSize;
+    log2BlockSize_ = ilog2(blockSize_);
+    blockReciprocal_ = ((1ull << 32) + blockSize_ - 1) / blockSize_;
+    blockLimit_ = blockSize_;
+    uint64_t maxBlockCount = maxMultipleIndex / blockSize_;
+    farLists_.resize(maxBlockCount + 1, nullptr);
+  }
+
+  lists_.resize(blockSegments_, nullptr);
+
+  for (Bucket*& list : lists_)
+    pushBucket(list);
+  for (Bucket*& list : farLists_)
+    pushBucket(list);
 }
 
 /// Add a new sieving prime to EratBig
@@ -71,31 +143,66 @@ void EratBig::storeSievingPrime(uint64_t prime, uint64_t multipleIndex, uint64_t
 {
   assert(prime <= maxPrime_);
   uint64_t sievingPrime = prime / 30;
-  uint64_t segment = multipleIndex >> log2SieveSize_;
-  multipleIndex &= moduloSieveSize_;
+  store<false>(sievingPrime, multipleIndex, wheelIndex);
+}
 
-  if (!lists_[segment]->store(sievingPrime, multipleIndex, wheelIndex))
-    pushBucket(segment);
+/// Move a sieving prime to the bucket list
+/// related to its next multiple
+///
+template <bool POW2>
+void EratBig::store(uint64_t sievingPrime, uint64_t multipleIndex, uint64_t wheelIndex)
+{
+  if (multipleIndex < blockLimit_)
+  {
+    uint64_t segment = getSegment<POW2>(&multipleIndex, sieveSize_, log2SieveSize_, reciprocal_);
+    Bucket*& list = lists_[segment];
+    if (!list->store(sievingPrime, multipleIndex, wheelIndex))
+      pushBucket(list);
+
+    // prefetch the next cache line of the bucket,
+    // 8 sieving primes per 64-byte cache line. Staging the
+    // sieving primes in per list write-combining lines that
+    // are copied to the buckets (with or without streaming
+    // stores) has been measured to be slower, the lists of
+    // the next segments are read back while still cached.
+    prefetch(list->end() + 8);
+  }
+  else
+  {
+    multipleIndex -= blockLimit_;
+    uint64_t block = getSegment<POW2>(&multipleIndex, blockSize_, log2BlockSize_, blockReciprocal_);
+    Bucket*& list = farLists_[block];
+    if (!list->store(sievingPrime, multipleIndex, wheelIndex))
+      pushBucket(list);
+
+    prefetch(list->end() + 8);
+  }
 }
 
-/// Add an empty bucket to the front of lists_[segment]
-void EratBig::pushBucket(uint64_t segment)
+/// Add an empty bucket to the front of list
+void EratBig::pushBucket(Bucket*& list)
 {
   // allocate new buckets
   if (!stock_)
   {
     int N = config::BYTES_PER_ALLOC / sizeof(Bucket);
-    memory_.emplace_back(unique_ptr<Bucket[]>(new Bucket[N]));
+    memory_.emplace_back(allocatePool<Bucket>(N));
     Bucket* bucket = memory_.back().get();
 
+    // the memory may be reused from a previous
+    // EratBig object, hence reset all buckets
+    for (int i = 0; i < N; i++)
+      new (&bucket[i]) Bucket();
     for (int i = 0; i < N - 1; i++)
       bucket[i].setNext(&bucket[i + 1]);
     bucket[N-1].setNext(nullptr);
     stock_ = bucket;
+    PRIMESIEVE_COUNT(COUNTER_BUCKETS_ALLOCATED_BIG, N);
   }
+  PRIMESIEVE_COUNT(COUNTER_BUCKETS_PUSHED_BIG, 1);
   Bucket* empty = stock_;
   stock_ = stock_->next();
-  moveBucket(*empty, lists_[segment]);
+  moveBucket(*empty, list);
 }
 
 void EratBig::moveBucket(Bucket& src, Bucket*& dest)
@@ -109,21 +216,66 @@ void EratBig::moveBucket(Bucket& src, Bucket*& dest)
 ///
 void EratBig::crossOff(byte_t* sieve)
 {
+  bool pow2 = isPow2(sieveSize_);
+
   while (lists_[0]->hasNext() || !lists_[0]->empty())
   {
     Bucket* bucket = lists_[0];
     lists_[0] = nullptr;
-    pushBucket(0);
+    pushBucket(lists_[0]);
     do {
-      crossOff(sieve, bucket->begin(), bucket->end());
+      if (pow2)
+        crossOff<true>(sieve, bucket->begin(), bucket->end());
+      else
+        crossOff<false>(sieve, bucket->begin(), bucket->end());
       Bucket* processed = bucket;
       bucket = bucket->next();
       processed->reset();
       moveBucket(*processed, stock_);
+      PRIMESIEVE_COUNT(COUNTER_BUCKETS_RECYCLED_BIG, 1);
     } while (bucket);
   }
 
   rotate(lists_.begin(), lists_.begin() + 1, lists_.end());
+
+  if (!farLists_.empty())
+  {
+    blockLimit_ -= sieveSize_;
+    if (!blockLimit_)
+      nextBlock();
+  }
+}
+
+/// The next block becomes the current block, move its
+/// sieving primes to the lists of their segments
+///
+void EratBig::nextBlock()
+{
+  Bucket* bucket = farLists_[0];
+  farLists_[0] = nullptr;
+  pushBucket(farLists_[0]);
+  rotate(farLists_.begin(), farLists_.begin() + 1, farLists_.end());
+  blockLimit_ = blockSize_;
+  bool pow2 = isPow2(sieveSize_);
+
+  do {
+    for (SievingPrime& prime : *bucket)
+    {
+      uint64_t multipleIndex = prime.getMultipleIndex();
+      uint64_t wheelIndex    = prime.getWheelIndex();
+      uint64_t sievingPrime  = prime.getSievingPrime();
+
+      if (pow2)
+        store<true>(sievingPrime, multipleIndex, wheelIndex);
+      else
+        store<false>(sievingPrime, multipleIndex, wheelIndex);
+    }
+    Bucket* processed = bucket;
+    bucket = bucket->next();
+    processed->reset();
+    moveBucket(*processed, stock_);
+    PRIMESIEVE_COUNT(COUNTER_BUCKETS_RECYCLED_BIG, 1);
+  } while (bucket);
 }
 
 /// Segmented sieve of Eratosthenes with wheel factorization
@@ -131,12 +283,9 @@ void EratBig::crossOff(byte_t* sieve)
 /// multiples per segment. Cross-off the next multiple of
 /// each sieving prime in the current bucket
 ///
+template <bool POW2>
 void EratBig::crossOff(byte_t* sieve, SievingPrime* primes, SievingPrime* end)
 {
-  Bucket** lists = &lists_[0];
-  uint64_t moduloSieveSize = moduloSieveSize_;
-  uint64_t log2SieveSize = log2SieveSize_;
-
   // 2 sieving primes are processed per loop iteration
   // to increase instruction level parallelism
   for (; primes + 2 <= end; primes += 2)
@@ -153,18 +302,10 @@ void EratBig::crossOff(byte_t* sieve, SievingPrime* primes, SievingPrime* end)
     unsetBit(sieve, sievingPrime0, &multipleIndex0, &wheelIndex0);
     unsetBit(sieve, sievingPrime1, &multipleIndex1, &wheelIndex1);
 
-    uint64_t segment0 = multipleIndex0 >> log2SieveSize;
-    uint64_t segment1 = multipleIndex1 >> log2SieveSize;
-
-    multipleIndex0 &= moduloSieveSize;
-    multipleIndex1 &= moduloSieveSize;
-
     // move the 2 sieving primes to the list related
     // to their next multiple
-    if (!lists[segment0]->store(sievingPrime0, multipleIndex0, wheelIndex0))
-      pushBucket(segment0);
-    if (!lists[segment1]->store(sievingPrime1, multipleIndex1, wheelIndex1))
-      pushBucket(segment1);
+    store<POW2>(sievingPrime0, multipleIndex0, wheelIndex0);
+    store<POW2>(sievingPrime1, multipleIndex1, wheelIndex1);
   }
 
   if (primes != end)
@@ -174,11 +315,7 @@ void EratBig::crossOff(byte_t* sieve, SievingPrime* primes, SievingPrime* end)
     uint64_t sievingPrime  = primes->getSievingPrime();
 
     unsetBit(sieve, sievingPrime, &multipleIndex, &wheelIndex);
-    uint64_t segment = multipleIndex >> log2SieveSize;
-    multipleIndex &= moduloSieveSize;
-
-    if (!lists[segment]->store(sievingPrime, multipleIndex, wheelIndex))
-      pushBucket(segment);
+    store<POW2>(sievingPrime, multipleIndex, wheelIndex);
   }
 }
 
@@ -1,7 +1,15 @@
 ///
 /// @file   EratMedium.cpp
 /// @brief  Segmented sieve of Eratosthenes optimized for
-///         medium sieving primes.
+///         medium sieving primes. EratMedium is similar to
+///         EratSmall except that the sieving primes are stored
+///         in 64 bucket lists, one per wheel index. After a
+///         sieving prime has been processed it is moved to the
+///         list of its next wheel index. In the next segment the
+///         sieving primes are processed list by list, hence the
+///         initial 'switch (wheelIndex)' of consecutive sieving
+///         primes jumps to the same case and is predicted
+///         correctly by the CPU.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -9,38 +17,52 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/bits.hpp>
 #include <primesieve/Bucket.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/Counters.hpp>
+#include <primesieve/CpuInfo.hpp>
 #include <primesieve/EratMedium.hpp>
+#include <primesieve/MemoryPool.hpp>
 #include <primesieve/primesieve_error.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/types.hpp>
 #include <primesieve/Wheel.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <cassert>
+#include <new>
 #include <vector>
 
+using namespace std;
+
 namespace primesieve {
 
-/// @stop:      Upper bound for sieving
-/// @sieveSize: Sieve size in bytes
-/// @maxPrime:  Sieving primes <= maxPrime
+/// @stop:     Upper bound for sieving
+/// @l2Size:   Block size in bytes
+/// @maxPrime: Sieving primes <= maxPrime
 ///
-void EratMedium::init(uint64_t stop, uint64_t sieveSize, uint64_t maxPrime)
+void EratMedium::init(uint64_t stop, uint64_t l2Size, uint64_t maxPrime)
 {
-  uint64_t maxSieveSize = 4096 << 10;
-
-  if (sieveSize > maxSieveSize)
-    throw primesieve_error("EratMedium: sieveSize > 4096 KiB");
-  if (maxPrime > sieveSize * 5)
-    throw primesieve_error("EratMedium: maxPrime > sieveSize * 5");
+  if (maxPrime > l2Size * 5)
+    throw primesieve_error("EratMedium: maxPrime > l2Size * 5");
 
   enabled_ = true;
   maxPrime_ = maxPrime;
-  Wheel::init(stop, sieveSize);
+  l2Size_ = l2Size;
+  stock_ = nullptr;
+  Wheel::init(stop, l2Size);
+
+  // whilst crossing off, the buckets of the current segment
+  // and the 64 new (partially filled) bucket lists are used
+  uint64_t buckets = primeCountApprox(maxPrime) / config::BUCKETSIZE;
+  uint64_t maxBuckets = config::BYTES_PER_ALLOC / sizeof(Bucket);
+  bucketsPerAlloc_ = min(buckets + lists_.size() * 2 + 1, maxBuckets);
 
-  size_t size = primeCountApprox(maxPrime);
-  primes_.reserve(size);
+  lists_.fill(nullptr);
+  for (uint64_t i = 0; i < lists_.size(); i++)
+    pushBucket(i);
 }
 
 /// Add a new sieving prime to EratMedium
@@ -48,67 +70,300 @@ void EratMedium::storeSievingPrime(uint64_t prime, uint64_t multipleIndex, uint6
 {
   assert(prime <= maxPrime_);
   uint64_t sievingPrime = prime / 30;
-  primes_.emplace_back(sievingPrime, multipleIndex, wheelIndex);
+
+  if (!lists_[wheelIndex]->store(sievingPrime, multipleIndex, wheelIndex))
+    pushBucket(wheelIndex);
 }
 
-/// Segmented sieve of Eratosthenes with wheel factorization
-/// optimized for medium sieving primes that have a
-/// few multiples per segment
+/// Add an empty bucket to the front of lists_[wheelIndex]
+void EratMedium::pushBucket(uint64_t wheelIndex)
+{
+  // allocate new buckets
+  if (!stock_)
+  {
+    uint64_t N = bucketsPerAlloc_;
+    memory_.emplace_back(allocatePool<Bucket>(N));
+    Bucket* bucket = memory_.back().get();
+
+    // the memory may be reused from a previous
+    // EratMedium object, hence reset all buckets
+    for (uint64_t i = 0; i < N; i++)
+      new (&bucket[i]) Bucket();
+    for (uint64_t i = 0; i < N - 1; i++)
+      bucket[i].setNext(&bucket[i + 1]);
+    bucket[N-1].setNext(nullptr);
+    stock_ = bucket;
+    PRIMESIEVE_COUNT(COUNTER_BUCKETS_ALLOCATED_MEDIUM, N);
+  }
+  PRIMESIEVE_COUNT(COUNTER_BUCKETS_PUSHED_MEDIUM, 1);
+  Bucket* empty = stock_;
+  stock_ = stock_->next();
+  moveBucket(*empty, lists_[wheelIndex]);
+}
+
+void EratMedium::moveBucket(Bucket& src, Bucket*& dest)
+{
+  src.setNext(dest);
+  dest = &src;
+}
+
+/// The segment (used by EratBig) may be larger than the
+/// L2 cache, EratMedium crosses off in L2 sized blocks
+///
+uint64_t EratMedium::getL2Size(uint64_t sieveSize)
+{
+  if (!cpuInfo.hasL2Cache() ||
+      !cpuInfo.hasPrivateL2Cache())
+    return sieveSize;
+
+  uint64_t size = cpuInfo.l2CacheSize();
+  uint64_t minSize = 32 << 10;
+  uint64_t maxSize = 4096 << 10;
+
+  size = inBetween(minSize, size, maxSize);
+
+  return min(size, sieveSize);
+}
+
+/// Cross-off the multiples of medium sieving
+/// primes from the sieve array
 ///
 void EratMedium::crossOff(byte_t* sieve, uint64_t sieveSize)
 {
-  size_t i = 0;
-  size_t size = primes_.size();
-  auto primes = primes_.data();
+  byte_t* sieveEnd = sieve + sieveSize;
 
-  // process 3 sieving primes per loop iteration to
-  // increase instruction level parallelism
-  for (; i < size - size % 3; i += 3)
+  while (sieve < sieveEnd)
   {
-    uint64_t multipleIndex0 = primes[i + 0].getMultipleIndex();
-    uint64_t wheelIndex0    = primes[i + 0].getWheelIndex();
-    uint64_t sievingPrime0  = primes[i + 0].getSievingPrime();
-    uint64_t multipleIndex1 = primes[i + 1].getMultipleIndex();
-    uint64_t wheelIndex1    = primes[i + 1].getWheelIndex();
-    uint64_t sievingPrime1  = primes[i + 1].getSievingPrime();
-    uint64_t multipleIndex2 = primes[i + 2].getMultipleIndex();
-    uint64_t wheelIndex2    = primes[i + 2].getWheelIndex();
-    uint64_t sievingPrime2  = primes[i + 2].getSievingPrime();
-
-    while (multipleIndex0 < sieveSize)
+    byte_t* start = sieve;
+    sieve += l2Size_;
+    sieve = min(sieve, sieveEnd);
+    crossOff(start, sieve);
+  }
+}
+
+/// Cross off the multiples within [sieve, sieveEnd[
+void EratMedium::crossOff(byte_t* sieve, byte_t* sieveEnd)
+{
+  // the sieving primes of the current segment are moved
+  // to the new lists_ (of their next wheel index) whilst
+  // crossing off their multiples
+  auto lists = lists_;
+  lists_.fill(nullptr);
+  for (uint64_t i = 0; i < lists_.size(); i++)
+    pushBucket(i);
+
+  for (Bucket* bucket : lists)
+  {
+    while (bucket)
     {
-      unsetBit(sieve, sievingPrime0, &multipleIndex0, &wheelIndex0);
-      if (multipleIndex1 >= sieveSize) break;
-      unsetBit(sieve, sievingPrime1, &multipleIndex1, &wheelIndex1);
-      if (multipleIndex2 >= sieveSize) break;
-      unsetBit(sieve, sievingPrime2, &multipleIndex2, &wheelIndex2);
+      crossOff(sieve, sieveEnd, bucket);
+      Bucket* processed = bucket;
+      bucket = bucket->next();
+      processed->reset();
+      moveBucket(*processed, stock_);
+      PRIMESIEVE_COUNT(COUNTER_BUCKETS_RECYCLED_MEDIUM, 1);
     }
+  }
+}
 
-    while (multipleIndex0 < sieveSize) unsetBit(sieve, sievingPrime0, &multipleIndex0, &wheelIndex0);
-    while (multipleIndex1 < sieveSize) unsetBit(sieve, sievingPrime1, &multipleIndex1, &wheelIndex1);
-    while (multipleIndex2 < sieveSize) unsetBit(sieve, sievingPrime2, &multipleIndex2, &wheelIndex2);
+/// Segmented sieve of Eratosthenes with wheel factorization
+/// optimized for medium sieving primes that have a few
+/// multiples per segment. This algorithm uses a hardcoded
+/// modulo 30 wheel that skips multiples of 2, 3 and 5.
+/// All sieving primes of a bucket have the same
+/// wheel index.
+///
+void EratMedium::crossOff(byte_t* sieve, byte_t* sieveEnd, Bucket* bucket)
+{
+  SievingPrime* prime = bucket->begin();
+  SievingPrime* end = bucket->end();
 
-    multipleIndex0 -= sieveSize;
-    multipleIndex1 -= sieveSize;
-    multipleIndex2 -= sieveSize;
+  for (; prime != end; prime++)
+  {
+    uint64_t sievingPrime  = prime->getSievingPrime();
+    uint64_t multipleIndex = prime->getMultipleIndex();
+    uint64_t wheelIndex    = prime->getWheelIndex();
 
-    primes[i + 0].set(multipleIndex0, wheelIndex0);
-    primes[i + 1].set(multipleIndex1, wheelIndex1);
-    primes[i + 2].set(multipleIndex2, wheelIndex2);
-  }
+    // pointer to the byte containing the first multiple
+    // of sievingPrime within the current segment
+    byte_t* p = &sieve[multipleIndex];
 
-  // process remaining sieving primes
-  for (; i < size; i++)
-  {
-    uint64_t multipleIndex = primes[i].getMultipleIndex();
-    uint64_t wheelIndex    = primes[i].getWheelIndex();
-    uint64_t sievingPrime  = primes[i].getSievingPrime();
+    switch (wheelIndex)
+    {
+      for (;;) // i*30 + 7
+      {
+        case 0:  if (p >= sieveEnd) { wheelIndex = 0; break; }
+                 *p &= BIT0; p += sievingPrime * 6 + 1;
+        case 1:  if (p >= sieveEnd) { wheelIndex = 1; break; }
+                 *p &= BIT4; p += sievingPrime * 4 + 1;
+        case 2:  if (p >= sieveEnd) { wheelIndex = 2; break; }
+                 *p &= BIT3; p += sievingPrime * 2 + 0;
+        case 3:  if (p >= sieveEnd) { wheelIndex = 3; break; }
+                 *p &= BIT7; p += sievingPrime * 4 + 1;
+        case 4:  if (p >= sieveEnd) { wheelIndex = 4; break; }
+                 *p &= BIT6; p += sievingPrime * 2 + 1;
+        case 5:  if (p >= sieveEnd) { wheelIndex = 5; break; }
+                 *p &= BIT2; p += sievingPrime * 4 + 1;
+        case 6:  if (p >= sieveEnd) { wheelIndex = 6; break; }
+                 *p &= BIT1; p += sievingPrime * 6 + 1;
+        case 7:  if (p >= sieveEnd) { wheelIndex = 7; break; }
+                 *p &= BIT5; p += sievingPrime * 2 + 1;
+      }
+      break;
+
+      for (;;) // i*30 + 11
+      {
+        case 8:  if (p >= sieveEnd) { wheelIndex = 8; break; }
+                 *p &= BIT1; p += sievingPrime * 6 + 2;
+        case 9:  if (p >= sieveEnd) { wheelIndex = 9; break; }
+                 *p &= BIT3; p += sievingPrime * 4 + 1;
+        case 10: if (p >= sieveEnd) { wheelIndex = 10; break; }
+                 *p &= BIT7; p += sievingPrime * 2 + 1;
+        case 11: if (p >= sieveEnd) { wheelIndex = 11; break; }
+                 *p &= BIT5; p += sievingPrime * 4 + 2;
+        case 12: if (p >= sieveEnd) { wheelIndex = 12; break; }
+                 *p &= BIT0; p += sievingPrime * 2 + 0;
+        case 13: if (p >= sieveEnd) { wheelIndex = 13; break; }
+                 *p &= BIT6; p += sievingPrime * 4 + 2;
+        case 14: if (p >= sieveEnd) { wheelIndex = 14; break; }
+                 *p &= BIT2; p += sievingPrime * 6 + 2;
+        case 15: if (p >= sieveEnd) { wheelIndex = 15; break; }
+                 *p &= BIT4; p += sievingPrime * 2 + 1;
+      }
+      break;
+
+      for (;;) // i*30 + 13
+      {
+        case 16: if (p >= sieveEnd) { wheelIndex = 16; break; }
+                 *p &= BIT2; p += sievingPrime * 6 + 2;
+        case 17: if (p >= sieveEnd) { wheelIndex = 17; break; }
+                 *p &= BIT7; p += sievingPrime * 4 + 2;
+        case 18: if (p >= sieveEnd) { wheelIndex = 18; break; }
+                 *p &= BIT5; p += sievingPrime * 2 + 1;
+        case 19: if (p >= sieveEnd) { wheelIndex = 19; break; }
+                 *p &= BIT4; p += sievingPrime * 4 + 2;
+        case 20: if (p >= sieveEnd) { wheelIndex = 20; break; }
+                 *p &= BIT1; p += sievingPrime * 2 + 1;
+        case 21: if (p >= sieveEnd) { wheelIndex = 21; break; }
+                 *p &= BIT0; p += sievingPrime * 4 + 1;
+        case 22: if (p >= sieveEnd) { wheelIndex = 22; break; }
+                 *p &= BIT6; p += sievingPrime * 6 + 3;
+        case 23: if (p >= sieveEnd) { wheelIndex = 23; break; }
+                 *p &= BIT3; p += sievingPrime * 2 + 1;
+      }
+      break;
 
-    while (multipleIndex < sieveSize)
-      unsetBit(sieve, sievingPrime, &multipleIndex, &wheelIndex);
+      for (;;) // i*30 + 17
+      {
+        case 24: if (p >= sieveEnd) { wheelIndex = 24; break; }
+                 *p &= BIT3; p += sievingPrime * 6 + 3;
+        case 25: if (p >= sieveEnd) { wheelIndex = 25; break; }
+                 *p &= BIT6; p += sievingPrime * 4 + 3;
+        case 26: if (p >= sieveEnd) { wheelIndex = 26; break; }
+                 *p &= BIT0; p += sievingPrime * 2 + 1;
+        case 27: if (p >= sieveEnd) { wheelIndex = 27; break; }
+                 *p &= BIT1; p += sievingPrime * 4 + 2;
+        case 28: if (p >= sieveEnd) { wheelIndex = 28; break; }
+                 *p &= BIT4; p += sievingPrime * 2 + 1;
+        case 29: if (p >= sieveEnd) { wheelIndex = 29; break; }
+                 *p &= BIT5; p += sievingPrime * 4 + 2;
+        case 30: if (p >= sieveEnd) { wheelIndex = 30; break; }
+                 *p &= BIT7; p += sievingPrime * 6 + 4;
+        case 31: if (p >= sieveEnd) { wheelIndex = 31; break; }
+                 *p &= BIT2; p += sievingPrime * 2 + 1;
+      }
+      break;
+
+      for (;;) // i*30 + 19
+      {
+        case 32: if (p >= sieveEnd) { wheelIndex = 32; break; }
+                 *p &= BIT4; p += sievingPrime * 6 + 4;
+        case 33: if (p >= sieveEnd) { wheelIndex = 33; break; }
+                 *p &= BIT2; p += sievingPrime * 4 + 2;
+        case 34: if (p >= sieveEnd) { wheelIndex = 34; break; }
+                 *p &= BIT6; p += sievingPrime * 2 + 2;
+        case 35: if (p >= sieveEnd) { wheelIndex = 35; break; }
+                 *p &= BIT0; p += sievingPrime * 4 + 2;
+        case 36: if (p >= sieveEnd) { wheelIndex = 36; break; }
+                 *p &= BIT5; p += sievingPrime * 2 + 1;
+        case 37: if (p >= sieveEnd) { wheelIndex = 37; break; }
+                 *p &= BIT7; p += sievingPrime * 4 + 3;
+        case 38: if (p >= sieveEnd) { wheelIndex = 38; break; }
+                 *p &= BIT3; p += sievingPrime * 6 + 4;
+        case 39: if (p >= sieveEnd) { wheelIndex = 39; break; }
+                 *p &= BIT1; p += sievingPrime * 2 + 1;
+      }
+      break;
+
+      for (;;) // i*30 + 23
+      {
+        case 40: if (p >= sieveEnd) { wheelIndex = 40; break; }
+                 *p &= BIT5; p += sievingPrime * 6 + 5;
+        case 41: if (p >= sieveEnd) { wheelIndex = 41; break; }
+                 *p &= BIT1; p += sievingPrime * 4 + 3;
+        case 42: if (p >= sieveEnd) { wheelIndex = 42; break; }
+                 *p &= BIT2; p += sievingPrime * 2 + 1;
+        case 43: if (p >= sieveEnd) { wheelIndex = 43; break; }
+                 *p &= BIT6; p += sievingPrime * 4 + 3;
+        case 44: if (p >= sieveEnd) { wheelIndex = 44; break; }
+                 *p &= BIT7; p += sievingPrime * 2 + 2;
+        case 45: if (p >= sieveEnd) { wheelIndex = 45; break; }
+                 *p &= BIT3; p += sievingPrime * 4 + 3;
+        case 46: if (p >= sieveEnd) { wheelIndex = 46; break; }
+                 *p &= BIT4; p += sievingPrime * 6 + 5;
+        case 47: if (p >= sieveEnd) { wheelIndex = 47; break; }
+                 *p &= BIT0; p += sievingPrime * 2 + 1;
+      }
+      break;
+
+      for (;;) // i*30 + 29
+      {
+        case 48: if (p >= sieveEnd) { wheelIndex = 48; break; }
+                 *p &= BIT6; p += sievingPrime * 6 + 6;
+        case 49: if (p >= sieveEnd) { wheelIndex = 49; break; }
+                 *p &= BIT5; p += sievingPrime * 4 + 4;
+        case 50: if (p >= sieveEnd) { wheelIndex = 50; break; }
+                 *p &= BIT4; p += sievingPrime * 2 + 2;
+        case 51: if (p >= sieveEnd) { wheelIndex = 51; break; }
+                 *p &= BIT3; p += sievingPrime * 4 + 4;
+        case 52: if (p >= sieveEnd) { wheelIndex = 52; break; }
+                 *p &= BIT2; p += sievingPrime * 2 + 2;
+        case 53: if (p >= sieveEnd) { wheelIndex = 53; break; }
+                 *p &= BIT1; p += sievingPrime * 4 + 4;
+        case 54: if (p >= sieveEnd) { wheelIndex = 54; break; }
+                 *p &= BIT0; p += sievingPrime * 6 + 5;
+        case 55: if (p >= sieveEnd) { wheelIndex = 55; break; }
+                 *p &= BIT7; p += sievingPrime * 2 + 2;
+      }
+      break;
+
+      for (;;) // i*30 + 31
+      {
+        case 56: if (p >= sieveEnd) { wheelIndex = 56; break; }
+                 *p &= BIT7; p += sievingPrime * 6 + 1;
+        case 57: if (p >= sieveEnd) { wheelIndex = 57; break; }
+                 *p &= BIT0; p += sievingPrime * 4 + 0;
+        case 58: if (p >= sieveEnd) { wheelIndex = 58; break; }
+                 *p &= BIT1; p += sievingPrime * 2 + 0;
+        case 59: if (p >= sieveEnd) { wheelIndex = 59; break; }
+                 *p &= BIT2; p += sievingPrime * 4 + 0;
+        case 60: if (p >= sieveEnd) { wheelIndex = 60; break; }
+                 *p &= BIT3; p += sievingPrime * 2 + 0;
+        case 61: if (p >= sieveEnd) { wheelIndex = 61; break; }
+                 *p &= BIT4; p += sievingPrime * 4 + 0;
+        case 62: if (p >= sieveEnd) { wheelIndex = 62; break; }
+                 *p &= BIT5; p += sievingPrime * 6 + 0;
+        case 63: if (p >= sieveEnd) { wheelIndex = 63; break; }
+                 *p &= BIT6; p += sievingPrime * 2 + 0;
+      }
+      break;
+    }
 
-    multipleIndex -= sieveSize;
-    primes[i].set(multipleIndex, wheelIndex);
+    // move the sieving prime to the list
+    // of its next wheel index
+    multipleIndex = (uint64_t) (p - sieveEnd);
+    if (!lists_[wheelIndex]->store(sievingPrime, multipleIndex, wheelIndex))
+      pushBucket(wheelIndex);
   }
 }
 
@@ -20,10 +20,185 @@
 
 #include <stdint.h>
 #include <algorithm>
+#include <array>
 #include <cassert>
+#include <cstring>
 #include <vector>
 
+#if defined(__GNUC__) && \
+   (defined(__x86_64__) || defined(__i386__))
+  #define STAMP_X86
+#elif defined(__GNUC__) && \
+      defined(__aarch64__)
+  #define STAMP_NEON
+#endif
+
 using namespace std;
+using namespace primesieve;
+
+namespace {
+
+const uint64_t wheelOffsets[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+
+/// Runs are rounded up to a multiple of the widest vector,
+/// hence each pattern is followed by VECTOR_SIZE extra bytes
+///
+const uint64_t VECTOR_SIZE = 64;
+
+/// Sieve array bytes of the multiples of a small prime, the
+/// pattern repeats every prime bytes. The buffer holds multiple
+/// periods so that each run of the kernel is long.
+///
+struct Pattern
+{
+  vector<byte_t> buffer;
+  uint64_t period = 0;
+
+  Pattern() { }
+
+  Pattern(uint64_t prime)
+  {
+    period = prime * ((4096 + prime - 1) / prime);
+    buffer.resize(period + VECTOR_SIZE);
+
+    for (uint64_t i = 0; i < buffer.size(); i++)
+    {
+      byte_t byte = 0xff;
+      for (int bit = 0; bit < 8; bit++)
+        if ((i * 30 + wheelOffsets[bit]) % prime == 0)
+          byte &= (byte_t) ~(1 << bit);
+      buffer[i] = byte;
+    }
+  }
+
+  uint64_t size() const { return period; }
+};
+
+/// Patterns of the primes < 64, initialized once
+const array<Pattern, 64>& patterns()
+{
+  static const array<Pattern, 64> patterns = []()
+  {
+    array<Pattern, 64> p;
+    for (uint64_t n = 7; n < p.size(); n += 2)
+    {
+      bool isPrime = true;
+      for (uint64_t d = 3; d * d <= n; d += 2)
+        if (n % d == 0)
+          isPrime = false;
+      if (isPrime)
+        p[n] = Pattern(n);
+    }
+    return p;
+  }();
+
+  return patterns;
+}
+
+/// sieve[i] &= patterns[0][i] & patterns[1][i] & ...
+/// V is the vector type, the compiler generates
+/// SSE2, AVX2, AVX-512 or NEON instructions depending
+/// on the target of the calling function.
+///
+template <typename V>
+#if defined(__GNUC__)
+  __attribute__((always_inline))
+#endif
+inline void stampBytes(byte_t* sieve,
+                       uint64_t bytes,
+                       const byte_t* const* patterns,
+                       size_t count)
+{
+  uint64_t i = 0;
+
+  for (; i + sizeof(V) <= bytes; i += sizeof(V))
+  {
+    V v;
+    memcpy(&v, &sieve[i], sizeof(V));
+    for (size_t j = 0; j < count; j++)
+    {
+      V t;
+      memcpy(&t, &patterns[j][i], sizeof(V));
+      v &= t;
+    }
+    memcpy(&sieve[i], &v, sizeof(V));
+  }
+
+  for (; i < bytes; i++)
+  {
+    byte_t b = sieve[i];
+    for (size_t j = 0; j < count; j++)
+      b &= patterns[j][i];
+    sieve[i] = b;
+  }
+}
+
+using StampFunc = void (*)(byte_t*, uint64_t, const byte_t* const*, size_t);
+
+void stampPortable(byte_t* sieve, uint64_t bytes, const byte_t* const* patterns, size_t count)
+{
+  stampBytes<uint64_t>(sieve, bytes, patterns, count);
+}
+
+#if defined(STAMP_X86)
+
+typedef byte_t v16 __attribute__((vector_size(16)));
+typedef byte_t v32 __attribute__((vector_size(32)));
+typedef byte_t v64 __attribute__((vector_size(64)));
+
+__attribute__((target("sse2")))
+void stampSSE2(byte_t* sieve, uint64_t bytes, const byte_t* const* patterns, size_t count)
+{
+  stampBytes<v16>(sieve, bytes, patterns, count);
+}
+
+__attribute__((target("avx2")))
+void stampAVX2(byte_t* sieve, uint64_t bytes, const byte_t* const* patterns, size_t count)
+{
+  stampBytes<v32>(sieve, bytes, patterns, count);
+}
+
+__attribute__((target("avx512f")))
+void stampAVX512(byte_t* sieve, uint64_t bytes, const byte_t* const* patterns, size_t count)
+{
+  stampBytes<v64>(sieve, bytes, patterns, count);
+}
+
+#endif
+
+#if defined(STAMP_NEON)
+
+typedef byte_t v16 __attribute__((vector_size(16)));
+
+/// NEON is part of the aarch64 base
+/// instruction set, no target needed
+///
+void stampNEON(byte_t* sieve, uint64_t bytes, const byte_t* const* patterns, size_t count)
+{
+  stampBytes<v16>(sieve, bytes, patterns, count);
+}
+
+#endif
+
+/// Choose the widest kernel supported by the CPU
+StampFunc getStampFunc()
+{
+#if defined(STAMP_X86)
+  if (cpuInfo.hasAVX512())
+    return stampAVX512;
+  if (cpuInfo.hasAVX2())
+    return stampAVX2;
+  if (cpuInfo.hasSSE2())
+    return stampSSE2;
+#elif defined(STAMP_NEON)
+  if (cpuInfo.hasNEON())
+    return stampNEON;
+#endif
+
+  return stampPortable;
+}
+
+} // namespace
 
 namespace primesieve {
 
@@ -63,6 +238,30 @@ uint64_t EratSmall::getL1Size(uint64_t sieveSize)
   return size;
 }
 
+/// The multiples of the primes < MAX_STAMP are removed using
+/// precomputed bit patterns, all other sieving primes use
+/// the modulo 30 wheel.
+///
+void EratSmall::addSievingPrime(uint64_t prime, uint64_t segmentLow)
+{
+  if (prime >= MAX_STAMP)
+  {
+    Wheel30_t::addSievingPrime(prime, segmentLow);
+    return;
+  }
+
+  assert(segmentLow % 30 == 0);
+  uint64_t phase = (segmentLow / 30) % prime;
+  uint64_t square = prime * prime;
+  uint64_t skip = 0;
+
+  // the prime itself must not be removed
+  if (square > segmentLow + 7)
+    skip = (square - segmentLow - 7) / 30;
+
+  stampPrimes_.push_back(StampPrime{prime, phase, skip});
+}
+
 /// Add a new sieving prime to EratSmall
 void EratSmall::storeSievingPrime(uint64_t prime, uint64_t multipleIndex, uint64_t wheelIndex)
 {
@@ -83,10 +282,74 @@ void EratSmall::crossOff(byte_t* sieve, uint64_t sieveSize)
     byte_t* start = sieve;
     sieve += l1Size_;
     sieve = min(sieve, sieveEnd);
+    stamp(start, sieve);
     crossOff(start, sieve);
   }
 }
 
+/// Remove the multiples of the primes < MAX_STAMP using a
+/// single pass over the sieve array. Each run ANDs the bit
+/// patterns of all primes until one of the patterns wraps.
+///
+void EratSmall::stamp(byte_t* sieve, byte_t* sieveEnd)
+{
+  if (stampPrimes_.empty())
+    return;
+
+  static const StampFunc stampFunc = getStampFunc();
+  auto& pats = patterns();
+  uint64_t size = (uint64_t) (sieveEnd - sieve);
+  array<StampPrime*, MAX_STAMP> active;
+  array<const byte_t*, MAX_STAMP> ptrs;
+  size_t count = 0;
+
+  for (auto& sp : stampPrimes_)
+  {
+    auto& pattern = pats[sp.prime];
+
+    if (sp.skip > 0)
+    {
+      // first L1 block after adding the prime
+      uint64_t skip = min(sp.skip, size);
+      for (uint64_t i = skip; i < size; i++)
+        sieve[i] &= pattern.buffer[(sp.phase + i) % pattern.size()];
+
+      sp.phase = (sp.phase + size) % pattern.size();
+      sp.skip -= skip;
+    }
+    else
+      active[count++] = &sp;
+  }
+
+  for (uint64_t i = 0; i < size;)
+  {
+    uint64_t bytes = size - i;
+
+    for (size_t j = 0; j < count; j++)
+    {
+      auto& pattern = pats[active[j]->prime];
+      bytes = min(bytes, pattern.size() - active[j]->phase);
+      ptrs[j] = &pattern.buffer[active[j]->phase];
+    }
+
+    // avoid the scalar tail of the kernel, the
+    // patterns are padded with VECTOR_SIZE bytes
+    bytes += (VECTOR_SIZE - bytes % VECTOR_SIZE) % VECTOR_SIZE;
+    bytes = min(bytes, size - i);
+
+    stampFunc(&sieve[i], bytes, ptrs.data(), count);
+    i += bytes;
+
+    for (size_t j = 0; j < count; j++)
+    {
+      auto& pattern = pats[active[j]->prime];
+      active[j]->phase += bytes;
+      if (active[j]->phase >= pattern.size())
+        active[j]->phase -= pattern.size();
+    }
+  }
+}
+
 /// Segmented sieve of Eratosthenes with wheel factorization
 /// optimized for small sieving primes that have many multiples
 /// per segment. This algorithm uses a hardcoded modulo 30
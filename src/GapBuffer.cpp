@@ -0,0 +1,136 @@
+///
+/// @file   GapBuffer.cpp
+/// @brief  Gap-compressed prime buffer of primesieve::iterator,
+///         used by prev_prime() if enabled using
+///         primesieve::set_iterator_compression().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/GapBuffer.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/PrimeGenerator.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+void GapBuffer::clear()
+{
+  gaps_.clear();
+  prime_ = 0;
+  count_ = 0;
+}
+
+/// Append the gaps of primes[0, size[ to gaps_
+void GapBuffer::add(const uint64_t* primes, size_t size)
+{
+  // up to 3 bytes per gap
+  size_t pos = gaps_.size();
+  gaps_.resize(pos + size * 3);
+  uint8_t* gaps = &gaps_[pos];
+  uint64_t prime = prime_;
+
+  for (size_t i = 0; i < size; i++)
+  {
+    // all gaps of odd primes are even
+    uint64_t half = (primes[i] - prime) / 2;
+    prime = primes[i];
+
+    if (half <= 0xff)
+      *gaps++ = (uint8_t) half;
+    else
+    {
+      // the max prime gap < 2^64 is about 1500
+      assert(half <= 0xffff);
+      gaps[0] = (uint8_t) half;
+      gaps[1] = (uint8_t) (half >> 8);
+      gaps[2] = 0;
+      gaps += 3;
+    }
+  }
+
+  gaps_.resize(gaps - gaps_.data());
+  prime_ = prime;
+  count_ += size;
+}
+
+void GapBuffer::fill(PrimeGenerator& primeGenerator,
+                     uint64_t start,
+                     uint64_t stop)
+{
+  clear();
+  gaps_.reserve(primeCountApprox(start, stop) + config::ITERATOR_BUFFER * 3);
+  vector<uint64_t> primes(config::ITERATOR_BUFFER);
+
+  while (true)
+  {
+    size_t size = 0;
+    primeGenerator.fill(primes, &size);
+    if (primeGenerator.finished())
+      break;
+    if (size == 0)
+      continue;
+
+    assert(primes[0] > 2);
+    const uint64_t* first = primes.data();
+
+    // the first prime is not stored as a gap
+    if (count_ == 0)
+    {
+      prime_ = *first++;
+      count_ = 1;
+      size--;
+    }
+
+    add(first, size);
+  }
+}
+
+bool GapBuffer::prevPrimes(vector<uint64_t>& primes)
+{
+  size_t size = min(count_, (size_t) config::ITERATOR_BUFFER);
+  if (size == 0)
+    return false;
+
+  primes.resize(size);
+  count_ -= size;
+  const uint8_t* gaps = gaps_.data() + gaps_.size();
+  uint64_t prime = prime_;
+  primes[size - 1] = prime;
+
+  // decode the gaps below the primes of this block
+  // too, the last one yields the next largest prime
+  size_t gapCount = size - (count_ == 0);
+
+  for (size_t i = 1; i <= gapCount; i++)
+  {
+    uint64_t half = *--gaps;
+    if (half == 0)
+    {
+      half = (uint64_t) gaps[-1] << 8;
+      half |= gaps[-2];
+      gaps -= 2;
+    }
+
+    prime -= half * 2;
+    if (i < size)
+      primes[size - 1 - i] = prime;
+  }
+
+  prime_ = prime;
+  gaps_.resize(gaps - gaps_.data());
+  return true;
+}
+
+} // namespace
@@ -0,0 +1,426 @@
+///
+/// @file   GpuSieve.cpp
+/// @brief  Segmented sieve of Eratosthenes on an OpenCL GPU. Each
+///         batch of GPU_BATCH_DISTANCE numbers is sieved in a bitmap
+///         of odd numbers in GPU memory:
+///
+///         1) crossOffLarge: one work item per sieving prime
+///            > segment span crosses off its multiples of the
+///            batch in global memory (like EratBig).
+///         2) countSegments: one work group per segment copies
+///            the segment to local memory, the work items cross
+///            off the multiples of the small sieving primes
+///            together (like EratSmall) and of the medium
+///            sieving primes one prime per work item (like
+///            EratMedium), then the unset bits are counted.
+///
+///         Only the per segment counts are copied back to the host.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/GpuSieve.hpp>
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <string>
+
+#if defined(PRIMESIEVE_OPENCL)
+
+#include <primesieve.hpp>
+#include <primesieve/pmath.hpp>
+
+#define CL_TARGET_OPENCL_VERSION 120
+
+#if defined(__APPLE__)
+  #include <OpenCL/opencl.h>
+#else
+  #include <CL/cl.h>
+#endif
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// OpenCL C 1.2, bit i of a segment represents
+/// the odd number segmentLow + 2 * i + 1
+///
+const char* kernelSource = R"(
+
+/// First odd multiple of p >= max(p * p, low + 1)
+ulong firstMultiple(ulong p, ulong low)
+{
+  ulong q = max(p * p, low + 1);
+  ulong m = (q + p - 1) / p * p;
+  return m + (~m & 1) * p;
+}
+
+__kernel void crossOffLarge(__global const uint* primes,
+                            uint first,
+                            uint last,
+                            ulong low,
+                            ulong high,
+                            __global uint* bitmap)
+{
+  uint j = first + (uint) get_global_id(0);
+  if (j >= last)
+    return;
+
+  ulong p = primes[j];
+
+  for (ulong n = firstMultiple(p, low); n < high; n += p * 2)
+  {
+    ulong bit = (n - low) >> 1;
+    atomic_or(&bitmap[bit >> 5], 1u << (bit & 31));
+  }
+}
+
+__kernel void countSegments(__global const uint* primes,
+                            uint smallPrimes,
+                            uint mediumPrimes,
+                            ulong low,
+                            ulong start,
+                            ulong stop,
+                            uint words,
+                            __global const uint* bitmap,
+                            __global uint* counts,
+                            __local uint* sieve)
+{
+  uint lid = (uint) get_local_id(0);
+  uint lsize = (uint) get_local_size(0);
+  uint group = (uint) get_group_id(0);
+  ulong segLow = low + (ulong) group * words * 64;
+  ulong segHigh = segLow + (ulong) words * 64;
+
+  for (uint i = lid; i < words; i += lsize)
+    sieve[i] = bitmap[(ulong) group * words + i];
+
+  barrier(CLK_LOCAL_MEM_FENCE);
+
+  // small primes have many multiples per segment
+  for (uint j = 0; j < smallPrimes; j++)
+  {
+    ulong p = primes[j];
+    ulong n = firstMultiple(p, segLow) + p * 2 * lid;
+
+    for (; n < segHigh; n += p * 2 * lsize)
+    {
+      uint bit = (uint) ((n - segLow) >> 1);
+      atomic_or(&sieve[bit >> 5], 1u << (bit & 31));
+    }
+  }
+
+  for (uint j = smallPrimes + lid; j < mediumPrimes; j += lsize)
+  {
+    ulong p = primes[j];
+
+    for (ulong n = firstMultiple(p, segLow); n < segHigh; n += p * 2)
+    {
+      uint bit = (uint) ((n - segLow) >> 1);
+      atomic_or(&sieve[bit >> 5], 1u << (bit & 31));
+    }
+  }
+
+  barrier(CLK_LOCAL_MEM_FENCE);
+  uint count = 0;
+
+  // count the unset bits of [start, stop]
+  for (uint i = lid; i < words; i += lsize)
+  {
+    uint w = ~sieve[i];
+    ulong n0 = segLow + (ulong) i * 64 + 1;
+
+    if (n0 < start)
+    {
+      ulong skip = (start - n0 + 1) / 2;
+      w = (skip >= 32) ? 0 : w & (~0u << skip);
+    }
+    if (n0 + 62 > stop)
+    {
+      ulong keep = (stop < n0) ? 0 : (stop - n0) / 2 + 1;
+      w = (keep == 0) ? 0 : w & (~0u >> (32 - keep));
+    }
+
+    count += popcount(w);
+  }
+
+  barrier(CLK_LOCAL_MEM_FENCE);
+  if (lid == 0)
+    sieve[0] = 0;
+  barrier(CLK_LOCAL_MEM_FENCE);
+  atomic_add(&sieve[0], count);
+  barrier(CLK_LOCAL_MEM_FENCE);
+
+  if (lid == 0)
+    counts[group] = sieve[0];
+}
+
+)";
+
+void check(cl_int err, const char* what)
+{
+  if (err != CL_SUCCESS)
+    throw primesieve::primesieve_error(string("OpenCL error ") + to_string(err) + " in " + what);
+}
+
+/// The OpenCL state is created once per process,
+/// the GPU is used by one computation at a time
+///
+struct Gpu
+{
+  cl_device_id device = nullptr;
+  cl_context context = nullptr;
+  cl_command_queue queue = nullptr;
+  cl_program program = nullptr;
+  cl_kernel crossOffLarge = nullptr;
+  cl_kernel countSegments = nullptr;
+  string name;
+  size_t groupSize = 256;
+  /// 32-bit words of a segment in local memory
+  cl_uint words = 4096;
+  mutex lock;
+
+  /// First GPU of any platform
+  bool init()
+  {
+    cl_uint platforms = 0;
+    if (clGetPlatformIDs(0, nullptr, &platforms) != CL_SUCCESS || !platforms)
+      return false;
+
+    vector<cl_platform_id> ids(platforms);
+    clGetPlatformIDs(platforms, ids.data(), nullptr);
+
+    for (auto id : ids)
+      if (clGetDeviceIDs(id, CL_DEVICE_TYPE_GPU, 1, &device, nullptr) == CL_SUCCESS)
+        break;
+      else
+        device = nullptr;
+
+    if (!device)
+      return false;
+
+    cl_int err;
+    context = clCreateContext(nullptr, 1, &device, nullptr, nullptr, &err);
+    check(err, "clCreateContext");
+    queue = clCreateCommandQueue(context, device, 0, &err);
+    check(err, "clCreateCommandQueue");
+    program = clCreateProgramWithSource(context, 1, &kernelSource, nullptr, &err);
+    check(err, "clCreateProgramWithSource");
+
+    if (clBuildProgram(program, 1, &device, "-cl-std=CL1.2", nullptr, nullptr) != CL_SUCCESS)
+    {
+      size_t size = 0;
+      clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, 0, nullptr, &size);
+      string log(size, '\0');
+      clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG, size, &log[0], nullptr);
+      throw primesieve::primesieve_error("OpenCL build failed: " + log);
+    }
+
+    crossOffLarge = clCreateKernel(program, "crossOffLarge", &err);
+    check(err, "clCreateKernel");
+    countSegments = clCreateKernel(program, "countSegments", &err);
+    check(err, "clCreateKernel");
+
+    char buffer[256] = { 0 };
+    clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(buffer) - 1, buffer, nullptr);
+    name = buffer;
+
+    size_t maxGroupSize = 0;
+    clGetKernelWorkGroupInfo(countSegments, device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(maxGroupSize), &maxGroupSize, nullptr);
+    if (maxGroupSize)
+      groupSize = primesieve::floorPow2(min(groupSize, maxGroupSize));
+
+    // 32 KiB segments if the GPU has >= 48 KiB local memory
+    cl_ulong localMem = 0;
+    clGetDeviceInfo(device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(localMem), &localMem, nullptr);
+    if (localMem >= (48 << 10))
+      words = 8192;
+
+    return true;
+  }
+};
+
+Gpu* gpu = nullptr;
+once_flag initialized;
+
+void initGpu()
+{
+  try
+  {
+    unique_ptr<Gpu> g(new Gpu);
+    if (g->init())
+      gpu = g.release();
+  }
+  catch (primesieve::primesieve_error&)
+  { }
+}
+
+/// Buffer released by the destructor
+struct Buffer
+{
+  cl_mem mem;
+
+  Buffer(cl_context context, cl_mem_flags flags, size_t size, void* host = nullptr)
+  {
+    cl_int err;
+    mem = clCreateBuffer(context, flags, size, host, &err);
+    check(err, "clCreateBuffer");
+  }
+
+  ~Buffer()
+  {
+    clReleaseMemObject(mem);
+  }
+};
+
+template <typename T>
+void setArg(cl_kernel kernel, cl_uint i, const T& value)
+{
+  check(clSetKernelArg(kernel, i, sizeof(T), &value), "clSetKernelArg");
+}
+
+} // namespace
+
+namespace primesieve {
+
+bool gpuAvailable()
+{
+  call_once(initialized, initGpu);
+  return gpu != nullptr;
+}
+
+string gpuName()
+{
+  return gpuAvailable() ? gpu->name : string();
+}
+
+uint64_t gpuCountPrimes(uint64_t start,
+                        uint64_t stop,
+                        const cancel_token* token)
+{
+  if (!gpuAvailable())
+    throw primesieve_error("no OpenCL GPU available");
+  if (stop > config::MAX_GPU_STOP)
+    throw primesieve_error("GPU sieving requires stop <= " + to_string(config::MAX_GPU_STOP));
+
+  uint64_t count = 0;
+  if (start <= 2 && stop >= 2)
+    count++;
+
+  // 1 is not crossed off
+  start = max(start, (uint64_t) 3);
+  if (start > stop)
+    return count;
+
+  lock_guard<mutex> lock(gpu->lock);
+
+  // odd sieving primes <= sqrt(stop)
+  vector<cl_uint> primes;
+  generate_primes(3, isqrt(stop), &primes);
+  // OpenCL buffers must not be empty,
+  // 9 > stop is not counted anyway
+  if (primes.empty())
+    primes.push_back(3);
+
+  uint64_t segmentDist = (uint64_t) gpu->words * 64;
+  uint64_t segments = config::GPU_BATCH_DISTANCE / segmentDist;
+  uint64_t batchDist = segments * segmentDist;
+  auto smallLimit = segmentDist / (gpu->groupSize * 2);
+  cl_uint numPrimes = (cl_uint) primes.size();
+  cl_uint smallPrimes = (cl_uint) (lower_bound(primes.begin(), primes.end(), smallLimit) - primes.begin());
+  cl_uint mediumPrimes = (cl_uint) (lower_bound(primes.begin(), primes.end(), segmentDist) - primes.begin());
+
+  Buffer primesBuf(gpu->context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, primes.size() * sizeof(cl_uint), primes.data());
+  Buffer bitmap(gpu->context, CL_MEM_READ_WRITE, batchDist / 16);
+  Buffer countsBuf(gpu->context, CL_MEM_WRITE_ONLY, segments * sizeof(cl_uint));
+  vector<cl_uint> counts(segments);
+  cl_uint zero = 0;
+
+  cl_ulong ustart = start;
+  cl_ulong ustop = stop;
+
+  for (uint64_t low = start & ~1ull; low <= stop; low += batchDist)
+  {
+    if (token && token->is_cancelled())
+      throw primesieve_cancelled();
+
+    cl_ulong ulow = low;
+    cl_ulong uhigh = low + batchDist;
+    uint64_t batchSegments = min(segments, (stop - low) / segmentDist + 1);
+
+    check(clEnqueueFillBuffer(gpu->queue, bitmap.mem, &zero, sizeof(zero), 0, batchDist / 16, 0, nullptr, nullptr), "clEnqueueFillBuffer");
+
+    if (mediumPrimes < numPrimes)
+    {
+      cl_kernel k = gpu->crossOffLarge;
+      setArg(k, 0, primesBuf.mem);
+      setArg(k, 1, mediumPrimes);
+      setArg(k, 2, numPrimes);
+      setArg(k, 3, ulow);
+      setArg(k, 4, uhigh);
+      setArg(k, 5, bitmap.mem);
+      size_t local = gpu->groupSize;
+      size_t global = (numPrimes - mediumPrimes + local - 1) / local * local;
+      check(clEnqueueNDRangeKernel(gpu->queue, k, 1, nullptr, &global, &local, 0, nullptr, nullptr), "crossOffLarge");
+    }
+
+    cl_kernel k = gpu->countSegments;
+    setArg(k, 0, primesBuf.mem);
+    setArg(k, 1, smallPrimes);
+    setArg(k, 2, mediumPrimes);
+    setArg(k, 3, ulow);
+    setArg(k, 4, ustart);
+    setArg(k, 5, ustop);
+    setArg(k, 6, gpu->words);
+    setArg(k, 7, bitmap.mem);
+    setArg(k, 8, countsBuf.mem);
+    check(clSetKernelArg(k, 9, gpu->words * sizeof(cl_uint), nullptr), "clSetKernelArg");
+    size_t local = gpu->groupSize;
+    size_t global = batchSegments * local;
+    check(clEnqueueNDRangeKernel(gpu->queue, k, 1, nullptr, &global, &local, 0, nullptr, nullptr), "countSegments");
+    check(clEnqueueReadBuffer(gpu->queue, countsBuf.mem, CL_TRUE, 0, batchSegments * sizeof(cl_uint), counts.data(), 0, nullptr, nullptr), "clEnqueueReadBuffer");
+
+    for (uint64_t i = 0; i < batchSegments; i++)
+      count += counts[i];
+
+    if (stop - low < batchDist)
+      break;
+  }
+
+  return count;
+}
+
+} // namespace
+
+#else
+
+namespace primesieve {
+
+bool gpuAvailable()
+{
+  return false;
+}
+
+std::string gpuName()
+{
+  return std::string();
+}
+
+uint64_t gpuCountPrimes(uint64_t, uint64_t, const cancel_token*)
+{
+  throw primesieve_error("primesieve has been built without OpenCL (cmake -DWITH_OPENCL=ON)");
+}
+
+} // namespace
+
+#endif
@@ -0,0 +1,122 @@
+///
+/// @file  IsPrime.cpp
+///        Primality tests used by primesieve::is_prime(). Numbers
+///        <= config::SMALL_PRIME_TABLE are looked up in the
+///        small_prime_table() which is built once, numbers <= the limit of the
+///        process-wide prime_table (if loaded) are looked up in
+///        the prime_table. Larger numbers are tested using
+///        Miller-Rabin, except in batches where many numbers are
+///        close to each other: such runs are sieved using
+///        primesieve::iterator which is faster than testing each
+///        number individually.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/IsPrime.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/iterator.hpp>
+#include <primesieve/MillerRabin.hpp>
+#include <primesieve/prime_table.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Sieve the sorted numbers[idx[a]], ..., numbers[idx[b - 1]]
+void sieveRun(const uint64_t* numbers,
+              const size_t* idx,
+              size_t a,
+              size_t b,
+              bool* results)
+{
+  uint64_t low = numbers[idx[a]];
+  uint64_t high = numbers[idx[b - 1]];
+  primesieve::iterator it(low - 1, high);
+  uint64_t prime = it.next_prime();
+
+  for (size_t i = a; i < b; i++)
+  {
+    uint64_t n = numbers[idx[i]];
+    while (prime < n)
+      prime = it.next_prime();
+
+    // next_prime() returns UINT64_MAX after the
+    // largest 64-bit prime, which is not a prime
+    results[idx[i]] = (prime == n && ~n != 0);
+  }
+}
+
+} // namespace
+
+namespace primesieve {
+
+bool isPrimeCached(uint64_t n)
+{
+  if (n <= config::SMALL_PRIME_TABLE)
+    return small_prime_table().is_prime(n);
+
+  auto table = get_prime_table();
+  if (table && n <= table->limit())
+    return table->is_prime(n);
+
+  return isPrime(n);
+}
+
+void isPrimeBatch(const uint64_t* numbers,
+                  size_t size,
+                  bool* results)
+{
+  vector<size_t> idx;
+  auto table = get_prime_table();
+  const prime_table& smallTable = small_prime_table();
+
+  for (size_t i = 0; i < size; i++)
+  {
+    if (numbers[i] <= config::SMALL_PRIME_TABLE)
+      results[i] = smallTable.is_prime(numbers[i]);
+    else if (table && numbers[i] <= table->limit())
+      results[i] = table->is_prime(numbers[i]);
+    else
+      idx.push_back(i);
+  }
+
+  if (idx.size() < config::MIN_IS_PRIME_SIEVE)
+  {
+    for (size_t i : idx)
+      results[i] = isPrime(numbers[i]);
+    return;
+  }
+
+  sort(idx.begin(), idx.end(), [&](size_t i, size_t j) {
+    return numbers[i] < numbers[j];
+  });
+
+  // split the sorted numbers into runs
+  // of numbers close to each other
+  for (size_t a = 0, b = 0; a < idx.size(); a = b)
+  {
+    for (b = a + 1; b < idx.size(); b++)
+      if (numbers[idx[b]] - numbers[idx[b - 1]] > config::IS_PRIME_GAP)
+        break;
+
+    if (b - a >= config::MIN_IS_PRIME_SIEVE)
+      sieveRun(numbers, idx.data(), a, b, results);
+    else
+    {
+      for (size_t i = a; i < b; i++)
+        results[idx[i]] = isPrime(numbers[idx[i]]);
+    }
+  }
+}
+
+} // namespace
@@ -12,11 +12,15 @@
 #include <primesieve/config.hpp>
 #include <primesieve/IteratorHelper.hpp>
 #include <primesieve/pmath.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/types.hpp>
+#include <primesieve.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <cmath>
 #include <limits>
+#include <memory>
 
 using namespace std;
 using namespace primesieve;
@@ -30,22 +34,27 @@ uint64_t getNextDist(uint64_t n, uint64_t dist)
   x = sqrt(x) / log(log(x));
 
   uint64_t minDist = (uint64_t) x;
-  uint64_t limit = numeric_limits<uint64_t>::max() / 4;
+  uint64_t growth = get_iterator_growth();
+  uint64_t limit = numeric_limits<uint64_t>::max() / growth;
   dist = max(dist, minDist);
 
   if (dist < limit)
-    dist *= 4;
+    dist *= growth;
 
   return dist;
 }
 
+/// The primes of [start, stop] are stored in the iterator's
+/// buffer, the buffer size is about dist / log(x) * 8 bytes
+/// which must not exceed get_iterator_memory_limit().
+///
 uint64_t getPrevDist(uint64_t n, uint64_t* dist)
 {
   double x = (double) n;
   x = max(x, 10.0);
 
   double minDist = config::MIN_CACHE_ITERATOR;
-  double maxDist = config::MAX_CACHE_ITERATOR;
+  double maxDist = (double) get_iterator_memory_limit();
   double logx = log(x);
 
   minDist *= logx;
@@ -53,11 +62,12 @@ uint64_t getPrevDist(uint64_t n, uint64_t* dist)
 
   minDist /= sizeof(uint64_t);
   maxDist /= sizeof(uint64_t);
+  minDist = min(minDist, maxDist);
 
   if (*dist < minDist)
   {
     minDist = (double) *dist;
-    *dist *= 4;
+    *dist *= get_iterator_growth();
   }
 
   double defaultDist = sqrt(x) * 2;
@@ -112,4 +122,40 @@ void IteratorHelper::prev(uint64_t* start,
     *start = checkedSub(stopHint, maxPrimeGap(stopHint));
 }
 
+/// The sieving primes <= sqrt(stop) are sieved into a
+/// SievingTable which is kept by the iterator and reused by
+/// all subsequent PrimeGenerators. Hence prev_prime() and
+/// skipto() to a lower (or nearby) region need not re-sieve
+/// the sieving primes. If stop grows the table is rebuilt
+/// with at least twice its size. Small sieving primes are
+/// cheap to re-sieve and are not cached. The bitmap of the
+/// process-wide prime_table is used if it is large enough.
+///
+void IteratorHelper::updateSievingTable(uint64_t stop,
+                                        shared_ptr<const SievingTable>& table)
+{
+  uint64_t sqrtStop = isqrt(stop);
+
+  if (sqrtStop < config::MIN_SIEVING_TABLE)
+    return;
+
+  auto shared = getSharedSievingTable(sqrtStop);
+  if (shared)
+  {
+    table = shared;
+    return;
+  }
+
+  if (!table ||
+      table->getStop() < sqrtStop)
+  {
+    uint64_t limit = sqrtStop;
+    uint64_t maxLimit = isqrt(numeric_limits<uint64_t>::max());
+    if (table)
+      limit = max(limit, table->getStop() * 2);
+    limit = min(limit, maxLimit);
+    table = make_shared<SievingTable>(limit, 1, get_sieve_size());
+  }
+}
+
 } // namespace
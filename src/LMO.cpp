@@ -0,0 +1,536 @@
+///
+/// @file   LMO.cpp
+/// @brief  Lagarias-Miller-Odlyzko prime counting algorithm:
+///
+///         pi(x) = S1 + S2 + pi(y) - 1 - P2
+///
+///         with y = alpha * x^(1/3) and a = pi(y). S1 are the
+///         ordinary leaves (n <= y), S2 the special leaves
+///         phi(x / (p_(b+1) * m), b) of Legendre's partial sieve
+///         function and P2 the numbers <= x with exactly two
+///         prime factors > y.
+///
+///         The special leaves of the primes p <= sqrt(x / y) are
+///         computed using a segmented sieve of the numbers
+///         <= x / y. The segments are split into chunks that are
+///         sieved in parallel, each chunk counts the unsieved
+///         numbers from 0 and the missing offsets are added
+///         after all chunks have been sieved. The special leaves
+///         of the larger primes are phi(n, b) = pi(n) - b + 1
+///         with n < y, they are computed using a pi(n) lookup
+///         table.
+///
+///         All sums are computed modulo 2^64, the result is
+///         correct since pi(x) < 2^64.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/LMO.hpp>
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/iterator.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Each counter counts the unsieved
+/// numbers of 16 words (2048 numbers)
+const uint64_t COUNTER_WORDS = 16;
+
+struct Tables
+{
+  /// Möbius function
+  vector<int8_t> mu;
+  /// Least prime factor, lpf[1] = UINT32_MAX
+  vector<uint32_t> lpf;
+  /// pi[n] = number of primes <= n
+  vector<uint32_t> pi;
+  /// primes[1] = 2, primes[2] = 3, ...
+  vector<uint32_t> primes;
+};
+
+/// Special leaves of a chunk, the phi(n, b) values
+/// are relative to the chunk low
+///
+struct Chunk
+{
+  uint64_t sum = 0;
+  /// Number of unsieved numbers after
+  /// removing the first b primes
+  vector<uint64_t> phi;
+  /// Sum of -mu(m) of the special leaves
+  vector<int64_t> leaves;
+};
+
+void checkCancelled(const cancel_token* token)
+{
+  if (token && token->is_cancelled())
+    throw primesieve_cancelled();
+}
+
+uint64_t iroot3(uint64_t x)
+{
+  uint64_t r = (uint64_t) cbrt((double) x);
+  // cbrt(2^64 - 1) = 2642245.9
+  r = min(r, (uint64_t) 2642245);
+
+  while (r * r * r > x)
+    r--;
+  while (r < 2642245 && (r + 1) * (r + 1) * (r + 1) <= x)
+    r++;
+
+  return r;
+}
+
+/// y = alpha * x^(1/3), a larger alpha reduces the
+/// sieving distance x / y but increases the number
+/// of special leaves
+///
+uint64_t getY(uint64_t x)
+{
+  double logx = log((double) max(x, (uint64_t) 10));
+  double alpha = max(1.0, logx * logx / 200);
+  uint64_t y = (uint64_t) (iroot3(x) * alpha);
+  uint64_t sqrtx = isqrt(x);
+
+  // the tables use about 10 bytes per number <= y
+  y = min(y, config::MAX_LMO_Y);
+  y = max(y, iroot3(x));
+
+  return min(y, sqrtx);
+}
+
+Tables getTables(uint64_t y)
+{
+  Tables t;
+  t.mu.resize(y + 1, 1);
+  t.lpf.resize(y + 1, 0);
+  t.pi.resize(y + 1, 0);
+  t.primes.push_back(0);
+
+  for (uint64_t i = 2; i <= y; i++)
+  {
+    if (t.lpf[i] == 0)
+    {
+      t.primes.push_back((uint32_t) i);
+      for (uint64_t j = i; j <= y; j += i)
+        if (t.lpf[j] == 0)
+          t.lpf[j] = (uint32_t) i;
+    }
+  }
+
+  if (y >= 1)
+    t.lpf[1] = ~0u;
+
+  for (uint64_t i = 2; i <= y; i++)
+  {
+    uint64_t p = t.lpf[i];
+    uint64_t n = i / p;
+    t.mu[i] = (n % p == 0) ? 0 : (int8_t) -t.mu[n];
+    t.pi[i] = t.pi[i - 1] + (p == i);
+  }
+
+  return t;
+}
+
+/// Ordinary leaves: sum mu(n) * (x / n) for n <= y
+uint64_t S1(uint64_t x, uint64_t y, const Tables& t)
+{
+  uint64_t sum = 0;
+
+  for (uint64_t n = 1; n <= y; n++)
+  {
+    if (t.mu[n] > 0)
+      sum += x / n;
+    if (t.mu[n] < 0)
+      sum -= x / n;
+  }
+
+  return sum;
+}
+
+/// Special leaves of p = 2: phi(x / (2 * m), 0) = x / (2 * m)
+uint64_t S2_two(uint64_t x, uint64_t y, const Tables& t)
+{
+  uint64_t sum = 0;
+
+  for (uint64_t m = y / 2 + 1; m <= y; m++)
+  {
+    if (t.mu[m] && t.lpf[m] > 2)
+    {
+      if (t.mu[m] > 0)
+        sum -= x / (2 * m);
+      else
+        sum += x / (2 * m);
+    }
+  }
+
+  return sum;
+}
+
+/// Special leaves of the primes p_(b+1) > sqrt(z), these are
+/// p * m with m prime and m > p. n = x / (p * m) < y hence
+/// phi(n, b) = pi(n) - b + 1, or 1 if n < p.
+///
+uint64_t S2_easy(uint64_t x,
+                 uint64_t y,
+                 uint64_t firstIndex,
+                 const Tables& t,
+                 int threads,
+                 const cancel_token* token)
+{
+  uint64_t lastIndex = t.pi[y];
+  uint64_t sum = 0;
+  mutex lock;
+  atomic<uint64_t> next(firstIndex);
+
+  threadPool().run(threads, [&]() {
+    uint64_t localSum = 0;
+    for (uint64_t i; (i = next.fetch_add(64)) <= lastIndex;)
+    {
+      checkCancelled(token);
+      for (uint64_t j = i; j < i + 64 && j <= lastIndex; j++)
+      {
+        uint64_t p = t.primes[j];
+        uint64_t xp = x / p;
+        uint64_t maxM = min(xp / p, y);
+
+        // leaves with n < p, phi(n, b) = 1
+        if (maxM > p)
+          localSum += t.pi[y] - t.pi[maxM];
+        else
+        {
+          localSum += t.pi[y] - t.pi[p];
+          continue;
+        }
+
+        for (uint64_t k = t.pi[maxM]; k > j; k--)
+        {
+          uint64_t n = xp / t.primes[k];
+          localSum += t.pi[n] - (j - 1) + 1;
+        }
+      }
+    }
+
+    lock_guard<mutex> guard(lock);
+    sum += localSum;
+  });
+
+  return sum;
+}
+
+/// Sieve the numbers of [low, high[ and compute the special
+/// leaves of the primes <= primes[B]. The sieve stores the
+/// odd numbers, the multiples of 2 are removed implicitly.
+///
+void sieveChunk(uint64_t x,
+                uint64_t y,
+                uint64_t low,
+                uint64_t high,
+                uint64_t segmentSize,
+                uint64_t B,
+                const Tables& t,
+                Chunk& chunk,
+                const cancel_token* token)
+{
+  chunk.phi.assign(B, 0);
+  chunk.leaves.assign(B, 0);
+
+  uint64_t words = segmentSize / 128;
+  vector<uint64_t> sieve(words);
+  vector<uint64_t> counters(ceilDiv(words, COUNTER_WORDS));
+  vector<uint64_t> multiples(B + 1);
+  uint64_t sqrty = isqrt(y);
+
+  // first odd multiple >= low of each sieving prime
+  for (uint64_t b = 2; b <= B; b++)
+  {
+    uint64_t p = t.primes[b];
+    uint64_t q = max(p, ceilDiv(low, p) * p);
+    q += p * (~q & 1);
+    multiples[b] = q;
+  }
+
+  for (uint64_t segLow = low; segLow < high; segLow += segmentSize)
+  {
+    checkCancelled(token);
+    uint64_t segHigh = min(segLow + segmentSize, high);
+    uint64_t bits = (segHigh - segLow) / 2;
+
+    // set the bits of the odd numbers < segHigh
+    fill(sieve.begin(), sieve.end(), 0);
+    fill(sieve.begin(), sieve.begin() + bits / 64, ~0ull);
+    if (bits % 64)
+      sieve[bits / 64] = (1ull << (bits % 64)) - 1;
+
+    for (uint64_t i = 0; i < counters.size(); i++)
+    {
+      uint64_t first = i * COUNTER_WORDS;
+      uint64_t size = min(COUNTER_WORDS, words - first);
+      counters[i] = popcount(&sieve[first], size);
+    }
+
+    uint64_t total = bits;
+
+    // here the multiples of the first b primes are removed
+    for (uint64_t b = 1; b < B; b++)
+    {
+      uint64_t p = t.primes[b + 1];
+      uint64_t xp = x / p;
+      uint64_t minM = max(y / p, xp / segHigh);
+      uint64_t maxM = (segLow > 0) ? min(y, xp / segLow) : y;
+      uint64_t counter = 0;
+      uint64_t count = 0;
+
+      // number of unsieved numbers <= n
+      auto countTo = [&](uint64_t n)
+      {
+        if (n <= segLow)
+          return (uint64_t) 0;
+        uint64_t k = (n - segLow - 1) / 2;
+        uint64_t word = k / 64;
+        uint64_t c = word / COUNTER_WORDS;
+        for (; counter < c; counter++)
+          count += counters[counter];
+        uint64_t first = c * COUNTER_WORDS;
+        uint64_t last = sieve[word] & (~0ull >> (63 - k % 64));
+        return count + popcount(&sieve[first], word - first) + popcount(&last, 1);
+      };
+
+      // n = x / (p * m) increases as m decreases
+      if (p <= sqrty)
+      {
+        for (uint64_t m = maxM; m > minM; m--)
+        {
+          if (t.mu[m] && t.lpf[m] > p)
+          {
+            uint64_t phi = chunk.phi[b] + countTo(xp / m);
+            if (t.mu[m] > 0)
+            {
+              chunk.sum -= phi;
+              chunk.leaves[b]--;
+            }
+            else
+            {
+              chunk.sum += phi;
+              chunk.leaves[b]++;
+            }
+          }
+        }
+      }
+      else
+      {
+        // m is a prime > p
+        minM = max(minM, p);
+        for (uint64_t i = t.pi[maxM]; maxM > minM && i > t.pi[minM]; i--)
+        {
+          chunk.sum += chunk.phi[b] + countTo(xp / t.primes[i]);
+          chunk.leaves[b]++;
+        }
+      }
+
+      chunk.phi[b] += total;
+
+      // remove the multiples of p
+      uint64_t q = multiples[b + 1];
+      for (; q < segHigh; q += p * 2)
+      {
+        uint64_t k = (q - segLow) / 2;
+        uint64_t bit = (sieve[k / 64] >> (k % 64)) & 1;
+        sieve[k / 64] &= ~(1ull << (k % 64));
+        counters[k / (64 * COUNTER_WORDS)] -= bit;
+        total -= bit;
+      }
+      multiples[b + 1] = q;
+    }
+  }
+}
+
+/// Special leaves of the primes <= sqrt(z), z = x / y
+uint64_t S2_sieve(uint64_t x,
+                  uint64_t y,
+                  uint64_t z,
+                  uint64_t B,
+                  const Tables& t,
+                  int threads,
+                  const cancel_token* token)
+{
+  if (B < 2)
+    return 0;
+
+  uint64_t segmentSize = max(isqrt(z), (uint64_t) 1 << 16);
+  segmentSize = inBetween((uint64_t) 1 << 16, floorPow2(segmentSize) * 2, (uint64_t) 1 << 22);
+  uint64_t segments = ceilDiv(z + 1, segmentSize);
+  uint64_t chunkSegments = ceilDiv(segments, (uint64_t) threads * 8);
+  uint64_t chunkSize = chunkSegments * segmentSize;
+  uint64_t chunks = ceilDiv(z + 1, chunkSize);
+
+  vector<Chunk> results(chunks);
+  atomic<uint64_t> next(0);
+
+  threadPool().run(threads, [&]() {
+    for (uint64_t i; (i = next++) < chunks;)
+    {
+      uint64_t low = i * chunkSize;
+      uint64_t high = min(low + chunkSize, z + 1);
+      sieveChunk(x, y, low, high, segmentSize, B, t, results[i], token);
+    }
+  });
+
+  uint64_t sum = 0;
+  vector<uint64_t> phi(B, 0);
+
+  for (auto& chunk : results)
+  {
+    sum += chunk.sum;
+    for (uint64_t b = 1; b < B; b++)
+    {
+      sum += phi[b] * (uint64_t) chunk.leaves[b];
+      phi[b] += chunk.phi[b];
+    }
+  }
+
+  return sum;
+}
+
+/// P2 = sum (pi(x / p) - pi(p) + 1) for y < p <= sqrt(x).
+/// The primes p are split into parts, each part counts the
+/// primes <= x / p relative to the end of the previous part.
+///
+uint64_t P2(uint64_t x,
+            uint64_t y,
+            uint64_t a,
+            int threads,
+            const cancel_token* token)
+{
+  uint64_t sqrtx = isqrt(x);
+  if (y >= sqrtx)
+    return 0;
+
+  vector<uint64_t> primes;
+  primesieve::iterator it(y, sqrtx);
+  for (uint64_t p = it.next_prime(); p <= sqrtx; p = it.next_prime())
+    primes.push_back(p);
+
+  uint64_t size = primes.size();
+  if (size == 0)
+    return 0;
+
+  // parts[j] = first index (descending) of part j
+  uint64_t parts = min(size, (uint64_t) threads * 8);
+  vector<uint64_t> bounds(parts + 1);
+  uint64_t lowX = x / primes[size - 1];
+  uint64_t highX = x / primes[0];
+
+  for (uint64_t j = 0; j <= parts; j++)
+  {
+    uint64_t v = lowX + (highX - lowX) / parts * j;
+    // number of primes with x / p <= v
+    auto iter = upper_bound(primes.begin(), primes.end(), v, [&](uint64_t n, uint64_t p) { return x / p <= n; });
+    bounds[j] = primes.end() - iter;
+  }
+  bounds[0] = 0;
+  bounds[parts] = size;
+
+  vector<uint64_t> sums(parts, 0);
+  vector<uint64_t> counts(parts, 0);
+  vector<uint64_t> lows(parts + 1, 0);
+  lows[0] = lowX - 1;
+  for (uint64_t j = 1; j <= parts; j++)
+    lows[j] = (bounds[j] > 0) ? x / primes[size - bounds[j]] : lows[0];
+
+  atomic<uint64_t> next(0);
+
+  threadPool().run(threads, [&]() {
+    for (uint64_t j; (j = next++) < parts;)
+    {
+      checkCancelled(token);
+      uint64_t low = lows[j];
+      uint64_t high = lows[j + 1];
+      if (bounds[j] >= bounds[j + 1])
+        continue;
+
+      primesieve::iterator iter(low, high);
+      uint64_t prime = iter.next_prime();
+      uint64_t count = 0;
+
+      for (uint64_t k = bounds[j]; k < bounds[j + 1]; k++)
+      {
+        uint64_t v = x / primes[size - 1 - k];
+        for (; prime <= v; prime = iter.next_prime())
+          count++;
+        sums[j] += count;
+      }
+
+      counts[j] = count;
+    }
+  });
+
+  PrimeSieve ps;
+  uint64_t pix = ps.countPrimes(0, lows[0]);
+  uint64_t sum = 0;
+
+  for (uint64_t j = 0; j < parts; j++)
+  {
+    sum += sums[j] + pix * (bounds[j + 1] - bounds[j]);
+    pix += counts[j];
+  }
+
+  // subtract sum (pi(p) - 1) with pi(primes[i]) = a + i + 1
+  sum -= size * a + size * (size - 1) / 2;
+
+  return sum;
+}
+
+} // namespace
+
+namespace primesieve {
+
+uint64_t piLMO(uint64_t x, int threads, const cancel_token* token)
+{
+  // the algorithm requires y >= 2 primes,
+  // sieving is faster for small x anyway
+  if (x < 100000)
+  {
+    PrimeSieve ps;
+    return ps.countPrimes(0, x);
+  }
+
+  checkCancelled(token);
+  threads = max(threads, 1);
+  uint64_t y = getY(x);
+  uint64_t z = x / y;
+  Tables t = getTables(y);
+  uint64_t a = t.pi[y];
+  uint64_t B = t.pi[isqrt(z)];
+
+  uint64_t sum = S1(x, y, t);
+  sum += S2_two(x, y, t);
+  sum += S2_sieve(x, y, z, B, t, threads, token);
+  sum += S2_easy(x, y, max(B, (uint64_t) 1) + 1, t, threads, token);
+  sum += a - 1;
+  sum -= P2(x, y, a, threads, token);
+
+  return sum;
+}
+
+} // namespace
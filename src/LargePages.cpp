@@ -0,0 +1,168 @@
+///
+/// @file   LargePages.cpp
+/// @brief  Allocate large memory blocks backed by huge pages.
+///         On Linux we first try reserved huge pages (MAP_HUGETLB)
+///         and then transparent huge pages (madvise). On Windows
+///         we try large pages (MEM_LARGE_PAGES) which requires the
+///         "Lock pages in memory" privilege. On other operating
+///         systems and if huge pages are not available we use
+///         normal pages.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/LargePages.hpp>
+
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+#elif defined(_WIN32)
+  #include <windows.h>
+#endif
+
+using namespace std;
+
+namespace {
+
+size_t roundUp(size_t bytes, size_t pageSize)
+{
+  return (bytes + pageSize - 1) / pageSize * pageSize;
+}
+
+#if defined(__linux__) && \
+    defined(MAP_ANONYMOUS)
+
+void* mapPages(size_t bytes, primesieve::PageType* type)
+{
+  using namespace primesieve;
+  size_t size = roundUp(bytes, HUGE_PAGE_SIZE);
+  int prot = PROT_READ | PROT_WRITE;
+  int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+#if defined(MAP_HUGETLB)
+  void* ptr = mmap(nullptr, size, prot, flags | MAP_HUGETLB, -1, 0);
+  if (ptr != MAP_FAILED)
+  {
+    *type = HUGE_PAGES;
+    return ptr;
+  }
+#endif
+
+  // transparent huge pages must be aligned to
+  // HUGE_PAGE_SIZE, hence we map an extra huge
+  // page and unmap the unaligned head and tail
+  size_t mapSize = size + HUGE_PAGE_SIZE;
+  void* raw = mmap(nullptr, mapSize, prot, flags, -1, 0);
+  if (raw == MAP_FAILED)
+    throw bad_alloc();
+
+  uintptr_t addr = (uintptr_t) raw;
+  uintptr_t aligned = roundUp((size_t) addr, HUGE_PAGE_SIZE);
+  size_t head = aligned - addr;
+  size_t tail = mapSize - head - size;
+
+  if (head)
+    munmap(raw, head);
+  if (tail)
+    munmap((void*) (aligned + size), tail);
+
+  *type = NORMAL_PAGES;
+
+#if defined(MADV_HUGEPAGE)
+  if (madvise((void*) aligned, size, MADV_HUGEPAGE) == 0)
+    *type = TRANSPARENT_HUGE_PAGES;
+#endif
+
+  return (void*) aligned;
+}
+
+void unmapPages(void* ptr, size_t bytes)
+{
+  munmap(ptr, roundUp(bytes, primesieve::HUGE_PAGE_SIZE));
+}
+
+#elif defined(_WIN32)
+
+void* mapPages(size_t bytes, primesieve::PageType* type)
+{
+  using namespace primesieve;
+  size_t largePage = GetLargePageMinimum();
+
+  if (largePage)
+  {
+    void* ptr = VirtualAlloc(nullptr, roundUp(bytes, largePage),
+                             MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES,
+                             PAGE_READWRITE);
+    if (ptr)
+    {
+      *type = HUGE_PAGES;
+      return ptr;
+    }
+  }
+
+  void* ptr = VirtualAlloc(nullptr, bytes, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+  if (!ptr)
+    throw bad_alloc();
+
+  *type = NORMAL_PAGES;
+  return ptr;
+}
+
+void unmapPages(void* ptr, size_t)
+{
+  VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+#else
+
+void* mapPages(size_t bytes, primesieve::PageType* type)
+{
+  *type = primesieve::NORMAL_PAGES;
+  return ::operator new(bytes);
+}
+
+void unmapPages(void* ptr, size_t)
+{
+  ::operator delete(ptr);
+}
+
+#endif
+
+} // namespace
+
+namespace primesieve {
+
+void* allocatePages(size_t bytes, PageType* type)
+{
+  PageType pages = NORMAL_PAGES;
+  void* ptr;
+
+  if (bytes < HUGE_PAGE_SIZE)
+    ptr = ::operator new(bytes);
+  else
+    ptr = mapPages(bytes, &pages);
+
+  if (type)
+    *type = pages;
+
+  return ptr;
+}
+
+void freePages(void* ptr, size_t bytes)
+{
+  if (!ptr)
+    return;
+
+  if (bytes < HUGE_PAGE_SIZE)
+    ::operator delete(ptr);
+  else
+    unmapPages(ptr, bytes);
+}
+
+} // namespace
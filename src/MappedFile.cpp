@@ -0,0 +1,129 @@
+///
+/// @file   MappedFile.cpp
+/// @brief  Memory map a file using mmap() on Unix-like systems,
+///         on other systems the file is read into memory and
+///         writable files are written back by sync().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/MappedFile.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+  #define HAS_MMAP
+#endif
+
+using namespace std;
+
+namespace primesieve {
+
+MappedFile::MappedFile(const string& filename)
+{
+#if defined(HAS_MMAP)
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd == -1)
+    throw primesieve_error("failed to open " + filename);
+
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0)
+  {
+    void* data = mmap(nullptr, (size_t) st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      data_ = (unsigned char*) data;
+      size_ = (size_t) st.st_size;
+      mapped_ = true;
+    }
+  }
+
+  close(fd);
+  if (mapped_)
+    return;
+#endif
+
+  ifstream file(filename, ios::binary);
+  if (!file)
+    throw primesieve_error("failed to open " + filename);
+
+  buffer_.assign(istreambuf_iterator<char>(file), istreambuf_iterator<char>());
+  data_ = buffer_.data();
+  size_ = buffer_.size();
+}
+
+MappedFile::MappedFile(const string& filename, size_t size) :
+  size_(size),
+  writable_(true),
+  filename_(filename)
+{
+#if defined(HAS_MMAP)
+  int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd == -1)
+    throw primesieve_error("failed to create " + filename);
+
+  if (ftruncate(fd, (off_t) size) != 0)
+  {
+    close(fd);
+    throw primesieve_error("failed to resize " + filename);
+  }
+
+  if (size > 0)
+  {
+    void* data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (data != MAP_FAILED)
+    {
+      data_ = (unsigned char*) data;
+      mapped_ = true;
+    }
+  }
+
+  close(fd);
+  if (mapped_ || size == 0)
+    return;
+#endif
+
+  buffer_.resize(size);
+  data_ = buffer_.data();
+}
+
+void MappedFile::sync()
+{
+  if (!writable_)
+    return;
+
+#if defined(HAS_MMAP)
+  if (mapped_)
+  {
+    if (msync(data_, size_, MS_SYNC) != 0)
+      throw primesieve_error("failed to write " + filename_);
+    return;
+  }
+#endif
+
+  ofstream file(filename_, ios::binary | ios::trunc);
+  file.write((const char*) data_, size_);
+  if (!file)
+    throw primesieve_error("failed to write " + filename_);
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(HAS_MMAP)
+  if (mapped_)
+    munmap(data_, size_);
+#endif
+}
+
+} // namespace
@@ -0,0 +1,182 @@
+///
+/// @file   MemoryPool.cpp
+/// @brief  Thread-local cache of large memory blocks. The blocks
+///         freed by a thread are kept (up to MAX_CACHE_POOL bytes
+///         or the memory limit) and are reused by the next
+///         allocation of the same size. This avoids malloc and
+///         page fault churn when a thread sieves many chunks one
+///         after another. Large blocks are backed by huge pages
+///         (see LargePages.cpp). The pools are registered so that
+///         release_memory() can free the cached memory of all
+///         threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/MemoryPool.hpp>
+#include <primesieve/LargePages.hpp>
+#include <primesieve/config.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <set>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Trivially destructible, hence it can
+/// still be read after the pool is destroyed
+///
+thread_local bool poolDestroyed = false;
+
+struct Registry
+{
+  mutex lock;
+  set<primesieve::MemoryPool*> pools;
+};
+
+/// Never destroyed, the ThreadPool threads
+/// may exit after the static destructors
+///
+Registry& registry()
+{
+  static Registry* registry = new Registry;
+  return *registry;
+}
+
+/// Each thread caches at most MAX_CACHE_POOL bytes
+/// and never more than the memory limit
+///
+uint64_t maxCachedBytes()
+{
+  uint64_t maxCached = primesieve::config::MAX_CACHE_POOL;
+  uint64_t limit = primesieve::get_memory_limit();
+  if (limit)
+    maxCached = min(maxCached, limit);
+  return maxCached;
+}
+
+} // namespace
+
+namespace primesieve {
+
+MemoryPool::MemoryPool()
+{
+  Registry& r = registry();
+  lock_guard<mutex> lock(r.lock);
+  r.pools.insert(this);
+}
+
+MemoryPool::~MemoryPool()
+{
+  {
+    Registry& r = registry();
+    lock_guard<mutex> lock(r.lock);
+    r.pools.erase(this);
+  }
+
+  release();
+  poolDestroyed = true;
+}
+
+void* MemoryPool::allocate(size_t bytes)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  // most recently freed blocks are at the back
+  for (size_t i = blocks_.size(); i-- > 0;)
+  {
+    if (blocks_[i].bytes == bytes)
+    {
+      void* ptr = blocks_[i].ptr;
+      blocks_.erase(blocks_.begin() + i);
+      cached_ -= bytes;
+      return ptr;
+    }
+  }
+
+  return allocatePages(bytes);
+}
+
+void MemoryPool::deallocate(void* ptr, size_t bytes)
+{
+  if (!ptr)
+    return;
+
+  lock_guard<mutex> lock(mutex_);
+
+  if (cached_ + bytes > maxCachedBytes())
+  {
+    freePages(ptr, bytes);
+    return;
+  }
+
+  blocks_.push_back(Block{ptr, bytes});
+  cached_ += bytes;
+}
+
+void MemoryPool::release()
+{
+  lock_guard<mutex> lock(mutex_);
+
+  for (Block& block : blocks_)
+    freePages(block.ptr, block.bytes);
+
+  blocks_.clear();
+  cached_ = 0;
+}
+
+size_t MemoryPool::getCachedBytes() const
+{
+  lock_guard<mutex> lock(mutex_);
+  return cached_;
+}
+
+void MemoryPool::releaseAll()
+{
+  Registry& r = registry();
+  lock_guard<mutex> lock(r.lock);
+
+  for (MemoryPool* pool : r.pools)
+    pool->release();
+}
+
+MemoryPool* memoryPool()
+{
+  if (poolDestroyed)
+    return nullptr;
+
+  thread_local MemoryPool pool;
+  return &pool;
+}
+
+void* poolAllocate(size_t bytes)
+{
+  MemoryPool* pool = memoryPool();
+
+  if (pool)
+    return pool->allocate(bytes);
+  else
+    return allocatePages(bytes);
+}
+
+void poolDeallocate(void* ptr, size_t bytes)
+{
+  MemoryPool* pool = memoryPool();
+
+  if (pool)
+    pool->deallocate(ptr, bytes);
+  else
+    freePages(ptr, bytes);
+}
+
+} // namespace
@@ -0,0 +1,142 @@
+///
+/// @file  MillerRabin.cpp
+///        Deterministic Miller-Rabin primality test for 64-bit
+///        numbers using the 7 bases found by Jim Sinclair.
+///        The candidates are first checked for small prime
+///        factors, this removes most composites cheaply.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/MillerRabin.hpp>
+
+#include <stdint.h>
+#include <array>
+#include <cstddef>
+
+using namespace std;
+
+namespace {
+
+const array<uint64_t, 15> smallPrimes =
+{
+  2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47
+};
+
+/// Miller-Rabin bases, correct for n < 2^64
+const array<uint64_t, 7> bases =
+{
+  2, 325, 9375, 28178, 450775, 9780504, 1795265022
+};
+
+uint64_t mulMod(uint64_t a, uint64_t b, uint64_t m)
+{
+#if defined(__SIZEOF_INT128__)
+  return (uint64_t) (((unsigned __int128) a * b) % m);
+#else
+  uint64_t res = 0;
+  a %= m;
+
+  for (; b > 0; b >>= 1)
+  {
+    if (b & 1)
+      res = (res >= m - a) ? res - (m - a) : res + a;
+    a = (a >= m - a) ? a - (m - a) : a + a;
+  }
+
+  return res;
+#endif
+}
+
+uint64_t powMod(uint64_t base, uint64_t exp, uint64_t m)
+{
+  uint64_t res = 1;
+  base %= m;
+
+  for (; exp > 0; exp >>= 1)
+  {
+    if (exp & 1)
+      res = mulMod(res, base, m);
+    base = mulMod(base, base, m);
+  }
+
+  return res;
+}
+
+/// @pre n odd && n > 47
+bool isStrongProbablePrime(uint64_t n, uint64_t d, int s, uint64_t base)
+{
+  base %= n;
+  if (base == 0)
+    return true;
+
+  uint64_t x = powMod(base, d, n);
+  if (x == 1 || x == n - 1)
+    return true;
+
+  for (int r = 1; r < s; r++)
+  {
+    x = mulMod(x, x, n);
+    if (x == n - 1)
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace
+
+namespace primesieve {
+
+bool isPrime(uint64_t n)
+{
+  for (uint64_t p : smallPrimes)
+  {
+    if (n % p == 0)
+      return n == p;
+  }
+
+  if (n < 53 * 53)
+    return n > 1;
+
+  uint64_t d = n - 1;
+  int s = 0;
+
+  for (; d % 2 == 0; s++)
+    d /= 2;
+
+  for (uint64_t base : bases)
+    if (!isStrongProbablePrime(n, d, s, base))
+      return false;
+
+  return true;
+}
+
+void nextPrimes(uint64_t start, uint64_t* primes, size_t n)
+{
+  const uint64_t maxPrime = 18446744073709551557ull;
+  size_t i = 0;
+
+  for (; i < n && start < 2; i++, start = 2)
+    primes[i] = 2;
+
+  // iterate over the odd numbers > start
+  uint64_t x = start + 1 + (start & 1);
+
+  for (; i < n && start < maxPrime; x += 2)
+  {
+    if (isPrime(x))
+    {
+      primes[i++] = x;
+      start = x;
+    }
+  }
+
+  for (; i < n; i++)
+    primes[i] = ~0ull;
+}
+
+} // namespace
@@ -0,0 +1,168 @@
+///
+/// @file   OutputSink.cpp
+/// @brief  Buffered writer of the printed primes to a file
+///         descriptor. The stdout stream std::cout synchronizes
+///         with stdio and copies the primes through the stdout
+///         buffer, OutputSink writes page aligned buffers of
+///         config::OUTPUT_BUFFER bytes directly to the file
+///         descriptor using write().
+///
+///         vmsplice() is not used for pipes: a reader that moves
+///         the pages onward using splice() (e.g. pv) still
+///         references our buffer after it has left our pipe,
+///         refilling the buffer would corrupt the output.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/OutputSink.hpp>
+#include <primesieve/config.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <unistd.h>
+  #define HAS_OUTPUT_SINK
+#endif
+
+using namespace std;
+
+namespace {
+
+/// std::cout's stream buffer before main(), if the user
+/// redirects std::cout the printed primes must follow
+ios_base::Init iosInit;
+streambuf* const coutBuffer = cout.rdbuf();
+
+const size_t pageSize = 4096;
+
+} // namespace
+
+namespace primesieve {
+
+OutputSink::OutputSink(int fd) :
+  fd_(fd),
+  memory_(config::OUTPUT_BUFFER + pageSize)
+{
+  uintptr_t addr = (uintptr_t) memory_.data();
+  uintptr_t aligned = (addr + pageSize - 1) & ~(pageSize - 1);
+  buffer_ = memory_.data() + (aligned - addr);
+}
+
+OutputSink::~OutputSink()
+{
+  sync();
+}
+
+OutputSink::int_type OutputSink::overflow(int_type c)
+{
+  if (traits_type::eq_int_type(c, traits_type::eof()))
+    return traits_type::not_eof(c);
+
+  char ch = traits_type::to_char_type(c);
+  if (xsputn(&ch, 1) != 1)
+    return traits_type::eof();
+
+  return c;
+}
+
+streamsize OutputSink::xsputn(const char* data, streamsize size)
+{
+  lock_guard<mutex> lock(mutex_);
+  size_t n = (size_t) size;
+
+  // large writes to files are not copied
+  if (pos_ == 0 && n >= config::OUTPUT_BUFFER / 2)
+    return writeAll(data, n) ? size : 0;
+
+  while (n > 0)
+  {
+    size_t bytes = min(n, config::OUTPUT_BUFFER - pos_);
+    memcpy(&buffer_[pos_], data, bytes);
+    pos_ += bytes;
+    data += bytes;
+    n -= bytes;
+
+    if (pos_ == config::OUTPUT_BUFFER &&
+        !flushBuffer())
+      return 0;
+  }
+
+  return size;
+}
+
+int OutputSink::sync()
+{
+  lock_guard<mutex> lock(mutex_);
+  return flushBuffer() ? 0 : -1;
+}
+
+bool OutputSink::flushBuffer()
+{
+  if (pos_ == 0)
+    return true;
+
+  // text printed using std::cout or printf()
+  // before the primes comes first
+  if (fd_ == 1)
+  {
+    cout.flush();
+    fflush(stdout);
+  }
+
+  size_t size = pos_;
+  pos_ = 0;
+
+  return writeAll(buffer_, size);
+}
+
+bool OutputSink::writeAll(const char* data, size_t size)
+{
+#if defined(HAS_OUTPUT_SINK)
+  while (size > 0)
+  {
+    ssize_t bytes = ::write(fd_, data, size);
+    if (bytes < 0)
+    {
+      if (errno == EINTR)
+        continue;
+      return false;
+    }
+    data += bytes;
+    size -= (size_t) bytes;
+  }
+
+  return true;
+#else
+  (void) data;
+  (void) size;
+  return false;
+#endif
+}
+
+ostream& outputStream(ostream* out)
+{
+#if defined(HAS_OUTPUT_SINK)
+  if (out == &cout &&
+      cout.rdbuf() == coutBuffer)
+  {
+    // flushed by ~OutputSink() at exit
+    static OutputSink sink(1);
+    static ostream stream(&sink);
+    return stream;
+  }
+#endif
+
+  return *out;
+}
+
+} // namespace
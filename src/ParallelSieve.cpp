@@ -1,6 +1,7 @@
 ///
 /// @file   ParallelSieve.cpp
-/// @brief  Multi-threaded prime sieve using std::async.
+/// @brief  Multi-threaded prime sieve, the threads are
+///         provided by primesieve's ThreadPool.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -8,18 +9,44 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/Affinity.hpp>
+#include <primesieve/Bucket.hpp>
+#include <primesieve/Checkpoint.hpp>
+#include <primesieve/ChunkScheduler.hpp>
 #include <primesieve/config.hpp>
+#include <primesieve/CountCache.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/Erat.hpp>
+#include <primesieve/GpuSieve.hpp>
+#include <primesieve/LMO.hpp>
+#include <primesieve/OutputSink.hpp>
 #include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PiTable.hpp>
+#include <primesieve/PrimePartitions.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/pmath.hpp>
+#include <primesieve/PrimeGaps.hpp>
+#include <primesieve/PrintFormat.hpp>
+#include <primesieve/PrintQueue.hpp>
+#include <primesieve/prime_table.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SieveStats.hpp>
+#include <primesieve/SieveTrace.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/Tuning.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <atomic>
-#include <cassert>
 #include <chrono>
-#include <future>
+#include <cmath>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <ostream>
+#include <thread>
 #include <vector>
 
 using namespace std;
@@ -34,28 +61,50 @@ counts_t& operator+=(counts_t& v1, const counts_t& v2)
   return v1;
 }
 
+/// Progress counter of a thread, padded
+/// to its own cache line
+///
+struct Progress
+{
+  atomic<uint64_t> processed{0};
+  char pad[64 - sizeof(atomic<uint64_t>)];
+};
+
+/// The LMO algorithm uses O(stop^(2/3)) operations,
+/// it is used if sieving would take much longer
+///
+bool useLMO(uint64_t start, uint64_t stop, uint64_t dist)
+{
+  if (stop < config::MIN_LMO_STOP)
+    return false;
+
+  double cost = pow((double) stop, 2.0 / 3.0) * config::LMO_FACTOR;
+  if (start > 0)
+    cost *= 2;
+
+  return dist > cost;
+}
+
 } // namespace
 
 namespace primesieve {
 
 ParallelSieve::ParallelSieve() :
-  shm_(nullptr),
-  numThreads_(getMaxThreads())
+  numThreads_(getMaxThreads()),
+  memoryLimit_(0),
+  pool_(&threadPool()),
+  tableCache_(nullptr),
+  checkpoint_(nullptr),
+  gpu_(false),
+  countCache_(true)
 { }
 
-void ParallelSieve::init(SharedMemory& shm)
-{
-  setStart(shm.start);
-  setStop(shm.stop);
-  setSieveSize(shm.sieveSize);
-  setFlags(shm.flags);
-  setNumThreads(shm.threads);
-  shm_ = &shm;
-}
-
+/// The CPUs available to this process, this honours the
+/// CPU affinity and the CPU quotas of containers
+///
 int ParallelSieve::getMaxThreads()
 {
-  int maxThreads = thread::hardware_concurrency();
+  int maxThreads = (int) cpuInfo.availableCpus();
   return max(1, maxThreads);
 }
 
@@ -69,6 +118,152 @@ void ParallelSieve::setNumThreads(int threads)
   numThreads_ = inBetween(1, threads, getMaxThreads());
 }
 
+uint64_t ParallelSieve::getMemoryLimit() const
+{
+  return memoryLimit_;
+}
+
+/// Limit the estimated memory usage (in bytes) of all
+/// threads, 0 = unlimited
+///
+void ParallelSieve::setMemoryLimit(uint64_t bytes)
+{
+  memoryLimit_ = bytes;
+}
+
+/// Estimate the memory usage in bytes of a thread that
+/// sieves up to stop_ using a sieve size in KiB. The
+/// sieving primes of EratMedium and EratBig dominate the
+/// memory usage for big stop numbers. Uses the same split
+/// of the sieving primes as Erat.
+///
+uint64_t ParallelSieve::getThreadMemory(int sieveSize) const
+{
+  uint64_t sqrtStop = isqrt(stop_);
+  uint64_t sieveBytes = (uint64_t) sieveSize << 10;
+  uint64_t maxEratSmall = Erat::getMaxEratSmall(stop_, sieveBytes);
+  uint64_t maxEratMedium = Erat::getMaxEratMedium(stop_, sieveBytes);
+  uint64_t primes = primeCountApprox(sqrtStop);
+  uint64_t bytes = sieveBytes + primes * sizeof(SievingPrime);
+
+  // EratMedium: 64 bucket lists, the lists of the
+  // current segment are moved to new buckets
+  if (sqrtStop > maxEratSmall)
+    bytes += 128 * sizeof(Bucket);
+
+  // EratBig: at least one bucket per list,
+  // allocated in chunks of BYTES_PER_ALLOC
+  if (sqrtStop > maxEratMedium)
+  {
+    uint64_t maxMultipleIndex = sqrtStop / 30 * 10 + sieveBytes;
+    uint64_t lists = maxMultipleIndex / sieveBytes + 1;
+    lists = min(lists, (uint64_t) config::MAX_BUCKET_LISTS * 2);
+    bytes += lists * sizeof(Bucket);
+    bytes += config::BYTES_PER_ALLOC;
+  }
+
+  return bytes;
+}
+
+/// The sieving primes used by multiple
+/// threads are stored only once
+///
+uint64_t ParallelSieve::getSharedMemory() const
+{
+  return isqrt(stop_) / 30;
+}
+
+/// Run the threads on the given pool
+/// instead of the process-wide pool
+///
+void ParallelSieve::setThreadPool(ThreadPool* pool)
+{
+  pool_ = pool;
+}
+
+/// Reuse the sieving primes of previous calls
+void ParallelSieve::setSievingTableCache(SievingTableCache* cache)
+{
+  tableCache_ = cache;
+}
+
+/// Record the finished pieces in a checkpoint file and
+/// skip the pieces finished by a previous run
+///
+void ParallelSieve::setCheckpoint(Checkpoint* checkpoint)
+{
+  checkpoint_ = checkpoint;
+}
+
+/// The callback is invoked with the status in percent every
+/// config::STATUS_INTERVAL from a separate thread, the
+/// callback must be thread-safe. Requires CALCULATE_STATUS.
+///
+void ParallelSieve::setStatusCallback(const function<void(double)>& callback)
+{
+  statusCallback_ = callback;
+}
+
+/// Count the primes on the GPU if available
+void ParallelSieve::setGpu(bool gpu)
+{
+  gpu_ = gpu;
+}
+
+/// The GPU only counts primes and only up to
+/// config::MAX_GPU_STOP, else the CPU is used
+///
+bool ParallelSieve::useGpu() const
+{
+  int countFlags = COUNT_SEXTUPLETS * 2 - 1;
+
+  return gpu_ &&
+         (getFlags() & countFlags) == COUNT_PRIMES &&
+         !isPrint() &&
+         !getHistogram() &&
+         !getPrimeGaps() &&
+         !getPrimeSums() &&
+         !getResidueCounts() &&
+         start_ <= stop_ &&
+         stop_ <= config::MAX_GPU_STOP &&
+         getDistance() >= config::MIN_GPU_DISTANCE &&
+         gpuAvailable();
+}
+
+/// Each thread sieves at least this distance
+uint64_t ParallelSieve::getThreadDistance() const
+{
+  uint64_t threshold = isqrt(stop_) / 5;
+  return max(threshold, getTuning(stop_).minThreadDistance);
+}
+
+/// If [start_, stop_] is too small to be split among the
+/// threads a single thread would spend most of its time
+/// adding the sieving primes, hence the sieving primes are
+/// split among the threads instead. Only supported for
+/// counting.
+///
+bool ParallelSieve::usePrimePartitions() const
+{
+  int countFlags = COUNT_SEXTUPLETS * 2 - 1;
+
+  return numThreads_ > 1 &&
+         !memoryLimit_ &&
+         (getFlags() & countFlags) &&
+         !isPrint() &&
+         !getHistogram() &&
+         !getPrimeGaps() &&
+         !getPrimeSums() &&
+         !getResidueCounts() &&
+         !getSieveStats() &&
+         !getTrace() &&
+         start_ >= 7 &&
+         start_ <= stop_ &&
+         isqrt(stop_) >= config::MIN_PRIME_PARTITION &&
+         getDistance() <= config::MAX_PRIME_PARTITION_DISTANCE &&
+         getDistance() / getThreadDistance() <= 1;
+}
+
 /// Get an ideal number of threads for
 /// the start_ and stop_ numbers
 ///
@@ -77,45 +272,501 @@ int ParallelSieve::idealNumThreads() const
   if (start_ > stop_)
     return 1;
 
-  uint64_t threshold = isqrt(stop_) / 5;
-  threshold = max(threshold, config::MIN_THREAD_DISTANCE);
-  uint64_t threads = getDistance() / threshold;
+  // the first gap of a chunk would depend
+  // on the last prime of the previous chunk
+  if (isPrintPrimes() && isDeltaFormat(getPrintFormat()))
+    return 1;
+
+  if (usePrimePartitions())
+    return numThreads_;
+
+  uint64_t threads = getDistance() / getThreadDistance();
   threads = inBetween(1, threads, numThreads_);
 
+  // reduce the number of threads so that
+  // the memory usage stays within the limit
+  if (memoryLimit_ && threads > 1)
+  {
+    uint64_t shared = getSharedMemory();
+    uint64_t perThread = getThreadMemory(getSieveSize());
+    uint64_t maxThreads = 1;
+    if (memoryLimit_ > shared)
+      maxThreads = (memoryLimit_ - shared) / perThread;
+    threads = inBetween(1, threads, maxThreads);
+  }
+
   return (int) threads;
 }
 
-/// Get a thread distance which ensures a good load
-/// balance when using multiple threads
+/// Get the minimum distance of a chunk, sieving
+/// smaller chunks would cause too much
+/// initialization overhead
 ///
-uint64_t ParallelSieve::getThreadDistance(int threads) const
+uint64_t ParallelSieve::getMinDistance() const
 {
-  assert(threads > 0);
+  uint64_t minDist = isqrt(stop_) * 100;
+  return max(getTuning(stop_).minThreadDistance, minDist);
+}
 
-  uint64_t balanced = isqrt(stop_) * 1000;
-  uint64_t unbalanced = getDistance() / threads;
-  uint64_t fastest = min(balanced, unbalanced);
-  uint64_t threadDistance = max(config::MIN_THREAD_DISTANCE, fastest);
-  uint64_t iters = getDistance() / threadDistance;
+/// On hybrid CPUs the threads running on the efficiency
+/// cores are slower, hence they get smaller initial spans.
+/// We assume that the operating system runs our threads
+/// on the fastest cores first.
+///
+vector<double> ParallelSieve::getThreadWeights(int threads) const
+{
+  vector<double> weights;
 
-  if (iters < threads * 5u)
-    threadDistance = max(config::MIN_THREAD_DISTANCE, unbalanced);
+  for (auto& core : cpuInfo.coreClasses())
+    for (size_t i = 0; i < core.cpus.size(); i++)
+      if ((int) weights.size() < threads)
+        weights.push_back(core.capacity / 1024.0);
 
-  threadDistance += 30 - threadDistance % 30;
-  return threadDistance;
+  weights.resize(threads, 1.0);
+  return weights;
 }
 
-/// Align n to modulo (30 + 2) to prevent prime k-tuplet
-/// (twin primes, prime triplets) gaps
+/// The default sieve size is based on the caches of cpu0.
+/// On hybrid CPUs the sieve size of the other core classes
+/// is scaled by their L2 cache size per thread.
 ///
-uint64_t ParallelSieve::align(uint64_t n) const
+vector<int> ParallelSieve::getCoreSieveSizes() const
 {
-  uint64_t n32 = checkedAdd(n, 32);
+  auto& classes = cpuInfo.coreClasses();
+  vector<int> sieveSizes(classes.size(), getSieveSize());
+  int cpu0 = cpuInfo.coreClass(0);
+
+  if (cpu0 < 0 ||
+      !classes[cpu0].l2CacheSize)
+    return sieveSizes;
 
-  if (n32 >= stop_)
-    return stop_;
+  auto l2PerThread = [](const CoreClass& core)
+  {
+    return (double) core.l2CacheSize / max<size_t>(1, core.l2Sharing);
+  };
+
+  double l2Cpu0 = l2PerThread(classes[cpu0]);
+
+  for (size_t i = 0; i < classes.size(); i++)
+  {
+    if (!classes[i].l2CacheSize)
+      continue;
+
+    double sieveSize = getSieveSize() * l2PerThread(classes[i]) / l2Cpu0;
+    sieveSize = inBetween(8.0, sieveSize, (double) config::MAX_SIEVE_SIZE);
+    sieveSizes[i] = (int) sieveSize;
+  }
+
+  return sieveSizes;
+}
+
+/// If a single thread exceeds the memory limit
+/// we reduce the sieve size. The sieving primes
+/// are always needed, hence the memory limit
+/// cannot be guaranteed.
+///
+void ParallelSieve::applyMemoryLimit()
+{
+  int sieveSize = getSieveSize();
+  uint64_t bytes = getThreadMemory(sieveSize);
+
+  while (sieveSize > 8 &&
+         bytes > memoryLimit_ &&
+         getThreadMemory(sieveSize / 2) < bytes)
+  {
+    sieveSize /= 2;
+    bytes = getThreadMemory(sieveSize);
+  }
 
-  return n32 - n % 30;
+  setSieveSize(sieveSize);
+}
+
+/// The sieving primes are generated only once
+/// and shared read-only by all threads. If the
+/// process-wide prime_table is large enough its
+/// bitmap is used instead.
+///
+shared_ptr<const SievingTable> ParallelSieve::getSievingTable(int threads)
+{
+  auto sievingTable = getSharedSievingTable(isqrt(stop_));
+  if (sievingTable)
+    return sievingTable;
+
+  auto t1 = chrono::steady_clock::now();
+  double traceStart = getTrace() ? getTrace()->now() : 0;
+
+  if (tableCache_)
+    sievingTable = tableCache_->get(isqrt(stop_), threads, getSieveSize(), *pool_, getCancelToken());
+  else
+    sievingTable = make_shared<SievingTable>(isqrt(stop_), threads, getSieveSize(), *pool_, getCancelToken());
+
+  // the table is built using all threads
+  if (SieveStats* stats = getSieveStats())
+  {
+    auto t2 = chrono::steady_clock::now();
+    chrono::duration<double> seconds = t2 - t1;
+    stats->seconds[PHASE_SIEVING_PRIMES] += seconds.count() * threads;
+    stats->busy += seconds.count() * threads;
+  }
+
+  // built by the main thread using the thread pool
+  if (SieveTrace* trace = getTrace())
+    trace->add({ "SievingTable", -1, traceStart, trace->now(), 0, isqrt(stop_) });
+
+  checkCancelled();
+  return sievingTable;
+}
+
+/// Each thread of a ParallelSieve increases its own progress
+/// counter after each segment (without any locking), a
+/// separate thread sums up the counters every STATUS_INTERVAL
+/// and updates the status of the ParallelSieve.
+///
+class StatusThread
+{
+public:
+  StatusThread(int threads, const function<void(uint64_t)>& update) :
+    progress_(threads),
+    update_(update)
+  {
+    thread_ = thread([this]()
+    {
+      unique_lock<mutex> lock(mutex_);
+      while (!cond_.wait_for(lock, chrono::milliseconds(config::STATUS_INTERVAL), [&]() { return finished_; }))
+        report();
+    });
+  }
+
+  ~StatusThread()
+  {
+    {
+      lock_guard<mutex> lock(mutex_);
+      finished_ = true;
+    }
+
+    cond_.notify_one();
+    thread_.join();
+    report();
+  }
+
+  atomic<uint64_t>* counter(int thread)
+  {
+    return &progress_[thread].processed;
+  }
+
+private:
+  vector<Progress> progress_;
+  function<void(uint64_t)> update_;
+  uint64_t reported_ = 0;
+  bool finished_ = false;
+  mutex mutex_;
+  condition_variable cond_;
+  thread thread_;
+
+  void report()
+  {
+    uint64_t processed = 0;
+    for (auto& p : progress_)
+      processed += p.processed.load(memory_order_relaxed);
+
+    update_(processed - reported_);
+    reported_ = processed;
+  }
+};
+
+/// Used if the status is printed or sent to the status callback
+unique_ptr<StatusThread> ParallelSieve::getStatusThread(int threads)
+{
+  unique_ptr<StatusThread> status;
+
+  if (isStatus())
+  {
+    status.reset(new StatusThread(threads, [this](uint64_t processed)
+    {
+      updateStatus(processed);
+      if (statusCallback_)
+        statusCallback_(getStatus());
+    }));
+  }
+
+  return status;
+}
+
+/// Print the primes or prime k-tuplets in [start_, stop_]
+/// using multi-threading. The threads sieve the chunks of
+/// PrintQueue in increasing order, the output of the chunks
+/// is written to stdout in order.
+///
+void ParallelSieve::sievePrint(int threads)
+{
+  auto t1 = chrono::system_clock::now();
+  auto sievingTable = getSievingTable(threads);
+  ostream& out = outputStream(getOutput());
+  PrintQueue printQueue(start_, stop_, config::PRINT_CHUNK_DISTANCE, threads * 2, out);
+  auto status = getStatusThread(threads);
+  SieveTrace* trace = getTrace();
+  atomic<int> threadId(0);
+
+  auto task = [&]()
+  {
+    int id = threadId++;
+    PrimeSieve ps(this);
+    ps.setSievingTable(sievingTable.get());
+    ps.setTrace(trace, id);
+    if (status)
+      ps.setProgress(status->counter(id));
+    SieveStats stats;
+    stats.hw = getSieveStats() && getSieveStats()->hw;
+    ps.setSieveStats(getSieveStats() ? &stats : nullptr);
+    counts_t counts;
+    counts.fill(0);
+    uint64_t chunk = 0;
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    try
+    {
+      // the chunk events include waiting for our turn
+      double t = trace ? trace->now() : 0;
+
+      while (printQueue.next(&chunk, &low, &high))
+      {
+        ps.setPrintQueue(&printQueue, chunk);
+        ps.sieve(low, high);
+        counts += ps.getCounts();
+        printQueue.finish(chunk);
+
+        if (trace)
+        {
+          trace->add({ "chunk", id, t, trace->now(), low, high });
+          t = trace->now();
+        }
+      }
+    }
+    catch (...)
+    {
+      // the other threads may wait for our chunk
+      printQueue.abort();
+      throw;
+    }
+
+    lock_guard<mutex> lock(lock_);
+    counts_ += counts;
+    if (getSieveStats())
+      getSieveStats()->add(stats);
+  };
+
+  pool_->run(threads, task);
+  status.reset();
+  out.flush();
+
+  if (getPrimeGaps())
+    getPrimeGaps()->finish();
+
+  auto t2 = chrono::system_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
+}
+
+/// Count the primes and prime k-tuplets in [start_, stop_]
+/// piece by piece, each piece is sieved in parallel and
+/// recorded in the checkpoint file once it is finished.
+/// The pieces are large enough (>= 16 chunks per thread)
+/// so that the threads stay busy.
+///
+void ParallelSieve::sieveCheckpoint()
+{
+  if (isPrint() ||
+      getHistogram() ||
+      getPrimeGaps() ||
+      getPrimeSums() ||
+      getResidueCounts())
+    throw primesieve_error("checkpoint files only support counting");
+
+  auto t1 = chrono::system_clock::now();
+  Checkpoint* checkpoint = checkpoint_;
+  uint64_t start = start_;
+  uint64_t stop = stop_;
+  int flags = getFlags();
+  checkpoint->init(start, stop, flags & (COUNT_SEXTUPLETS * 2 - 1));
+
+  uint64_t pieceDist = getMinDistance() * getNumThreads() * 16;
+  pieceDist = max(pieceDist, getDistance() / 1024);
+
+  auto restore = [&]()
+  {
+    checkpoint_ = checkpoint;
+    setFlags(flags);
+    start_ = start;
+    stop_ = stop;
+  };
+
+  // the status would be reset for each piece
+  checkpoint_ = nullptr;
+  setFlags(flags & ~(PRINT_STATUS | CALCULATE_STATUS));
+
+  try
+  {
+    for (auto& interval : checkpoint->remaining())
+    {
+      uint64_t low = interval.first;
+
+      while (true)
+      {
+        uint64_t high = interval.second;
+        if (high - low > pieceDist)
+          high = low + pieceDist;
+
+        sieve(low, high);
+        checkpoint->add(low, high, counts_);
+
+        if (high >= interval.second)
+          break;
+        low = high + 1;
+      }
+    }
+  }
+  catch (...)
+  {
+    restore();
+    checkpoint->save();
+    throw;
+  }
+
+  restore();
+  checkpoint->save();
+  counts_ = checkpoint->getCounts();
+
+  auto t2 = chrono::system_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
+}
+
+/// Count the primes and prime k-tuplets in [start_, stop_],
+/// the threads split the sieving primes (see PrimePartitions.hpp)
+///
+void ParallelSieve::sievePrimePartitions(int threads)
+{
+  auto t1 = chrono::system_clock::now();
+  auto sievingTable = getSievingTable(threads);
+  auto status = getStatusThread(threads);
+  int countFlags = getFlags() & (COUNT_SEXTUPLETS * 2 - 1);
+
+  counts_ = countPrimePartitions(start_, stop_, countFlags, getSieveSize(),
+                                 threads, *sievingTable, *pool_,
+                                 [&](int thread, uint64_t dist)
+  {
+    checkCancelled();
+    if (status)
+      status->counter(thread)->fetch_add(dist, memory_order_relaxed);
+  });
+
+  status.reset();
+  auto t2 = chrono::system_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
+}
+
+/// Only counts are cached and [start_, stop_]
+/// must contain at least 1 chunk
+///
+bool ParallelSieve::useCountCache() const
+{
+  int countFlags = COUNT_SEXTUPLETS * 2 - 1;
+
+  return countCache_ &&
+         countCache().enabled() &&
+         (getFlags() & countFlags) &&
+         !isPrint() &&
+         !isStatus() &&
+         !statusCallback_ &&
+         !getHistogram() &&
+         !getPrimeGaps() &&
+         !getPrimeSums() &&
+         !getResidueCounts() &&
+         !getSieveStats() &&
+         !getTrace() &&
+         start_ <= stop_ &&
+         CountCache::firstChunk(start_) < CountCache::chunks(stop_);
+}
+
+/// Assemble the counts of [start_, stop_] from the cached
+/// chunks. The chunks that are not cached are sieved one by
+/// one (each using all threads) and stored in the cache,
+/// the edges of [start_, stop_] are sieved as usual.
+///
+void ParallelSieve::sieveCountCache()
+{
+  auto t1 = chrono::system_clock::now();
+  CountCache& cache = countCache();
+  uint64_t start = start_;
+  uint64_t stop = stop_;
+  int countFlags = getFlags() & (COUNT_SEXTUPLETS * 2 - 1);
+  uint64_t first = CountCache::firstChunk(start);
+  uint64_t last = CountCache::chunks(stop);
+  counts_t counts;
+  counts.fill(0);
+
+  auto restore = [&]()
+  {
+    countCache_ = true;
+    start_ = start;
+    stop_ = stop;
+  };
+
+  uint64_t low = CountCache::chunkLow(first);
+  uint64_t high = CountCache::chunkHigh(last - 1);
+  countCache_ = false;
+
+  try
+  {
+    if (start < low)
+    {
+      sieve(start, low - 1);
+      counts += counts_;
+    }
+
+    for (uint64_t i = first; i < last; i++)
+    {
+      counts_t chunk;
+      chunk.fill(0);
+
+      if (!cache.get(i, countFlags, chunk))
+      {
+        sieve(CountCache::chunkLow(i), CountCache::chunkHigh(i));
+        chunk = counts_;
+        cache.put(i, countFlags, chunk);
+      }
+
+      counts += chunk;
+    }
+
+    if (high < stop)
+    {
+      sieve(high + 1, stop);
+      counts += counts_;
+    }
+  }
+  catch (...)
+  {
+    restore();
+    throw;
+  }
+
+  restore();
+  counts_ = counts;
+  auto t2 = chrono::system_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
+}
+
+void ParallelSieve::sieveGpu()
+{
+  auto t1 = chrono::system_clock::now();
+  counts_[0] = gpuCountPrimes(start_, stop_, getCancelToken());
+  auto t2 = chrono::system_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+  seconds_ = seconds.count();
 }
 
 /// Sieve the primes and prime k-tuplets in [start_, stop_]
@@ -128,87 +779,212 @@ void ParallelSieve::sieve()
   if (start_ > stop_)
     return;
 
+  if (checkpoint_)
+  {
+    sieveCheckpoint();
+    return;
+  }
+
+  if (useCountCache())
+  {
+    sieveCountCache();
+    return;
+  }
+
+  // the threads share the CPU caches, the memory
+  // limit depends on the sieve size
+  tuneSieveSize(idealNumThreads());
   int threads = idealNumThreads();
 
-  if (threads == 1)
-    PrimeSieve::sieve();
+  if (getSieveStats())
+    getSieveStats()->reset();
+
+  if (memoryLimit_ && threads == 1)
+    applyMemoryLimit();
+
+  if (useGpu())
+    sieveGpu();
+  else if (threads > 1 && usePrimePartitions())
+    sievePrimePartitions(threads);
+  else if (threads == 1 && !statusCallback_)
+  {
+    // frees the cached memory of the
+    // calling thread when it is done
+    pool_->run(1, [&]() { PrimeSieve::sieve(); });
+  }
+  else if (isPrint())
+    sievePrint(threads);
   else
   {
     auto t1 = chrono::system_clock::now();
-    uint64_t threadDistance = getThreadDistance(threads);
-    uint64_t iters = ((getDistance() - 1) / threadDistance) + 1;
-    threads = inBetween(1, threads, iters);
-    atomic<uint64_t> i(0);
-
-    // each thread executes 1 task
+    ChunkScheduler scheduler(start_, stop_, getThreadWeights(threads), getMinDistance());
+    auto& coreClasses = cpuInfo.coreClasses();
+    vector<int> sieveSizes = getCoreSieveSizes();
+
+    auto sievingTable = getSievingTable(threads);
+    auto status = getStatusThread(threads);
+    SieveTrace* trace = getTrace();
+    vector<int> threadIds;
+    for (int i = threads - 1; i >= 0; i--)
+      threadIds.push_back(i);
+
+    // each thread executes 1 task, a worker thread
+    // may yield to concurrent computations in
+    // between the spans and resume later with
+    // the id of any thread that has returned
     auto task = [&]()
     {
+      int id;
+      {
+        lock_guard<mutex> lock(lock_);
+        id = threadIds.back();
+        threadIds.pop_back();
+      }
+
       PrimeSieve ps(this);
-      uint64_t j;
+      ps.setSievingTable(sievingTable.get());
+      ps.setTrace(trace, id);
+      if (status)
+        ps.setProgress(status->counter(id));
+      SieveStats stats;
+      stats.hw = getSieveStats() && getSieveStats()->hw;
+      ps.setSieveStats(getSieveStats() ? &stats : nullptr);
       counts_t counts;
       counts.fill(0);
-
-      while ((j = i++) < iters)
+      int span = -1;
+      uint64_t start = 0;
+      uint64_t stop = 0;
+
+      // sieve the spans [start, stop], the sieving
+      // state is kept until another thread steals
+      // the upper part of our span
+      while (true)
       {
-        uint64_t start = start_ + j * threadDistance;
-        uint64_t stop = checkedAdd(start, threadDistance);
-        stop = align(stop);
-        if (start > start_)
-          start = align(start) + 1;
+        // the span events include the scheduling
+        double t = trace ? trace->now() : 0;
+
+        // core class of the CPU we are running on
+        int core = cpuInfo.coreClass(getCurrentCpu());
+        double weight = 1.0;
+        if (core >= 0)
+          weight = coreClasses[core].capacity / 1024.0;
+
+        if (pool_->yield())
+        {
+          scheduler.release(span);
+          break;
+        }
+
+        if (!scheduler.next(&span, &start, &stop, weight))
+          break;
 
-        // sieve the range [start, stop]
+        if (core >= 0)
+          ps.setSieveSize(sieveSizes[core]);
+
+        ps.setSpan(&scheduler, span);
         ps.sieve(start, stop);
         counts += ps.getCounts();
+
+        if (trace)
+          trace->add({ "span", id, t, trace->now(), start, stop });
       }
 
-      return counts;
+      lock_guard<mutex> lock(lock_);
+      counts_ += counts;
+      if (getSieveStats())
+        getSieveStats()->add(stats);
+      threadIds.push_back(id);
     };
 
-    vector<future<counts_t>> futures;
-    futures.reserve(threads);
-
-    for (int t = 0; t < threads; t++)
-      futures.emplace_back(async(launch::async, task));
+    pool_->run(threads, task);
+    status.reset();
 
-    for (auto &f : futures)
-      counts_ += f.get();
+    if (getPrimeGaps())
+      getPrimeGaps()->finish();
 
     auto t2 = chrono::system_clock::now();
     chrono::duration<double> seconds = t2 - t1;
     seconds_ = seconds.count();
   }
 
-  if (shm_)
+  if (SieveStats* stats = getSieveStats())
   {
-    // communicate the sieving results to
-    // the primesieve GUI application
-    copy(counts_.begin(), counts_.end(), shm_->counts);
-    shm_->seconds = seconds_;
+    stats->threads = threads;
+    stats->idle = max(0.0, threads * seconds_ - stats->busy);
   }
 }
 
-/// Print status in percent to stdout
-/// @processed: Sum of recently processed segments
-/// @tryLock:   Do not block if tryLock = true
+/// If stop <= limit of the process-wide prime_table (or of the
+/// small_prime_table()) the primes are counted using the table
+/// in O(1). Else
+/// pi(n) = pi(x) + count_primes(x + 1, n) where x <= n is
+/// the nearest entry of the pi(x) table. The table is only
+/// used if it reduces the distance to sieve. If the LMO
+/// algorithm is cheaper than sieving it is used instead.
 ///
-bool ParallelSieve::updateStatus(uint64_t processed, bool tryLock)
+uint64_t ParallelSieve::countPrimes(uint64_t start, uint64_t stop)
 {
-  unique_lock<mutex> lock(lock_, defer_lock);
+  if (start > stop)
+    return 0;
 
-  if (tryLock)
-    lock.try_lock();
-  else
-    lock.lock();
+  if (stop <= config::SMALL_PRIME_TABLE)
+  {
+    setStart(start);
+    setStop(stop);
+    counts_.fill(0);
+    counts_[0] = small_prime_table().count_primes(start, stop);
+    return counts_[0];
+  }
+
+  auto primeTable = get_prime_table();
+  if (primeTable && stop <= primeTable->limit())
+  {
+    setStart(start);
+    setStop(stop);
+    counts_.fill(0);
+    counts_[0] = primeTable->count_primes(start, stop);
+    return counts_[0];
+  }
+
+  auto table = getPiTable();
+  uint64_t dist = stop - start;
+  uint64_t x = 0;
+  uint64_t y = 0;
+  uint64_t count = 0;
 
-  if (lock.owns_lock())
+  if (table)
   {
-    PrimeSieve::updateStatus(processed);
-    if (shm_)
-      shm_->status = getStatus();
-    return true;
+    x = table->floor(stop);
+    y = (start > 0) ? table->floor(start - 1) : 0;
+    dist = min(dist, (stop - x) + ((start > 0) ? start - 1 - y : 0));
   }
 
-  return false;
+  if (useLMO(start, stop, dist))
+  {
+    int threads = getNumThreads();
+    count = piLMO(stop, threads, getCancelToken());
+    if (start > 0)
+      count -= piLMO(start - 1, threads, getCancelToken());
+  }
+  else if (table && dist < stop - start)
+  {
+    count = table->pi(x);
+    if (x < stop)
+      count += PrimeSieve::countPrimes(x + 1, stop);
+    if (start > 0)
+      count -= table->pi(y);
+    if (start > 0 && y < start - 1)
+      count -= PrimeSieve::countPrimes(y + 1, start - 1);
+  }
+  else
+    return PrimeSieve::countPrimes(start, stop);
+
+  setStart(start);
+  setStop(stop);
+  counts_.fill(0);
+  counts_[0] = count;
+
+  return count;
 }
 
 } // namespace
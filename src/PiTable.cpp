@@ -0,0 +1,156 @@
+///
+/// @file   PiTable.cpp
+/// @brief  Write and read the table of prime counts pi(k * dist).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/PiTable.hpp>
+#include <primesieve/MappedFile.hpp>
+#include <primesieve/PrintFormat.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = { 'P', 'S', 'P', 'I', 'T', 'B', 'L', '1' };
+const uint64_t HEADER_SIZE = 24;
+
+mutex piTableMutex;
+shared_ptr<const primesieve::PiTable> piTable;
+
+void write64(string& str, uint64_t n)
+{
+  char bytes[8];
+  primesieve::toLittleEndian<8>(n, bytes);
+  str.append(bytes, 8);
+}
+
+} // namespace
+
+namespace primesieve {
+
+/// pi(k * dist) is the sum of the prime counts of the
+/// bins [1, dist], ..., [(k - 1) * dist + 1, k * dist]
+/// which are counted in a single multi-threaded pass.
+///
+void write_pi_table(const string& filename, uint64_t stop, uint64_t dist)
+{
+  if (dist == 0)
+    throw primesieve_error("pi(x) table distance must be > 0");
+
+  uint64_t n = stop / dist;
+  vector<uint64_t> bins;
+  if (n > 0)
+    bins = count_primes_bins(1, n * dist, dist);
+
+  string data(MAGIC, sizeof(MAGIC));
+  write64(data, dist);
+  write64(data, n + 1);
+  write64(data, 0);
+
+  uint64_t pix = 0;
+  for (uint64_t count : bins)
+  {
+    pix += count;
+    write64(data, pix);
+  }
+
+  ofstream file(filename, ios::binary | ios::trunc);
+  file.write(data.data(), data.size());
+  file.close();
+
+  if (!file)
+    throw primesieve_error("failed to write " + filename);
+}
+
+void load_pi_table(const string& filename)
+{
+  setPiTable(make_shared<const PiTable>(filename));
+}
+
+void unload_pi_table()
+{
+  setPiTable(nullptr);
+}
+
+PiTable::PiTable(const string& filename) :
+  file_(filename)
+{
+  bool valid = file_.size() >= HEADER_SIZE &&
+               memcmp(file_.data(), MAGIC, sizeof(MAGIC)) == 0;
+
+  if (valid)
+  {
+    dist_ = file_.read64(8);
+    size_ = file_.read64(16);
+    uint64_t entries = (file_.size() - HEADER_SIZE) / 8;
+
+    valid = dist_ > 0 &&
+            size_ > 0 &&
+            size_ <= entries &&
+            size_ - 1 <= ~0ull / dist_ &&
+            pi(0) == 0;
+  }
+
+  if (!valid)
+    throw primesieve_error("invalid pi(x) table " + filename);
+}
+
+uint64_t PiTable::floor(uint64_t n) const
+{
+  uint64_t k = n / dist_;
+  if (k >= size_)
+    k = size_ - 1;
+  return k * dist_;
+}
+
+/// Binary search for the last entry with pi(x) < n
+uint64_t PiTable::floorNth(uint64_t n) const
+{
+  uint64_t lo = 0;
+  uint64_t hi = size_ - 1;
+
+  while (lo < hi)
+  {
+    uint64_t mid = lo + (hi - lo + 1) / 2;
+    if (pi(mid * dist_) < n)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  return lo * dist_;
+}
+
+uint64_t PiTable::pi(uint64_t x) const
+{
+  return file_.read64((size_t) (HEADER_SIZE + x / dist_ * 8));
+}
+
+shared_ptr<const PiTable> getPiTable()
+{
+  lock_guard<mutex> lock(piTableMutex);
+  return piTable;
+}
+
+void setPiTable(const shared_ptr<const PiTable>& table)
+{
+  lock_guard<mutex> lock(piTableMutex);
+  piTable = table;
+}
+
+} // namespace
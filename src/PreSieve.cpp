@@ -1,7 +1,13 @@
 ///
 /// @file   PreSieve.cpp
 /// @brief  Pre-sieve multiples of small primes to speed up
-///         the sieve of Eratosthenes.
+///         the sieve of Eratosthenes. The patterns of
+///         multiple groups of small primes are combined using
+///         bitwise AND whilst they are copied to the sieve
+///         array, the compiler vectorizes the inner loop.
+///         The patterns are built once per process and shared
+///         read-only by all threads, iterators and PreSieve
+///         objects.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -11,92 +17,137 @@
 
 #include <primesieve/PreSieve.hpp>
 #include <primesieve/EratSmall.hpp>
-#include <primesieve/pmath.hpp>
 #include <primesieve/types.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <array>
-#include <memory>
+#include <initializer_list>
+#include <vector>
 
 using namespace std;
 using namespace primesieve;
 
 namespace {
 
-// small primes >= 7
-const array<uint64_t, 5> primes = { 7, 11, 13, 17, 19 };
+const uint64_t CACHE_LINE = 64;
 
-// prime products of primes >= 7
-const array<uint64_t, 5> primeProducts = { 210, 2310, 30030, 510510, 9699690 };
+/// Pre-sieved buffer of the multiples of a group of small
+/// primes. The buffer starts at a cache line boundary and
+/// owns its last cache line, hence no cache line of the
+/// read-only pattern is shared with data that other threads
+/// write to.
+///
+struct Pattern
+{
+  vector<byte_t> memory;
+  byte_t* buffer;
+  uint64_t bytes;
 
-} // namespace
+  Pattern(initializer_list<uint64_t> primes)
+  {
+    uint64_t size = 1;
+    for (uint64_t prime : primes)
+      size *= prime;
 
-namespace primesieve {
+    uint64_t lines = (size + CACHE_LINE - 1) / CACHE_LINE;
+    memory.resize(lines * CACHE_LINE + CACHE_LINE - 1);
+    uintptr_t addr = (uintptr_t) memory.data();
+    uintptr_t aligned = (addr + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+    buffer = memory.data() + (aligned - addr);
+    bytes = size;
+    fill_n(buffer, size, (byte_t) 0xff);
 
-PreSieve::PreSieve(uint64_t start, uint64_t stop)
-{
-  // use a small buffer_ array if the
-  // sieve interval is small
-  uint64_t distance = stop - start;
-  uint64_t threshold = max(distance, isqrt(stop)) / 10;
-  size_t i = 0;
+    uint64_t primeProduct = size * 30;
+    uint64_t maxPrime = *max_element(primes.begin(), primes.end());
 
-  for (uint64_t pp : primeProducts)
-    if (pp < threshold)
-      i += 1;
+    EratSmall eratSmall;
+    uint64_t stop = primeProduct * 2;
+    eratSmall.init(stop, size, maxPrime);
 
-  i = min(i, primes.size() - 1);
-  maxPrime_ = primes[i];
-  primeProduct_ = primeProducts[i];
+    for (uint64_t prime : primes)
+      eratSmall.addSievingPrime(prime, primeProduct);
 
-  init();
-}
+    eratSmall.crossOff(buffer, size);
+  }
+
+  /// buffer stays valid, the moved
+  /// vector keeps its memory
+  Pattern(Pattern&&) = default;
+  Pattern(const Pattern&) = delete;
+  Pattern& operator=(const Pattern&) = delete;
+  uint64_t size() const { return bytes; }
+};
 
-/// Pre-sieve a small buffer by removing the
-/// multiples of primes <= maxPrime.
+/// Initialized once (thread-safe), the
+/// largest prime must be listed last
 ///
-void PreSieve::init()
+const array<Pattern, 3>& patterns()
 {
-  size_ = primeProduct_ / 30;
-  buffer_ = new byte_t[size_];
-  deleter_.reset(buffer_);
-  fill_n(buffer_, size_, 0xff);
+  static const array<Pattern, 3> patterns =
+  {
+    Pattern{  7, 11, 13 },
+    Pattern{ 17, 19, 23 },
+    Pattern{ 29, 31 }
+  };
 
-  EratSmall eratSmall;
-  uint64_t stop = primeProduct_ * 2;
-  eratSmall.init(stop, size_, maxPrime_);
+  return patterns;
+}
 
-  for (uint64_t prime : primes)
-    if (prime <= maxPrime_)
-      eratSmall.addSievingPrime(prime, primeProduct_);
+/// sieve[i] = p0[i] & p1[i] & p2[i]
+void andPatterns(byte_t* __restrict sieve,
+                 const byte_t* __restrict p0,
+                 const byte_t* __restrict p1,
+                 const byte_t* __restrict p2,
+                 uint64_t bytes)
+{
+  for (uint64_t i = 0; i < bytes; i++)
+    sieve[i] = p0[i] & p1[i] & p2[i];
+}
+
+} // namespace
+
+namespace primesieve {
 
-  eratSmall.crossOff(buffer_, size_);
+PreSieve::PreSieve() :
+  maxPrime_(31)
+{
+  patterns();
 }
 
-/// Copy pre-sieved buffer to sieve array
+/// Copy the pre-sieved patterns to the sieve array
 void PreSieve::copy(byte_t* sieve,
                     uint64_t sieveSize,
                     uint64_t segmentLow) const
 {
+  auto& p = patterns();
+  array<uint64_t, 3> idx;
+
   // find segmentLow index
-  uint64_t remainder = segmentLow % primeProduct_;
-  uint64_t i = remainder / 30;
-  uint64_t sizeLeft = size_ - i;
+  for (size_t j = 0; j < p.size(); j++)
+    idx[j] = (segmentLow / 30) % p[j].size();
 
-  if (sieveSize <= sizeLeft)
-    copy_n(&buffer_[i], sieveSize, sieve);
-  else
+  for (uint64_t i = 0; i < sieveSize;)
   {
-    // copy the last remaining bytes of buffer
-    // to the beginning of the sieve array
-    copy_n(&buffer_[i], sizeLeft, sieve);
-
-    // restart copying at the beginning of buffer
-    for (i = sizeLeft; i + size_ < sieveSize; i += size_)
-      copy_n(buffer_, size_, &sieve[i]);
-
-    copy_n(buffer_, sieveSize - i, &sieve[i]);
+    // copy until the end of the sieve
+    // array or until a pattern wraps
+    uint64_t bytes = sieveSize - i;
+    for (size_t j = 0; j < p.size(); j++)
+      bytes = min(bytes, p[j].size() - idx[j]);
+
+    andPatterns(&sieve[i],
+                p[0].buffer + idx[0],
+                p[1].buffer + idx[1],
+                p[2].buffer + idx[2],
+                bytes);
+
+    i += bytes;
+    for (size_t j = 0; j < p.size(); j++)
+    {
+      idx[j] += bytes;
+      if (idx[j] == p[j].size())
+        idx[j] = 0;
+    }
   }
 }
 
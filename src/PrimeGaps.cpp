@@ -0,0 +1,95 @@
+///
+/// @file   PrimeGaps.cpp
+/// @brief  Merge the prime gap statistics of the threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/PrimeGaps.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+void PrimeGaps::Run::merge(const Run& run)
+{
+  if (run.counts_.size() > counts_.size())
+  {
+    counts_.resize(run.counts_.size(), 0);
+    firstPrimes_.resize(run.counts_.size(), 0);
+  }
+
+  for (size_t gap = 0; gap < run.counts_.size(); gap++)
+  {
+    if (!run.counts_[gap])
+      continue;
+
+    counts_[gap] += run.counts_[gap];
+    uint64_t prime = run.firstPrimes_[gap];
+    if (!firstPrimes_[gap] || prime < firstPrimes_[gap])
+      firstPrimes_[gap] = prime;
+  }
+}
+
+void PrimeGaps::merge(const Run& run)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if (run.last_)
+  {
+    total_.merge(run);
+    runs_.emplace_back(run.first_, run.last_);
+  }
+}
+
+/// The runs partition the sieved interval, hence
+/// the last prime of a run and the first prime of
+/// the next run are consecutive primes.
+///
+void PrimeGaps::finish()
+{
+  lock_guard<mutex> lock(mutex_);
+  sort(runs_.begin(), runs_.end());
+
+  for (size_t i = 1; i < runs_.size(); i++)
+  {
+    uint64_t prime = runs_[i - 1].second;
+    total_.addGap(prime, runs_[i].first - prime);
+  }
+
+  if (!runs_.empty())
+  {
+    auto run = make_pair(runs_.front().first, runs_.back().second);
+    runs_.assign(1, run);
+  }
+}
+
+uint64_t PrimeGaps::maxGap() const
+{
+  return total_.counts_.empty() ? 0 : total_.counts_.size() - 1;
+}
+
+uint64_t PrimeGaps::count(uint64_t gap) const
+{
+  if (gap >= total_.counts_.size())
+    return 0;
+  return total_.counts_[gap];
+}
+
+uint64_t PrimeGaps::firstPrime(uint64_t gap) const
+{
+  if (gap >= total_.counts_.size())
+    return 0;
+  return total_.firstPrimes_[gap];
+}
+
+} // namespace
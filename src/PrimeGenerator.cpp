@@ -5,6 +5,8 @@
 ///        vector primesieve::iterator iterates over the vector and
 ///        returns the primes. When there are no more primes left in
 ///        the vector PrimeGenerator generates new primes.
+///        fill(std::vector<uint32_t>&) is the 32-bit variant
+///        used if stop < 2^32.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -13,6 +15,7 @@
 ///
 
 #include <primesieve/Erat.hpp>
+#include <primesieve/fillPrimes.hpp>
 #include <primesieve/PreSieve.hpp>
 #include <primesieve/PrimeGenerator.hpp>
 #include <primesieve/pmath.hpp>
@@ -22,6 +25,8 @@
 #include <stdint.h>
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <limits>
 #include <vector>
 
 using namespace std;
@@ -78,9 +83,11 @@ const array<uint8_t, 312> PrimeGenerator::primePi =
   63, 64
 };
 
-PrimeGenerator::PrimeGenerator(uint64_t start, uint64_t stop) :
+PrimeGenerator::PrimeGenerator(uint64_t start,
+                               uint64_t stop,
+                               const SievingTable* sievingTable) :
   Erat(start, stop),
-  preSieve_(start, stop)
+  sievingTable_(sievingTable)
 { }
 
 void PrimeGenerator::init()
@@ -91,7 +98,8 @@ void PrimeGenerator::init()
   start_ = max(start_, sieving);
 
   Erat::init(start_, stop_, sieveSize, preSieve_);
-  sievingPrimes_.init(this, preSieve_);
+  enableSegmentCache();
+  sievingPrimes_.init(this, preSieve_, sievingTable_);
   isInit_ = true;
 }
 
@@ -117,7 +125,8 @@ size_t PrimeGenerator::getStopIdx() const
   return stopIdx;
 }
 
-void PrimeGenerator::init(vector<uint64_t>& primes)
+template <typename T>
+void PrimeGenerator::init(vector<T>& primes)
 {
   size_t size = primeCountApprox(start_, stop_);
   primes.reserve(size);
@@ -151,7 +160,8 @@ void PrimeGenerator::init(vector<uint64_t>& primes, size_t* size)
   init();
 }
 
-bool PrimeGenerator::sieveSegment(vector<uint64_t>& primes)
+template <typename T>
+bool PrimeGenerator::sieveSegment(vector<T>& primes)
 {
   if (!isInit_)
     init(primes);
@@ -191,6 +201,9 @@ void PrimeGenerator::sieveSegment()
   sieveIdx_ = 0;
   low_ = segmentLow_;
 
+  if (cachedSegment())
+    return;
+
   if (!prime_)
     prime_ = sievingPrimes_.next();
 
@@ -203,20 +216,48 @@ void PrimeGenerator::sieveSegment()
   Erat::sieveSegment();
 }
 
-void PrimeGenerator::fill(vector<uint64_t>& primes)
+/// Decode the primes of the next 64-bit words of the sieve
+/// array into primes (the buffer of primesieve::iterator)
+/// until it is (nearly) full.
+///
+void PrimeGenerator::fill(vector<uint64_t>& primes,
+                          size_t* size)
 {
-  while (sieveSegment(primes))
-  {
-    for (; sieveIdx_ < sieveSize_; sieveIdx_ += 8)
-    {
-      uint64_t bits = littleendian_cast<uint64_t>(&sieve_[sieveIdx_]);
+  if (sieveIdx_ >= sieveSize_)
+    if (!sieveSegment(primes, size))
+      return;
 
-      while (bits)
-        primes.push_back(nextPrime(&bits, low_));
+  *size = fillPrimes(sieve_, &sieveIdx_, sieveSize_,
+                     &low_, primes.data(), primes.size());
+}
 
-      low_ += 8 * 30;
-    }
+/// For T = uint32_t the primes are decoded using 32-bit
+/// arithmetic, which halves the memory traffic and avoids
+/// converting the primes afterwards.
+///
+template <typename T>
+void PrimeGenerator::fill(vector<T>& primes)
+{
+  assert(sizeof(T) >= sizeof(uint64_t) ||
+         stop_ <= numeric_limits<T>::max());
+
+  while (sieveSegment(primes))
+  {
+    // the last segment is padded with zero
+    // bytes to a multiple of 8 bytes
+    uint64_t words = (sieveSize_ + 7) / 8;
+    uint64_t count = popcount((const uint64_t*) sieve_, words);
+
+    // fillPrimes() needs 64 spare entries
+    size_t size = primes.size();
+    primes.resize(size + count + 64);
+    size += fillPrimes(sieve_, &sieveIdx_, sieveSize_, &low_,
+                       &primes[size], count + 64);
+    primes.resize(size);
   }
 }
 
+template void PrimeGenerator::fill<uint64_t>(vector<uint64_t>&);
+template void PrimeGenerator::fill<uint32_t>(vector<uint32_t>&);
+
 } // namespace
@@ -0,0 +1,212 @@
+///
+/// @file   PrimePartitions.cpp
+/// @brief  For [start, stop] near 10^19 with stop - start < 10^9
+///         adding the ~ 2 * 10^8 sieving primes costs much more
+///         than crossing off their few multiples, but the interval
+///         is too small to be split among the threads. Hence the
+///         sieving primes are split into pieces instead, each
+///         thread sieves the whole interval using the sieving
+///         primes of its pieces into a private bitmap. A number is
+///         prime if its bit is set in all bitmaps.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/PrimePartitions.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/Erat.hpp>
+#include <primesieve/fillPrimes.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PreSieve.hpp>
+#include <primesieve/PrintPrimes.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Iterates over the primes of the 64-bit
+/// words [first, last[ of the SievingTable
+///
+class PiecePrimes
+{
+public:
+  PiecePrimes(const SievingTable& table, uint64_t first, uint64_t last) :
+    bits_(table.data()),
+    sieveIdx_(first * 8),
+    sieveSize_(last * 8),
+    low_(first * 8 * 30)
+  { }
+
+  /// Returns ~0 once all primes have been returned
+  uint64_t next()
+  {
+    while (i_ >= size_)
+    {
+      if (sieveIdx_ >= sieveSize_)
+        return ~0ull;
+
+      i_ = 0;
+      size_ = fillPrimes(bits_, &sieveIdx_, sieveSize_, &low_,
+                         primes_, sizeof(primes_) / sizeof(primes_[0]));
+    }
+
+    return primes_[i_++];
+  }
+
+private:
+  const byte_t* bits_;
+  uint64_t sieveIdx_;
+  uint64_t sieveSize_;
+  uint64_t low_;
+  uint64_t i_ = 0;
+  uint64_t size_ = 0;
+  uint64_t primes_[256];
+};
+
+/// Sieves [start, stop] using only the sieving primes
+/// of one piece and ANDs the segments into a bitmap
+///
+class PartitionSieve : public Erat
+{
+public:
+  PartitionSieve(uint64_t start, uint64_t stop, uint64_t sieveSize)
+  {
+    Erat::init(start, stop, sieveSize, preSieve_);
+  }
+
+  void sieve(PiecePrimes& primes, vector<byte_t>& bitmap)
+  {
+    uint64_t first = segmentLow_;
+    uint64_t prime = primes.next();
+
+    // the small primes are pre-sieved
+    while (prime <= preSieve_.getMaxPrime())
+      prime = primes.next();
+
+    while (hasNextSegment())
+    {
+      uint64_t offset = (segmentLow_ - first) / 30;
+      uint64_t sqrtHigh = isqrt(segmentHigh_);
+
+      for (; prime <= sqrtHigh; prime = primes.next())
+        addSievingPrime(prime);
+
+      sieveSegment();
+
+      // the last segment is zero padded to 8 bytes
+      uint64_t bytes = ceilDiv(sieveSize_, 8) * 8;
+      if (bitmap.size() < offset + bytes)
+        bitmap.resize(offset + bytes, 0xff);
+
+      byte_t* b = &bitmap[offset];
+      for (uint64_t i = 0; i < bytes; i++)
+        b[i] &= sieve_[i];
+    }
+  }
+
+private:
+  PreSieve preSieve_;
+};
+
+} // namespace
+
+namespace primesieve {
+
+counts_t countPrimePartitions(uint64_t start,
+                              uint64_t stop,
+                              int countFlags,
+                              int sieveSize,
+                              int threads,
+                              const SievingTable& table,
+                              ThreadPool& pool,
+                              const function<void(int, uint64_t)>& progress)
+{
+  // words of the table containing the primes <= sqrt(stop)
+  uint64_t sqrtStop = isqrt(stop);
+  uint64_t words = ceilDiv((sqrtStop - 7) / 30 + 1, 8);
+  words = min(words, table.size() / 8);
+  uint64_t pieces = (uint64_t) threads * config::PRIME_PARTITIONS_PER_THREAD;
+  pieces = inBetween(1, words, pieces);
+
+  vector<vector<byte_t>> bitmaps(threads);
+  atomic<uint64_t> nextPiece(0);
+  atomic<int> nextThread(0);
+
+  // the pieces of the small sieving primes have most of
+  // the multiples, they are claimed first
+  pool.run(threads, [&]()
+  {
+    int thread = nextThread++;
+
+    for (uint64_t i = nextPiece++; i < pieces; i = nextPiece++)
+    {
+      PiecePrimes primes(table, words * i / pieces, words * (i + 1) / pieces);
+      PartitionSieve sieve(start, stop, sieveSize);
+      sieve.sieve(primes, bitmaps[thread]);
+      progress(thread, (stop - start) / pieces);
+    }
+  });
+
+  // threads without pieces have no bitmap
+  vector<const uint64_t*> used;
+  uint64_t size = 0;
+
+  for (auto& bitmap : bitmaps)
+  {
+    if (!bitmap.empty())
+    {
+      used.push_back((const uint64_t*) bitmap.data());
+      size = bitmap.size() / 8;
+    }
+  }
+
+  // combine and count the bitmaps in blocks
+  // which stay in the L1 cache
+  CountFunc countSegment = getCountFunc(countFlags);
+  const uint64_t blockSize = 1 << 10;
+  vector<counts_t> threadCounts(threads, counts_t());
+  atomic<uint64_t> nextBlock(0);
+  nextThread = 0;
+
+  pool.run(threads, [&]()
+  {
+    int thread = nextThread++;
+    counts_t& counts = threadCounts[thread];
+    vector<uint64_t> block(blockSize);
+
+    for (uint64_t i = nextBlock++ * blockSize; i < size; i = nextBlock++ * blockSize)
+    {
+      uint64_t n = min(blockSize, size - i);
+      memcpy(block.data(), &used[0][i], n * 8);
+
+      for (size_t j = 1; j < used.size(); j++)
+        for (uint64_t k = 0; k < n; k++)
+          block[k] &= used[j][i + k];
+
+      countSegment(block.data(), n, counts);
+    }
+  });
+
+  counts_t counts;
+  counts.fill(0);
+
+  for (auto& c : threadCounts)
+    for (size_t i = 0; i < counts.size(); i++)
+      counts[i] += c[i];
+
+  return counts;
+}
+
+} // namespace
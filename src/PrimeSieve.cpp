@@ -10,14 +10,30 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/ChunkScheduler.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/Histogram.hpp>
+#include <primesieve/OutputSink.hpp>
+#include <primesieve/PrimeGaps.hpp>
+#include <primesieve/PrimeSums.hpp>
+#include <primesieve/PrintFormat.hpp>
+#include <primesieve/PrintQueue.hpp>
+#include <primesieve/ResidueCounts.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/PrintPrimes.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SieveStats.hpp>
+#include <primesieve/SieveTrace.hpp>
+#include <primesieve/TupletSieve.hpp>
+#include <primesieve/Tuning.hpp>
 #include <primesieve/types.hpp>
 
 #include <stdint.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <chrono>
 #include <iostream>
 #include <string>
@@ -46,6 +62,30 @@ const array<SmallPrime, 8> smallPrimes
   { 5, 17, 4, "(5, 7, 11, 13, 17)" }
 }};
 
+/// Enables the PhaseTimers of the calling thread
+class StatsScope
+{
+public:
+  StatsScope(primesieve::SieveStats* stats) :
+    prev_(primesieve::threadStats())
+  {
+    primesieve::threadStats() = stats;
+  }
+  ~StatsScope()
+  {
+    primesieve::threadStats() = prev_;
+  }
+private:
+  primesieve::SieveStats* prev_;
+};
+
+template <int CONSUMER>
+void sievePrimes(primesieve::PrimeSieve& ps)
+{
+  primesieve::PrintPrimes<CONSUMER> printPrimes(ps);
+  printPrimes.sieve();
+}
+
 } // namespace
 
 namespace primesieve {
@@ -54,9 +94,27 @@ PrimeSieve::PrimeSieve() :
   start_(0),
   stop_(0),
   flags_(COUNT_PRIMES),
-  parent_(nullptr)
+  printFormat_(FORMAT_TEXT),
+  parent_(nullptr),
+  sievingTable_(nullptr),
+  histogram_(nullptr),
+  primeGaps_(nullptr),
+  primeSums_(nullptr),
+  residueCounts_(nullptr),
+  scheduler_(nullptr),
+  span_(-1),
+  printQueue_(nullptr),
+  printChunk_(0),
+  cancelToken_(nullptr),
+  output_(&cout),
+  progress_(nullptr),
+  stats_(nullptr),
+  trace_(nullptr),
+  traceThread_(0),
+  setupEnd_(0)
 {
   setSieveSize(get_sieve_size());
+  tuneSieveSize_ = true;
   reset();
 }
 
@@ -65,8 +123,26 @@ PrimeSieve::PrimeSieve() :
 ///
 PrimeSieve::PrimeSieve(PrimeSieve* parent) :
   sieveSize_(parent->sieveSize_),
+  tuneSieveSize_(false),
   flags_(parent->flags_),
-  parent_(parent)
+  printFormat_(parent->printFormat_),
+  parent_(parent),
+  sievingTable_(parent->sievingTable_),
+  histogram_(parent->histogram_),
+  primeGaps_(parent->primeGaps_),
+  primeSums_(parent->primeSums_),
+  residueCounts_(parent->residueCounts_),
+  scheduler_(nullptr),
+  span_(-1),
+  printQueue_(nullptr),
+  printChunk_(0),
+  cancelToken_(parent->cancelToken_),
+  output_(parent->output_),
+  progress_(nullptr),
+  stats_(parent->stats_),
+  trace_(parent->trace_),
+  traceThread_(0),
+  setupEnd_(0)
 { }
 
 PrimeSieve::~PrimeSieve()
@@ -76,7 +152,6 @@ void PrimeSieve::reset()
 {
   counts_.fill(0);
   seconds_ = 0.0;
-  toUpdate_ = 0;
   processed_ = 0;
   percent_ = -1.0;
 }
@@ -86,6 +161,11 @@ bool PrimeSieve::isParallelSieve() const
   return parent_ != nullptr;
 }
 
+bool PrimeSieve::isSpan() const
+{
+  return scheduler_ != nullptr;
+}
+
 bool PrimeSieve::isFlag(int flag) const
 {
   return (flags_ & flag) == flag;
@@ -136,6 +216,12 @@ int PrimeSieve::getSieveSize() const
   return sieveSize_;
 }
 
+/// PrimeSieve is single-threaded
+int PrimeSieve::getNumThreads() const
+{
+  return 1;
+}
+
 double PrimeSieve::getSeconds() const
 {
   return seconds_;
@@ -146,6 +232,61 @@ double PrimeSieve::getStatus() const
   return percent_;
 }
 
+const SievingTable* PrimeSieve::getSievingTable() const
+{
+  return sievingTable_;
+}
+
+Histogram* PrimeSieve::getHistogram() const
+{
+  return histogram_;
+}
+
+PrimeGaps* PrimeSieve::getPrimeGaps() const
+{
+  return primeGaps_;
+}
+
+PrimeSums* PrimeSieve::getPrimeSums() const
+{
+  return primeSums_;
+}
+
+int PrimeSieve::getPrintFormat() const
+{
+  return printFormat_;
+}
+
+ResidueCounts* PrimeSieve::getResidueCounts() const
+{
+  return residueCounts_;
+}
+
+const cancel_token* PrimeSieve::getCancelToken() const
+{
+  return cancelToken_;
+}
+
+ostream* PrimeSieve::getOutput() const
+{
+  return output_;
+}
+
+SieveStats* PrimeSieve::getSieveStats() const
+{
+  return stats_;
+}
+
+SieveTrace* PrimeSieve::getTrace() const
+{
+  return trace_;
+}
+
+int PrimeSieve::getFlags() const
+{
+  return flags_;
+}
+
 void PrimeSieve::setFlags(int flags)
 {
   flags_ = flags;
@@ -156,11 +297,135 @@ void PrimeSieve::addFlags(int flags)
   flags_ |= flags;
 }
 
+/// Use a precomputed table of sieving primes,
+/// the table must outlive sieve()
+///
+void PrimeSieve::setSievingTable(const SievingTable* sievingTable)
+{
+  sievingTable_ = sievingTable;
+}
+
+/// Additionally count the primes and prime k-tuplets
+/// of each bin, the histogram must outlive sieve()
+///
+void PrimeSieve::setHistogram(Histogram* histogram)
+{
+  histogram_ = histogram;
+}
+
+/// Additionally compute the prime gap statistics,
+/// primeGaps must outlive sieve()
+///
+void PrimeSieve::setPrimeGaps(PrimeGaps* primeGaps)
+{
+  primeGaps_ = primeGaps;
+}
+
+/// Additionally sum up the primes (and their squares),
+/// primeSums must outlive sieve()
+///
+void PrimeSieve::setPrimeSums(PrimeSums* primeSums)
+{
+  primeSums_ = primeSums;
+}
+
+/// Print the primes using a PrintFormat e.g. FORMAT_U64,
+/// prime k-tuplets are always printed as text
+///
+void PrimeSieve::setPrintFormat(int format)
+{
+  printFormat_ = format;
+}
+
+/// Additionally count the primes of each residue
+/// class mod q, residueCounts must outlive sieve()
+///
+void PrimeSieve::setResidueCounts(ResidueCounts* residueCounts)
+{
+  residueCounts_ = residueCounts;
+}
+
+/// Sieve a span of a ParallelSieve ChunkScheduler, other
+/// threads may steal the upper part of the span
+///
+void PrimeSieve::setSpan(ChunkScheduler* scheduler, int span)
+{
+  scheduler_ = scheduler;
+  span_ = span;
+}
+
+/// Print the primes of a ParallelSieve chunk, the output
+/// of the chunks is written to stdout in order
+///
+void PrimeSieve::setPrintQueue(PrintQueue* printQueue, uint64_t chunk)
+{
+  printQueue_ = printQueue;
+  printChunk_ = chunk;
+}
+
+/// Sieving stops with a primesieve_cancelled
+/// exception once the token is cancelled
+///
+void PrimeSieve::setCancelToken(const cancel_token* token)
+{
+  cancelToken_ = token;
+}
+
+/// Write the printed primes to out instead of
+/// stdout, out must outlive sieve()
+///
+void PrimeSieve::setOutput(ostream* out)
+{
+  output_ = out;
+}
+
+void PrimeSieve::setProgress(atomic<uint64_t>* progress)
+{
+  progress_ = progress;
+}
+
+/// Add the time spent in each sieving phase to stats,
+/// stats must outlive sieve()
+///
+void PrimeSieve::setSieveStats(SieveStats* stats)
+{
+  stats_ = stats;
+}
+
+/// Add the setup and sieving time of sieve() to the
+/// timeline of thread, trace must outlive sieve()
+///
+void PrimeSieve::setTrace(SieveTrace* trace, int thread)
+{
+  trace_ = trace;
+  traceThread_ = thread;
+}
+
+/// Called by PrintPrimes once Erat and the
+/// sieving primes have been initialized
+///
+void PrimeSieve::traceSetupDone()
+{
+  if (trace_)
+    setupEnd_ = trace_->now();
+}
+
 /// Set the size of the sieve array in KiB (kibibyte)
 void PrimeSieve::setSieveSize(int sieveSize)
 {
-  sieveSize_ = inBetween(8, sieveSize, 4096);
-  sieveSize_ = floorPow2(sieveSize_);
+  sieveSize_ = inBetween(8, sieveSize, (int) config::MAX_SIEVE_SIZE);
+  tuneSieveSize_ = false;
+}
+
+/// Without a user specified sieve size, use the
+/// sieve size measured by primesieve --autotune
+/// for the band of the stop number.
+/// @threads: Number of threads sieving concurrently.
+///
+void PrimeSieve::tuneSieveSize(int threads)
+{
+  if (tuneSieveSize_)
+    sieveSize_ = tunedSieveSize(start_, stop_, threads);
 }
 
 /// Set a start number (lower bound) for sieving
@@ -175,16 +440,21 @@ void PrimeSieve::setStop(uint64_t stop)
   stop_ = stop;
 }
 
-/// Print status in percent to stdout.
+/// Print status in percent to stdout. The threads of a
+/// ParallelSieve only increase their progress counter, the
+/// counters are summed up by ParallelSieve's status thread.
 /// @processed:  Sum of recently processed segments
 ///
-bool PrimeSieve::updateStatus(uint64_t processed, bool tryLock)
+void PrimeSieve::updateStatus(uint64_t processed)
 {
   if (isParallelSieve())
   {
-    toUpdate_ += processed;
-    if (parent_->updateStatus(toUpdate_, tryLock))
-      toUpdate_ = 0;
+    if (progress_)
+    {
+      // we are the only writer, no atomic add needed
+      uint64_t n = progress_->load(memory_order_relaxed);
+      progress_->store(n + processed, memory_order_relaxed);
+    }
   }
   else
   {
@@ -197,7 +467,34 @@ bool PrimeSieve::updateStatus(uint64_t processed, bool tryLock)
     if (isFlag(PRINT_STATUS))
       printStatus(old, percent_);
   }
-  return true;
+}
+
+/// Claim the numbers <= high for sieving
+/// @return The (possibly decreased) stop number
+///
+uint64_t PrimeSieve::claimSpan(uint64_t high)
+{
+  if (scheduler_)
+    stop_ = scheduler_->claim(span_, high);
+
+  return stop_;
+}
+
+/// Write printed primes to the output stream
+void PrimeSieve::write(const char* data, size_t size)
+{
+  if (printQueue_)
+    printQueue_->write(printChunk_, data, size);
+  else
+    outputStream(output_).write(data, size);
+}
+
+/// Called after each sieved segment
+void PrimeSieve::checkCancelled() const
+{
+  if (cancelToken_ &&
+      cancelToken_->is_cancelled())
+    throw primesieve_cancelled();
 }
 
 void PrimeSieve::printStatus(double old, double current)
@@ -214,14 +511,49 @@ void PrimeSieve::printStatus(double old, double current)
 /// Process small primes <= 5 and small k-tuplets <= 17
 void PrimeSieve::processSmallPrimes()
 {
+  if (primeGaps_)
+  {
+    PrimeGaps::Run run;
+    for (uint64_t prime : { 2, 3, 5 })
+      if (prime >= start_ && prime <= stop_)
+        run.add(prime);
+    primeGaps_->merge(run);
+  }
+
+  if (residueCounts_)
+    for (uint64_t prime : { 2, 3, 5 })
+      if (prime >= start_ && prime <= stop_)
+        residueCounts_->addPrime(prime);
+
+  if (primeSums_)
+    for (uint64_t prime : { 2, 3, 5 })
+      if (prime >= start_ && prime <= stop_)
+        primeSums_->addPrime(prime);
+
+  uint64_t prevPrime = 0;
+
   for (auto& p : smallPrimes)
   {
     if (p.first >= start_ && p.last <= stop_)
     {
       if (isCount(p.index))
+      {
         counts_[p.index]++;
+        if (histogram_)
+          histogram_->add(histogram_->bin(p.first), p.index, 1);
+      }
       if (isPrint(p.index))
-        cout << p.str << '\n';
+      {
+        string line = p.str + '\n';
+        if (p.index == 0 && printFormat_ != FORMAT_TEXT)
+        {
+          char buffer[32];
+          char* end = encodePrime(printFormat_, p.first, prevPrime, buffer);
+          line.assign(buffer, end);
+          prevPrime = p.first;
+        }
+        write(line.data(), line.size());
+      }
     }
   }
 }
@@ -257,7 +589,14 @@ void PrimeSieve::sieve()
   if (start_ > stop_)
     return;
 
+  checkCancelled();
+  tuneSieveSize();
   auto t1 = chrono::system_clock::now();
+  SieveStats stats;
+  stats.hw = stats_ && stats_->hw;
+  StatsScope scope(stats_ ? &stats : nullptr);
+  double traceStart = trace_ ? trace_->now() : 0;
+  setupEnd_ = 0;
   int initStatus = 0;
   int finishStatus = 10;
 
@@ -267,18 +606,65 @@ void PrimeSieve::sieve()
   if (start_ <= 5)
     processSmallPrimes();
 
-  if (stop_ >= 7)
+  if (TupletSieve::isSupported(*this))
   {
-    PrintPrimes printPrimes(*this);
-    printPrimes.sieve();
+    TupletSieve tupletSieve(*this);
+    tupletSieve.sieve();
   }
+  else if (stop_ >= 7)
+  {
+    // pick the PrintPrimes instantiation once
+    switch (getConsumer(*this))
+    {
+      case 0: sievePrimes<0>(*this); break;
+      case 1: sievePrimes<1>(*this); break;
+      case 2: sievePrimes<2>(*this); break;
+      case 3: sievePrimes<3>(*this); break;
+      case 4: sievePrimes<4>(*this); break;
+      case 5: sievePrimes<5>(*this); break;
+      case 6: sievePrimes<6>(*this); break;
+      case 7: sievePrimes<7>(*this); break;
+      case 8: sievePrimes<8>(*this); break;
+      case 9: sievePrimes<9>(*this); break;
+      case 10: sievePrimes<10>(*this); break;
+      case 11: sievePrimes<11>(*this); break;
+      case 12: sievePrimes<12>(*this); break;
+      case 13: sievePrimes<13>(*this); break;
+      case 14: sievePrimes<14>(*this); break;
+      case 15: sievePrimes<15>(*this); break;
+    }
+  }
+
+  if (primeGaps_ && !isParallelSieve())
+    primeGaps_->finish();
+
+  // text printed after the primes must follow them
+  if (isPrint() && !parent_ && !printQueue_)
+    outputStream(output_).flush();
 
   auto t2 = chrono::system_clock::now();
   chrono::duration<double> seconds = t2 - t1;
   seconds_ = seconds.count();
 
+  if (stats_)
+  {
+    stats.busy = seconds_;
+    stats_->add(stats);
+  }
+
+  if (trace_)
+  {
+    double traceEnd = trace_->now();
+    if (setupEnd_ > 0)
+    {
+      trace_->add({ "setup", traceThread_, traceStart, setupEnd_, start_, stop_ });
+      traceStart = setupEnd_;
+    }
+    trace_->add({ "sieve", traceThread_, traceStart, traceEnd, start_, stop_ });
+  }
+
   if (isStatus())
-    updateStatus(finishStatus, false);
+    updateStatus(finishStatus);
 }
 
 } // namespace
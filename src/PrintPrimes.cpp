@@ -11,25 +11,100 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/Counters.hpp>
+#include <primesieve/Histogram.hpp>
+#include <primesieve/kernels.hpp>
 #include <primesieve/littleendian_cast.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/PreSieve.hpp>
+#include <primesieve/PrintFormat.hpp>
 #include <primesieve/PrintPrimes.hpp>
 #include <primesieve/PrimeSieve.hpp>
+#include <primesieve/PrimeSums.hpp>
+#include <primesieve/ResidueCounts.hpp>
+#include <primesieve/SieveStats.hpp>
 #include <primesieve/Erat.hpp>
 #include <primesieve/SievingPrimes.hpp>
 #include <primesieve/types.hpp>
 
 #include <stdint.h>
 #include <algorithm>
-#include <iostream>
-#include <sstream>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && \
+    defined(__aarch64__)
+  #define MATCH_NEON
+  #include <arm_neon.h>
+#endif
 
 using namespace std;
+using namespace primesieve;
 
-namespace primesieve {
+namespace {
+
+/// Number of bytes of words[0...n] that contain all 1 bits
+/// of mask (a byte bitmask replicated to all 8 bytes).
+/// Uses only bitwise operations (SWAR) hence the compiler
+/// vectorizes the loop. Each word adds at most 1 per byte
+/// lane, so n must be < 256.
+///
+uint64_t countMatchesSWAR(const uint64_t* words, uint64_t n, uint64_t mask)
+{
+  const uint64_t ones = 0x0101010101010101ull;
+  const uint64_t low7 = 0x7f7f7f7f7f7f7f7full;
+  uint64_t sum = 0;
+
+  for (uint64_t i = 0; i < n; i++)
+  {
+    // byte is zero <==> byte matches mask
+    uint64_t t = ~words[i] & mask;
+    // high bit of each byte set <==> byte is non zero
+    uint64_t y = ((t & low7) + low7) | t;
+    sum += (~y >> 7) & ones;
+  }
+
+  // add up the byte lanes (each <= n)
+  const uint64_t m16 = 0x00ff00ff00ff00ffull;
+  sum = (sum & m16) + ((sum >> 8) & m16);
+  return (sum * 0x0001000100010001ull) >> 48;
+}
+
+#if defined(MATCH_NEON)
+
+/// NEON is part of the aarch64 base instruction set. CMEQ
+/// sets each matching byte to 0xff (-1), subtracting it
+/// adds 1 to the byte lane (each <= n / 2).
+///
+uint64_t countMatchesNEON(const uint64_t* words, uint64_t n, uint64_t mask)
+{
+  uint8x16_t m = vreinterpretq_u8_u64(vdupq_n_u64(mask));
+  uint8x16_t sum = vdupq_n_u8(0);
+  uint64_t i = 0;
+
+  for (; i + 2 <= n; i += 2)
+  {
+    uint8x16_t v = vld1q_u8((const uint8_t*) &words[i]);
+    sum = vsubq_u8(sum, vceqq_u8(vandq_u8(v, m), m));
+  }
+
+  return vaddlvq_u8(sum) + countMatchesSWAR(&words[i], n - i, mask);
+}
+
+#endif
 
-const uint64_t PrintPrimes::bitmasks_[6][5] =
+inline uint64_t countMatches(const uint64_t* words, uint64_t n, uint64_t mask)
+{
+#if defined(MATCH_NEON)
+  return countMatchesNEON(words, n, mask);
+#else
+  return countMatchesSWAR(words, n, mask);
+#endif
+}
+
+const uint64_t END = 0xff + 1;
+
+const uint64_t bitmasks[6][5] =
 {
   { END },
   { 0x06, 0x18, 0xc0, END },       // Twin primes:       b00000110, b00011000, b11000000
@@ -39,136 +114,621 @@ const uint64_t PrintPrimes::bitmasks_[6][5] =
   { 0x3f, END }                    // Prime sextuplets
 };
 
-PrintPrimes::PrintPrimes(PrimeSieve& ps) :
-  preSieve_(ps.getStart(), ps.getStop()),
-  counts_(ps.getCounts()),
-  ps_(ps)
+/// Number of bytes of words[0...n] that contain
+/// one of the bitmasks of a prime k-tuplet type
+///
+uint64_t countTuplets(const uint64_t* words, uint64_t n, const uint64_t* masks)
 {
-  uint64_t start = max<uint64_t>(7, ps.getStart());
-  uint64_t stop = ps.getStop();
-  uint64_t sieveSize = ps.getSieveSize();
+  uint64_t count = 0;
+  for (const uint64_t* b = masks; *b != END; b++)
+    count += countMatches(words, n, *b * 0x0101010101010101ull);
+  return count;
+}
 
-  Erat::init(start, stop, sieveSize, preSieve_);
+/// Count the primes and prime k-tuplets of a segment, FLAGS
+/// is the combination of the requested COUNT_* flags. All
+/// counts are computed in a single pass, the sieve array is
+/// processed in small blocks that stay in the L1 cache.
+///
+template <int FLAGS>
+void countSegment(const uint64_t* words, uint64_t size, counts_t& counts)
+{
+  // counting only primes needs no blocking
+  uint64_t blockSize = (FLAGS & ~COUNT_PRIMES) ? 128 : size;
 
-  if (ps_.isCountkTuplets())
-    initCounts();
+  for (uint64_t j = 0; j < size; j += blockSize)
+  {
+    uint64_t n = min(blockSize, size - j);
+    const uint64_t* block = &words[j];
+
+    if (FLAGS & COUNT_PRIMES)
+      counts[0] += popcount(block, n);
+    if (FLAGS & COUNT_TWINS)
+      counts[1] += countTuplets(block, n, bitmasks[1]);
+    if (FLAGS & COUNT_TRIPLETS)
+      counts[2] += countTuplets(block, n, bitmasks[2]);
+    if (FLAGS & COUNT_QUADRUPLETS)
+      counts[3] += countTuplets(block, n, bitmasks[3]);
+    if (FLAGS & COUNT_QUINTUPLETS)
+      counts[4] += countTuplets(block, n, bitmasks[4]);
+    if (FLAGS & COUNT_SEXTUPLETS)
+      counts[5] += countTuplets(block, n, bitmasks[5]);
+  }
 }
 
-/// Initialize the lookup tables to count the number
-/// of twins, triplets, ... per byte
+/// Bits of a sieve byte whose number (minus 30 * byte
+/// index) is >= r (bitsFrom) or <= r (bitsUpTo)
 ///
-void PrintPrimes::initCounts()
+const uint8_t bitsFrom[32] =
 {
-  for (uint_t i = 1; i < counts_.size(); i++)
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe, 0xfe, 0xfe,
+  0xfe, 0xfc, 0xfc, 0xf8, 0xf8, 0xf8, 0xf8, 0xf0, 0xf0, 0xe0, 0xe0,
+  0xe0, 0xe0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0xc0, 0x80, 0x80
+};
+
+const uint8_t bitsUpTo[32] =
+{
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, 0x01, 0x01, 0x01,
+  0x03, 0x03, 0x07, 0x07, 0x07, 0x07, 0x0f, 0x0f, 0x1f, 0x1f, 0x1f,
+  0x1f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x7f, 0x7f, 0xff
+};
+
+const uint64_t bitValues[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+
+/// Spreads the 8 bits of a sieve byte into the 8
+/// byte lanes of a 64-bit word, bit i -> byte i
+///
+struct ExpandTable
+{
+  uint64_t bytes[256];
+
+  ExpandTable()
   {
-    if (!ps_.isCount(i))
-      continue;
+    for (uint64_t byte = 0; byte < 256; byte++)
+    {
+      bytes[byte] = 0;
+      for (int i = 0; i < 8; i++)
+        if (byte & (1ull << i))
+          bytes[byte] |= 1ull << (i * 8);
+    }
+  }
+};
+
+const ExpandTable expandTable;
 
-    kCounts_[i].resize(256);
+/// Number of bits, sum of the bit values and sum
+/// of the squared bit values of each sieve byte
+///
+struct SumTable
+{
+  uint8_t counts[256];
+  uint16_t sums[256];
+  uint16_t squares[256];
 
-    for (uint64_t j = 0; j < 256; j++)
+  SumTable()
+  {
+    for (int byte = 0; byte < 256; byte++)
     {
-      byte_t count = 0;
-      for (const uint64_t* b = bitmasks_[i]; *b <= j; b++)
+      counts[byte] = 0;
+      sums[byte] = 0;
+      squares[byte] = 0;
+
+      for (int i = 0; i < 8; i++)
       {
-        if ((j & *b) == *b)
-          count++;
+        if (byte & (1 << i))
+        {
+          counts[byte] += 1;
+          sums[byte] += (uint16_t) bitValues[i];
+          squares[byte] += (uint16_t) (bitValues[i] * bitValues[i]);
+        }
       }
-      kCounts_[i][j] = count;
     }
   }
+};
+
+const SumTable sumTable;
+
+uint64_t gcd(uint64_t a, uint64_t b)
+{
+  while (b)
+  {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/// Upper bound of the output of 8 sieve bytes e.g.
+/// 64 primes * (20 digits + newline) or 8 bytes
+/// with 4 prime triplets each
+///
+const size_t MAX_PRINT_BYTES = 64 * 21 + 8 * 6 * 23;
+
+/// Table of all 64 COUNT_* flag combinations
+template <int FLAGS>
+struct CountTable
+{
+  static void init(CountFunc* table)
+  {
+    table[FLAGS] = countSegment<FLAGS>;
+    CountTable<FLAGS - 1>::init(table);
+  }
+};
+
+template <>
+struct CountTable<-1>
+{
+  static void init(CountFunc*) { }
+};
+
+} // namespace
+
+namespace primesieve {
+
+CountFunc getCountFunc(int flags)
+{
+  static CountFunc table[64];
+  static bool init = (CountTable<63>::init(table), true);
+  (void) init;
+
+  return table[flags & 63];
 }
 
-void PrintPrimes::sieve()
+/// The kernel used by countTuplets() is last
+vector<Kernel<CountMatchesFunc>> getCountMatchesKernels()
 {
-  SievingPrimes sievingPrimes(this, preSieve_);
-  uint64_t prime = sievingPrimes.next();
+  vector<Kernel<CountMatchesFunc>> kernels;
+  kernels.push_back({ "SWAR", countMatchesSWAR });
+#if defined(MATCH_NEON)
+  kernels.push_back({ "NEON", countMatchesNEON });
+#endif
+  return kernels;
+}
+
+int getConsumer(const PrimeSieve& ps)
+{
+  int consumer = 0;
+
+  if (ps.isCountPrimes() ||
+      ps.isCountkTuplets() ||
+      ps.getResidueCounts() ||
+      ps.getPrimeSums())
+    consumer |= CONSUME_COUNTS;
+  if (ps.isPrintPrimes())
+    consumer |= CONSUME_PRIMES;
+  if (ps.isPrintkTuplets())
+    consumer |= CONSUME_KTUPLETS;
+  if (ps.getPrimeGaps())
+    consumer |= CONSUME_GAPS;
+
+  return consumer;
+}
+
+template <int CONSUMER>
+PrintPrimes<CONSUMER>::PrintPrimes(PrimeSieve& ps) :
+  isStatus_(ps.isStatus()),
+  counts_(ps.getCounts()),
+  ps_(ps)
+{
+  uint64_t start = max<uint64_t>(7, ps.getStart());
+  uint64_t stop = ps.getStop();
+  uint64_t sieveSize = ps.getSieveSize();
+
+  Erat::init(start, stop, sieveSize, preSieve_);
+  enableSegmentCache();
+
+  int flags = 0;
+  for (uint_t i = 0; i < counts_.size(); i++)
+    if (ps_.isCount(i))
+      flags |= COUNT_PRIMES << i;
+
+  if (flags)
+    countSegment_ = getCountFunc(flags);
+
+  countFlags_ = flags;
+
+  if (ps.getResidueCounts())
+  {
+    // the residue of byte i mod q depends only on i mod period
+    uint64_t q = ps.getResidueCounts()->modulus();
+    period_ = q / gcd(q, 30);
+    residues_.resize((size_t) q, 0);
+  }
+
+  if (CONSUMER & (CONSUME_PRIMES | CONSUME_KTUPLETS))
+    printBuffer_.resize(1 << 20);
+
+  // the small primes have been printed by PrimeSieve
+  if (CONSUMER & CONSUME_PRIMES)
+    for (uint64_t prime : { 2, 3, 5 })
+      if (prime >= ps.getStart() && prime <= stop)
+        prevPrime_ = prime;
+}
+
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::sieve()
+{
+  SievingPrimes sievingPrimes;
+  uint64_t prime;
+
+  {
+    PhaseTimer timer(PHASE_SIEVING_PRIMES);
+    sievingPrimes.init(this, preSieve_, ps_.getSievingTable());
+    prime = sievingPrimes.next();
+  }
+
+  ps_.traceSetupDone();
 
   while (hasNextSegment())
   {
+    // other threads may steal the upper
+    // part of our ParallelSieve span
+    if (ps_.isSpan())
+      setStop(ps_.claimSpan(segmentHigh_));
+
     low_ = segmentLow_;
-    uint64_t sqrtHigh = isqrt(segmentHigh_);
 
-    for (; prime <= sqrtHigh; prime = sievingPrimes.next())
-      addSievingPrime(prime);
+    if (!cachedSegment())
+    {
+      uint64_t sqrtHigh = isqrt(segmentHigh_);
+
+      if (prime <= sqrtHigh)
+      {
+        PhaseTimer timer(PHASE_SIEVING_PRIMES);
+        // the first segment of a span near 1e18 adds
+        // ~5e7 sieving primes, check the token in between
+        for (uint64_t i = 1; prime <= sqrtHigh; prime = sievingPrimes.next(), i++)
+        {
+          addSievingPrime(prime);
+          if (i % (1 << 16) == 0)
+            ps_.checkCancelled();
+        }
+      }
+
+      sieveSegment();
+    }
+
+    {
+      PRIMESIEVE_COUNT(COUNTER_SEGMENTS_CONSUMED, 1);
+      PhaseTimer timer(PHASE_CONSUME);
+      print();
+    }
 
-    sieveSegment();
-    print();
+    ps_.checkCancelled();
   }
+
+  if (CONSUMER & CONSUME_GAPS)
+    ps_.getPrimeGaps()->merge(gaps_);
+  if ((CONSUMER & CONSUME_COUNTS) && !residues_.empty())
+    ps_.getResidueCounts()->add(residues_);
+  if ((CONSUMER & CONSUME_COUNTS) && ps_.getPrimeSums())
+    ps_.getPrimeSums()->add(primeSum_, squareSum_);
 }
 
 /// Executed after each sieved segment
-void PrintPrimes::print()
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::print()
 {
-  if (ps_.isCountPrimes())
-    countPrimes();
-  if (ps_.isCountkTuplets())
-    countkTuplets();
-  if (ps_.isPrintPrimes())
+  if ((CONSUMER & CONSUME_COUNTS) && countSegment_)
+  {
+    if (ps_.getHistogram())
+      countBins();
+    else
+      countSegment_((const uint64_t*) sieve_, ceilDiv(sieveSize_, 8), counts_);
+  }
+  if ((CONSUMER & CONSUME_COUNTS) && !residues_.empty())
+    countResidues();
+  if ((CONSUMER & CONSUME_COUNTS) && ps_.getPrimeSums())
+    sumPrimes();
+  if (CONSUMER & CONSUME_PRIMES)
     printPrimes();
-  if (ps_.isPrintkTuplets())
+  if (CONSUMER & CONSUME_KTUPLETS)
     printkTuplets();
+  if (CONSUMER & CONSUME_GAPS)
+    addGaps();
 
-  if (ps_.isStatus())
+  if (isStatus_)
     ps_.updateStatus(sieveSize_ * 30);
 }
 
-void PrintPrimes::countPrimes()
+/// Count the primes and prime k-tuplets of each histogram
+/// bin that overlaps the current segment. A prime k-tuplet
+/// belongs to the bin of its smallest prime.
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::countBins()
 {
-  uint64_t size = ceilDiv(sieveSize_, 8);
-  counts_[0] += popcount((const uint64_t*) sieve_, size);
+  Histogram& histogram = *ps_.getHistogram();
+  uint64_t first = max(low_ + 7, histogram.getStart());
+  uint64_t last = histogram.getStop();
+
+  // largest number of the segment, may be > 2^64
+  if (last - low_ > sieveSize_ * 30 + 1)
+    last = low_ + sieveSize_ * 30 + 1;
+
+  if (first > last)
+    return;
+
+  uint64_t lastBin = histogram.bin(last);
+
+  for (uint64_t i = histogram.bin(first); i <= lastBin; i++)
+  {
+    uint64_t a = max(first, histogram.binLow(i));
+    uint64_t b = min(last, histogram.binHigh(i));
+    counts_t counts;
+    counts.fill(0);
+    countRange(a, b, counts);
+
+    for (int k = 0; k < 6; k++)
+    {
+      if (counts[k])
+      {
+        histogram.add(i, k, counts[k]);
+        counts_[k] += counts[k];
+      }
+    }
+  }
 }
 
-void PrintPrimes::countkTuplets()
+/// Count the primes and prime k-tuplets whose smallest
+/// prime is inside [a, b]. The whole words of the sieve
+/// array are counted using countSegment_, only the bytes
+/// at the edges of [a, b] are counted bit by bit.
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::countRange(uint64_t a,
+                                       uint64_t b,
+                                       counts_t& counts) const
 {
-  // i = 1 twins, i = 2 triplets, ...
-  for (uint_t i = 1; i < counts_.size(); i++)
+  // byte i contains the numbers [low + i * 30 + 7, low + i * 30 + 31]
+  uint64_t i = (a - low_ - 2) / 30;
+  uint64_t j = (b - low_ - 2) / 30 + 1;
+
+  auto countByte = [&](uint64_t k)
+  {
+    uint64_t low = low_ + k * 30;
+    uint64_t bits = 0xff;
+    if (a > low)
+      bits &= bitsFrom[a - low];
+    if (b - low < 31)
+      bits &= bitsUpTo[b - low];
+
+    uint64_t byte = sieve_[k];
+    if (countFlags_ & COUNT_PRIMES)
+      for (uint64_t x = byte & bits; x; x &= x - 1)
+        counts[0]++;
+
+    for (int t = 1; t < 6; t++)
+      if (countFlags_ & (COUNT_PRIMES << t))
+        for (const uint64_t* mask = bitmasks[t]; *mask != END; mask++)
+          counts[t] += ((byte & *mask) == *mask) && (*mask & (0 - *mask) & bits);
+  };
+
+  // whole words inside [i + 1, j - 1[
+  uint64_t w1 = (i + 1 + 7) / 8 * 8;
+  uint64_t w2 = (j - 1) / 8 * 8;
+
+  if (w1 >= w2)
+  {
+    for (uint64_t k = i; k < j; k++)
+      countByte(k);
+  }
+  else
+  {
+    for (uint64_t k = i; k < w1; k++)
+      countByte(k);
+
+    countSegment_((const uint64_t*) &sieve_[w1], (w2 - w1) / 8, counts);
+
+    for (uint64_t k = w2; k < j; k++)
+      countByte(k);
+  }
+}
+
+/// Count the primes of the current segment in each residue
+/// class mod q. The numbers of byte i are congruent to the
+/// numbers of byte i + period (mod q), hence it suffices to
+/// sum up the bits of the bytes with the same i % period
+/// which is done for 8 bits at once using expandTable.
+/// If q is large the primes are counted one by one.
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::countResidues()
+{
+  uint64_t q = residues_.size();
+
+  if (period_ * 8 > sieveSize_)
+  {
+    uint64_t low = low_;
+    for (uint64_t i = 0; i < sieveSize_; i += 8)
+    {
+      uint64_t bits = littleendian_cast<uint64_t>(&sieve_[i]);
+      while (bits)
+        residues_[nextPrime(&bits, low) % q]++;
+
+      low += 8 * 30;
+    }
+    return;
+  }
+
+  residueSums_.resize(period_, 0);
+  uint64_t* sums = residueSums_.data();
+  uint64_t i = 0;
+
+  while (i < sieveSize_)
+  {
+    // each byte lane of sums[j] must be <= 255
+    uint64_t end = min(i + period_ * 255, sieveSize_);
+    for (uint64_t j = 0; i < end; i++)
+    {
+      sums[j] += expandTable.bytes[sieve_[i]];
+      if (++j == period_)
+        j = 0;
+    }
+
+    addResidueSums(q);
+  }
+}
+
+/// Add the per bit counts of residueSums_ to residues_
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::addResidueSums(uint64_t q)
+{
+  // residue of the bytes j % period_
+  uint64_t r = low_ % q;
+
+  for (uint64_t j = 0; j < period_; j++)
   {
-    if (!ps_.isCount(i))
-      continue;
+    uint64_t sum = residueSums_[j];
+    residueSums_[j] = 0;
+
+    for (int bit = 0; sum; bit++, sum >>= 8)
+      residues_[(r + bitValues[bit]) % q] += sum & 0xff;
+
+    r = (r + 30) % q;
+  }
+}
+
+/// Sum up the primes (and their squares) of the current
+/// segment. The segment is processed in blocks, the primes
+/// of a block are base + d with d < 2^17 so that the sums of
+/// d and d^2 fit into 64 bits. They are computed using the
+/// per byte sums of sumTable and then added to the 128-bit
+/// accumulators i.e. sum += count * base + sum(d).
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::sumPrimes()
+{
+  const uint64_t blockSize = 1 << 12;
+  bool isSquares = ps_.getPrimeSums()->isSquares();
 
+  for (uint64_t j = 0; j < sieveSize_; j += blockSize)
+  {
+    uint64_t n = min(blockSize, sieveSize_ - j);
+    const byte_t* block = &sieve_[j];
+    uint64_t count = 0;
     uint64_t sum = 0;
+    uint64_t squares = 0;
 
-    for (uint64_t j = 0; j < sieveSize_; j += 4)
+    if (!isSquares)
     {
-      sum += kCounts_[i][sieve_[j+0]];
-      sum += kCounts_[i][sieve_[j+1]];
-      sum += kCounts_[i][sieve_[j+2]];
-      sum += kCounts_[i][sieve_[j+3]];
+      for (uint64_t k = 0; k < n; k++)
+      {
+        uint64_t c = sumTable.counts[block[k]];
+        count += c;
+        sum += c * (k * 30) + sumTable.sums[block[k]];
+      }
+    }
+    else
+    {
+      for (uint64_t k = 0; k < n; k++)
+      {
+        uint64_t c = sumTable.counts[block[k]];
+        uint64_t s = sumTable.sums[block[k]];
+        uint64_t d = k * 30;
+        count += c;
+        sum += c * d + s;
+        // (d + v)^2 = d^2 + 2dv + v^2
+        squares += c * d * d + 2 * d * s + sumTable.squares[block[k]];
+      }
     }
 
-    counts_[i] += sum;
+    uint64_t base = low_ + j * 30;
+    add128(primeSum_, mul128(count, base));
+    add128(primeSum_, sum);
+
+    if (isSquares)
+    {
+      // (base + d)^2 = count * base^2 + 2 * base * sum(d) + sum(d^2)
+      uint128 x;
+      bool ok = mul128(mul128(base, base), count, x);
+      ok = ok && add128(x, mul128(base, sum * 2));
+      ok = ok && add128(x, squares);
+      ok = ok && add128(squareSum_, x);
+      if (!ok)
+        throw primesieve_error("sum of prime squares >= 2^128");
+    }
   }
 }
 
-/// Print primes to stdout
-void PrintPrimes::printPrimes() const
+/// Write the formatted primes to stdout if
+/// the print buffer is (nearly) full
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::flush(char*& pos)
 {
-  uint64_t i = 0;
+  char* buffer = printBuffer_.data();
+  if (pos + MAX_PRINT_BYTES > buffer + printBuffer_.size())
+  {
+    ps_.write(buffer, pos - buffer);
+    pos = buffer;
+  }
+}
+
+/// Print primes to stdout, the primes are converted
+/// to decimal using toChars() or encoded using the
+/// binary PrintFormat of PrimeSieve
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::printPrimes()
+{
+  char* pos = printBuffer_.data();
   uint64_t low = low_;
+  int format = ps_.getPrintFormat();
 
-  while (i < sieveSize_)
+  for (uint64_t i = 0; i < sieveSize_; i += 8)
   {
-    uint64_t size = min(i + (1 << 16), sieveSize_);
-    ostringstream primes;
+    uint64_t bits = littleendian_cast<uint64_t>(&sieve_[i]);
 
-    for (; i < size; i += 8)
+    if (format == FORMAT_TEXT)
     {
-      uint64_t bits = littleendian_cast<uint64_t>(&sieve_[i]);
       while (bits)
-        primes << nextPrime(&bits, low) << '\n';
-
-      low += 8 * 30;
+      {
+        pos = toChars(nextPrime(&bits, low), pos);
+        *pos++ = '\n';
+      }
+    }
+    else
+    {
+      while (bits)
+      {
+        uint64_t prime = nextPrime(&bits, low);
+        pos = encodePrime(format, prime, prevPrime_, pos);
+        prevPrime_ = prime;
+      }
     }
 
-    cout << primes.str();
+    low += 8 * 30;
+    flush(pos);
+  }
+
+  ps_.write(printBuffer_.data(), pos - printBuffer_.data());
+}
+
+/// Add the gaps of the current segment, the gap between
+/// the previous segment and this one is also added
+///
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::addGaps()
+{
+  uint64_t low = low_;
+
+  for (uint64_t i = 0; i < sieveSize_; i += 8)
+  {
+    uint64_t bits = littleendian_cast<uint64_t>(&sieve_[i]);
+    while (bits)
+      gaps_.add(nextPrime(&bits, low));
+
+    low += 8 * 30;
   }
 }
 
 /// Print prime k-tuplets to stdout
-void PrintPrimes::printkTuplets() const
+template <int CONSUMER>
+void PrintPrimes<CONSUMER>::printkTuplets()
 {
-  ostringstream kTuplets;
+  char* pos = printBuffer_.data();
   // i = 1 twins, i = 2 triplets, ...
   uint_t i = 1;
   uint64_t low = low_;
@@ -177,22 +737,48 @@ void PrintPrimes::printkTuplets() const
 
   for (uint64_t j = 0; j < sieveSize_; j++, low += 30)
   {
-    for (const uint64_t* bitmask = bitmasks_[i]; *bitmask <= sieve_[j]; bitmask++)
+    for (const uint64_t* bitmask = bitmasks[i]; *bitmask <= sieve_[j]; bitmask++)
     {
       if ((sieve_[j] & *bitmask) == *bitmask)
       {
-        kTuplets << "(";
+        *pos++ = '(';
         uint64_t bits = *bitmask;
         while (bits != 0)
         {
-          kTuplets << nextPrime(&bits, low);
-          kTuplets << ((bits != 0) ? ", " : ")\n");
+          pos = toChars(nextPrime(&bits, low), pos);
+          if (bits != 0)
+          {
+            memcpy(pos, ", ", 2);
+            pos += 2;
+          }
         }
+        memcpy(pos, ")\n", 2);
+        pos += 2;
       }
     }
+
+    if (j % 8 == 7)
+      flush(pos);
   }
 
-  cout << kTuplets.str();
+  ps_.write(printBuffer_.data(), pos - printBuffer_.data());
 }
 
+template class PrintPrimes<0>;
+template class PrintPrimes<1>;
+template class PrintPrimes<2>;
+template class PrintPrimes<3>;
+template class PrintPrimes<4>;
+template class PrintPrimes<5>;
+template class PrintPrimes<6>;
+template class PrintPrimes<7>;
+template class PrintPrimes<8>;
+template class PrintPrimes<9>;
+template class PrintPrimes<10>;
+template class PrintPrimes<11>;
+template class PrintPrimes<12>;
+template class PrintPrimes<13>;
+template class PrintPrimes<14>;
+template class PrintPrimes<15>;
+
 } // namespace
@@ -0,0 +1,119 @@
+///
+/// @file   PrintQueue.cpp
+/// @brief  Ordered output of the chunks that are sieved by
+///         ParallelSieve's threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/PrintQueue.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <mutex>
+
+using namespace std;
+
+namespace primesieve {
+
+PrintQueue::PrintQueue(uint64_t start,
+                       uint64_t stop,
+                       uint64_t chunkDist,
+                       int window,
+                       ostream& out) :
+  start_(start),
+  stop_(stop),
+  chunkDist_(max<uint64_t>(chunkDist, 100)),
+  chunks_(0),
+  window_(max(window, 1)),
+  out_(out)
+{
+  if (start <= stop)
+    chunks_ = (stop - start) / chunkDist_ + 1;
+}
+
+/// Align n to modulo (30 + 2) to prevent prime k-tuplet
+/// (twin primes, prime triplets) gaps
+///
+uint64_t PrintQueue::align(uint64_t n) const
+{
+  uint64_t n32 = checkedAdd(n, 32);
+
+  if (n32 >= stop_)
+    return stop_;
+
+  return n32 - n % 30;
+}
+
+bool PrintQueue::next(uint64_t* chunk, uint64_t* low, uint64_t* high)
+{
+  unique_lock<mutex> lock(mutex_);
+
+  // the thread that sieves the head chunk never waits
+  cond_.wait(lock, [&]() {
+    return aborted_ ||
+           next_ >= chunks_ ||
+           next_ < head_ + window_;
+  });
+
+  if (aborted_ || next_ >= chunks_)
+    return false;
+
+  uint64_t i = next_++;
+  *chunk = i;
+  *low = (i == 0) ? start_ : align(start_ + chunkDist_ * i) + 1;
+  *high = (i + 1 == chunks_) ? stop_ : align(start_ + chunkDist_ * (i + 1));
+
+  return true;
+}
+
+void PrintQueue::write(uint64_t chunk, const char* data, size_t size)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if (chunk == head_)
+    out_.write(data, size);
+  else
+    buffers_[chunk].append(data, size);
+}
+
+void PrintQueue::finish(uint64_t chunk)
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    finished_.insert(chunk);
+
+    // print the buffered output of the
+    // following chunks in order
+    while (finished_.erase(head_))
+    {
+      head_++;
+      auto iter = buffers_.find(head_);
+      if (iter != buffers_.end())
+      {
+        out_.write(iter->second.data(), iter->second.size());
+        buffers_.erase(iter);
+      }
+    }
+  }
+
+  cond_.notify_all();
+}
+
+void PrintQueue::abort()
+{
+  {
+    lock_guard<mutex> lock(mutex_);
+    aborted_ = true;
+  }
+
+  cond_.notify_all();
+}
+
+} // namespace
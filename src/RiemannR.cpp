@@ -0,0 +1,124 @@
+///
+/// @file  RiemannR.cpp
+/// @brief The logarithmic integral li(x) is computed using
+///        Ramanujan's series and the Riemann R function using
+///        R(x) = sum_{k=1}^{inf} mu(k)/k * li(x^(1/k)).
+///        R^-1(x) is computed using Newton's method.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/RiemannR.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+namespace {
+
+/// Möbius function for k <= 64
+int moebius(int k)
+{
+  int mu = 1;
+
+  for (int p = 2; p * p <= k; p++)
+  {
+    if (k % p == 0)
+    {
+      k /= p;
+      if (k % p == 0)
+        return 0;
+      mu = -mu;
+    }
+  }
+
+  if (k > 1)
+    mu = -mu;
+
+  return mu;
+}
+
+} // namespace
+
+namespace primesieve {
+
+/// Ramanujan's series:
+/// li(x) = gamma + log(log(x)) + sqrt(x) *
+///         sum_{n=1}^{inf} ((-1)^(n-1) * log(x)^n) / (n! * 2^(n-1)) *
+///         sum_{k=0}^{floor((n-1)/2)} 1 / (2k + 1)
+///
+long double li(long double x)
+{
+  if (x <= 1)
+    return 0;
+
+  long double gamma = 0.577215664901532860606512090082402431L;
+  long double sum = 0;
+  long double innerSum = 0;
+  long double factorial = 1;
+  long double p = -1;
+  long double power2 = 1;
+  long double logx = log(x);
+  int terms = (int) (logx * 2) + 10;
+
+  for (int n = 1, k = 0; n < terms; n++)
+  {
+    p *= -logx;
+    factorial *= n;
+    long double q = factorial * power2;
+    power2 *= 2;
+    for (; k <= (n - 1) / 2; k++)
+      innerSum += 1.0L / (2 * k + 1);
+    sum += (p / q) * innerSum;
+  }
+
+  return gamma + log(logx) + sqrt(x) * sum;
+}
+
+long double RiemannR(long double x)
+{
+  if (x <= 1)
+    return 0;
+
+  long double sum = 0;
+
+  // x^(1/k) < 2 for k > log2(x), the
+  // remaining terms are negligible
+  for (int k = 1; k <= 64; k++)
+  {
+    long double root = pow(x, 1.0L / k);
+    if (root < 2)
+      break;
+    int mu = moebius(k);
+    if (mu != 0)
+      sum += mu * li(root) / k;
+  }
+
+  return sum;
+}
+
+/// Newton's method, R'(t) ~ 1 / log(t)
+long double RiemannR_inverse(long double x)
+{
+  if (x < 2)
+    return 2;
+
+  long double t = x * log(x);
+
+  for (int i = 0; i < 100; i++)
+  {
+    long double logt = log(max(t, 2.0L));
+    long double delta = (RiemannR(t) - x) * logt;
+    t = max(t - delta, 2.0L);
+    if (fabs(delta) < 1)
+      break;
+  }
+
+  return t;
+}
+
+} // namespace
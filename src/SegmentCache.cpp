@@ -0,0 +1,102 @@
+///
+/// @file  SegmentCache.cpp
+/// @brief Process-wide LRU cache of sieved segments.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/SegmentCache.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <mutex>
+
+using namespace std;
+
+namespace primesieve {
+
+SegmentCache& segmentCache()
+{
+  static SegmentCache cache;
+  return cache;
+}
+
+void SegmentCache::setMaxSize(uint64_t bytes)
+{
+  lock_guard<mutex> lock(mutex_);
+  maxSize_ = bytes;
+  evict(bytes);
+}
+
+/// The last segment is padded with zero
+/// bytes to a multiple of 8 bytes
+///
+bool SegmentCache::get(const Key& key, byte_t* sieve, uint64_t* sieveSize)
+{
+  lock_guard<mutex> lock(mutex_);
+  auto iter = index_.find(key);
+
+  if (iter == index_.end())
+  {
+    misses_++;
+    return false;
+  }
+
+  // move to the front of the LRU list
+  lru_.splice(lru_.begin(), lru_, iter->second);
+  const Entry& entry = *iter->second;
+  copy(entry.sieve.begin(), entry.sieve.end(), sieve);
+  *sieveSize = entry.sieveSize;
+  hits_++;
+
+  return true;
+}
+
+void SegmentCache::put(const Key& key, const byte_t* sieve, uint64_t sieveSize)
+{
+  uint64_t bytes = ceilDiv(sieveSize, 8) * 8;
+  lock_guard<mutex> lock(mutex_);
+
+  if (bytes > maxSize_ ||
+      index_.count(key))
+    return;
+
+  evict(maxSize_ - bytes);
+  lru_.push_front(Entry{key, sieveSize, vector<byte_t>(sieve, sieve + bytes)});
+  index_[key] = lru_.begin();
+  size_ += bytes;
+}
+
+/// Remove the least recently used
+/// segments until size <= maxSize
+///
+void SegmentCache::evict(uint64_t maxSize)
+{
+  while (size_ > maxSize)
+  {
+    Entry& entry = lru_.back();
+    size_ -= entry.sieve.size();
+    index_.erase(entry.key);
+    lru_.pop_back();
+  }
+}
+
+void set_segment_cache_size(uint64_t bytes)
+{
+  segmentCache().setMaxSize(bytes);
+}
+
+segment_cache_stats get_segment_cache_stats()
+{
+  segment_cache_stats stats;
+  stats.hits = segmentCache().getHits();
+  stats.misses = segmentCache().getMisses();
+  return stats;
+}
+
+} // namespace
@@ -0,0 +1,306 @@
+///
+/// @file   SequenceSieve.cpp
+/// @brief  Segmented sieve of the index space of a sequence. For
+///         each sieving prime p and each root r the candidates
+///         k = r (mod p) are crossed off. Big sieving primes use
+///         the bucket sieve algorithm of EratBig: each one is
+///         stored in the bucket list of the segment of its next
+///         multiple.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/SequenceSieve.hpp>
+#include <primesieve/Bucket.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/iterator.hpp>
+#include <primesieve/MemoryPool.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/sequence_sieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+const uint64_t SEGMENT_SIZE = config::SEQUENCE_SIEVE_BYTES * 8;
+const uint64_t SEGMENT_WORDS = SEGMENT_SIZE / 64;
+
+static_assert((SEGMENT_SIZE & (SEGMENT_SIZE - 1)) == 0, "SEQUENCE_SIEVE_BYTES must be a power of 2");
+static_assert(SEGMENT_SIZE <= SievingPrime::MAX_MULTIPLEINDEX + 1ull,
+              "SEQUENCE_SIEVE_BYTES too large for SievingPrime");
+
+/// x^-1 (mod p) using the extended Euclidean
+/// algorithm, @pre p prime and x % p != 0
+///
+uint64_t modInverse(uint64_t x, uint64_t p)
+{
+  int64_t t0 = 0;
+  int64_t t1 = 1;
+  uint64_t r0 = p;
+  uint64_t r1 = x % p;
+
+  while (r1)
+  {
+    uint64_t q = r0 / r1;
+    int64_t t = t0 - (int64_t) q * t1;
+    uint64_t r = r0 - q * r1;
+    t0 = t1; t1 = t;
+    r0 = r1; r1 = r;
+  }
+
+  return (t0 < 0) ? t0 + p : t0;
+}
+
+/// b^n (mod p), @pre p < 2^32
+uint64_t modPow(uint64_t b, uint64_t n, uint64_t p)
+{
+  uint64_t result = 1 % p;
+  b %= p;
+
+  for (; n > 0; n >>= 1)
+  {
+    if (n & 1)
+      result = (result * b) % p;
+    b = (b * b) % p;
+  }
+
+  return result;
+}
+
+/// Root of a + k * d = 0 (mod p), @pre a, d < p
+void linearRoot(uint64_t a, uint64_t d, uint64_t p, vector<uint64_t>& roots)
+{
+  if (d == 0)
+  {
+    if (a == 0)
+      throw primesieve_error("sieving prime " + to_string(p) + " divides all candidates");
+    return;
+  }
+
+  // k = -a * d^-1 (mod p)
+  uint64_t minusA = (p - a) % p;
+  roots.push_back((minusA * modInverse(d, p)) % p);
+}
+
+} // namespace
+
+namespace primesieve {
+
+roots_callback progression_roots(uint64_t a, uint64_t d)
+{
+  return [=](uint64_t prime, vector<uint64_t>& roots)
+  {
+    linearRoot(a % prime, d % prime, prime, roots);
+  };
+}
+
+roots_callback power_roots(uint64_t b, uint64_t n, int64_t c)
+{
+  return [=](uint64_t prime, vector<uint64_t>& roots)
+  {
+    uint64_t absC = (c < 0) ? 0 - (uint64_t) c : (uint64_t) c;
+    uint64_t cm = absC % prime;
+    if (c < 0)
+      cm = (prime - cm) % prime;
+
+    linearRoot(cm, modPow(b, n, prime), prime, roots);
+  };
+}
+
+void sieve_sequence(uint64_t start,
+                    uint64_t stop,
+                    uint64_t max_prime,
+                    const roots_callback& roots,
+                    const survivors_callback& callback)
+{
+  if (start > stop)
+    return;
+
+  SequenceSieve sequenceSieve(start, stop, max_prime, roots);
+  sequenceSieve.sieve(callback);
+}
+
+SequenceSieve::SequenceSieve(uint64_t start,
+                             uint64_t stop,
+                             uint64_t maxPrime,
+                             const roots_callback& roots) :
+  start_(start),
+  stop_(stop),
+  maxPrime_(maxPrime),
+  log2SegmentSize_(ilog2(SEGMENT_SIZE))
+{
+  // SievingPrime stores 32-bit primes
+  if (maxPrime_ > numeric_limits<uint32_t>::max())
+    throw primesieve_error("sieve_sequence: max_prime must be < 2^32");
+
+  // a multiple inside the current segment is
+  // at most maxPrime ahead of the next one
+  uint64_t maxSegment = (SEGMENT_SIZE - 1 + maxPrime_) >> log2SegmentSize_;
+  lists_.resize(maxSegment + 1, nullptr);
+
+  for (Bucket*& list : lists_)
+    pushBucket(list);
+
+  bits_ = allocatePool<uint64_t>(SEGMENT_WORDS);
+  init(roots);
+}
+
+/// Calculate the first multiple >= start
+/// of each root of each sieving prime
+///
+void SequenceSieve::init(const roots_callback& callback)
+{
+  vector<uint64_t> roots;
+  primesieve::iterator it(0, maxPrime_);
+  uint64_t maxOffset = stop_ - start_;
+
+  for (uint64_t prime = it.next_prime(); prime <= maxPrime_; prime = it.next_prime())
+  {
+    roots.clear();
+    callback(prime, roots);
+    uint64_t startMod = start_ % prime;
+
+    for (uint64_t root : roots)
+    {
+      if (root >= prime)
+        throw primesieve_error("sieve_sequence: root " + to_string(root) +
+                               " >= prime " + to_string(prime));
+
+      uint64_t offset = (root >= startMod) ? root - startMod : root + prime - startMod;
+      if (offset > maxOffset)
+        continue;
+
+      if (prime < SEGMENT_SIZE)
+        smallPrimes_.push_back(SmallPrime{prime, offset});
+      else
+        store(prime, offset);
+    }
+  }
+}
+
+/// Move a big sieving prime to the bucket list of
+/// the segment of its next multiple, @multiple is
+/// relative to the current segment.
+///
+void SequenceSieve::store(uint64_t prime, uint64_t multiple)
+{
+  uint64_t segment = multiple >> log2SegmentSize_;
+  uint64_t multipleIndex = multiple & (SEGMENT_SIZE - 1);
+  Bucket*& list = lists_[segment];
+  if (!list->store(prime, multipleIndex, 0))
+    pushBucket(list);
+}
+
+/// Add an empty bucket to the front of list
+void SequenceSieve::pushBucket(Bucket*& list)
+{
+  // allocate new buckets
+  if (!stock_)
+  {
+    int N = config::BYTES_PER_ALLOC / sizeof(Bucket);
+    memory_.emplace_back(allocatePool<Bucket>(N));
+    Bucket* bucket = memory_.back().get();
+
+    for (int i = 0; i < N; i++)
+      new (&bucket[i]) Bucket();
+    for (int i = 0; i < N - 1; i++)
+      bucket[i].setNext(&bucket[i + 1]);
+    bucket[N-1].setNext(nullptr);
+    stock_ = bucket;
+  }
+
+  Bucket* empty = stock_;
+  stock_ = stock_->next();
+  moveBucket(*empty, list);
+}
+
+void SequenceSieve::moveBucket(Bucket& src, Bucket*& dest)
+{
+  src.setNext(dest);
+  dest = &src;
+}
+
+void SequenceSieve::sieve(const survivors_callback& callback)
+{
+  uint64_t* bits = bits_.get();
+
+  for (uint64_t low = start_; true; low += SEGMENT_SIZE)
+  {
+    fill_n(bits, SEGMENT_WORDS, ~0ull);
+    crossOffSmall(bits);
+    crossOffBig(bits);
+
+    // unset the bits after stop
+    uint64_t size = min(stop_ - low, SEGMENT_SIZE - 1) + 1;
+    uint64_t words = ceilDiv(size, 64);
+    fill(bits + words, bits + SEGMENT_WORDS, 0);
+    if (size % 64)
+      bits[words - 1] &= (1ull << (size % 64)) - 1;
+
+    callback(low, bits, (size_t) size);
+
+    if (stop_ - low < SEGMENT_SIZE)
+      break;
+  }
+}
+
+void SequenceSieve::crossOffSmall(uint64_t* bits)
+{
+  for (SmallPrime& p : smallPrimes_)
+  {
+    uint64_t prime = p.prime;
+    uint64_t j = p.next;
+
+    for (; j < SEGMENT_SIZE; j += prime)
+      bits[j / 64] &= ~(1ull << (j % 64));
+
+    p.next = j - SEGMENT_SIZE;
+  }
+}
+
+/// Cross off the next multiple of each big sieving
+/// prime of the current segment, then move it to
+/// the list of the segment of its next multiple.
+///
+void SequenceSieve::crossOffBig(uint64_t* bits)
+{
+  while (lists_[0]->hasNext() || !lists_[0]->empty())
+  {
+    Bucket* bucket = lists_[0];
+    lists_[0] = nullptr;
+    pushBucket(lists_[0]);
+
+    do {
+      for (SievingPrime& sp : *bucket)
+      {
+        uint64_t prime = sp.getSievingPrime();
+        uint64_t j = sp.getMultipleIndex();
+        bits[j / 64] &= ~(1ull << (j % 64));
+        store(prime, j + prime);
+      }
+      Bucket* processed = bucket;
+      bucket = bucket->next();
+      processed->reset();
+      moveBucket(*processed, stock_);
+    } while (bucket);
+  }
+
+  // the segment is finished, all multiples are
+  // now relative to the next segment
+  rotate(lists_.begin(), lists_.begin() + 1, lists_.end());
+}
+
+} // namespace
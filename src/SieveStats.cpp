@@ -0,0 +1,139 @@
+///
+/// @file  SieveStats.cpp
+///        The hardware counters are read using Linux perf_event,
+///        each thread opens one group of counters which is read
+///        with a single read() system call.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/SieveStats.hpp>
+
+#include <stdint.h>
+#include <array>
+#include <cstring>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+  #if defined(__NR_perf_event_open)
+    #define HAS_PERF_EVENT
+  #endif
+#endif
+
+namespace {
+
+#if defined(HAS_PERF_EVENT)
+
+uint64_t cacheEvent(uint64_t cache, uint64_t result)
+{
+  return cache |
+         (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (result << 16);
+}
+
+/// The counters of the calling thread (user space only).
+/// Events which are not supported by the CPU are skipped,
+/// they stay 0.
+///
+class HwGroup
+{
+public:
+  HwGroup()
+  {
+    const std::array<std::array<uint64_t, 2>, primesieve::HW_EVENTS> events =
+    {{
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+      { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+      { PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+      { PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+      { PERF_TYPE_HW_CACHE, cacheEvent(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_RESULT_MISS) }
+    }};
+
+    for (int i = 0; i < primesieve::HW_EVENTS; i++)
+    {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = (uint32_t) events[i][0];
+      attr.config = events[i][1];
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_GROUP;
+
+      int fd = (int) syscall(__NR_perf_event_open, &attr, 0, -1, leader_, 0);
+      if (fd < 0)
+      {
+        // without cycles there is no group
+        if (i == 0)
+          return;
+        continue;
+      }
+
+      if (i == 0)
+        leader_ = fd;
+      fds_[size_] = fd;
+      index_[size_++] = i;
+    }
+  }
+
+  ~HwGroup()
+  {
+    for (int i = 0; i < size_; i++)
+      close(fds_[i]);
+  }
+
+  bool read(primesieve::HwCounters& counters)
+  {
+    if (leader_ < 0)
+      return false;
+
+    // nr, then the values in the order of opening
+    uint64_t data[1 + primesieve::HW_EVENTS];
+    ssize_t bytes = ::read(leader_, data, sizeof(data));
+    if (bytes < (ssize_t) sizeof(uint64_t) || data[0] != (uint64_t) size_)
+      return false;
+
+    counters.fill(0);
+    for (int i = 0; i < size_; i++)
+      counters[index_[i]] = data[1 + i];
+
+    return true;
+  }
+
+private:
+  int leader_ = -1;
+  int size_ = 0;
+  std::array<int, primesieve::HW_EVENTS> fds_;
+  std::array<int, primesieve::HW_EVENTS> index_;
+};
+
+#endif
+
+} // namespace
+
+namespace primesieve {
+
+SieveStats*& threadStats()
+{
+  thread_local SieveStats* stats = nullptr;
+  return stats;
+}
+
+bool readHwCounters(HwCounters& counters)
+{
+#if defined(HAS_PERF_EVENT)
+  thread_local HwGroup group;
+  return group.read(counters);
+#else
+  (void) counters;
+  return false;
+#endif
+}
+
+} // namespace
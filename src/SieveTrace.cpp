@@ -0,0 +1,100 @@
+///
+/// @file   SieveTrace.cpp
+/// @brief  Write the ParallelSieve timeline as Chrome trace JSON,
+///         one row per thread, each event is a complete ("X")
+///         event with the interval it sieved as arguments. The
+///         main thread (-1) is tid 0, thread i is tid i + 1.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/SieveTrace.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+SieveTrace::SieveTrace() :
+  start_(chrono::steady_clock::now())
+{ }
+
+double SieveTrace::now() const
+{
+  chrono::duration<double, micro> us = chrono::steady_clock::now() - start_;
+  return us.count();
+}
+
+void SieveTrace::add(const Event& event)
+{
+  lock_guard<mutex> lock(lock_);
+  events_.push_back(event);
+}
+
+vector<SieveTrace::Event> SieveTrace::getEvents() const
+{
+  lock_guard<mutex> lock(lock_);
+  return events_;
+}
+
+void SieveTrace::write(const string& filename) const
+{
+  ofstream file(filename);
+  if (!file)
+    throw primesieve_error("failed to open " + filename);
+
+  auto events = getEvents();
+  set<int> threads;
+  for (auto& event : events)
+    threads.insert(event.thread);
+
+  vector<string> lines;
+
+  for (int thread : threads)
+  {
+    ostringstream line;
+    line << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread + 1
+         << ", \"args\": {\"name\": \"";
+    if (thread < 0)
+      line << "main";
+    else
+      line << "thread " << thread;
+    line << "\"}}";
+    lines.push_back(line.str());
+  }
+
+  for (auto& e : events)
+  {
+    ostringstream line;
+    line << fixed << setprecision(3);
+    line << "{\"name\": \"" << e.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread + 1
+         << ", \"ts\": " << e.start
+         << ", \"dur\": " << max(e.end - e.start, 0.0)
+         << ", \"args\": {\"low\": " << e.low << ", \"high\": " << e.high << "}}";
+    lines.push_back(line.str());
+  }
+
+  file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+  for (size_t i = 0; i < lines.size(); i++)
+    file << lines[i] << ((i + 1 < lines.size()) ? ",\n" : "\n");
+  file << "]}\n";
+
+  if (!file)
+    throw primesieve_error("failed to write " + filename);
+}
+
+} // namespace
@@ -10,30 +10,79 @@
 
 #include <primesieve/SievingPrimes.hpp>
 #include <primesieve/Erat.hpp>
+#include <primesieve/fillPrimes.hpp>
 #include <primesieve/PreSieve.hpp>
-#include <primesieve/littleendian_cast.hpp>
+#include <primesieve/SievingTable.hpp>
 #include <primesieve/pmath.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <vector>
 
+using namespace std;
+
 namespace primesieve {
 
-SievingPrimes::SievingPrimes(Erat* erat, PreSieve& preSieve)
+SievingPrimes::SievingPrimes(Erat* erat,
+                             PreSieve& preSieve,
+                             const SievingTable* table)
 {
-  init(erat, preSieve);
+  init(erat, preSieve, table);
 }
 
-void SievingPrimes::init(Erat* erat, PreSieve& preSieve)
+/// @table: If not nullptr the sieving primes are read
+///         from the table instead of being sieved. Else
+///         the bitmap of the process-wide prime_table
+///         is used if it is large enough.
+///
+void SievingPrimes::init(Erat* erat,
+                         PreSieve& preSieve,
+                         const SievingTable* table)
 {
-  Erat::init(preSieve.getMaxPrime() + 1,
-             isqrt(erat->getStop()),
-             erat->getSieveSize(),
-             preSieve);
+  uint64_t start = preSieve.getMaxPrime() + 1;
+  uint64_t stop = isqrt(erat->getStop());
+
+  if (!table)
+  {
+    shared_ = getSharedSievingTable(stop);
+    table = shared_.get();
+  }
+
+  if (table &&
+      table->getStop() >= stop)
+  {
+    start_ = start;
+    stop_ = stop;
+    initTable(*table);
+    return;
+  }
 
+  Erat::init(start, stop, erat->getSieveSize(), preSieve);
+  bits_ = sieve_;
   tinySieve();
 }
 
+/// Iterate over the shared table, there is only
+/// one segment which is already sieved
+///
+void SievingPrimes::initTable(const SievingTable& table)
+{
+  uint64_t bytes = 0;
+  if (stop_ >= 7)
+    bytes = (stop_ - 7) / 30 + 1;
+
+  bytes += (8 - bytes % 8) % 8;
+  sieveSize_ = min(bytes, table.size());
+  bits_ = table.data();
+  sieveIdx_ = 0;
+  low_ = 0;
+
+  // skip the pre-sieved primes < start
+  fill();
+  while (i_ < size_ && primes_[i_] < start_)
+    i_++;
+}
+
 /// Sieve up to n^(1/4)
 void SievingPrimes::tinySieve()
 {
@@ -55,16 +104,9 @@ void SievingPrimes::fill()
     if (!sieveSegment())
       return;
 
-  uint64_t num = 0;
-  uint64_t bits = littleendian_cast<uint64_t>(&sieve_[sieveIdx_]);
-  sieveIdx_ += 8;
-
-  for (; bits != 0; num++)
-    primes_[num] = nextPrime(&bits, low_);
-
   i_ = 0;
-  size_ = num;
-  low_ += 8 * 30;
+  size_ = fillPrimes(bits_, &sieveIdx_, sieveSize_, &low_,
+                     primes_, sizeof(primes_) / sizeof(primes_[0]));
 }
 
 bool SievingPrimes::sieveSegment()
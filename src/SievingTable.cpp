@@ -0,0 +1,245 @@
+///
+/// @file   SievingTable.cpp
+/// @brief  Sieve the primes <= sqrt(stop) once in parallel, the
+///         resulting table is shared read-only by all threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/Erat.hpp>
+#include <primesieve/MappedFile.hpp>
+#include <primesieve/PreSieve.hpp>
+#include <primesieve/PrintFormat.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SievingPrimes.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/types.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Sieving cache file format (integers are little-endian):
+/// "PSSVCHE1", stop, size, 5 * 0 (reserved), table bytes
+///
+const char MAGIC[8] = { 'P', 'S', 'S', 'V', 'C', 'H', 'E', '1' };
+const uint64_t HEADER_SIZE = 64;
+
+mutex sharedMutex;
+shared_ptr<const SievingTable> sharedTables[2];
+
+/// Table size in bytes (multiple of 8)
+uint64_t tableSize(uint64_t stop)
+{
+  if (stop < 7)
+    return 0;
+
+  uint64_t bytes = (stop - 7) / 30 + 1;
+  return bytes + (8 - bytes % 8) % 8;
+}
+
+/// Sieves the primes inside [start, stop] and
+/// copies the sieve array into the table
+///
+class TableSieve : public Erat
+{
+public:
+  TableSieve(uint64_t start, uint64_t stop, uint64_t sieveSize)
+  {
+    Erat::init(start, stop, sieveSize, preSieve_);
+  }
+
+  void sieve(byte_t* table)
+  {
+    SievingPrimes sievingPrimes(this, preSieve_);
+    uint64_t prime = sievingPrimes.next();
+
+    while (hasNextSegment())
+    {
+      uint64_t low = segmentLow_;
+      uint64_t sqrtHigh = isqrt(segmentHigh_);
+
+      for (; prime <= sqrtHigh; prime = sievingPrimes.next())
+        addSievingPrime(prime);
+
+      sieveSegment();
+      copy_n(sieve_, sieveSize_, &table[low / 30]);
+    }
+  }
+private:
+  PreSieve preSieve_;
+};
+
+} // namespace
+
+namespace primesieve {
+
+SievingTable::SievingTable(uint64_t stop,
+                           int threads,
+                           int sieveSize,
+                           ThreadPool& pool,
+                           const cancel_token* token) :
+  stop_(stop)
+{
+  if (stop_ < 7)
+    return;
+
+  // the byte i of the table corresponds
+  // to the numbers [i * 30 + 7, i * 30 + 31]
+  uint64_t bytes = (stop_ - 7) / 30 + 1;
+  size_ = tableSize(stop_);
+  byte_t* table = new byte_t[size_];
+  deleter_.reset(table);
+  table_ = table;
+  fill(&table[bytes], &table[size_], 0);
+
+  // each piece must be a multiple of 8 bytes
+  // because SievingPrimes reads 64-bit words
+  uint64_t pieceSize = size_ / (max(threads, 1) * 4);
+  pieceSize = max<uint64_t>(pieceSize, 1 << 16);
+  pieceSize += (8 - pieceSize % 8) % 8;
+  uint64_t pieces = ceilDiv(bytes, pieceSize);
+  threads = (int) min<uint64_t>(threads, pieces);
+  atomic<uint64_t> i(0);
+
+  auto task = [&]()
+  {
+    for (uint64_t j = i++; j < pieces; j = i++)
+    {
+      if (token && token->is_cancelled())
+        throw primesieve_cancelled();
+
+      uint64_t low = j * pieceSize;
+      uint64_t high = min(low + pieceSize, bytes);
+      uint64_t start = low * 30 + 7;
+      uint64_t end = min(high * 30 + 1, stop_);
+
+      TableSieve tableSieve(start, end, sieveSize);
+      tableSieve.sieve(table);
+    }
+  };
+
+  pool.run(threads, task);
+}
+
+SievingTable::SievingTable(const string& filename) :
+  file_(new MappedFile(filename))
+{
+  bool valid = file_->size() >= HEADER_SIZE &&
+               memcmp(file_->data(), MAGIC, sizeof(MAGIC)) == 0;
+
+  if (valid)
+  {
+    stop_ = file_->read64(8);
+    size_ = file_->read64(16);
+    valid = size_ == tableSize(stop_) &&
+            size_ <= file_->size() - HEADER_SIZE;
+  }
+
+  if (!valid)
+    throw primesieve_error("invalid sieving cache " + filename);
+
+  table_ = file_->data() + HEADER_SIZE;
+}
+
+SievingTable::~SievingTable() = default;
+
+void SievingTable::write(const string& filename) const
+{
+  string header(MAGIC, sizeof(MAGIC));
+  char bytes[8];
+  toLittleEndian<8>(stop_, bytes);
+  header.append(bytes, 8);
+  toLittleEndian<8>(size_, bytes);
+  header.append(bytes, 8);
+  header.resize(HEADER_SIZE, '\0');
+
+  ofstream file(filename, ios::binary | ios::trunc);
+  if (!file)
+    throw primesieve_error("failed to open " + filename);
+
+  file.write(header.data(), header.size());
+  file.write((const char*) table_, size_);
+  file.close();
+
+  if (!file)
+    throw primesieve_error("failed to write " + filename);
+}
+
+/// The table is only rebuilt if it is too small, other
+/// threads needing a table wait until it has been built
+///
+shared_ptr<const SievingTable> SievingTableCache::get(uint64_t stop,
+                                                      int threads,
+                                                      int sieveSize,
+                                                      ThreadPool& pool,
+                                                      const cancel_token* token)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if (!table_ ||
+      table_->getStop() < stop)
+    table_ = make_shared<SievingTable>(stop, threads, sieveSize, pool, token);
+
+  return table_;
+}
+
+void SievingTableCache::clear()
+{
+  lock_guard<mutex> lock(mutex_);
+  table_.reset();
+}
+
+void setSharedSievingTable(SharedTable source,
+                           shared_ptr<const SievingTable> table)
+{
+  lock_guard<mutex> lock(sharedMutex);
+  sharedTables[source] = table;
+}
+
+shared_ptr<const SievingTable> getSharedSievingTable(uint64_t stop)
+{
+  lock_guard<mutex> lock(sharedMutex);
+
+  for (auto& table : sharedTables)
+    if (table && table->getStop() >= stop)
+      return table;
+
+  return nullptr;
+}
+
+void write_sieving_cache(const string& filename, uint64_t stop)
+{
+  SievingTable table(stop, get_num_threads(), get_sieve_size());
+  table.write(filename);
+}
+
+void load_sieving_cache(const string& filename)
+{
+  auto table = make_shared<const SievingTable>(filename);
+  setSharedSievingTable(SIEVING_CACHE, table);
+}
+
+void unload_sieving_cache()
+{
+  setSharedSievingTable(SIEVING_CACHE, nullptr);
+}
+
+} // namespace
@@ -0,0 +1,252 @@
+///
+/// @file   StoreTuplets.cpp
+/// @brief  Generate the prime k-tuplets of an interval into
+///         vectors and buffers. The tuplets are decoded straight
+///         from the bitmask matches of the sieve bytes of
+///         sieve_bitmap(), without formatting them as text.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/StoreTuplets.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/sieve_bitmap.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+const uint64_t END = 0xff + 1;
+
+/// Same constellations as the bitmasks in PrintPrimes.cpp,
+/// ordered by their first member
+///
+const uint64_t bitmasks[7][5] =
+{
+  { END },
+  { END },
+  { 0x06, 0x18, 0xc0, END },       // Twin primes:       b00000110, b00011000, b11000000
+  { 0x07, 0x0e, 0x1c, 0x38, END }, // Prime triplets:    b00000111, b00001110, ...
+  { 0x1e, END },                   // Prime quadruplets: b00011110
+  { 0x1f, 0x3e, END },             // Prime quintuplets
+  { 0x3f, END }                    // Prime sextuplets
+};
+
+const uint64_t bitValues[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+
+struct SmallTuplet
+{
+  int k;
+  uint64_t first;
+  uint64_t last;
+};
+
+/// The k-tuplets < 7 are not part of the sieve array
+const array<SmallTuplet, 5> smallTuplets
+{{
+  { 2, 3, 5 },
+  { 2, 5, 7 },
+  { 3, 5, 11 },
+  { 4, 5, 13 },
+  { 5, 5, 17 }
+}};
+
+/// The first member of each match of bitmask
+/// is the lowest bit of the bitmask
+///
+uint64_t firstOffset(uint64_t bitmask)
+{
+  int bit = 0;
+  while (!(bitmask & (1ull << bit)))
+    bit++;
+  return bitValues[bit];
+}
+
+/// Tuplets of one segment of a thread,
+/// [begin, end[ of the thread's buffer
+///
+struct Chunk
+{
+  uint64_t low;
+  size_t begin;
+  size_t end;
+};
+
+struct ThreadTuplets
+{
+  vector<uint64_t> tuplets;
+  vector<Chunk> chunks;
+};
+
+/// Call f(first member) for each k-tuplet of the sieve array,
+/// a k-tuplet matches all bits of one of the bitmasks.
+///
+template <typename F>
+void decode(int k, uint64_t low, const uint8_t* sieve, size_t size, F&& f)
+{
+  const uint64_t* masks = bitmasks[k];
+  uint64_t offsets[4];
+  size_t n = 0;
+
+  for (; masks[n] != END; n++)
+    offsets[n] = firstOffset(masks[n]);
+
+  for (size_t i = 0; i < size; i++, low += 30)
+  {
+    uint64_t byte = sieve[i];
+
+    for (size_t j = 0; j < n; j++)
+      if ((byte & masks[j]) == masks[j])
+        f(low + offsets[j]);
+  }
+}
+
+void checkK(int k)
+{
+  if (k < 2 || k > 6)
+    throw primesieve_error("k-tuplets: k must be >= 2 and <= 6, k = " + to_string(k));
+}
+
+/// Thrown by fill_tuplets() once the buffer is full
+struct BufferFull { };
+
+} // namespace
+
+namespace primesieve {
+
+void store_tuplets(int k,
+                   uint64_t start,
+                   uint64_t stop,
+                   const tuplets_allocator& allocate)
+{
+  checkK(k);
+
+  vector<uint64_t> small;
+  for (auto& t : smallTuplets)
+    if (t.k == k && t.first >= start && t.last <= stop)
+      small.push_back(t.first);
+
+  int threads = get_num_threads();
+  vector<ThreadTuplets> threadTuplets(threads);
+
+  if (start <= stop)
+  {
+    sieve_bitmap(start, stop, threads, [&](int thread, uint64_t low, const uint8_t* sieve, size_t size)
+    {
+      auto& t = threadTuplets[thread];
+      Chunk chunk;
+      chunk.low = low;
+      chunk.begin = t.tuplets.size();
+      decode(k, low, sieve, size, [&](uint64_t first) {
+        t.tuplets.push_back(first);
+      });
+      chunk.end = t.tuplets.size();
+      if (chunk.begin != chunk.end)
+        t.chunks.push_back(chunk);
+    });
+  }
+
+  // the segments of each thread are in increasing
+  // order but there is no order across threads
+  vector<pair<const ThreadTuplets*, Chunk>> chunks;
+  size_t size = small.size();
+
+  for (auto& t : threadTuplets)
+  {
+    for (auto& chunk : t.chunks)
+    {
+      chunks.emplace_back(&t, chunk);
+      size += chunk.end - chunk.begin;
+    }
+  }
+
+  sort(chunks.begin(), chunks.end(), [](const pair<const ThreadTuplets*, Chunk>& a,
+                                        const pair<const ThreadTuplets*, Chunk>& b) {
+    return a.second.low < b.second.low;
+  });
+
+  uint64_t* tuplets = allocate(size);
+  tuplets = copy(small.begin(), small.end(), tuplets);
+
+  for (auto& c : chunks)
+  {
+    const uint64_t* first = c.first->tuplets.data();
+    tuplets = copy(first + c.second.begin, first + c.second.end, tuplets);
+  }
+}
+
+void generate_tuplets(int k, uint64_t start, uint64_t stop, vector<uint64_t>* tuplets)
+{
+  if (!tuplets)
+    return;
+
+  size_t offset = tuplets->size();
+  store_tuplets(k, start, stop, [&](size_t size) {
+    tuplets->resize(offset + size);
+    return tuplets->data() + offset;
+  });
+}
+
+void generate_twins(uint64_t start, uint64_t stop, vector<pair<uint64_t, uint64_t>>* twins)
+{
+  if (!twins)
+    return;
+
+  vector<uint64_t> first;
+  generate_tuplets(2, start, stop, &first);
+  twins->reserve(twins->size() + first.size());
+
+  for (uint64_t p : first)
+    twins->emplace_back(p, p + 2);
+}
+
+bool fill_tuplets(int k, uint64_t start, uint64_t stop, uint64_t* tuplets, size_t size, size_t* written)
+{
+  checkK(k);
+  size_t n = 0;
+  bool full = false;
+
+  try
+  {
+    auto add = [&](uint64_t first)
+    {
+      if (n == size)
+        throw BufferFull();
+      tuplets[n++] = first;
+    };
+
+    for (auto& t : smallTuplets)
+      if (t.k == k && t.first >= start && t.last <= stop)
+        add(t.first);
+
+    // single-threaded, stops
+    // once the buffer is full
+    sieve_bitmap(start, stop, [&](uint64_t low, const uint8_t* sieve, size_t bytes) {
+      decode(k, low, sieve, bytes, add);
+    });
+  }
+  catch (BufferFull&)
+  {
+    full = true;
+  }
+
+  if (written)
+    *written = n;
+
+  return full;
+}
+
+} // namespace
@@ -0,0 +1,383 @@
+///
+/// @file   ThreadPool.cpp
+/// @brief  Process-wide pool of worker threads. Instead of launching
+///         new threads for each multi-threaded computation (which
+///         is expensive if many small computations are run)
+///         ParallelSieve runs its tasks on the worker threads of
+///         this pool. The queue is ordered by priority, a big
+///         computation yields its workers to the queued jobs
+///         of concurrent computations after each chunk.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/Affinity.hpp>
+#include <primesieve/MemoryPool.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Priority of the jobs of the calling thread
+thread_local int threadPriority = 0;
+
+/// Free the memory cached by the calling thread
+void releaseMemory()
+{
+  primesieve::MemoryPool* pool = primesieve::memoryPool();
+  if (pool)
+    pool->release();
+}
+
+} // namespace
+
+namespace primesieve {
+
+thread_local ThreadPool::Job* ThreadPool::workerJob_ = nullptr;
+thread_local bool ThreadPool::yielded_ = false;
+
+ThreadPool& threadPool()
+{
+  static ThreadPool pool;
+  return pool;
+}
+
+ThreadPool::ThreadPool()
+{ }
+
+ThreadPool::~ThreadPool()
+{
+  shutdown();
+}
+
+/// Returns false if the job has already
+/// been completed by other threads
+///
+bool ThreadPool::Job::enter()
+{
+  lock_guard<mutex> guard(lock);
+  if (closed)
+    return false;
+  running++;
+  return true;
+}
+
+void ThreadPool::Job::leave()
+{
+  lock_guard<mutex> guard(lock);
+  running--;
+  if (running == 0)
+    finished.notify_all();
+}
+
+void ThreadPool::Job::execute()
+{
+  try
+  {
+    task();
+  }
+  catch (...)
+  {
+    lock_guard<mutex> guard(lock);
+    if (!error)
+      error = current_exception();
+  }
+}
+
+/// The calling thread always executes task() itself. Hence
+/// run() also completes if all worker threads are busy, the
+/// queued copies of the task that have not been started by
+/// the time the calling thread has finished are discarded.
+///
+void ThreadPool::run(int threads, const function<void()>& task)
+{
+  if (threads <= 1)
+  {
+    Job job(task);
+    job.execute();
+    if (!keepMemory_)
+      releaseMemory();
+    if (job.error)
+      rethrow_exception(job.error);
+    return;
+  }
+
+  auto job = make_shared<Job>(task);
+  startWorkers(threads - 1);
+
+  {
+    lock_guard<mutex> lock(mutex_);
+    for (int i = 1; i < threads; i++)
+      enqueue(job);
+  }
+
+  wakeup_.notify_all();
+
+  // the calling thread never yields
+  Job* workerJob = workerJob_;
+  workerJob_ = nullptr;
+  job->enter();
+  job->execute();
+  job->leave();
+  workerJob_ = workerJob;
+
+  if (!keepMemory_)
+    releaseMemory();
+
+  unique_lock<mutex> lock(job->lock);
+  job->closed = true;
+  job->finished.wait(lock, [&]() { return job->running == 0; });
+
+  if (job->error)
+    rethrow_exception(job->error);
+}
+
+/// Used by the asynchronous API e.g. count_primes_async(). The
+/// task may itself call run() from the worker thread, its
+/// copies are then executed by the other workers of the pool.
+/// If no worker is available because shutdown() is in
+/// progress the task is executed by the calling thread.
+///
+void ThreadPool::submit(const function<void()>& task)
+{
+  auto job = make_shared<Job>(task);
+  startWorkers(1);
+
+  {
+    lock_guard<mutex> lock(mutex_);
+    if (!workers_.empty())
+    {
+      enqueue(job);
+      job.reset();
+    }
+  }
+
+  if (job)
+    job->execute();
+  else
+    wakeup_.notify_one();
+}
+
+/// Insert the job after the jobs of the same or a higher
+/// priority, called with mutex_ locked
+///
+void ThreadPool::enqueue(const shared_ptr<Job>& job)
+{
+  auto pos = queue_.end();
+  while (pos != queue_.begin() && (*(pos - 1))->priority < job->priority)
+    --pos;
+
+  queue_.insert(pos, job);
+}
+
+bool ThreadPool::yield()
+{
+  Job* job = workerJob_;
+  if (!job)
+    return false;
+
+  int running;
+  {
+    lock_guard<mutex> guard(job->lock);
+    running = job->running;
+  }
+
+  lock_guard<mutex> lock(mutex_);
+
+  // the first job of the queue that has not yet
+  // been completed has the highest priority
+  for (auto& waiting : queue_)
+  {
+    if (waiting.get() == job)
+      continue;
+
+    lock_guard<mutex> guard(waiting->lock);
+    if (waiting->closed)
+      continue;
+
+    if (waiting->priority > job->priority ||
+        (waiting->priority == job->priority &&
+         waiting->running + 1 < running))
+      yielded_ = true;
+
+    break;
+  }
+
+  return yielded_;
+}
+
+void ThreadPool::setPriority(int priority)
+{
+  threadPriority = priority;
+}
+
+int ThreadPool::getPriority()
+{
+  return threadPriority;
+}
+
+void ThreadPool::startWorkers(int threads)
+{
+  // do not block if shutdown() is in progress,
+  // run() then uses the calling thread only
+  unique_lock<mutex> shutdownLock(shutdownMutex_, try_to_lock);
+  if (!shutdownLock.owns_lock())
+    return;
+
+  lock_guard<mutex> lock(mutex_);
+  while ((int) workers_.size() < threads)
+  {
+    int index = (int) workers_.size();
+    workers_.emplace_back(&ThreadPool::worker, this, index);
+  }
+}
+
+/// @index: Worker index, the calling thread of run() is
+///         not pinned and may use the first CPU.
+///
+void ThreadPool::worker(int index)
+{
+  int epoch = 0;
+
+  while (true)
+  {
+    shared_ptr<Job> job;
+    vector<int> cpus;
+    bool updateCpus = false;
+
+    {
+      unique_lock<mutex> lock(mutex_);
+      wakeup_.wait(lock, [&]() { return stop_ || !queue_.empty(); });
+      // finish the submitted jobs before stopping
+      if (queue_.empty())
+        return;
+      job = queue_.front();
+      queue_.pop_front();
+
+      if (epoch != pinEpoch_)
+      {
+        epoch = pinEpoch_;
+        cpus = getCpus(index);
+        updateCpus = true;
+      }
+    }
+
+    if (updateCpus)
+      updateAffinity(cpus);
+
+    if (job->enter())
+    {
+      // nested jobs inherit the priority
+      workerJob_ = job.get();
+      threadPriority = job->priority;
+      job->execute();
+      workerJob_ = nullptr;
+      threadPriority = 0;
+      job->leave();
+
+      if (!keepMemory_)
+        releaseMemory();
+
+      // resume the task once the
+      // queued jobs have a worker
+      if (yielded_)
+      {
+        yielded_ = false;
+        lock_guard<mutex> lock(mutex_);
+        if (!stop_)
+          enqueue(job);
+      }
+    }
+  }
+}
+
+void ThreadPool::shutdown()
+{
+  lock_guard<mutex> shutdownLock(shutdownMutex_);
+  vector<thread> workers;
+
+  {
+    lock_guard<mutex> lock(mutex_);
+    stop_ = true;
+    workers.swap(workers_);
+  }
+
+  wakeup_.notify_all();
+
+  for (auto& t : workers)
+    t.join();
+
+  lock_guard<mutex> lock(mutex_);
+  queue_.clear();
+  stop_ = false;
+}
+
+/// CPUs of the worker thread,
+/// called with mutex_ locked
+///
+vector<int> ThreadPool::getCpus(int index) const
+{
+  if (pin_ && !cpus_.empty())
+    return vector<int>{ cpus_[(index + 1) % cpus_.size()] };
+  else
+    return allowedCpus_;
+}
+
+void ThreadPool::updateAffinity(const vector<int>& cpus)
+{
+  setThreadAffinity(cpus);
+
+  // the cached memory may reside on another NUMA node,
+  // new memory will be first touched by this thread
+  // and hence allocated on the local NUMA node
+  releaseMemory();
+}
+
+void ThreadPool::setPinThreads(bool pin)
+{
+  lock_guard<mutex> lock(mutex_);
+
+  if (pin && !pin_)
+  {
+    allowedCpus_ = getAllowedCpus();
+    cpus_ = getCpuOrder();
+  }
+
+  if (pin != pin_)
+  {
+    pin_ = pin;
+    pinEpoch_++;
+  }
+}
+
+bool ThreadPool::getPinThreads()
+{
+  lock_guard<mutex> lock(mutex_);
+  return pin_;
+}
+
+void ThreadPool::setKeepMemory(bool keep)
+{
+  keepMemory_ = keep;
+}
+
+int ThreadPool::getNumWorkers()
+{
+  lock_guard<mutex> lock(mutex_);
+  return (int) workers_.size();
+}
+
+} // namespace
@@ -0,0 +1,239 @@
+///
+/// @file   Tuning.cpp
+/// @brief  Load and save the tuning file written by
+///         primesieve --autotune. One band per line:
+///         max_stop sieve_size factor_erat_small
+///         factor_erat_medium min_thread_distance
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/Tuning.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+using namespace primesieve;
+
+/// Built-in table: if sqrt(stop) > default sieve size * factor
+/// use default sieve size / divisor. Measured on x86-64 CPUs
+/// with a private L2 cache, the EratBig buckets of the current
+/// segment compete with the sieve array for the L2 cache.
+///
+const struct
+{
+  double factor;
+  int divisor;
+} builtinBands[] =
+{
+  // EratBig is used
+  { config::FACTOR_ERATMEDIUM, 2 },
+  // stop > 1.1e18 (2 MiB L2 cache)
+  { 512, 4 }
+};
+
+mutex tuningLock;
+shared_ptr<const Tuning> tuning;
+atomic<bool> hasTuning(false);
+once_flag loaded;
+
+/// $PRIMESIEVE_TUNING or the default tuning file, a
+/// missing or invalid tuning file is ignored
+///
+void loadTuning()
+{
+  const char* env = getenv("PRIMESIEVE_TUNING");
+  string filename = env ? env : Tuning::defaultFilename();
+  if (filename.empty())
+    return;
+
+  try
+  {
+    if (!ifstream(filename))
+      return;
+
+    auto t = make_shared<Tuning>();
+    t->load(filename);
+
+    lock_guard<mutex> lock(tuningLock);
+    tuning = t;
+    hasTuning = !t->empty();
+  }
+  catch (primesieve_error&)
+  { }
+}
+
+} // namespace
+
+namespace primesieve {
+
+TuningBand Tuning::defaults(uint64_t maxStop)
+{
+  return { maxStop, 0,
+           config::FACTOR_ERATSMALL,
+           config::FACTOR_ERATMEDIUM,
+           config::MIN_THREAD_DISTANCE };
+}
+
+/// Sieve size in KiB if there is no tuning file
+int Tuning::builtinSieveSize(uint64_t stop, int threads)
+{
+  int sieveSize = cpuInfo.sieveSize(threads);
+
+  // L1 cache sized sieve array
+  if (!cpuInfo.hasL2Cache() ||
+      !cpuInfo.hasPrivateL2Cache())
+    return sieveSize;
+
+  uint64_t sqrtStop = isqrt(stop);
+  uint64_t bytes = (uint64_t) sieveSize << 10;
+  int size = sieveSize;
+
+  for (auto& band : builtinBands)
+    if (sqrtStop > bytes * band.factor)
+      size = sieveSize / band.divisor;
+
+  return max(size, 32);
+}
+
+TuningBand Tuning::band(uint64_t stop) const
+{
+  for (auto& band : bands_)
+    if (stop <= band.maxStop)
+      return band;
+
+  return defaults(numeric_limits<uint64_t>::max());
+}
+
+/// The values are clamped to the preconditions of config.hpp,
+/// a band replaces an existing band with the same maxStop.
+///
+void Tuning::add(TuningBand band)
+{
+  if (band.sieveSize)
+    band.sieveSize = inBetween(8, band.sieveSize, (int) config::MAX_SIEVE_SIZE);
+
+  band.factorEratSmall = inBetween(0.0, band.factorEratSmall, 3.0);
+  band.factorEratMedium = inBetween(0.0, band.factorEratMedium, 5.0);
+  band.minThreadDistance = max(band.minThreadDistance, (uint64_t) 100);
+
+  auto pos = lower_bound(bands_.begin(), bands_.end(), band,
+    [](const TuningBand& a, const TuningBand& b) { return a.maxStop < b.maxStop; });
+
+  if (pos != bands_.end() && pos->maxStop == band.maxStop)
+    *pos = band;
+  else
+    bands_.insert(pos, band);
+}
+
+void Tuning::load(const string& filename)
+{
+  ifstream file(filename);
+  if (!file)
+    throw primesieve_error("failed to open " + filename);
+
+  Tuning tuning;
+  string line;
+
+  while (getline(file, line))
+  {
+    size_t pos = line.find_first_not_of(" \t\r");
+    if (pos == string::npos || line[pos] == '#')
+      continue;
+
+    istringstream in(line);
+    TuningBand band;
+    in >> band.maxStop >> band.sieveSize
+       >> band.factorEratSmall >> band.factorEratMedium
+       >> band.minThreadDistance;
+
+    if (!in)
+      throw primesieve_error("invalid tuning file " + filename + ": " + line);
+
+    tuning.add(band);
+  }
+
+  *this = tuning;
+}
+
+void Tuning::save(const string& filename) const
+{
+  ofstream file(filename);
+  if (!file)
+    throw primesieve_error("failed to open " + filename);
+
+  file << "# primesieve tuning file, written by primesieve --autotune\n";
+  file << "# max_stop sieve_size factor_erat_small factor_erat_medium min_thread_distance\n";
+
+  for (auto& band : bands_)
+  {
+    file << band.maxStop << ' '
+         << band.sieveSize << ' '
+         << band.factorEratSmall << ' '
+         << band.factorEratMedium << ' '
+         << band.minThreadDistance << '\n';
+  }
+
+  if (!file)
+    throw primesieve_error("failed to write " + filename);
+}
+
+string Tuning::defaultFilename()
+{
+#if defined(_WIN32)
+  const char* appData = getenv("APPDATA");
+  if (appData && *appData)
+    return string(appData) + "\\primesieve\\tuning.txt";
+#else
+  const char* config = getenv("XDG_CONFIG_HOME");
+  if (config && *config)
+    return string(config) + "/primesieve/tuning.txt";
+  const char* home = getenv("HOME");
+  if (home && *home)
+    return string(home) + "/.config/primesieve/tuning.txt";
+#endif
+
+  return string();
+}
+
+TuningBand getTuning(uint64_t stop)
+{
+  call_once(loaded, loadTuning);
+
+  if (!hasTuning)
+    return Tuning::defaults(numeric_limits<uint64_t>::max());
+
+  lock_guard<mutex> lock(tuningLock);
+  return tuning->band(stop);
+}
+
+void setTuning(const Tuning& t)
+{
+  call_once(loaded, loadTuning);
+
+  lock_guard<mutex> lock(tuningLock);
+  tuning = make_shared<Tuning>(t);
+  hasTuning = !t.empty();
+}
+
+} // namespace
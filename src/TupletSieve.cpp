@@ -0,0 +1,303 @@
+///
+/// @file   TupletSieve.cpp
+/// @brief  Count prime quintuplets and sextuplets by sieving
+///         only the candidate start positions 210 * k + r of
+///         the admissible constellations. For each sieving
+///         prime q and each member (210 * k + r + offset) we
+///         solve 210 * k = -(r + offset) (mod q) to find the
+///         first multiple, then we cross off every q-th k.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/TupletSieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/iterator.hpp>
+#include <primesieve/MemoryPool.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+struct Pattern
+{
+  int index;
+  /// Residue mod 30 of the first member
+  uint64_t base;
+  vector<uint64_t> offsets;
+};
+
+/// Same constellations as the bitmasks in PrintPrimes.cpp
+const array<Pattern, 3> patterns =
+{{
+  { 4,  7, { 0, 4, 6, 10, 12 } },    // Prime quintuplets: b00011111
+  { 4, 11, { 0, 2, 6, 8, 12 } },     // Prime quintuplets: b00111110
+  { 5,  7, { 0, 4, 6, 10, 12, 16 } } // Prime sextuplets:  b00111111
+}};
+
+/// Sieving primes > 7 are used,
+/// 2, 3, 5, 7 are removed by the wheel
+///
+const uint64_t MIN_PRIME = 11;
+
+uint64_t gcd(uint64_t a, uint64_t b)
+{
+  while (b)
+  {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+/// t[q % 210] = -q^-1 (mod 210) for q coprime to 210, then
+/// 210^-1 (mod q) = (1 + q * t) / 210 since q * t = -1 (mod 210)
+///
+const array<uint64_t, 210>& inverseTable()
+{
+  static const array<uint64_t, 210> table = []()
+  {
+    array<uint64_t, 210> t{};
+    for (uint64_t a = 1; a < 210; a++)
+      if (gcd(a, 210) == 1)
+        for (uint64_t b = 1; b < 210; b++)
+          if ((a * b) % 210 == 209)
+            t[a] = b;
+    return t;
+  }();
+
+  return table;
+}
+
+} // namespace
+
+namespace primesieve {
+
+bool TupletSieve::isSupported(const PrimeSieve& ps)
+{
+  // both would sieve the residue class 97 twice,
+  // which is slower than the normal sieve
+  return (ps.isCount(4) != ps.isCount(5)) &&
+         !ps.isCount(0) &&
+         !ps.isCount(1) &&
+         !ps.isCount(2) &&
+         !ps.isCount(3) &&
+         !ps.isPrint() &&
+         !ps.getHistogram() &&
+         !ps.getPrimeGaps() &&
+         !ps.getResidueCounts() &&
+         !ps.getPrimeSums() &&
+         ps.getStart() >= config::MIN_TUPLET_SIEVE &&
+         ps.getStart() <= ps.getStop();
+}
+
+TupletSieve::TupletSieve(PrimeSieve& ps) :
+  start_(ps.getStart()),
+  stop_(ps.getStop()),
+  ps_(ps)
+{
+  for (auto& p : patterns)
+  {
+    if (!ps.isCount(p.index))
+      continue;
+
+    for (uint64_t r = p.base; r < 210; r += 30)
+    {
+      bool admissible = true;
+      for (uint64_t offset : p.offsets)
+        if (gcd(r + offset, 210) != 1)
+          admissible = false;
+
+      if (admissible)
+      {
+        Class c;
+        c.index = p.index;
+        c.residue = r;
+        c.offsets = p.offsets;
+        classes_.push_back(move(c));
+      }
+    }
+  }
+
+  segmentSize_ = config::TUPLET_SIEVE_BYTES * 8;
+
+  for (auto& c : classes_)
+    c.bits = allocatePool<uint64_t>(segmentSize_ / 64 + 1);
+
+  initStop(stop_);
+}
+
+/// Candidates k with start <= 210 * k + r
+/// and 210 * k + r + last offset <= stop
+///
+void TupletSieve::initStop(uint64_t stop)
+{
+  stop_ = stop;
+
+  for (auto& c : classes_)
+  {
+    uint64_t last = c.residue + c.offsets.back();
+    c.kLow = ceilDiv(start_ - c.residue, 210);
+    c.kHigh = 0;
+
+    if (stop_ >= last)
+      c.kHigh = (stop_ - last) / 210;
+
+    // empty
+    if (stop_ < last || c.kHigh < c.kLow)
+    {
+      c.kLow = 1;
+      c.kHigh = 0;
+    }
+  }
+}
+
+void TupletSieve::sieve()
+{
+  uint64_t kLow = ~0ull;
+  uint64_t kHigh = 0;
+
+  for (auto& c : classes_)
+  {
+    if (c.kLow <= c.kHigh)
+    {
+      kLow = min(kLow, c.kLow);
+      kHigh = max(kHigh, c.kHigh);
+    }
+  }
+
+  for (uint64_t k = kLow; k <= kHigh; k += segmentSize_)
+  {
+    // other threads may steal the upper
+    // part of our ParallelSieve span
+    if (ps_.isSpan())
+    {
+      uint64_t high = stop_;
+      uint64_t kLast = k + segmentSize_ - 1;
+      if (kLast < (stop_ - 209) / 210)
+        high = kLast * 210 + 209;
+
+      uint64_t stop = ps_.claimSpan(high);
+      if (stop != stop_)
+      {
+        initStop(stop);
+        kHigh = 0;
+        for (auto& c : classes_)
+          if (c.kLow <= c.kHigh)
+            kHigh = max(kHigh, c.kHigh);
+        if (k > kHigh)
+          break;
+      }
+    }
+
+    sieveSegment(k);
+
+    if (ps_.isStatus())
+      ps_.updateStatus(segmentSize_ * 210);
+
+    ps_.checkCancelled();
+  }
+}
+
+/// Sieve the candidates [k, k + segmentSize_[
+/// of all residue classes
+///
+void TupletSieve::sieveSegment(uint64_t k)
+{
+  uint64_t words = segmentSize_ / 64;
+  bool active = false;
+
+  for (auto& c : classes_)
+  {
+    uint64_t* bits = c.bits.get();
+    fill_n(bits, words, 0);
+
+    if (c.kLow > c.kHigh ||
+        c.kHigh < k ||
+        c.kLow >= k + segmentSize_)
+      continue;
+
+    uint64_t low = max(c.kLow, k) - k;
+    uint64_t high = min(c.kHigh - k, segmentSize_ - 1);
+
+    for (uint64_t i = low; i <= high; i++)
+      bits[i / 64] |= 1ull << (i % 64);
+
+    active = true;
+  }
+
+  if (!active)
+    return;
+
+  uint64_t maxPrime = isqrt(stop_);
+  primesieve::iterator it(MIN_PRIME - 1, maxPrime);
+
+  for (uint64_t q = it.next_prime(); q <= maxPrime; q = it.next_prime())
+    crossOff(q, k);
+
+  auto& counts = ps_.getCounts();
+
+  for (auto& c : classes_)
+    counts[c.index] += popcount(c.bits.get(), words);
+}
+
+/// Cross off the candidates whose members are divisible by q.
+/// Member 210 * (k + j) + v (v = residue + offset) is divisible
+/// by q if j = -k - v * 210^-1 (mod q). Since 210 * 210^-1 = 1
+/// (mod q) this needs only a single modulo operation per prime.
+///
+void TupletSieve::crossOff(uint64_t q, uint64_t k)
+{
+  static const auto& table = inverseTable();
+  uint64_t t = table[q % 210];
+  uint64_t inv = (1 + q * t) / 210;
+  uint64_t j0 = k % q;
+  j0 = (j0 > 0) ? q - j0 : 0;
+
+  for (auto& c : classes_)
+  {
+    uint64_t* bits = c.bits.get();
+    uint64_t words = segmentSize_ / 64;
+
+    for (uint64_t offset : c.offsets)
+    {
+      // w = v * 210^-1 (mod q), the quotient
+      // floor(v * inv / q) = floor(v * t / 210) for q > v
+      uint64_t v = c.residue + offset;
+      uint64_t w = v * inv - q * ((v * t) / 210);
+      if (q <= v)
+        w = (v * inv) % q;
+
+      uint64_t j = (j0 >= w) ? j0 - w : j0 + q - w;
+
+      if (q < segmentSize_)
+      {
+        for (; j < segmentSize_; j += q)
+          bits[j / 64] &= ~(1ull << (j % 64));
+      }
+      else
+      {
+        // at most 1 multiple per segment, branchfree:
+        // misses go to the extra word after the segment
+        uint64_t i = (j < segmentSize_) ? j / 64 : words;
+        bits[i] &= ~(1ull << (j % 64));
+      }
+    }
+  }
+}
+
+} // namespace
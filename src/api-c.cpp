@@ -12,13 +12,22 @@
 
 #include <primesieve.h>
 #include <primesieve.hpp>
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/context.hpp>
 #include <primesieve/malloc_vector.hpp>
+#include <primesieve/StoreTuplets.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/primesieve_error.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <cstdlib>
 #include <cstddef>
 #include <cerrno>
+#include <chrono>
+#include <memory>
 #include <exception>
+#include <vector>
 
 using namespace std;
 using namespace primesieve;
@@ -119,6 +128,120 @@ void* primesieve_generate_n_primes(uint64_t n, uint64_t start, int type)
   return NULL;
 }
 
+int primesieve_fill_primes(uint64_t start, uint64_t stop, void* primes, size_t size, size_t* written, int type)
+{
+  primesieve_iterator it;
+  primesieve_init(&it);
+  primesieve_skipto(&it, start > 0 ? start - 1 : 0, stop);
+  int res = primesieve_fill_next_primes(&it, stop, primes, size, written, type);
+  primesieve_free_iterator(&it);
+
+  return res;
+}
+
+uint64_t* primesieve_generate_tuplets(int k, uint64_t start, uint64_t stop, size_t* size)
+{
+  try
+  {
+    malloc_vector<uint64_t> tuplets;
+    store_tuplets(k, start, stop, [&](size_t n) {
+      tuplets.resize(n);
+      return tuplets.data();
+    });
+
+    if (size)
+      *size = tuplets.size();
+
+    tuplets.disable_free();
+    return tuplets.data();
+  }
+  catch (exception&)
+  {
+    if (size)
+      *size = 0;
+
+    errno = EDOM;
+    return NULL;
+  }
+}
+
+int primesieve_fill_tuplets(int k, uint64_t start, uint64_t stop, uint64_t* tuplets, size_t size, size_t* written)
+{
+  try
+  {
+    return fill_tuplets(k, start, stop, tuplets, size, written) ? 1 : 0;
+  }
+  catch (exception&)
+  {
+    if (written)
+      *written = 0;
+
+    errno = EDOM;
+    return -1;
+  }
+}
+
+uint64_t* primesieve_generate_cunningham_chains(int length, uint64_t start, uint64_t stop, size_t* size)
+{
+  try
+  {
+    vector<uint64_t> primes;
+    generate_cunningham_chains(length, start, stop, &primes);
+    malloc_vector<uint64_t> chains(primes.size());
+    copy(primes.begin(), primes.end(), chains.data());
+
+    if (size)
+      *size = chains.size();
+
+    chains.disable_free();
+    return chains.data();
+  }
+  catch (exception&)
+  {
+    if (size)
+      *size = 0;
+
+    errno = EDOM;
+    return NULL;
+  }
+}
+
+uint64_t primesieve_generate_primes_to_file(uint64_t start, uint64_t stop, const char* filename, int type)
+{
+  size_t bytes = 0;
+
+  switch (type)
+  {
+    case SHORT_PRIMES:     bytes = sizeof(short); break;
+    case USHORT_PRIMES:    bytes = sizeof(unsigned short); break;
+    case INT_PRIMES:       bytes = sizeof(int); break;
+    case UINT_PRIMES:      bytes = sizeof(unsigned int); break;
+    case LONG_PRIMES:      bytes = sizeof(long); break;
+    case ULONG_PRIMES:     bytes = sizeof(unsigned long); break;
+    case LONGLONG_PRIMES:  bytes = sizeof(long long); break;
+    case ULONGLONG_PRIMES: bytes = sizeof(unsigned long long); break;
+    case INT16_PRIMES:     bytes = sizeof(int16_t); break;
+    case UINT16_PRIMES:    bytes = sizeof(uint16_t); break;
+    case INT32_PRIMES:     bytes = sizeof(int32_t); break;
+    case UINT32_PRIMES:    bytes = sizeof(uint32_t); break;
+    case INT64_PRIMES:     bytes = sizeof(int64_t); break;
+    case UINT64_PRIMES:    bytes = sizeof(uint64_t); break;
+  }
+
+  try
+  {
+    if (!filename || !bytes)
+      throw primesieve_error("invalid argument");
+
+    return generate_primes_to_file(start, stop, filename, bytes);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
 void primesieve_free(void* primes)
 {
   free(primes);
@@ -137,6 +260,36 @@ uint64_t primesieve_nth_prime(int64_t n, uint64_t start)
   }
 }
 
+int primesieve_is_prime(uint64_t n)
+{
+  try
+  {
+    return is_prime(n);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return 0;
+  }
+}
+
+void primesieve_is_prime_batch(const uint64_t* numbers, size_t size, int* results)
+{
+  try
+  {
+    unique_ptr<bool[]> isPrime(new bool[size]);
+    is_prime(numbers, size, isPrime.get());
+    for (size_t i = 0; i < size; i++)
+      results[i] = isPrime[i];
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    for (size_t i = 0; i < size; i++)
+      results[i] = 0;
+  }
+}
+
 uint64_t primesieve_count_primes(uint64_t start, uint64_t stop)
 {
   try
@@ -150,6 +303,302 @@ uint64_t primesieve_count_primes(uint64_t start, uint64_t stop)
   }
 }
 
+void primesieve_count_primes_batch(const uint64_t* starts, const uint64_t* stops, size_t size, uint64_t* counts)
+{
+  try
+  {
+    count_primes_batch(starts, stops, size, counts);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    for (size_t i = 0; i < size; i++)
+      counts[i] = PRIMESIEVE_ERROR;
+  }
+}
+
+uint64_t primesieve_count_constellations(uint64_t start, uint64_t stop, const uint64_t* offsets, size_t size)
+{
+  try
+  {
+    vector<uint64_t> vect(offsets, offsets + size);
+    return count_constellations(start, stop, vect);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
+uint64_t* primesieve_count_primes_bins(uint64_t start, uint64_t stop, uint64_t width, size_t* size)
+{
+  try
+  {
+    auto bins = count_primes_bins(start, stop, width);
+    malloc_vector<uint64_t> counts;
+    counts.insert(counts.end(), bins.data(), bins.data() + bins.size());
+
+    if (size)
+      *size = counts.size();
+
+    counts.disable_free();
+    return counts.data();
+  }
+  catch (exception&)
+  {
+    if (size)
+      *size = 0;
+
+    errno = EDOM;
+    return NULL;
+  }
+}
+
+uint64_t* primesieve_count_primes_mod(uint64_t start, uint64_t stop, uint64_t q, size_t* size)
+{
+  try
+  {
+    auto residues = count_primes_mod(start, stop, q);
+    malloc_vector<uint64_t> counts;
+    counts.insert(counts.end(), residues.data(), residues.data() + residues.size());
+
+    if (size)
+      *size = counts.size();
+
+    counts.disable_free();
+    return counts.data();
+  }
+  catch (exception&)
+  {
+    if (size)
+      *size = 0;
+
+    errno = EDOM;
+    return NULL;
+  }
+}
+
+primesieve_uint128 primesieve_sum_primes(uint64_t start, uint64_t stop)
+{
+  try
+  {
+    uint128 sum = sum_primes(start, stop);
+    primesieve_uint128 res = { sum.low, sum.high };
+    return res;
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    primesieve_uint128 res = { PRIMESIEVE_ERROR, PRIMESIEVE_ERROR };
+    return res;
+  }
+}
+
+primesieve_uint128 primesieve_sum_prime_squares(uint64_t start, uint64_t stop)
+{
+  try
+  {
+    uint128 sum = sum_prime_squares(start, stop);
+    primesieve_uint128 res = { sum.low, sum.high };
+    return res;
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    primesieve_uint128 res = { PRIMESIEVE_ERROR, PRIMESIEVE_ERROR };
+    return res;
+  }
+}
+
+uint64_t primesieve_nth_prime_cancellable(int64_t n, uint64_t start, const primesieve_cancel_token* token)
+{
+  try
+  {
+    if (!token)
+      return nth_prime(n, start);
+
+    auto& tok = *reinterpret_cast<const cancel_token*>(token);
+    return nth_prime(n, start, tok);
+  }
+  catch (primesieve_cancelled&)
+  {
+    errno = ECANCELED;
+    return PRIMESIEVE_ERROR;
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
+uint64_t primesieve_count_primes_cancellable(uint64_t start, uint64_t stop, const primesieve_cancel_token* token)
+{
+  try
+  {
+    if (!token)
+      return count_primes(start, stop);
+
+    auto& tok = *reinterpret_cast<const cancel_token*>(token);
+    return count_primes(start, stop, tok);
+  }
+  catch (primesieve_cancelled&)
+  {
+    errno = ECANCELED;
+    return PRIMESIEVE_ERROR;
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
+int primesieve_nth_prime_async(int64_t n, uint64_t start, const primesieve_cancel_token* token, primesieve_callback callback, void* data)
+{
+  try
+  {
+    threadPool().submit([=]() {
+      errno = 0;
+      uint64_t res = primesieve_nth_prime_cancellable(n, start, token);
+      if (callback)
+        callback(res, (res == PRIMESIEVE_ERROR) ? errno : 0, data);
+    });
+    return 0;
+  }
+  catch (exception&)
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+}
+
+int primesieve_count_primes_async(uint64_t start, uint64_t stop, const primesieve_cancel_token* token, primesieve_callback callback, void* data)
+{
+  try
+  {
+    threadPool().submit([=]() {
+      errno = 0;
+      uint64_t res = primesieve_count_primes_cancellable(start, stop, token);
+      if (callback)
+        callback(res, (res == PRIMESIEVE_ERROR) ? errno : 0, data);
+    });
+    return 0;
+  }
+  catch (exception&)
+  {
+    errno = ENOMEM;
+    return -1;
+  }
+}
+
+primesieve_cancel_token* primesieve_create_cancel_token()
+{
+  try
+  {
+    return reinterpret_cast<primesieve_cancel_token*>(new cancel_token);
+  }
+  catch (exception&)
+  {
+    errno = ENOMEM;
+    return nullptr;
+  }
+}
+
+void primesieve_cancel(primesieve_cancel_token* token)
+{
+  reinterpret_cast<cancel_token*>(token)->cancel();
+}
+
+void primesieve_set_deadline(primesieve_cancel_token* token, double seconds)
+{
+  auto timeout = chrono::duration<double>(seconds);
+  reinterpret_cast<cancel_token*>(token)->set_timeout(timeout);
+}
+
+void primesieve_free_cancel_token(primesieve_cancel_token* token)
+{
+  delete reinterpret_cast<cancel_token*>(token);
+}
+
+primesieve_context* primesieve_create_context()
+{
+  try
+  {
+    return reinterpret_cast<primesieve_context*>(new context);
+  }
+  catch (exception&)
+  {
+    errno = ENOMEM;
+    return nullptr;
+  }
+}
+
+void primesieve_free_context(primesieve_context* ctx)
+{
+  delete reinterpret_cast<context*>(ctx);
+}
+
+int primesieve_context_get_sieve_size(primesieve_context* ctx)
+{
+  return reinterpret_cast<context*>(ctx)->get_sieve_size();
+}
+
+int primesieve_context_get_num_threads(primesieve_context* ctx)
+{
+  return reinterpret_cast<context*>(ctx)->get_num_threads();
+}
+
+void primesieve_context_set_sieve_size(primesieve_context* ctx, int sieve_size)
+{
+  reinterpret_cast<context*>(ctx)->set_sieve_size(sieve_size);
+}
+
+void primesieve_context_set_num_threads(primesieve_context* ctx, int num_threads)
+{
+  reinterpret_cast<context*>(ctx)->set_num_threads(num_threads);
+}
+
+uint64_t primesieve_context_nth_prime(primesieve_context* ctx, int64_t n, uint64_t start)
+{
+  try
+  {
+    return reinterpret_cast<context*>(ctx)->nth_prime(n, start);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
+uint64_t primesieve_context_count_primes(primesieve_context* ctx, uint64_t start, uint64_t stop)
+{
+  try
+  {
+    return reinterpret_cast<context*>(ctx)->count_primes(start, stop);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
+uint64_t primesieve_context_count_twins(primesieve_context* ctx, uint64_t start, uint64_t stop)
+{
+  try
+  {
+    return reinterpret_cast<context*>(ctx)->count_twins(start, stop);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
 uint64_t primesieve_count_twins(uint64_t start, uint64_t stop)
 {
   try
@@ -215,6 +664,19 @@ uint64_t primesieve_count_sextuplets(uint64_t start, uint64_t stop)
   }
 }
 
+uint64_t primesieve_count_cunningham_chains(int length, uint64_t start, uint64_t stop)
+{
+  try
+  {
+    return count_cunningham_chains(length, start, stop);
+  }
+  catch (exception&)
+  {
+    errno = EDOM;
+    return PRIMESIEVE_ERROR;
+  }
+}
+
 void primesieve_print_primes(uint64_t start, uint64_t stop)
 {
   try
@@ -297,6 +759,21 @@ int primesieve_get_num_threads()
   return get_num_threads();
 }
 
+void primesieve_set_priority(int priority)
+{
+  set_priority(priority);
+}
+
+int primesieve_get_priority()
+{
+  return get_priority();
+}
+
+int primesieve_get_max_threads()
+{
+  return get_max_threads();
+}
+
 void primesieve_set_sieve_size(int sieve_size)
 {
   set_sieve_size(sieve_size);
@@ -307,6 +784,66 @@ void primesieve_set_num_threads(int num_threads)
   set_num_threads(num_threads);
 }
 
+uint64_t primesieve_get_memory_limit()
+{
+  return get_memory_limit();
+}
+
+void primesieve_set_memory_limit(uint64_t bytes)
+{
+  set_memory_limit(bytes);
+}
+
+uint64_t primesieve_get_iterator_memory_limit()
+{
+  return get_iterator_memory_limit();
+}
+
+void primesieve_set_iterator_memory_limit(uint64_t bytes)
+{
+  set_iterator_memory_limit(bytes);
+}
+
+int primesieve_get_iterator_growth()
+{
+  return get_iterator_growth();
+}
+
+void primesieve_set_iterator_growth(int factor)
+{
+  set_iterator_growth(factor);
+}
+
+int primesieve_get_iterator_compression()
+{
+  return get_iterator_compression();
+}
+
+void primesieve_set_iterator_compression(int enable)
+{
+  set_iterator_compression(enable != 0);
+}
+
+int primesieve_get_pin_threads()
+{
+  return get_pin_threads();
+}
+
+void primesieve_set_pin_threads(int pin)
+{
+  set_pin_threads(pin != 0);
+}
+
+void primesieve_shutdown_thread_pool()
+{
+  shutdown_thread_pool();
+}
+
+void primesieve_release_memory()
+{
+  release_memory();
+}
+
 uint64_t primesieve_get_max_stop()
 {
   return get_max_stop();
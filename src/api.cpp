@@ -11,48 +11,426 @@
 ///
 
 #include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/ConstellationSieve.hpp>
 #include <primesieve/CpuInfo.hpp>
+#include <primesieve/Histogram.hpp>
+#include <primesieve/IsPrime.hpp>
+#include <primesieve/MemoryPool.hpp>
 #include <primesieve/pmath.hpp>
+#include <primesieve/PrimeGenerator.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/ParallelSieve.hpp>
+#include <primesieve/prime_table.hpp>
+#include <primesieve/PrimeSums.hpp>
+#include <primesieve/ResidueCounts.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/Tuning.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstddef>
+#include <future>
 #include <limits>
+#include <memory>
 #include <string>
+#include <vector>
+
+using namespace primesieve;
 
 namespace {
 
-int sieve_size = 0;
+std::atomic<int> sieve_size(0);
+
+std::atomic<int> num_threads(0);
+
+std::atomic<uint64_t> memory_limit(0);
+
+std::atomic<uint64_t> iterator_memory_limit(config::MAX_CACHE_ITERATOR);
+
+std::atomic<int> iterator_growth(config::ITERATOR_GROWTH);
+
+std::atomic<bool> iterator_compression(false);
+
+/// The settings are read by the calling
+/// thread, not by the worker thread
+///
+std::future<uint64_t> countAsync(uint64_t start,
+                                 uint64_t stop,
+                                 int flags,
+                                 const cancel_token* token)
+{
+  int threads = get_num_threads();
+  int sieveSize = tunedSieveSize(start, stop, threads);
+  uint64_t memoryLimit = get_memory_limit();
+
+  auto task = std::make_shared<std::packaged_task<uint64_t()>>([=]() {
+    ParallelSieve ps;
+    ps.setSieveSize(sieveSize);
+    ps.setNumThreads(threads);
+    ps.setMemoryLimit(memoryLimit);
+    ps.setCancelToken(token);
+    ps.sieve(start, stop, flags);
+    return ps.getCount(ilog2(flags));
+  });
+
+  auto future = task->get_future();
+  threadPool().submit([task]() { (*task)(); });
+  return future;
+}
+
+std::future<uint64_t> nthPrimeAsync(int64_t n,
+                                    uint64_t start,
+                                    const cancel_token* token)
+{
+  int sieveSize = get_sieve_size();
+  int threads = get_num_threads();
+  uint64_t memoryLimit = get_memory_limit();
+
+  auto task = std::make_shared<std::packaged_task<uint64_t()>>([=]() {
+    ParallelSieve ps;
+    ps.setSieveSize(sieveSize);
+    ps.setNumThreads(threads);
+    ps.setMemoryLimit(memoryLimit);
+    ps.setCancelToken(token);
+    return ps.nthPrime(n, start);
+  });
+
+  auto future = task->get_future();
+  threadPool().submit([task]() { (*task)(); });
+  return future;
+}
+
+/// An interval [starts[i], stops[i]] of count_primes_batch()
+struct Interval
+{
+  uint64_t start;
+  uint64_t stop;
+  std::size_t i;
+};
+
+/// A group of nearby intervals which is
+/// counted in a single sieve sweep
+struct Sweep
+{
+  std::size_t first;
+  std::size_t last;
+  uint64_t low;
+  uint64_t high;
+};
+
+/// Count the primes of the intervals [first, last[ which are
+/// sorted by start. Each interval is the difference of two
+/// prefix counts pi(stop) - pi(start - 1) relative to
+/// sweep.low, all prefix counts are computed in one pass.
+///
+void countSweep(const Sweep& sweep,
+                const std::vector<Interval>& intervals,
+                uint64_t* counts)
+{
+  std::vector<uint64_t> points;
+  points.reserve((sweep.last - sweep.first) * 2);
+
+  for (std::size_t j = sweep.first; j < sweep.last; j++)
+  {
+    if (intervals[j].start > sweep.low)
+      points.push_back(intervals[j].start - 1);
+    points.push_back(intervals[j].stop);
+  }
+
+  std::sort(points.begin(), points.end());
+  points.erase(std::unique(points.begin(), points.end()), points.end());
+  std::vector<uint64_t> pi(points.size());
+
+  const uint64_t* first;
+  const uint64_t* last;
+  primesieve::iterator it(sweep.low - 1, sweep.high);
+  it.next_primes(&first, &last);
+  uint64_t count = 0;
+
+  for (std::size_t k = 0; k < points.size(); k++)
+  {
+    uint64_t x = points[k];
+    while (last[-1] <= x)
+    {
+      count += last - first;
+      it.next_primes(&first, &last);
+    }
+
+    const uint64_t* p = std::upper_bound(first, last, x);
+    count += p - first;
+    first = p;
+    pi[k] = count;
+  }
 
-int num_threads = 0;
+  auto prefix = [&](uint64_t x) {
+    auto k = std::lower_bound(points.begin(), points.end(), x) - points.begin();
+    return pi[k];
+  };
 
+  for (std::size_t j = sweep.first; j < sweep.last; j++)
+  {
+    const Interval& iv = intervals[j];
+    uint64_t count = prefix(iv.stop);
+    if (iv.start > sweep.low)
+      count -= prefix(iv.start - 1);
+    counts[iv.i] = count;
+  }
 }
 
+} // namespace
+
 namespace primesieve {
 
 uint64_t nth_prime(int64_t n, uint64_t start)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
   return ps.nthPrime(n, start);
 }
 
+uint64_t nth_prime(int64_t n, uint64_t start, const cancel_token& token)
+{
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  ps.setCancelToken(&token);
+  return ps.nthPrime(n, start);
+}
+
+bool is_prime(uint64_t n)
+{
+  return isPrimeCached(n);
+}
+
+void is_prime(const uint64_t* numbers, std::size_t size, bool* results)
+{
+  isPrimeBatch(numbers, size, results);
+}
+
 uint64_t count_primes(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  return ps.countPrimes(start, stop);
+}
+
+uint64_t count_primes(uint64_t start, uint64_t stop, const cancel_token& token)
+{
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  ps.setCancelToken(&token);
+  return ps.countPrimes(start, stop);
+}
+
+/// The intervals are sorted and split into sweeps, a new
+/// sweep starts if the gap to the next interval is larger
+/// than COUNT_BATCH_GAP or if the current sweep is larger
+/// than its share of the total distance. The sweeps are
+/// distributed onto the threads.
+///
+void count_primes_batch(const uint64_t* starts,
+                        const uint64_t* stops,
+                        std::size_t size,
+                        uint64_t* counts)
+{
+  std::vector<Interval> intervals;
+  intervals.reserve(size);
+
+  for (std::size_t i = 0; i < size; i++)
+  {
+    // primes > 2^64 - 1 do not exist, this
+    // also avoids overflowing the iterator
+    uint64_t start = std::max(starts[i], (uint64_t) 2);
+    uint64_t stop = std::min(stops[i], get_max_stop() - 1);
+
+    if (start > stop)
+      counts[i] = 0;
+    else
+      intervals.push_back(Interval{start, stop, i});
+  }
+
+  if (intervals.empty())
+    return;
+
+  std::sort(intervals.begin(), intervals.end(),
+    [](const Interval& a, const Interval& b) {
+      return a.start < b.start;
+    });
+
+  uint64_t low = intervals.front().start;
+  uint64_t high = 0;
+  for (auto& iv : intervals)
+    high = std::max(high, iv.stop);
+
+  uint64_t threads = get_num_threads();
+  uint64_t maxDist = (high - low) / threads;
+  maxDist = std::max(maxDist, config::MIN_THREAD_DISTANCE);
+
+  std::vector<Sweep> sweeps;
+  Sweep sweep = { 0, 0, low, low };
+
+  for (std::size_t j = 0; j < intervals.size(); j++)
+  {
+    const Interval& iv = intervals[j];
+    if (j > sweep.first &&
+        (iv.start - sweep.low > maxDist ||
+         (iv.start > sweep.high &&
+          iv.start - sweep.high > config::COUNT_BATCH_GAP)))
+    {
+      sweep.last = j;
+      sweeps.push_back(sweep);
+      sweep = Sweep{ j, j, iv.start, iv.start };
+    }
+
+    sweep.high = std::max(sweep.high, iv.stop);
+  }
+
+  sweep.last = intervals.size();
+  sweeps.push_back(sweep);
+
+  threads = std::min(threads, (uint64_t) sweeps.size());
+  std::atomic<std::size_t> next(0);
+
+  threadPool().run((int) threads, [&]() {
+    for (std::size_t i; (i = next++) < sweeps.size();)
+      countSweep(sweeps[i], intervals, counts);
+  });
+}
+
+/// [start, stop - maxOffset] is split into one part per
+/// thread, each thread sieves its part plus maxOffset.
+///
+uint64_t count_constellations(uint64_t start,
+                              uint64_t stop,
+                              const std::vector<uint64_t>& offsets)
+{
+  Constellation constellation(offsets);
+  uint64_t maxOffset = constellation.maxOffset();
+  if (start > stop || stop - start < maxOffset)
+    return 0;
+
+  uint64_t maxN = stop - maxOffset;
+  uint64_t dist = maxN - start;
+  uint64_t threshold = isqrt(stop) / 5;
+  threshold = std::max(threshold, config::MIN_THREAD_DISTANCE);
+  uint64_t threads = dist / threshold;
+  threads = inBetween(1, threads, get_num_threads());
+  int sieveSize = tunedSieveSize(start, stop, (int) threads);
+
+  // the sieving primes are shared by all threads
+  std::unique_ptr<SievingTable> sievingTable;
+  if (threads > 1)
+    sievingTable.reset(new SievingTable(isqrt(stop), (int) threads, sieveSize));
+
+  std::atomic<uint64_t> part(0);
+  std::atomic<uint64_t> count(0);
+
+  threadPool().run((int) threads, [&]() {
+    for (uint64_t i; (i = part++) < threads;)
+    {
+      uint64_t low = start + dist / threads * i;
+      uint64_t high = maxN;
+      if (i + 1 < threads)
+        high = start + dist / threads * (i + 1) - 1;
+
+      ConstellationSieve sieve(low, high, high + maxOffset, sieveSize,
+                               constellation, sievingTable.get());
+      count += sieve.count();
+    }
+  });
+
+  return count;
+}
+
+std::vector<uint64_t> count_primes_bins(uint64_t start, uint64_t stop, uint64_t width)
+{
+  Histogram histogram(start, stop, width);
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  ps.setHistogram(&histogram);
+  ps.sieve(start, stop, COUNT_PRIMES);
+
+  std::vector<uint64_t> bins(histogram.size());
+  for (std::size_t i = 0; i < bins.size(); i++)
+    bins[i] = histogram.count(i, 0);
+
+  return bins;
+}
+
+std::vector<uint64_t> count_primes_mod(uint64_t start, uint64_t stop, uint64_t q)
+{
+  ResidueCounts residueCounts(q);
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  ps.setResidueCounts(&residueCounts);
   ps.sieve(start, stop, COUNT_PRIMES);
-  return ps.getCount(0);
+
+  return residueCounts.counts();
+}
+
+uint128 sum_primes(uint64_t start, uint64_t stop)
+{
+  PrimeSums primeSums;
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  ps.setPrimeSums(&primeSums);
+  ps.sieve(start, stop, COUNT_PRIMES);
+
+  return primeSums.sum();
+}
+
+uint128 sum_prime_squares(uint64_t start, uint64_t stop)
+{
+  PrimeSums primeSums(true);
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
+  ps.setPrimeSums(&primeSums);
+  ps.sieve(start, stop, COUNT_PRIMES);
+
+  return primeSums.squares();
+}
+
+std::future<uint64_t> nth_prime_async(int64_t n, uint64_t start)
+{
+  return nthPrimeAsync(n, start, nullptr);
+}
+
+std::future<uint64_t> nth_prime_async(int64_t n, uint64_t start, const cancel_token& token)
+{
+  return nthPrimeAsync(n, start, &token);
+}
+
+std::future<uint64_t> count_primes_async(uint64_t start, uint64_t stop)
+{
+  return countAsync(start, stop, COUNT_PRIMES, nullptr);
+}
+
+std::future<uint64_t> count_primes_async(uint64_t start, uint64_t stop, const cancel_token& token)
+{
+  return countAsync(start, stop, COUNT_PRIMES, &token);
+}
+
+std::future<uint64_t> count_twins_async(uint64_t start, uint64_t stop)
+{
+  return countAsync(start, stop, COUNT_TWINS, nullptr);
 }
 
 uint64_t count_twins(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
   ps.sieve(start, stop, COUNT_TWINS);
   return ps.getCount(1);
 }
@@ -60,8 +438,8 @@ uint64_t count_twins(uint64_t start, uint64_t stop)
 uint64_t count_triplets(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
   ps.sieve(start, stop, COUNT_TRIPLETS);
   return ps.getCount(2);
 }
@@ -69,8 +447,8 @@ uint64_t count_triplets(uint64_t start, uint64_t stop)
 uint64_t count_quadruplets(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
   ps.sieve(start, stop, COUNT_QUADRUPLETS);
   return ps.getCount(3);
 }
@@ -78,8 +456,8 @@ uint64_t count_quadruplets(uint64_t start, uint64_t stop)
 uint64_t count_quintuplets(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
   ps.sieve(start, stop, COUNT_QUINTUPLETS);
   return ps.getCount(4);
 }
@@ -87,67 +465,237 @@ uint64_t count_quintuplets(uint64_t start, uint64_t stop)
 uint64_t count_sextuplets(uint64_t start, uint64_t stop)
 {
   ParallelSieve ps;
-  ps.setSieveSize(get_sieve_size());
   ps.setNumThreads(get_num_threads());
+  ps.setMemoryLimit(get_memory_limit());
   ps.sieve(start, stop, COUNT_SEXTUPLETS);
   return ps.getCount(5);
 }
 
+bool store_small_primes(uint64_t start,
+                        uint64_t stop,
+                        void* primes,
+                        resize_primes_t resize,
+                        copy_primes_t copy)
+{
+  if (start >= stop ||
+      stop > config::SMALL_PRIME_TABLE)
+    return false;
+
+  const prime_table& table = small_prime_table();
+  std::size_t size = (std::size_t) table.count_primes(start + 1, stop);
+  void* data = resize(primes, size);
+  uint64_t buffer[256];
+  std::size_t offset = 0;
+  start++;
+
+  while (offset < size)
+  {
+    std::size_t n = table.fill_primes(&start, stop, buffer, 256);
+    copy(data, offset, buffer, buffer + n);
+    offset += n;
+  }
+
+  return true;
+}
+
+bool store_primes32(uint64_t start,
+                    uint64_t stop,
+                    std::vector<uint32_t>& primes)
+{
+  if (start >= stop ||
+      stop > std::numeric_limits<uint32_t>::max())
+    return false;
+
+  PrimeGenerator primeGenerator(start + 1, stop);
+  primeGenerator.fill(primes);
+
+  return true;
+}
+
+/// The primes of each part are counted first (in parallel),
+/// then the primes container is resized once and each thread
+/// stores the primes of its part in its own slice. Sieving
+/// twice is cheaper than merging per thread vectors.
+///
+bool store_primes_parallel(uint64_t start,
+                           uint64_t stop,
+                           void* primes,
+                           resize_primes_t resize,
+                           copy_primes_t copy)
+{
+  if (start >= stop)
+    return false;
+
+  uint64_t dist = stop - start;
+  uint64_t threshold = isqrt(stop) / 5;
+  threshold = std::max(threshold, config::MIN_THREAD_DISTANCE);
+  uint64_t threads = dist / threshold;
+  threads = inBetween(1, threads, get_num_threads());
+
+  if (threads <= 1)
+    return false;
+
+  // part i = ]parts[i], parts[i + 1]]
+  std::vector<uint64_t> parts(threads + 1);
+  for (uint64_t i = 0; i < threads; i++)
+    parts[i] = start + dist / threads * i;
+  parts[threads] = stop;
+
+  int sieveSize = tunedSieveSize(start, stop, (int) threads);
+  std::vector<std::size_t> offsets(threads + 1, 0);
+  std::atomic<uint64_t> part(0);
+
+  threadPool().run((int) threads, [&]() {
+    for (uint64_t i; (i = part++) < threads;)
+    {
+      PrimeSieve ps;
+      ps.setSieveSize(sieveSize);
+      offsets[i + 1] = (std::size_t) ps.countPrimes(parts[i] + 1, parts[i + 1]);
+    }
+  });
+
+  for (uint64_t i = 0; i < threads; i++)
+    offsets[i + 1] += offsets[i];
+
+  void* data = resize(primes, offsets[threads]);
+  part = 0;
+
+  threadPool().run((int) threads, [&]() {
+    for (uint64_t i; (i = part++) < threads;)
+    {
+      const uint64_t* first;
+      const uint64_t* last;
+      std::size_t offset = offsets[i];
+      primesieve::iterator it(parts[i], parts[i + 1]);
+
+      while (offset < offsets[i + 1])
+      {
+        it.next_primes(&first, &last);
+        std::size_t n = (std::size_t) (last - first);
+        n = std::min(n, offsets[i + 1] - offset);
+        copy(data, offset, first, first + n);
+        offset += n;
+      }
+    }
+  });
+
+  return true;
+}
+
+/// The nth prime is found in parallel first, then
+/// the primes up to the nth prime are stored in
+/// parallel using store_primes_parallel().
+///
+bool store_n_primes_parallel(uint64_t n,
+                             uint64_t start,
+                             void* primes,
+                             resize_primes_t resize,
+                             copy_primes_t copy)
+{
+  // primes are roughly log(start) apart, if the
+  // estimated stop is too small we don't use threads
+  double x = std::max(10.0, (double) start);
+  double dist = n * std::log(x);
+  if (dist < 2.0 * config::MIN_THREAD_DISTANCE ||
+      n > (uint64_t) std::numeric_limits<int64_t>::max() ||
+      get_num_threads() <= 1)
+    return false;
+
+  uint64_t stop = nth_prime((int64_t) n, start);
+  return store_primes_parallel(start, stop, primes, resize, copy);
+}
+
 void print_primes(uint64_t start, uint64_t stop)
 {
-  PrimeSieve ps;
-  ps.setSieveSize(get_sieve_size());
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
   ps.sieve(start, stop, PRINT_PRIMES);
 }
 
 void print_twins(uint64_t start, uint64_t stop)
 {
-  PrimeSieve ps;
-  ps.setSieveSize(get_sieve_size());
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
   ps.sieve(start, stop, PRINT_TWINS);
 }
 
 void print_triplets(uint64_t start, uint64_t stop)
 {
-  PrimeSieve ps;
-  ps.setSieveSize(get_sieve_size());
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
   ps.sieve(start, stop, PRINT_TRIPLETS);
 }
 
 void print_quadruplets(uint64_t start, uint64_t stop)
 {
-  PrimeSieve ps;
-  ps.setSieveSize(get_sieve_size());
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
   ps.sieve(start, stop, PRINT_QUADRUPLETS);
 }
 
 void print_quintuplets(uint64_t start, uint64_t stop)
 {
-  PrimeSieve ps;
-  ps.setSieveSize(get_sieve_size());
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
   ps.sieve(start, stop, PRINT_QUINTUPLETS);
 }
 
 void print_sextuplets(uint64_t start, uint64_t stop)
 {
-  PrimeSieve ps;
-  ps.setSieveSize(get_sieve_size());
+  ParallelSieve ps;
+  ps.setNumThreads(get_num_threads());
   ps.sieve(start, stop, PRINT_SEXTUPLETS);
 }
 
 int get_num_threads()
 {
-  if (num_threads)
-    return num_threads;
+  int threads = num_threads;
+  if (threads)
+    return threads;
   else
     return ParallelSieve::getMaxThreads();
 }
 
+int get_max_threads()
+{
+  return ParallelSieve::getMaxThreads();
+}
+
 void set_num_threads(int threads)
 {
   num_threads = inBetween(1, threads, ParallelSieve::getMaxThreads());
 }
 
+void set_priority(int priority)
+{
+  ThreadPool::setPriority(priority);
+}
+
+int get_priority()
+{
+  return ThreadPool::getPriority();
+}
+
+bool get_pin_threads()
+{
+  return threadPool().getPinThreads();
+}
+
+void set_pin_threads(bool pin)
+{
+  threadPool().setPinThreads(pin);
+}
+
+void shutdown_thread_pool()
+{
+  threadPool().shutdown();
+}
+
+void release_memory()
+{
+  MemoryPool::releaseAll();
+}
+
 uint64_t get_max_stop()
 {
   return std::numeric_limits<uint64_t>::max();
@@ -160,45 +708,93 @@ std::string primesieve_version()
 
 void set_sieve_size(int size)
 {
-  sieve_size = inBetween(8, size, 4096);
-  sieve_size = floorPow2(sieve_size);
+  sieve_size = inBetween(8, size, (int) config::MAX_SIEVE_SIZE);
+}
+
+void set_memory_limit(uint64_t bytes)
+{
+  memory_limit = bytes;
+
+  // the cached memory of the threads
+  // may exceed the new limit
+  if (bytes)
+    MemoryPool::releaseAll();
+}
+
+uint64_t get_memory_limit()
+{
+  return memory_limit;
+}
+
+void set_iterator_memory_limit(uint64_t bytes)
+{
+  if (!bytes)
+    bytes = config::MAX_CACHE_ITERATOR;
+
+  iterator_memory_limit = bytes;
+}
+
+uint64_t get_iterator_memory_limit()
+{
+  return iterator_memory_limit;
+}
+
+void set_iterator_growth(int factor)
+{
+  iterator_growth = inBetween(1, factor, 64);
+}
+
+int get_iterator_growth()
+{
+  return iterator_growth;
+}
+
+void set_iterator_compression(bool enable)
+{
+  iterator_compression = enable;
+}
+
+bool get_iterator_compression()
+{
+  return iterator_compression;
 }
 
 int get_sieve_size()
 {
   // user specified sieve size
-  if (sieve_size)
-    return sieve_size;
+  int size = sieve_size;
+  if (size)
+    return size;
 
-  size_t l1CacheSize = cpuInfo.l1CacheSize();
-  size_t l2CacheSize = cpuInfo.l2CacheSize();
+  return cpuInfo.sieveSize(get_num_threads());
+}
 
-  // convert bytes to KiB
-  l1CacheSize >>= 10;
-  l2CacheSize >>= 10;
+int tunedSieveSize(uint64_t start, uint64_t stop, int threads)
+{
+  int size = sieve_size;
+  if (size)
+    return size;
 
-  // check if each CPU core has a private L2 cache
-  if (cpuInfo.hasL2Cache() &&
-      cpuInfo.hasPrivateL2Cache() &&
-      l2CacheSize > l1CacheSize)
-  {
-    l2CacheSize = inBetween(32, l2CacheSize, 4096);
-    l2CacheSize = floorPow2(l2CacheSize);
-    return (int) l2CacheSize;
-  }
-  else
-  {
-    if (!cpuInfo.hasL1Cache())
-      l1CacheSize = 32;
+  size = getTuning(stop).sieveSize;
 
-    // if the CPU does not have an L2 cache or if the
-    // cache is shared between all CPU cores we
-    // set the sieve size to the CPU's L1 cache size
+  // --autotune measures the sieve size using 1 thread,
+  // more threads may share the caches of a CPU core
+  if (size)
+    size = std::max(8, (int) ((int64_t) size * cpuInfo.sieveSize(threads) / cpuInfo.sieveSize(1)));
+  else
+    size = Tuning::builtinSieveSize(stop, threads);
 
-    l1CacheSize = inBetween(8, l1CacheSize, 4096);
-    l1CacheSize = floorPow2(l1CacheSize);
-    return (int) l1CacheSize;
+  // 1 byte of the sieve array holds 30 numbers
+  if (start <= stop)
+  {
+    uint64_t kib = (stop - start) / (30 << 10) + 1;
+    if (!isPow2(kib))
+      kib = floorPow2(kib) * 2;
+    kib = std::max(kib, (uint64_t) 8);
+    size = (int) std::min((uint64_t) size, kib);
   }
+
+  return size;
 }
 
 } // namespace
@@ -0,0 +1,186 @@
+///
+/// @file   autotune.cpp
+/// @brief  primesieve --autotune benchmarks candidate sieve sizes,
+///         EratSmall/EratMedium factors and minimum thread
+///         distances for bands of stop numbers and writes the
+///         fastest values to the tuning file, which is loaded
+///         by libprimesieve at startup (see Tuning.hpp).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include "cmdoptions.hpp"
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/Tuning.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+  #include <direct.h>
+#else
+  #include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+struct Band
+{
+  uint64_t maxStop;
+  /// The benchmarks sieve [start, start + distance]
+  uint64_t start;
+};
+
+const uint64_t distance = (uint64_t) 1e9;
+
+/// Create the missing parent directories of the file
+void createDirectories(const string& filename)
+{
+  for (size_t pos = filename.find_first_of("/\\", 1);
+       pos != string::npos;
+       pos = filename.find_first_of("/\\", pos + 1))
+  {
+    string dir = filename.substr(0, pos);
+#if defined(_WIN32)
+    _mkdir(dir.c_str());
+#else
+    mkdir(dir.c_str(), 0755);
+#endif
+  }
+}
+
+/// Best time of 2 runs using the candidate tuning
+double benchmark(const TuningBand& band, uint64_t start, int threads)
+{
+  Tuning tuning;
+  tuning.add(band);
+  setTuning(tuning);
+  double seconds = numeric_limits<double>::max();
+
+  for (int i = 0; i < 2; i++)
+  {
+    ParallelSieve ps;
+    ps.setNumThreads(threads);
+    ps.countPrimes(start, start + distance * threads);
+    seconds = min(seconds, ps.getSeconds());
+  }
+
+  return seconds;
+}
+
+/// Try the candidate values of one parameter,
+/// keep the fastest value.
+///
+template <typename T>
+void tune(TuningBand& band,
+          T TuningBand::* param,
+          const vector<T>& candidates,
+          uint64_t start,
+          int threads)
+{
+  TuningBand best = band;
+  double bestSeconds = benchmark(band, start, threads);
+
+  for (T value : candidates)
+  {
+    TuningBand candidate = band;
+    candidate.*param = value;
+    double seconds = benchmark(candidate, start, threads);
+
+    if (seconds < bestSeconds)
+    {
+      best = candidate;
+      bestSeconds = seconds;
+    }
+  }
+
+  band = best;
+}
+
+vector<int> sieveSizes()
+{
+  vector<int> sizes = { cpuInfo.sieveSize(1) };
+
+  for (int size = 16; size <= 4096; size *= 2)
+    if (size != sizes[0])
+      sizes.push_back(size);
+
+  return sizes;
+}
+
+} // namespace
+
+/// The parameters are tuned one after another, the
+/// sieve size first as it determines the L1/L2 block
+/// sizes used by EratSmall and EratMedium.
+///
+void autotune(CmdOptions& opt)
+{
+  string filename = opt.tuningFile;
+  if (filename.empty())
+    filename = Tuning::defaultFilename();
+  if (filename.empty())
+    throw primesieve_error("no default tuning file location, use --autotune=<F>");
+
+  int threads = opt.threads ? opt.threads : get_num_threads();
+  threads = min(threads, ParallelSieve::getMaxThreads());
+
+  vector<Band> bands =
+  {
+    { (uint64_t) 1e11, (uint64_t) 1e10 },
+    { (uint64_t) 1e13, (uint64_t) 1e12 },
+    { (uint64_t) 1e15, (uint64_t) 1e14 },
+    { (uint64_t) 1e17, (uint64_t) 1e16 },
+    { numeric_limits<uint64_t>::max(), (uint64_t) 1e18 }
+  };
+
+  Tuning tuning;
+
+  for (auto& b : bands)
+  {
+    TuningBand band = Tuning::defaults(b.maxStop);
+    band.sieveSize = cpuInfo.sieveSize(1);
+
+    tune(band, &TuningBand::sieveSize, sieveSizes(), b.start, 1);
+    tune(band, &TuningBand::factorEratSmall, { 0.25, 0.5, 0.75, 1.0, 1.5 }, b.start, 1);
+    tune(band, &TuningBand::factorEratMedium, { 1.5, 2.0, 2.5, 3.0, 4.0 }, b.start, 1);
+
+    // the minimum thread distance only
+    // matters if there are multiple threads
+    if (threads > 1)
+    {
+      vector<uint64_t> distances = { (uint64_t) 1e6, (uint64_t) 1e7, (uint64_t) 1e8 };
+      tune(band, &TuningBand::minThreadDistance, distances, b.start, threads);
+    }
+
+    tuning.add(band);
+
+    cout << "Stop <= " << band.maxStop
+         << ": sieve size = " << band.sieveSize << " KiB"
+         << ", EratSmall = " << band.factorEratSmall
+         << ", EratMedium = " << band.factorEratMedium
+         << ", thread distance = " << band.minThreadDistance << endl;
+  }
+
+  createDirectories(filename);
+  tuning.save(filename);
+  setTuning(tuning);
+
+  cout << "Tuning file: " << filename << endl;
+}
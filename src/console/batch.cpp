@@ -0,0 +1,197 @@
+///
+/// @file   batch.cpp
+/// @brief  primesieve --batch[=SOCKET] reads commands line by
+///         line from stdin (or from the clients of a Unix domain
+///         or TCP socket) and runs them using a primesieve::context,
+///         hence the thread pool and the cached sieving primes
+///         are reused by all commands. Commands:
+///
+///         count[K+] START STOP Count primes (K = 1) and prime
+///                              k-tuplets (K <= 6) in a single
+///                              pass, e.g. count12 writes the
+///                              counts of primes and twins
+///         nth N [START]        Nth prime
+///         print START STOP     Primes one per line, followed
+///                              by an empty line
+///         quit                 Close the connection
+///
+///         The numbers may be expressions e.g. 1e10 or 2^32.
+///         Each command writes one line (print: a block of
+///         lines), errors are written as "error: <message>".
+///         primesieve --nodes uses this protocol over TCP.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include "cmdoptions.hpp"
+#include "socket.hpp"
+
+#include <primesieve.hpp>
+#include <primesieve/calculator.hpp>
+#include <primesieve/context.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <exception>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+uint64_t toNumber(const string& str)
+{
+  return calculator::eval<uint64_t>(str);
+}
+
+void printPrimes(uint64_t start, uint64_t stop, ostream& out)
+{
+  // next_prime() returns 2^64 - 1 (not a
+  // prime) after the largest prime < 2^64
+  stop = min(stop, get_max_stop() - 1);
+  // next_prime() returns the primes > start - 1
+  primesieve::iterator it((start > 0) ? start - 1 : 0, stop);
+  ostringstream buffer;
+  uint64_t prime = it.next_prime();
+
+  for (; prime <= stop; prime = it.next_prime())
+  {
+    buffer << prime << '\n';
+    if (buffer.tellp() > (1 << 16))
+    {
+      out << buffer.str();
+      buffer.str("");
+    }
+  }
+
+  buffer << '\n';
+  out << buffer.str();
+}
+
+/// count12 START STOP: counts of the primes and twins
+void count(context& ctx, const string& ks, uint64_t start, uint64_t stop, ostream& out)
+{
+  int kmask = 0;
+
+  for (char k : ks)
+  {
+    if (k < '1' || k > '6')
+      throw primesieve_error("invalid command count" + ks);
+    kmask |= 1 << (k - '1');
+  }
+
+  uint64_t counts[6];
+  ctx.count(start, stop, kmask, counts);
+
+  for (size_t i = 0; i < ks.size(); i++)
+    out << (i ? " " : "") << counts[ks[i] - '1'];
+
+  out << '\n';
+}
+
+/// @return false for quit
+bool runCommand(context& ctx, const string& line, ostream& out)
+{
+  istringstream in(line);
+  vector<string> args;
+  string arg;
+
+  while (in >> arg)
+    args.push_back(arg);
+
+  if (args.empty())
+    return true;
+
+  string& cmd = args[0];
+
+  if (cmd == "quit")
+    return false;
+
+  if (cmd.compare(0, 5, "count") == 0 && args.size() == 3)
+  {
+    string ks = (cmd.size() == 5) ? "1" : cmd.substr(5);
+    count(ctx, ks, toNumber(args[1]), toNumber(args[2]), out);
+  }
+  else if (cmd == "nth" && (args.size() == 2 || args.size() == 3))
+  {
+    int64_t n = calculator::eval<int64_t>(args[1]);
+    uint64_t start = (args.size() == 3) ? toNumber(args[2]) : 0;
+    out << ctx.nth_prime(n, start) << '\n';
+  }
+  else if (cmd == "print" && args.size() == 3)
+    printPrimes(toNumber(args[1]), toNumber(args[2]), out);
+  else
+    throw primesieve_error("invalid command: " + line);
+
+  return true;
+}
+
+/// Run the commands until end of input or quit
+void runBatch(context& ctx, istream& in, ostream& out)
+{
+  string line;
+
+  while (getline(in, line))
+  {
+    try
+    {
+      if (!runCommand(ctx, line, out))
+        break;
+    }
+    catch (exception& e)
+    {
+      out << "error: " << e.what() << '\n';
+    }
+
+    out.flush();
+  }
+}
+
+/// Each client is served by its own thread,
+/// all clients share the context.
+///
+void runServer(context& ctx, const string& address)
+{
+  int server = listenSocket(address);
+
+  while (true)
+  {
+    int client = acceptSocket(server);
+    if (client < 0)
+      continue;
+
+    thread([&ctx, client]() {
+      SocketBuf buf(client);
+      istream in(&buf);
+      ostream out(&buf);
+      runBatch(ctx, in, out);
+    }).detach();
+  }
+}
+
+} // namespace
+
+void batch(CmdOptions& opt)
+{
+  context ctx;
+
+  if (opt.sieveSize)
+    ctx.set_sieve_size(opt.sieveSize);
+  if (opt.threads)
+    ctx.set_num_threads(opt.threads);
+  if (opt.pinThreads)
+    ctx.set_pin_threads(true);
+
+  if (opt.batchSocket.empty())
+    runBatch(ctx, cin, cout);
+  else
+    runServer(ctx, opt.batchSocket);
+}
@@ -14,12 +14,14 @@
 #include <primesieve/calculator.hpp>
 #include <primesieve/CpuInfo.hpp>
 #include <primesieve/PrimeSieve.hpp>
+#include <primesieve/PrintFormat.hpp>
 #include <primesieve/primesieve_error.hpp>
 
 #include <cstddef>
 #include <cstdlib>
 #include <iostream>
 #include <map>
+#include <sstream>
 #include <stdint.h>
 #include <string>
 
@@ -46,48 +48,92 @@ struct Option
       throw primesieve_error("missing value for option " + str);
     return calculator::eval<T>(val);
   }
+
+  /// e.g. "--format=u64" -> "u64",
+  /// for values that are not numbers
+  string getString() const
+  {
+    size_t pos = str.find('=');
+    if (pos == string::npos || pos + 1 == str.size())
+      throw primesieve_error("missing value for option " + str);
+    return str.substr(pos + 1);
+  }
 };
 
 enum OptionID
 {
+  OPTION_ARCHIVE,
+  OPTION_AUTOTUNE,
+  OPTION_BATCH,
+  OPTION_BINS,
+  OPTION_CHAIN,
+  OPTION_CHECKPOINT,
   OPTION_COUNT,
   OPTION_CPU_INFO,
+  OPTION_FORMAT,
+  OPTION_GAPS,
+  OPTION_GPU,
   OPTION_HELP,
+  OPTION_NODES,
   OPTION_NTHPRIME,
   OPTION_NO_STATUS,
   OPTION_NUMBER,
   OPTION_DISTANCE,
+  OPTION_PI_TABLE,
+  OPTION_PIN,
   OPTION_PRINT,
   OPTION_QUIET,
+  OPTION_SAFE,
+  OPTION_SIEVING_CACHE,
   OPTION_SIZE,
+  OPTION_STATS,
+  OPTION_SUM,
   OPTION_THREADS,
   OPTION_TIME,
+  OPTION_TRACE,
   OPTION_VERSION
 };
 
 /// Command-line options
 map<string, OptionID> optionMap =
 {
+  { "--archive",   OPTION_ARCHIVE },
+  { "--autotune",  OPTION_AUTOTUNE },
+  { "--batch",     OPTION_BATCH },
+  { "--bins",      OPTION_BINS },
+  { "--chain",     OPTION_CHAIN },
+  { "--checkpoint", OPTION_CHECKPOINT },
   { "-c",          OPTION_COUNT },
   { "--count",     OPTION_COUNT },
   { "--cpu-info",  OPTION_CPU_INFO },
+  { "--format",    OPTION_FORMAT },
+  { "--gaps",      OPTION_GAPS },
+  { "--gpu",       OPTION_GPU },
   { "-h",          OPTION_HELP },
   { "--help",      OPTION_HELP },
   { "-n",          OPTION_NTHPRIME },
   { "--nthprime",  OPTION_NTHPRIME },
   { "--no-status", OPTION_NO_STATUS },
+  { "--nodes",     OPTION_NODES },
   { "--number",    OPTION_NUMBER },
   { "-d",          OPTION_DISTANCE },
   { "--dist",      OPTION_DISTANCE },
+  { "--pi-table",  OPTION_PI_TABLE },
+  { "--pin",       OPTION_PIN },
   { "-p",          OPTION_PRINT },
   { "--print",     OPTION_PRINT },
   { "-q",          OPTION_QUIET },
   { "--quiet",     OPTION_QUIET },
+  { "--safe",      OPTION_SAFE },
+  { "--sieving-cache", OPTION_SIEVING_CACHE },
   { "-s",          OPTION_SIZE },
   { "--size",      OPTION_SIZE },
+  { "--stats",     OPTION_STATS },
+  { "--sum",       OPTION_SUM },
   { "-t",          OPTION_THREADS },
   { "--threads",   OPTION_THREADS },
   { "--time",      OPTION_TIME },
+  { "--trace",     OPTION_TRACE },
   { "-v",          OPTION_VERSION },
   { "--version",   OPTION_VERSION }
 };
@@ -113,6 +159,25 @@ void optionPrint(Option& opt,
   }
 }
 
+void optionFormat(Option& opt,
+                  CmdOptions& opts)
+{
+  const map<string, int> formats =
+  {
+    { "text",   FORMAT_TEXT },
+    { "u32",    FORMAT_U32 },
+    { "u64",    FORMAT_U64 },
+    { "delta8", FORMAT_DELTA8 },
+    { "varint", FORMAT_VARINT }
+  };
+
+  auto iter = formats.find(opt.getString());
+  if (iter == formats.end())
+    throw primesieve_error("invalid option " + opt.str);
+
+  opts.format = iter->second;
+}
+
 void optionCount(Option& opt,
                  CmdOptions& opts)
 {
@@ -137,6 +202,78 @@ void optionCount(Option& opt,
   }
 }
 
+/// --autotune or --autotune=<F>
+void optionAutotune(Option& opt,
+                    CmdOptions& opts)
+{
+  opts.autotune = true;
+
+  if (opt.str.find('=') != string::npos)
+    opts.tuningFile = opt.getString();
+}
+
+/// --batch or --batch=<SOCKET>
+void optionBatch(Option& opt,
+                 CmdOptions& opts)
+{
+  opts.batch = true;
+
+  if (opt.str.find('=') != string::npos)
+    opts.batchSocket = opt.getString();
+}
+
+/// --nodes=ADDR,ADDR,...
+void optionNodes(Option& opt,
+                 CmdOptions& opts)
+{
+  istringstream in(opt.getString());
+  string node;
+
+  while (getline(in, node, ','))
+    if (!node.empty())
+      opts.nodes.push_back(node);
+
+  if (opts.nodes.empty())
+    throw primesieve_error("missing value for option " + opt.str);
+}
+
+/// --stats, --stats=json, --stats=hw or --stats=json,hw
+void optionStats(Option& opt,
+                 CmdOptions& opts)
+{
+  opts.stats = true;
+
+  if (opt.str.find('=') != string::npos)
+  {
+    istringstream values(opt.getString());
+    string value;
+
+    while (getline(values, value, ','))
+    {
+      if (value == "json")
+        opts.statsJson = true;
+      else if (value == "hw")
+        opts.statsHw = true;
+      else
+        throw primesieve_error("invalid option " + opt.str);
+    }
+  }
+}
+
+/// --chain or --chain=<N>
+void optionChain(Option& opt,
+                 CmdOptions& opts)
+{
+  // by default Sophie Germain primes
+  if (opt.val.empty())
+    opt.val = "2";
+
+  opts.chain = opt.getValue<int>();
+
+  if (opts.chain < 1 || opts.chain > 64)
+    throw primesieve_error("invalid option " + opt.str);
+}
+
 /// e.g. "--thread=4" -> return "--thread"
 string getOption(const string& str)
 {
@@ -202,6 +339,11 @@ void optionCpuInfo()
   else
     cout << "Threads per core: unknown" << endl;
 
+  cout << "Available CPUs: " << cpuInfo.availableCpus();
+  if (!cpuInfo.cpuLimit().empty())
+    cout << " (limited by " << cpuInfo.cpuLimit() << ")";
+  cout << endl;
+
   if (cpuInfo.hasL1Cache())
     cout << "L1 cache size: " << cpuInfo.l1CacheSize() / (1 << 10) << " KiB" << endl;
 
@@ -238,6 +380,17 @@ void optionCpuInfo()
            << ((cpuInfo.l3Sharing() > 1) ? " threads" : " thread") << endl;
   }
 
+  if (cpuInfo.hasHybridCpu())
+  {
+    for (auto& core : cpuInfo.coreClasses())
+    {
+      cout << "Core class: " << core.cpus.size()
+           << ((core.cpus.size() > 1) ? " threads" : " thread")
+           << ", capacity " << core.capacity
+           << ", L2 cache " << core.l2CacheSize / (1 << 10) << " KiB" << endl;
+    }
+  }
+
   if (!cpuInfo.hasL1Cache() &&
       !cpuInfo.hasL2Cache() &&
       !cpuInfo.hasL3Cache())
@@ -265,15 +418,32 @@ CmdOptions parseOptions(int argc, char* argv[])
 
     switch (optionMap[opt.opt])
     {
+      case OPTION_ARCHIVE:   opts.archive = opt.getString(); break;
+      case OPTION_AUTOTUNE:  optionAutotune(opt, opts); break;
+      case OPTION_BATCH:     optionBatch(opt, opts); break;
+      case OPTION_BINS:      opts.binWidth = opt.getValue<uint64_t>(); break;
+      case OPTION_CHAIN:     optionChain(opt, opts); break;
+      case OPTION_CHECKPOINT: opts.checkpoint = opt.getString(); break;
       case OPTION_COUNT:     optionCount(opt, opts); break;
       case OPTION_CPU_INFO:  optionCpuInfo(); break;
+      case OPTION_FORMAT:    optionFormat(opt, opts); break;
+      case OPTION_GAPS:      opts.gaps = true; break;
+      case OPTION_GPU:       opts.gpu = true; break;
       case OPTION_PRINT:     optionPrint(opt, opts); break;
       case OPTION_SIZE:      opts.sieveSize = opt.getValue<int>(); break;
+      case OPTION_STATS:     optionStats(opt, opts); break;
+      case OPTION_SUM:       opts.sum = true; break;
       case OPTION_THREADS:   opts.threads = opt.getValue<int>(); break;
+      case OPTION_PIN:       opts.pinThreads = true; break;
+      case OPTION_PI_TABLE:  opts.piTable = opt.getString(); break;
       case OPTION_QUIET:     opts.quiet = true; break;
+      case OPTION_SAFE:      opts.safePrimes = true; break;
+      case OPTION_SIEVING_CACHE: opts.sievingCache = opt.getString(); break;
       case OPTION_NTHPRIME:  opts.nthPrime = true; break;
+      case OPTION_NODES:     optionNodes(opt, opts); break;
       case OPTION_NO_STATUS: opts.status = false; break;
       case OPTION_TIME:      opts.time = true; break;
+      case OPTION_TRACE:     opts.trace = opt.getString(); break;
       case OPTION_NUMBER:    opts.numbers.push_back(opt.getValue<uint64_t>()); break;
       case OPTION_DISTANCE:  opts.numbers.push_back(opt.getValue<uint64_t>() + opts.numbers[0]); break;
       case OPTION_VERSION:   version(); break;
@@ -281,9 +451,41 @@ CmdOptions parseOptions(int argc, char* argv[])
     }
   }
 
+  if (opts.autotune || opts.batch)
+    return opts;
+
   if (opts.numbers.empty())
     throw primesieve_error("missing STOP number");
 
+  if (!opts.archive.empty() && (opts.flags || opts.nthPrime))
+    throw primesieve_error("--archive cannot be combined with -c, -n or -p");
+  if (!opts.piTable.empty() && (opts.flags || opts.nthPrime))
+    throw primesieve_error("--pi-table cannot be combined with -c, -n or -p");
+
+  if (!opts.nodes.empty() &&
+      ((opts.flags & ~(COUNT_SEXTUPLETS * 2 - 1)) ||
+       opts.nthPrime || opts.gaps || opts.sum || opts.binWidth ||
+       !opts.archive.empty() || !opts.piTable.empty() ||
+       !opts.checkpoint.empty()))
+    throw primesieve_error("--nodes only supports counting (-c)");
+
+  if ((opts.chain || opts.safePrimes) &&
+      ((opts.flags & ~(COUNT_PRIMES | PRINT_PRIMES)) ||
+       opts.nthPrime || !opts.nodes.empty() ||
+       !opts.archive.empty() || !opts.piTable.empty()))
+    throw primesieve_error("--chain and --safe only support -c and -p");
+
+  if (opts.format != FORMAT_TEXT)
+  {
+    int printTuplets = PRINT_TWINS | PRINT_TRIPLETS | PRINT_QUADRUPLETS |
+                       PRINT_QUINTUPLETS | PRINT_SEXTUPLETS;
+
+    if (!(opts.flags & PRINT_PRIMES) || (opts.flags & printTuplets))
+      throw primesieve_error("--format requires printing primes (-p)");
+    if (opts.format == FORMAT_U32 && opts.numbers.back() > 0xffffffff)
+      throw primesieve_error("--format=u32 requires STOP < 2^32");
+  }
+
   if (opts.quiet)
     opts.status = false;
   else
@@ -12,16 +12,39 @@
 
 #include <stdint.h>
 #include <deque>
+#include <string>
+#include <vector>
 
 struct CmdOptions
 {
   std::deque<uint64_t> numbers;
+  std::string archive;
+  std::string piTable;
+  std::string sievingCache;
+  std::string trace;
+  std::string tuningFile;
+  std::string batchSocket;
+  std::string checkpoint;
+  std::vector<std::string> nodes;
+  uint64_t binWidth = 0;
+  int chain = 0;
   int flags = 0;
+  int format = 0;
   int sieveSize = 0;
   int threads = 0;
+  bool autotune = false;
+  bool batch = false;
+  bool gpu = false;
+  bool pinThreads = false;
+  bool gaps = false;
   bool quiet = false;
+  bool safePrimes = false;
   bool nthPrime = false;
   bool status = true;
+  bool stats = false;
+  bool statsJson = false;
+  bool statsHw = false;
+  bool sum = false;
   bool time = false;
 };
 
@@ -0,0 +1,215 @@
+///
+/// @file   distributed.cpp
+/// @brief  primesieve START STOP --nodes=ADDR,ADDR,... counts the
+///         primes and prime k-tuplets using multiple machines.
+///         Each node runs primesieve --batch=:PORT, the
+///         coordinator splits [START, STOP] into ranges aligned
+///         like the ParallelSieve spans (no prime k-tuplet is
+///         split) and sends each range as a count command to the
+///         next idle node. The counts of the ranges are summed up.
+///         If a node fails its range is sieved by another node.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include "socket.hpp"
+
+#include <primesieve/ChunkScheduler.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+using Range = pair<uint64_t, uint64_t>;
+
+class Coordinator
+{
+public:
+  Coordinator(const vector<Range>& ranges, int flags, bool status) :
+    queue_(ranges.begin(), ranges.end()),
+    flags_(flags),
+    status_(status)
+  {
+    counts_.fill(0);
+    for (auto& range : ranges)
+      total_ += (double) (range.second - range.first) + 1;
+  }
+
+  /// Sieve ranges using the node until there is no work left,
+  /// the ranges of a failed node are put back into the queue.
+  ///
+  void run(const string& node)
+  {
+    Range range;
+    bool busy = false;
+
+    try
+    {
+      SocketBuf buf(connectSocket(node));
+      istream in(&buf);
+      ostream out(&buf);
+      string cmd = "count";
+
+      for (int i = 0; i < 6; i++)
+        if (flags_ & (COUNT_PRIMES << i))
+          cmd += (char) ('1' + i);
+
+      while ((busy = next(&range)))
+      {
+        out << cmd << ' ' << range.first << ' ' << range.second << endl;
+        string line;
+
+        if (!getline(in, line))
+          throw primesieve_error("connection to " + node + " lost");
+        if (line.compare(0, 6, "error:") == 0)
+          throw primesieve_error(node + ": " + line);
+
+        finish(range, line);
+        busy = false;
+      }
+    }
+    catch (exception& e)
+    {
+      fail(busy ? &range : nullptr, e.what());
+    }
+  }
+
+  counts_t getCounts() const
+  {
+    if (!queue_.empty() || inFlight_)
+      throw primesieve_error("all nodes failed, last error: " + error_);
+
+    return counts_;
+  }
+
+private:
+  deque<Range> queue_;
+  counts_t counts_;
+  int flags_;
+  bool status_;
+  int inFlight_ = 0;
+  double total_ = 0;
+  double done_ = 0;
+  double percent_ = -1;
+  string error_;
+  mutex mutex_;
+  condition_variable cond_;
+
+  /// Wait while the other nodes may still put back their range
+  bool next(Range* range)
+  {
+    unique_lock<mutex> lock(mutex_);
+    cond_.wait(lock, [&]() { return !queue_.empty() || !inFlight_; });
+
+    if (queue_.empty())
+      return false;
+
+    *range = queue_.front();
+    queue_.pop_front();
+    inFlight_++;
+    return true;
+  }
+
+  void finish(const Range& range, const string& line)
+  {
+    istringstream in(line);
+    counts_t counts;
+    counts.fill(0);
+
+    for (int i = 0; i < 6; i++)
+      if (flags_ & (COUNT_PRIMES << i))
+        in >> counts[i];
+
+    if (!in)
+      throw primesieve_error("invalid reply: " + line);
+
+    lock_guard<mutex> lock(mutex_);
+    for (int i = 0; i < 6; i++)
+      counts_[i] += counts[i];
+
+    inFlight_--;
+    done_ += (double) (range.second - range.first) + 1;
+    cond_.notify_all();
+
+    if (status_)
+    {
+      int percent = (int) (100 * done_ / total_);
+      if (percent > percent_)
+      {
+        percent_ = percent;
+        cout << '\r' << percent << '%' << flush;
+        if (percent == 100)
+          cout << endl;
+      }
+    }
+  }
+
+  void fail(const Range* range, const string& error)
+  {
+    lock_guard<mutex> lock(mutex_);
+    error_ = error;
+
+    if (range)
+    {
+      queue_.push_back(*range);
+      inFlight_--;
+    }
+
+    cond_.notify_all();
+    cerr << "primesieve: " << error << endl;
+  }
+};
+
+} // namespace
+
+/// Count the primes and prime k-tuplets in [start, stop]
+/// using the primesieve --batch workers of the nodes
+///
+counts_t distributedCount(const vector<string>& nodes,
+                          uint64_t start,
+                          uint64_t stop,
+                          int flags,
+                          bool status)
+{
+  if (nodes.empty())
+    throw primesieve_error("missing nodes");
+
+  // each node sieves its ranges using
+  // all of its threads (>= 16 chunks)
+  ParallelSieve ps;
+  ps.setStart(start);
+  ps.setStop(stop);
+  uint64_t minDist = ps.getMinDistance() * 16;
+  uint64_t parts = nodes.size() * 16;
+
+  auto ranges = ChunkScheduler::split(start, stop, parts, minDist);
+  Coordinator coordinator(ranges, flags, status);
+  vector<thread> threads;
+
+  for (auto& node : nodes)
+    threads.emplace_back([&coordinator, &node]() { coordinator.run(node); });
+
+  for (auto& t : threads)
+    t.join();
+
+  return coordinator.getCounts();
+}
@@ -27,20 +27,57 @@ const string helpMenu
   "\n"
   "Options:\n"
   "\n"
+  "          --archive=<F>   Write the primes to the prime archive file F\n"
+  "          --autotune[=F]  Measure the fastest sieve size and thresholds of\n"
+  "                          this CPU, write them to the tuning file F\n"
+  "                          (default ~/.config/primesieve/tuning.txt)\n"
+  "          --batch[=S]     Read commands from stdin (or from the socket S,\n"
+  "                          a Unix socket path or [HOST]:PORT):\n"
+  "                          count[K+] START STOP, nth N [START], print START STOP\n"
+  "          --bins=<N>      Count primes (and -c k-tuplets) in bins of width N\n"
+  "          --chain[=N]     Count (or -p print) the primes p for which p,\n"
+  "                          2p + 1, ... (N members) are prime, N <= 64\n"
+  "                          (default 2, Sophie Germain primes)\n"
+  "          --checkpoint=<F>\n"
+  "                          Save the progress of the count to the file F,\n"
+  "                          resume from F if it exists\n"
   "  -c[N+], --count[=N+]    Count primes and prime k-tuplets, N <= 6,\n"
   "                          e.g. -c1 primes, -c2 twins, -c3 triplets, ...\n"
   "          --cpu-info      Print CPU information\n"
   "  -d<N>,  --dist=<N>      Sieve the interval [START, START + N]\n"
+  "          --format=<F>    Print primes (-p) as text (default), u32, u64\n"
+  "                          (little-endian binary), delta8 (gap / 2 bytes\n"
+  "                          after the first prime as u64) or varint (gaps)\n"
+  "          --gaps          Print prime gap statistics: max gap, count and\n"
+  "                          first occurrence of each gap\n"
+  "          --gpu           Count primes on the GPU (OpenCL) if available\n"
   "  -h,     --help          Print this help menu\n"
   "  -n,     --nthprime      Calculate the nth prime,\n"
   "                          e.g. 1 100 -n finds the 1st prime > 100\n"
   "          --no-status     Turn off the progressing status\n"
+  "          --nodes=<A,..>  Count using the primesieve --batch=:PORT workers\n"
+  "                          at the addresses A (HOST:PORT)\n"
+  "          --pi-table=<F>  Write pi(k * N) for k * N <= STOP to the file F,\n"
+  "                          N = 10^9 or --bins=N\n"
+  "          --pin           Pin the threads to CPUs (NUMA aware)\n"
   "  -p[N],  --print[=N]     Print primes or prime k-tuplets, N <= 6,\n"
   "                          e.g. -p1 primes, -p2 twins, -p3 triplets, ...\n"
   "  -q,     --quiet         Quiet mode, prints less output\n"
-  "  -s<N>,  --size=<N>      Set the sieve size in KiB, N <= 4096\n"
-  "  -t<N>,  --threads=<N>   Set the number of threads, N <= CPU cores\n"
+  "          --safe          Count (or -p print) the safe primes q,\n"
+  "                          (q - 1) / 2 is prime\n"
+  "          --sieving-cache=<F>\n"
+  "                          Read the sieving primes from the file F,\n"
+  "                          F is created if it does not exist\n"
+  "  -s<N>,  --size=<N>      Set the sieve size in KiB, N <= 8192\n"
+  "          --stats[=<S>]   Print the time spent in each sieving phase\n"
+  "                          and the throughput (numbers/s, bytes/s),\n"
+  "                          S = json and/or hw (hardware counters of\n"
+  "                          each phase, Linux perf_event), e.g. json,hw\n"
+  "          --sum           Print the sum of the primes\n"
+  "  -t<N>,  --threads=<N>   Set the number of threads, N <= available CPUs\n"
   "          --time          Print the time elapsed in seconds\n"
+  "          --trace=<F>     Write the timeline of the threads to the file F\n"
+  "                          (Chrome trace JSON, chrome://tracing, Perfetto)\n"
   "  -v,     --version       Print version and license information\n"
   "\n"
   "Examples:\n"
@@ -49,6 +86,11 @@ const string helpMenu
   "  primesieve 1000 -c2     Count the twin primes below 1000\n"
   "  primesieve 1e6 --print  Print the primes below 10^6\n"
   "  primesieve 100 200 -p   Print the primes inside [100, 200]\n"
+  "  primesieve 1e6 --bins=1e5\n"
+  "                          Count the primes of 10 bins below 10^6\n"
+  "  primesieve 1e9 --chain  Count the Sophie Germain primes below 10^9\n"
+  "  primesieve 1e9 --archive=primes.bin\n"
+  "                          Store the primes below 10^9 in primes.bin\n"
 };
 
 } // namespace
@@ -8,21 +8,48 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve.hpp>
+#include <primesieve/Checkpoint.hpp>
+#include <primesieve/GpuSieve.hpp>
+#include <primesieve/Histogram.hpp>
 #include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PrimeGaps.hpp>
+#include <primesieve/PrimeSums.hpp>
+#include <primesieve/SieveStats.hpp>
+#include <primesieve/SieveTrace.hpp>
 #include "cmdoptions.hpp"
 
 #include <stdint.h>
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <exception>
+#include <fstream>
 #include <iomanip>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
+
+#if defined(_WIN32)
+  #include <fcntl.h>
+  #include <io.h>
+#endif
+
+void autotune(CmdOptions&);
+void batch(CmdOptions&);
+primesieve::counts_t distributedCount(const std::vector<std::string>& nodes,
+                                      uint64_t start,
+                                      uint64_t stop,
+                                      int flags,
+                                      bool status);
 
 using namespace std;
 using namespace primesieve;
 
 namespace {
 
-void printResults(ParallelSieve& ps, CmdOptions& opt)
+void printResults(const counts_t& counts, int flags, double seconds, CmdOptions& opt)
 {
   cout << left;
 
@@ -37,11 +64,205 @@ void printResults(ParallelSieve& ps, CmdOptions& opt)
   };
 
   for (int i = 0; i < 6; i++)
-    if (ps.isCount(i))
-      cout << text[i] << ps.getCount(i) << endl;
+    if (flags & (COUNT_PRIMES << i))
+      cout << text[i] << counts[i] << endl;
 
   if (opt.time)
-    cout << "Seconds: " << fixed << setprecision(3) << ps.getSeconds() << endl;
+    cout << "Seconds: " << fixed << setprecision(3) << seconds << endl;
+}
+
+/// One line per bin: low, high and the
+/// counts of the requested k-tuplets
+///
+void printBins(ParallelSieve& ps, const Histogram& histogram)
+{
+  ostringstream bins;
+
+  for (uint64_t i = 0; i < histogram.size(); i++)
+  {
+    bins << histogram.binLow(i) << ' ' << histogram.binHigh(i);
+    for (int k = 0; k < 6; k++)
+      if (ps.isCount(k))
+        bins << ' ' << histogram.count(i, k);
+    bins << '\n';
+  }
+
+  cout << bins.str();
+}
+
+/// One line per gap: gap, count and first prime
+void printGaps(const PrimeGaps& gaps)
+{
+  ostringstream lines;
+  lines << "Prime gaps (gap, count, first prime):" << '\n';
+
+  for (uint64_t gap = 1; gap <= gaps.maxGap(); gap++)
+    if (gaps.count(gap))
+      lines << gap << ' ' << gaps.count(gap) << ' ' << gaps.firstPrime(gap) << '\n';
+
+  uint64_t maxGap = gaps.maxGap();
+  lines << "Max prime gap: " << maxGap;
+  if (maxGap)
+    lines << " (" << gaps.firstPrime(maxGap) << ", " << gaps.firstPrime(maxGap) + maxGap << ")";
+  lines << '\n';
+
+  cout << lines.str();
+}
+
+/// Print the thread seconds spent in each sieving phase,
+/// the idle time of the threads and the throughput. If
+/// stats.hw is set the hardware events of each phase
+/// are printed as well.
+///
+void printStats(ParallelSieve& ps, const SieveStats& stats, bool json)
+{
+  const string keys[PHASES] =
+  {
+    "sieving_primes",
+    "pre_sieve",
+    "erat_small",
+    "erat_medium",
+    "erat_big",
+    "consume"
+  };
+
+  const string text[PHASES] =
+  {
+    "Sieving primes: ",
+    "Pre-sieve: ",
+    "EratSmall: ",
+    "EratMedium: ",
+    "EratBig: ",
+    ps.isPrint() ? "Print: " : "Count: "
+  };
+
+  const string hwKeys[HW_EVENTS] =
+  {
+    "cycles",
+    "instructions",
+    "branch_misses",
+    "l1d_misses",
+    "llc_misses",
+    "dtlb_misses"
+  };
+
+  const string hwText[HW_EVENTS] =
+  {
+    "Cycles",
+    "Instructions",
+    "Br. misses",
+    "L1D misses",
+    "LLC misses",
+    "dTLB misses"
+  };
+
+  HwCounters counters;
+  bool hwAvailable = stats.hw && readHwCounters(counters);
+
+  double seconds = ps.getSeconds();
+  double threadSeconds = seconds * stats.threads;
+  double other = stats.busy;
+  for (double s : stats.seconds)
+    other -= s;
+  other = max(other, 0.0);
+
+  double numbers = 0;
+  if (ps.getStart() <= ps.getStop())
+    numbers = (double) (ps.getStop() - ps.getStart()) + 1;
+
+  // 1 byte of the sieve array holds 30 numbers
+  double numbersPerSec = (seconds > 0) ? numbers / seconds : 0;
+  double bytesPerSec = numbersPerSec / 30;
+  ostringstream out;
+
+  if (json)
+  {
+    out << "{\"start\": " << ps.getStart()
+        << ", \"stop\": " << ps.getStop()
+        << ", \"sieve_size\": " << ps.getSieveSize()
+        << ", \"threads\": " << stats.threads
+        << ", \"seconds\": " << seconds
+        << ", \"phases\": {";
+    for (int i = 0; i < PHASES; i++)
+      out << "\"" << keys[i] << "\": " << stats.seconds[i] << ", ";
+    out << "\"other\": " << other
+        << ", \"idle\": " << stats.idle
+        << "}, \"numbers_per_second\": " << numbersPerSec
+        << ", \"bytes_per_second\": " << bytesPerSec;
+    if (stats.hw)
+    {
+      out << ", \"hw\": ";
+      if (!hwAvailable)
+        out << "null";
+      else
+      {
+        out << "{";
+        for (int i = 0; i < PHASES; i++)
+        {
+          out << (i ? ", " : "") << "\"" << keys[i] << "\": {";
+          for (int j = 0; j < HW_EVENTS; j++)
+            out << (j ? ", " : "") << "\"" << hwKeys[j] << "\": " << stats.events[i][j];
+          out << "}";
+        }
+        out << "}";
+      }
+    }
+    out << "}\n";
+  }
+  else
+  {
+    auto line = [&](const string& name, double s)
+    {
+      double percent = (threadSeconds > 0) ? s * 100 / threadSeconds : 0;
+      out << left << setw(17) << name << fixed << setprecision(3) << s
+          << " s (" << setprecision(1) << percent << "%)\n";
+    };
+
+    out << "Thread seconds per phase:\n";
+    for (int i = 0; i < PHASES; i++)
+      line(text[i], stats.seconds[i]);
+    line("Other: ", other);
+    line("Idle/tail: ", stats.idle);
+    out << scientific << setprecision(3);
+    out << "Numbers/s: " << numbersPerSec << '\n';
+    out << "Bytes/s: " << bytesPerSec << '\n';
+
+    if (stats.hw && !hwAvailable)
+      out << "Hardware counters: not available (perf_event)\n";
+    else if (stats.hw)
+    {
+      out << "Hardware events per phase:\n";
+      out << left << setw(17) << "" << right << setw(6) << "IPC";
+      for (int j = HW_BRANCH_MISSES; j < HW_EVENTS; j++)
+        out << setw(13) << hwText[j];
+      out << '\n';
+
+      for (int i = 0; i < PHASES; i++)
+      {
+        const HwCounters& events = stats.events[i];
+        double ipc = events[HW_CYCLES] ? (double) events[HW_INSTRUCTIONS] / events[HW_CYCLES] : 0;
+        out << left << setw(17) << text[i] << right << fixed << setprecision(2) << setw(6) << ipc;
+        out << scientific << setprecision(3);
+        for (int j = HW_BRANCH_MISSES; j < HW_EVENTS; j++)
+          out << setw(13) << (double) events[j];
+        out << '\n';
+      }
+    }
+  }
+
+  cout << out.str();
+}
+
+/// Print the primes as binary data, on Windows stdout
+/// must not convert '\n' bytes to "\r\n"
+///
+void setBinaryMode(ParallelSieve& ps, int format)
+{
+  ps.setPrintFormat(format);
+
+#if defined(_WIN32)
+  _setmode(_fileno(stdout), _O_BINARY);
+#endif
 }
 
 /// Count & print primes and prime k-tuplets
@@ -52,29 +273,105 @@ void sieve(CmdOptions& opt)
 
   if (opt.flags)
     ps.setFlags(opt.flags);
+  if (opt.format)
+    setBinaryMode(ps, opt.format);
   if (opt.sieveSize)
     ps.setSieveSize(opt.sieveSize);
   if (opt.threads)
     ps.setNumThreads(opt.threads);
-  if (ps.isPrint())
-    ps.setNumThreads(1);
+  if (opt.pinThreads)
+    set_pin_threads(true);
+  if (opt.gpu)
+    ps.setGpu(true);
   if (numbers.size() < 2)
     numbers.push_front(0);
 
   ps.setStart(numbers[0]);
   ps.setStop(numbers[1]);
+  ps.tuneSieveSize();
 
   if (!opt.quiet)
   {
-    cout << "Sieve size = " << ps.getSieveSize() << " KiB" << endl;
-    cout << "Threads = " << ps.idealNumThreads() << endl;
+    if (ps.useGpu())
+      cout << "GPU = " << gpuName() << endl;
+    else
+    {
+      cout << "Sieve size = " << ps.getSieveSize() << " KiB" << endl;
+      cout << "Threads = " << ps.idealNumThreads() << endl;
+    }
   }
 
   if (opt.status)
     ps.addFlags(PRINT_STATUS);
 
+  unique_ptr<Histogram> histogram;
+  if (opt.binWidth)
+  {
+    histogram.reset(new Histogram(numbers[0], numbers[1], opt.binWidth));
+    ps.setHistogram(histogram.get());
+  }
+
+  PrimeGaps gaps;
+  if (opt.gaps)
+    ps.setPrimeGaps(&gaps);
+
+  PrimeSums sums;
+  if (opt.sum)
+    ps.setPrimeSums(&sums);
+
+  SieveStats stats;
+  stats.hw = opt.statsHw;
+  if (opt.stats)
+    ps.setSieveStats(&stats);
+
+  SieveTrace trace;
+  if (!opt.trace.empty())
+    ps.setTrace(&trace);
+
+  unique_ptr<Checkpoint> checkpoint;
+  if (!opt.checkpoint.empty())
+  {
+    checkpoint.reset(new Checkpoint(opt.checkpoint));
+    ps.setCheckpoint(checkpoint.get());
+  }
+
   ps.sieve();
-  printResults(ps, opt);
+
+  if (!opt.trace.empty())
+    trace.write(opt.trace);
+
+  if (histogram)
+    printBins(ps, *histogram);
+  if (opt.gaps)
+    printGaps(gaps);
+  if (opt.sum)
+    cout << "Sum of primes: " << to_string(sums.sum()) << endl;
+
+  printResults(ps.getCounts(), ps.getFlags(), ps.getSeconds(), opt);
+
+  if (opt.stats)
+    printStats(ps, stats, opt.statsJson);
+}
+
+/// Count primes and prime k-tuplets using
+/// the primesieve --batch workers of --nodes
+///
+void sieveNodes(CmdOptions& opt)
+{
+  auto& numbers = opt.numbers;
+  int flags = opt.flags ? opt.flags : COUNT_PRIMES;
+
+  if (numbers.size() < 2)
+    numbers.push_front(0);
+  if (!opt.quiet)
+    cout << "Nodes = " << opt.nodes.size() << endl;
+
+  auto t1 = chrono::steady_clock::now();
+  counts_t counts = distributedCount(opt.nodes, numbers[0], numbers[1], flags, opt.status);
+  auto t2 = chrono::steady_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+
+  printResults(counts, flags, seconds.count(), opt);
 }
 
 void nthPrime(CmdOptions& opt)
@@ -88,6 +385,8 @@ void nthPrime(CmdOptions& opt)
     ps.setSieveSize(opt.sieveSize);
   if (opt.threads)
     ps.setNumThreads(opt.threads);
+  if (opt.pinThreads)
+    set_pin_threads(true);
   if (numbers.size() < 2)
     numbers.push_back(0);
 
@@ -110,6 +409,126 @@ void nthPrime(CmdOptions& opt)
     cout << "Seconds: " << fixed << setprecision(3) << ps.getSeconds() << endl;
 }
 
+/// Write the primes inside [START, STOP]
+/// to the prime archive file
+///
+void writeArchive(CmdOptions& opt)
+{
+  auto& numbers = opt.numbers;
+
+  if (opt.threads)
+    set_num_threads(opt.threads);
+  if (opt.pinThreads)
+    set_pin_threads(true);
+  if (numbers.size() < 2)
+    numbers.push_front(0);
+
+  auto t1 = chrono::steady_clock::now();
+  uint64_t primes = write_prime_archive(opt.archive, numbers[0], numbers[1]);
+  auto t2 = chrono::steady_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+
+  cout << "Primes: " << primes << endl;
+
+  if (opt.time)
+    cout << "Seconds: " << fixed << setprecision(3) << seconds.count() << endl;
+}
+
+/// Write the table pi(k * N) for k * N <= STOP
+/// with N = 10^9 or N = --bins
+///
+void writePiTable(CmdOptions& opt)
+{
+  uint64_t dist = (uint64_t) 1e9;
+
+  if (opt.binWidth)
+    dist = opt.binWidth;
+  if (opt.threads)
+    set_num_threads(opt.threads);
+  if (opt.pinThreads)
+    set_pin_threads(true);
+
+  auto t1 = chrono::steady_clock::now();
+  write_pi_table(opt.piTable, opt.numbers.back(), dist);
+  auto t2 = chrono::steady_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+
+  cout << "Entries: " << opt.numbers.back() / dist + 1 << endl;
+
+  if (opt.time)
+    cout << "Seconds: " << fixed << setprecision(3) << seconds.count() << endl;
+}
+
+/// Count or print the primes p for which p, 2p + 1, ...
+/// (--chain=N members) are all prime, or the safe primes
+///
+void chains(CmdOptions& opt)
+{
+  auto& numbers = opt.numbers;
+  int length = opt.chain ? opt.chain : 2;
+
+  if (opt.threads)
+    set_num_threads(opt.threads);
+  if (opt.pinThreads)
+    set_pin_threads(true);
+  if (numbers.size() < 2)
+    numbers.push_front(0);
+
+  auto t1 = chrono::steady_clock::now();
+  vector<uint64_t> primes;
+  uint64_t count = 0;
+
+  if (opt.flags & PRINT_PRIMES)
+  {
+    if (opt.safePrimes)
+      generate_safe_primes(numbers[0], numbers[1], &primes);
+    else
+      generate_cunningham_chains(length, numbers[0], numbers[1], &primes);
+    count = primes.size();
+  }
+  else
+  {
+    if (opt.safePrimes)
+      count = count_safe_primes(numbers[0], numbers[1]);
+    else
+      count = count_cunningham_chains(length, numbers[0], numbers[1]);
+  }
+
+  auto t2 = chrono::steady_clock::now();
+  chrono::duration<double> seconds = t2 - t1;
+
+  for (uint64_t p : primes)
+    cout << p << '\n';
+
+  if (!(opt.flags & PRINT_PRIMES) || (opt.flags & COUNT_PRIMES))
+  {
+    if (opt.safePrimes)
+      cout << "Safe primes: " << count << endl;
+    else if (length == 2)
+      cout << "Sophie Germain primes: " << count << endl;
+    else
+      cout << "Cunningham chains: " << count << endl;
+  }
+
+  if (opt.time)
+    cout << "Seconds: " << fixed << setprecision(3) << seconds.count() << endl;
+}
+
+/// The sieving cache file is written once (sieving
+/// primes <= 2^32), then memory mapped
+///
+void loadSievingCache(CmdOptions& opt)
+{
+  if (!ifstream(opt.sievingCache))
+  {
+    if (opt.threads)
+      set_num_threads(opt.threads);
+    write_sieving_cache(opt.sievingCache);
+  }
+
+  load_sieving_cache(opt.sievingCache);
+}
+
 } // namespace
 
 int main(int argc, char* argv[])
@@ -118,8 +537,23 @@ int main(int argc, char* argv[])
   {
     CmdOptions opt = parseOptions(argc, argv);
 
-    if (opt.nthPrime)
+    if (!opt.sievingCache.empty())
+      loadSievingCache(opt);
+
+    if (opt.autotune)
+      autotune(opt);
+    else if (opt.batch)
+      batch(opt);
+    else if (!opt.archive.empty())
+      writeArchive(opt);
+    else if (!opt.piTable.empty())
+      writePiTable(opt);
+    else if (opt.chain || opt.safePrimes)
+      chains(opt);
+    else if (opt.nthPrime)
       nthPrime(opt);
+    else if (!opt.nodes.empty())
+      sieveNodes(opt);
     else
       sieve(opt);
   }
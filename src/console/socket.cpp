@@ -0,0 +1,266 @@
+///
+/// @file   socket.cpp
+/// @brief  Unix domain and TCP sockets of the
+///         primesieve console application.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include "socket.hpp"
+
+#include <primesieve/primesieve_error.hpp>
+
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+  #include <netdb.h>
+  #include <netinet/in.h>
+  #include <netinet/tcp.h>
+  #include <sys/socket.h>
+  #include <sys/un.h>
+  #include <unistd.h>
+  #include <cerrno>
+  #include <cstring>
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+#if !defined(_WIN32)
+
+namespace {
+
+bool isTcp(const string& address)
+{
+  return address.find(':') != string::npos;
+}
+
+/// Resolve HOST:PORT, an empty HOST is the
+/// wildcard address if listening
+///
+addrinfo* resolve(const string& address, bool listen)
+{
+  size_t pos = address.rfind(':');
+  string host = address.substr(0, pos);
+  string port = address.substr(pos + 1);
+
+  // [::1]:PORT
+  if (host.size() >= 2 && host.front() == '[' && host.back() == ']')
+    host = host.substr(1, host.size() - 2);
+
+  addrinfo hints;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (listen)
+    hints.ai_flags = AI_PASSIVE;
+
+  addrinfo* result = nullptr;
+  int err = getaddrinfo(host.empty() ? nullptr : host.c_str(), port.c_str(), &hints, &result);
+  if (err != 0)
+    throw primesieve_error("invalid address " + address + ": " + gai_strerror(err));
+
+  return result;
+}
+
+sockaddr_un unixAddress(const string& path)
+{
+  sockaddr_un addr;
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+
+  if (path.size() >= sizeof(addr.sun_path))
+    throw primesieve_error("socket path too long: " + path);
+
+  strcpy(addr.sun_path, path.c_str());
+  return addr;
+}
+
+/// The commands and results are short
+/// lines, hence disable Nagle's algorithm
+///
+void setNoDelay(int fd)
+{
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+}
+
+} // namespace
+
+SocketBuf::SocketBuf(int fd) :
+  fd_(fd),
+  in_(1 << 12),
+  out_(1 << 16)
+{
+  setg(in_.data(), in_.data(), in_.data());
+  setp(out_.data(), out_.data() + out_.size());
+}
+
+SocketBuf::~SocketBuf()
+{
+  sync();
+  close(fd_);
+}
+
+SocketBuf::int_type SocketBuf::underflow()
+{
+  ssize_t bytes = ::read(fd_, in_.data(), in_.size());
+  if (bytes <= 0)
+    return traits_type::eof();
+
+  setg(in_.data(), in_.data(), in_.data() + bytes);
+  return traits_type::to_int_type(in_[0]);
+}
+
+SocketBuf::int_type SocketBuf::overflow(int_type c)
+{
+  if (sync() != 0)
+    return traits_type::eof();
+
+  if (!traits_type::eq_int_type(c, traits_type::eof()))
+    sputc(traits_type::to_char_type(c));
+
+  return traits_type::not_eof(c);
+}
+
+int SocketBuf::sync()
+{
+  const char* data = pbase();
+  size_t bytes = pptr() - pbase();
+
+  while (bytes > 0)
+  {
+    ssize_t n = ::write(fd_, data, bytes);
+    if (n <= 0)
+      return -1;
+    data += n;
+    bytes -= n;
+  }
+
+  setp(out_.data(), out_.data() + out_.size());
+  return 0;
+}
+
+int listenSocket(const string& address)
+{
+  if (!isTcp(address))
+  {
+    sockaddr_un addr = unixAddress(address);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(address.c_str());
+
+    if (fd < 0 ||
+        bind(fd, (sockaddr*) &addr, sizeof(addr)) != 0 ||
+        listen(fd, 16) != 0)
+      throw primesieve_error("failed to listen on " + address + ": " + strerror(errno));
+
+    return fd;
+  }
+
+  addrinfo* result = resolve(address, true);
+  int fd = -1;
+
+  for (addrinfo* ai = result; ai; ai = ai->ai_next)
+  {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0)
+      continue;
+
+    int on = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+    if (bind(fd, ai->ai_addr, ai->ai_addrlen) == 0 &&
+        listen(fd, 16) == 0)
+      break;
+
+    close(fd);
+    fd = -1;
+  }
+
+  freeaddrinfo(result);
+
+  if (fd < 0)
+    throw primesieve_error("failed to listen on " + address + ": " + strerror(errno));
+
+  return fd;
+}
+
+int acceptSocket(int server)
+{
+  int fd = accept(server, nullptr, nullptr);
+
+  // fails harmlessly for Unix domain sockets
+  if (fd >= 0)
+    setNoDelay(fd);
+
+  return fd;
+}
+
+int connectSocket(const string& address)
+{
+  if (!isTcp(address))
+  {
+    sockaddr_un addr = unixAddress(address);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (fd >= 0 && connect(fd, (sockaddr*) &addr, sizeof(addr)) == 0)
+      return fd;
+
+    if (fd >= 0)
+      close(fd);
+
+    throw primesieve_error("failed to connect to " + address + ": " + strerror(errno));
+  }
+
+  addrinfo* result = resolve(address, false);
+  int fd = -1;
+
+  for (addrinfo* ai = result; ai; ai = ai->ai_next)
+  {
+    fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+    if (fd < 0)
+      continue;
+    if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0)
+      break;
+
+    close(fd);
+    fd = -1;
+  }
+
+  freeaddrinfo(result);
+
+  if (fd < 0)
+    throw primesieve_error("failed to connect to " + address + ": " + strerror(errno));
+
+  setNoDelay(fd);
+  return fd;
+}
+
+#else
+
+SocketBuf::SocketBuf(int) { }
+SocketBuf::~SocketBuf() { }
+SocketBuf::int_type SocketBuf::underflow() { return traits_type::eof(); }
+SocketBuf::int_type SocketBuf::overflow(int_type) { return traits_type::eof(); }
+int SocketBuf::sync() { return -1; }
+
+int listenSocket(const string&)
+{
+  throw primesieve_error("sockets are not supported on Windows");
+}
+
+int acceptSocket(int)
+{
+  return -1;
+}
+
+int connectSocket(const string&)
+{
+  throw primesieve_error("sockets are not supported on Windows");
+}
+
+#endif
@@ -0,0 +1,51 @@
+///
+/// @file  socket.hpp
+///        Sockets used by primesieve --batch=<SOCKET> and
+///        primesieve --nodes. An address containing a ':' is
+///        a TCP address HOST:PORT (HOST may be empty to listen
+///        on all interfaces), else it is the path of a Unix
+///        domain socket. Not supported on Windows.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#ifndef SOCKET_HPP
+#define SOCKET_HPP
+
+#include <streambuf>
+#include <string>
+#include <vector>
+
+/// Buffered std::streambuf of a connected socket,
+/// the socket is closed by the destructor
+///
+class SocketBuf : public std::streambuf
+{
+public:
+  SocketBuf(int fd);
+  ~SocketBuf();
+  SocketBuf(const SocketBuf&) = delete;
+  SocketBuf& operator=(const SocketBuf&) = delete;
+protected:
+  int_type underflow() override;
+  int_type overflow(int_type c) override;
+  int sync() override;
+private:
+  int fd_;
+  std::vector<char> in_;
+  std::vector<char> out_;
+};
+
+/// @return Socket listening on the address
+int listenSocket(const std::string& address);
+
+/// @return Next client of the listening socket, -1 on error
+int acceptSocket(int server);
+
+/// @return Socket connected to the address
+int connectSocket(const std::string& address);
+
+#endif
@@ -0,0 +1,233 @@
+///
+/// @file   context.cpp
+/// @brief  primesieve::context owns a ThreadPool and a
+///         SievingTableCache. Since the MemoryPool is
+///         thread-local and the workers of the context keep
+///         their cached memory the sieve arrays and buckets
+///         stay warm between the calls (until
+///         release_memory() is called).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/context.hpp>
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+
+using namespace std;
+
+namespace primesieve {
+
+struct context::Impl
+{
+  atomic<int> sieveSize;
+  atomic<int> threads;
+  atomic<uint64_t> memoryLimit;
+  SievingTableCache tableCache;
+  /// Destroyed first, finishes the
+  /// queued asynchronous computations
+  ThreadPool pool;
+
+  Impl() :
+    sieveSize(0),
+    threads(0),
+    memoryLimit(0)
+  {
+    pool.setKeepMemory(true);
+  }
+
+  /// ParallelSieve using the settings,
+  /// threads and caches of the context
+  ///
+  void init(ParallelSieve& ps, const cancel_token* token)
+  {
+    int size = sieveSize;
+    int numThreads = threads;
+    if (!numThreads)
+      numThreads = ParallelSieve::getMaxThreads();
+    ps.setSieveSize(size ? size : cpuInfo.sieveSize(numThreads));
+    ps.setNumThreads(numThreads);
+    ps.setMemoryLimit(memoryLimit);
+    ps.setThreadPool(&pool);
+    ps.setSievingTableCache(&tableCache);
+    ps.setCancelToken(token);
+  }
+
+  uint64_t count(uint64_t start, uint64_t stop, int flags, const cancel_token* token)
+  {
+    ParallelSieve ps;
+    init(ps, token);
+    ps.sieve(start, stop, flags);
+    return ps.getCount(ilog2(flags));
+  }
+
+  void countAll(uint64_t start, uint64_t stop, int flags, uint64_t counts[6])
+  {
+    ParallelSieve ps;
+    init(ps, nullptr);
+    ps.sieve(start, stop, flags);
+    for (int i = 0; i < 6; i++)
+      counts[i] = ps.getCount(i);
+  }
+
+  uint64_t nthPrime(int64_t n, uint64_t start, const cancel_token* token)
+  {
+    ParallelSieve ps;
+    init(ps, token);
+    return ps.nthPrime(n, start);
+  }
+};
+
+context::context() :
+  impl_(new Impl)
+{ }
+
+/// The destructor of the ThreadPool finishes the
+/// queued asynchronous computations
+///
+context::~context()
+{ }
+
+int context::get_sieve_size() const
+{
+  int size = impl_->sieveSize;
+  return size ? size : cpuInfo.sieveSize(get_num_threads());
+}
+
+int context::get_num_threads() const
+{
+  int threads = impl_->threads;
+  return threads ? threads : ParallelSieve::getMaxThreads();
+}
+
+uint64_t context::get_memory_limit() const
+{
+  return impl_->memoryLimit;
+}
+
+bool context::get_pin_threads() const
+{
+  return impl_->pool.getPinThreads();
+}
+
+void context::set_sieve_size(int sieve_size)
+{
+  impl_->sieveSize = inBetween(8, sieve_size, (int) config::MAX_SIEVE_SIZE);
+}
+
+void context::set_num_threads(int num_threads)
+{
+  impl_->threads = inBetween(1, num_threads, ParallelSieve::getMaxThreads());
+}
+
+void context::set_memory_limit(uint64_t bytes)
+{
+  impl_->memoryLimit = bytes;
+}
+
+void context::set_pin_threads(bool pin)
+{
+  impl_->pool.setPinThreads(pin);
+}
+
+uint64_t context::nth_prime(int64_t n, uint64_t start)
+{
+  return impl_->nthPrime(n, start, nullptr);
+}
+
+uint64_t context::nth_prime(int64_t n, uint64_t start, const cancel_token& token)
+{
+  return impl_->nthPrime(n, start, &token);
+}
+
+uint64_t context::count_primes(uint64_t start, uint64_t stop)
+{
+  return impl_->count(start, stop, COUNT_PRIMES, nullptr);
+}
+
+uint64_t context::count_primes(uint64_t start, uint64_t stop, const cancel_token& token)
+{
+  return impl_->count(start, stop, COUNT_PRIMES, &token);
+}
+
+uint64_t context::count_twins(uint64_t start, uint64_t stop)
+{
+  return impl_->count(start, stop, COUNT_TWINS, nullptr);
+}
+
+uint64_t context::count_triplets(uint64_t start, uint64_t stop)
+{
+  return impl_->count(start, stop, COUNT_TRIPLETS, nullptr);
+}
+
+uint64_t context::count_quadruplets(uint64_t start, uint64_t stop)
+{
+  return impl_->count(start, stop, COUNT_QUADRUPLETS, nullptr);
+}
+
+uint64_t context::count_quintuplets(uint64_t start, uint64_t stop)
+{
+  return impl_->count(start, stop, COUNT_QUINTUPLETS, nullptr);
+}
+
+uint64_t context::count_sextuplets(uint64_t start, uint64_t stop)
+{
+  return impl_->count(start, stop, COUNT_SEXTUPLETS, nullptr);
+}
+
+void context::count(uint64_t start, uint64_t stop, int kmask, uint64_t counts[6])
+{
+  int flags = kmask & (COUNT_SEXTUPLETS * 2 - 1);
+  if (!flags)
+    throw primesieve_error("invalid kmask " + to_string(kmask));
+
+  impl_->countAll(start, stop, flags, counts);
+}
+
+std::future<uint64_t> context::nth_prime_async(int64_t n, uint64_t start)
+{
+  Impl* impl = impl_.get();
+  auto task = make_shared<packaged_task<uint64_t()>>([=]() {
+    return impl->nthPrime(n, start, nullptr);
+  });
+
+  auto future = task->get_future();
+  impl->pool.submit([task]() { (*task)(); });
+  return future;
+}
+
+std::future<uint64_t> context::count_primes_async(uint64_t start, uint64_t stop)
+{
+  Impl* impl = impl_.get();
+  auto task = make_shared<packaged_task<uint64_t()>>([=]() {
+    return impl->count(start, stop, COUNT_PRIMES, nullptr);
+  });
+
+  auto future = task->get_future();
+  impl->pool.submit([task]() { (*task)(); });
+  return future;
+}
+
+void context::clear_cache()
+{
+  impl_->tableCache.clear();
+  impl_->pool.shutdown();
+}
+
+} // namespace
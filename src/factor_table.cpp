@@ -0,0 +1,281 @@
+///
+/// @file   factor_table.cpp
+/// @brief  Segmented sieve of the multiplicative functions. For
+///         each sieving prime p <= sqrt(high) we visit the multiples
+///         of p, p^2, p^3, ... inside the segment and multiply the
+///         product of the small prime factors found so far by p.
+///         n / product is then either 1 or the only prime factor
+///         > sqrt(n), hence the only division is per number and
+///         not per multiple.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ChunkScheduler.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/factor_table.hpp>
+#include <primesieve/MemoryPool.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+class FactorSieve
+{
+public:
+  FactorSieve(uint64_t start, uint64_t stop, uint64_t segmentSize) :
+    start_(start),
+    stop_(stop),
+    segmentSize_(segmentSize),
+    product_(allocatePool<uint64_t>(segmentSize)),
+    spf_(allocatePool<uint64_t>(segmentSize)),
+    moebius_(allocatePool<int8_t>(segmentSize)),
+    phi_(allocatePool<uint64_t>(segmentSize)),
+    omega_(allocatePool<uint8_t>(segmentSize))
+  { }
+
+  /// @scheduler: Claim the segments of our span before
+  ///             sieving them, nullptr if single-threaded.
+  ///
+  void sieve(const factor_callback& callback,
+             ChunkScheduler* scheduler = nullptr,
+             int span = 0)
+  {
+    for (uint64_t low = start_; low <= stop_; low += segmentSize_)
+    {
+      uint64_t high = stop_;
+      if (stop_ - low >= segmentSize_)
+        high = low + segmentSize_ - 1;
+
+      // other threads may steal the
+      // upper part of our span
+      if (scheduler)
+      {
+        stop_ = scheduler->claim(span, high);
+        high = min(high, stop_);
+        if (low > high)
+          break;
+      }
+
+      sieveSegment(low, high);
+
+      factor_segment segment;
+      segment.low = low;
+      segment.size = (size_t) (high - low + 1);
+      segment.spf = spf_.get();
+      segment.moebius = moebius_.get();
+      segment.phi = phi_.get();
+      segment.omega = omega_.get();
+      callback(segment);
+
+      if (high >= stop_)
+        break;
+    }
+  }
+
+private:
+  uint64_t start_;
+  uint64_t stop_;
+  uint64_t segmentSize_;
+  /// Sieving primes <= sqrt(high), 32-bit
+  /// since sqrt(2^64) = 2^32
+  vector<uint32_t> primes_;
+  primesieve::iterator it_;
+  uint64_t nextPrime_ = it_.next_prime();
+  pool_ptr<uint64_t> product_;
+  pool_ptr<uint64_t> spf_;
+  pool_ptr<int8_t> moebius_;
+  pool_ptr<uint64_t> phi_;
+  pool_ptr<uint8_t> omega_;
+
+  void sieveSegment(uint64_t low, uint64_t high)
+  {
+    size_t size = (size_t) (high - low + 1);
+    uint64_t* product = product_.get();
+    uint64_t* spf = spf_.get();
+    int8_t* moebius = moebius_.get();
+    uint64_t* phi = phi_.get();
+    uint8_t* omega = omega_.get();
+
+    fill_n(product, size, 1);
+    fill_n(spf, size, 0);
+    fill_n(moebius, size, 1);
+    fill_n(phi, size, 1);
+    fill_n(omega, size, 0);
+
+    uint64_t sqrtHigh = isqrt(high);
+    for (; nextPrime_ <= sqrtHigh; nextPrime_ = it_.next_prime())
+      primes_.push_back((uint32_t) nextPrime_);
+
+    for (uint64_t p : primes_)
+    {
+      // multiples of p
+      for (uint64_t i = (p - low % p) % p; i < size; i += p)
+      {
+        product[i] *= p;
+        if (!spf[i])
+          spf[i] = p;
+        moebius[i] = -moebius[i];
+        phi[i] *= p - 1;
+        omega[i]++;
+      }
+
+      // multiples of p^2, p^3, ...
+      for (uint64_t q = p * p; q <= high; q *= p)
+      {
+        for (uint64_t i = (q - low % q) % q; i < size; i += q)
+        {
+          product[i] *= p;
+          moebius[i] = 0;
+          phi[i] *= p;
+        }
+
+        if (q > high / p)
+          break;
+      }
+    }
+
+    // prime factor > sqrt(n)
+    for (size_t i = 0; i < size; i++)
+    {
+      uint64_t n = low + i;
+      if (product[i] != n && n > 1)
+      {
+        uint64_t q = n / product[i];
+        if (!spf[i])
+          spf[i] = q;
+        moebius[i] = -moebius[i];
+        phi[i] *= q - 1;
+        omega[i]++;
+      }
+    }
+
+    // 0 is divisible by all primes, 1 by none
+    if (low == 0)
+    {
+      spf[0] = 0;
+      moebius[0] = 0;
+      phi[0] = 0;
+      omega[0] = 0;
+    }
+    if (low <= 1 && high >= 1)
+      spf[1 - low] = 1;
+  }
+};
+
+uint64_t segmentSize(uint64_t stop)
+{
+  uint64_t minSize = config::FACTOR_TABLE_SIZE;
+  return inBetween(minSize, isqrt(stop), minSize * 32);
+}
+
+/// Copy one table of each segment into the
+/// caller's array using all threads.
+///
+template <typename T, typename F>
+void fillTable(uint64_t start, uint64_t stop, T* array, F table)
+{
+  factor_tables(start, stop, 0, [&](int, const factor_segment& segment)
+  {
+    const T* src = table(segment);
+    copy(src, src + segment.size, array + (segment.low - start));
+  });
+}
+
+} // namespace
+
+namespace primesieve {
+
+void factor_tables(uint64_t start,
+                   uint64_t stop,
+                   const factor_callback& callback)
+{
+  if (start > stop)
+    return;
+
+  FactorSieve sieve(start, stop, segmentSize(stop));
+  sieve.sieve(callback);
+}
+
+/// Each thread sieves the spans handed out by
+/// the ChunkScheduler (like sieve_bitmap())
+///
+void factor_tables(uint64_t start,
+                   uint64_t stop,
+                   int threads,
+                   const parallel_factor_callback& callback)
+{
+  if (start > stop)
+    return;
+
+  if (threads <= 0)
+    threads = get_num_threads();
+
+  uint64_t minDist = config::MIN_THREAD_DISTANCE;
+  threads = (int) inBetween(1, (stop - start) / minDist, threads);
+  uint64_t size = segmentSize(stop);
+
+  if (threads == 1)
+  {
+    FactorSieve sieve(start, stop, size);
+    sieve.sieve([&](const factor_segment& segment) {
+      callback(0, segment);
+    });
+    return;
+  }
+
+  ChunkScheduler scheduler(start, stop, threads, minDist);
+  atomic<int> nextThread(0);
+
+  threadPool().run(threads, [&]() {
+    int thread = nextThread++;
+    int span = -1;
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    auto threadCallback = [&](const factor_segment& segment) {
+      callback(thread, segment);
+    };
+
+    while (scheduler.next(&span, &low, &high))
+    {
+      FactorSieve sieve(low, high, size);
+      sieve.sieve(threadCallback, &scheduler, span);
+    }
+  });
+}
+
+void smallest_prime_factors(uint64_t start, uint64_t stop, uint64_t* spf)
+{
+  fillTable(start, stop, spf, [](const factor_segment& s) { return s.spf; });
+}
+
+void moebius(uint64_t start, uint64_t stop, int8_t* mu)
+{
+  fillTable(start, stop, mu, [](const factor_segment& s) { return s.moebius; });
+}
+
+void euler_phi(uint64_t start, uint64_t stop, uint64_t* phi)
+{
+  fillTable(start, stop, phi, [](const factor_segment& s) { return s.phi; });
+}
+
+void prime_factor_counts(uint64_t start, uint64_t stop, uint8_t* omega)
+{
+  fillTable(start, stop, omega, [](const factor_segment& s) { return s.omega; });
+}
+
+} // namespace
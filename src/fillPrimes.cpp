@@ -0,0 +1,332 @@
+///
+/// @file   fillPrimes.cpp
+/// @brief  Decode the set bits of the sieve array into primes.
+///         On x86-64 CPUs the fastest kernel supported by the
+///         CPU is chosen at runtime: AVX-512 decodes each byte
+///         of the sieve array into 8 candidate primes and keeps
+///         the primes using VPCOMPRESSQ, BMI decodes 4 primes
+///         at once using TZCNT and BLSR. Else we use the
+///         portable De Bruijn bitscan of Erat::nextPrime().
+///         For primes < 2^32 the kernels are instantiated for
+///         uint32_t, the AVX-512 kernel then decodes 2 bytes of
+///         the sieve array into 16 candidate primes using
+///         VPCOMPRESSD. On ARM64 CPUs we decode 4 primes at
+///         once using RBIT and CLZ.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/fillPrimes.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/Erat.hpp>
+#include <primesieve/kernels.hpp>
+#include <primesieve/littleendian_cast.hpp>
+
+#include <stdint.h>
+#include <array>
+#include <cstring>
+#include <vector>
+
+#if defined(__GNUC__) && \
+    defined(__x86_64__)
+  #define FILL_X86
+  #include <immintrin.h>
+#elif defined(__GNUC__) && \
+      defined(__aarch64__) && \
+      __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  #define FILL_ARM
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+template <typename T>
+uint64_t fillPortable(const byte_t* sieve,
+                      uint64_t* sieveIdx,
+                      uint64_t sieveSize,
+                      uint64_t* low,
+                      T* primes,
+                      uint64_t size)
+{
+  uint64_t i = *sieveIdx;
+  uint64_t l = *low;
+  uint64_t n = 0;
+
+  for (; i < sieveSize && n + 64 <= size; i += 8)
+  {
+    uint64_t bits = littleendian_cast<uint64_t>(&sieve[i]);
+    while (bits)
+      primes[n++] = (T) Erat::nextPrime(&bits, l);
+    l += 8 * 30;
+  }
+
+  *sieveIdx = i;
+  *low = l;
+  return n;
+}
+
+#if defined(FILL_X86) || \
+    defined(FILL_ARM)
+
+/// bitValues[i] = value of the i-th bit of a 64-bit word,
+/// bitValues[64] is used for TZCNT(0) = 64.
+///
+const array<uint64_t, 65> bitValues = []()
+{
+  const uint64_t wheel[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+  array<uint64_t, 65> values = { };
+  for (uint64_t i = 0; i < 64; i++)
+    values[i] = (i / 8) * 30 + wheel[i % 8];
+  return values;
+}();
+
+#endif
+
+#if defined(FILL_X86)
+
+/// Each iteration of the inner loop stores 4 primes, the
+/// remaining (unused) entries are overwritten later. Hence
+/// the loop exit is mispredicted less often than using one
+/// branch per prime.
+///
+template <typename T>
+__attribute__((target("bmi,popcnt")))
+uint64_t fillBMI(const byte_t* sieve,
+                 uint64_t* sieveIdx,
+                 uint64_t sieveSize,
+                 uint64_t* low,
+                 T* primes,
+                 uint64_t size)
+{
+  uint64_t i = *sieveIdx;
+  uint64_t l = *low;
+  uint64_t n = 0;
+
+  for (; i < sieveSize && n + 64 <= size; i += 8)
+  {
+    uint64_t bits;
+    memcpy(&bits, &sieve[i], sizeof(bits));
+    uint64_t count = _mm_popcnt_u64(bits);
+    T* p = &primes[n];
+
+    for (uint64_t j = 0; j < count; j += 4)
+    {
+      p[j + 0] = (T) (l + bitValues[_tzcnt_u64(bits)]); bits = _blsr_u64(bits);
+      p[j + 1] = (T) (l + bitValues[_tzcnt_u64(bits)]); bits = _blsr_u64(bits);
+      p[j + 2] = (T) (l + bitValues[_tzcnt_u64(bits)]); bits = _blsr_u64(bits);
+      p[j + 3] = (T) (l + bitValues[_tzcnt_u64(bits)]); bits = _blsr_u64(bits);
+    }
+
+    n += count;
+    l += 8 * 30;
+  }
+
+  *sieveIdx = i;
+  *low = l;
+  return n;
+}
+
+/// Each byte of the sieve array corresponds to the 8 numbers
+/// low + { 7, 11, 13, 17, 19, 23, 29, 31 }, VPCOMPRESSQ keeps
+/// the numbers whose bit is set. The store writes 8 entries,
+/// the unused ones are overwritten by the next byte.
+///
+__attribute__((target("avx512f,popcnt")))
+uint64_t fillAVX512(const byte_t* sieve,
+                    uint64_t* sieveIdx,
+                    uint64_t sieveSize,
+                    uint64_t* low,
+                    uint64_t* primes,
+                    uint64_t size)
+{
+  uint64_t i = *sieveIdx;
+  uint64_t l = *low;
+  uint64_t n = 0;
+
+  const __m512i wheel = _mm512_setr_epi64(7, 11, 13, 17, 19, 23, 29, 31);
+  const __m512i step = _mm512_set1_epi64(30);
+
+  for (; i < sieveSize && n + 64 <= size; i += 8)
+  {
+    uint64_t bits;
+    memcpy(&bits, &sieve[i], sizeof(bits));
+    __m512i values = _mm512_add_epi64(wheel, _mm512_set1_epi64((long long) l));
+
+    if (bits)
+    {
+      for (int j = 0; j < 8; j++)
+      {
+        __mmask8 mask = (__mmask8) (bits >> (j * 8));
+        __m512i v = _mm512_maskz_compress_epi64(mask, values);
+        _mm512_storeu_si512((void*) &primes[n], v);
+        n += _mm_popcnt_u32(mask);
+        values = _mm512_add_epi64(values, step);
+      }
+    }
+
+    l += 8 * 30;
+  }
+
+  *sieveIdx = i;
+  *low = l;
+  return n;
+}
+
+/// Each 16-bit word of the sieve array corresponds to 16
+/// numbers < 2^32, VPCOMPRESSD keeps the numbers whose bit
+/// is set. The store writes 16 entries, the unused ones are
+/// overwritten by the next 16-bit word.
+///
+__attribute__((target("avx512f,popcnt")))
+uint64_t fillAVX512(const byte_t* sieve,
+                    uint64_t* sieveIdx,
+                    uint64_t sieveSize,
+                    uint64_t* low,
+                    uint32_t* primes,
+                    uint64_t size)
+{
+  uint64_t i = *sieveIdx;
+  uint64_t l = *low;
+  uint64_t n = 0;
+
+  const __m512i wheel = _mm512_setr_epi32(7, 11, 13, 17, 19, 23, 29, 31,
+                                          37, 41, 43, 47, 49, 53, 59, 61);
+  const __m512i step = _mm512_set1_epi32(60);
+
+  for (; i < sieveSize && n + 64 <= size; i += 8)
+  {
+    uint64_t bits;
+    memcpy(&bits, &sieve[i], sizeof(bits));
+    __m512i values = _mm512_add_epi32(wheel, _mm512_set1_epi32((int) (uint32_t) l));
+
+    if (bits)
+    {
+      for (int j = 0; j < 4; j++)
+      {
+        __mmask16 mask = (__mmask16) (bits >> (j * 16));
+        __m512i v = _mm512_maskz_compress_epi32(mask, values);
+        _mm512_storeu_si512((void*) &primes[n], v);
+        n += _mm_popcnt_u32(mask);
+        values = _mm512_add_epi32(values, step);
+      }
+    }
+
+    l += 8 * 30;
+  }
+
+  *sieveIdx = i;
+  *low = l;
+  return n;
+}
+
+#endif
+
+#if defined(FILL_ARM)
+
+/// CLZ(0) = 64 on ARM64, hence the compiler
+/// removes the branch (RBIT + CLZ)
+///
+inline uint64_t ctz64(uint64_t bits)
+{
+  return bits ? __builtin_ctzll(bits) : 64;
+}
+
+/// Same as fillBMI(), the popcount uses the NEON CNT
+/// instruction and the lowest set bit is cleared
+/// using bits &= bits - 1.
+///
+template <typename T>
+uint64_t fillCTZ(const byte_t* sieve,
+                 uint64_t* sieveIdx,
+                 uint64_t sieveSize,
+                 uint64_t* low,
+                 T* primes,
+                 uint64_t size)
+{
+  uint64_t i = *sieveIdx;
+  uint64_t l = *low;
+  uint64_t n = 0;
+
+  for (; i < sieveSize && n + 64 <= size; i += 8)
+  {
+    uint64_t bits;
+    memcpy(&bits, &sieve[i], sizeof(bits));
+    uint64_t count = __builtin_popcountll(bits);
+    T* p = &primes[n];
+
+    for (uint64_t j = 0; j < count; j += 4)
+    {
+      p[j + 0] = (T) (l + bitValues[ctz64(bits)]); bits &= bits - 1;
+      p[j + 1] = (T) (l + bitValues[ctz64(bits)]); bits &= bits - 1;
+      p[j + 2] = (T) (l + bitValues[ctz64(bits)]); bits &= bits - 1;
+      p[j + 3] = (T) (l + bitValues[ctz64(bits)]); bits &= bits - 1;
+    }
+
+    n += count;
+    l += 8 * 30;
+  }
+
+  *sieveIdx = i;
+  *low = l;
+  return n;
+}
+
+#endif
+
+} // namespace
+
+namespace primesieve {
+
+/// The fastest kernel supported by the CPU is last
+template <typename T>
+vector<Kernel<FillFunc<T>>> getFillKernels()
+{
+  vector<Kernel<FillFunc<T>>> kernels;
+  kernels.push_back({ "portable", fillPortable<T> });
+
+#if defined(FILL_X86)
+  if (cpuInfo.hasBMI() &&
+      cpuInfo.hasPOPCNT())
+    kernels.push_back({ "BMI", fillBMI<T> });
+  if (cpuInfo.hasAVX512() &&
+      cpuInfo.hasPOPCNT())
+    kernels.push_back({ "AVX512", fillAVX512 });
+#elif defined(FILL_ARM)
+  if (cpuInfo.hasNEON())
+    kernels.push_back({ "CTZ", fillCTZ<T> });
+#endif
+
+  return kernels;
+}
+
+template vector<Kernel<FillFunc<uint64_t>>> getFillKernels<uint64_t>();
+template vector<Kernel<FillFunc<uint32_t>>> getFillKernels<uint32_t>();
+
+uint64_t fillPrimes(const byte_t* sieve,
+                    uint64_t* sieveIdx,
+                    uint64_t sieveSize,
+                    uint64_t* low,
+                    uint64_t* primes,
+                    uint64_t size)
+{
+  static const FillFunc<uint64_t> fillFunc = getFillKernels<uint64_t>().back().func;
+  return fillFunc(sieve, sieveIdx, sieveSize, low, primes, size);
+}
+
+uint64_t fillPrimes(const byte_t* sieve,
+                    uint64_t* sieveIdx,
+                    uint64_t sieveSize,
+                    uint64_t* low,
+                    uint32_t* primes,
+                    uint64_t size)
+{
+  static const FillFunc<uint32_t> fillFunc = getFillKernels<uint32_t>().back().func;
+  return fillFunc(sieve, sieveIdx, sieveSize, low, primes, size);
+}
+
+} // namespace
@@ -25,13 +25,13 @@ SOURCES += \
   src/main.cpp \
   src/PrimeSieveGUI.cpp \
   src/PrimeSieveGUI_menu.cpp \
-  src/PrimeSieveProcess.cpp
+  src/PrimeSieveWorker.cpp
 
 HEADERS += \
   ../../include/primesieve/calculator.hpp \
   src/PrimeSieveGUI.hpp \
   src/PrimeSieveGUI_const.hpp \
-  src/PrimeSieveProcess.hpp
+  src/PrimeSieveWorker.hpp
 
 # ---------------------------------------------------------
 # Sieve of Eratosthenes source code
@@ -40,22 +40,65 @@ HEADERS += \
 INCLUDEPATH += ../../include
 
 SOURCES += \
+  ../Affinity.cpp \
+  ../api-c.cpp \
   ../api.cpp \
+  ../Checkpoint.cpp \
+  ../ChunkScheduler.cpp \
+  ../context.cpp \
+  ../ConstellationSieve.cpp \
+  ../CountCache.cpp \
+  ../Counters.cpp \
   ../CpuInfo.cpp \
+  ../CunninghamChains.cpp \
   ../EratBig.cpp \
   ../EratMedium.cpp \
   ../EratSmall.cpp \
+  ../factor_table.cpp \
+  ../fillPrimes.cpp \
+  ../GapBuffer.cpp \
+  ../GpuSieve.cpp \
+  ../IsPrime.cpp \
+  ../iterator-c.cpp \
   ../iterator.cpp \
   ../IteratorHelper.cpp \
+  ../LargePages.cpp \
+  ../LMO.cpp \
+  ../MappedFile.cpp \
+  ../MemoryPool.cpp \
+  ../MillerRabin.cpp \
   ../PrimeGenerator.cpp \
+  ../PrimePartitions.cpp \
   ../nthPrime.cpp \
+  ../OutputSink.cpp \
   ../ParallelSieve.cpp \
+  ../PiTable.cpp \
   ../popcount.cpp \
+  ../prefetch_iterator.cpp \
+  ../prime_archive.cpp \
+  ../prime_monitor.cpp \
+  ../prime_queue.cpp \
+  ../prime_stream.cpp \
+  ../prime_table.cpp \
+  ../primes_file.cpp \
   ../PreSieve.cpp \
+  ../PrimeGaps.cpp \
   ../PrintPrimes.cpp \
-  ../SievingPrimes.cpp \
+  ../PrintQueue.cpp \
   ../PrimeSieve.cpp \
+  ../SegmentCache.cpp \
+  ../SequenceSieve.cpp \
+  ../RiemannR.cpp \
   ../Erat.cpp \
+  ../SievingPrimes.cpp \
+  ../SieveStats.cpp \
+  ../SieveTrace.cpp \
+  ../SievingTable.cpp \
+  ../StoreTuplets.cpp \
+  ../sieve_bitmap.cpp \
+  ../ThreadPool.cpp \
+  ../TupletSieve.cpp \
+  ../Tuning.cpp \
   ../Wheel.cpp
 
 # ---------------------------------------------------------
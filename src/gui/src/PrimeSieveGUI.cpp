@@ -19,7 +19,7 @@
 
 #include "PrimeSieveGUI.hpp"
 #include "ui_PrimeSieveGUI.h"
-#include "PrimeSieveProcess.hpp"
+#include "PrimeSieveWorker.hpp"
 
 #include <primesieve.hpp>
 #include <primesieve/calculator.hpp>
@@ -31,8 +31,6 @@
   #include <QtGlobal>
   #include <QCoreApplication>
   #include <QByteArray>
-  #include <QTextStream>
-  #include <QFile>
   #include <QSize>
   #include <QtWidgets/QMessageBox>
   #include <QTextCursor>
@@ -42,8 +40,6 @@
   #include <QtGlobal>
   #include <QCoreApplication>
   #include <QByteArray>
-  #include <QTextStream>
-  #include <QFile>
   #include <QSize>
   #include <QMessageBox>
   #include <QTextCursor>
@@ -55,7 +51,7 @@ using namespace primesieve;
 
 PrimeSieveGUI::PrimeSieveGUI(QWidget *parent) :
   QMainWindow(parent), ui(new Ui::PrimeSieveGUI), validator_(0),
-  primeSieveProcess_(0), saveAct_(0), quitAct_(0), aboutAct_(0),
+  primeSieveWorker_(0), saveAct_(0), quitAct_(0), aboutAct_(0),
   alignmentGroup_(0) {
   ui->setupUi(this);
   primeText_.push_back("Prime numbers");
@@ -143,7 +139,6 @@ void PrimeSieveGUI::initGUI() {
 }
 
 void PrimeSieveGUI::initConnections() {
-  connect(&progressBarTimer_,     SIGNAL(timeout()),                    this, SLOT(advanceProgressBar()));
   connect(ui->lowerBoundLineEdit, SIGNAL(textChanged(const QString &)), this, SLOT(autoSetThreads()));
   connect(ui->upperBoundLineEdit, SIGNAL(textChanged(const QString &)), this, SLOT(autoSetThreads()));
   connect(ui->autoSetCheckBox,    SIGNAL(toggled(bool)),                this, SLOT(autoSetThreads()));
@@ -251,17 +246,19 @@ void PrimeSieveGUI::on_sieveButton_clicked() {
     // reset the GUI widgets
     ui->progressBar->setValue(ui->progressBar->minimum());
     ui->textEdit->clear();
-    progressBarTimer_.start(25);
+    partialLine_.clear();
 
-    // start a new process for sieving (avoids cancel
-    // trouble with multiple threads)
-    primeSieveProcess_ = new PrimeSieveProcess(this);
+    // sieve using a separate thread, the GUI stays responsive
+    // and cancels sieving using a cancel_token
+    primeSieveWorker_ = new PrimeSieveWorker(this);
+    connect(primeSieveWorker_, SIGNAL(statusChanged(double)),
+        this, SLOT(advanceProgressBar(double)));
     if (flags_ & PRINT_FLAGS)
-      connect(primeSieveProcess_, SIGNAL(readyReadStandardOutput()),
-          this, SLOT(printProcessOutput()));
-    connect(primeSieveProcess_, SIGNAL(finished(int, QProcess::ExitStatus)),
-        this, SLOT(processFinished(int, QProcess::ExitStatus)));
-    primeSieveProcess_->start(lowerBound, upperBound, this->getSieveSize(),
+      connect(primeSieveWorker_, SIGNAL(output(QByteArray)),
+          this, SLOT(printOutput(QByteArray)));
+    connect(primeSieveWorker_, SIGNAL(finished()),
+        this, SLOT(sieveFinished()));
+    primeSieveWorker_->start(lowerBound, upperBound, this->getSieveSize(),
         flags_, this->getThreads());
 
   } catch (std::invalid_argument& ex) {
@@ -273,73 +270,58 @@ void PrimeSieveGUI::on_sieveButton_clicked() {
   }
 }
 
-void PrimeSieveGUI::advanceProgressBar() {
-  int permil = static_cast<int>(primeSieveProcess_->getStatus() * 10.0);
+/**
+ * Is executed every config::STATUS_INTERVAL while sieving, the
+ * ParallelSieve status thread sums up the progress counters of
+ * the sieving threads.
+ */
+void PrimeSieveGUI::advanceProgressBar(double percent) {
+  if (!ui->cancelButton->isEnabled())
+    return;
+  int permil = static_cast<int>(percent * 10.0);
   ui->progressBar->setValue(permil);
 }
 
 /**
- * Redirects the standard output (prime numbers or prime k-tuplets) of
- * the primeSieveProcess_ to the TextEdit.
+ * Appends the printed primes (or prime k-tuplets) of the
+ * primeSieveWorker_ to the TextEdit, line by line.
  */
-void PrimeSieveGUI::printProcessOutput() {
-  QByteArray buffer;
-  buffer.reserve(PRINT_BUFFER_SIZE + 256);
-  while (ui->cancelButton->isEnabled() && primeSieveProcess_->canReadLine()) {
-    buffer.clear();
-    while (primeSieveProcess_->canReadLine() && buffer.size() < PRINT_BUFFER_SIZE)
-      buffer.append(primeSieveProcess_->readLine(256));
-    // remove "\r\n" or '\n', '\r' at the back
-    while (buffer.endsWith('\n') ||
-           buffer.endsWith('\r'))
-      buffer.chop(1);
-    if (!buffer.isEmpty())
-      ui->textEdit->appendPlainText(buffer);
-/// @brief   Keep the GUI responsive.
-/// @bug     processEvents() crashes on Windows with MSVC 2010 and Qt 5 beta.
-/// @warning QApplication::processEvents() must not be used on
-///          operating systems that use signal recursion (like Linux
-///          X11) otherwise the stack will explode!
-#if defined(Q_OS_WIN) || defined(Q_OS_MAC) || defined(Q_OS_IOS)
-    QApplication::processEvents();
-#else
-    ui->textEdit->repaint();
-#endif
-  }
+void PrimeSieveGUI::printOutput(QByteArray output) {
+  // output of a canceled run, its worker is deleted
+  if (!ui->cancelButton->isEnabled())
+    return;
+  primeSieveWorker_->outputConsumed();
+  partialLine_.append(output);
+  int pos = partialLine_.lastIndexOf('\n');
+  if (pos < 0)
+    return;
+  QByteArray buffer = partialLine_.left(pos);
+  partialLine_.remove(0, pos + 1);
+  // remove '\r' of "\r\n" at the back
+  if (buffer.endsWith('\r'))
+    buffer.chop(1);
+  ui->textEdit->appendPlainText(buffer);
 }
 
 /**
- * Is executed when the primeSieveProcess_ finishes, checks for
- * process errors and calls this->printResults().
+ * Is executed when the primeSieveWorker_ finishes, checks for
+ * errors and calls this->printResults().
  */
-void PrimeSieveGUI::processFinished(int exitCode,
-    QProcess::ExitStatus exitStatus) {
-  // the process did not exit normally, i.e. threw and exception
-  if (exitCode != 0) {
-    // Qt uses '/' internally, even for Windows
-    QString path = QCoreApplication::applicationDirPath() + "/" + APPLICATION_NAME + "_error.txt";
-    QFile error_log(path);
-    if (error_log.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
-      QTextStream out(&error_log);
-      out << primeSieveProcess_->readAllStandardError();
-      error_log.close();
-    }
+void PrimeSieveGUI::sieveFinished() {
+  // canceled, already cleaned up
+  if (primeSieveWorker_ == 0 || primeSieveWorker_->isCancelled())
+    return;
+  QString error = primeSieveWorker_->getError();
+  if (!error.isEmpty()) {
     this->cleanUp();
     QMessageBox::critical(this, APPLICATION_NAME,
-        "The PrimeSieveProcess reported an error (see primesieve_error.txt), sieving has been aborted.");
+        "Sieving has been aborted: " + error);
   }
-  // the PrimeSieveProcess has been interrupted by a signal (SIGTERM,
-  // SIGKILL, ...) or a segmentation fault
-  else if (exitStatus == QProcess::CrashExit) {
-    this->cleanUp();
-    QMessageBox::critical(this, APPLICATION_NAME, "The PrimeSieveProcess crashed, sieving has been aborted.");
-  }
-  // the PrimeSieveProcess has finished correctly
   else {
+    if (!partialLine_.isEmpty())
+      ui->textEdit->appendPlainText(partialLine_);
     ui->progressBar->setValue(ui->progressBar->maximum());
-    // print results if not canceled lately
-    if (ui->cancelButton->isEnabled())
-      this->printResults();
+    this->printResults();
     this->cleanUp();
   }
 }
@@ -366,11 +348,11 @@ void PrimeSieveGUI::printResults() {
   // print prime counts & time elapsed
   for (int i = 0; i < primeText_.size(); i++) {
     if (flags_ & (COUNT_PRIMES << i))
-      ui->textEdit->appendPlainText(primeText_[i] + ":\t" + QString::number(primeSieveProcess_->getCount(i)));
+      ui->textEdit->appendPlainText(primeText_[i] + ":\t" + QString::number(primeSieveWorker_->getCount(i)));
   }
   if (flags_ & COUNT_KTUPLETS)
     ui->textEdit->appendPlainText("");
-  QString time("Elapsed time:\t" + QString::number(primeSieveProcess_->getSeconds(), 'f', 2) + " sec");
+  QString time("Elapsed time:\t" + QString::number(primeSieveWorker_->getSeconds(), 'f', 2) + " sec");
   ui->textEdit->appendPlainText(time);
 }
 
@@ -380,21 +362,20 @@ void PrimeSieveGUI::printResults() {
 void PrimeSieveGUI::on_cancelButton_clicked() {
   ui->cancelButton->setDisabled(true);
   ui->progressBar->setValue(0);
-  // too late to abort
-  if ((flags_ & PRINT_FLAGS) && primeSieveProcess_->isFinished())
-    return;
   this->cleanUp();
 }
 
 /**
- * Clean up after sieving is finished or canceled (abort the
- * PrimeSieveProcess if still running).
+ * Clean up after sieving is finished or canceled (cancel the
+ * PrimeSieveWorker if still running).
  */
 void PrimeSieveGUI::cleanUp() {
-  progressBarTimer_.stop();
-  if (primeSieveProcess_ != 0)
-    delete primeSieveProcess_;
-  primeSieveProcess_ = 0;
+  if (primeSieveWorker_ != 0) {
+    primeSieveWorker_->cancel();
+    delete primeSieveWorker_;
+  }
+  primeSieveWorker_ = 0;
+  partialLine_.clear();
   // invert buttons
   ui->cancelButton->setDisabled(true);
   ui->sieveButton->setEnabled(true);
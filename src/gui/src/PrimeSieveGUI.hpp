@@ -29,10 +29,9 @@
   #include <QtWidgets/QMenu>
   #include <QtWidgets/QAction>
   #include <QtWidgets/QComboBox>
-  #include <QProcess>
+  #include <QByteArray>
   #include <QVector>
   #include <QTime>
-  #include <QTimer>
   #include <QValidator>
   #include <QString>
 #else
@@ -40,11 +39,10 @@
   #include <QtGlobal>
   #include <QMenu>
   #include <QAction>
-  #include <QProcess>
+  #include <QByteArray>
   #include <QVector>
   #include <QComboBox>
   #include <QTime>
-  #include <QTimer>
   #include <QValidator>
   #include <QString>
 #endif
@@ -53,7 +51,7 @@ namespace Ui {
   class PrimeSieveGUI;
 }
 
-class PrimeSieveProcess;
+class PrimeSieveWorker;
 
 /**
  * PrimeSieveGUI is a graphical user interface for primeSieve (highly
@@ -71,9 +69,9 @@ private slots:
   void on_threadsComboBox_activated();
   void on_sieveButton_clicked();
   void on_cancelButton_clicked();
-  void advanceProgressBar();
-  void printProcessOutput();
-  void processFinished(int, QProcess::ExitStatus);
+  void advanceProgressBar(double);
+  void printOutput(QByteArray);
+  void sieveFinished();
 
   /// PrimeSieveGUI_menu.cpp
   void printMenuClicked(QAction*);
@@ -105,12 +103,12 @@ private:
   /// Validates the input of the lower and upperBoundLineEdit.
   QValidator* validator_;
   int maxThreads_;
-  /// Settings (bit flags) for PrimeSieveProcess.
+  /// Settings (bit flags) for PrimeSieveWorker.
   int flags_;
-  /// Timer for the progressBar.
-  QTimer progressBarTimer_;
-  /// Separate process used for sieving
-  PrimeSieveProcess* primeSieveProcess_;
+  /// Thread used for sieving
+  PrimeSieveWorker* primeSieveWorker_;
+  /// Printed output after the last newline
+  QByteArray partialLine_;
 
   /**
    * PrimeSieveGUI_menu.cpp & menu bar objects.
@@ -133,9 +131,9 @@ private:
   /// Use radio button like behaviour.
   QActionGroup* alignmentGroup_;
 
-  /// Count settings for PrimeSieveProcess.
+  /// Count settings for PrimeSieveWorker.
   QVector<QAction*> countAct_;
-  /// Print settings for PrimeSieveProcess.
+  /// Print settings for PrimeSieveWorker.
   QVector<QAction*> printAct_;
 };
 
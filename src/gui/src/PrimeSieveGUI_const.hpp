@@ -72,4 +72,10 @@ const QString UPPER_BOUND_STR = QString::number(UPPER_BOUND_LIMIT);
  */
 const int PRINT_BUFFER_SIZE = 1024;
 
+/**
+ * Max number of chunks queued for the TextEdit, the sieving
+ * threads wait while the GUI is behind.
+ */
+const int PRINT_QUEUE_SIZE = 64;
+
 #endif // PRIMESIEVEGUI_CONST_H
@@ -0,0 +1,174 @@
+/*
+ * PrimeSieveWorker.cpp -- This file is part of primesieve
+ *
+ * Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#include "PrimeSieveWorker.hpp"
+#include "PrimeSieveGUI_const.hpp"
+
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <exception>
+#include <ostream>
+#include <streambuf>
+#include <vector>
+
+namespace {
+
+/**
+ * Sends the printed primes to the GUI in chunks of
+ * PRINT_BUFFER_SIZE bytes.
+ */
+class OutputBuffer : public std::streambuf {
+public:
+  OutputBuffer(PrimeSieveWorker* worker) :
+    worker_(worker), buffer_(PRINT_BUFFER_SIZE) {
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+  }
+protected:
+  int_type overflow(int_type c) {
+    if (sync() != 0)
+      return traits_type::eof();
+    if (!traits_type::eq_int_type(c, traits_type::eof()))
+      sputc(traits_type::to_char_type(c));
+    return traits_type::not_eof(c);
+  }
+  int sync() {
+    int bytes = static_cast<int>(pptr() - pbase());
+    setp(buffer_.data(), buffer_.data() + buffer_.size());
+    if (bytes > 0 && !worker_->sendOutput(buffer_.data(), bytes))
+      return -1;
+    return 0;
+  }
+private:
+  PrimeSieveWorker* worker_;
+  std::vector<char> buffer_;
+};
+
+} // namespace
+
+PrimeSieveWorker::PrimeSieveWorker(QObject* parent) :
+  QThread(parent), start_(0), stop_(0), sieveSize_(0), flags_(0),
+  threads_(1), seconds_(0.0), pending_(PRINT_QUEUE_SIZE) {
+  counts_.fill(0);
+}
+
+/**
+ * Stop sieving and wait for the ParallelSieve threads.
+ */
+PrimeSieveWorker::~PrimeSieveWorker() {
+  this->disconnect();
+  this->cancel();
+  this->wait();
+}
+
+/**
+ * Sieve the primes within [start, stop] using a new thread.
+ */
+void PrimeSieveWorker::start(quint64 start, quint64 stop,
+    int sieveSize, int flags, int threads) {
+  start_ = start;
+  stop_ = stop;
+  sieveSize_ = sieveSize;
+  flags_ = flags;
+  threads_ = threads;
+  QThread::start();
+}
+
+/**
+ * Stops sieving after the current segment, thread-safe.
+ */
+void PrimeSieveWorker::cancel() {
+  token_.cancel();
+}
+
+bool PrimeSieveWorker::isCancelled() const {
+  return token_.is_cancelled();
+}
+
+/**
+ * Called by the ParallelSieve threads, blocks while too many
+ * chunks are queued for the GUI.
+ * @return false if sieving has been cancelled.
+ */
+bool PrimeSieveWorker::sendOutput(const char* data, int size) {
+  while (!pending_.tryAcquire(1, 100))
+    if (token_.is_cancelled())
+      return false;
+  emit output(QByteArray(data, size));
+  return true;
+}
+
+/**
+ * Called by the GUI once it has printed a chunk.
+ */
+void PrimeSieveWorker::outputConsumed() {
+  pending_.release();
+}
+
+void PrimeSieveWorker::run() {
+  OutputBuffer buffer(this);
+  std::ostream out(&buffer);
+  try {
+    primesieve::ParallelSieve ps;
+    ps.setStart(start_);
+    ps.setStop(stop_);
+    ps.setSieveSize(sieveSize_);
+    ps.setFlags(flags_);
+    ps.setNumThreads(threads_);
+    ps.setCancelToken(&token_);
+    ps.setOutput(&out);
+    ps.setStatusCallback([this](double percent) {
+      emit statusChanged(percent);
+    });
+    ps.sieve();
+    out.flush();
+    for (int i = 0; i < 6; i++)
+      counts_[i] = ps.getCount(i);
+    seconds_ = ps.getSeconds();
+  }
+  catch (primesieve::primesieve_cancelled&) { }
+  catch (std::exception& e) {
+    if (!token_.is_cancelled())
+      error_ = e.what();
+  }
+}
+
+/**
+ * @return The count of primes/k-tuplets within [start, stop].
+ * @pre index < 6
+ */
+quint64 PrimeSieveWorker::getCount(unsigned int index) const {
+  return counts_[index];
+}
+
+/**
+ * @return The time elapsed in seconds (if sieving is finished).
+ */
+double PrimeSieveWorker::getSeconds() const {
+  return seconds_;
+}
+
+/**
+ * @return The error message if sieving failed.
+ */
+QString PrimeSieveWorker::getError() const {
+  return error_;
+}
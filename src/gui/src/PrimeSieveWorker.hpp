@@ -0,0 +1,72 @@
+/*
+ * PrimeSieveWorker.hpp -- This file is part of primesieve
+ *
+ * Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>
+ */
+
+#ifndef PRIMESIEVEWORKER_HPP
+#define PRIMESIEVEWORKER_HPP
+
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/PrimeSieve.hpp>
+
+#include <QByteArray>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+#include <QtGlobal>
+
+/**
+ * QThread used for prime sieving, runs a multi-threaded
+ * ParallelSieve inside the GUI process. Sieving is stopped using
+ * a cancel_token, the status and the printed primes are sent to
+ * the GUI using queued signals.
+ */
+class PrimeSieveWorker : public QThread {
+Q_OBJECT
+public:
+  PrimeSieveWorker(QObject*);
+  ~PrimeSieveWorker();
+  void start(quint64, quint64, int, int, int);
+  void cancel();
+  bool sendOutput(const char*, int);
+  void outputConsumed();
+  bool isCancelled() const;
+  quint64 getCount(unsigned int) const;
+  double getSeconds() const;
+  QString getError() const;
+signals:
+  /// Status in percent, sent every config::STATUS_INTERVAL
+  void statusChanged(double);
+  /// Printed primes, one chunk of <= PRINT_BUFFER_SIZE bytes
+  void output(QByteArray);
+protected:
+  void run();
+private:
+  quint64 start_;
+  quint64 stop_;
+  int sieveSize_;
+  int flags_;
+  int threads_;
+  primesieve::counts_t counts_;
+  double seconds_;
+  QString error_;
+  primesieve::cancel_token token_;
+  /// Limits the number of chunks queued for the GUI
+  QSemaphore pending_;
+};
+
+#endif // PRIMESIEVEWORKER_HPP
@@ -9,13 +9,20 @@
 ///
 
 #include <primesieve.h>
+#include <primesieve.hpp>
 #include <primesieve/IteratorHelper.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/GapBuffer.hpp>
+#include <primesieve/MillerRabin.hpp>
 #include <primesieve/PrimeGenerator.hpp>
+#include <primesieve/SievingTable.hpp>
 #include <primesieve/types.hpp>
 
 #include <stdint.h>
+#include <algorithm>
 #include <cerrno>
 #include <exception>
+#include <memory>
 #include <vector>
 
 using namespace std;
@@ -35,11 +42,25 @@ void clearPrimeGenerator(primesieve_iterator* it)
   it->primeGenerator = nullptr;
 }
 
+/// it->vector points to an IteratorData object
+struct IteratorData
+{
+  vector<uint64_t> primes;
+  /// primesieve_prev_prime() primes not yet in primes,
+  /// see primesieve_set_iterator_compression()
+  GapBuffer gapBuffer;
+  /// Sieving primes, kept across primesieve_skipto()
+  shared_ptr<const SievingTable> sievingTable;
+};
+
+IteratorData& getData(primesieve_iterator* it)
+{
+  return *(IteratorData*) it->vector;
+}
+
 vector<uint64_t>& getPrimes(primesieve_iterator* it)
 {
-  using T = vector<uint64_t>;
-  T* primes = (T*) it->vector;
-  return *primes;
+  return getData(it).primes;
 }
 
 } // namespace
@@ -53,7 +74,7 @@ void primesieve_init(primesieve_iterator* it)
   it->i = 0;
   it->last_idx = 0;
   it->dist = PrimeGenerator::maxCachedPrime();
-  it->vector = new vector<uint64_t>;
+  it->vector = new IteratorData;
   it->primeGenerator = nullptr;
   it->is_error = false;
 }
@@ -70,6 +91,7 @@ void primesieve_skipto(primesieve_iterator* it,
   it->dist = PrimeGenerator::maxCachedPrime();
   auto& primes = getPrimes(it);
   primes.clear();
+  getData(it).gapBuffer.clear();
   clearPrimeGenerator(it);
 }
 
@@ -79,8 +101,7 @@ void primesieve_free_iterator(primesieve_iterator* it)
   if (it)
   {
     clearPrimeGenerator(it);
-    auto* primes = &getPrimes(it);
-    delete primes;
+    delete &getData(it);
   }
 }
 
@@ -88,6 +109,20 @@ void primesieve_generate_next_primes(primesieve_iterator* it)
 {
   auto& primes = getPrimes(it);
   auto primeGenerator = getPrimeGenerator(it);
+  getData(it).gapBuffer.clear();
+
+  if (primes.empty() &&
+      it->stop >= config::MIN_MILLER_RABIN)
+  {
+    primes.resize(config::MILLER_RABIN_PRIMES);
+    nextPrimes(it->stop, primes.data(), primes.size());
+    it->primes = &primes[0];
+    it->start = primes.front();
+    it->stop = primes.back();
+    it->i = 0;
+    it->last_idx = primes.size() - 1;
+    return;
+  }
 
   try
   {
@@ -96,9 +131,11 @@ void primesieve_generate_next_primes(primesieve_iterator* it)
       if (!it->primeGenerator)
       {
         IteratorHelper::next(&it->start, &it->stop, it->stop_hint, &it->dist);
-        it->primeGenerator = new PrimeGenerator(it->start, it->stop);
+        auto& sievingTable = getData(it).sievingTable;
+        IteratorHelper::updateSievingTable(it->stop, sievingTable);
+        it->primeGenerator = new PrimeGenerator(it->start, it->stop, sievingTable.get());
         primeGenerator = getPrimeGenerator(it);
-        primes.resize(64);
+        primes.resize(config::ITERATOR_BUFFER);
         it->primes = &primes[0];
       }
 
@@ -125,6 +162,120 @@ void primesieve_generate_next_primes(primesieve_iterator* it)
   it->last_idx--;
 }
 
+void primesieve_next_primes(primesieve_iterator* it,
+                            uint64_t* primes,
+                            size_t n)
+{
+  while (n > 0)
+  {
+    if (it->i++ == it->last_idx)
+      primesieve_generate_next_primes(it);
+
+    size_t count = it->last_idx - it->i + 1;
+    count = min(count, n);
+    copy_n(&it->primes[it->i], count, primes);
+    it->i += count - 1;
+    primes += count;
+    n -= count;
+  }
+}
+
+namespace {
+
+/// Copy the next primes <= stop from the iterator's buffer
+/// into the caller's buffer converting them to type T
+///
+template <typename T>
+int fillNextPrimes(primesieve_iterator* it,
+                   uint64_t stop,
+                   T* primes,
+                   size_t size,
+                   size_t* written)
+{
+  // UINT64_MAX is returned if next prime > 2^64
+  stop = min(stop, get_max_stop() - 1);
+  size_t n = 0;
+  int res = 1;
+
+  while (n < size)
+  {
+    if (it->i++ == it->last_idx)
+    {
+      primesieve_generate_next_primes(it);
+      if (it->is_error)
+      {
+        res = -1;
+        break;
+      }
+    }
+
+    const uint64_t* first = &it->primes[it->i];
+    const uint64_t* last = &it->primes[it->last_idx] + 1;
+    if (last[-1] > stop)
+      last = upper_bound(first, last, stop);
+
+    size_t count = (size_t) (last - first);
+    count = min(count, size - n);
+
+    if (count == 0)
+    {
+      // unget the first prime > stop, if it is the first
+      // prime of a new buffer we restart from it
+      if (it->i > 0)
+        it->i--;
+      else
+        primesieve_skipto(it, *first - 1, it->stop_hint);
+      res = 0;
+      break;
+    }
+
+    for (size_t j = 0; j < count; j++)
+      primes[n + j] = (T) first[j];
+
+    n += count;
+    it->i += count - 1;
+  }
+
+  if (written)
+    *written = n;
+
+  return res;
+}
+
+} // namespace
+
+int primesieve_fill_next_primes(primesieve_iterator* it,
+                                uint64_t stop,
+                                void* primes,
+                                size_t size,
+                                size_t* written,
+                                int type)
+{
+  switch (type)
+  {
+    case SHORT_PRIMES:     return fillNextPrimes(it, stop, (short*) primes, size, written);
+    case USHORT_PRIMES:    return fillNextPrimes(it, stop, (unsigned short*) primes, size, written);
+    case INT_PRIMES:       return fillNextPrimes(it, stop, (int*) primes, size, written);
+    case UINT_PRIMES:      return fillNextPrimes(it, stop, (unsigned int*) primes, size, written);
+    case LONG_PRIMES:      return fillNextPrimes(it, stop, (long*) primes, size, written);
+    case ULONG_PRIMES:     return fillNextPrimes(it, stop, (unsigned long*) primes, size, written);
+    case LONGLONG_PRIMES:  return fillNextPrimes(it, stop, (long long*) primes, size, written);
+    case ULONGLONG_PRIMES: return fillNextPrimes(it, stop, (unsigned long long*) primes, size, written);
+    case INT16_PRIMES:     return fillNextPrimes(it, stop, (int16_t*) primes, size, written);
+    case UINT16_PRIMES:    return fillNextPrimes(it, stop, (uint16_t*) primes, size, written);
+    case INT32_PRIMES:     return fillNextPrimes(it, stop, (int32_t*) primes, size, written);
+    case UINT32_PRIMES:    return fillNextPrimes(it, stop, (uint32_t*) primes, size, written);
+    case INT64_PRIMES:     return fillNextPrimes(it, stop, (int64_t*) primes, size, written);
+    case UINT64_PRIMES:    return fillNextPrimes(it, stop, (uint64_t*) primes, size, written);
+  }
+
+  if (written)
+    *written = 0;
+
+  errno = EDOM;
+  return -1;
+}
+
 void primesieve_generate_prev_primes(primesieve_iterator* it)
 {
   auto& primes = getPrimes(it);
@@ -134,23 +285,44 @@ void primesieve_generate_prev_primes(primesieve_iterator* it)
     if (it->primeGenerator)
       it->start = primes.front();
 
-    primes.clear();
-    clearPrimeGenerator(it);
+    auto& gapBuffer = getData(it).gapBuffer;
 
-    while (primes.empty())
+    // next block of the compressed interval
+    if (gapBuffer.prevPrimes(primes))
+      it->stop = primes.back();
+    else
     {
-      IteratorHelper::prev(&it->start, &it->stop, it->stop_hint, &it->dist);
-      it->primeGenerator = new PrimeGenerator(it->start, it->stop);
-      auto primeGenerator = getPrimeGenerator(it);
-      if (it->start <= 2)
-        primes.push_back(0);
-      primeGenerator->fill(primes);
+      primes.clear();
       clearPrimeGenerator(it);
+
+      while (primes.empty())
+      {
+        IteratorHelper::prev(&it->start, &it->stop, it->stop_hint, &it->dist);
+        auto& sievingTable = getData(it).sievingTable;
+        IteratorHelper::updateSievingTable(it->stop, sievingTable);
+        it->primeGenerator = new PrimeGenerator(it->start, it->stop, sievingTable.get());
+        auto primeGenerator = getPrimeGenerator(it);
+        if (it->start <= 2)
+          primes.push_back(0);
+
+        // the interval containing 2 is small
+        if (it->start > 2 && get_iterator_compression())
+        {
+          gapBuffer.fill(*primeGenerator, it->start, it->stop);
+          if (gapBuffer.prevPrimes(primes))
+            it->stop = primes.back();
+        }
+        else
+          primeGenerator->fill(primes);
+
+        clearPrimeGenerator(it);
+      }
     }
   }
   catch (exception&)
   {
     clearPrimeGenerator(it);
+    getData(it).gapBuffer.clear();
     primes.resize(1);
     primes[0] = PRIMESIEVE_ERROR;
     it->is_error = true;
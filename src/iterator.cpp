@@ -9,9 +9,16 @@
 
 #include <primesieve/iterator.hpp>
 #include <primesieve/IteratorHelper.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/GapBuffer.hpp>
+#include <primesieve/MillerRabin.hpp>
 #include <primesieve/PrimeGenerator.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve.hpp>
 
 #include <stdint.h>
+#include <algorithm>
+#include <cstddef>
 #include <vector>
 #include <memory>
 
@@ -46,19 +53,35 @@ void iterator::skipto(uint64_t start,
   last_idx_ = 0;
   dist_ = PrimeGenerator::maxCachedPrime();
   clear(primeGenerator_);
+  clear(gapBuffer_);
   primes_.clear();
 }
 
 void iterator::generate_next_primes()
 {
+  clear(gapBuffer_);
+
+  if (primes_.empty() &&
+      stop_ >= config::MIN_MILLER_RABIN)
+  {
+    primes_.resize(config::MILLER_RABIN_PRIMES);
+    nextPrimes(stop_, primes_.data(), primes_.size());
+    start_ = primes_.front();
+    stop_ = primes_.back();
+    i_ = 0;
+    last_idx_ = primes_.size() - 1;
+    return;
+  }
+
   while (true)
   {
     if (!primeGenerator_)
     {
       IteratorHelper::next(&start_, &stop_, stop_hint_, &dist_);
-      auto p = new PrimeGenerator(start_, stop_);
+      IteratorHelper::updateSievingTable(stop_, sievingTable_);
+      auto p = new PrimeGenerator(start_, stop_, sievingTable_.get());
       primeGenerator_.reset(p);
-      primes_.resize(64);
+      primes_.resize(config::ITERATOR_BUFFER);
     }
 
     for (last_idx_ = 0; !last_idx_;)
@@ -74,11 +97,50 @@ void iterator::generate_next_primes()
   last_idx_--;
 }
 
+void iterator::next_primes(const uint64_t** first,
+                           const uint64_t** last)
+{
+  if (i_++ == last_idx_)
+    generate_next_primes();
+
+  *first = &primes_[i_];
+  *last = &primes_[last_idx_] + 1;
+  i_ = last_idx_;
+}
+
+void iterator::next_primes(uint64_t* primes,
+                           std::size_t n)
+{
+  while (n > 0)
+  {
+    if (i_++ == last_idx_)
+      generate_next_primes();
+
+    std::size_t count = last_idx_ - i_ + 1;
+    count = std::min(count, n);
+    std::copy_n(&primes_[i_], count, primes);
+    i_ += count - 1;
+    primes += count;
+    n -= count;
+  }
+}
+
 void iterator::generate_prev_primes()
 {
   if (primeGenerator_)
     start_ = primes_.front();
 
+  // next block of the compressed interval, the
+  // primes > stop_ have been decoded already
+  if (gapBuffer_ &&
+      gapBuffer_->prevPrimes(primes_))
+  {
+    stop_ = primes_.back();
+    last_idx_ = primes_.size() - 1;
+    i_ = last_idx_;
+    return;
+  }
+
   primes_.clear();
 
   while (primes_.empty())
@@ -86,9 +148,22 @@ void iterator::generate_prev_primes()
     IteratorHelper::prev(&start_, &stop_, stop_hint_, &dist_);
     if (start_ <= 2)
       primes_.push_back(0);
-    auto p = new PrimeGenerator(start_, stop_);
+    IteratorHelper::updateSievingTable(stop_, sievingTable_);
+    auto p = new PrimeGenerator(start_, stop_, sievingTable_.get());
     primeGenerator_.reset(p);
-    primeGenerator_->fill(primes_);
+
+    // the interval containing 2 is small
+    if (start_ > 2 && get_iterator_compression())
+    {
+      if (!gapBuffer_)
+        gapBuffer_.reset(new GapBuffer);
+      gapBuffer_->fill(*primeGenerator_, start_, stop_);
+      if (gapBuffer_->prevPrimes(primes_))
+        stop_ = primes_.back();
+    }
+    else
+      primeGenerator_->fill(primes_);
+
     clear(primeGenerator_);
   }
 
@@ -1,5 +1,12 @@
 ///
 /// @file  nthPrime.cpp
+/// @brief The nth prime is approximated using the inverse
+///        Riemann R function: nth prime ~ R^-1(R(start) + n).
+///        The primes up to the approximation are counted
+///        once (using multiple threads, a pi(x) table or the
+///        LMO algorithm), the remaining primes are found in a
+///        small window whose parts are counted in parallel.
+///        Only the part containing the nth prime is iterated.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -7,23 +14,35 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/config.hpp>
 #include <primesieve/iterator.hpp>
 #include <primesieve/PrimeSieve.hpp>
 #include <primesieve/pmath.hpp>
 #include <primesieve/primesieve_error.hpp>
-#include <primesieve/types.hpp>
+#include <primesieve/RiemannR.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
 
 #include <stdint.h>
 #include <algorithm>
-#include <cassert>
+#include <atomic>
 #include <chrono>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 using namespace std;
 using namespace primesieve;
 
 namespace {
 
+struct Part
+{
+  uint64_t low;
+  uint64_t high;
+  uint64_t count;
+};
+
 void checkLimit(uint64_t start)
 {
   if (start >= get_max_stop())
@@ -32,66 +51,165 @@ void checkLimit(uint64_t start)
 
 void checkLowerLimit(uint64_t stop)
 {
-  if (stop == 0)
+  if (stop < 2)
     throw primesieve_error("nth prime < 2 is impossible");
 }
 
-bool sieveBackwards(int64_t n, int64_t count, uint64_t stop)
+/// R^-1(x) rounded and clamped to [min, max]
+uint64_t nthPrimeApprox(long double x, uint64_t min, uint64_t max)
 {
-  return (count >= n) &&
-        !(count == n && stop < 2);
+  if (x < 1)
+    return min;
+
+  long double t = RiemannR_inverse(x);
+  if (t >= (long double) max)
+    return max;
+  if (t <= (long double) min)
+    return min;
+
+  return (uint64_t) t;
 }
 
-// Prime count approximation
-int64_t pix(int64_t n)
+/// Distance that contains about k primes near x
+uint64_t windowDist(uint64_t x, uint64_t k)
 {
-  double x = (double) n;
-  x = max(4.0, x);
-  double pix = x / log(x);
-  return (int64_t) pix;
+  double logx = log(max(8.0, (double) x));
+  double dist = k * logx * 1.1 + maxPrimeGap((double) x);
+  dist = min(dist, (double) get_max_stop());
+
+  return (uint64_t) dist;
 }
 
-uint64_t nthPrimeDist(int64_t n, int64_t count, uint64_t start)
+/// Minimum distance of a part that is counted by a thread
+uint64_t partDist(uint64_t high)
 {
-  double x = (double) (n - count);
+  uint64_t dist = isqrt(high) / 5;
+  return max(dist, config::MIN_THREAD_DISTANCE);
+}
 
-  x = abs(x);
-  x = max(x, 4.0);
+/// Windows smaller than a part are not counted,
+/// their primes are iterated directly
+///
+bool isSmall(uint64_t x, uint64_t k)
+{
+  uint64_t dist = windowDist(x, k);
+  return dist < partDist(x);
+}
+
+/// Split [low, high] into parts and count the
+/// primes of all parts using multiple threads
+///
+vector<Part> countParts(PrimeSieve& ps, uint64_t low, uint64_t high)
+{
+  uint64_t dist = high - low;
+  int threads = ps.getNumThreads();
+  uint64_t parts = dist / partDist(high);
+  parts = inBetween(1, parts, threads * 4);
+  threads = (int) min((uint64_t) threads, parts);
+
+  vector<Part> result(parts);
+  for (uint64_t i = 0; i < parts; i++)
+  {
+    result[i].low = low + dist / parts * i;
+    result[i].high = high;
+    if (i > 0)
+      result[i - 1].high = result[i].low - 1;
+  }
 
-  // rough pi(x) approximation
-  double logx = log(x);
-  double loglogx = log(logx);
-  double pix = x * (logx + loglogx - 1);
+  // the sieving primes are shared by all parts
+  unique_ptr<SievingTable> sievingTable;
+  if (parts > 1)
+    sievingTable.reset(new SievingTable(isqrt(high), threads, ps.getSieveSize(), threadPool(), ps.getCancelToken()));
 
-  // correct start if sieving backwards to
-  // get more accurate approximation
-  if (count >= n)
+  atomic<uint64_t> part(0);
+
+  threadPool().run(threads, [&]() {
+    for (uint64_t i; (i = part++) < parts;)
+    {
+      PrimeSieve sieve;
+      sieve.setSieveSize(ps.getSieveSize());
+      sieve.setSievingTable(sievingTable.get());
+      sieve.setCancelToken(ps.getCancelToken());
+      result[i].count = sieve.countPrimes(result[i].low, result[i].high);
+    }
+  });
+
+  return result;
+}
+
+/// The kth prime of [low, high]
+uint64_t selectPrime(uint64_t low, uint64_t high, uint64_t k)
+{
+  uint64_t prime = 0;
+  primesieve::iterator it(checkedSub(low, 1), high);
+  for (; k > 0; k--)
+    prime = it.next_prime();
+
+  return prime;
+}
+
+/// Find the kth prime > x
+uint64_t nthPrimeForward(PrimeSieve& ps, uint64_t x, uint64_t k)
+{
+  if (isSmall(x, k))
   {
-    double st = start - pix;
-    st = max(0.0, st);
-    start = (uint64_t) st;
+    uint64_t prime = 0;
+    primesieve::iterator it(x, checkedAdd(x, windowDist(x, k)));
+    for (; k > 0; k--)
+      prime = it.next_prime();
+    checkLimit(prime);
+    return prime;
   }
 
-  // approximate the nth prime using:
-  // start + n * log(start + pi(n) / loglog(n))
-  double startPix = start + pix / loglogx;
-  startPix = max(4.0, startPix);
-  double logStartPix = log(startPix);
-  double dist = max(pix, x * logStartPix);
-
-  // ensure start + dist <= nth prime
-  if (count < n)
-    dist -= sqrt(dist) * log(logStartPix) * 2;
-  // ensure start + dist >= nth prime
-  if (count > n)
-    dist += sqrt(dist) * log(logStartPix) * 2;
-
-  // if n is very small:
-  // ensure start + dist >= nth prime
-  double primeGap = maxPrimeGap(startPix);
-  dist = max(dist, primeGap);
+  while (true)
+  {
+    ps.checkCancelled();
+    checkLimit(x);
+    uint64_t low = x + 1;
+    uint64_t high = checkedAdd(x, windowDist(x, k));
+    high = min(high, get_max_stop());
 
-  return (uint64_t) dist;
+    for (auto& part : countParts(ps, low, high))
+    {
+      if (part.count >= k)
+        return selectPrime(part.low, part.high, k);
+      k -= part.count;
+    }
+
+    x = high;
+  }
+}
+
+/// Find the kth prime <= x, counting downwards
+uint64_t nthPrimeBackward(PrimeSieve& ps, uint64_t x, uint64_t k)
+{
+  if (isSmall(x, k))
+  {
+    uint64_t prime = 0;
+    primesieve::iterator it(checkedAdd(x, 1), checkedSub(x, windowDist(x, k)));
+    for (; k > 0; k--)
+      prime = it.prev_prime();
+    checkLowerLimit(prime);
+    return prime;
+  }
+
+  while (true)
+  {
+    ps.checkCancelled();
+    checkLowerLimit(x);
+    uint64_t low = checkedSub(x, windowDist(x, k));
+    auto parts = countParts(ps, low, x);
+
+    for (auto part = parts.rbegin(); part != parts.rend(); part++)
+    {
+      if (part->count >= k)
+        return selectPrime(part->low, part->high, part->count - k + 1);
+      k -= part->count;
+    }
+
+    checkLowerLimit(low);
+    x = low - 1;
+  }
 }
 
 } // namespace
@@ -103,66 +221,58 @@ uint64_t PrimeSieve::nthPrime(uint64_t n)
   return nthPrime(0, n);
 }
 
+/// n > 0: nth prime > start,
+/// n = 0: first prime >= start (like Mathematica),
+/// n < 0: nth prime < start
+///
 uint64_t PrimeSieve::nthPrime(int64_t n, uint64_t start)
 {
   setStart(start);
+  checkCancelled();
   auto t1 = chrono::system_clock::now();
+  uint64_t prime;
 
   if (n == 0)
-    n = 1; // like Mathematica
-  else if (n > 0)
-    start = checkedAdd(start, 1);
-  else if (n < 0)
+  {
+    n = 1;
     start = checkedSub(start, 1);
+  }
 
-  uint64_t stop = start;
-  uint64_t dist = nthPrimeDist(n, 0, start);
-  uint64_t nthPrimeGuess = checkedAdd(start, dist);
-
-  int64_t count = 0;
-  int64_t tinyN = 100000;
-  tinyN = max(tinyN, pix(isqrt(nthPrimeGuess)));
-
-  while ((n - count) > tinyN ||
-         sieveBackwards(n, count, stop))
+  if (n > 0)
   {
-    if (count < n)
-    {
-      checkLimit(start);
-      dist = nthPrimeDist(n, count, start);
-      stop = checkedAdd(start, dist);
-      count += countPrimes(start, stop);
-      start = checkedAdd(stop, 1);
-    }
-    if (sieveBackwards(n, count, stop))
-    {
-      checkLowerLimit(stop);
-      dist = nthPrimeDist(n, count, stop);
-      start = checkedSub(start, dist);
-      count -= (int64_t) countPrimes(start, stop);
-      stop = checkedSub(start, 1);
-    }
+    checkLimit(start);
+    uint64_t k = (uint64_t) n;
+    long double x = RiemannR((long double) start) + k;
+    uint64_t guess = nthPrimeApprox(x, start, get_max_stop());
+    if (isSmall(start, k))
+      guess = start;
+    uint64_t count = 0;
+    if (guess > start)
+      count = countPrimes(start + 1, guess);
+
+    if (count < k)
+      prime = nthPrimeForward(*this, guess, k - count);
+    else
+      prime = nthPrimeBackward(*this, guess, count - k + 1);
+  }
+  else
+  {
+    uint64_t stop = checkedSub(start, 1);
+    checkLowerLimit(stop);
+    uint64_t k = (uint64_t) -(n + 1) + 1;
+    long double x = RiemannR((long double) stop) - k;
+    uint64_t guess = nthPrimeApprox(x, 0, stop);
+    if (isSmall(stop, k))
+      guess = stop;
+    uint64_t count = 0;
+    if (guess < stop)
+      count = countPrimes(guess + 1, stop);
+
+    if (count >= k)
+      prime = nthPrimeForward(*this, guess, count - k + 1);
+    else
+      prime = nthPrimeBackward(*this, guess, k - count);
   }
-
-  if (n < 0)
-    count -= 1;
-
-  // here start < nth prime,
-  // hence we can sieve forward the remaining
-  // distance and find the nth prime
-  assert(count < n);
-
-  checkLimit(start);
-  dist = nthPrimeDist(n, count, start) * 2;
-  start = checkedSub(start, 1);
-  stop = checkedAdd(start, dist);
-  uint64_t prime = 0;
-
-  for (primesieve::iterator it(start, stop); count < n; count++)
-    prime = it.next_prime();
-
-  if (~prime == 0)
-    throw primesieve_error("nth prime > 2^64");
 
   auto t2 = chrono::system_clock::now();
   chrono::duration<double> seconds = t2 - t1;
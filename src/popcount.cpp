@@ -1,7 +1,12 @@
 ///
 /// @file   popcount.cpp
-/// @brief  Fast algorithm to count the number of 1 bits in an
-///         array using only integer operations.
+/// @brief  Fast algorithms to count the number of 1 bits in an
+///         array. On x86 CPUs the fastest kernel supported by
+///         the CPU (AVX-512 VPOPCNTDQ, AVX2 Harley-Seal or
+///         POPCNT) is chosen at runtime, on ARM64 CPUs we use
+///         SVE (if enabled at compile time and supported by
+///         the CPU) or NEON. Else we use a portable Harley-Seal
+///         implementation using only integer operations.
 ///
 /// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
 ///
@@ -9,7 +14,28 @@
 /// file in the top level directory.
 ///
 
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/kernels.hpp>
+
 #include <stdint.h>
+#include <algorithm>
+#include <vector>
+
+#if defined(__GNUC__) && \
+   (defined(__x86_64__) || defined(__i386__))
+  #define POPCNT_X86
+  #include <immintrin.h>
+#elif defined(__GNUC__) && \
+      defined(__aarch64__)
+  #define POPCNT_ARM
+  #include <arm_neon.h>
+  #if defined(__ARM_FEATURE_SVE)
+    #define POPCNT_SVE
+    #include <arm_sve.h>
+  #endif
+#endif
+
+using namespace primesieve;
 
 namespace {
 
@@ -36,22 +62,18 @@ uint64_t popcount64(uint64_t x)
 ///
 void CSA(uint64_t& h, uint64_t& l, uint64_t a, uint64_t b, uint64_t c)
 {
-  uint64_t u = a ^ b; 
+  uint64_t u = a ^ b;
   h = (a & b) | (u & c);
   l = u ^ c;
 }
 
-} // namespace
-
-namespace primesieve {
-
 /// Harley-Seal popcount (4th iteration).
 /// The Harley-Seal popcount algorithm is one of the fastest algorithms
 /// for counting 1 bits in an array using only integer operations.
 /// This implementation uses only 5.69 instructions per 64-bit word.
 /// @see Chapter 5 in "Hacker's Delight" 2nd edition.
 ///
-uint64_t popcount(const uint64_t* array, uint64_t size)
+uint64_t popcountPortable(const uint64_t* array, uint64_t size)
 {
   uint64_t total = 0;
   uint64_t ones = 0, twos = 0, fours = 0, eights = 0, sixteens = 0;
@@ -92,4 +114,258 @@ uint64_t popcount(const uint64_t* array, uint64_t size)
   return total;
 }
 
+#if defined(POPCNT_X86)
+
+/// Hardware POPCNT instruction, 4 independent
+/// accumulators hide the latency of POPCNT.
+///
+__attribute__((target("popcnt")))
+uint64_t popcountPOPCNT(const uint64_t* array, uint64_t size)
+{
+  uint64_t cnt0 = 0, cnt1 = 0, cnt2 = 0, cnt3 = 0;
+  uint64_t limit = size - size % 4;
+  uint64_t i = 0;
+
+  for (; i < limit; i += 4)
+  {
+    cnt0 += __builtin_popcountll(array[i+0]);
+    cnt1 += __builtin_popcountll(array[i+1]);
+    cnt2 += __builtin_popcountll(array[i+2]);
+    cnt3 += __builtin_popcountll(array[i+3]);
+  }
+
+  for (; i < size; i++)
+    cnt0 += __builtin_popcountll(array[i]);
+
+  return cnt0 + cnt1 + cnt2 + cnt3;
+}
+
+__attribute__((target("avx2")))
+void CSA(__m256i& h, __m256i& l, __m256i a, __m256i b, __m256i c)
+{
+  __m256i u = _mm256_xor_si256(a, b);
+  h = _mm256_or_si256(_mm256_and_si256(a, b), _mm256_and_si256(u, c));
+  l = _mm256_xor_si256(u, c);
+}
+
+/// Count the bits of each byte using a 4-bit lookup table
+/// (vpshufb) and sum them up into 4 64-bit counters.
+///
+__attribute__((target("avx2")))
+__m256i popcount256(__m256i v)
+{
+  const __m256i lookup = _mm256_setr_epi8(
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+      0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+  __m256i lo = _mm256_and_si256(v, low_mask);
+  __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+  __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo),
+                                _mm256_shuffle_epi8(lookup, hi));
+
+  return _mm256_sad_epu8(cnt, _mm256_setzero_si256());
+}
+
+/// Harley-Seal popcount using AVX2, processes
+/// 16 vectors (64 words) per iteration.
+/// @see https://arxiv.org/abs/1611.07612
+///
+__attribute__((target("avx2,popcnt")))
+uint64_t popcountAVX2(const uint64_t* array, uint64_t size)
+{
+  const __m256i* a = (const __m256i*) array;
+  __m256i total = _mm256_setzero_si256();
+  __m256i ones = _mm256_setzero_si256();
+  __m256i twos = _mm256_setzero_si256();
+  __m256i fours = _mm256_setzero_si256();
+  __m256i eights = _mm256_setzero_si256();
+  __m256i sixteens, twosA, twosB, foursA, foursB, eightsA, eightsB;
+  uint64_t vectors = size / 4;
+  uint64_t limit = vectors - vectors % 16;
+  uint64_t i = 0;
+
+  for (; i < limit; i += 16)
+  {
+    CSA(twosA, ones, ones, _mm256_loadu_si256(a+i+0), _mm256_loadu_si256(a+i+1));
+    CSA(twosB, ones, ones, _mm256_loadu_si256(a+i+2), _mm256_loadu_si256(a+i+3));
+    CSA(foursA, twos, twos, twosA, twosB);
+    CSA(twosA, ones, ones, _mm256_loadu_si256(a+i+4), _mm256_loadu_si256(a+i+5));
+    CSA(twosB, ones, ones, _mm256_loadu_si256(a+i+6), _mm256_loadu_si256(a+i+7));
+    CSA(foursB, twos, twos, twosA, twosB);
+    CSA(eightsA, fours, fours, foursA, foursB);
+    CSA(twosA, ones, ones, _mm256_loadu_si256(a+i+8), _mm256_loadu_si256(a+i+9));
+    CSA(twosB, ones, ones, _mm256_loadu_si256(a+i+10), _mm256_loadu_si256(a+i+11));
+    CSA(foursA, twos, twos, twosA, twosB);
+    CSA(twosA, ones, ones, _mm256_loadu_si256(a+i+12), _mm256_loadu_si256(a+i+13));
+    CSA(twosB, ones, ones, _mm256_loadu_si256(a+i+14), _mm256_loadu_si256(a+i+15));
+    CSA(foursB, twos, twos, twosA, twosB);
+    CSA(eightsB, fours, fours, foursA, foursB);
+    CSA(sixteens, eights, eights, eightsA, eightsB);
+
+    total = _mm256_add_epi64(total, popcount256(sixteens));
+  }
+
+  total = _mm256_slli_epi64(total, 4);
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(eights), 3));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(fours), 2));
+  total = _mm256_add_epi64(total, _mm256_slli_epi64(popcount256(twos), 1));
+  total = _mm256_add_epi64(total, popcount256(ones));
+
+  for (; i < vectors; i++)
+    total = _mm256_add_epi64(total, popcount256(_mm256_loadu_si256(a+i)));
+
+  uint64_t lanes[4];
+  _mm256_storeu_si256((__m256i*) lanes, total);
+  uint64_t cnt = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+  for (i *= 4; i < size; i++)
+    cnt += __builtin_popcountll(array[i]);
+
+  return cnt;
+}
+
+/// AVX-512 VPOPCNTDQ counts the bits of 8 words
+/// per instruction, the remaining words are
+/// processed using a masked load.
+///
+__attribute__((target("avx512f,avx512vpopcntdq")))
+uint64_t popcountAVX512(const uint64_t* array, uint64_t size)
+{
+  __m512i cnt0 = _mm512_setzero_si512();
+  __m512i cnt1 = _mm512_setzero_si512();
+  uint64_t limit = size - size % 16;
+  uint64_t i = 0;
+
+  for (; i < limit; i += 16)
+  {
+    __m512i v0 = _mm512_loadu_si512((const void*) &array[i+0]);
+    __m512i v1 = _mm512_loadu_si512((const void*) &array[i+8]);
+    cnt0 = _mm512_add_epi64(cnt0, _mm512_popcnt_epi64(v0));
+    cnt1 = _mm512_add_epi64(cnt1, _mm512_popcnt_epi64(v1));
+  }
+
+  for (; i < size; i += 8)
+  {
+    uint64_t n = size - i;
+    __mmask8 mask = (__mmask8) (n >= 8 ? 0xff : (1u << n) - 1);
+    __m512i v = _mm512_maskz_loadu_epi64(mask, &array[i]);
+    cnt0 = _mm512_add_epi64(cnt0, _mm512_popcnt_epi64(v));
+  }
+
+  uint64_t lanes[8];
+  _mm512_storeu_si512((void*) lanes, _mm512_add_epi64(cnt0, cnt1));
+  uint64_t cnt = 0;
+
+  for (uint64_t lane : lanes)
+    cnt += lane;
+
+  return cnt;
+}
+
+#endif
+
+#if defined(POPCNT_ARM)
+
+/// CNT counts the bits of each byte, 4 vectors of byte
+/// counts (<= 32 per byte) are added up and accumulated
+/// into 16-bit counters using UADALP. After 256
+/// iterations (<= 16384 per counter) the 16-bit counters
+/// are added to the 64-bit total.
+///
+uint64_t popcountNEON(const uint64_t* array, uint64_t size)
+{
+  const uint8_t* p = (const uint8_t*) array;
+  uint64x2_t total = vdupq_n_u64(0);
+  uint64_t vectors = size / 2;
+  uint64_t limit = vectors - vectors % 4;
+  uint64_t i = 0;
+
+  while (i < limit)
+  {
+    uint16x8_t sum = vdupq_n_u16(0);
+    uint64_t end = std::min(limit, i + 4 * 256);
+
+    for (; i < end; i += 4)
+    {
+      uint8x16_t c0 = vcntq_u8(vld1q_u8(p + (i + 0) * 16));
+      uint8x16_t c1 = vcntq_u8(vld1q_u8(p + (i + 1) * 16));
+      uint8x16_t c2 = vcntq_u8(vld1q_u8(p + (i + 2) * 16));
+      uint8x16_t c3 = vcntq_u8(vld1q_u8(p + (i + 3) * 16));
+      uint8x16_t c = vaddq_u8(vaddq_u8(c0, c1), vaddq_u8(c2, c3));
+      sum = vpadalq_u8(sum, c);
+    }
+
+    total = vpadalq_u32(total, vpaddlq_u16(sum));
+  }
+
+  uint64_t cnt = vgetq_lane_u64(total, 0) +
+                 vgetq_lane_u64(total, 1);
+
+  for (i *= 2; i < size; i++)
+    cnt += popcount64(array[i]);
+
+  return cnt;
+}
+
+#endif
+
+#if defined(POPCNT_SVE)
+
+/// SVE counts the bits of svcntd() words per
+/// instruction, the remaining words are
+/// processed using a predicated load.
+///
+uint64_t popcountSVE(const uint64_t* array, uint64_t size)
+{
+  svuint64_t total = svdup_n_u64(0);
+
+  for (uint64_t i = 0; i < size; i += svcntd())
+  {
+    svbool_t pg = svwhilelt_b64(i, size);
+    svuint64_t v = svld1_u64(pg, &array[i]);
+    total = svadd_u64_m(pg, total, svcnt_u64_z(pg, v));
+  }
+
+  return svaddv_u64(svptrue_b64(), total);
+}
+
+#endif
+
+} // namespace
+
+namespace primesieve {
+
+/// The fastest kernel supported by the CPU is last
+std::vector<Kernel<PopcountFunc>> getPopcountKernels()
+{
+  std::vector<Kernel<PopcountFunc>> kernels;
+  kernels.push_back({ "portable", popcountPortable });
+
+#if defined(POPCNT_X86)
+  if (cpuInfo.hasPOPCNT())
+    kernels.push_back({ "POPCNT", popcountPOPCNT });
+  if (cpuInfo.hasAVX2())
+    kernels.push_back({ "AVX2", popcountAVX2 });
+  if (cpuInfo.hasAVX512VPOPCNT())
+    kernels.push_back({ "AVX512", popcountAVX512 });
+#elif defined(POPCNT_ARM)
+  if (cpuInfo.hasNEON())
+    kernels.push_back({ "NEON", popcountNEON });
+  #if defined(POPCNT_SVE)
+  if (cpuInfo.hasSVE())
+    kernels.push_back({ "SVE", popcountSVE });
+  #endif
+#endif
+
+  return kernels;
+}
+
+/// Count the 1 bits of an array of size 64-bit words
+uint64_t popcount(const uint64_t* array, uint64_t size)
+{
+  static const PopcountFunc popcountFunc = getPopcountKernels().back().func;
+  return popcountFunc(array, size);
+}
+
 } // namespace
@@ -0,0 +1,151 @@
+///
+/// @file   prefetch_iterator.cpp
+/// @brief  The helper thread generates the primes using a
+///         primesieve::iterator and pushes the filled buffers
+///         into a bounded queue. The buffers consumed by the
+///         caller are recycled by the helper thread.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/prefetch_iterator.hpp>
+#include <primesieve/iterator.hpp>
+#include <primesieve/config.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+struct prefetch_iterator::Impl
+{
+  mutex lock;
+  condition_variable notFull;
+  condition_variable notEmpty;
+  /// Buffers filled by the helper thread
+  deque<vector<uint64_t>> queue;
+  /// Buffers consumed by the caller
+  vector<vector<uint64_t>> unused;
+  size_t queueSize;
+  exception_ptr error;
+  bool stop = false;
+  thread helper;
+
+  Impl(uint64_t start, uint64_t stopHint, size_t size) :
+    queueSize(max(size, (size_t) 1))
+  {
+    helper = thread([=]() { generate(start, stopHint); });
+  }
+
+  ~Impl()
+  {
+    {
+      lock_guard<mutex> guard(lock);
+      stop = true;
+    }
+
+    notFull.notify_one();
+    helper.join();
+  }
+
+  /// Executed by the helper thread
+  void generate(uint64_t start, uint64_t stopHint)
+  {
+    try
+    {
+      primesieve::iterator it(start, stopHint);
+
+      while (true)
+      {
+        vector<uint64_t> primes;
+
+        {
+          unique_lock<mutex> guard(lock);
+          notFull.wait(guard, [&]() { return stop || queue.size() < queueSize; });
+          if (stop)
+            return;
+          if (!unused.empty())
+          {
+            primes.swap(unused.back());
+            unused.pop_back();
+          }
+        }
+
+        // generate the primes outside of the lock
+        primes.resize(config::PREFETCH_BUFFER);
+        it.next_primes(primes.data(), primes.size());
+
+        {
+          lock_guard<mutex> guard(lock);
+          queue.push_back(move(primes));
+        }
+
+        notEmpty.notify_one();
+      }
+    }
+    catch (...)
+    {
+      {
+        lock_guard<mutex> guard(lock);
+        error = current_exception();
+      }
+
+      notEmpty.notify_one();
+    }
+  }
+
+  /// Swap the consumed primes with
+  /// the next buffer of the queue
+  void pop(vector<uint64_t>& primes)
+  {
+    unique_lock<mutex> guard(lock);
+    notEmpty.wait(guard, [&]() { return !queue.empty() || error; });
+
+    // the buffers generated before
+    // the error are consumed first
+    if (queue.empty())
+      rethrow_exception(error);
+
+    if (!primes.empty())
+      unused.push_back(move(primes));
+
+    primes = move(queue.front());
+    queue.pop_front();
+    guard.unlock();
+    notFull.notify_one();
+  }
+};
+
+prefetch_iterator::prefetch_iterator(uint64_t start,
+                                     uint64_t stop_hint,
+                                     size_t queue_size) :
+  i_(0),
+  last_idx_(0),
+  impl_(new Impl(start, stop_hint, queue_size))
+{ }
+
+prefetch_iterator::~prefetch_iterator()
+{ }
+
+void prefetch_iterator::generate_next_primes()
+{
+  impl_->pop(primes_);
+  i_ = 0;
+  last_idx_ = primes_.size() - 1;
+}
+
+} // namespace
@@ -0,0 +1,402 @@
+///
+/// @file   prime_archive.cpp
+/// @brief  Write and read prime archive files, see
+///         prime_archive.hpp for the file format.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/prime_archive.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/MappedFile.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PrintFormat.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+const char MAGIC[8] = { 'P', 'S', 'A', 'R', 'C', 'H', 'V', '1' };
+const uint64_t HEADER_SIZE = 64;
+const uint64_t INDEX_ENTRY_SIZE = 16;
+
+/// Number of blocks encoded by a thread at once
+const uint64_t GROUP_BLOCKS = 16;
+
+struct Block
+{
+  string data;
+  uint64_t count = 0;
+};
+
+void write64(string& str, uint64_t n)
+{
+  char bytes[8];
+  primesieve::toLittleEndian<8>(n, bytes);
+  str.append(bytes, 8);
+}
+
+/// Last number of the block that starts at low
+uint64_t blockHigh(uint64_t low, uint64_t stop, uint64_t dist)
+{
+  if (stop - low < dist)
+    return stop;
+  return low + dist - 1;
+}
+
+/// Encode the blocks [first, last[ of the archive [start, stop]
+void encodeBlocks(uint64_t start,
+                  uint64_t stop,
+                  uint64_t first,
+                  uint64_t last,
+                  Block* blocks)
+{
+  uint64_t dist = primesieve::config::ARCHIVE_BLOCK_DISTANCE;
+  uint64_t low = start + first * dist;
+  uint64_t high = blockHigh(start + (last - 1) * dist, stop, dist);
+  // UINT64_MAX is not a prime, it is returned
+  // by next_prime() if there are no more primes
+  high = min(high, primesieve::get_max_stop() - 1);
+
+  primesieve::iterator it(low > 0 ? low - 1 : 0, high);
+  uint64_t prime = it.next_prime();
+  char bytes[32];
+
+  for (uint64_t b = first; b < last; b++)
+  {
+    Block& block = blocks[b - first];
+    uint64_t blockLow = start + b * dist;
+    uint64_t prev = blockLow;
+    uint64_t limit = min(high, blockHigh(blockLow, stop, dist));
+    block.data.reserve(primesieve::primeCountApprox(blockLow, limit));
+
+    for (; prime <= limit; prime = it.next_prime())
+    {
+      char* end = primesieve::encodePrime(primesieve::FORMAT_VARINT, prime, prev, bytes);
+      block.data.append(bytes, end - bytes);
+      block.count++;
+      prev = prime;
+    }
+  }
+}
+
+} // namespace
+
+namespace primesieve {
+
+/// The blocks are encoded in batches of 2 groups per
+/// thread, then the blocks of the batch are appended
+/// to the file in order.
+///
+uint64_t write_prime_archive(const string& filename,
+                             uint64_t start,
+                             uint64_t stop)
+{
+  if (start > stop)
+    throw primesieve_error("prime archive: start > stop");
+
+  ofstream file(filename, ios::binary | ios::trunc);
+  if (!file)
+    throw primesieve_error("failed to open " + filename);
+
+  // the header is written last, the file
+  // is invalid until it is complete
+  string header(HEADER_SIZE, '\0');
+  file.write(header.data(), header.size());
+
+  uint64_t dist = config::ARCHIVE_BLOCK_DISTANCE;
+  uint64_t blocks = (stop - start) / dist + 1;
+  uint64_t groups = ceilDiv(blocks, GROUP_BLOCKS);
+  int threads = (int) inBetween(1, groups, get_num_threads());
+  uint64_t batch = threads * 2;
+
+  uint64_t offset = HEADER_SIZE;
+  uint64_t primes = 0;
+  string index;
+  vector<Block> buffer;
+
+  for (uint64_t g = 0; g < groups; g += batch)
+  {
+    uint64_t lastGroup = min(groups, g + batch);
+    uint64_t first = g * GROUP_BLOCKS;
+    uint64_t last = min(blocks, lastGroup * GROUP_BLOCKS);
+    buffer.assign(last - first, Block());
+    atomic<uint64_t> group(g);
+
+    threadPool().run(threads, [&]() {
+      for (uint64_t i; (i = group++) < lastGroup;)
+      {
+        uint64_t b = i * GROUP_BLOCKS;
+        uint64_t e = min(blocks, b + GROUP_BLOCKS);
+        encodeBlocks(start, stop, b, e, &buffer[b - first]);
+      }
+    });
+
+    for (auto& block : buffer)
+    {
+      write64(index, primes);
+      write64(index, offset);
+      file.write(block.data.data(), block.data.size());
+      offset += block.data.size();
+      primes += block.count;
+    }
+  }
+
+  write64(index, primes);
+  write64(index, offset);
+  file.write(index.data(), index.size());
+
+  header.assign(MAGIC, sizeof(MAGIC));
+  write64(header, start);
+  write64(header, stop);
+  write64(header, dist);
+  write64(header, blocks);
+  write64(header, primes);
+  write64(header, offset);
+  write64(header, 0);
+  file.seekp(0);
+  file.write(header.data(), header.size());
+  file.close();
+
+  if (!file)
+    throw primesieve_error("failed to write " + filename);
+
+  return primes;
+}
+
+prime_archive::prime_archive(const string& filename) :
+  file_(new MappedFile(filename))
+{
+  bool valid = file_->size() >= HEADER_SIZE &&
+               memcmp(file_->data(), MAGIC, sizeof(MAGIC)) == 0;
+
+  if (valid)
+  {
+    start_ = file_->read64(8);
+    stop_ = file_->read64(16);
+    blockDist_ = file_->read64(24);
+    blocks_ = file_->read64(32);
+    primes_ = file_->read64(40);
+    indexOffset_ = file_->read64(48);
+    uint64_t size = file_->size();
+
+    valid = blockDist_ > 0 &&
+            start_ <= stop_ &&
+            blocks_ == (stop_ - start_) / blockDist_ + 1 &&
+            indexOffset_ >= HEADER_SIZE &&
+            indexOffset_ <= size &&
+            blocks_ < (size - indexOffset_) / INDEX_ENTRY_SIZE &&
+            blockRank(blocks_) == primes_ &&
+            blockOffset(blocks_) == indexOffset_;
+  }
+
+  if (!valid)
+    throw primesieve_error("invalid prime archive " + filename);
+}
+
+prime_archive::~prime_archive() = default;
+
+uint64_t prime_archive::blockOf(uint64_t n) const
+{
+  if (n <= start_)
+    return 0;
+  if (n >= stop_)
+    return blocks_ - 1;
+  return (n - start_) / blockDist_;
+}
+
+uint64_t prime_archive::blockLow(uint64_t block) const
+{
+  return start_ + block * blockDist_;
+}
+
+/// Number of primes < blockLow(block)
+uint64_t prime_archive::blockRank(uint64_t block) const
+{
+  return file_->read64((size_t) (indexOffset_ + block * INDEX_ENTRY_SIZE));
+}
+
+uint64_t prime_archive::blockOffset(uint64_t block) const
+{
+  return file_->read64((size_t) (indexOffset_ + block * INDEX_ENTRY_SIZE + 8));
+}
+
+uint64_t prime_archive::blockCount(uint64_t block) const
+{
+  return blockRank(block + 1) - blockRank(block);
+}
+
+void prime_archive::decode(uint64_t block, vector<uint64_t>& primes) const
+{
+  uint64_t first = blockOffset(block);
+  uint64_t last = blockOffset(block + 1);
+
+  if (first > last || last > indexOffset_)
+    throw primesieve_error("corrupt prime archive block");
+
+  const unsigned char* bytes = file_->data() + first;
+  const unsigned char* end = file_->data() + last;
+  uint64_t prime = blockLow(block);
+  primes.clear();
+  primes.reserve((size_t) blockCount(block));
+
+  while (bytes < end)
+  {
+    uint64_t gap = 0;
+    int shift = 0;
+
+    for (; bytes < end && (*bytes & 0x80); bytes++, shift += 7)
+      gap |= (uint64_t) (*bytes & 0x7f) << shift;
+    if (bytes < end)
+      gap |= (uint64_t) *bytes++ << shift;
+
+    prime += gap;
+    primes.push_back(prime);
+  }
+}
+
+/// Number of archive primes <= n
+uint64_t prime_archive::pi(uint64_t n) const
+{
+  if (n < start_)
+    return 0;
+
+  uint64_t block = blockOf(n);
+  vector<uint64_t> primes;
+  decode(block, primes);
+  auto iter = upper_bound(primes.begin(), primes.end(), n);
+
+  return blockRank(block) + (iter - primes.begin());
+}
+
+uint64_t prime_archive::count_primes(uint64_t start, uint64_t stop) const
+{
+  if (start > stop)
+    return 0;
+  if (start < start_ || stop > stop_)
+    throw primesieve_error("count_primes: interval is not inside the prime archive");
+
+  uint64_t count = pi(stop);
+  if (start > 0)
+    count -= pi(start - 1);
+
+  return count;
+}
+
+uint64_t prime_archive::nth_prime(uint64_t n) const
+{
+  if (n == 0 || n > primes_)
+    throw primesieve_error("nth_prime: n is not inside the prime archive");
+
+  // find the last block with blockRank(block) < n
+  uint64_t lo = 0;
+  uint64_t hi = blocks_ - 1;
+
+  while (lo < hi)
+  {
+    uint64_t mid = lo + (hi - lo + 1) / 2;
+    if (blockRank(mid) < n)
+      lo = mid;
+    else
+      hi = mid - 1;
+  }
+
+  vector<uint64_t> primes;
+  decode(lo, primes);
+
+  return primes.at((size_t) (n - blockRank(lo) - 1));
+}
+
+prime_archive::iterator::iterator(const prime_archive& archive, uint64_t start) :
+  archive_(archive)
+{
+  skipto(start);
+}
+
+/// The block is decoded lazily by the first
+/// next_prime() or prev_prime() call
+///
+void prime_archive::iterator::skipto(uint64_t start)
+{
+  start_ = start;
+  decoded_ = false;
+  primes_.clear();
+  i_ = 0;
+}
+
+void prime_archive::iterator::decode(uint64_t block)
+{
+  block_ = block;
+  decoded_ = true;
+  archive_.decode(block, primes_);
+}
+
+uint64_t prime_archive::iterator::next_block_prime()
+{
+  if (!decoded_)
+  {
+    decode(archive_.blockOf(start_));
+    auto iter = upper_bound(primes_.begin(), primes_.end(), start_);
+    if (iter != primes_.end())
+    {
+      i_ = iter - primes_.begin();
+      return *iter;
+    }
+    i_ = primes_.size();
+  }
+
+  // skip the blocks without primes
+  uint64_t block = block_ + 1;
+  while (block < archive_.blocks_ && !archive_.blockCount(block))
+    block++;
+
+  if (block >= archive_.blocks_)
+    return get_max_stop();
+
+  decode(block);
+  i_ = 0;
+  return primes_[i_];
+}
+
+uint64_t prime_archive::iterator::prev_block_prime()
+{
+  if (!decoded_)
+  {
+    decode(archive_.blockOf(start_));
+    auto iter = lower_bound(primes_.begin(), primes_.end(), start_);
+    if (iter != primes_.begin())
+    {
+      i_ = (iter - primes_.begin()) - 1;
+      return primes_[i_];
+    }
+    i_ = 0;
+  }
+
+  uint64_t block = block_;
+  while (block > 0 && !archive_.blockCount(block - 1))
+    block--;
+
+  if (block == 0)
+    return 0;
+
+  decode(block - 1);
+  i_ = primes_.size() - 1;
+  return primes_[i_];
+}
+
+} // namespace
@@ -0,0 +1,227 @@
+///
+/// @file   prime_monitor.cpp
+/// @brief  A single PrimeGenerator sieves [start, horizon], it is
+///         consumed up to the stop number of each extension and
+///         the primes > stop of its last buffer are kept for the
+///         next extension. The prime k-tuplets are found using a
+///         shift register of the last 5 gaps, e.g. a twin prime
+///         ends with the gap 2 and a prime quadruplet with the
+///         gaps 2, 4, 2. For primes >= 7 these are exactly the
+///         bitmasks used by PrintPrimes, below 7 the tuplets of
+///         PrimeSieve's small primes table, e.g. (5, 7, 11).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/prime_monitor.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/PrimeGaps.hpp>
+#include <primesieve/PrimeGenerator.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+/// Last gaps of each k-tuplet pattern, one byte per
+/// gap and the last gap in the lowest byte.
+///
+struct Pattern
+{
+  int k;
+  uint64_t gaps;
+  uint64_t mask;
+};
+
+const array<Pattern, 8> patterns =
+{{
+  { 2, 0x02, 0xff },                  // Twin primes
+  { 3, 0x0204, 0xffff },              // Prime triplets (p, p+2, p+6)
+  { 3, 0x0402, 0xffff },              // Prime triplets (p, p+4, p+6)
+  { 4, 0x020402, 0xffffff },          // Prime quadruplets
+  { 5, 0x02040204, 0xffffffff },      // Prime quintuplets
+  { 5, 0x04020402, 0xffffffff },
+  { 6, 0x0402040204, 0xffffffffff },  // Prime sextuplets
+  { 0, 0, 0 }
+}};
+
+} // namespace
+
+namespace primesieve {
+
+struct prime_monitor::Impl
+{
+  uint64_t start;
+  uint64_t stop;
+  uint64_t horizon;
+  PrimeGenerator primeGenerator;
+  vector<uint64_t> primes;
+  /// primes[i, size[ are > stop
+  size_t i = 0;
+  size_t size = 0;
+  bool finished;
+  uint64_t lastPrime = 0;
+  /// Last 5 gaps, 1 byte per gap
+  uint64_t gaps = 0;
+  array<uint64_t, 6> counts;
+  PrimeGaps primeGaps;
+
+  Impl(uint64_t startNumber, uint64_t horizonNumber) :
+    start(startNumber),
+    stop(max(startNumber, (uint64_t) 1) - 1),
+    horizon(horizonNumber),
+    primeGenerator(startNumber, horizonNumber),
+    primes(config::ITERATOR_BUFFER),
+    finished(startNumber > horizonNumber)
+  {
+    counts.fill(0);
+  }
+
+  /// @return false if there are no more primes <= horizon
+  bool refill()
+  {
+    for (size = 0; !size;)
+      primeGenerator.fill(primes, &size);
+
+    i = 0;
+
+    // UINT64_MAX is returned after the last prime
+    if (size == 1 && ~primes[0] == 0)
+      finished = true;
+
+    return !finished;
+  }
+
+  void add(uint64_t prime, PrimeGaps::Run& run)
+  {
+    if (lastPrime)
+    {
+      uint64_t gap = min(prime - lastPrime, (uint64_t) 0xff);
+      gaps = (gaps << 8) | gap;
+      for (const Pattern* p = patterns.data(); p->k; p++)
+        counts[p->k - 1] += (gaps & p->mask) == p->gaps;
+    }
+
+    counts[0]++;
+    lastPrime = prime;
+    run.add(prime);
+  }
+
+  void extend(uint64_t stopNumber)
+  {
+    if (stopNumber > horizon)
+      throw primesieve_error("prime_monitor: stop > horizon");
+    if (stopNumber <= stop)
+      return;
+
+    // gaps of ]stop, stopNumber], the gap to the last
+    // prime <= stop is added by primeGaps.finish()
+    PrimeGaps::Run run;
+
+    while (!finished)
+    {
+      if (i == size && !refill())
+        break;
+
+      uint64_t prime = primes[i];
+      if (prime > stopNumber)
+        break;
+
+      add(prime, run);
+      i++;
+    }
+
+    stop = stopNumber;
+    primeGaps.merge(run);
+    primeGaps.finish();
+  }
+};
+
+prime_monitor::prime_monitor(uint64_t start, uint64_t horizon) :
+  impl_(new Impl(start, horizon))
+{ }
+
+prime_monitor::~prime_monitor()
+{ }
+
+void prime_monitor::extend(uint64_t stop)
+{
+  impl_->extend(stop);
+}
+
+uint64_t prime_monitor::start() const
+{
+  return impl_->start;
+}
+
+uint64_t prime_monitor::stop() const
+{
+  return impl_->stop;
+}
+
+uint64_t prime_monitor::horizon() const
+{
+  return impl_->horizon;
+}
+
+uint64_t prime_monitor::count_primes() const
+{
+  return impl_->counts[0];
+}
+
+uint64_t prime_monitor::count_twins() const
+{
+  return impl_->counts[1];
+}
+
+uint64_t prime_monitor::count_triplets() const
+{
+  return impl_->counts[2];
+}
+
+uint64_t prime_monitor::count_quadruplets() const
+{
+  return impl_->counts[3];
+}
+
+uint64_t prime_monitor::count_quintuplets() const
+{
+  return impl_->counts[4];
+}
+
+uint64_t prime_monitor::count_sextuplets() const
+{
+  return impl_->counts[5];
+}
+
+uint64_t prime_monitor::last_prime() const
+{
+  return impl_->lastPrime;
+}
+
+uint64_t prime_monitor::max_gap() const
+{
+  return impl_->primeGaps.maxGap();
+}
+
+uint64_t prime_monitor::gap_count(uint64_t gap) const
+{
+  return impl_->primeGaps.count(gap);
+}
+
+uint64_t prime_monitor::gap_first_prime(uint64_t gap) const
+{
+  return impl_->primeGaps.firstPrime(gap);
+}
+
+} // namespace
@@ -0,0 +1,211 @@
+///
+/// @file   prime_queue.cpp
+/// @brief  [start, stop] is split into chunks of at least
+///         MIN_THREAD_DISTANCE numbers. A worker that finds the
+///         queue empty claims the next chunk, sieves it using
+///         sieve_bitmap() and appends each full block of primes
+///         to the queue while it is still sieving, so the other
+///         workers can already claim them.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/prime_queue.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/sieve_bitmap.hpp>
+#include <primesieve/ThreadPool.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+struct prime_queue::Impl
+{
+  mutex lock;
+  condition_variable notEmpty;
+  deque<vector<uint64_t>> blocks;
+  /// Claimed blocks, reused for new blocks
+  vector<vector<uint64_t>> unused;
+  uint64_t start;
+  uint64_t stop;
+  uint64_t chunkSize;
+  uint64_t chunks;
+  uint64_t nextChunk = 0;
+  /// Number of workers sieving a chunk
+  int sieving = 0;
+  size_t blockSize;
+  exception_ptr error;
+
+  Impl(uint64_t startNumber, uint64_t stopNumber, size_t size) :
+    start(startNumber),
+    stop(stopNumber),
+    blockSize(max(size, (size_t) 1))
+  {
+    vector<uint64_t> smallPrimes;
+    for (uint64_t prime : { 2, 3, 5 })
+      if (prime >= start && prime <= stop)
+        smallPrimes.push_back(prime);
+    if (!smallPrimes.empty())
+      blocks.push_back(move(smallPrimes));
+
+    // the sieving primes of each
+    // chunk cost < 1% of its sieving
+    start = max<uint64_t>(start, 7);
+    chunkSize = max(config::MIN_THREAD_DISTANCE, isqrt(stop) * 100);
+    chunks = (start <= stop) ? (stop - start) / chunkSize + 1 : 0;
+  }
+
+  /// @pre lock is held
+  vector<uint64_t> newBlock()
+  {
+    vector<uint64_t> block;
+    if (!unused.empty())
+    {
+      block.swap(unused.back());
+      unused.pop_back();
+    }
+    block.clear();
+    block.reserve(blockSize);
+    return block;
+  }
+
+  void publish(vector<uint64_t>& block)
+  {
+    {
+      lock_guard<mutex> guard(lock);
+      blocks.push_back(move(block));
+      block = newBlock();
+    }
+
+    notEmpty.notify_one();
+  }
+
+  void sieveChunk(uint64_t chunk)
+  {
+    uint64_t low = start + chunkSize * chunk;
+    uint64_t high = stop;
+    if (stop - low >= chunkSize)
+      high = low + chunkSize - 1;
+
+    vector<uint64_t> block;
+    {
+      lock_guard<mutex> guard(lock);
+      block = newBlock();
+    }
+
+    auto push = [&](uint64_t prime)
+    {
+      block.push_back(prime);
+      if (block.size() == blockSize)
+        publish(block);
+    };
+
+    sieve_bitmap(low, high, [&](uint64_t segmentLow, const uint8_t* sieve, size_t size) {
+      detail::for_each_bit(segmentLow, sieve, size, push);
+    });
+
+    if (!block.empty())
+      publish(block);
+  }
+
+  bool next(vector<uint64_t>& primes)
+  {
+    unique_lock<mutex> guard(lock);
+
+    while (true)
+    {
+      if (error)
+        rethrow_exception(error);
+
+      if (!blocks.empty())
+      {
+        if (primes.capacity() > 0)
+          unused.push_back(move(primes));
+        primes = move(blocks.front());
+        blocks.pop_front();
+        return true;
+      }
+
+      if (nextChunk < chunks)
+      {
+        uint64_t chunk = nextChunk++;
+        sieving++;
+        guard.unlock();
+
+        try
+        {
+          sieveChunk(chunk);
+        }
+        catch (...)
+        {
+          guard.lock();
+          error = current_exception();
+          sieving--;
+          notEmpty.notify_all();
+          throw;
+        }
+
+        guard.lock();
+        sieving--;
+        notEmpty.notify_all();
+        continue;
+      }
+
+      // all chunks have been sieved
+      if (sieving == 0)
+      {
+        primes.clear();
+        return false;
+      }
+
+      notEmpty.wait(guard);
+    }
+  }
+};
+
+prime_queue::prime_queue(uint64_t start,
+                         uint64_t stop,
+                         size_t block_size) :
+  impl_(new Impl(start, stop, block_size))
+{ }
+
+prime_queue::~prime_queue()
+{ }
+
+bool prime_queue::next_block(vector<uint64_t>& primes)
+{
+  return impl_->next(primes);
+}
+
+void prime_queue::for_each_block(int threads, const block_callback& callback)
+{
+  if (threads <= 0)
+    threads = get_num_threads();
+
+  atomic<int> nextThread(0);
+
+  threadPool().run(threads, [&]() {
+    int thread = nextThread++;
+    vector<uint64_t> primes;
+
+    while (next_block(primes))
+      callback(thread, primes.data(), primes.size());
+  });
+}
+
+} // namespace
@@ -0,0 +1,210 @@
+///
+/// @file   prime_stream.cpp
+/// @brief  The helper thread generates the primes using a
+///         primesieve::iterator and appends the blocks of primes
+///         to a queue which is shared by all cursors. The blocks
+///         are reference counted, a block leaves the queue once
+///         all cursors have moved past it.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/prime_stream.hpp>
+#include <primesieve/iterator.hpp>
+#include <primesieve/config.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+namespace primesieve {
+
+using block_t = shared_ptr<const vector<uint64_t>>;
+
+struct prime_stream::Impl
+{
+  mutex lock;
+  condition_variable notFull;
+  condition_variable notEmpty;
+  /// Blocks which have not yet been
+  /// consumed by all cursors
+  deque<block_t> blocks;
+  /// Index of blocks.front()
+  uint64_t first = 0;
+  /// Index of the next block of each cursor
+  multiset<uint64_t> cursors;
+  /// Returned after the last prime
+  block_t end = make_shared<const vector<uint64_t>>(1, ~0ull);
+  size_t backlog;
+  exception_ptr error;
+  bool done = false;
+  bool stop = false;
+  thread helper;
+
+  Impl(uint64_t start, uint64_t stopNumber, size_t size) :
+    backlog(max(size, (size_t) 1))
+  {
+    helper = thread([=]() { generate(start, stopNumber); });
+  }
+
+  void close()
+  {
+    {
+      lock_guard<mutex> guard(lock);
+      stop = true;
+    }
+
+    notFull.notify_one();
+    helper.join();
+  }
+
+  /// Remove the blocks consumed by all cursors,
+  /// without cursors the blocks are kept.
+  /// @pre lock is held
+  ///
+  void dropBlocks()
+  {
+    if (cursors.empty())
+      return;
+
+    uint64_t slowest = *cursors.begin();
+
+    while (!blocks.empty() && first < slowest)
+    {
+      blocks.pop_front();
+      first++;
+    }
+  }
+
+  /// Executed by the helper thread
+  void generate(uint64_t start, uint64_t stopNumber)
+  {
+    try
+    {
+      primesieve::iterator it(start, stopNumber);
+      bool last = (start >= stopNumber);
+
+      while (!last)
+      {
+        {
+          unique_lock<mutex> guard(lock);
+          notFull.wait(guard, [&]() { return stop || blocks.size() < backlog; });
+          if (stop)
+            break;
+        }
+
+        // generate the primes outside of the lock
+        vector<uint64_t> primes(config::PREFETCH_BUFFER);
+        it.next_primes(primes.data(), primes.size());
+
+        // UINT64_MAX is returned after the largest prime
+        auto iter = upper_bound(primes.begin(), primes.end(), stopNumber);
+        if (iter != primes.end() || primes.back() == ~0ull)
+        {
+          primes.erase(find(primes.begin(), iter, ~0ull), primes.end());
+          last = true;
+        }
+
+        if (!primes.empty())
+        {
+          lock_guard<mutex> guard(lock);
+          blocks.push_back(make_shared<const vector<uint64_t>>(move(primes)));
+        }
+
+        notEmpty.notify_all();
+      }
+    }
+    catch (...)
+    {
+      lock_guard<mutex> guard(lock);
+      error = current_exception();
+    }
+
+    {
+      lock_guard<mutex> guard(lock);
+      done = true;
+    }
+
+    notEmpty.notify_all();
+  }
+
+  /// Move a cursor from block pos to pos + 1
+  block_t next(uint64_t& pos)
+  {
+    unique_lock<mutex> guard(lock);
+    notEmpty.wait(guard, [&]() { return pos < first + blocks.size() || done; });
+
+    // the blocks generated before
+    // the end are consumed first
+    if (pos < first + blocks.size())
+    {
+      block_t block = blocks[pos - first];
+      cursors.erase(cursors.find(pos));
+      cursors.insert(++pos);
+      dropBlocks();
+      guard.unlock();
+      notFull.notify_one();
+      return block;
+    }
+
+    if (error)
+      rethrow_exception(error);
+
+    return end;
+  }
+};
+
+prime_stream::prime_stream(uint64_t start,
+                           uint64_t stop,
+                           size_t backlog) :
+  impl_(make_shared<Impl>(start, stop, backlog))
+{ }
+
+prime_stream::~prime_stream()
+{
+  impl_->close();
+}
+
+prime_stream::cursor::cursor(prime_stream& stream) :
+  i_(0),
+  last_idx_(0),
+  impl_(stream.impl_)
+{
+  lock_guard<mutex> guard(impl_->lock);
+  pos_ = impl_->first;
+  impl_->cursors.insert(pos_);
+  block_ = impl_->end;
+}
+
+prime_stream::cursor::~cursor()
+{
+  {
+    lock_guard<mutex> guard(impl_->lock);
+    impl_->cursors.erase(impl_->cursors.find(pos_));
+    impl_->dropBlocks();
+  }
+
+  impl_->notFull.notify_one();
+}
+
+void prime_stream::cursor::next_block()
+{
+  block_ = impl_->next(pos_);
+  i_ = 0;
+  last_idx_ = block_->size() - 1;
+}
+
+} // namespace
@@ -0,0 +1,293 @@
+///
+/// @file   prime_table.cpp
+/// @brief  Bitmap of the primes <= limit with rank (pi(x)) and
+///         select (nth prime) support, see prime_table.hpp.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/prime_table.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/fillPrimes.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/types.hpp>
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Number of bytes per rank entry
+const uint64_t BLOCK_SIZE = 64;
+
+/// The primes 2, 3 and 5 are not part of the bitmap
+const uint64_t SMALL_PRIMES[3] = { 2, 3, 5 };
+
+const uint64_t bitValues[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+
+/// Bit of n % 30 inside a byte of the bitmap,
+/// -1 if n is divisible by 2, 3 or 5.
+///
+const array<int8_t, 30> wheelBit =
+{
+  -1,  7, -1, -1, -1, -1, -1,  0, -1, -1,
+  -1,  1, -1,  2, -1, -1, -1,  3, -1,  4,
+  -1, -1, -1,  5, -1, -1, -1, -1, -1,  6
+};
+
+/// Bits of a byte whose numbers are <= 30 * byte + 7 + r
+const array<uint8_t, 30> rankMask =
+{
+  0x01, 0x01, 0x01, 0x01, 0x03, 0x03, 0x07, 0x07,
+  0x07, 0x07, 0x0f, 0x0f, 0x1f, 0x1f, 0x1f, 0x1f,
+  0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x3f, 0x7f, 0x7f,
+  0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+};
+
+mutex primeTableMutex;
+shared_ptr<const primesieve::prime_table> primeTable;
+
+uint64_t popcountBytes(const byte_t* bytes, uint64_t size)
+{
+  uint64_t words[BLOCK_SIZE / 8] = { 0 };
+  memcpy(words, bytes, (size_t) size);
+  return primesieve::popcount(words, ceilDiv(size, 8));
+}
+
+} // namespace
+
+namespace primesieve {
+
+/// The bitmap is sieved and the blocks are counted
+/// using multiple threads, the rank of each block
+/// is the prefix sum of the counts.
+///
+prime_table::prime_table(uint64_t limit) :
+  limit_(limit),
+  primes_(0)
+{
+  if (limit_ >= get_max_stop())
+    throw primesieve_error("prime_table: limit must be < 2^64 - 1");
+
+  int threads = get_num_threads();
+  table_ = make_shared<SievingTable>(limit_, threads, get_sieve_size());
+
+  uint64_t size = table_->size();
+  uint64_t blocks = ceilDiv(size, BLOCK_SIZE);
+  const byte_t* bits = table_->data();
+  ranks_.resize(blocks + 1, 0);
+
+  uint64_t pieceSize = 1 << 12;
+  uint64_t pieces = ceilDiv(blocks, pieceSize);
+  threads = (int) inBetween(1, pieces, threads);
+  atomic<uint64_t> piece(0);
+
+  threadPool().run(threads, [&]() {
+    for (uint64_t i; (i = piece++) < pieces;)
+    {
+      uint64_t first = i * pieceSize;
+      uint64_t last = min(blocks, first + pieceSize);
+      for (uint64_t b = first; b < last; b++)
+      {
+        uint64_t bytes = min(BLOCK_SIZE, size - b * BLOCK_SIZE);
+        ranks_[b + 1] = popcountBytes(&bits[b * BLOCK_SIZE], bytes);
+      }
+    }
+  });
+
+  for (uint64_t b = 0; b < blocks; b++)
+    ranks_[b + 1] += ranks_[b];
+
+  primes_ = pi(limit_);
+}
+
+prime_table::~prime_table() = default;
+
+bool prime_table::is_prime(uint64_t n) const
+{
+  if (n > limit_)
+    throw primesieve_error("prime_table: n > limit");
+  if (n < 7)
+    return n == 2 || n == 3 || n == 5;
+
+  int bit = wheelBit[n % 30];
+  if (bit < 0)
+    return false;
+
+  const byte_t* bits = table_->data();
+  return (bits[(n - 7) / 30] >> bit) & 1;
+}
+
+/// Rank of the block + popcount of the bytes of the
+/// block before n + the masked byte containing n
+///
+uint64_t prime_table::pi(uint64_t n) const
+{
+  if (n > limit_)
+    throw primesieve_error("prime_table: n > limit");
+  if (n < 7)
+    return (n >= 2) + (n >= 3) + (n >= 5);
+
+  const byte_t* bits = table_->data();
+  uint64_t byte = (n - 7) / 30;
+  uint64_t block = byte / BLOCK_SIZE;
+  uint64_t low = block * BLOCK_SIZE;
+
+  byte_t bytes[BLOCK_SIZE];
+  uint64_t size = byte - low + 1;
+  copy_n(&bits[low], size, bytes);
+  bytes[size - 1] &= rankMask[(n - 7) % 30];
+
+  return 3 + ranks_[block] + popcountBytes(bytes, size);
+}
+
+uint64_t prime_table::count_primes(uint64_t start, uint64_t stop) const
+{
+  if (start > stop)
+    return 0;
+
+  uint64_t count = pi(stop);
+  if (start > 0)
+    count -= pi(start - 1);
+
+  return count;
+}
+
+/// Binary search the last block whose rank is < n,
+/// then the primes of the block are scanned.
+///
+uint64_t prime_table::nth_prime(uint64_t n) const
+{
+  if (n == 0 || n > primes_)
+    throw primesieve_error("prime_table: nth prime > limit");
+  if (n <= 3)
+    return SMALL_PRIMES[n - 1];
+
+  n -= 3;
+  auto iter = lower_bound(ranks_.begin(), ranks_.end(), n);
+  uint64_t block = (iter - ranks_.begin()) - 1;
+  n -= ranks_[block];
+
+  const byte_t* bits = table_->data();
+  uint64_t byte = block * BLOCK_SIZE;
+
+  for (;; byte++)
+  {
+    uint64_t count = popcountBytes(&bits[byte], 1);
+    if (count >= n)
+      break;
+    n -= count;
+  }
+
+  uint64_t flags = bits[byte];
+  for (int bit = 0; bit < 8; bit++)
+  {
+    if ((flags >> bit) & 1)
+      if (--n == 0)
+        return byte * 30 + bitValues[bit];
+  }
+
+  throw primesieve_error("prime_table: corrupt table");
+}
+
+/// The 64-bit words of the bitmap are decoded one at a
+/// time, the primes < *start of the first word are skipped.
+///
+size_t prime_table::fill_primes(uint64_t* start,
+                                uint64_t stop,
+                                uint64_t* primes,
+                                size_t size) const
+{
+  if (stop > limit_)
+    throw primesieve_error("prime_table: stop > limit");
+
+  uint64_t low = *start;
+  size_t n = 0;
+
+  for (; low <= stop && low < 7 && n < size; low++)
+    if (low == 2 || low == 3 || low == 5)
+      primes[n++] = low;
+
+  if (low > stop || n == size)
+  {
+    *start = low;
+    return n;
+  }
+
+  const byte_t* bits = table_->data();
+  uint64_t sieveIdx = (low - 7) / 30 / 8 * 8;
+  uint64_t sieveSize = min(table_->size(), ((stop - 7) / 30 / 8 + 1) * 8);
+  uint64_t wordLow = sieveIdx * 30;
+  uint64_t word[64];
+
+  while (n < size && sieveIdx < sieveSize)
+  {
+    uint64_t count = fillPrimes(bits, &sieveIdx, sieveSize, &wordLow, word, 64);
+
+    for (uint64_t i = 0; i < count; i++)
+    {
+      if (word[i] < low)
+        continue;
+      if (word[i] > stop)
+      {
+        *start = stop + 1;
+        return n;
+      }
+      if (n == size)
+      {
+        *start = word[i];
+        return n;
+      }
+      primes[n++] = word[i];
+      low = word[i] + 1;
+    }
+  }
+
+  *start = (sieveIdx < sieveSize) ? low : stop + 1;
+  return n;
+}
+
+void load_prime_table(uint64_t limit)
+{
+  auto table = make_shared<const prime_table>(limit);
+  setSharedSievingTable(PRIME_TABLE, table->table_);
+  lock_guard<mutex> lock(primeTableMutex);
+  primeTable = table;
+}
+
+void unload_prime_table()
+{
+  setSharedSievingTable(PRIME_TABLE, nullptr);
+  lock_guard<mutex> lock(primeTableMutex);
+  primeTable.reset();
+}
+
+shared_ptr<const prime_table> get_prime_table()
+{
+  lock_guard<mutex> lock(primeTableMutex);
+  return primeTable;
+}
+
+const prime_table& small_prime_table()
+{
+  static const prime_table table(config::SMALL_PRIME_TABLE);
+  return table;
+}
+
+} // namespace
@@ -0,0 +1,148 @@
+///
+/// @file   primes_file.cpp
+/// @brief  Store the primes inside [start, stop] in a binary file
+///         which may be much larger than the available memory.
+///         The primes of each part of [start, stop] are counted
+///         in parallel, then the file is created with its final
+///         size and memory mapped, each thread writes the primes
+///         of its parts into its own slice of the file.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/MappedFile.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/Tuning.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+/// Part i = [parts[i], parts[i + 1] - 1]
+vector<uint64_t> getParts(uint64_t start, uint64_t stop, int threads)
+{
+  uint64_t dist = stop - start;
+  uint64_t threshold = isqrt(stop) / 5;
+  threshold = max(threshold, config::MIN_THREAD_DISTANCE);
+
+  // more parts than threads for load balancing
+  uint64_t n = dist / threshold;
+  n = inBetween(1, n, threads * 8);
+
+  vector<uint64_t> parts(n + 1);
+  for (uint64_t i = 0; i < n; i++)
+    parts[i] = start + dist / n * i;
+  parts[n] = stop + 1;
+
+  return parts;
+}
+
+template <typename T>
+void writeParts(const vector<uint64_t>& parts,
+                const vector<uint64_t>& offsets,
+                unsigned char* data,
+                int threads)
+{
+  uint64_t n = parts.size() - 1;
+  T* primes = (T*) data;
+  atomic<uint64_t> part(0);
+
+  threadPool().run(threads, [&]() {
+    for (uint64_t i; (i = part++) < n;)
+    {
+      // the primes are written straight
+      // from the sieve array to the file
+      T* p = primes + offsets[i];
+      for_each_prime(parts[i], parts[i + 1] - 1, [&](uint64_t prime) {
+        *p++ = (T) prime;
+      });
+    }
+  });
+}
+
+} // namespace
+
+namespace primesieve {
+
+uint64_t generate_primes_to_file(uint64_t start,
+                                 uint64_t stop,
+                                 const string& filename,
+                                 size_t bytes)
+{
+  if (bytes != 2 && bytes != 4 && bytes != 8)
+    throw primesieve_error("generate_primes_to_file: bytes must be 2, 4 or 8");
+  if (bytes < 8 && stop >> (bytes * 8))
+    throw primesieve_error("generate_primes_to_file: stop is too large for the prime type");
+
+  // UINT64_MAX is not a prime and stop + 1 must not overflow
+  stop = min(stop, get_max_stop() - 1);
+  int threads = get_num_threads();
+  vector<uint64_t> parts;
+
+  if (start <= stop)
+    parts = getParts(start, stop, threads);
+
+  uint64_t n = parts.empty() ? 0 : parts.size() - 1;
+  threads = (int) inBetween(1, n, threads);
+  vector<uint64_t> offsets(n + 1, 0);
+  int sieveSize = tunedSieveSize(start, stop, threads);
+  unique_ptr<SievingTable> sievingTable;
+
+  if (n > 1)
+    sievingTable.reset(new SievingTable(isqrt(stop), threads, sieveSize));
+
+  atomic<uint64_t> part(0);
+
+  threadPool().run(threads, [&]() {
+    for (uint64_t i; (i = part++) < n;)
+    {
+      PrimeSieve ps;
+      ps.setSieveSize(sieveSize);
+      ps.setSievingTable(sievingTable.get());
+      offsets[i + 1] = ps.countPrimes(parts[i], parts[i + 1] - 1);
+    }
+  });
+
+  for (uint64_t i = 0; i < n; i++)
+    offsets[i + 1] += offsets[i];
+
+  uint64_t primes = offsets[n];
+  uint64_t size = primes * bytes;
+  if (size / bytes != primes || (uint64_t) (size_t) size != size)
+    throw primesieve_error("generate_primes_to_file: file too large");
+
+  MappedFile file(filename, (size_t) size);
+
+  if (primes > 0)
+  {
+    switch (bytes)
+    {
+      case 2: writeParts<uint16_t>(parts, offsets, file.data(), threads); break;
+      case 4: writeParts<uint32_t>(parts, offsets, file.data(), threads); break;
+      case 8: writeParts<uint64_t>(parts, offsets, file.data(), threads); break;
+    }
+  }
+
+  file.sync();
+  return primes;
+}
+
+} // namespace
@@ -0,0 +1,156 @@
+///
+/// @file   sieve_bitmap.cpp
+/// @brief  Pass the sieve array of each segment to a user
+///         callback, the primes are never reconstructed.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ChunkScheduler.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/Erat.hpp>
+#include <primesieve/PreSieve.hpp>
+#include <primesieve/SievingPrimes.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+#include <primesieve/Tuning.hpp>
+#include <primesieve/pmath.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+using namespace std;
+using namespace primesieve;
+
+namespace {
+
+class BitmapSieve : public Erat
+{
+public:
+  BitmapSieve(uint64_t start, uint64_t stop, uint64_t sieveSize)
+  {
+    Erat::init(start, stop, sieveSize, preSieve_);
+    enableSegmentCache();
+  }
+
+  /// @scheduler: Claim the segments of our span before
+  ///             sieving them, nullptr if single-threaded.
+  ///
+  void sieve(const bitmap_callback& callback,
+             const SievingTable* sievingTable = nullptr,
+             ChunkScheduler* scheduler = nullptr,
+             int span = 0)
+  {
+    SievingPrimes sievingPrimes(this, preSieve_, sievingTable);
+    uint64_t prime = sievingPrimes.next();
+
+    while (hasNextSegment())
+    {
+      // other threads may steal the
+      // upper part of our span
+      if (scheduler)
+        setStop(scheduler->claim(span, segmentHigh_));
+
+      uint64_t low = segmentLow_;
+
+      if (!cachedSegment())
+      {
+        uint64_t sqrtHigh = isqrt(segmentHigh_);
+
+        for (; prime <= sqrtHigh; prime = sievingPrimes.next())
+          addSievingPrime(prime);
+
+        sieveSegment();
+      }
+
+      callback(low, sieve_, (size_t) sieveSize_);
+    }
+  }
+private:
+  PreSieve preSieve_;
+};
+
+} // namespace
+
+namespace primesieve {
+
+/// The segments are sieved by the calling thread
+/// and passed to the callback in increasing order
+///
+void sieve_bitmap(uint64_t start,
+                  uint64_t stop,
+                  const bitmap_callback& callback)
+{
+  start = max<uint64_t>(start, 7);
+  if (start > stop)
+    return;
+
+  BitmapSieve sieve(start, stop, tunedSieveSize(start, stop, 1));
+  sieve.sieve(callback);
+}
+
+/// Each thread sieves the spans handed out by the
+/// ChunkScheduler (like ParallelSieve), the sieving
+/// primes are shared by all threads.
+///
+void sieve_bitmap(uint64_t start,
+                  uint64_t stop,
+                  int threads,
+                  const parallel_bitmap_callback& callback)
+{
+  start = max<uint64_t>(start, 7);
+  if (start > stop)
+    return;
+
+  if (threads <= 0)
+    threads = get_num_threads();
+
+  uint64_t threshold = isqrt(stop) / 5;
+  threshold = max(threshold, config::MIN_THREAD_DISTANCE);
+  threads = (int) inBetween(1, (stop - start) / threshold, threads);
+  int sieveSize = tunedSieveSize(start, stop, threads);
+
+  if (threads == 1)
+  {
+    BitmapSieve sieve(start, stop, sieveSize);
+    sieve.sieve([&](uint64_t low, const uint8_t* sieve, size_t size) {
+      callback(0, low, sieve, size);
+    });
+    return;
+  }
+
+  uint64_t sqrtStop = isqrt(stop);
+  auto sievingTable = getSharedSievingTable(sqrtStop);
+  if (!sievingTable)
+    sievingTable = make_shared<SievingTable>(sqrtStop, threads, sieveSize);
+
+  uint64_t minDist = max(config::MIN_THREAD_DISTANCE, sqrtStop * 100);
+  ChunkScheduler scheduler(start, stop, threads, minDist);
+  atomic<int> nextThread(0);
+
+  threadPool().run(threads, [&]() {
+    int thread = nextThread++;
+    int span = -1;
+    uint64_t low = 0;
+    uint64_t high = 0;
+
+    auto threadCallback = [&](uint64_t segmentLow, const uint8_t* sieve, size_t size) {
+      callback(thread, segmentLow, sieve, size);
+    };
+
+    while (scheduler.next(&span, &low, &high))
+    {
+      BitmapSieve sieve(low, high, sieveSize);
+      sieve.sieve(threadCallback, sievingTable.get(), &scheduler, span);
+    }
+  });
+}
+
+} // namespace
@@ -0,0 +1,137 @@
+///
+/// @file   async.cpp
+/// @brief  Test the asynchronous API e.g. count_primes_async()
+///         and primesieve_count_primes_async().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <cerrno>
+#include <condition_variable>
+#include <future>
+#include <iostream>
+#include <cstdlib>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+struct Result
+{
+  mutex lock;
+  condition_variable done;
+  uint64_t value = 0;
+  int error = -1;
+  bool finished = false;
+};
+
+void callback(uint64_t value, int error, void* data)
+{
+  Result& res = *(Result*) data;
+  lock_guard<mutex> guard(res.lock);
+  res.value = value;
+  res.error = error;
+  res.finished = true;
+  res.done.notify_all();
+}
+
+void wait(Result& res)
+{
+  unique_lock<mutex> lock(res.lock);
+  res.done.wait(lock, [&]() { return res.finished; });
+}
+
+int main()
+{
+  // pi(10^n) for n = 1..9
+  vector<uint64_t> pix = { 4, 25, 168, 1229, 9592, 78498, 664579, 5761455, 50847534 };
+  vector<future<uint64_t>> futures;
+  uint64_t stop = 1;
+
+  for (size_t i = 0; i < pix.size(); i++)
+  {
+    stop *= 10;
+    futures.push_back(count_primes_async(0, stop));
+  }
+
+  for (size_t i = 0; i < pix.size(); i++)
+  {
+    uint64_t count = futures[i].get();
+    cout << "count_primes_async(0, 10^" << i + 1 << ") = " << count;
+    check(count == pix[i]);
+  }
+
+  auto nth = nth_prime_async(10000000);
+  auto twins = count_twins_async(0, (uint64_t) 1e9);
+  uint64_t prime = nth.get();
+  uint64_t twinCount = twins.get();
+  cout << "nth_prime_async(10^7) = " << prime;
+  check(prime == 179424673);
+  cout << "count_twins_async(0, 10^9) = " << twinCount;
+  check(twinCount == 3424506);
+
+  cancel_token token;
+  token.cancel();
+  auto cancelled = count_primes_async(0, (uint64_t) 1e9, token);
+  bool isCancelled = false;
+  try { cancelled.get(); }
+  catch (primesieve_cancelled&) { isCancelled = true; }
+  cout << "count_primes_async() cancelled";
+  check(isCancelled);
+
+  auto invalid = nth_prime_async(-100, 10);
+  bool isError = false;
+  try { invalid.get(); }
+  catch (primesieve_error&) { isError = true; }
+  cout << "nth_prime_async(-100, 10) throws";
+  check(isError);
+
+  // C API
+  Result res1;
+  Result res2;
+  primesieve_count_primes_async(0, (uint64_t) 1e8, NULL, callback, &res1);
+  primesieve_nth_prime_async(25, 0, NULL, callback, &res2);
+  wait(res1);
+  wait(res2);
+  cout << "primesieve_count_primes_async(0, 10^8) = " << res1.value;
+  check(res1.value == 5761455 && res1.error == 0);
+  cout << "primesieve_nth_prime_async(25) = " << res2.value;
+  check(res2.value == 97 && res2.error == 0);
+
+  primesieve_cancel_token* ctoken = primesieve_create_cancel_token();
+  primesieve_cancel(ctoken);
+  Result res3;
+  primesieve_count_primes_async(0, (uint64_t) 1e8, ctoken, callback, &res3);
+  wait(res3);
+  cout << "primesieve_count_primes_async() cancelled";
+  check(res3.value == PRIMESIEVE_ERROR && res3.error == ECANCELED);
+  primesieve_free_cancel_token(ctoken);
+
+  // the queued computations are finished before
+  // the worker threads are stopped
+  Result res4;
+  primesieve_count_primes_async(0, (uint64_t) 1e7, NULL, callback, &res4);
+  shutdown_thread_pool();
+  cout << "shutdown_thread_pool() finishes queued work";
+  check(res4.finished && res4.value == 664579);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,143 @@
+///
+/// @file   cancel.cpp
+/// @brief  Test cancelling count_primes() and nth_prime()
+///         using a cancel_token.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <cerrno>
+#include <chrono>
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+bool isCancelled(uint64_t start, uint64_t stop, const cancel_token& token)
+{
+  try
+  {
+    count_primes(start, stop, token);
+    return false;
+  }
+  catch (primesieve_cancelled&)
+  {
+    return true;
+  }
+}
+
+int main()
+{
+  cancel_token token;
+  cout << "count_primes(0, 10^9, token) = " << count_primes(0, (uint64_t) 1e9, token);
+  check(count_primes(0, (uint64_t) 1e9, token) == 50847534);
+
+  cout << "nth_prime(10^7, 0, token) = " << nth_prime((int64_t) 1e7, 0, token);
+  check(nth_prime((int64_t) 1e7, 0, token) == 179424673);
+
+  token.cancel();
+  cout << "cancelled before call";
+  check(isCancelled(0, (uint64_t) 1e9, token));
+
+  bool nthCancelled = false;
+  try { nth_prime((int64_t) 1e7, 0, token); }
+  catch (primesieve_cancelled&) { nthCancelled = true; }
+  cout << "nth_prime() cancelled";
+  check(nthCancelled);
+
+  token.reset();
+  token.set_deadline(cancel_token::clock::now() - chrono::seconds(1));
+  cout << "deadline in the past";
+  check(isCancelled(0, (uint64_t) 1e9, token));
+
+  // cancel while sieving, count_primes() would take hours
+  token.reset();
+  thread canceller([&]() {
+    this_thread::sleep_for(chrono::milliseconds(50));
+    token.cancel();
+  });
+  bool cancelled = isCancelled((uint64_t) 1e18, (uint64_t) 1e18 + (uint64_t) 1e12, token);
+  canceller.join();
+  cout << "cancelled while sieving";
+  check(cancelled);
+
+  // cancelled by the first status update, the
+  // stop number must not have been reached
+  {
+    token.reset();
+    double status = -1;
+    ParallelSieve ps;
+    ps.setFlags(COUNT_PRIMES | CALCULATE_STATUS);
+    ps.setNumThreads(1);
+    ps.setCancelToken(&token);
+    ps.setStatusCallback([&](double percent)
+    {
+      if (status < 0)
+        status = percent;
+      token.cancel();
+    });
+    try
+    {
+      ps.sieve((uint64_t) 1e18, (uint64_t) 1e18 + (uint64_t) 1e12);
+      cancelled = false;
+    }
+    catch (primesieve_cancelled&)
+    {
+      cancelled = true;
+    }
+    cout << "cancelled by status callback at " << status << "%";
+    check(cancelled && status < 100 && ps.getStatus() < 100);
+  }
+
+  token.reset();
+  token.set_timeout(chrono::milliseconds(50));
+  cout << "timeout while sieving";
+  check(isCancelled((uint64_t) 1e18, (uint64_t) 1e18 + (uint64_t) 1e12, token));
+
+  // C API
+  primesieve_cancel_token* ctoken = primesieve_create_cancel_token();
+  cout << "primesieve_count_primes_cancellable(0, 10^8) = " << primesieve_count_primes_cancellable(0, (uint64_t) 1e8, ctoken);
+  check(primesieve_count_primes_cancellable(0, (uint64_t) 1e8, ctoken) == 5761455);
+
+  primesieve_cancel(ctoken);
+  errno = 0;
+  uint64_t res = primesieve_count_primes_cancellable(0, (uint64_t) 1e8, ctoken);
+  cout << "C API errno = ECANCELED";
+  check(res == PRIMESIEVE_ERROR && errno == ECANCELED);
+
+  errno = 0;
+  res = primesieve_nth_prime_cancellable(1000, 0, ctoken);
+  cout << "C API nth prime errno = ECANCELED";
+  check(res == PRIMESIEVE_ERROR && errno == ECANCELED);
+  primesieve_free_cancel_token(ctoken);
+
+  ctoken = primesieve_create_cancel_token();
+  primesieve_set_deadline(ctoken, -1.0);
+  errno = 0;
+  res = primesieve_count_primes_cancellable(0, (uint64_t) 1e8, ctoken);
+  cout << "C API deadline errno = ECANCELED";
+  check(res == PRIMESIEVE_ERROR && errno == ECANCELED);
+  primesieve_free_cancel_token(ctoken);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
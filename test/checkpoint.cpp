@@ -0,0 +1,121 @@
+///
+/// @file   checkpoint.cpp
+/// @brief  Count primes and twin primes using a checkpoint
+///         file and resume an interrupted count.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/Checkpoint.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+counts_t count(uint64_t start, uint64_t stop, Checkpoint* checkpoint)
+{
+  ParallelSieve ps;
+  ps.setFlags(COUNT_PRIMES | COUNT_TWINS);
+  ps.setCheckpoint(checkpoint);
+  ps.sieve(start, stop);
+  return ps.getCounts();
+}
+
+int main()
+{
+  string filename = "primesieve_checkpoint_test.txt";
+  remove(filename.c_str());
+
+  uint64_t start = 1000000000000ull;
+  uint64_t stop = start + 1000000000;
+  uint64_t mid = start + 123456789;
+  counts_t expected = count(start, stop, nullptr);
+
+  {
+    Checkpoint checkpoint(filename);
+    counts_t counts = count(start, stop, &checkpoint);
+    cout << "Checkpoint count = " << counts[0];
+    check(counts == expected);
+  }
+
+  {
+    Checkpoint checkpoint(filename);
+    counts_t counts = count(start, stop, &checkpoint);
+    cout << "Finished checkpoint count = " << counts[0];
+    check(counts == expected);
+
+    cout << "Finished checkpoint remaining = 0";
+    check(checkpoint.remaining().empty());
+  }
+
+  // interrupted run: [start, mid] has been counted, the
+  // fake counts of the finished piece must be reused
+  {
+    ofstream file(filename);
+    file << start << ' ' << stop << ' ' << (COUNT_PRIMES | COUNT_TWINS) << '\n';
+    file << start << ' ' << mid << " 1 2 0 0 0 0\n";
+    file << "incomplete line";
+  }
+
+  {
+    Checkpoint checkpoint(filename);
+    checkpoint.init(start, stop, COUNT_PRIMES | COUNT_TWINS);
+    auto remaining = checkpoint.remaining();
+    cout << "Remaining = [" << remaining[0].first << ", " << remaining[0].second << "]";
+    check(remaining.size() == 1 &&
+          remaining[0].first == mid + 1 &&
+          remaining[0].second == stop);
+  }
+
+  {
+    Checkpoint checkpoint(filename);
+    counts_t counts = count(start, stop, &checkpoint);
+    counts_t head = count(start, mid, nullptr);
+    cout << "Resumed count = " << counts[0];
+    check(counts[0] == expected[0] - head[0] + 1 &&
+          counts[1] == expected[1] - head[1] + 2);
+  }
+
+  // the checkpoint file belongs to another computation
+  {
+    bool error = false;
+    try
+    {
+      Checkpoint checkpoint(filename);
+      count(start, stop + 1, &checkpoint);
+    }
+    catch (primesieve_error&)
+    {
+      error = true;
+    }
+
+    cout << "Other computation throws";
+    check(error);
+  }
+
+  remove(filename.c_str());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
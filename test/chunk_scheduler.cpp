@@ -0,0 +1,158 @@
+///
+/// @file   chunk_scheduler.cpp
+/// @brief  Test that the work-stealing ChunkScheduler
+///         distributes each number of [start, stop]
+///         exactly once.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/ChunkScheduler.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <iostream>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Simulate the threads by sieving segments in pseudo
+/// random order, some threads are never started
+///
+bool test(uint64_t start, uint64_t stop, int threads, int started)
+{
+  // every other thread is slower
+  vector<double> weights(threads, 1.0);
+  for (int i = 1; i < threads; i += 2)
+    weights[i] = 0.5;
+
+  ChunkScheduler scheduler(start, stop, weights, 1000);
+  vector<pair<uint64_t, uint64_t>> chunks;
+  vector<uint64_t> spanStarts;
+  vector<int> spans(started, -1);
+  vector<uint64_t> low(started, 0);
+  vector<uint64_t> high(started, 0);
+  vector<bool> sieving(started, false);
+  vector<bool> finished(started, false);
+  int active = started;
+  uint64_t seed = 1;
+
+  while (active > 0)
+  {
+    seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+    int t = (int) ((seed >> 33) % started);
+    if (finished[t])
+      continue;
+
+    if (!sieving[t])
+    {
+      if (!scheduler.next(&spans[t], &low[t], &high[t], weights[t]))
+      {
+        finished[t] = true;
+        active--;
+        continue;
+      }
+      spanStarts.push_back(low[t]);
+      sieving[t] = true;
+    }
+
+    // sieve the next segment of our span
+    uint64_t segmentHigh = low[t] + 777;
+    if (segmentHigh < low[t])
+      segmentHigh = ~0ull;
+    high[t] = scheduler.claim(spans[t], segmentHigh);
+    segmentHigh = min(segmentHigh, high[t]);
+    chunks.emplace_back(low[t], segmentHigh);
+
+    if (segmentHigh >= high[t])
+      sieving[t] = false;
+    else
+      low[t] = segmentHigh + 1;
+  }
+
+  // spans must not split prime k-tuplets
+  for (uint64_t n : spanStarts)
+    if (n != start && n % 30 != 3)
+      return false;
+
+  sort(chunks.begin(), chunks.end());
+
+  if (chunks.empty() ||
+      chunks.front().first != start ||
+      chunks.back().second != stop)
+    return false;
+
+  for (size_t i = 1; i < chunks.size(); i++)
+    if (chunks[i].first != chunks[i - 1].second + 1)
+      return false;
+
+  return true;
+}
+
+/// The ranges of split() cover [start, stop]
+/// and they are aligned like the spans
+///
+bool testSplit(uint64_t start, uint64_t stop, uint64_t parts)
+{
+  auto ranges = ChunkScheduler::split(start, stop, parts, 1000);
+
+  if (ranges.empty() ||
+      ranges.size() > parts ||
+      ranges.front().first != start ||
+      ranges.back().second != stop)
+    return false;
+
+  for (size_t i = 1; i < ranges.size(); i++)
+    if (ranges[i].first != ranges[i - 1].second + 1 ||
+        ranges[i].first % 30 != 3)
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  uint64_t max = ~0ull;
+
+  for (uint64_t parts : { 1, 2, 7, 64, 100000 })
+  {
+    bool OK = testSplit(0, 1000000, parts) &&
+              testSplit(7, 123456789, parts) &&
+              testSplit(max - 1000000, max, parts) &&
+              testSplit(0, max, parts);
+
+    cout << "ChunkScheduler::split(parts = " << parts << ")";
+    check(OK);
+  }
+
+  for (int threads = 1; threads <= 16; threads++)
+  {
+    for (int started = 1; started <= threads; started++)
+    {
+      bool OK = test(0, 1000000, threads, started) &&
+                test(7, 123456789, threads, started) &&
+                test(max - 1000000, max, threads, started);
+
+      cout << "ChunkScheduler(threads = " << threads << ", started = " << started << ")";
+      check(OK);
+    }
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,116 @@
+///
+/// @file   context.cpp
+/// @brief  Test primesieve::context and the C context API,
+///         the settings of a context must not affect
+///         the process-wide settings.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <future>
+#include <iostream>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  int sieveSize = get_sieve_size();
+  int threads = get_num_threads();
+
+  context ctx1;
+  context ctx2;
+  ctx1.set_sieve_size(16);
+  ctx1.set_num_threads(1);
+  ctx2.set_sieve_size(256);
+
+  cout << "ctx1.get_sieve_size() = " << ctx1.get_sieve_size();
+  check(ctx1.get_sieve_size() == 16);
+  cout << "ctx2.get_sieve_size() = " << ctx2.get_sieve_size();
+  check(ctx2.get_sieve_size() == 256);
+  cout << "ctx1.get_num_threads() = " << ctx1.get_num_threads();
+  check(ctx1.get_num_threads() == 1);
+  cout << "get_sieve_size() = " << get_sieve_size();
+  check(get_sieve_size() == sieveSize);
+  cout << "get_num_threads() = " << get_num_threads();
+  check(get_num_threads() == threads);
+
+  uint64_t count1 = 0;
+  uint64_t count2 = 0;
+  thread t1([&]() { count1 = ctx1.count_primes(0, (uint64_t) 1e9); });
+  thread t2([&]() { count2 = ctx2.count_primes(0, (uint64_t) 1e9); });
+  t1.join();
+  t2.join();
+
+  cout << "ctx1.count_primes(0, 10^9) = " << count1;
+  check(count1 == 50847534);
+  cout << "ctx2.count_primes(0, 10^9) = " << count2;
+  check(count2 == 50847534);
+
+  // the cached sieving primes are reused
+  uint64_t start = (uint64_t) 1e15;
+  uint64_t stop = start + (uint64_t) 1e9;
+  for (int i = 0; i < 3; i++)
+  {
+    uint64_t count = ctx2.count_primes(start, stop);
+    cout << "ctx2.count_primes(10^15, 10^15+10^9) = " << count;
+    check(count == 28946421);
+  }
+
+  cout << "ctx2.count_twins(0, 10^9) = " << ctx2.count_twins(0, (uint64_t) 1e9);
+  check(ctx2.count_twins(0, (uint64_t) 1e9) == 3424506);
+  cout << "ctx2.nth_prime(10^7) = " << ctx2.nth_prime((int64_t) 1e7);
+  check(ctx2.nth_prime((int64_t) 1e7) == 179424673);
+
+  uint64_t counts[6];
+  ctx2.count(0, (uint64_t) 1e9, 1 | 2 | 4, counts);
+  cout << "ctx2.count(0, 10^9, primes | twins | triplets) = " << counts[0] << " " << counts[1] << " " << counts[2];
+  check(counts[0] == 50847534 && counts[1] == 3424506 && counts[2] == 759256 && counts[3] == 0);
+
+  auto future = ctx1.count_primes_async(0, (uint64_t) 1e8);
+  uint64_t count = future.get();
+  cout << "ctx1.count_primes_async(0, 10^8) = " << count;
+  check(count == 5761455);
+
+  ctx2.clear_cache();
+  cout << "ctx2.count_primes(0, 10^8) after clear_cache() = " << ctx2.count_primes(0, (uint64_t) 1e8);
+  check(ctx2.count_primes(0, (uint64_t) 1e8) == 5761455);
+
+  // C API
+  primesieve_context* ctx = primesieve_create_context();
+  primesieve_context_set_num_threads(ctx, 1);
+  primesieve_context_set_sieve_size(ctx, 64);
+  cout << "primesieve_context_get_sieve_size() = " << primesieve_context_get_sieve_size(ctx);
+  check(primesieve_context_get_sieve_size(ctx) == 64);
+  cout << "primesieve_context_get_num_threads() = " << primesieve_context_get_num_threads(ctx);
+  check(primesieve_context_get_num_threads(ctx) == 1);
+  cout << "primesieve_context_count_primes(0, 10^8) = " << primesieve_context_count_primes(ctx, 0, (uint64_t) 1e8);
+  check(primesieve_context_count_primes(ctx, 0, (uint64_t) 1e8) == 5761455);
+  cout << "primesieve_context_count_twins(0, 10^8) = " << primesieve_context_count_twins(ctx, 0, (uint64_t) 1e8);
+  check(primesieve_context_count_twins(ctx, 0, (uint64_t) 1e8) == 440312);
+  cout << "primesieve_context_nth_prime(25, 0) = " << primesieve_context_nth_prime(ctx, 25, 0);
+  check(primesieve_context_nth_prime(ctx, 25, 0) == 97);
+  primesieve_free_context(ctx);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
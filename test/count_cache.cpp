@@ -0,0 +1,113 @@
+///
+/// @file   count_cache.cpp
+/// @brief  Test the cache of the counts of aligned chunks,
+///         the counts of intervals that are assembled from
+///         cached chunks must match the sieved counts.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/CountCache.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+counts_t getCounts(uint64_t start, uint64_t stop, int flags)
+{
+  ParallelSieve ps;
+  ps.sieve(start, stop, flags);
+  return ps.getCounts();
+}
+
+int main()
+{
+  int flags = COUNT_PRIMES | COUNT_TWINS | COUNT_TRIPLETS | COUNT_QUADRUPLETS;
+  uint64_t n = (uint64_t) 1e12;
+  uint64_t low = CountCache::chunkLow(CountCache::firstChunk(n));
+  uint64_t high = CountCache::chunkHigh(CountCache::firstChunk(n) + 2);
+
+  cout << "chunkLow(firstChunk(n)) >= n";
+  check(low >= n && CountCache::chunkLow(CountCache::firstChunk(n) - 1) < n);
+  cout << "chunks(chunkHigh(i)) = i + 1";
+  check(CountCache::chunks(high) == CountCache::firstChunk(n) + 3 &&
+        CountCache::chunks(high - 1) == CountCache::firstChunk(n) + 2);
+
+  // sieved without cache
+  counts_t c1 = getCounts(low - 1, high + 1, flags);
+  counts_t c2 = getCounts(low + 100, high + 100000, flags);
+  counts_t c3 = getCounts(0, CountCache::chunkHigh(2), flags);
+  counts_t c4 = getCounts(low, high, flags);
+
+  set_count_cache_size(1 << 20);
+
+  for (int i = 0; i < 2; i++)
+  {
+    cout << "cached counts (" << low - 1 << ", " << high + 1 << ") = " << c1[0];
+    check(getCounts(low - 1, high + 1, flags) == c1);
+    cout << "cached counts (" << low + 100 << ", " << high + 100000 << ") = " << c2[0];
+    check(getCounts(low + 100, high + 100000, flags) == c2);
+    cout << "cached counts (0, " << CountCache::chunkHigh(2) << ") = " << c3[0];
+    check(getCounts(0, CountCache::chunkHigh(2), flags) == c3);
+    cout << "cached counts (" << low << ", " << high << ") = " << c4[0];
+    check(getCounts(low, high, flags) == c4);
+  }
+
+  cout << "count cache hits > 0";
+  check(get_count_cache_stats().hits > 0);
+
+  // the chunks are cached for the flags of
+  // the 1st sieve, other counts are added later
+  set_count_cache_size(0);
+  set_count_cache_size(1 << 20);
+  counts_t primes = getCounts(low, high, COUNT_PRIMES);
+  counts_t twins = getCounts(low, high, COUNT_TWINS);
+  uint64_t hits = get_count_cache_stats().hits;
+  counts_t both = getCounts(low, high, COUNT_PRIMES | COUNT_TWINS);
+  cout << "cached primes and twins = " << both[0] << ", " << both[1];
+  check(primes[0] == c4[0] &&
+        twins[1] == c4[1] &&
+        both[0] == c4[0] &&
+        both[1] == c4[1] &&
+        get_count_cache_stats().hits == hits + 3);
+
+  cout << "count_primes(" << low << ", " << high << ") = " << count_primes(low, high);
+  check(count_primes(low, high) == c4[0]);
+
+  // the cache is smaller than the range,
+  // chunks are evicted
+  set_count_cache_size(256);
+  for (int i = 0; i < 2; i++)
+  {
+    cout << "counts with small count cache = " << c1[0];
+    check(getCounts(low - 1, high + 1, flags) == c1);
+  }
+
+  hits = get_count_cache_stats().hits;
+  uint64_t misses = get_count_cache_stats().misses;
+  set_count_cache_size(0);
+  getCounts(low, high, flags);
+  cout << "disabled count cache";
+  check(get_count_cache_stats().hits == hits &&
+        get_count_cache_stats().misses == misses);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
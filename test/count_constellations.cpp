@@ -0,0 +1,109 @@
+///
+/// @file   count_constellations.cpp
+/// @brief  Test count_constellations() against a simple
+///         count using primesieve::iterator and is_prime().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ConstellationSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+uint64_t countSlow(uint64_t start, uint64_t stop, const vector<uint64_t>& offsets)
+{
+  uint64_t count = 0;
+  primesieve::iterator it(start > 0 ? start - 1 : 0, stop);
+
+  for (uint64_t p = it.next_prime(); p <= stop; p = it.next_prime())
+  {
+    bool isMatch = true;
+    for (uint64_t offset : offsets)
+      isMatch = isMatch && p + offset <= stop && is_prime(p + offset);
+    count += isMatch;
+  }
+
+  return count;
+}
+
+int main()
+{
+  vector<vector<uint64_t>> constellations =
+  {
+    { 0, 2 },
+    { 0, 4 },
+    { 0, 6 },
+    { 0, 2, 4 },
+    { 0, 2, 6, 8, 12 },
+    { 0, 2, 6, 8, 12, 18, 20 },
+    { 0, 2, 6, 8, 12, 18, 20, 26 },
+    { 0, 1000 }
+  };
+
+  uint64_t ranges[][2] =
+  {
+    { 0, 2000000 },
+    { 3, 1000 },
+    { 10000019, 10000019 },
+    { 1000000000000ull, 1000002000000ull }
+  };
+
+  for (auto& offsets : constellations)
+  {
+    for (auto& r : ranges)
+    {
+      cout << "count_constellations(" << r[0] << ", " << r[1] << ", {";
+      for (size_t i = 0; i < offsets.size(); i++)
+        cout << (i ? ", " : "") << offsets[i];
+      cout << "}) = " << count_constellations(r[0], r[1], offsets);
+      check(count_constellations(r[0], r[1], offsets) == countSlow(r[0], r[1], offsets));
+    }
+  }
+
+  cout << "count_constellations({0, 2}) == count_twins()";
+  check(count_constellations(12345, 98765432, { 0, 2 }) == count_twins(12345, 98765432));
+
+  // split into parts like the threads do
+  uint64_t start = 100;
+  uint64_t stop = 30000000;
+  vector<uint64_t> offsets = { 0, 4, 6, 10 };
+  Constellation constellation(offsets);
+  uint64_t parts = 13;
+  uint64_t maxN = stop - constellation.maxOffset();
+  uint64_t dist = (maxN - start) / parts;
+  uint64_t count = 0;
+
+  for (uint64_t i = 0; i < parts; i++)
+  {
+    uint64_t low = start + dist * i;
+    uint64_t high = (i + 1 < parts) ? low + dist - 1 : maxN;
+    ConstellationSieve sieve(low, high, high + constellation.maxOffset(), 16, constellation);
+    count += sieve.count();
+  }
+
+  cout << "count_constellations({0, 4, 6, 10}) in " << parts << " parts = " << count;
+  check(count == count_constellations(start, stop, offsets) &&
+        count == countSlow(start, stop, offsets));
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
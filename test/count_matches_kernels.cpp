@@ -0,0 +1,88 @@
+///
+/// @file   count_matches_kernels.cpp
+/// @brief  Each kernel used for counting the prime k-tuplets
+///         (SWAR, ARM64 NEON) must count the same bytes
+///         matching the k-tuplet bitmasks as a simple byte
+///         by byte count.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/kernels.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+uint64_t countMatchesNaive(const uint64_t* words, uint64_t n, uint64_t mask)
+{
+  uint64_t count = 0;
+  for (uint64_t i = 0; i < n; i++)
+    for (int j = 0; j < 64; j += 8)
+      count += ((words[i] >> j) & mask & 0xff) == (mask & 0xff);
+  return count;
+}
+
+int main()
+{
+  mt19937_64 gen(42);
+  vector<uint64_t> words(256);
+
+  // the sieve arrays contain many k-tuplets
+  for (auto& w : words)
+    w = gen() | gen();
+
+  const uint64_t bitmasks[] = { 0x06, 0x18, 0xc0, 0x07, 0x0e, 0x1c, 0x38, 0x1e, 0x1f, 0x3e, 0x3f };
+  auto kernels = getCountMatchesKernels();
+
+  for (auto& kernel : kernels)
+  {
+    bool ok = true;
+
+    for (uint64_t b : bitmasks)
+    {
+      uint64_t mask = b * 0x0101010101010101ull;
+      for (uint64_t offset = 0; offset < 2; offset++)
+        for (uint64_t n = 0; n < 255; n++)
+          if (kernel.func(&words[offset], n, mask) != countMatchesNaive(&words[offset], n, mask))
+            ok = false;
+    }
+
+    // all bytes match
+    vector<uint64_t> ones(255, ~0ull);
+    if (kernel.func(ones.data(), ones.size(), 0x3f3f3f3f3f3f3f3full) != 255 * 8)
+      ok = false;
+
+    cout << kernel.name << " countMatches kernel";
+    check(ok);
+  }
+
+#if defined(__aarch64__)
+  bool neon = false;
+  for (auto& kernel : kernels)
+    neon |= (string(kernel.name) == "NEON");
+  cout << "NEON countMatches kernel is tested";
+  check(neon);
+#endif
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
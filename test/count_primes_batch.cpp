@@ -0,0 +1,87 @@
+///
+/// @file   count_primes_batch.cpp
+/// @brief  Test count_primes_batch() against count_primes()
+///         using sorted, unsorted, overlapping and empty
+///         intervals.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+bool isEqual(const vector<uint64_t>& starts,
+             const vector<uint64_t>& stops)
+{
+  vector<uint64_t> counts(starts.size());
+  count_primes_batch(starts.data(), stops.data(), starts.size(), counts.data());
+
+  for (size_t i = 0; i < starts.size(); i++)
+    if (counts[i] != count_primes(starts[i], stops[i]))
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  mt19937_64 gen(42);
+  vector<uint64_t> starts;
+  vector<uint64_t> stops;
+
+  // histogram bins
+  for (uint64_t low = 0; low < 10000000; low += 10000)
+  {
+    starts.push_back(low);
+    stops.push_back(low + 9999);
+  }
+
+  cout << "count_primes_batch(1000 bins of [0, 10^7])";
+  check(isEqual(starts, stops));
+
+  // unsorted, overlapping and far apart intervals
+  starts.clear();
+  stops.clear();
+  uniform_int_distribution<uint64_t> dist(0, 100000);
+  uint64_t bases[] = { 0, 1000000, 1000000000, 1000000000000ull };
+
+  for (int i = 0; i < 2000; i++)
+  {
+    uint64_t base = bases[i % 4];
+    uint64_t start = base + dist(gen) * (i % 3 + 1);
+    uint64_t stop = start + dist(gen) % 5000;
+    starts.push_back(start);
+    stops.push_back(stop);
+  }
+
+  cout << "count_primes_batch(2000 random intervals)";
+  check(isEqual(starts, stops));
+
+  starts = { 10, 1000, 0, 18446744073709551557ull, 18446744073709551558ull };
+  stops = { 5, 1000, 2, 18446744073709551615ull, 18446744073709551615ull };
+  cout << "count_primes_batch(empty and tiny intervals)";
+  check(isEqual(starts, stops));
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,91 @@
+///
+/// @file   count_primes_bins.cpp
+/// @brief  Test count_primes_bins() and the k-tuplet
+///         histogram against count_primes() and
+///         count_twins() of each bin.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/Histogram.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+bool checkBins(uint64_t start, uint64_t stop, uint64_t width)
+{
+  vector<uint64_t> bins = count_primes_bins(start, stop, width);
+  uint64_t low = start;
+
+  for (size_t i = 0; i < bins.size(); i++, low += width)
+  {
+    uint64_t high = low + min(stop - low, width - 1);
+    if (bins[i] != count_primes(low, high))
+      return false;
+  }
+
+  return bins.size() == (stop - start) / width + 1;
+}
+
+int main()
+{
+  uint64_t tests[][3] =
+  {
+    { 0, 1000, 1 },
+    { 0, 1000000, 7 },
+    { 3, 10000000, 997 },
+    { 1000000000000ull, 1000010000000ull, 1000003 },
+    { 18446744073609551615ull, 18446744073709551615ull, 33333333 }
+  };
+
+  for (auto& t : tests)
+  {
+    cout << "count_primes_bins(" << t[0] << ", " << t[1] << ", " << t[2] << ")";
+    check(checkBins(t[0], t[1], t[2]));
+  }
+
+  uint64_t start = 0;
+  uint64_t stop = 10000000;
+  uint64_t width = 12345;
+  Histogram histogram(start, stop, width);
+  ParallelSieve ps;
+  ps.setHistogram(&histogram);
+  ps.sieve(start, stop, COUNT_TWINS | COUNT_TRIPLETS);
+  bool OK = true;
+
+  for (uint64_t i = 0; i < histogram.size(); i++)
+  {
+    // a k-tuplet belongs to the bin of its smallest prime
+    uint64_t low = histogram.binLow(i);
+    uint64_t high = histogram.binHigh(i);
+    uint64_t twins = count_twins(low, high + 2);
+    uint64_t triplets = count_triplets(low, high + 6);
+    OK = OK && histogram.count(i, 1) == twins;
+    OK = OK && histogram.count(i, 2) == triplets;
+  }
+
+  cout << "Histogram twins and triplets, width = " << width;
+  check(OK && ps.getCount(1) == count_twins(start, stop));
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
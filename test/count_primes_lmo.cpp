@@ -0,0 +1,77 @@
+///
+/// @file   count_primes_lmo.cpp
+/// @brief  Test the LMO prime counting algorithm which is
+///         used by count_primes() for large intervals.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/LMO.hpp>
+#include <primesieve/PrimeSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  // pi(10^i)
+  uint64_t pix[] =
+  {
+    4,
+    25,
+    168,
+    1229,
+    9592,
+    78498,
+    664579,
+    5761455,
+    50847534,
+    455052511,
+    4118054813ull,
+    37607912018ull,
+    346065536839ull
+  };
+
+  uint64_t x = 1;
+  for (int i = 0; i < 13; i++)
+  {
+    x *= 10;
+    cout << "piLMO(10^" << i + 1 << ") = " << piLMO(x, 4);
+    check(piLMO(x, 4) == pix[i]);
+  }
+
+  for (int i = 0; i < 100; i++)
+  {
+    uint64_t n = (rand() % 1000000) * (uint64_t) 1000 + rand() % 1000;
+    PrimeSieve ps;
+    uint64_t count = ps.countPrimes(0, n);
+    cout << "piLMO(" << n << ") = " << piLMO(n, 1 + i % 4);
+    check(piLMO(n, 1 + i % 4) == count);
+  }
+
+  uint64_t start = 1000000007;
+  uint64_t stop = 100000000000ull;
+  uint64_t count = 4118054813ull - 50847534;
+  cout << "count_primes(" << start << ", " << stop << ") = " << count_primes(start, stop);
+  check(count_primes(start, stop) == count);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,95 @@
+///
+/// @file   count_primes_mod.cpp
+/// @brief  Test count_primes_mod() against counting the primes
+///         of each residue class using primesieve::iterator.
+///         The interval is also sieved in chunks like
+///         ParallelSieve's threads do.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/ResidueCounts.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <numeric>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+vector<uint64_t> countSlow(uint64_t start, uint64_t stop, uint64_t q)
+{
+  vector<uint64_t> counts(q, 0);
+  primesieve::iterator it(start > 0 ? start - 1 : 0, stop);
+
+  for (uint64_t p = it.next_prime(); p <= stop; p = it.next_prime())
+    counts[p % q]++;
+
+  return counts;
+}
+
+int main()
+{
+  uint64_t moduli[] = { 1, 2, 3, 4, 7, 8, 30, 210, 1000, 99991, 1 << 20 };
+
+  uint64_t ranges[][2] =
+  {
+    { 0, 10000000 },
+    { 0, 4 },
+    { 3, 1000 },
+    { 1000000007, 1000000007 },
+    { 1000000000000ull, 1000003000000ull }
+  };
+
+  for (uint64_t q : moduli)
+  {
+    for (auto& r : ranges)
+    {
+      auto counts = count_primes_mod(r[0], r[1], q);
+      cout << "count_primes_mod(" << r[0] << ", " << r[1] << ", " << q << ")";
+      check(counts == countSlow(r[0], r[1], q) &&
+            accumulate(counts.begin(), counts.end(), (uint64_t) 0) == count_primes(r[0], r[1]));
+    }
+  }
+
+  // sieve the chunks in reverse order like
+  // the threads of ParallelSieve
+  uint64_t start = 1000000;
+  uint64_t stop = 50000000;
+  uint64_t q = 210;
+  uint64_t chunks = 7;
+  uint64_t dist = (stop - start) / chunks;
+  ResidueCounts residueCounts(q);
+  PrimeSieve parent;
+  parent.setResidueCounts(&residueCounts);
+
+  for (uint64_t i = chunks; i-- > 0;)
+  {
+    uint64_t low = start + dist * i;
+    uint64_t high = (i == chunks - 1) ? stop : low + dist - 1;
+    PrimeSieve child(&parent);
+    child.sieve(low, high);
+  }
+
+  cout << "count_primes_mod(" << start << ", " << stop << ", " << q << ") in " << chunks << " chunks";
+  check(residueCounts.counts() == countSlow(start, stop, q));
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+///
+/// @file   count_primes_sparse.cpp
+/// @brief  Count the primes of intervals that fit into a single
+///         segment at huge offsets, the big sieving primes have
+///         at most one multiple inside such an interval and are
+///         crossed off without EratBig. Compared with
+///         is_prime() of each number.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t dist)
+{
+  uint64_t stop = start + dist;
+  uint64_t count = 0;
+
+  for (uint64_t n = start; n <= stop && n >= start; n++)
+    count += is_prime(n);
+
+  cout << "count_primes(" << start << ", " << stop << ") = " << count;
+  check(count_primes(start, stop) == count);
+
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+  bool OK = primes.size() == count;
+  for (uint64_t p : primes)
+    OK = OK && is_prime(p);
+  cout << "generate_primes(" << start << ", " << stop << ") = " << primes.size();
+  check(OK);
+}
+
+int main()
+{
+  test(1000000000000ull, 100000);
+  test(1000000000000000000ull, 1);
+  test(1000000000000000000ull + 1, 100);
+  test(1000000000000000000ull, 300000);
+  test(12345678901234567890ull, 200000);
+  test(18446744073709551615ull - 100000, 100000);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -87,6 +87,25 @@ int main()
     return 1;
   }
 
+  auto& coreClasses = cpuInfo.coreClasses();
+
+  if (coreClasses.size() == 1)
+  {
+    cerr << "Invalid number of core classes: 1" << endl;
+    return 1;
+  }
+
+  for (size_t i = 0; i < coreClasses.size(); i++)
+  {
+    if (coreClasses[i].cpus.empty() ||
+        coreClasses[i].capacity > 1024 ||
+        (i > 0 && coreClasses[i].capacity > coreClasses[i - 1].capacity))
+    {
+      cerr << "Invalid core class: " << i << endl;
+      return 1;
+    }
+  }
+
   if (cpuInfo.hasCpuName())
     cout << cpuInfo.cpuName() << endl;
 
@@ -102,5 +121,8 @@ int main()
       cout << "L2 cache: shared"  << endl;
   }
 
+  if (cpuInfo.hasHybridCpu())
+    cout << "Hybrid CPU: " << coreClasses.size() << " core classes" << endl;
+
   return 0;
 }
@@ -0,0 +1,150 @@
+///
+/// @file   cunningham_chains.cpp
+/// @brief  Test count_cunningham_chains(), generate_cunningham_chains(),
+///         the Sophie Germain and safe prime functions and the C
+///         equivalents against is_prime() of the chain members.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// The primes p inside [start, stop] for which
+/// p, 2p + 1, 4p + 3, ... are all prime
+///
+vector<uint64_t> findChains(int length, uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+  vector<uint64_t> chains;
+
+  for (uint64_t p : primes)
+  {
+    bool found = true;
+    uint64_t m = p;
+    for (int i = 1; i < length && found; i++)
+    {
+      m = m * 2 + 1;
+      found = is_prime(m);
+    }
+    if (found)
+      chains.push_back(p);
+  }
+
+  return chains;
+}
+
+void test(int length, uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> expected = findChains(length, start, stop);
+  vector<uint64_t> chains;
+  generate_cunningham_chains(length, start, stop, &chains);
+  cout << "generate_cunningham_chains(" << length << ", " << start << ", " << stop << ") = " << chains.size();
+  check(chains == expected);
+
+  uint64_t count = count_cunningham_chains(length, start, stop);
+  cout << "count_cunningham_chains(" << length << ", " << start << ", " << stop << ") = " << count;
+  check(count == expected.size());
+
+  size_t size = 0;
+  uint64_t* cchains = primesieve_generate_cunningham_chains(length, start, stop, &size);
+  cout << "primesieve_generate_cunningham_chains(" << length << ", " << start << ", " << stop << ") = " << size;
+  check(size == expected.size() && equal(cchains, cchains + size, expected.begin()));
+  primesieve_free(cchains);
+}
+
+int main()
+{
+  for (int length = 1; length <= 5; length++)
+  {
+    test(length, 0, 1000000);
+    test(length, 1000000000000ull, 1000000000000ull + 30000000);
+  }
+
+  test(2, 7, 11);
+  test(2, 100, 99);
+
+  // A005384: 190 Sophie Germain primes below 10^4
+  uint64_t count = count_sophie_germain_primes(0, 10000);
+  cout << "count_sophie_germain_primes(0, 10^4) = " << count;
+  check(count == 190);
+
+  vector<uint64_t> safePrimes;
+  generate_safe_primes(0, 100, &safePrimes);
+  vector<uint64_t> expected = { 5, 7, 11, 23, 47, 59, 83 };
+  cout << "generate_safe_primes(0, 100) = " << safePrimes.size();
+  check(safePrimes == expected);
+
+  vector<uint64_t> sophieGermain;
+  generate_sophie_germain_primes(1000000, 20000000, &sophieGermain);
+  safePrimes.clear();
+  generate_safe_primes(2000003, 40000001, &safePrimes);
+  bool OK = safePrimes.size() == sophieGermain.size() &&
+            safePrimes.size() == count_safe_primes(2000003, 40000001);
+  for (size_t i = 0; i < safePrimes.size() && OK; i++)
+    OK = safePrimes[i] == sophieGermain[i] * 2 + 1;
+  cout << "generate_safe_primes(2000003, 40000001) = " << safePrimes.size();
+  check(OK);
+
+  // multi-threaded, many chunks
+  set_num_threads(4);
+  count = count_sophie_germain_primes(0, 2000000000);
+  cout << "count_sophie_germain_primes(0, 2 * 10^9), 4 threads = " << count;
+  check(count == count_cunningham_chains(2, 0, 1000000000) +
+                 count_cunningham_chains(2, 1000000001, 2000000000));
+
+  // the last member of stop must be < 2^64
+  uint64_t max = 18446744073709551615ull;
+  cout << "primesieve_count_cunningham_chains(2, 0, 2^63) = PRIMESIEVE_ERROR";
+  check(primesieve_count_cunningham_chains(2, 0, max / 2 + 1) == PRIMESIEVE_ERROR);
+  cout << "primesieve_count_cunningham_chains(65, 0, 100) = PRIMESIEVE_ERROR";
+  check(primesieve_count_cunningham_chains(65, 0, 100) == PRIMESIEVE_ERROR);
+
+  // the last member of 2^63 - 1 is 2^64 - 1
+  count = count_cunningham_chains(2, max / 2 - 2, max / 2);
+  cout << "count_cunningham_chains(2, 2^63 - 3, 2^63 - 1) = " << count;
+  check(count == 0);
+  count = count_safe_primes(max - 4, max);
+  cout << "count_safe_primes(2^64 - 5, 2^64 - 1) = " << count;
+  check(count == 0);
+  count = count_cunningham_chains(33, (1ull << 32) - 100, (1ull << 32) - 1);
+  cout << "count_cunningham_chains(33, 2^32 - 100, 2^32 - 1) = " << count;
+  check(count == 0);
+  cout << "primesieve_count_cunningham_chains(33, 0, 2^32) = PRIMESIEVE_ERROR";
+  check(primesieve_count_cunningham_chains(33, 0, 1ull << 32) == PRIMESIEVE_ERROR);
+
+  // sieving primes up to 2^25.5
+  vector<uint64_t> chains;
+  uint64_t stop = 1ull << 50;
+  generate_cunningham_chains(2, stop - 10000000, stop, &chains);
+  OK = !chains.empty();
+  for (uint64_t p : chains)
+    OK = OK && is_prime(p) && is_prime(p * 2 + 1);
+  cout << "generate_cunningham_chains(2, 2^50 - 10^7, 2^50) = " << chains.size();
+  check(OK);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,205 @@
+///
+/// @file   factor_tables.cpp
+/// @brief  Compare the smallest prime factor, Moebius, Euler phi
+///         and omega tables of factor_tables() against trial
+///         division, single and multi-threaded.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+struct Factors
+{
+  uint64_t spf = 0;
+  int moebius = 1;
+  uint64_t phi = 1;
+  int omega = 0;
+};
+
+Factors trialDivision(uint64_t n)
+{
+  Factors f;
+  if (n == 0)
+  {
+    f.moebius = 0;
+    f.phi = 0;
+    return f;
+  }
+  if (n == 1)
+  {
+    f.spf = 1;
+    return f;
+  }
+
+  for (uint64_t p = 2; p * p <= n; p++)
+  {
+    if (n % p == 0)
+    {
+      if (!f.spf)
+        f.spf = p;
+      f.omega++;
+      f.moebius = -f.moebius;
+      f.phi *= p - 1;
+      n /= p;
+      while (n % p == 0)
+      {
+        f.moebius = 0;
+        f.phi *= p;
+        n /= p;
+      }
+    }
+  }
+
+  if (n > 1)
+  {
+    if (!f.spf)
+      f.spf = n;
+    f.omega++;
+    f.moebius = -f.moebius;
+    f.phi *= n - 1;
+  }
+
+  return f;
+}
+
+bool compare(const factor_segment& s)
+{
+  for (size_t i = 0; i < s.size; i++)
+  {
+    Factors f = trialDivision(s.low + i);
+    if (s.spf[i] != f.spf ||
+        s.moebius[i] != f.moebius ||
+        s.phi[i] != f.phi ||
+        s.omega[i] != f.omega)
+    {
+      cerr << "\nWrong tables of " << s.low + i;
+      return false;
+    }
+  }
+  return true;
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  bool OK = true;
+  uint64_t next = start;
+
+  factor_tables(start, stop, [&](const factor_segment& s)
+  {
+    OK = OK && s.low == next && compare(s);
+    next = s.low + s.size;
+  });
+
+  cout << "factor_tables(" << start << ", " << stop << ")";
+  check(OK && next - 1 == stop);
+}
+
+int main()
+{
+  test(0, 100000);
+  test(1, 1);
+  test(1000000000000ull, 1000000000000ull + 2000);
+
+  // trial division is too slow near 2^64, check
+  // that spf(n) is a prime factor of n instead
+  {
+    uint64_t stop = 18446744073709551615ull;
+    uint64_t start = stop - 100000;
+    bool OK = true;
+
+    factor_tables(start, stop, [&](const factor_segment& s)
+    {
+      for (size_t i = 0; i < s.size; i++)
+      {
+        uint64_t n = s.low + i;
+        OK = OK && n % s.spf[i] == 0 && is_prime(s.spf[i]);
+        OK = OK && (s.spf[i] == n) == (s.omega[i] == 1 && is_prime(n));
+      }
+    });
+
+    cout << "factor_tables(" << start << ", " << stop << ")";
+    check(OK);
+  }
+
+  // multi-threaded, the segments of all
+  // threads must cover [start, stop]
+  {
+    uint64_t start = 123456789;
+    uint64_t stop = start + (uint64_t) 3e7;
+    vector<char> seen(stop - start + 1, 0);
+    mutex lock;
+    bool OK = true;
+
+    factor_tables(start, stop, 4, [&](int thread, const factor_segment& s)
+    {
+      lock_guard<mutex> guard(lock);
+      OK = OK && thread >= 0 && thread < 4;
+      for (size_t i = 0; i < s.size; i++)
+        OK = OK && seen[s.low - start + i]++ == 0;
+      // trial division of every 1000th number
+      for (size_t i = 0; i < s.size; i += 1000)
+      {
+        Factors f = trialDivision(s.low + i);
+        OK = OK && s.spf[i] == f.spf && s.phi[i] == f.phi;
+      }
+    });
+
+    for (char c : seen)
+      OK = OK && c == 1;
+
+    cout << "factor_tables(" << start << ", " << stop << ", threads = 4)";
+    check(OK);
+  }
+
+  // caller buffers
+  {
+    uint64_t start = 999000;
+    uint64_t stop = 1001000;
+    size_t size = (size_t) (stop - start + 1);
+    vector<uint64_t> spf(size);
+    vector<int8_t> mu(size);
+    vector<uint64_t> phi(size);
+    vector<uint8_t> omega(size);
+    smallest_prime_factors(start, stop, spf.data());
+    moebius(start, stop, mu.data());
+    euler_phi(start, stop, phi.data());
+    prime_factor_counts(start, stop, omega.data());
+    bool OK = true;
+
+    for (size_t i = 0; i < size; i++)
+    {
+      Factors f = trialDivision(start + i);
+      OK = OK && spf[i] == f.spf && mu[i] == f.moebius &&
+           phi[i] == f.phi && omega[i] == f.omega;
+    }
+
+    cout << "smallest_prime_factors(), moebius(), euler_phi(), prime_factor_counts()";
+    check(OK);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
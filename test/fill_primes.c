@@ -0,0 +1,111 @@
+///
+/// @file   fill_primes.c
+/// @brief  Test primesieve_fill_primes() and streaming primes
+///         through a small buffer using primesieve_fill_next_primes().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+/// Stream the primes inside [start, stop] through
+/// a buffer of size primes and compare them with
+/// primesieve_generate_primes()
+///
+void testStream(uint64_t start, uint64_t stop, size_t size)
+{
+  size_t i;
+  size_t n = 0;
+  size_t written = 0;
+  size_t expected_size = 0;
+  int res = 1;
+  int OK = 1;
+  uint64_t next;
+  uint64_t* buffer = (uint64_t*) malloc(size * sizeof(uint64_t));
+  uint64_t* expected = (uint64_t*) primesieve_generate_primes(start, stop, &expected_size, UINT64_PRIMES);
+
+  primesieve_iterator it;
+  primesieve_init(&it);
+  primesieve_skipto(&it, start - 1, stop);
+
+  while (res == 1)
+  {
+    res = primesieve_fill_next_primes(&it, stop, buffer, size, &written, UINT64_PRIMES);
+    OK = OK && res >= 0 && written <= size;
+    for (i = 0; OK && i < written; i++, n++)
+      OK = n < expected_size && buffer[i] == expected[n];
+  }
+
+  printf("primesieve_fill_next_primes(%" PRIu64 ", %" PRIu64 ", size = %zu) = %zu", start, stop, size, n);
+  check(OK && n == expected_size);
+
+  // the iterator continues after stop
+  next = primesieve_next_prime(&it);
+  printf("next prime > %" PRIu64 " = %" PRIu64, stop, next);
+  check(next > stop && (n == 0 || next > expected[n - 1]));
+
+  primesieve_free_iterator(&it);
+  primesieve_free(expected);
+  free(buffer);
+}
+
+int main()
+{
+  uint32_t primes32[25];
+  uint64_t primes64[10];
+  size_t written = 0;
+  int res;
+
+  res = primesieve_fill_primes(0, 100, primes32, 25, &written, UINT32_PRIMES);
+  printf("primesieve_fill_primes(0, 100) = %zu", written);
+  check(res == 1 && written == 25 && primes32[0] == 2 && primes32[24] == 97);
+
+  res = primesieve_fill_primes(0, 100, primes64, 10, &written, UINT64_PRIMES);
+  printf("primesieve_fill_primes(0, 100, size = 10) = %zu", written);
+  check(res == 1 && written == 10 && primes64[9] == 29);
+
+  res = primesieve_fill_primes(30, 36, primes64, 10, &written, UINT64_PRIMES);
+  printf("primesieve_fill_primes(30, 36) = %zu", written);
+  check(res == 0 && written == 1 && primes64[0] == 31);
+
+  res = primesieve_fill_primes(24, 28, primes64, 10, &written, UINT64_PRIMES);
+  printf("primesieve_fill_primes(24, 28) = %zu", written);
+  check(res == 0 && written == 0);
+
+  res = primesieve_fill_primes(18446744073709551533ull, 18446744073709551615ull, primes64, 10, &written, UINT64_PRIMES);
+  printf("primesieve_fill_primes(2^64 - 83, 2^64 - 1) = %zu", written);
+  check(res == 0 && written == 2 && primes64[0] == 18446744073709551533ull && primes64[1] == 18446744073709551557ull);
+
+  res = primesieve_fill_primes(0, 100, primes64, 10, &written, -1);
+  printf("primesieve_fill_primes(0, 100, type = -1) = %d", res);
+  check(res == -1 && written == 0);
+
+  testStream(1, 1000, 7);
+  testStream(1000000, 3000000, 1000);
+  testStream(1000000007, 1000000007 + 10000000, 4096);
+  testStream(18446744073709551615ull - 100000, 18446744073709551615ull - 1000, 333);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
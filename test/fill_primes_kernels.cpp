@@ -0,0 +1,117 @@
+///
+/// @file   fill_primes_kernels.cpp
+/// @brief  Each fillPrimes() kernel supported by the CPU
+///         (AVX-512, BMI, ARM64 CTZ) must decode the same
+///         random sieve words into the same primes as the
+///         portable kernel.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/kernels.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Decode sieve[0, sieveSize[ in calls of at most size primes
+template <typename T>
+vector<T> decode(FillFunc<T> fill,
+                 const vector<byte_t>& sieve,
+                 uint64_t sieveSize,
+                 uint64_t low,
+                 uint64_t size)
+{
+  vector<T> primes;
+  // the kernels may write up to 64 entries past the last prime
+  vector<T> buffer(size + 64);
+  uint64_t sieveIdx = 0;
+
+  while (sieveIdx < sieveSize)
+  {
+    uint64_t n = fill(sieve.data(), &sieveIdx, sieveSize, &low, buffer.data(), size);
+    primes.insert(primes.end(), buffer.begin(), buffer.begin() + n);
+  }
+
+  return primes;
+}
+
+template <typename T>
+void test(const string& type, uint64_t low, mt19937_64& gen)
+{
+  auto kernels = getFillKernels<T>();
+  auto portable = kernels.front().func;
+
+  for (auto& kernel : kernels)
+  {
+    bool ok = true;
+
+    for (uint64_t bytes = 8; bytes <= 4096; bytes *= 2)
+    {
+      // sparse, random and dense sieve words
+      for (int density = 0; density < 3; density++)
+      {
+        vector<byte_t> sieve(bytes);
+        for (uint64_t i = 0; i < bytes; i += 8)
+        {
+          uint64_t bits = gen();
+          if (density == 0)
+            bits &= gen() & gen();
+          if (density == 2)
+            bits |= gen() | gen();
+          for (int j = 0; j < 8; j++)
+            sieve[i + j] = (byte_t) (bits >> (j * 8));
+        }
+
+        for (uint64_t size : { 64, 100, 1024 })
+          if (decode<T>(kernel.func, sieve, bytes, low, size) !=
+              decode<T>(portable, sieve, bytes, low, size))
+            ok = false;
+      }
+    }
+
+    cout << kernel.name << " fillPrimes kernel (" << type << ", low = " << low << ")";
+    check(ok);
+  }
+}
+
+int main()
+{
+  mt19937_64 gen(42);
+
+  test<uint64_t>("uint64_t", 0, gen);
+  test<uint64_t>("uint64_t", 30 * 1000000, gen);
+  test<uint64_t>("uint64_t", 30 * 600000000000000000ull, gen);
+  test<uint32_t>("uint32_t", 0, gen);
+  test<uint32_t>("uint32_t", 30 * 100000000ull, gen);
+
+#if defined(__aarch64__)
+  bool ctz = false;
+  for (auto& kernel : getFillKernels<uint64_t>())
+    ctz |= (string(kernel.name) == "CTZ");
+  cout << "CTZ fillPrimes kernel is tested";
+  check(ctz);
+#endif
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,107 @@
+///
+/// @file   for_each_prime.cpp
+/// @brief  Test the single and multi-threaded for_each_prime()
+///         against count_primes() and generate_primes().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+struct Visitor
+{
+  uint64_t count = 0;
+  uint64_t sum = 0;
+  uint64_t prev = 0;
+  bool increasing = true;
+
+  void operator()(uint64_t prime)
+  {
+    increasing = increasing && prime > prev;
+    prev = prime;
+    count++;
+    sum += prime;
+  }
+};
+
+uint64_t sum(uint64_t start, uint64_t stop)
+{
+  uint64_t s = 0;
+  primesieve::iterator it(start > 0 ? start - 1 : 0, stop);
+  for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+    s += prime;
+  return s;
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+  vector<uint64_t> res;
+  for_each_prime(start, stop, [&](uint64_t prime) { res.push_back(prime); });
+
+  cout << "for_each_prime(" << start << ", " << stop << ") = " << res.size();
+  check(res == primes);
+}
+
+void testParallel(uint64_t start, uint64_t stop, int threads)
+{
+  Visitor total;
+  bool increasing = true;
+
+  for (auto& visitor : for_each_prime(start, stop, threads, Visitor()))
+  {
+    total.count += visitor.count;
+    total.sum += visitor.sum;
+    increasing = increasing && visitor.increasing;
+  }
+
+  cout << "for_each_prime(" << start << ", " << stop << ", threads = " << threads << ") = " << total.count;
+  check(increasing &&
+        total.count == count_primes(start, stop) &&
+        total.sum == sum(start, stop));
+}
+
+int main()
+{
+  test(0, 100);
+  test(2, 5);
+  test(5, 7);
+  test(1000, 1000000);
+  test(18446744073709551615ull - 1000000, 18446744073709551615ull);
+
+  for (int i = 0; i < 10; i++)
+  {
+    uint64_t start = rand() % 10000000;
+    uint64_t stop = start + rand() % 10000000;
+    test(start, stop);
+  }
+
+  testParallel(0, 100, 4);
+  testParallel(0, 100000000, 1);
+  testParallel(0, 100000000, 3);
+  testParallel(1000000000000ull, 1000000000000ull + 100000000, 8);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
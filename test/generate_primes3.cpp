@@ -0,0 +1,141 @@
+///
+/// @file   generate_primes3.cpp
+/// @brief  Test that generate_primes() and generate_n_primes()
+///         (which copy the primes in bulk and use multiple
+///         threads) generate the same primes as
+///         primesieve::iterator, also for narrow types and
+///         the 32-bit PrimeGenerator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+uint64_t nextPrimeAfter(uint64_t n)
+{
+  primesieve::iterator it(n);
+  return it.next_prime();
+}
+
+template <typename T>
+bool isEqual(uint64_t start, uint64_t stop, const vector<T>& primes)
+{
+  primesieve::iterator it(start);
+  uint64_t prime = it.next_prime();
+  size_t i = 0;
+
+  for (; prime <= stop; prime = it.next_prime(), i++)
+    if (i >= primes.size() || (uint64_t) primes[i] != prime)
+      return false;
+
+  return i == primes.size();
+}
+
+int main()
+{
+  uint64_t start = 1000;
+  uint64_t stop = 3000000;
+
+  vector<uint64_t> primes64;
+  generate_primes(start, stop, &primes64);
+  cout << "generate_primes(" << start << ", " << stop << ") uint64_t";
+  check(isEqual(start - 1, stop, primes64));
+
+  vector<uint32_t> primes32;
+  generate_primes(start, stop, &primes32);
+  cout << "generate_primes(" << start << ", " << stop << ") uint32_t";
+  check(isEqual(start - 1, stop, primes32));
+
+  vector<uint16_t> primes16;
+  generate_primes(65535, &primes16);
+  cout << "generate_primes(65535) uint16_t";
+  check(isEqual(0, 65535, primes16));
+
+  primes32.clear();
+  generate_n_primes(200000, 100, &primes32);
+  cout << "generate_n_primes(200000, 100) uint32_t";
+  check(primes32.size() == 200000 &&
+        isEqual(99, primes32.back(), primes32));
+
+  // large enough for multiple threads
+  start = 100000000;
+  stop = 150000000;
+  primes32.clear();
+  generate_primes(start, stop, &primes32);
+  cout << "generate_primes(" << start << ", " << stop << ") uint32_t";
+  check(isEqual(start - 1, stop, primes32));
+
+  primes64.clear();
+  generate_n_primes(2000000, start, &primes64);
+  cout << "generate_n_primes(2000000, " << start << ") uint64_t";
+  check(primes64.size() == 2000000 &&
+        isEqual(start - 1, primes64.back(), primes64));
+
+  // 32-bit PrimeGenerator, stop < 2^32
+  for (uint64_t i = 0; i < 20; i++)
+  {
+    start = 5000000 + i * 12345;
+    stop = start + i * i * 1000;
+    primes32.clear();
+    generate_primes(start, stop, &primes32);
+    if (!isEqual(start - 1, stop, primes32))
+    {
+      cout << "generate_primes(" << start << ", " << stop << ") uint32_t";
+      check(false);
+    }
+  }
+
+  cout << "generate_primes(5000000 + i * 12345, ...) uint32_t";
+  check(true);
+
+  start = 4294967295ull - 20000000;
+  stop = 4294967295ull;
+  primes32.clear();
+  generate_primes(start, stop, &primes32);
+  cout << "generate_primes(" << start << ", " << stop << ") uint32_t";
+  check(isEqual(start - 1, stop, primes32) &&
+        primes32.back() == 4294967291u);
+
+  // the primes are appended
+  vector<uint32_t> appended;
+  generate_primes(start, start + 10000000, &appended);
+  generate_primes(start + 10000001, stop, &appended);
+  cout << "generate_primes() appends to uint32_t vector";
+  check(appended == primes32);
+
+  // next_primes() followed by next_prime()
+  primesieve::iterator it;
+  const uint64_t* first;
+  const uint64_t* last;
+  it.next_primes(&first, &last);
+  uint64_t prime = last[-1];
+  it.next_primes(&first, &last);
+  cout << "next_primes() continues after " << prime;
+  check(*first == nextPrimeAfter(prime));
+  prime = last[-1];
+  cout << "next_prime() continues after " << prime;
+  check(it.next_prime() == nextPrimeAfter(prime));
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+///
+/// @file   generate_primes_to_file.cpp
+/// @brief  Compare the primes written by generate_primes_to_file()
+///         with generate_primes().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+template <typename T>
+vector<T> readFile(const string& filename)
+{
+  ifstream file(filename, ios::binary);
+  vector<char> bytes((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+  vector<T> primes(bytes.size() / sizeof(T));
+  copy(bytes.begin(), bytes.begin() + primes.size() * sizeof(T), (char*) primes.data());
+  return primes;
+}
+
+template <typename T>
+void test(const string& filename, uint64_t start, uint64_t stop)
+{
+  vector<T> primes;
+  generate_primes(start, stop, &primes);
+  uint64_t count = generate_primes_to_file(start, stop, filename, sizeof(T));
+
+  cout << "generate_primes_to_file(" << start << ", " << stop << ", bytes = " << sizeof(T) << ") = " << count;
+  check(count == primes.size() && readFile<T>(filename) == primes);
+}
+
+int main()
+{
+  string filename = "generate_primes_to_file_test.bin";
+
+  test<uint16_t>(filename, 0, 65535);
+  test<uint32_t>(filename, 24, 28);
+  test<uint32_t>(filename, 0, 100000000);
+  test<uint64_t>(filename, 1000000000000ull, 1000000000000ull + 50000000);
+  test<uint64_t>(filename, 18446744073709551615ull - 1000000, 18446744073709551615ull);
+
+  cout << "generate_primes_to_file(0, 2^32, bytes = 4)";
+  try
+  {
+    generate_primes_to_file(0, 1ull << 32, filename, 4);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  remove(filename.c_str());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,134 @@
+///
+/// @file   generate_tuplets.cpp
+/// @brief  Test generate_tuplets(), generate_twins(),
+///         fill_tuplets() and the C equivalents against the
+///         prime k-tuplets found in the generated primes.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+const vector<vector<vector<uint64_t>>> patterns =
+{
+  { },
+  { },
+  { { 0, 2 } },
+  { { 0, 2, 6 }, { 0, 4, 6 } },
+  { { 0, 2, 6, 8 } },
+  { { 0, 2, 6, 8, 12 }, { 0, 4, 6, 10, 12 } },
+  { { 0, 4, 6, 10, 12, 16 } }
+};
+
+/// First members of the k-tuplets inside [start, stop]
+vector<uint64_t> findTuplets(int k, uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+  vector<uint64_t> tuplets;
+
+  for (uint64_t p : primes)
+  {
+    for (auto& offsets : patterns[k])
+    {
+      bool found = true;
+      for (uint64_t offset : offsets)
+        found = found && p + offset <= stop &&
+                binary_search(primes.begin(), primes.end(), p + offset);
+      if (found)
+      {
+        tuplets.push_back(p);
+        break;
+      }
+    }
+  }
+
+  return tuplets;
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  for (int k = 2; k <= 6; k++)
+  {
+    vector<uint64_t> expected = findTuplets(k, start, stop);
+    vector<uint64_t> tuplets;
+    generate_tuplets(k, start, stop, &tuplets);
+    cout << "generate_tuplets(" << k << ", " << start << ", " << stop << ") = " << tuplets.size();
+    check(tuplets == expected);
+
+    // fill a small buffer repeatedly
+    vector<uint64_t> filled;
+    uint64_t buffer[1000];
+    uint64_t low = start;
+    size_t written = 0;
+    while (fill_tuplets(k, low, stop, buffer, 1000, &written))
+    {
+      filled.insert(filled.end(), buffer, buffer + written);
+      low = buffer[written - 1] + 1;
+    }
+    filled.insert(filled.end(), buffer, buffer + written);
+    cout << "fill_tuplets(" << k << ", " << start << ", " << stop << ") = " << filled.size();
+    check(filled == expected);
+
+    size_t size = 0;
+    uint64_t* ctuplets = primesieve_generate_tuplets(k, start, stop, &size);
+    cout << "primesieve_generate_tuplets(" << k << ", " << start << ", " << stop << ") = " << size;
+    check(size == expected.size() && equal(ctuplets, ctuplets + size, expected.begin()));
+    primesieve_free(ctuplets);
+  }
+}
+
+int main()
+{
+  test(0, 1000000);
+  test(5, 13);
+  test(1000000000000ull, 1000000000000ull + 100000000);
+
+  vector<pair<uint64_t, uint64_t>> twins;
+  generate_twins(0, 100000000, &twins);
+  bool OK = twins.size() == count_twins(0, 100000000);
+  for (auto& t : twins)
+    OK = OK && t.second == t.first + 2 && is_prime(t.first) && is_prime(t.second);
+  cout << "generate_twins(0, 10^8) = " << twins.size();
+  check(OK);
+
+  // multi-threaded
+  set_num_threads(4);
+  vector<uint64_t> tuplets;
+  generate_tuplets(3, 1000000000, 1000000000 + 500000000, &tuplets);
+  OK = tuplets.size() == count_triplets(1000000000, 1000000000 + 500000000) &&
+       is_sorted(tuplets.begin(), tuplets.end());
+  cout << "generate_tuplets(3, 10^9, 1.5 * 10^9), 4 threads = " << tuplets.size();
+  check(OK);
+
+  size_t written = 0;
+  uint64_t buffer[1];
+  cout << "primesieve_fill_tuplets(7, ...) = -1";
+  check(primesieve_fill_tuplets(7, 0, 100, buffer, 1, &written) == -1);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
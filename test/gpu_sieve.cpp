@@ -0,0 +1,66 @@
+///
+/// @file   gpu_sieve.cpp
+/// @brief  Compare the prime counts of the GPU with the CPU,
+///         without an OpenCL GPU ParallelSieve must fall back
+///         to the CPU.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/GpuSieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  ParallelSieve ps;
+  ps.setGpu(true);
+  ps.sieve((uint64_t) 1e9, (uint64_t) 3e9);
+  uint64_t count = ps.getCount(0);
+  cout << "ParallelSieve::setGpu(true) count_primes(10^9, 3*10^9) = " << count;
+  check(count == 93602003);
+
+  if (!gpuAvailable())
+    cout << "No OpenCL GPU available, skipping GPU tests" << endl;
+  else
+  {
+    cout << "GPU: " << gpuName() << endl;
+
+    uint64_t ranges[][2] =
+    {
+      { 0, 0 }, { 0, 2 }, { 1, 3 }, { 3, 3 }, { 0, 100 },
+      { 999983, 5000000 }, { 1000000007, 1002000000 },
+      { (uint64_t) 1e13, (uint64_t) 1e13 + (uint64_t) 5e9 }
+    };
+
+    for (auto& r : ranges)
+    {
+      uint64_t gpu = gpuCountPrimes(r[0], r[1]);
+      uint64_t cpu = count_primes(r[0], r[1]);
+      cout << "gpuCountPrimes(" << r[0] << ", " << r[1] << ") = " << gpu;
+      check(gpu == cpu);
+    }
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+///
+/// @file   is_prime1.cpp
+/// @brief  Test is_prime() and the batch is_prime().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Check is_prime(n) and the batch is_prime()
+/// for all n inside [start, stop]
+///
+void checkRange(uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+
+  vector<uint64_t> numbers;
+  vector<bool> expected;
+  size_t i = 0;
+
+  for (uint64_t n = start; n <= stop; n++)
+  {
+    bool isPrime = (i < primes.size() && primes[i] == n);
+    i += isPrime;
+    numbers.push_back(n);
+    expected.push_back(isPrime);
+  }
+
+  // shuffle, the batch is_prime() sorts the numbers
+  mt19937_64 rng(start);
+  for (size_t j = numbers.size() - 1; j > 0; j--)
+  {
+    size_t k = rng() % (j + 1);
+    swap(numbers[j], numbers[k]);
+    bool tmp = expected[j];
+    expected[j] = expected[k];
+    expected[k] = tmp;
+  }
+
+  bool OK = true;
+  for (size_t j = 0; j < numbers.size(); j++)
+    OK = OK && (is_prime(numbers[j]) == expected[j]);
+
+  cout << "is_prime(n) for n in [" << start << ", " << stop << "]";
+  check(OK);
+
+  unique_ptr<bool[]> results(new bool[numbers.size()]);
+  is_prime(numbers.data(), numbers.size(), results.get());
+
+  for (size_t j = 0; j < numbers.size(); j++)
+    OK = OK && (results[j] == expected[j]);
+
+  cout << "is_prime(numbers, " << numbers.size() << ", results)";
+  check(OK);
+}
+
+int main()
+{
+  checkRange(0, 2000000);
+  checkRange(1000000000000000ull, 1000000000100000ull);
+  checkRange(18446744073709451614ull, 18446744073709551614ull);
+
+  // sparse batch, tested using Miller-Rabin
+  uint64_t numbers[] = { 18446744073709551615ull, 18446744073709551557ull, 3825123056546413051ull, 1000000007, 4, 2 };
+  bool expected[] = { false, true, false, true, false, true };
+  bool results[6];
+  is_prime(numbers, 6, results);
+  bool OK = true;
+
+  for (int i = 0; i < 6; i++)
+    OK = OK && (results[i] == expected[i]) && (is_prime(numbers[i]) == expected[i]);
+
+  cout << "is_prime(sparse numbers, 6, results)";
+  check(OK);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,76 @@
+///
+/// @file   is_prime2.c
+/// @brief  Test primesieve_is_prime() and
+///         primesieve_is_prime_batch().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  uint64_t start = 1000000000000ull;
+  uint64_t stop = start + 100000;
+  size_t size = 0;
+  uint64_t* primes = (uint64_t*) primesieve_generate_primes(start, stop, &size, UINT64_PRIMES);
+  uint64_t* numbers = (uint64_t*) malloc((stop - start + 1) * sizeof(uint64_t));
+  int* results = (int*) malloc((stop - start + 1) * sizeof(int));
+  size_t i = 0;
+  int OK = 1;
+  uint64_t n;
+
+  for (n = start; n <= stop; n++)
+  {
+    int isPrime = (i < size && primes[i] == n);
+    i += isPrime;
+    numbers[n - start] = n;
+    OK = OK && (primesieve_is_prime(n) == isPrime);
+  }
+
+  printf("primesieve_is_prime(n) for n in [%" PRIu64 ", %" PRIu64 "]", start, stop);
+  check(OK);
+
+  primesieve_is_prime_batch(numbers, stop - start + 1, results);
+
+  for (i = 0, n = start; n <= stop; n++)
+  {
+    int isPrime = (i < size && primes[i] == n);
+    i += isPrime;
+    OK = OK && (results[n - start] == isPrime);
+  }
+
+  printf("primesieve_is_prime_batch()");
+  check(OK);
+
+  printf("primesieve_is_prime(2) = %d", primesieve_is_prime(2));
+  check(primesieve_is_prime(2) == 1);
+
+  free(results);
+  free(numbers);
+  primesieve_free(primes);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
@@ -0,0 +1,103 @@
+///
+/// @file   iterator_compression.cpp
+/// @brief  Test prev_prime() with the gap-compressed buffer of
+///         primesieve::iterator and primesieve_iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t dist)
+{
+  vector<uint64_t> primes;
+  uint64_t low = (start > dist) ? start - dist : 0;
+  generate_primes(low, start, &primes);
+
+  // iterate backwards
+  bool OK = true;
+  primesieve::iterator it(start + 1);
+  for (auto p = primes.rbegin(); p != primes.rend(); p++)
+    OK = OK && it.prev_prime() == *p;
+
+  // change direction twice
+  size_t n = primes.size() / 2;
+  for (size_t i = 1; i <= n; i++)
+    OK = OK && it.next_prime() == primes[i];
+  for (size_t i = n; i-- > 0;)
+    OK = OK && it.prev_prime() == primes[i];
+
+  primesieve_iterator cit;
+  primesieve_init(&cit);
+  primesieve_skipto(&cit, start + 1, low);
+  for (auto p = primes.rbegin(); p != primes.rend(); p++)
+    OK = OK && primesieve_prev_prime(&cit) == *p;
+  primesieve_free_iterator(&cit);
+
+  cout << "prev_prime() from " << start << ", " << primes.size() << " primes";
+  check(OK);
+}
+
+int main()
+{
+  cout << "get_iterator_compression() = " << get_iterator_compression();
+  check(!get_iterator_compression());
+
+  set_iterator_compression(true);
+  cout << "set_iterator_compression(true) = " << get_iterator_compression();
+  check(get_iterator_compression() && primesieve_get_iterator_compression() == 1);
+
+  // small intervals, many blocks
+  set_iterator_memory_limit(1 << 16);
+  test(1000000000000ull, 10000000);
+  set_iterator_memory_limit(0);
+
+  // down to 0
+  test(100000, 100000);
+  test(100000000, 100000000);
+
+  // maximal prime gap of 540 after 738832927927
+  // requires the 3 bytes encoding
+  test(738832928467ull + 1000, 100000);
+
+  // 2^64 - 59 is the largest 64-bit prime
+  test(18446744073709551557ull, 1000000);
+
+  // prev_prime(2) = 0
+  {
+    primesieve::iterator it(20);
+    bool OK = true;
+    for (uint64_t p : { 19, 17, 13, 11, 7, 5, 3, 2, 0 })
+      OK = OK && it.prev_prime() == p;
+    cout << "prev_prime() below 20";
+    check(OK);
+  }
+
+  set_iterator_compression(false);
+  cout << "set_iterator_compression(false) = " << get_iterator_compression();
+  check(!get_iterator_compression());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
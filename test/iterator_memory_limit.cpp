@@ -0,0 +1,83 @@
+///
+/// @file   iterator_memory_limit.cpp
+/// @brief  Test primesieve::iterator with a small memory limit
+///         and different growth factors.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t dist)
+{
+  vector<uint64_t> primes;
+  generate_primes(start - dist, start, &primes);
+
+  // iterate backwards
+  bool OK = true;
+  primesieve::iterator it(start + 1);
+  for (auto p = primes.rbegin(); p != primes.rend(); p++)
+    OK = OK && it.prev_prime() == *p;
+
+  // iterate forwards
+  it.skipto(start - dist - 1);
+  for (uint64_t p : primes)
+    OK = OK && it.next_prime() == p;
+
+  cout << "iterator(" << start << "), growth = " << get_iterator_growth()
+       << ", limit = " << get_iterator_memory_limit();
+  check(OK);
+}
+
+int main()
+{
+  cout << "get_iterator_memory_limit() = " << get_iterator_memory_limit();
+  check(get_iterator_memory_limit() == (1 << 20) * 1024ull);
+
+  cout << "get_iterator_growth() = " << get_iterator_growth();
+  check(get_iterator_growth() == 4);
+
+  set_iterator_growth(0);
+  cout << "set_iterator_growth(0) = " << get_iterator_growth();
+  check(get_iterator_growth() == 1);
+
+  set_iterator_growth(1000);
+  cout << "set_iterator_growth(1000) = " << get_iterator_growth();
+  check(get_iterator_growth() == 64);
+
+  for (int growth : { 1, 2, 4 })
+  {
+    set_iterator_growth(growth);
+    set_iterator_memory_limit(1 << 16);
+    test(1000000000000ull, 30000000);
+    test(1000000000000000ull, 3000000);
+    set_iterator_memory_limit(0);
+    test(1000000000, 30000000);
+  }
+
+  cout << "set_iterator_memory_limit(0) = " << get_iterator_memory_limit();
+  check(get_iterator_memory_limit() == (1 << 20) * 1024ull);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
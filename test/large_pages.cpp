@@ -0,0 +1,85 @@
+///
+/// @file   large_pages.cpp
+/// @brief  Test allocatePages() and freePages(), large blocks
+///         may be backed by huge pages depending on the
+///         operating system configuration.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/LargePages.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+const char* pageName(PageType type)
+{
+  switch (type)
+  {
+    case HUGE_PAGES: return "huge pages";
+    case TRANSPARENT_HUGE_PAGES: return "transparent huge pages";
+    default: return "normal pages";
+  }
+}
+
+int main()
+{
+  PageType type = HUGE_PAGES;
+  void* small = allocatePages(1 << 16, &type);
+  cout << "allocatePages(64 KiB) uses " << pageName(type);
+  check(small != nullptr && type == NORMAL_PAGES);
+  freePages(small, 1 << 16);
+
+  // not a multiple of the huge page size
+  size_t sizes[] = { HUGE_PAGE_SIZE, (5 << 20) + 123 };
+
+  for (size_t bytes : sizes)
+  {
+    void* ptr = allocatePages(bytes, &type);
+    cout << "allocatePages(" << bytes << ") uses " << pageName(type);
+    check(ptr != nullptr);
+
+    char* buf = (char*) ptr;
+    memset(buf, 0xab, bytes);
+    cout << "memory is writable";
+    check(buf[0] == (char) 0xab && buf[bytes - 1] == (char) 0xab);
+
+    if (type != NORMAL_PAGES)
+    {
+      cout << "aligned to HUGE_PAGE_SIZE";
+      check((uintptr_t) ptr % HUGE_PAGE_SIZE == 0);
+    }
+
+    freePages(ptr, bytes);
+  }
+
+  freePages(nullptr, HUGE_PAGE_SIZE);
+
+  // the 8 MiB sieve array and the EratBig
+  // buckets are allocated using allocatePages()
+  set_sieve_size(8192);
+  uint64_t count = count_primes((uint64_t) 1e15, (uint64_t) 1e15 + (uint64_t) 1e9);
+  cout << "count_primes(10^15, 10^15+10^9) = " << count;
+  check(count == 28946421);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
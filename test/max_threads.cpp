@@ -0,0 +1,65 @@
+///
+/// @file   max_threads.cpp
+/// @brief  The default number of threads must not exceed the
+///         CPUs allowed by the CPU affinity and the cgroup
+///         CPU quota of the process.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+#include <primesieve/Affinity.hpp>
+#include <primesieve/CpuInfo.hpp>
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  int maxThreads = get_max_threads();
+  int hwThreads = (int) thread::hardware_concurrency();
+  cout << "get_max_threads() = " << maxThreads;
+  check(maxThreads >= 1 && (hwThreads == 0 || maxThreads <= hwThreads));
+
+  cout << "primesieve_get_max_threads() = " << primesieve_get_max_threads();
+  check(primesieve_get_max_threads() == maxThreads);
+
+  int allowed = (int) getAllowedCpus().size();
+  cout << "CPU affinity = " << allowed;
+  check(allowed == 0 || maxThreads <= allowed);
+
+  string limit;
+  int cpus = getAvailableCpus(limit);
+  cout << "getAvailableCpus() = " << cpus << " " << limit;
+  check(cpus == maxThreads &&
+        limit == cpuInfo.cpuLimit() &&
+        (!limit.empty() || hwThreads == 0 || cpus == hwThreads));
+
+  cout << "get_num_threads() = " << get_num_threads();
+  check(get_num_threads() == maxThreads);
+
+  set_num_threads(1 << 20);
+  cout << "set_num_threads(2^20), get_num_threads() = " << get_num_threads();
+  check(get_num_threads() == maxThreads);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,78 @@
+///
+/// @file   memory_limit.cpp
+/// @brief  Test primesieve::set_memory_limit(), the number of
+///         threads must be reduced so that the estimated memory
+///         usage stays within the limit.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  cout << "get_memory_limit() = " << get_memory_limit();
+  check(get_memory_limit() == 0);
+
+  ParallelSieve ps;
+  ps.setStart((uint64_t) 1e18);
+  ps.setStop((uint64_t) 1e18 + (uint64_t) 1e14);
+  ps.setNumThreads(ParallelSieve::getMaxThreads());
+  int threads = ps.idealNumThreads();
+  uint64_t perThread = ps.getThreadMemory(ps.getSieveSize());
+
+  cout << "getThreadMemory() = " << perThread;
+  check(perThread > (uint64_t) 50e6 * 8);
+
+  ps.setMemoryLimit(perThread * 2);
+  cout << "idealNumThreads() = " << ps.idealNumThreads();
+  check(ps.idealNumThreads() <= 2 &&
+        ps.idealNumThreads() <= threads);
+
+  ps.setMemoryLimit(1);
+  cout << "idealNumThreads() = " << ps.idealNumThreads();
+  check(ps.idealNumThreads() == 1);
+
+  uint64_t start = (uint64_t) 1e15;
+  uint64_t stop = start + (uint64_t) 1e9;
+  uint64_t count = count_primes(start, stop);
+
+  set_memory_limit(1 << 20);
+  cout << "get_memory_limit() = " << get_memory_limit();
+  check(get_memory_limit() == (1 << 20));
+
+  uint64_t res = count_primes(start, stop);
+  cout << "count_primes(1e15, 1e15+1e9) = " << res;
+  check(res == count);
+
+  context ctx;
+  ctx.set_memory_limit(1 << 20);
+  cout << "ctx.get_memory_limit() = " << ctx.get_memory_limit();
+  check(ctx.get_memory_limit() == (1 << 20));
+  res = ctx.count_primes(start, stop);
+  cout << "ctx.count_primes(1e15, 1e15+1e9) = " << res;
+  check(res == count);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
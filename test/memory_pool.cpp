@@ -0,0 +1,93 @@
+///
+/// @file   memory_pool.cpp
+/// @brief  Test the thread-local MemoryPool used by Erat,
+///         PreSieve and EratBig.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/MemoryPool.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  MemoryPool& pool = *memoryPool();
+  pool.release();
+
+  void* ptr1 = poolAllocate(1 << 16);
+  poolDeallocate(ptr1, 1 << 16);
+  cout << "cached bytes = " << pool.getCachedBytes();
+  check(pool.getCachedBytes() == 1 << 16);
+
+  void* ptr2 = poolAllocate(1 << 16);
+  cout << "reuse freed block";
+  check(ptr1 == ptr2);
+  poolDeallocate(ptr2, 1 << 16);
+
+  size_t tooLarge = config::MAX_CACHE_POOL;
+  void* ptr3 = poolAllocate(tooLarge);
+  poolDeallocate(ptr3, tooLarge);
+  cout << "cached bytes <= MAX_CACHE_POOL";
+  check(pool.getCachedBytes() == 1 << 16);
+
+  pool.release();
+  cout << "release() cached bytes = " << pool.getCachedBytes();
+  check(pool.getCachedBytes() == 0);
+
+  uint64_t start = (uint64_t) 1e15;
+  uint64_t stop = start + (uint64_t) 1e8;
+  uint64_t count1 = count_primes(start, stop);
+  uint64_t count2 = count_primes(start, stop);
+  cout << "count_primes(10^15, 10^15+10^8) = " << count2;
+  check(count1 == count2 &&
+        count1 == 2893937);
+
+  // the memory is freed when the computation ends
+  cout << "cached bytes after count_primes() = " << pool.getCachedBytes();
+  check(pool.getCachedBytes() == 0);
+
+  // a context keeps the memory of its threads
+  context ctx;
+  ctx.set_num_threads(1);
+  uint64_t count3 = ctx.count_primes(start, stop);
+  cout << "context.count_primes(10^15, 10^15+10^8) = " << count3;
+  check(count3 == count1);
+
+  cout << "context cached bytes = " << pool.getCachedBytes();
+  check(pool.getCachedBytes() > 0);
+
+  release_memory();
+  cout << "release_memory() cached bytes = " << pool.getCachedBytes();
+  check(pool.getCachedBytes() == 0);
+
+  // the cache never exceeds the memory limit
+  set_memory_limit(1 << 16);
+  void* ptr4 = poolAllocate(1 << 17);
+  poolDeallocate(ptr4, 1 << 17);
+  cout << "cached bytes <= memory limit";
+  check(pool.getCachedBytes() == 0);
+  set_memory_limit(0);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,90 @@
+///
+/// @file   miller_rabin.cpp
+/// @brief  Test the Miller-Rabin primality test and the
+///         iterator's Miller-Rabin path after skipto().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/MillerRabin.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  uint64_t starts[] = { 0, 1000000000000ull, 18446744073709000000ull };
+
+  for (uint64_t start : starts)
+  {
+    uint64_t stop = start + 500000;
+    vector<uint64_t> primes;
+    generate_primes(start, stop, &primes);
+    size_t i = 0;
+    bool OK = true;
+
+    for (uint64_t n = start; n <= stop; n++)
+    {
+      bool isPrimeSieve = (i < primes.size() && primes[i] == n);
+      i += isPrimeSieve;
+      OK = OK && (isPrime(n) == isPrimeSieve);
+    }
+
+    cout << "isPrime(n) for n in [" << start << ", " << stop << "]";
+    check(OK);
+  }
+
+  // strong pseudoprimes to many small bases
+  uint64_t psp[] = { 2047, 3215031751ull, 341550071728321ull, 3825123056546413051ull };
+
+  for (uint64_t n : psp)
+  {
+    cout << "isPrime(" << n << ") = " << isPrime(n);
+    check(!isPrime(n));
+  }
+
+  uint64_t offsets[] = { 10000000000ull, 1000000000000000ull, 18446744073709551000ull };
+
+  for (uint64_t start : offsets)
+  {
+    // more primes than the Miller-Rabin buffer, except
+    // near 2^64 where there are only a few primes left
+    uint64_t n = (start < 18446744073709000000ull) ? 100 : 10;
+    vector<uint64_t> primes;
+    generate_n_primes(n, start + 1, &primes);
+    primesieve::iterator it(start);
+    bool OK = true;
+
+    for (uint64_t p : primes)
+      OK = OK && (it.next_prime() == p);
+
+    cout << "next_prime() after skipto(" << start << ")";
+    check(OK);
+  }
+
+  primesieve::iterator it(18446744073709551556ull);
+  it.next_prime();
+  cout << "next_prime(18446744073709551557) = " << it.next_prime();
+  check(it.prev_prime() == 18446744073709551557ull);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,88 @@
+///
+/// @file   next_primes1.cpp
+/// @brief  Test iterator::next_primes().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  vector<uint64_t> primes;
+  generate_primes(0, 10000000, &primes);
+
+  primesieve::iterator it;
+  vector<uint64_t> batch(5000);
+  size_t i = 0;
+
+  // mix next_primes() with next_prime() and
+  // use batch sizes smaller and larger than
+  // the iterator's buffer
+  for (size_t n = 1; i + n < primes.size(); n = n % 1000 * 3 + 1)
+  {
+    it.next_primes(batch.data(), n);
+    bool OK = true;
+    for (size_t j = 0; j < n; j++)
+      OK = OK && (batch[j] == primes[i + j]);
+    i += n;
+
+    cout << "next_primes(" << n << ") = " << batch[0] << " ... " << batch[n - 1];
+    check(OK);
+
+    uint64_t prime = it.next_prime();
+    cout << "next_prime() = " << prime;
+    check(prime == primes[i++]);
+  }
+
+  uint64_t sum = 0;
+  it.skipto(0);
+
+  // sum the primes below 10^9 in batches
+  while (true)
+  {
+    it.next_primes(batch.data(), batch.size());
+    size_t j = 0;
+    for (; j < batch.size() && batch[j] < 1000000000; j++)
+      sum += batch[j];
+    if (j < batch.size())
+      break;
+  }
+
+  cout << "Sum of the primes below 10^9 = " << sum;
+  check(sum == 24739512092254535ull);
+
+  it.skipto(18446744073709551556ull, 0);
+  it.next_primes(batch.data(), 10);
+  cout << "next_primes(18446744073709551556) = " << batch[0];
+  check(batch[0] == 18446744073709551557ull);
+
+  for (size_t j = 1; j < 10; j++)
+  {
+    cout << "next_primes()[" << j << "] = " << batch[j];
+    check(batch[j] == 18446744073709551615ull);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
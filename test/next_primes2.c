@@ -0,0 +1,77 @@
+///
+/// @file   next_primes2.c
+/// @brief  Test primesieve_next_primes().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+void check(int OK)
+{
+  if (OK)
+    printf("   OK\n");
+  else
+  {
+    printf("   ERROR\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  size_t size = 0;
+  uint64_t* primes = (uint64_t*) primesieve_generate_primes(0, 10000000, &size, UINT64_PRIMES);
+  uint64_t batch[5000];
+  primesieve_iterator it;
+  primesieve_init(&it);
+
+  size_t i = 0;
+  size_t j;
+  size_t n;
+  uint64_t prime;
+
+  /* mix primesieve_next_primes() with primesieve_next_prime() */
+  for (n = 1; i + n < size; n = n % 1000 * 3 + 1)
+  {
+    int OK = 1;
+    primesieve_next_primes(&it, batch, n);
+    for (j = 0; j < n; j++)
+      OK = OK && (batch[j] == primes[i + j]);
+    i += n;
+
+    printf("next_primes(%u) = %" PRIu64 " ... %" PRIu64, (unsigned) n, batch[0], batch[n - 1]);
+    check(OK);
+
+    prime = primesieve_next_prime(&it);
+    printf("next_prime() = %" PRIu64, prime);
+    check(prime == primes[i++]);
+  }
+
+  primesieve_skipto(&it, 18446744073709551556ull, 0);
+  primesieve_next_primes(&it, batch, 10);
+  printf("next_primes(18446744073709551556) = %" PRIu64, batch[0]);
+  check(batch[0] == 18446744073709551557ull);
+
+  for (j = 1; j < 10; j++)
+  {
+    printf("next_primes()[%u] = %" PRIu64, (unsigned) j, batch[j]);
+    check(batch[j] == 18446744073709551615ull);
+  }
+
+  primesieve_free_iterator(&it);
+  primesieve_free(primes);
+
+  printf("\n");
+  printf("All tests passed successfully!\n");
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+///
+/// @file   nth_prime4.cpp
+/// @brief  Test nth_prime() for large n whose nth prime is
+///         approximated using the inverse Riemann R function,
+///         and compare small n with primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace primesieve;
+
+/// nth prime for n = 10^i
+const uint64_t nths[12] =
+{
+  29ull,
+  541ull,
+  7919ull,
+  104729ull,
+  1299709ull,
+  15485863ull,
+  179424673ull,
+  2038074743ull,
+  22801763489ull,
+  252097800623ull,
+  2760727302517ull,
+  29996224275833ull
+};
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  uint64_t n = 1;
+
+  for (int i = 0; i < 12; i++)
+  {
+    n *= 10;
+    uint64_t prime = nth_prime(n);
+    cout << "nth_prime(" << n << ") = " << prime;
+    check(prime == nths[i]);
+  }
+
+  uint64_t starts[] = { 0, 1, 2, 3, 1000, 1000000007, 1000000000000ull };
+  bool OK = true;
+
+  for (uint64_t start : starts)
+  {
+    primesieve::iterator it(start);
+    for (int64_t i = 1; i <= 100; i++)
+      OK = OK && (nth_prime(i, start) == it.next_prime());
+
+    it.skipto(start);
+    for (int64_t i = 1; i <= 100; i++)
+    {
+      uint64_t prime = it.prev_prime();
+      if (prime < 2)
+        break;
+      OK = OK && (nth_prime(-i, start) == prime);
+    }
+  }
+
+  cout << "nth_prime(n, start) = iterator";
+  check(OK);
+
+  uint64_t maxPrime = 18446744073709551557ull;
+  cout << "nth_prime(1, 2^64 - 60) = " << nth_prime(1, maxPrime - 1);
+  check(nth_prime(1, maxPrime - 1) == maxPrime);
+
+  cout << "nth_prime(-1, 2^64 - 1) = " << nth_prime(-1, get_max_stop());
+  check(nth_prime(-1, get_max_stop()) == maxPrime);
+
+  cout << "nth_prime(-4, 7) = ";
+  try
+  {
+    nth_prime(-4, 7);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
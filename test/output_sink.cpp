@@ -0,0 +1,180 @@
+///
+/// @file   output_sink.cpp
+/// @brief  Write many buffers through an OutputSink into a pipe
+///         and into a file, the reader must receive exactly the
+///         written bytes. On Linux the pipe's reader also moves
+///         the pages onward to a second pipe using splice()
+///         before reading them (like pv), the sink must not
+///         modify pages that are still referenced by a pipe.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/OutputSink.hpp>
+#include <primesieve/config.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+  #include <unistd.h>
+#endif
+
+#if defined(__linux__)
+  #include <fcntl.h>
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Text of varying line lengths, similar to printed primes
+string getText(uint64_t bytes)
+{
+  string text;
+  for (uint64_t n = 1; text.size() < bytes; n = n * 7 + 3)
+    text += to_string(n % 1000000007) + "\n";
+  return text;
+}
+
+/// Write the text in pieces of different
+/// sizes, flush once in between
+void writeText(ostream& out, const string& text)
+{
+  size_t pos = 0;
+  for (size_t i = 0; pos < text.size(); i++)
+  {
+    size_t size = (i % 3 == 0) ? 1 : (i % 3 == 1) ? 1000 : (size_t) config::OUTPUT_BUFFER + 123;
+    size = min(size, text.size() - pos);
+    if (size == 1)
+      out << text[pos];
+    else
+      out.write(&text[pos], size);
+    pos += size;
+    if (i == 10)
+      out.flush();
+  }
+  out.flush();
+}
+
+int main()
+{
+#if defined(__unix__) || defined(__APPLE__)
+  string text = getText(config::OUTPUT_BUFFER * 9);
+
+  int fds[2];
+  cout << "pipe()";
+  check(pipe(fds) == 0);
+  string received;
+
+  thread reader([&]()
+  {
+    char buffer[1 << 16];
+    ssize_t bytes;
+    while ((bytes = read(fds[0], buffer, sizeof(buffer))) > 0)
+      received.append(buffer, (size_t) bytes);
+    close(fds[0]);
+  });
+
+  {
+    OutputSink sink(fds[1]);
+    ostream out(&sink);
+    writeText(out, text);
+    cout << "OutputSink pipe";
+    check(out.good());
+  }
+
+  close(fds[1]);
+  reader.join();
+  cout << "pipe bytes received = " << received.size();
+  check(received == text);
+
+#if defined(__linux__)
+  // pipe -> splice() -> pipe -> read()
+  int in[2];
+  int relay[2];
+  cout << "pipe() relay";
+  check(pipe(in) == 0 && pipe(relay) == 0);
+  fcntl(relay[1], F_SETPIPE_SZ, 1 << 20);
+  received.clear();
+
+  thread relayThread([&]()
+  {
+    ssize_t bytes;
+    while ((bytes = splice(in[0], nullptr, relay[1], nullptr, 1 << 20, 0)) > 0)
+      continue;
+    close(in[0]);
+    close(relay[1]);
+  });
+
+  thread relayReader([&]()
+  {
+    // read slowly, the spliced pages stay in the relay pipe
+    // while the sink refills its buffer
+    char buffer[1 << 12];
+    ssize_t bytes;
+    while ((bytes = read(relay[0], buffer, sizeof(buffer))) > 0)
+      received.append(buffer, (size_t) bytes);
+    close(relay[0]);
+  });
+
+  {
+    OutputSink sink(in[1]);
+    ostream out(&sink);
+    writeText(out, text);
+    cout << "OutputSink spliced pipe";
+    check(out.good());
+  }
+
+  close(in[1]);
+  relayThread.join();
+  relayReader.join();
+  cout << "spliced pipe bytes received = " << received.size();
+  check(received == text);
+#endif
+
+  FILE* file = tmpfile();
+  cout << "tmpfile()";
+  check(file != nullptr);
+
+  {
+    OutputSink sink(fileno(file));
+    ostream out(&sink);
+    writeText(out, text);
+  }
+
+  rewind(file);
+  string content(text.size() + 1, '\0');
+  size_t bytes = fread(&content[0], 1, content.size(), file);
+  content.resize(bytes);
+  fclose(file);
+  cout << "file bytes written = " << content.size();
+  check(content == text);
+
+  // std::cout has not been redirected
+  cout << "outputStream(&cout) != cout";
+  check(&outputStream(&cout) != &cout);
+
+  ostream other(cout.rdbuf());
+  cout << "outputStream(&other) = other";
+  check(&outputStream(&other) == &other);
+#endif
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,52 @@
+///
+/// @file   parallel_status.cpp
+/// @brief  The status of a multi-threaded sieve is summed up
+///         from the progress counters of the threads, it must
+///         reach 100% once sieving has finished.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t stop, int threads, int flags)
+{
+  ParallelSieve ps;
+  ps.setNumThreads(threads);
+  ps.sieve(start, stop, flags | CALCULATE_STATUS);
+
+  cout << "status(" << start << ", " << stop << ", threads = " << threads << ") = " << ps.getStatus();
+  check(ps.getStatus() == 100.0 &&
+        ps.getCount(0) == count_primes(start, stop));
+}
+
+int main()
+{
+  test(0, 1000000, 1, COUNT_PRIMES);
+  test(0, 100000000, 2, COUNT_PRIMES);
+  test(1000000000000ull, 1000000000000ull + 300000000, 8, COUNT_PRIMES);
+  test(1000000000000ull, 1000000000000ull + 100000000, 4, COUNT_PRIMES | COUNT_TWINS);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
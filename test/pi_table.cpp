@@ -0,0 +1,107 @@
+///
+/// @file   pi_table.cpp
+/// @brief  Test count_primes() and nth_prime() using a
+///         pi(x) table loaded with load_pi_table().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Compare the results with and without pi(x) table
+void testTable(const string& filename, uint64_t stop, uint64_t dist)
+{
+  write_pi_table(filename, stop, dist);
+
+  vector<uint64_t> starts, stops, nths;
+  for (int i = 0; i < 50; i++)
+  {
+    uint64_t a = rand() % (stop + dist);
+    uint64_t b = rand() % (stop + dist);
+    starts.push_back(min(a, b));
+    stops.push_back(max(a, b));
+  }
+  starts.push_back(0);
+  stops.push_back(stop);
+  starts.push_back(dist);
+  stops.push_back(dist * 2);
+
+  vector<uint64_t> counts;
+  for (size_t i = 0; i < starts.size(); i++)
+    counts.push_back(count_primes(starts[i], stops[i]));
+
+  vector<uint64_t> n = { 1, 2, 3, 4, 100, 1000, count_primes(0, dist), count_primes(0, dist) + 1 };
+  for (int i = 0; i < 20; i++)
+    n.push_back(1 + rand() % count_primes(0, stop));
+  for (uint64_t i : n)
+    nths.push_back(nth_prime(i));
+
+  load_pi_table(filename);
+
+  bool OK = true;
+  for (size_t i = 0; i < starts.size(); i++)
+    OK = OK && (count_primes(starts[i], stops[i]) == counts[i]);
+  cout << "count_primes() with pi(x) table, dist = " << dist;
+  check(OK);
+
+  for (size_t i = 0; i < n.size(); i++)
+    OK = OK && (nth_prime(n[i]) == nths[i]);
+  cout << "nth_prime() with pi(x) table, dist = " << dist;
+  check(OK);
+
+  cout << "nth_prime(-1, 1000) = " << nth_prime(-1, 1000);
+  check(nth_prime(-1, 1000) == 997);
+
+  unload_pi_table();
+}
+
+int main()
+{
+  string filename = "pi_table_test.bin";
+
+  testTable(filename, 1000, 7);
+  testTable(filename, 100000000, 1000000);
+  testTable(filename, 100000000, 30000000);
+
+  cout << "load invalid pi(x) table";
+  try
+  {
+    FILE* file = fopen(filename.c_str(), "wb");
+    fputs("not a pi(x) table", file);
+    fclose(file);
+    load_pi_table(filename);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  remove(filename.c_str());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
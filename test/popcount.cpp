@@ -0,0 +1,110 @@
+///
+/// @file   popcount.cpp
+/// @brief  Test the popcount kernel chosen at runtime
+///         (AVX-512, AVX2, POPCNT or portable) against
+///         a simple bit by bit count and each popcount
+///         kernel supported by the CPU against the
+///         portable kernel.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/kernels.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+uint64_t popcountNaive(const uint64_t* array, uint64_t size)
+{
+  uint64_t cnt = 0;
+  for (uint64_t i = 0; i < size; i++)
+    for (uint64_t x = array[i]; x; x &= x - 1)
+      cnt++;
+  return cnt;
+}
+
+int main()
+{
+  mt19937_64 gen(42);
+  vector<uint64_t> array(5000);
+
+  for (auto& x : array)
+    x = gen();
+
+  // test all array sizes around the unrolled loop
+  // lengths and an unaligned array start
+  bool ok = true;
+  for (uint64_t offset = 0; offset < 2; offset++)
+    for (uint64_t size = 0; size <= 300; size++)
+      if (popcount(&array[offset], size) != popcountNaive(&array[offset], size))
+        ok = false;
+
+  cout << "popcount(array, 0...300)";
+  check(ok);
+
+  uint64_t size = array.size();
+  uint64_t cnt = popcount(array.data(), size);
+  cout << "popcount(random, " << size << ") = " << cnt;
+  check(cnt == popcountNaive(array.data(), size));
+
+  for (auto& x : array)
+    x = ~0ull;
+
+  cnt = popcount(array.data(), size);
+  cout << "popcount(all ones, " << size << ") = " << cnt;
+  check(cnt == size * 64);
+
+  for (auto& x : array)
+    x = gen();
+
+  // sizes that are not a multiple of the vector width
+  auto kernels = getPopcountKernels();
+  auto portable = kernels.front().func;
+
+  for (auto& kernel : kernels)
+  {
+    ok = true;
+    for (uint64_t offset = 0; offset < 2; offset++)
+      for (uint64_t size = 0; size <= 300; size++)
+        if (kernel.func(&array[offset], size) != portable(&array[offset], size))
+          ok = false;
+
+    size = array.size() - 1;
+    if (kernel.func(&array[1], size) != portable(&array[1], size))
+      ok = false;
+
+    cout << kernel.name << " popcount kernel";
+    check(ok);
+  }
+
+#if defined(__aarch64__)
+  bool neon = false;
+  for (auto& kernel : kernels)
+    neon |= (string(kernel.name) == "NEON");
+  cout << "NEON popcount kernel is tested";
+  check(neon);
+#endif
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,80 @@
+///
+/// @file   pre_sieve.cpp
+/// @brief  Check that PreSieve removes exactly the multiples
+///         of the primes <= PreSieve::getMaxPrime().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/PreSieve.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+const uint64_t wheel[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+
+bool hasSmallFactor(uint64_t n, uint64_t maxPrime)
+{
+  for (uint64_t p = 7; p <= maxPrime; p += 2)
+    if (n % p == 0)
+      return true;
+
+  return false;
+}
+
+int main()
+{
+  PreSieve preSieve;
+  uint64_t maxPrime = preSieve.getMaxPrime();
+  cout << "PreSieve max prime = " << maxPrime;
+  check(maxPrime >= 23);
+
+  // segment lows including wrap-arounds of all patterns
+  vector<uint64_t> lows = { 0, 30, 30030, 26970, 222870, 9999990, 300300000000ull };
+  vector<uint64_t> sizes = { 1, 8, 1000, 20000 };
+
+  for (uint64_t low : lows)
+  {
+    for (uint64_t size : sizes)
+    {
+      vector<byte_t> sieve(size);
+      preSieve.copy(sieve.data(), size, low);
+      bool OK = true;
+
+      for (uint64_t i = 0; i < size; i++)
+      {
+        for (int bit = 0; bit < 8; bit++)
+        {
+          uint64_t n = low + i * 30 + wheel[bit];
+          bool isSet = (sieve[i] >> bit) & 1;
+          if (isSet == hasSmallFactor(n, maxPrime))
+            OK = false;
+        }
+      }
+
+      cout << "PreSieve::copy(" << size << ", " << low << ")";
+      check(OK);
+    }
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,69 @@
+///
+/// @file   prefetch_iterator.cpp
+/// @brief  Test that prefetch_iterator generates the same
+///         primes as primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  uint64_t starts[] = { 0, 1, 100, 1000000000000ull };
+
+  for (uint64_t start : starts)
+  {
+    primesieve::iterator it(start);
+    prefetch_iterator pit(start);
+    bool OK = true;
+
+    // more than one prefetch buffer
+    for (int i = 0; i < 1000000; i++)
+      OK = OK && (it.next_prime() == pit.next_prime());
+
+    cout << "prefetch_iterator(" << start << ") 10^6 primes";
+    check(OK);
+  }
+
+  uint64_t sum = 0;
+  prefetch_iterator pit(0, 1000000000, 1);
+  uint64_t prime = pit.next_prime();
+
+  for (; prime < 1000000000; prime = pit.next_prime())
+    sum += prime;
+
+  cout << "Sum of the primes below 10^9 = " << sum;
+  check(sum == 24739512092254535ull);
+
+  prefetch_iterator pit2(18446744073709551556ull, 0);
+  prime = pit2.next_prime();
+  cout << "next_prime(18446744073709551556) = " << prime;
+  check(prime == 18446744073709551557ull);
+
+  prime = pit2.next_prime();
+  cout << "next_prime(18446744073709551557) = " << prime;
+  check(prime == 18446744073709551615ull);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,70 @@
+///
+/// @file   prev_prime3.cpp
+/// @brief  Test long prev_prime() walks at large offsets
+///         where primesieve::iterator reuses its sieving
+///         primes for each new (lower) interval.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  uint64_t stop = 10000000000000ull;
+  uint64_t start = stop - 100000000;
+
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+
+  primesieve::iterator it(stop + 1);
+  bool OK = true;
+
+  for (size_t i = primes.size(); i > 0; i--)
+    OK = OK && (it.prev_prime() == primes[i - 1]);
+
+  cout << "iterator::prev_prime() from " << stop << " to " << start;
+  check(OK);
+
+  // the sieving primes must be extended after skipto()
+  it.skipto(stop * 100);
+  uint64_t prime = it.prev_prime();
+  cout << "prev_prime(" << stop * 100 << ") = " << prime;
+  check(prime == 999999999999989ull);
+
+  primesieve_iterator pi;
+  primesieve_init(&pi);
+  primesieve_skipto(&pi, stop + 1, 0);
+  OK = true;
+
+  for (size_t i = primes.size(); i > 0; i--)
+    OK = OK && (primesieve_prev_prime(&pi) == primes[i - 1]);
+
+  primesieve_free_iterator(&pi);
+  cout << "primesieve_prev_prime() from " << stop << " to " << start;
+  check(OK);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,117 @@
+///
+/// @file   prime_archive.cpp
+/// @brief  Write prime archives and compare the primes read
+///         back from the archive with primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void testArchive(const string& filename, uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+
+  uint64_t n = write_prime_archive(filename, start, stop);
+  cout << "write_prime_archive(" << start << ", " << stop << ") = " << n;
+  check(n == primes.size());
+
+  prime_archive archive(filename);
+  cout << "archive.size() = " << archive.size();
+  check(archive.size() == primes.size());
+
+  prime_archive::iterator it(archive, start > 0 ? start - 1 : 0);
+  bool OK = true;
+  for (uint64_t p : primes)
+    OK = OK && (it.next_prime() == p);
+  OK = OK && (it.next_prime() == get_max_stop());
+  cout << "archive next_prime()";
+  check(OK);
+
+  it.skipto(stop < get_max_stop() ? stop + 1 : stop);
+  for (size_t i = primes.size(); i > 0; i--)
+    OK = OK && (it.prev_prime() == primes[i - 1]);
+  OK = OK && (it.prev_prime() == 0);
+  cout << "archive prev_prime()";
+  check(OK);
+
+  // skipto() inside the archive
+  for (size_t i = 0; i < primes.size(); i += 997)
+  {
+    it.skipto(primes[i]);
+    uint64_t next = (i + 1 < primes.size()) ? primes[i + 1] : get_max_stop();
+    OK = OK && (it.next_prime() == next);
+    it.skipto(primes[i]);
+    uint64_t prev = (i > 0) ? primes[i - 1] : 0;
+    OK = OK && (it.prev_prime() == prev);
+    OK = OK && (archive.nth_prime(i + 1) == primes[i]);
+  }
+  cout << "archive skipto() & nth_prime()";
+  check(OK);
+
+  uint64_t dist = stop - start;
+  for (uint64_t i = 0; i < 100; i++)
+  {
+    uint64_t low = start + rand() % (dist + 1);
+    uint64_t high = low + rand() % (stop - low + 1);
+    auto first = lower_bound(primes.begin(), primes.end(), low);
+    auto last = upper_bound(primes.begin(), primes.end(), high);
+    OK = OK && (archive.count_primes(low, high) == (uint64_t) (last - first));
+  }
+  cout << "archive count_primes()";
+  check(OK);
+}
+
+int main()
+{
+  string filename = "prime_archive_test.bin";
+
+  testArchive(filename, 0, 100);
+  testArchive(filename, 7, 7);
+  testArchive(filename, 0, 10000000);
+  testArchive(filename, 1000000000000ull, 1000005000000ull);
+  testArchive(filename, 18446744073700000000ull, 18446744073709551615ull);
+
+  cout << "open invalid archive";
+  try
+  {
+    FILE* file = fopen(filename.c_str(), "wb");
+    fputs("not a prime archive", file);
+    fclose(file);
+    prime_archive archive(filename);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  remove(filename.c_str());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,101 @@
+///
+/// @file   prime_gaps.cpp
+/// @brief  Test the prime gap statistics (PrimeGaps) against
+///         primesieve::iterator. The interval is sieved in
+///         unordered chunks like ParallelSieve's threads do.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/PrimeGaps.hpp>
+#include <primesieve/PrimeSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Compare with the gaps of consecutive primes inside [start, stop]
+bool isEqual(uint64_t start, uint64_t stop, const PrimeGaps& gaps)
+{
+  vector<uint64_t> counts;
+  vector<uint64_t> firstPrimes;
+  primesieve::iterator it(start > 0 ? start - 1 : 0);
+  uint64_t prime = it.next_prime();
+  uint64_t next = it.next_prime();
+
+  for (; next <= stop; prime = next, next = it.next_prime())
+  {
+    uint64_t gap = next - prime;
+    if (gap >= counts.size())
+    {
+      counts.resize(gap + 1, 0);
+      firstPrimes.resize(gap + 1, 0);
+    }
+    if (!counts[gap]++)
+      firstPrimes[gap] = prime;
+  }
+
+  if (gaps.maxGap() + 1 != counts.size())
+    return false;
+
+  for (uint64_t gap = 0; gap < counts.size(); gap++)
+    if (gaps.count(gap) != counts[gap] ||
+        gaps.firstPrime(gap) != firstPrimes[gap])
+      return false;
+
+  return true;
+}
+
+int main()
+{
+  uint64_t start = 0;
+  uint64_t stop = 20000000;
+  PrimeGaps gaps1;
+  PrimeSieve ps;
+  ps.setPrimeGaps(&gaps1);
+  ps.sieve(start, stop);
+  cout << "PrimeGaps [" << start << ", " << stop << "]";
+  check(isEqual(start, stop, gaps1) && gaps1.maxGap() == 180);
+
+  // sieve the chunks in reverse order, the
+  // gaps between the chunks are added by finish()
+  start = 1000000000000ull;
+  stop = start + 30000000;
+  uint64_t chunks = 7;
+  uint64_t dist = (stop - start) / chunks;
+  PrimeGaps gaps2;
+  PrimeSieve parent;
+  parent.setPrimeGaps(&gaps2);
+
+  for (uint64_t i = chunks; i-- > 0;)
+  {
+    uint64_t low = start + dist * i;
+    uint64_t high = (i == chunks - 1) ? stop : low + dist - 1;
+    PrimeSieve child(&parent);
+    child.sieve(low, high);
+  }
+
+  gaps2.finish();
+  cout << "PrimeGaps [" << start << ", " << stop << "] in " << chunks << " chunks";
+  check(isEqual(start, stop, gaps2));
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,138 @@
+///
+/// @file   prime_monitor.cpp
+/// @brief  A prime_monitor extended in many small steps must
+///         have the same prime, k-tuplet and gap statistics as
+///         the count functions and primesieve::iterator over
+///         the whole interval.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Gap statistics of [start, stop] using primesieve::iterator
+void gaps(uint64_t start, uint64_t stop, map<uint64_t, pair<uint64_t, uint64_t>>& gapMap)
+{
+  primesieve::iterator it((start > 0) ? start - 1 : 0, stop);
+  uint64_t prev = it.next_prime();
+
+  for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+  {
+    auto& g = gapMap[prime - prev];
+    if (!g.first)
+      g.second = prev;
+    g.first++;
+    prev = prime;
+  }
+}
+
+void test(uint64_t start, uint64_t stop, uint64_t maxStep, uint64_t seed)
+{
+  prime_monitor monitor(start);
+  mt19937_64 rng(seed);
+
+  for (uint64_t n = start; monitor.stop() < stop;)
+  {
+    n += rng() % maxStep;
+    monitor.extend(min(n, stop));
+  }
+
+  cout << "prime_monitor(" << start << ", " << stop << ") primes = " << monitor.count_primes();
+  check(monitor.count_primes() == count_primes(start, stop));
+  cout << "twins = " << monitor.count_twins();
+  check(monitor.count_twins() == count_twins(start, stop));
+  cout << "triplets = " << monitor.count_triplets();
+  check(monitor.count_triplets() == count_triplets(start, stop));
+  cout << "quadruplets = " << monitor.count_quadruplets();
+  check(monitor.count_quadruplets() == count_quadruplets(start, stop));
+  cout << "quintuplets = " << monitor.count_quintuplets();
+  check(monitor.count_quintuplets() == count_quintuplets(start, stop));
+  cout << "sextuplets = " << monitor.count_sextuplets();
+  check(monitor.count_sextuplets() == count_sextuplets(start, stop));
+
+  map<uint64_t, pair<uint64_t, uint64_t>> gapMap;
+  gaps(start, stop, gapMap);
+  bool OK = monitor.max_gap() == (gapMap.empty() ? 0 : gapMap.rbegin()->first);
+  for (auto& g : gapMap)
+    OK = OK && monitor.gap_count(g.first) == g.second.first &&
+               monitor.gap_first_prime(g.first) == g.second.second;
+
+  cout << "max gap = " << monitor.max_gap();
+  check(OK);
+
+  primesieve::iterator it(stop + 1);
+  uint64_t lastPrime = it.prev_prime();
+  if (lastPrime < start)
+    lastPrime = 0;
+  cout << "last prime = " << monitor.last_prime();
+  check(monitor.last_prime() == lastPrime);
+}
+
+int main()
+{
+  test(0, 1000, 10, 1);
+  test(0, 10000000, 50000, 2);
+  test(6, 100000, 7, 3);
+  test(1000000000000ull, 1000000000000ull + 20000000, 3000000, 4);
+  test(1000000000000000ull, 1000000000000000ull + 2000000, 100000, 5);
+
+  // the default horizon is 2^64 - 1
+  prime_monitor last(18446744073709551556ull);
+  last.extend(18446744073709551600ull);
+  last.extend(18446744073709551615ull);
+  cout << "prime_monitor(2^64 - 60, 2^64 - 1) last prime = " << last.last_prime();
+  check(last.count_primes() == 1 &&
+        last.last_prime() == 18446744073709551557ull);
+
+  // the horizon limits the stop number
+  prime_monitor monitor(100, 200);
+  monitor.extend(150);
+  monitor.extend(120);
+  cout << "extend() to a smaller stop, stop = " << monitor.stop();
+  check(monitor.stop() == 150);
+
+  try
+  {
+    monitor.extend(201);
+    cout << "extend() beyond horizon";
+    check(false);
+  }
+  catch (primesieve_error& e)
+  {
+    cout << "extend() beyond horizon: " << e.what();
+    check(true);
+  }
+
+  monitor.extend(200);
+  cout << "primes inside [100, 200] = " << monitor.count_primes();
+  check(monitor.count_primes() == 21);
+
+  prime_monitor empty(300, 200);
+  empty.extend(200);
+  cout << "start > horizon, primes = " << empty.count_primes();
+  check(empty.count_primes() == 0);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
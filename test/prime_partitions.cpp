@@ -0,0 +1,79 @@
+///
+/// @file   prime_partitions.cpp
+/// @brief  Count the primes and prime k-tuplets of short intervals
+///         at huge offsets with the sieving primes split among
+///         the threads and compare with a single thread.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/pmath.hpp>
+#include <primesieve/PrimePartitions.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/ThreadPool.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t stop, int threads)
+{
+  int flags = COUNT_PRIMES | COUNT_TWINS | COUNT_TRIPLETS;
+  SievingTable table(isqrt(stop), threads, 256);
+  atomic<uint64_t> processed(0);
+
+  counts_t counts = countPrimePartitions(start, stop, flags, 256, threads, table, threadPool(),
+    [&](int, uint64_t dist) { processed += dist; });
+
+  cout << "countPrimePartitions(" << start << ", " << stop << ", threads = " << threads << ") = " << counts[0];
+  check(counts[0] == count_primes(start, stop) &&
+        counts[1] == count_twins(start, stop) &&
+        counts[2] == count_triplets(start, stop) &&
+        counts[3] == 0 &&
+        processed <= stop - start);
+}
+
+int main()
+{
+  set_num_threads(1);
+
+  test(1000000000000000ull, 1000000000000000ull + 10000000, 4);
+  test(1000000000000000000ull, 1000000000000000000ull + 1000000, 3);
+  test(1000000000000000000ull + 7, 1000000000000000000ull + 7, 2);
+  test(18446744073709551615ull - 30000000, 18446744073709551615ull, 8);
+
+  // used by count_primes() if a single thread
+  // would have to sieve the whole interval
+  ParallelSieve ps;
+  ps.setStart((uint64_t) 1e18);
+  ps.setStop((uint64_t) 1e18 + (uint64_t) 1e7);
+  ps.setNumThreads(ParallelSieve::getMaxThreads());
+  cout << "idealNumThreads() = " << ps.idealNumThreads();
+  check(ps.idealNumThreads() == ParallelSieve::getMaxThreads());
+
+  set_num_threads(ParallelSieve::getMaxThreads());
+  uint64_t count = count_primes((uint64_t) 1e18, (uint64_t) 1e18 + (uint64_t) 1e7);
+  cout << "count_primes(10^18, 10^18 + 10^7) = " << count;
+  check(count == 241295);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,144 @@
+///
+/// @file   prime_queue.cpp
+/// @brief  Worker threads claiming blocks of a prime_queue, with
+///         very uneven work per prime, must together see each
+///         prime inside [start, stop] exactly once.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Sum and count of the primes >= start and <= stop
+void iterate(uint64_t start, uint64_t stop, uint64_t& sum, uint64_t& count)
+{
+  sum = 0;
+  count = 0;
+  if (start > stop)
+    return;
+
+  primesieve::iterator it((start > 0) ? start - 1 : 0, stop);
+  for (uint64_t prime = it.next_prime(); prime <= stop && ~prime != 0; prime = it.next_prime())
+  {
+    sum += prime;
+    count++;
+  }
+}
+
+/// Skewed work, the larger primes cost more
+uint64_t work(uint64_t prime)
+{
+  uint64_t x = prime;
+  for (uint64_t i = 0; i < (prime & 63); i++)
+    x = x * 6364136223846793005ull + 1442695040888963407ull;
+  return x;
+}
+
+void test(uint64_t start, uint64_t stop, int threads, size_t blockSize)
+{
+  uint64_t sum;
+  uint64_t count;
+  iterate(start, stop, sum, count);
+
+  prime_queue queue(start, stop, blockSize);
+  vector<uint64_t> sums(threads, 0);
+  vector<uint64_t> counts(threads, 0);
+  atomic<uint64_t> dummy(0);
+  vector<thread> workers;
+
+  for (int i = 0; i < threads; i++)
+  {
+    workers.emplace_back([&, i]()
+    {
+      vector<uint64_t> primes;
+      uint64_t x = 0;
+      while (queue.next_block(primes))
+      {
+        for (uint64_t prime : primes)
+        {
+          sums[i] += prime;
+          counts[i]++;
+          x += work(prime);
+        }
+      }
+      dummy += x;
+    });
+  }
+
+  for (thread& t : workers)
+    t.join();
+
+  uint64_t querySum = 0;
+  uint64_t queryCount = 0;
+  for (int i = 0; i < threads; i++)
+  {
+    querySum += sums[i];
+    queryCount += counts[i];
+  }
+
+  cout << "prime_queue(" << start << ", " << stop << "), " << threads << " threads = " << queryCount;
+  check(querySum == sum && queryCount == count);
+
+  // all blocks have been claimed
+  vector<uint64_t> primes;
+  cout << "next_block() after the last block = " << queue.next_block(primes);
+  check(primes.empty());
+}
+
+int main()
+{
+  test(0, 100, 2, 1);
+  test(2, 5, 3, 1024);
+  test(0, 100000000, 4, 1024);
+  test(1000000000000ull, 1000000000000ull + 100000000, 3, 100);
+  test(100, 99, 2, 1024);
+  test(18446744073709551556ull, 18446744073709551615ull, 2, 1);
+
+  struct Counter
+  {
+    uint64_t count = 0;
+    void operator()(uint64_t) { count++; }
+  };
+
+  auto counters = for_each_prime_dynamic(0, 200000000, 3, Counter());
+  uint64_t count = 0;
+  for (auto& counter : counters)
+    count += counter.count;
+  cout << "for_each_prime_dynamic(0, 2e8) = " << count;
+  check(count == count_primes(0, 200000000));
+
+  atomic<uint64_t> blocks(0);
+  prime_queue queue(0, 1000000, 1000);
+  queue.for_each_block(2, [&](int thread, const uint64_t*, size_t size) {
+    if (thread >= 0 && thread < 2 && size > 0)
+      blocks++;
+  });
+  cout << "for_each_block(0, 1e6) blocks = " << blocks;
+  // 2, 3, 5 are in their own block
+  check(blocks == 1 + (78495 + 999) / 1000);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
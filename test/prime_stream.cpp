@@ -0,0 +1,136 @@
+///
+/// @file   prime_stream.cpp
+/// @brief  Cursors of a prime_stream in different threads,
+///         consuming at different speeds, must each see the
+///         same primes as primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+
+#include <stdint.h>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Sum and count of the primes > start and <= stop
+void iterate(uint64_t start, uint64_t stop, uint64_t& sum, uint64_t& count)
+{
+  primesieve::iterator it(start, stop);
+  sum = 0;
+  count = 0;
+  for (uint64_t prime = it.next_prime(); prime <= stop && ~prime != 0; prime = it.next_prime())
+  {
+    sum += prime;
+    count++;
+  }
+}
+
+void test(uint64_t start, uint64_t stop, int cursors, size_t backlog)
+{
+  uint64_t sum;
+  uint64_t count;
+  iterate(start, stop, sum, count);
+
+  prime_stream stream(start, stop, backlog);
+  vector<unique_ptr<prime_stream::cursor>> cur;
+  for (int i = 0; i < cursors; i++)
+    cur.emplace_back(new prime_stream::cursor(stream));
+
+  vector<uint64_t> sums(cursors, 0);
+  vector<uint64_t> counts(cursors, 0);
+  vector<thread> threads;
+
+  for (int i = 0; i < cursors; i++)
+  {
+    threads.emplace_back([&, i]()
+    {
+      uint64_t n = 0;
+      for (uint64_t prime = cur[i]->next_prime(); ~prime != 0; prime = cur[i]->next_prime())
+      {
+        sums[i] += prime;
+        counts[i]++;
+        // the 1st cursor is slow
+        if (i == 0 && ++n % 100000 == 0)
+          this_thread::sleep_for(chrono::milliseconds(1));
+      }
+    });
+  }
+
+  for (thread& t : threads)
+    t.join();
+
+  bool OK = true;
+  for (int i = 0; i < cursors; i++)
+    OK = OK && sums[i] == sum && counts[i] == count;
+
+  cout << "prime_stream(" << start << ", " << stop << "), " << cursors << " cursors = " << count;
+  check(OK);
+
+  // returns UINT64_MAX after the last prime
+  cout << "next_prime() after stop = " << cur[0]->next_prime();
+  check(~cur[0]->next_prime() == 0);
+}
+
+int main()
+{
+  test(0, 100, 1, 1);
+  test(0, 100000000, 3, 2);
+  test(1000000000000ull, 1000000000000ull + 100000000, 4, 4);
+  test(100, 99, 2, 4);
+  test(18446744073709551556ull, 18446744073709551615ull, 2, 1);
+
+  // a cursor created after the other cursors have
+  // consumed the 1st block starts at the 2nd block
+  prime_stream stream(0, 1000000000, 2);
+  uint64_t prime = 0;
+  {
+    prime_stream::cursor c1(stream);
+    prime_stream::cursor c2(stream);
+    for (int i = 0; i < 1000; i++)
+      prime = c1.next_prime();
+    cout << "c1 1000th prime = " << prime;
+    check(prime == 7919);
+    prime = c2.next_prime();
+    cout << "c2 1st prime = " << prime;
+    check(prime == 2);
+  }
+
+  prime_stream::cursor c3(stream);
+  prime = c3.next_prime();
+  cout << "late cursor 1st prime = " << prime;
+  check(prime == nth_prime(config::PREFETCH_BUFFER + 1));
+
+  // the stream can be destroyed before its cursors
+  unique_ptr<prime_stream> s(new prime_stream(0, 1000));
+  prime_stream::cursor c4(*s);
+  s.reset();
+  uint64_t count = 0;
+  for (prime = c4.next_prime(); ~prime != 0; prime = c4.next_prime())
+    count++;
+  cout << "cursor after stream destroyed = " << count;
+  check(count <= 168);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
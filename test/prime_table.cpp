@@ -0,0 +1,117 @@
+///
+/// @file   prime_table.cpp
+/// @brief  Test prime_table's is_prime(), pi(x) and nth_prime()
+///         and the process-wide table built by load_prime_table().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void testTable(uint64_t limit)
+{
+  vector<uint64_t> primes;
+  generate_primes(limit, &primes);
+  prime_table table(limit);
+
+  cout << "prime_table(" << limit << ").size() = " << table.size();
+  check(table.size() == primes.size());
+
+  bool OK = true;
+  for (uint64_t n = 0; n <= min(limit, (uint64_t) 100000); n++)
+  {
+    auto iter = upper_bound(primes.begin(), primes.end(), n);
+    OK = OK && (table.pi(n) == (uint64_t) (iter - primes.begin()));
+    OK = OK && (table.is_prime(n) == binary_search(primes.begin(), primes.end(), n));
+  }
+  for (int i = 0; i < 10000; i++)
+  {
+    uint64_t n = rand() % (limit + 1);
+    auto iter = upper_bound(primes.begin(), primes.end(), n);
+    OK = OK && (table.pi(n) == (uint64_t) (iter - primes.begin()));
+    OK = OK && (table.is_prime(n) == binary_search(primes.begin(), primes.end(), n));
+  }
+  cout << "prime_table is_prime() & pi()";
+  check(OK);
+
+  for (size_t i = 0; i < primes.size(); i += 1 + rand() % 100)
+    OK = OK && (table.nth_prime(i + 1) == primes[i]);
+  if (!primes.empty())
+    OK = OK && (table.nth_prime(primes.size()) == primes.back());
+  cout << "prime_table nth_prime()";
+  check(OK);
+}
+
+int main()
+{
+  for (uint64_t limit = 0; limit <= 100; limit++)
+    testTable(limit);
+
+  testTable(1000003);
+  testTable(30000000);
+
+  // results without the process-wide table
+  uint64_t start = (uint64_t) 1e15;
+  uint64_t stop = start + (uint64_t) 1e8;
+  uint64_t count1 = count_primes(start, stop);
+  uint64_t count2 = count_primes(12345, 20000000);
+  uint64_t nth = nth_prime(1000000, start);
+
+  load_prime_table(40000000);
+
+  cout << "count_primes(10^15, 10^15 + 10^8) = " << count_primes(start, stop);
+  check(count_primes(start, stop) == count1);
+
+  cout << "count_primes(12345, 2 * 10^7) = " << count_primes(12345, 20000000);
+  check(count_primes(12345, 20000000) == count2);
+
+  cout << "nth_prime(10^6, 10^15) = " << nth_prime(1000000, start);
+  check(nth_prime(1000000, start) == nth);
+
+  primesieve::iterator it(start);
+  uint64_t prime = it.next_prime();
+  for (int i = 0; i < 100000; i++)
+    prime = it.next_prime();
+  cout << "iterator 10^5th prime > 10^15 = " << prime;
+  check(prime == nth_prime(100001, start));
+
+  cout << "is_prime(39999983) = " << is_prime(39999983);
+  check(is_prime(39999983) && !is_prime(39999981));
+
+  unload_prime_table();
+
+  cout << "prime_table(100).nth_prime(26) = ";
+  try
+  {
+    prime_table(100).nth_prime(26);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
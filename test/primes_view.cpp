@@ -0,0 +1,88 @@
+///
+/// @file   primes_view.cpp
+/// @brief  Test primes_view in range-based for loops and
+///         (if supported) in C++20 range pipelines.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#if defined(__cpp_lib_ranges)
+  #include <ranges>
+#endif
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+  vector<uint64_t> res;
+
+  for (uint64_t prime : primes_view(start, stop))
+    res.push_back(prime);
+
+  cout << "primes_view(" << start << ", " << stop << ") = " << res.size();
+  check(res == primes);
+}
+
+int main()
+{
+  test(0, 100);
+  test(2, 2);
+  test(24, 28);
+  test(100, 50);
+  test(1000000, 20000000);
+  test(18446744073709551615ull - 100000, 18446744073709551615ull);
+
+  // continue a partially consumed view
+  primes_view view(0, 1000);
+  auto it = view.begin();
+  for (int i = 0; i < 10; i++)
+    ++it;
+  cout << "11th prime = " << *view.begin();
+  check(*view.begin() == 31);
+
+#if defined(__cpp_lib_ranges)
+  static_assert(std::ranges::input_range<primes_view>, "primes_view must be an input range");
+
+  vector<uint64_t> primes1mod4;
+  for (uint64_t p : primes_view(0, 1000000) |
+                    std::views::filter([](uint64_t p) { return p % 4 == 1; }) |
+                    std::views::take(5))
+    primes1mod4.push_back(p);
+
+  cout << "primes_view | filter | take";
+  check(primes1mod4 == vector<uint64_t>{ 5, 13, 17, 29, 37 });
+#endif
+
+#if defined(__cpp_lib_generator)
+  uint64_t sum = 0;
+  for (uint64_t p : primes_generator(0, 100))
+    sum += p;
+  cout << "primes_generator(0, 100) sum = " << sum;
+  check(sum == 1060);
+#endif
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
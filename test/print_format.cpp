@@ -0,0 +1,131 @@
+///
+/// @file   print_format.cpp
+/// @brief  Print primes using the binary print formats
+///         (u32, u64, delta8, varint), decode the output
+///         and compare with primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/PrintFormat.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+string print(uint64_t start, uint64_t stop, int format)
+{
+  ostringstream out;
+  auto buf = cout.rdbuf(out.rdbuf());
+  PrimeSieve ps;
+  ps.setPrintFormat(format);
+  ps.sieve(start, stop, PRINT_PRIMES);
+  cout.rdbuf(buf);
+  return out.str();
+}
+
+uint64_t readLittleEndian(const string& str, size_t& i, int bytes)
+{
+  uint64_t n = 0;
+  for (int j = 0; j < bytes; j++)
+    n |= (uint64_t) (unsigned char) str[i++] << (j * 8);
+  return n;
+}
+
+vector<uint64_t> decode(const string& str, int format)
+{
+  vector<uint64_t> primes;
+  uint64_t prime = 0;
+  size_t i = 0;
+
+  while (i < str.size())
+  {
+    switch (format)
+    {
+      case FORMAT_U32: prime = readLittleEndian(str, i, 4); break;
+      case FORMAT_U64: prime = readLittleEndian(str, i, 8); break;
+      case FORMAT_DELTA8:
+      {
+        if (primes.empty())
+          prime = readLittleEndian(str, i, 8);
+        else
+        {
+          uint64_t half = (unsigned char) str[i++];
+          prime += half ? half * 2 : 1;
+        }
+        break;
+      }
+      case FORMAT_VARINT:
+      {
+        uint64_t gap = 0;
+        for (int shift = 0; ; shift += 7)
+        {
+          uint64_t byte = (unsigned char) str[i++];
+          gap |= (byte & 0x7f) << shift;
+          if (byte < 0x80)
+            break;
+        }
+        prime += gap;
+        break;
+      }
+    }
+
+    primes.push_back(prime);
+  }
+
+  return primes;
+}
+
+int main()
+{
+  uint64_t ranges[][2] =
+  {
+    { 0, 1000000 },
+    { 3, 100 },
+    { 5, 5 },
+    { 4000000000ull, 4010000000ull },
+    { 1000000000000ull, 1000001000000ull }
+  };
+
+  const string names[] = { "text", "u32", "u64", "delta8", "varint" };
+
+  for (auto& r : ranges)
+  {
+    vector<uint64_t> primes;
+    generate_primes(r[0], r[1], &primes);
+
+    for (int format = FORMAT_U32; format <= FORMAT_VARINT; format++)
+    {
+      if (format == FORMAT_U32 && r[1] > 0xffffffff)
+        continue;
+
+      string output = print(r[0], r[1], format);
+      cout << "print --format=" << names[format] << " [" << r[0] << ", " << r[1] << "], "
+           << output.size() << " bytes";
+      check(decode(output, format) == primes);
+    }
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
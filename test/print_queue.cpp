@@ -0,0 +1,101 @@
+///
+/// @file   print_queue.cpp
+/// @brief  Print primes and prime k-tuplets using multiple
+///         threads and PrintQueue, the output must be
+///         identical to the output of a single thread.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/PrintQueue.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// Redirect stdout into a string
+string capture(uint64_t start, uint64_t stop, int flags, int threads, uint64_t chunkDist)
+{
+  ostringstream out;
+  auto buf = cout.rdbuf(out.rdbuf());
+  PrimeSieve parent;
+  parent.setFlags(flags);
+
+  if (threads == 1)
+    parent.sieve(start, stop);
+  else
+  {
+    PrintQueue printQueue(start, stop, chunkDist, threads);
+    vector<thread> pool;
+
+    for (int t = 0; t < threads; t++)
+    {
+      pool.emplace_back([&]()
+      {
+        PrimeSieve ps(&parent);
+        uint64_t chunk, low, high;
+        while (printQueue.next(&chunk, &low, &high))
+        {
+          ps.setPrintQueue(&printQueue, chunk);
+          ps.sieve(low, high);
+          printQueue.finish(chunk);
+        }
+      });
+    }
+
+    for (auto& t : pool)
+      t.join();
+  }
+
+  cout.rdbuf(buf);
+  return out.str();
+}
+
+int main()
+{
+  uint64_t ranges[][2] =
+  {
+    { 0, 3000000 },
+    { 1000000000000ull, 1000001000000ull }
+  };
+
+  for (auto& r : ranges)
+  {
+    for (int i = 0; i < 6; i++)
+    {
+      int flags = PRINT_PRIMES << i;
+      string expected = capture(r[0], r[1], flags, 1, 0);
+
+      for (int threads : { 2, 4, 7 })
+      {
+        string output = capture(r[0], r[1], flags, threads, 100000);
+        cout << "print " << (i + 1) << "-tuplets [" << r[0] << ", " << r[1] << "] threads = " << threads
+             << ", " << output.size() << " bytes";
+        check(output == expected);
+      }
+    }
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+///
+/// @file   segment_cache.cpp
+/// @brief  Count and generate primes of the same ranges
+///         repeatedly using the LRU cache of sieved segments.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  // a single thread sieves the same
+  // segments in each iteration
+  set_num_threads(1);
+  set_sieve_size(32);
+
+  uint64_t start = (uint64_t) 1e12 + 11;
+  uint64_t stop = start + (uint64_t) 1e8;
+  uint64_t count = count_primes(start, stop);
+  vector<uint64_t> primes;
+  generate_primes(start, start + (uint64_t) 1e7, &primes);
+
+  set_segment_cache_size(64 << 20);
+
+  for (int i = 0; i < 3; i++)
+  {
+    cout << "count_primes(10^12 + 11, 10^12 + 10^8 + 11) = " << count_primes(start, stop);
+    check(count_primes(start, stop) == count);
+  }
+
+  cout << "segment cache hits > 0";
+  check(get_segment_cache_stats().hits > 0);
+
+  for (int i = 0; i < 3; i++)
+  {
+    primesieve::iterator it(start - 1);
+    bool OK = true;
+    for (uint64_t p : primes)
+      OK = OK && (it.next_prime() == p);
+    cout << "iterator with segment cache";
+    check(OK);
+  }
+
+  // the cache is smaller than the range,
+  // segments are evicted
+  set_segment_cache_size(1 << 16);
+
+  for (int i = 0; i < 3; i++)
+  {
+    cout << "count_primes() with small segment cache = " << count_primes(start - 5, stop);
+    check(count_primes(start - 5, stop) == count);
+  }
+
+  uint64_t misses = get_segment_cache_stats().misses;
+  set_segment_cache_size(0);
+  count_primes(start, stop);
+  cout << "disabled segment cache";
+  check(get_segment_cache_stats().misses == misses);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
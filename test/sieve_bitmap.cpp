@@ -0,0 +1,84 @@
+///
+/// @file   sieve_bitmap.cpp
+/// @brief  Decode the bitmaps of sieve_bitmap() and compare
+///         the primes with generate_primes().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+vector<uint64_t> decode(uint64_t start, uint64_t stop)
+{
+  const uint64_t offsets[8] = { 7, 11, 13, 17, 19, 23, 29, 31 };
+  vector<uint64_t> primes;
+  uint64_t prevLow = 0;
+  bool increasing = true;
+
+  sieve_bitmap(start, stop, [&](uint64_t low, const uint8_t* sieve, size_t size)
+  {
+    increasing = increasing && low >= prevLow && low % 30 == 0;
+    prevLow = low;
+    for (size_t i = 0; i < size; i++)
+      for (int j = 0; j < 8; j++)
+        if (sieve[i] & (1 << j))
+          primes.push_back(low + i * 30 + offsets[j]);
+  });
+
+  if (!increasing)
+    primes.clear();
+
+  return primes;
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  generate_primes(max<uint64_t>(start, 7), stop, &primes);
+
+  cout << "sieve_bitmap(" << start << ", " << stop << ") = " << primes.size();
+  check(decode(start, stop) == primes);
+}
+
+int main()
+{
+  test(0, 100);
+  test(7, 7);
+  test(8, 10);
+  test(1000, 1000000);
+  test(1000000007, 1000000007 + 12345);
+  test(10000000000ull, 10000000000ull + 30000000);
+  test(18446744073709551615ull - 1000000, 18446744073709551615ull);
+
+  for (int i = 0; i < 20; i++)
+  {
+    uint64_t start = rand() % 10000000;
+    uint64_t stop = start + rand() % 10000000;
+    test(start, stop);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,84 @@
+///
+/// @file   sieve_counters.cpp
+/// @brief  Test the hot path counters, if primesieve has been
+///         built without counters (default) they must be 0.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+uint64_t sum(const sieve_counters& c)
+{
+  uint64_t s = c.segments + c.segments_consumed;
+  for (int i = 0; i < 3; i++)
+    s += c.sieving_primes[i] + c.bits_unset[i];
+  for (int i = 0; i < 2; i++)
+    s += c.buckets_pushed[i] + c.buckets_allocated[i] + c.buckets_recycled[i];
+  return s;
+}
+
+int main()
+{
+  cout << "has_sieve_counters() = " << has_sieve_counters() << endl;
+
+  reset_sieve_counters();
+  count_primes(1000000000000000ull, 1000000000000000ull + 100000000);
+  sieve_counters c = get_sieve_counters();
+
+  if (!has_sieve_counters())
+  {
+    cout << "counters = " << sum(c);
+    check(sum(c) == 0);
+  }
+  else
+  {
+    cout << "segments = " << c.segments;
+    check(c.segments > 0 && c.segments >= c.segments_consumed);
+    cout << "segments_consumed = " << c.segments_consumed;
+    check(c.segments_consumed > 0);
+
+    for (int i = 0; i < 3; i++)
+    {
+      cout << "sieving_primes[" << i << "] = " << c.sieving_primes[i];
+      check(c.sieving_primes[i] > 0);
+      cout << "bits_unset[" << i << "] = " << c.bits_unset[i];
+      check(c.bits_unset[i] > 0);
+    }
+
+    for (int i = 0; i < 2; i++)
+    {
+      cout << "buckets_pushed[" << i << "] = " << c.buckets_pushed[i];
+      check(c.buckets_pushed[i] > 0 &&
+            c.buckets_pushed[i] >= c.buckets_recycled[i]);
+      cout << "buckets_allocated[" << i << "] = " << c.buckets_allocated[i];
+      check(c.buckets_allocated[i] > 0);
+    }
+  }
+
+  reset_sieve_counters();
+  cout << "reset_sieve_counters() = " << sum(get_sieve_counters());
+  check(sum(get_sieve_counters()) == 0);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,210 @@
+///
+/// @file   sieve_sequence.cpp
+/// @brief  Sieve arithmetic progressions, k * 2^n +- 1 and
+///         k^2 + 1 using sieve_sequence() and compare the
+///         survivors against the primes and trial division.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/sequence_sieve.hpp>
+
+#include <stdint.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+uint64_t isqrt64(uint64_t n)
+{
+  uint64_t r = (uint64_t) sqrt((double) n);
+  while (r * r > n) r--;
+  while ((r + 1) * (r + 1) <= n) r++;
+  return r;
+}
+
+uint64_t popcount(const uint64_t* bits, size_t size)
+{
+  uint64_t count = 0;
+  for (size_t i = 0; i < size; i++)
+    if ((bits[i / 64] >> (i % 64)) & 1)
+      count++;
+  return count;
+}
+
+/// Count the survivors, also checks that the
+/// segments are contiguous and cover [start, stop]
+///
+uint64_t countSurvivors(uint64_t start, uint64_t stop, uint64_t maxPrime, const roots_callback& roots)
+{
+  uint64_t count = 0;
+  uint64_t next = start;
+  bool OK = true;
+
+  sieve_sequence(start, stop, maxPrime, roots, [&](uint64_t low, const uint64_t* bits, size_t size)
+  {
+    OK = OK && low == next && size > 0;
+    next = low + size;
+    count += popcount(bits, size);
+  });
+
+  if (!OK || next - 1 != stop)
+    return ~0ull;
+
+  return count;
+}
+
+/// Count the primes = a (mod d) inside [start, stop]
+uint64_t countPrimes(uint64_t start, uint64_t stop, uint64_t a, uint64_t d)
+{
+  uint64_t count = 0;
+  primesieve::iterator it(start - 1, stop);
+  for (uint64_t p = it.next_prime(); p <= stop; p = it.next_prime())
+    count += (p % d == a % d);
+  return count;
+}
+
+int main()
+{
+  // k itself, the survivors > sqrt(stop) are the primes.
+  // Sieving primes > segment size use the buckets.
+  {
+    uint64_t start = (uint64_t) 1e13;
+    uint64_t stop = start + (uint64_t) 1e7;
+    uint64_t maxPrime = isqrt64(stop);
+    uint64_t count = countSurvivors(start, stop, maxPrime, progression_roots(0, 1));
+    cout << "sieve_sequence(k, " << start << ", " << stop << ") = " << count;
+    check(count == count_primes(start, stop));
+  }
+
+  // 10 * k + 3
+  {
+    uint64_t start = (uint64_t) 1e11;
+    uint64_t stop = start + (uint64_t) 5e6;
+    uint64_t maxPrime = isqrt64(10 * stop + 3);
+    uint64_t count = countSurvivors(start, stop, maxPrime, progression_roots(3, 10));
+    cout << "sieve_sequence(10 * k + 3, " << start << ", " << stop << ") = " << count;
+    check(count == countPrimes(10 * start + 3, 10 * stop + 3, 3, 10));
+  }
+
+  // Proth and Riesel candidates k * 2^3 +- 1
+  for (int64_t c : { 1, -1 })
+  {
+    uint64_t start = (uint64_t) 1e11;
+    uint64_t stop = start + (uint64_t) 3e6;
+    uint64_t maxPrime = isqrt64(8 * stop + 1);
+    uint64_t count = countSurvivors(start, stop, maxPrime, power_roots(2, 3, c));
+    cout << "sieve_sequence(k * 2^3 " << (c > 0 ? "+" : "-") << " 1, " << start << ", " << stop << ") = " << count;
+    check(count == countPrimes(8 * start + c, 8 * stop + c, 8 + c, 8));
+  }
+
+  // k * 2^1000 + 1, compare against the roots of each
+  // prime found by trial and error
+  {
+    uint64_t start = 1;
+    uint64_t stop = 100000;
+    uint64_t maxPrime = 1000;
+    vector<char> divisible(stop + 1, false);
+    primesieve::iterator it;
+
+    for (uint64_t p = it.next_prime(); p <= maxPrime; p = it.next_prime())
+    {
+      uint64_t pow2 = 1;
+      for (int i = 0; i < 1000; i++)
+        pow2 = (pow2 * 2) % p;
+      for (uint64_t k = start; k <= stop; k++)
+        if ((k % p * pow2 + 1) % p == 0)
+          divisible[k] = true;
+    }
+
+    uint64_t expected = 0;
+    for (uint64_t k = start; k <= stop; k++)
+      expected += !divisible[k];
+
+    uint64_t count = countSurvivors(start, stop, maxPrime, power_roots(2, 1000, 1));
+    cout << "sieve_sequence(k * 2^1000 + 1, " << start << ", " << stop << ") = " << count;
+    check(count == expected);
+  }
+
+  // k^2 + 1 has 2 roots mod p if p = 1 (mod 4)
+  {
+    uint64_t start = 1000;
+    uint64_t stop = 2500000;
+    uint64_t maxPrime = 1000;
+
+    auto roots = [](uint64_t p, vector<uint64_t>& r)
+    {
+      for (uint64_t k = 0; k < p; k++)
+        if ((k * k + 1) % p == 0)
+          r.push_back(k);
+    };
+
+    vector<uint64_t> primes;
+    generate_primes(maxPrime, &primes);
+    uint64_t expected = 0;
+
+    for (uint64_t k = start; k <= stop; k++)
+    {
+      uint64_t n = k * k + 1;
+      bool survivor = true;
+      for (uint64_t p : primes)
+        if (n % p == 0)
+          survivor = false;
+      expected += survivor;
+    }
+
+    uint64_t count = countSurvivors(start, stop, maxPrime, roots);
+    cout << "sieve_sequence(k^2 + 1, " << start << ", " << stop << ") = " << count;
+    check(count == expected);
+  }
+
+  // every candidate divisible by 2
+  {
+    bool error = false;
+    try
+    {
+      sieve_sequence(0, 1000, 100, progression_roots(2, 4), [](uint64_t, const uint64_t*, size_t) { });
+    }
+    catch (primesieve_error&)
+    {
+      error = true;
+    }
+    cout << "sieve_sequence(4 * k + 2) throws";
+    check(error);
+  }
+
+  // max_prime >= 2^32
+  {
+    bool error = false;
+    try
+    {
+      sieve_sequence(0, 1000, 1ull << 32, progression_roots(1, 2), [](uint64_t, const uint64_t*, size_t) { });
+    }
+    catch (primesieve_error&)
+    {
+      error = true;
+    }
+    cout << "sieve_sequence(max_prime = 2^32) throws";
+    check(error);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
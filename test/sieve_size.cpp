@@ -0,0 +1,74 @@
+///
+/// @file   sieve_size.cpp
+/// @brief  Count the primes using sieve sizes that are not a
+///         power of 2 and sieve sizes up to 8 MiB, the sieving
+///         primes are processed by EratSmall, EratMedium and
+///         EratBig (including its two-level bucket hierarchy).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <initializer_list>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  uint64_t start = (uint64_t) 1e16;
+  uint64_t stop = start + (uint64_t) 3e8;
+  int sizes[] = { 8, 13, 100, 768, 1000, 3000, 4096, 5000, 7777, 8192 };
+
+  set_num_threads(1);
+  set_sieve_size(32);
+  uint64_t count = count_primes(start, stop);
+
+  for (int size : sizes)
+  {
+    set_sieve_size(size);
+    cout << "get_sieve_size() = " << get_sieve_size();
+    check(get_sieve_size() == size);
+    uint64_t res = count_primes(start, stop);
+    cout << "count_primes(1e16, 1e16+3e8) = " << res;
+    check(res == count);
+  }
+
+  // small sieve sizes and huge numbers use
+  // EratBig's two-level bucket hierarchy
+  start = (uint64_t) 1e18;
+  stop = start + (uint64_t) 1e7;
+  set_sieve_size(1024);
+  count = count_primes(start, stop);
+
+  for (int size : { 8, 24 })
+  {
+    set_sieve_size(size);
+    uint64_t res = count_primes(start, stop);
+    cout << "count_primes(1e18, 1e18+1e7) = " << res;
+    check(res == count);
+  }
+
+  set_sieve_size(100000);
+  cout << "get_sieve_size() = " << get_sieve_size();
+  check(get_sieve_size() == 8192);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+///
+/// @file   sieve_size_threads.cpp
+/// @brief  The default sieve size is the share of the CPU
+///         caches each thread has, it must not grow with
+///         the number of threads.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/Affinity.hpp>
+#include <primesieve/CpuInfo.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/Tuning.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  int maxThreads = ParallelSieve::getMaxThreads();
+  int prev = cpuInfo.sieveSize(1);
+
+  for (int threads = 1; threads <= maxThreads * 2; threads++)
+  {
+    int size = cpuInfo.sieveSize(threads);
+    cout << "cpuInfo.sieveSize(" << threads << ") = " << size;
+    check(size >= 8 && size <= prev);
+    prev = size;
+
+    for (int level = 1; level <= 3; level++)
+    {
+      size_t sharing = cpuInfo.threadsSharing(level, threads);
+      size_t max = cpuInfo.hasCpuThreads() ? cpuInfo.cpuThreads() : 1;
+      cout << "cpuInfo.threadsSharing(" << level << ", " << threads << ") = " << sharing;
+      check(sharing >= 1 && sharing <= max);
+    }
+  }
+
+  // a single thread has the caches to itself
+  for (int level = 1; level <= 3; level++)
+  {
+    cout << "cpuInfo.threadsSharing(" << level << ", 1) = " << cpuInfo.threadsSharing(level, 1);
+    check(cpuInfo.threadsSharing(level, 1) == 1);
+  }
+
+  set_num_threads(1);
+  cout << "get_sieve_size(), 1 thread = " << get_sieve_size();
+  check(get_sieve_size() == cpuInfo.sieveSize(1));
+
+  set_num_threads(maxThreads);
+  cout << "get_sieve_size(), " << maxThreads << " threads = " << get_sieve_size();
+  check(get_sieve_size() == cpuInfo.sieveSize(maxThreads));
+
+  setTuning(Tuning());
+  uint64_t stop = 1000000000000ull;
+  cout << "tunedSieveSize(0, 1e12, " << maxThreads << " threads)";
+  check(tunedSieveSize(0, stop, maxThreads) <= tunedSieveSize(0, stop, 1));
+
+  // each allowed CPU exactly once
+  vector<int> order = getCpuOrder();
+  vector<int> allowed = getAllowedCpus();
+  sort(order.begin(), order.end());
+  cout << "getCpuOrder() = " << order.size() << " CPUs";
+  check(order == allowed);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,87 @@
+///
+/// @file   sieve_stats.cpp
+/// @brief  Test the time spent in each sieving phase
+///         reported by ParallelSieve (--stats).
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/SieveStats.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t stop, int threads, bool eratBig)
+{
+  ParallelSieve ps;
+  SieveStats stats;
+  ps.setNumThreads(threads);
+  ps.setSieveStats(&stats);
+  ps.sieve(start, stop, COUNT_PRIMES);
+
+  double phases = 0;
+  bool positive = true;
+  for (double s : stats.seconds)
+  {
+    phases += s;
+    positive = positive && s >= 0;
+  }
+
+  double eps = 1e-3;
+  cout << "stats(" << start << ", " << stop << ", threads = " << threads << ") = " << phases << " s";
+  check(positive &&
+        ps.getCount(0) == count_primes(start, stop) &&
+        stats.threads == ps.idealNumThreads() &&
+        stats.seconds[PHASE_ERAT_SMALL] > 0 &&
+        (stats.seconds[PHASE_ERAT_BIG] > 0) == eratBig &&
+        phases <= stats.busy + eps &&
+        stats.busy + stats.idle <= ps.getSeconds() * stats.threads + eps);
+}
+
+int main()
+{
+  test(0, 100000000, 1, false);
+  test(0, 1000000000, 3, false);
+  test(1000000000000000ull, 1000000000000000ull + 100000000, 2, true);
+
+  // hardware events, if perf_event is supported
+  HwCounters counters;
+  bool available = readHwCounters(counters);
+  ParallelSieve hw;
+  SieveStats hwStats;
+  hwStats.hw = true;
+  hw.setSieveStats(&hwStats);
+  hw.sieve(0, 100000000, COUNT_PRIMES);
+  uint64_t cycles = hwStats.events[PHASE_ERAT_SMALL][HW_CYCLES];
+  cout << "stats.hw = " << available << ", EratSmall cycles = " << cycles;
+  check(hwStats.hw &&
+        hwStats.seconds[PHASE_ERAT_SMALL] > 0 &&
+        (cycles > 0) == available);
+
+  // stats are disabled by default
+  ParallelSieve ps;
+  ps.sieve(0, 1000000);
+  cout << "getSieveStats() = " << ps.getSieveStats();
+  check(ps.getSieveStats() == nullptr);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
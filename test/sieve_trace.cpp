@@ -0,0 +1,106 @@
+///
+/// @file   sieve_trace.cpp
+/// @brief  Test the ParallelSieve timeline (--trace), each
+///         sieve() call is split into setup and sieving.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/SieveTrace.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void test(uint64_t start, uint64_t stop, int threads)
+{
+  ParallelSieve ps;
+  SieveTrace trace;
+  ps.setNumThreads(threads);
+  ps.setTrace(&trace);
+  ps.sieve(start, stop, COUNT_PRIMES);
+  double end = trace.now();
+
+  auto events = trace.getEvents();
+  int setup = 0;
+  int sieve = 0;
+  bool OK = true;
+
+  for (size_t i = 0; i < events.size(); i++)
+  {
+    auto& e = events[i];
+    OK = OK && e.start >= 0 && e.start <= e.end && e.end <= end;
+    OK = OK && e.thread >= -1 && e.thread < ps.idealNumThreads();
+
+    if (!strcmp(e.name, "setup"))
+    {
+      // the next event of the thread is
+      // the sieving of the same interval
+      setup++;
+      size_t j = i + 1;
+      while (j < events.size() && events[j].thread != e.thread)
+        j++;
+      OK = OK && j < events.size() &&
+           !strcmp(events[j].name, "sieve") &&
+           events[j].start == e.end;
+    }
+    if (!strcmp(e.name, "sieve"))
+    {
+      sieve++;
+      OK = OK && e.low >= start && e.high <= stop;
+    }
+  }
+
+  cout << "trace(" << start << ", " << stop << ", threads = " << threads << ") = " << events.size() << " events";
+  check(OK && sieve > 0 && setup == sieve);
+}
+
+int main()
+{
+  test(0, 1000000, 1);
+  test(0, 1000000000, 4);
+  test(1000000000000ull, 1000000000000ull + 300000000, 8);
+
+  string filename = "sieve_trace.json";
+  ParallelSieve ps;
+  SieveTrace trace;
+  ps.setTrace(&trace);
+  ps.sieve(0, 100000000);
+  trace.write(filename);
+
+  ifstream file(filename);
+  string json((istreambuf_iterator<char>(file)), istreambuf_iterator<char>());
+  file.close();
+  remove(filename.c_str());
+
+  cout << "trace.write() = " << json.size() << " bytes";
+  check(json.find("{\"displayTimeUnit\": \"ms\", \"traceEvents\": [") == 0 &&
+        json.find("\"name\": \"setup\", \"ph\": \"X\"") != string::npos &&
+        json.find("\"thread_name\"") != string::npos &&
+        json.substr(json.size() - 3) == "]}\n");
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
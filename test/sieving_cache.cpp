@@ -0,0 +1,82 @@
+///
+/// @file   sieving_cache.cpp
+/// @brief  Test reading the sieving primes from a sieving
+///         cache file written by write_sieving_cache().
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+
+#include <stdint.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  string filename = "sieving_cache_test.bin";
+  uint64_t start = (uint64_t) 1e12;
+  uint64_t stop = start + (uint64_t) 1e8;
+
+  // results without sieving cache
+  uint64_t count = count_primes(start, stop);
+  vector<uint64_t> primes;
+  generate_n_primes(1000, start, &primes);
+
+  write_sieving_cache(filename, 2000000);
+  load_sieving_cache(filename);
+
+  cout << "count_primes(10^12, 10^12 + 10^8) = " << count_primes(start, stop);
+  check(count_primes(start, stop) == count);
+
+  primesieve::iterator it(start);
+  bool OK = true;
+  for (uint64_t p : primes)
+    OK = OK && (it.next_prime() == p);
+  cout << "iterator with sieving cache";
+  check(OK);
+
+  // the cache is too small for 10^13,
+  // the sieving primes are sieved
+  cout << "count_primes(10^13, 10^13 + 10^6) = " << count_primes((uint64_t) 1e13, (uint64_t) 1e13 + (uint64_t) 1e6);
+  check(count_primes((uint64_t) 1e13, (uint64_t) 1e13 + (uint64_t) 1e6) == 33456);
+
+  unload_sieving_cache();
+
+  cout << "load invalid sieving cache";
+  try
+  {
+    FILE* file = fopen(filename.c_str(), "wb");
+    fputs("not a sieving cache", file);
+    fclose(file);
+    load_sieving_cache(filename);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  remove(filename.c_str());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
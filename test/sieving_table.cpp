@@ -0,0 +1,54 @@
+///
+/// @file   sieving_table.cpp
+/// @brief  Test the SievingTable shared by the threads
+///         of ParallelSieve.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/SievingTable.hpp>
+#include <primesieve/types.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  uint64_t stops[] = { 0, 7, 37, 1000, 123456, 12345678, 1ull << 32 };
+
+  for (uint64_t stop : stops)
+  {
+    for (int threads = 1; threads <= 4; threads++)
+    {
+      SievingTable table(stop, threads, 32);
+      uint64_t count = popcount((const uint64_t*) table.data(), table.size() / 8);
+      uint64_t primes = 0;
+      if (stop >= 7)
+        primes = count_primes(7, stop);
+
+      cout << "SievingTable(" << stop << ", " << threads << ") primes = " << count;
+      check(count == primes &&
+            table.size() % 8 == 0);
+    }
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,94 @@
+///
+/// @file   small_prime_table.cpp
+/// @brief  count_primes() and generate_primes() with stop <=
+///         config::SMALL_PRIME_TABLE are answered from the
+///         small_prime_table(), compare with primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/prime_table.hpp>
+
+#include <stdint.h>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+vector<uint64_t> iterate(uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> primes;
+  primesieve::iterator it(start > 0 ? start - 1 : 0);
+  for (uint64_t prime = it.next_prime(); prime <= stop; prime = it.next_prime())
+    if (prime >= start)
+      primes.push_back(prime);
+  return primes;
+}
+
+void test(uint64_t start, uint64_t stop)
+{
+  vector<uint64_t> expected = iterate(start, stop);
+  cout << "count_primes(" << start << ", " << stop << ") = " << expected.size();
+  check(count_primes(start, stop) == expected.size());
+
+  vector<uint64_t> primes;
+  generate_primes(start, stop, &primes);
+  cout << "generate_primes(" << start << ", " << stop << ") = " << primes.size();
+  check(primes == expected);
+
+  vector<uint32_t> primes32;
+  generate_primes(start, stop, &primes32);
+  cout << "generate_primes<uint32_t>(" << start << ", " << stop << ") = " << primes32.size();
+  check(vector<uint64_t>(primes32.begin(), primes32.end()) == expected);
+}
+
+int main()
+{
+  uint64_t limit = config::SMALL_PRIME_TABLE;
+
+  for (uint64_t start = 0; start <= 12; start++)
+    for (uint64_t stop = start; stop <= 40; stop += 3)
+      test(start, stop);
+
+  test(0, 1000);
+  test(239, 241);
+  test(240, 240 + 30 * 8 * 3 + 1);
+  test(1000000, 1000000 + 1000);
+  test(0, limit);
+  test(limit - 1000, limit);
+  test(limit - 1000, limit + 1000);
+
+  // decode in pieces of 7 primes
+  const prime_table& table = small_prime_table();
+  vector<uint64_t> expected = iterate(3, 100000);
+  vector<uint64_t> primes;
+  uint64_t start = 3;
+  uint64_t buffer[7];
+  size_t n;
+  while ((n = table.fill_primes(&start, 100000, buffer, 7)) > 0)
+    primes.insert(primes.end(), buffer, buffer + n);
+  cout << "fill_primes(3, 100000), 7 primes per call = " << primes.size();
+  check(primes == expected && start == 100001);
+
+  cout << "count_primes(2, 1) = 0";
+  check(count_primes(2, 1) == 0);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+///
+/// @file   status_callback.cpp
+/// @brief  Run ParallelSieve like the primesieve GUI: the
+///         printed primes are written to a custom stream and
+///         the status is sent to a callback.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve/cancel_token.hpp>
+#include <primesieve/ParallelSieve.hpp>
+#include <primesieve/primesieve_error.hpp>
+
+#include <stdint.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  for (int threads = 1; threads <= 4; threads *= 2)
+  {
+    ostringstream out;
+    atomic<int> calls(0);
+    atomic<bool> increasing(true);
+    double last = -1;
+
+    ParallelSieve ps;
+    ps.setFlags(PRINT_PRIMES | COUNT_PRIMES | CALCULATE_STATUS);
+    ps.setNumThreads(threads);
+    ps.setOutput(&out);
+    ps.setStatusCallback([&](double percent)
+    {
+      if (percent < last)
+        increasing = false;
+      last = percent;
+      calls++;
+    });
+
+    ps.sieve(0, 10000000);
+    string str = out.str();
+    uint64_t lines = 0;
+    for (char c : str)
+      lines += (c == '\n');
+
+    cout << "threads = " << threads << ", printed primes = " << lines;
+    check(lines == 664579 && lines == ps.getCount(0));
+    cout << "threads = " << threads << ", last line = " << str.substr(str.size() - 8, 7);
+    check(str.compare(str.size() - 8, 8, "9999991\n") == 0);
+    cout << "threads = " << threads << ", status callback = " << last << "%";
+    check(calls > 0 && increasing && last == 100);
+  }
+
+  // status callback and cancellation
+  {
+    ostringstream out;
+    cancel_token token;
+    ParallelSieve ps;
+    ps.setFlags(PRINT_PRIMES | CALCULATE_STATUS);
+    ps.setNumThreads(2);
+    ps.setOutput(&out);
+    ps.setCancelToken(&token);
+    ps.setStatusCallback([&](double) { token.cancel(); });
+    bool cancelled = false;
+
+    try
+    {
+      ps.sieve(0, (uint64_t) 1e12);
+    }
+    catch (primesieve_cancelled&)
+    {
+      cancelled = true;
+    }
+
+    cout << "Cancel from the status callback";
+    check(cancelled);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,99 @@
+///
+/// @file   sum_primes.cpp
+/// @brief  Test sum_primes() and sum_prime_squares() against
+///         summing up the primes using primesieve::iterator.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/PrimeSums.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+#include <string>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+void sumSlow(uint64_t start, uint64_t stop, uint128& sum, uint128& squares)
+{
+  sum = 0;
+  squares = 0;
+  primesieve::iterator it(start > 0 ? start - 1 : 0, stop);
+
+  for (uint64_t p = it.next_prime(); p <= stop; p = it.next_prime())
+  {
+    add128(sum, p);
+    add128(squares, mul128(p, p));
+  }
+}
+
+int main()
+{
+  cout << "to_string(0) = " << to_string(uint128(0));
+  check(to_string(uint128(0)) == "0");
+
+  cout << "to_string(2^64) = " << to_string(uint128(1, 0));
+  check(to_string(uint128(1, 0)) == "18446744073709551616");
+
+  cout << "to_string(2^128 - 1) = " << to_string(uint128(~0ull, ~0ull));
+  check(to_string(uint128(~0ull, ~0ull)) == "340282366920938463463374607431768211455");
+
+  // sum of the primes below 10^9
+  cout << "sum_primes(1e9) = " << to_string(sum_primes(0, 1000000000));
+  check(to_string(sum_primes(0, 1000000000)) == "24739512092254535");
+
+
+  uint64_t ranges[][2] =
+  {
+    { 0, 10000000 },
+    { 0, 5 },
+    { 3, 7 },
+    { 1000000007, 1000000007 },
+    { 1000000000000ull, 1000003000000ull },
+    // sum > 2^64
+    { 1000000000000000ull, 1000000001000000ull }
+  };
+
+  for (auto& r : ranges)
+  {
+    uint128 sum, squares;
+    sumSlow(r[0], r[1], sum, squares);
+
+    uint128 res = sum_primes(r[0], r[1]);
+    cout << "sum_primes(" << r[0] << ", " << r[1] << ") = " << to_string(res);
+    check(res == sum);
+
+    res = sum_prime_squares(r[0], r[1]);
+    cout << "sum_prime_squares(" << r[0] << ", " << r[1] << ") = " << to_string(res);
+    check(res == squares);
+  }
+
+  cout << "sum_prime_squares(2^64 - 10^6, 2^64 - 1) >= 2^128";
+  try
+  {
+    sum_prime_squares(18446744073708551615ull, 18446744073709551615ull);
+    check(false);
+  }
+  catch (primesieve_error&)
+  {
+    check(true);
+  }
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
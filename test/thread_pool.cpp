@@ -0,0 +1,99 @@
+///
+/// @file   thread_pool.cpp
+/// @brief  Test the ThreadPool used by ParallelSieve.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/Affinity.hpp>
+#include <primesieve/ThreadPool.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <cstdlib>
+#include <stdexcept>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  ThreadPool& pool = threadPool();
+
+  for (int threads = 1; threads <= 8; threads *= 2)
+  {
+    atomic<int> i(0);
+    atomic<int> sum(0);
+    int iters = 100000;
+
+    pool.run(threads, [&]()
+    {
+      while (i++ < iters)
+        sum++;
+    });
+
+    cout << "run(" << threads << ") sum = " << sum;
+    check(sum == iters);
+  }
+
+  bool caught = false;
+
+  try
+  {
+    pool.run(4, []() { throw runtime_error("test"); });
+  }
+  catch (runtime_error&)
+  {
+    caught = true;
+  }
+
+  cout << "run() rethrows exception";
+  check(caught);
+
+  shutdown_thread_pool();
+  cout << "shutdown_thread_pool() workers = " << pool.getNumWorkers();
+  check(pool.getNumWorkers() == 0);
+
+  uint64_t count = count_primes(0, 1000000000);
+  cout << "count_primes(0, 10^9) = " << count;
+  check(count == 50847534);
+
+  vector<int> allowed = getAllowedCpus();
+  vector<int> order = getCpuOrder();
+  sort(order.begin(), order.end());
+  cout << "getCpuOrder() CPUs = " << order.size();
+  check(order == allowed);
+
+  set_pin_threads(true);
+  cout << "get_pin_threads() = " << get_pin_threads();
+  check(get_pin_threads());
+
+  count = count_primes(0, 1000000000);
+  cout << "count_primes(0, 10^9) pinned = " << count;
+  check(count == 50847534);
+
+  set_pin_threads(false);
+  count = count_primes(0, 1000000000);
+  cout << "count_primes(0, 10^9) unpinned = " << count;
+  check(count == 50847534 &&
+        !get_pin_threads());
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,162 @@
+///
+/// @file   thread_pool_priority.cpp
+/// @brief  Concurrent jobs on the ThreadPool: the queued jobs
+///         are executed by priority and a running job yields
+///         its workers to a queued job of the same priority.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve.h>
+#include <primesieve/ThreadPool.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+int main()
+{
+  cout << "get_priority() = " << get_priority();
+  check(get_priority() == 0);
+
+  set_priority(3);
+  cout << "set_priority(3), primesieve_get_priority() = " << primesieve_get_priority();
+  check(primesieve_get_priority() == 3);
+
+  // the setting is thread-local
+  int other = -1;
+  thread t([&]() { other = get_priority(); });
+  t.join();
+  cout << "get_priority() of another thread = " << other;
+  check(other == 0);
+  set_priority(0);
+
+  {
+    // the only worker is busy while the jobs
+    // are queued, the jobs of priority 1 must
+    // be executed before the job of priority 0
+    ThreadPool pool;
+    mutex lock;
+    condition_variable cond;
+    bool release = false;
+    vector<int> order;
+
+    pool.submit([&]() {
+      unique_lock<mutex> guard(lock);
+      cond.wait(guard, [&]() { return release; });
+    });
+
+    for (int priority : { 0, 1, 1 })
+    {
+      set_priority(priority);
+      pool.submit([&, priority]() {
+        lock_guard<mutex> guard(lock);
+        order.push_back(priority);
+      });
+    }
+
+    set_priority(0);
+
+    {
+      lock_guard<mutex> guard(lock);
+      release = true;
+    }
+
+    cond.notify_all();
+    pool.shutdown();
+    cout << "execution order by priority";
+    check(order == vector<int>({ 1, 1, 0 }));
+  }
+
+  {
+    // a big job runs on 4 threads until a small job
+    // has been completed by one of its workers
+    ThreadPool pool;
+    atomic<bool> done(false);
+    atomic<int> yields(0);
+    atomic<int> smallRuns(0);
+
+    thread big([&]() {
+      pool.run(4, [&]() {
+        while (!done)
+        {
+          if (pool.yield())
+          {
+            yields++;
+            return;
+          }
+          this_thread::sleep_for(chrono::milliseconds(1));
+        }
+      });
+    });
+
+    while (pool.getNumWorkers() < 3)
+      this_thread::sleep_for(chrono::milliseconds(1));
+    this_thread::sleep_for(chrono::milliseconds(20));
+
+    // the calling thread is not a worker
+    cout << "yield() of the calling thread = " << pool.yield();
+    check(!pool.yield());
+
+    pool.run(2, [&]() {
+      smallRuns++;
+      // wait until the copy of the
+      // small job has been started
+      while (smallRuns < 2)
+        this_thread::sleep_for(chrono::milliseconds(1));
+    });
+
+    done = true;
+    big.join();
+
+    cout << "small job executed by 2 threads = " << smallRuns;
+    check(smallRuns == 2);
+    cout << "big job yielded workers = " << yields;
+    check(yields >= 1);
+  }
+
+  // concurrent computations of different
+  // priorities on the process-wide pool
+  uint64_t expected = count_primes(0, 100000000);
+  vector<thread> threads;
+  atomic<int> errors(0);
+
+  for (int i = 0; i < 4; i++)
+  {
+    threads.emplace_back([&, i]() {
+      set_priority(i % 2);
+      if (count_primes(0, 100000000) != expected)
+        errors++;
+    });
+  }
+
+  for (auto& th : threads)
+    th.join();
+
+  cout << "concurrent count_primes(0, 10^8) = " << expected;
+  check(errors == 0);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,145 @@
+///
+/// @file   tuning.cpp
+/// @brief  Test the tuning file written by primesieve --autotune
+///         and sieving using tuned parameters.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/config.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/Tuning.hpp>
+
+#include <stdint.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+bool operator==(const TuningBand& a, const TuningBand& b)
+{
+  return a.maxStop == b.maxStop &&
+         a.sieveSize == b.sieveSize &&
+         a.factorEratSmall == b.factorEratSmall &&
+         a.factorEratMedium == b.factorEratMedium &&
+         a.minThreadDistance == b.minThreadDistance;
+}
+
+int main()
+{
+  uint64_t max = numeric_limits<uint64_t>::max();
+  Tuning tuning;
+  tuning.add({ max, 512, 1.0, 2.5, 1000000 });
+  tuning.add({ 1000000000000ull, 64, 0.25, 4.0, 100000000 });
+  tuning.add({ 1000000000ull, 16, 0.5, 1.5, 10000000 });
+
+  cout << "tuning.band(1e9)";
+  check(tuning.band(1000000000ull).sieveSize == 16);
+
+  cout << "tuning.band(1e9 + 1)";
+  check(tuning.band(1000000001ull).sieveSize == 64);
+
+  cout << "tuning.band(2^64 - 1)";
+  check(tuning.band(max).sieveSize == 512);
+
+  cout << "Tuning().band(1e12) = defaults";
+  check(Tuning().band(1000000000000ull) == Tuning::defaults(max));
+
+  // the values are clamped to the limits of config.hpp
+  Tuning clamped;
+  clamped.add({ 100, 1 << 20, 9.0, -1.0, 1 });
+  TuningBand band = clamped.band(100);
+  cout << "clamped band";
+  check(band.sieveSize == config::MAX_SIEVE_SIZE &&
+        band.factorEratSmall == 3.0 &&
+        band.factorEratMedium == 0.0 &&
+        band.minThreadDistance == 100);
+
+  string filename = "primesieve_tuning.txt";
+  tuning.save(filename);
+  Tuning loaded;
+  loaded.load(filename);
+  remove(filename.c_str());
+
+  cout << "load(save(tuning)) = tuning";
+  bool OK = loaded.bands().size() == tuning.bands().size();
+  for (size_t i = 0; OK && i < loaded.bands().size(); i++)
+    OK = loaded.bands()[i] == tuning.bands()[i];
+  check(OK);
+
+  uint64_t start = 1000000000000ull - 100000000;
+  uint64_t stop = 1000000000000ull + 100000000;
+  uint64_t count = count_primes(start, stop);
+
+  // bands with extreme EratSmall/EratMedium
+  // factors and sieve sizes give the same count
+  setTuning(tuning);
+
+  cout << "tunedSieveSize(1e9)";
+  check(tunedSieveSize(0, 1000000000ull, 1) == 16);
+
+  cout << "count_primes(" << start << ", " << stop << ") = " << count;
+  check(count_primes(start, stop) == count);
+
+  for (double small : { 0.0, 1.5, 3.0 })
+  {
+    for (double medium : { 0.0, 2.5, 5.0 })
+    {
+      Tuning t;
+      t.add({ max, 32, small, medium, 1000000 });
+      setTuning(t);
+      cout << "EratSmall = " << small << ", EratMedium = " << medium << ": count_primes = " << count;
+      check(count_primes(start, stop) == count);
+    }
+  }
+
+  setTuning(tuning);
+  PrimeSieve tuned;
+  tuned.countPrimes(0, 1000000000);
+  cout << "PrimeSieve::getSieveSize() = tuned sieve size";
+  check(tuned.getSieveSize() == 16);
+
+  // without tuning file: built-in sieve size of
+  // the stop number, reduced for small distances
+  setTuning(Tuning());
+  uint64_t n = 1000000000000000ull;
+  cout << "tunedSieveSize(1e15, 1e15 + 1e6)";
+  check(tunedSieveSize(n, n + 1000000, 1) == min(64, Tuning::builtinSieveSize(n + 1000000, 1)));
+
+  cout << "builtinSieveSize(1e19) <= builtinSieveSize(1e10)";
+  check(Tuning::builtinSieveSize(10000000000000000000ull, 1) <= Tuning::builtinSieveSize(10000000000ull, 1));
+
+  // set_sieve_size() and setSieveSize()
+  // have priority over the tuned sieve size
+  setTuning(tuning);
+  set_sieve_size(128);
+  cout << "tunedSieveSize(1e9) = set_sieve_size()";
+  check(tunedSieveSize(0, 1000000000ull, 1) == 128);
+
+  PrimeSieve ps;
+  ps.setSieveSize(256);
+  ps.countPrimes(0, 1000000000);
+  cout << "ps.getSieveSize() = setSieveSize()";
+  check(ps.getSieveSize() == 256);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}
@@ -0,0 +1,79 @@
+///
+/// @file   tuplet_sieve.cpp
+/// @brief  Compare the quintuplet and sextuplet counts of the
+///         TupletSieve against the normal sieve.
+///
+/// Copyright (C) 2018 Kim Walisch, <kim.walisch@gmail.com>
+///
+/// This file is distributed under the BSD License. See the COPYING
+/// file in the top level directory.
+///
+
+#include <primesieve.hpp>
+#include <primesieve/PrimeSieve.hpp>
+#include <primesieve/TupletSieve.hpp>
+
+#include <stdint.h>
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+using namespace primesieve;
+
+void check(bool OK)
+{
+  cout << "   " << (OK ? "OK" : "ERROR") << "\n";
+  if (!OK)
+    exit(1);
+}
+
+/// COUNT_PRIMES disables the TupletSieve
+uint64_t countNormal(uint64_t start, uint64_t stop, int flag, int i)
+{
+  PrimeSieve ps;
+  ps.sieve(start, stop, COUNT_PRIMES | flag);
+  return ps.getCount(i);
+}
+
+int main()
+{
+  PrimeSieve ps;
+  ps.setStart((uint64_t) 1e12);
+  ps.setStop((uint64_t) 1e12 + 1000);
+  ps.setFlags(COUNT_SEXTUPLETS);
+  cout << "TupletSieve::isSupported(COUNT_SEXTUPLETS)";
+  check(TupletSieve::isSupported(ps));
+
+  ps.setFlags(COUNT_PRIMES | COUNT_SEXTUPLETS);
+  cout << "TupletSieve::isSupported(COUNT_PRIMES | COUNT_SEXTUPLETS)";
+  check(!TupletSieve::isSupported(ps));
+
+  uint64_t starts[] = { (uint64_t) 1e10, (uint64_t) 1e12 + 12345, (uint64_t) 1e17 };
+
+  for (uint64_t start : starts)
+  {
+    uint64_t stop = start + (uint64_t) 1e9;
+
+    uint64_t res = count_quintuplets(start, stop);
+    cout << "count_quintuplets(" << start << ", " << stop << ") = " << res;
+    check(res == countNormal(start, stop, COUNT_QUINTUPLETS, 4));
+
+    res = count_sextuplets(start, stop);
+    cout << "count_sextuplets(" << start << ", " << stop << ") = " << res;
+    check(res == countNormal(start, stop, COUNT_SEXTUPLETS, 5));
+  }
+
+  // sextuplet at the boundaries of [start, stop]
+  uint64_t p = 100006222567ull;
+  cout << "count_sextuplets(p, p + 16) = " << count_sextuplets(p, p + 16);
+  check(count_sextuplets(p, p + 16) == 1);
+  cout << "count_sextuplets(p, p + 15) = " << count_sextuplets(p, p + 15);
+  check(count_sextuplets(p, p + 15) == 0);
+  cout << "count_sextuplets(p + 1, p + 16) = " << count_sextuplets(p + 1, p + 16);
+  check(count_sextuplets(p + 1, p + 16) == 0);
+
+  cout << endl;
+  cout << "All tests passed successfully!" << endl;
+
+  return 0;
+}